@@ -9,6 +9,8 @@ class CmakeBuilder:
         '-app' : '-DBUILD_ENGINE_CORE',
         '-third_party' : '-DBUILD_THIRD_PARTY',
         '-project_launcher' : '-DBUILD_PROJECT_LAUNCHER',
+        '-pak_packer' : '-DBUILD_PAK_PACKER',
+        '-asset_importer' : '-DBUILD_ASSET_IMPORTER',
         '-vulkan_rhi' : '-DBUILD_VULKAN_RHI',
         '-renderer' : '-DBUILD_RENDERER',
         '-render_core' : '-DBUILD_RENDER_CORE',
@@ -19,7 +21,7 @@ class CmakeBuilder:
     }
 
 
-    fully_dependent_modules = { '-render_core', '-engine', '-renderer', '-app', '-tests', '-vulkan_rhi', '-editor', '-project_launcher' }
+    fully_dependent_modules = { '-render_core', '-engine', '-renderer', '-app', '-tests', '-vulkan_rhi', '-editor', '-project_launcher', '-pak_packer', '-asset_importer' }
     partially_dependent_modules = {  }
 
 
@@ -133,6 +135,8 @@ class CmakeBuilder:
         print('\t-render_core      = Compiles Render Core Module.\n')
         print('\t-renderer         = Compiles Renderer module.\n')
         print('\t-project_launcher = Compiles Project Launcher Module.\n')
+        print('\t-pak_packer       = Compiles PakPacker tool that packs project files into one archive.\n')
+        print('\t-asset_importer   = Compiles AssetImporter tool that imports a folder of source assets without the editor.\n')
         print('\t-editor           = Compiles editor.\n')
         print('\t-vs2017           = Uses cmake generator for Visual Studio 15 2017.\n')
         print('\t-vs2019           = Uses cmake generator for Visual Studio 16 2019.\n')
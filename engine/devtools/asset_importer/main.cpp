@@ -0,0 +1,111 @@
+#include "resource_manager/resource_manager2.h"
+#include "resource_manager/resource_manager_module.h"
+#include "core/global_objects.h"
+#include "file_system/utils.h"
+#include "profiler/logger.h"
+#include "core/timer.h"
+
+#include <cstring>
+#include <filesystem>
+
+using namespace ad_astris;
+
+constexpr uint64_t MEGABYTE = 1024 * 1024;
+
+// Usage: AssetImporter <project directory> <source directory> <engine resource directory> [--max-memory MiB] [--no-cache] [--keep-loaded]
+// Imports all supported models, textures and fonts of the source directory without the editor. Must be started
+// from the bin folder of the engine like other engine executables, so modules and configs are found
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		LOG_ERROR("Usage: AssetImporter <project directory> <source directory> <engine resource directory> [--max-memory MiB] [--no-cache] [--keep-loaded]")
+		return 1;
+	}
+
+	std::filesystem::path projectDirectory = std::filesystem::absolute(argv[1]);
+	std::filesystem::path sourceDirectory = std::filesystem::absolute(argv[2]);
+	std::filesystem::path engineResourceDirectory = std::filesystem::absolute(argv[3]);
+	resource::experimental::ResourceImportSettings importSettings;
+	importSettings.areResourcesUnloaded = true;
+	bool isImportCacheEnabled = true;
+	for (int i = 4; i != argc; ++i)
+	{
+		if (!strcmp(argv[i], "--max-memory") && i + 1 != argc)
+			importSettings.maxInFlightSize = std::stoull(argv[++i]) * MEGABYTE;
+		else if (!strcmp(argv[i], "--no-cache"))
+			isImportCacheEnabled = false;
+		else if (!strcmp(argv[i], "--keep-loaded"))
+			importSettings.areResourcesUnloaded = false;
+		else
+		{
+			LOG_WARNING("Unknown option {}", argv[i])
+		}
+	}
+	
+	if (!std::filesystem::is_directory(projectDirectory) || !std::filesystem::is_directory(sourceDirectory))
+	{
+		LOG_ERROR("Directory {} or {} doesn't exist", projectDirectory.string(), sourceDirectory.string())
+		return 1;
+	}
+	std::filesystem::create_directories(engineResourceDirectory);
+
+	GlobalObjectContext globalObjectContext;
+	GlobalObjects::set_global_object_context(&globalObjectContext);
+	GlobalObjects::init_frame_scratch_allocator();
+	GlobalObjects::init_event_manager();
+	EVENT_MANAGER()->set_frame_scratch_allocator(FRAME_SCRATCH_ALLOCATOR());
+	GlobalObjects::init_file_system();
+	GlobalObjects::init_module_manager();
+	GlobalObjects::init_task_composer();
+	FILE_SYSTEM()->set_project_root_path(projectDirectory.string().c_str());
+
+	auto resourceManagerModule = MODULE_MANAGER()->load_module<resource::experimental::IResourceManagerModule>("ResourceManager");
+	resourceManagerModule->set_global_objects();
+	resource::experimental::ResourceManager* resourceManager = resourceManagerModule->get_resource_manager();
+	resourceManager->init();
+	resourceManager->set_import_cache_enabled(isImportCacheEnabled);
+
+	std::vector<resource::experimental::ResourceImportRequest> requests;
+	for (auto& entry : std::filesystem::recursive_directory_iterator(sourceDirectory))
+	{
+		if (!entry.is_regular_file())
+			continue;
+		std::string extension = io::Utils::get_file_extension(entry.path().string().c_str());
+		if (resourceManager->is_model_format_supported(extension)
+			|| resourceManager->is_texture_format_supported(extension)
+			|| resourceManager->is_font_format_supported(extension))
+		{
+			resource::experimental::ResourceImportRequest& request = requests.emplace_back();
+			request.originalResourcePath = entry.path().string().c_str();
+			request.engineResourcePath = engineResourceDirectory.string().c_str();
+		}
+	}
+	LOG_INFO("Found {} sources to import in {}", requests.size(), sourceDirectory.string())
+
+	Timer timer;
+	resource::experimental::ResourceImportResult result = resourceManager->import_resources(requests, importSettings,
+		[](const resource::experimental::ResourceImportProgress& progress)
+		{
+			LOG_INFO("Imported {}/{} sources ({} failed, {} cached), {:.1f} MiB/s read, {:.1f} MiB/s written, {} MiB peak in flight",
+				progress.completedSourceCount,
+				progress.sourceCount,
+				progress.failedSourceCount,
+				progress.cachedSourceCount,
+				progress.get_source_throughput(),
+				progress.get_write_throughput(),
+				progress.peakInFlightSize / MEGABYTE)
+		});
+	resourceManager->save_resources();
+
+	const resource::experimental::ResourceImportProgress& progress = result.progress;
+	LOG_INFO("Imported {} resources from {} sources ({} MiB) into {} MiB of resource files in {} ms",
+		progress.writtenResourceCount,
+		progress.completedSourceCount - progress.failedSourceCount,
+		progress.sourceSize / MEGABYTE,
+		progress.writtenSize / MEGABYTE,
+		timer.elapsed_milliseconds())
+
+	resourceManager->cleanup();
+	return progress.failedSourceCount ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+#include "file_system/pak_archive.h"
+#include "profiler/logger.h"
+#include "core/timer.h"
+
+#include <cstring>
+#include <filesystem>
+
+using namespace ad_astris;
+
+// Usage: PakPacker <project directory> <output archive> [--lz4]
+// Paths in the archive are relative to the project directory, so the archive is mounted at the project root
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		LOG_ERROR("Usage: PakPacker <project directory> <output archive> [--lz4]")
+		return 1;
+	}
+
+	std::filesystem::path directory = argv[1];
+	std::filesystem::path outputPath = argv[2];
+	io::PakCompression compression = argc > 3 && !strcmp(argv[3], "--lz4") ? io::PakCompression::LZ4 : io::PakCompression::NONE;
+	if (!std::filesystem::is_directory(directory))
+	{
+		LOG_ERROR("Directory {} doesn't exist", directory.string())
+		return 1;
+	}
+
+	Timer timer;
+	io::PakWriter writer;
+	for (auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		// The archive can be written into the packed directory, older archives are not packed
+		if (entry.is_regular_file() && entry.path().extension() != io::PAK_FILE_EXTENSION)
+			writer.add_file(entry.path(), entry.path().lexically_relative(directory));
+	}
+
+	if (!writer.write(outputPath, compression))
+		return 1;
+
+	LOG_INFO("Packed {} files into {} ({} bytes) in {} ms",
+		writer.get_file_count(), outputPath.string(), std::filesystem::file_size(outputPath), timer.elapsed_milliseconds())
+	return 0;
+}
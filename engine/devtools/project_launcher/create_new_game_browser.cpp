@@ -146,7 +146,6 @@ void CreateNewGameBrowser::create_folders(std::string& projectPath, std::string&
 	std::filesystem::create_directories(projectPath + "/content/builtin");
 	std::filesystem::create_directories(projectPath + "/content/materials");
 	std::ofstream aaprojectFile(projectPath + "/" + projectName + ".aaproject", std::ios::trunc);
-	std::ofstream resourceTableConfigFile(projectPath + "/configs/resource_table.ini");
 	std::ofstream projectSettingsConfigFile(projectPath + "/configs/project_settings.ini");
 	std::ofstream projectModulesConfigFile(projectPath + "/configs/modules.ini");
 }
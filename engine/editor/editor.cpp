@@ -7,6 +7,7 @@
 #include "ui_core/utils.h"
 #include "ui_core/docking_window.h"
 #include "resource_manager/resource_events.h"
+#include "resource_manager/resource_index.h"
 #include <imgui/ImGuizmo.h>
 
 using namespace ad_astris;
@@ -24,21 +25,20 @@ void Editor::init(EditorInitContext& initContext)
 	_ecsUiManager->set_global_variables();
 	subscribe_to_events();
 
-	io::URI path = _fileSystem->get_project_root_path() + "/configs/resource_table.ini";
-	Config config;
-	config.load_from_file(path);
-
-	for (auto section : config)
+	// The resource manager owns the index of the project, so this one must not save it or append to its log
+	resource::ResourceIndex resourceIndex;
+	resourceIndex.load_project(_fileSystem, _fileSystem->get_project_root_path(), true);
+	resourceIndex.for_each([&](const resource::ResourceIndexRecord& record)
 	{
 		ResourceInfo resourceInfo;
-		resourceInfo.type = resource::Utils::get_enum_resource_type(section.get_option_value<std::string>("Type"));
-		resourceInfo.uuid = section.get_option_value<uint64_t>("UUID");
-		_resourceInfoByRelativePath[section.get_name()] = resourceInfo;
+		resourceInfo.type = record.type;
+		resourceInfo.uuid = record.uuid;
+		_resourceInfoByRelativePath[record.path] = resourceInfo;
 		ResourceDesc resourceDesc;
 		resourceDesc.uuid = resourceInfo.uuid;
-		resourceDesc.resourceName = io::Utils::get_file_name(section.get_name());
+		resourceDesc.resourceName = io::Utils::get_file_name(record.path);
 		_resourceDescriptionsByType[resourceInfo.type].push_back(resourceDesc);
-	}
+	});
 
 	rhi::init_imgui(IMGUI_BACKEND());
 	_ecsUiManager->set_imgui_context(IMGUI_BACKEND()->get_context());
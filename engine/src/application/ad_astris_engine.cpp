@@ -45,11 +45,22 @@ void AdAstrisEngine::init_global_objects()
 	GlobalObjects::set_global_object_context(_globalObjectContext.get());
 	LOG_INFO("AdAstrisEngine::init(): Initialized GlobalObjectContext.")
 	
+	GlobalObjects::init_frame_scratch_allocator();
+	LOG_INFO("AdAstrisEngine::init(): Initialized FrameScratchAllocator.")
+	
 	GlobalObjects::init_event_manager();
+	EVENT_MANAGER()->set_frame_scratch_allocator(FRAME_SCRATCH_ALLOCATOR());
 	LOG_INFO("AdAstrisEngine::init(): Initialized EventManager.")
 	
 	GlobalObjects::init_file_system();
 	LOG_INFO("AdAstrisEngine::init(): Initialized FileSystem. Engine root path is {}", FILE_SYSTEM()->get_engine_root_path().c_str())
+
+	profiler::LogFileSettings logFileSettings;
+	logFileSettings.filePath = std::string(FILE_SYSTEM()->get_engine_root_path().c_str()) + "/logs/engine.log";
+	if (Logger::get_instance()->open_log_file(logFileSettings))
+	{
+		LOG_INFO("AdAstrisEngine::init(): Opened log file {}", logFileSettings.filePath)
+	}
 	
 	GlobalObjects::init_module_manager();
 	LOG_INFO("AdAstrisEngine::init(): Initialized ModuleManager.")
@@ -80,6 +91,13 @@ bool AdAstrisEngine::open_project()
 	std::string& fullProjectPath = _projectInfo.projectPath;
 	std::string projectPathWithNoFile = fullProjectPath.substr(0, fullProjectPath.find_last_of("/"));
 	FILE_SYSTEM()->set_project_root_path(projectPathWithNoFile.c_str());
+
+	// Shipped projects keep resources and resource tables in one archive instead of loose files
+	std::string pakPath = projectPathWithNoFile + "/" + _projectInfo.projectName + io::PAK_FILE_EXTENSION;
+	if (std::filesystem::exists(pakPath) && FILE_SYSTEM()->mount_pak(pakPath, projectPathWithNoFile))
+	{
+		LOG_INFO("AdAstrisEngine::init(): Mounted project archive {}", pakPath)
+	}
 	MODULE_MANAGER()->load_project_modules_config();
 
 	return true;
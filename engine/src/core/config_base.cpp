@@ -74,6 +74,25 @@ bool Config::load_from_file(const io::URI& configPath)
 	return true;
 }
 
+bool Config::load_from_file(io::FileSystem* fileSystem, const io::URI& configPath)
+{
+	_configPath = configPath.c_str();
+	if (io::Utils::get_file_extension(configPath) != "ini")
+	{
+		LOG_ERROR("ConfigBase::load_config(): You can't load config if it's not an .ini file")
+		return false;
+	}
+
+	io::MappedFile mappedFile = fileSystem->map_file(configPath, io::MapAccess::SEQUENTIAL);
+	if (!mappedFile.is_valid())
+	{
+		LOG_ERROR("ConfigBase::load_config(): Failed to read config {}", _configPath)
+		return false;
+	}
+	_config = inicpp::parser::load(std::string(reinterpret_cast<const char*>(mappedFile.data()), mappedFile.size()));
+	return true;
+}
+
 void Config::unload()
 {
 	_config = inicpp::config();
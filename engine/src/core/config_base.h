@@ -92,6 +92,8 @@ namespace ad_astris
 	{
 		public:
 			bool load_from_file(const io::URI& configPath);
+			// Reads the config through the file system, so configs from mounted pak archives can be loaded
+			bool load_from_file(io::FileSystem* fileSystem, const io::URI& configPath);
 			void unload();
 			void save(io::FileSystem* fileSystem);
 
@@ -0,0 +1,780 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define FLAT_HASH_USE_SSE2 0
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ad_astris
+{
+	namespace flat_hash
+	{
+		// Each slot has one control byte. Full slots store 7 low bits of the hash (H2), so their highest bit is 0.
+		using Control = int8_t;
+		constexpr Control EMPTY = -128;		// 0b10000000
+		constexpr Control DELETED = -2;		// 0b11111110
+
+#if FLAT_HASH_USE_SSE2
+		constexpr size_t GROUP_WIDTH = 16;
+#else
+		constexpr size_t GROUP_WIDTH = 8;
+#endif
+
+		inline uint32_t count_trailing_zeros(uint64_t value)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return index;
+#else
+			return __builtin_ctzll(value);
+#endif
+		}
+
+		// Hashes of integer keys are identity in some STL implementations, so they are mixed before splitting into H1 and H2
+		inline uint64_t mix(uint64_t hash)
+		{
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdull;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		inline size_t get_h1(uint64_t hash)
+		{
+			return hash >> 7;
+		}
+
+		inline Control get_h2(uint64_t hash)
+		{
+			return static_cast<Control>(hash & 0x7f);
+		}
+
+		// Iterates over set bits. SHIFT is log2 of the number of bits that represent one slot
+		template<typename T, uint32_t SHIFT>
+		class BitMask
+		{
+			public:
+				explicit BitMask(T mask) : _mask(mask) { }
+
+				explicit operator bool() const
+				{
+					return _mask != 0;
+				}
+
+				uint32_t get_lowest_bit_index() const
+				{
+					return count_trailing_zeros(_mask) >> SHIFT;
+				}
+
+				BitMask& operator++()
+				{
+					_mask &= _mask - 1;
+					return *this;
+				}
+
+			private:
+				T _mask;
+		};
+
+#if FLAT_HASH_USE_SSE2
+		class Group
+		{
+			public:
+				explicit Group(const Control* ctrl) : _ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) { }
+
+				BitMask<uint32_t, 0> match(Control h2) const
+				{
+					return BitMask<uint32_t, 0>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _ctrl)));
+				}
+
+				BitMask<uint32_t, 0> match_empty() const
+				{
+					return match(EMPTY);
+				}
+
+				BitMask<uint32_t, 0> match_empty_or_deleted() const
+				{
+					return BitMask<uint32_t, 0>(_mm_movemask_epi8(_ctrl));
+				}
+
+			private:
+				__m128i _ctrl;
+		};
+#else
+		// SWAR fallback for platforms without SSE2. Works with 8 control bytes packed into uint64_t
+		class Group
+		{
+			public:
+				explicit Group(const Control* ctrl)
+				{
+					memcpy(&_ctrl, ctrl, sizeof(uint64_t));
+				}
+
+				// Can return false positives, they are filtered out by the key comparison
+				BitMask<uint64_t, 3> match(Control h2) const
+				{
+					uint64_t x = _ctrl ^ (LSBS * static_cast<uint8_t>(h2));
+					return BitMask<uint64_t, 3>((x - LSBS) & ~x & MSBS);
+				}
+
+				BitMask<uint64_t, 3> match_empty() const
+				{
+					return BitMask<uint64_t, 3>(_ctrl & ~(_ctrl << 6) & MSBS);
+				}
+
+				BitMask<uint64_t, 3> match_empty_or_deleted() const
+				{
+					return BitMask<uint64_t, 3>(_ctrl & MSBS);
+				}
+
+			private:
+				static constexpr uint64_t LSBS = 0x0101010101010101ull;
+				static constexpr uint64_t MSBS = 0x8080808080808080ull;
+				uint64_t _ctrl;
+		};
+#endif
+
+		template<typename Key, typename Slot>
+		struct KeyExtractor
+		{
+			static const Key& get(const Slot& slot)
+			{
+				return slot.first;
+			}
+		};
+
+		template<typename Key>
+		struct KeyExtractor<Key, const Key>
+		{
+			static const Key& get(const Key& slot)
+			{
+				return slot;
+			}
+		};
+	}
+
+	// Open addressing hash table with SwissTable-like layout. Slots are stored in one flat array, control bytes
+	// are stored separately and are probed by groups of GROUP_WIDTH bytes (SSE2 or SWAR).
+	// Iteration semantics:
+	// - iteration order is unspecified, but it is deterministic for the same sequence of operations;
+	// - any insertion can rehash the table and invalidate all iterators, pointers and references to elements,
+	//   call reserve() beforehand if pointers must stay valid while inserting;
+	// - erase() invalidates only iterators to erased elements, so it is safe to erase while iterating with it = erase(it);
+	// - clear() keeps the capacity.
+	// Hash and KeyEqual must be stateless.
+	template<typename Key, typename Slot, typename Hash, typename KeyEqual>
+	class FlatHashTable
+	{
+		using KeyExtractor = flat_hash::KeyExtractor<Key, Slot>;
+		using Control = flat_hash::Control;
+
+		public:
+			using key_type = Key;
+			using value_type = Slot;
+			using size_type = size_t;
+			using hasher = Hash;
+			using key_equal = KeyEqual;
+
+			template<bool IS_CONST>
+			class Iterator
+			{
+				friend class FlatHashTable;
+
+				public:
+					using iterator_category = std::forward_iterator_tag;
+					using value_type = std::remove_const_t<Slot>;
+					using difference_type = std::ptrdiff_t;
+					using reference = std::conditional_t<IS_CONST, const Slot&, Slot&>;
+					using pointer = std::conditional_t<IS_CONST, const Slot*, Slot*>;
+
+					Iterator() = default;
+
+					template<bool OTHER_IS_CONST, typename = std::enable_if_t<IS_CONST && !OTHER_IS_CONST>>
+					Iterator(const Iterator<OTHER_IS_CONST>& other) : _ctrl(other._ctrl), _ctrlEnd(other._ctrlEnd), _slot(other._slot) { }
+
+					reference operator*() const
+					{
+						return *_slot;
+					}
+
+					pointer operator->() const
+					{
+						return _slot;
+					}
+
+					Iterator& operator++()
+					{
+						++_ctrl;
+						++_slot;
+						skip_empty_slots();
+						return *this;
+					}
+
+					Iterator operator++(int)
+					{
+						Iterator it = *this;
+						++*this;
+						return it;
+					}
+
+					template<bool OTHER_IS_CONST>
+					bool operator==(const Iterator<OTHER_IS_CONST>& other) const
+					{
+						return _ctrl == other._ctrl;
+					}
+
+					template<bool OTHER_IS_CONST>
+					bool operator!=(const Iterator<OTHER_IS_CONST>& other) const
+					{
+						return _ctrl != other._ctrl;
+					}
+
+				private:
+					template<bool> friend class Iterator;
+
+					const Control* _ctrl{ nullptr };
+					const Control* _ctrlEnd{ nullptr };
+					Slot* _slot{ nullptr };
+
+					Iterator(const Control* ctrl, const Control* ctrlEnd, Slot* slot) : _ctrl(ctrl), _ctrlEnd(ctrlEnd), _slot(slot) { }
+
+					void skip_empty_slots()
+					{
+						while (_ctrl != _ctrlEnd && *_ctrl < 0)
+						{
+							++_ctrl;
+							++_slot;
+						}
+					}
+			};
+
+			using iterator = Iterator<false>;
+			using const_iterator = Iterator<true>;
+
+			FlatHashTable() = default;
+
+			FlatHashTable(const FlatHashTable& other)
+			{
+				reserve(other._size);
+				for (const Slot& slot : other)
+					emplace_slot(slot);
+			}
+
+			FlatHashTable(FlatHashTable&& other) noexcept
+			{
+				swap(other);
+			}
+
+			FlatHashTable& operator=(const FlatHashTable& other)
+			{
+				if (this != &other)
+				{
+					FlatHashTable temp(other);
+					swap(temp);
+				}
+				return *this;
+			}
+
+			FlatHashTable& operator=(FlatHashTable&& other) noexcept
+			{
+				if (this != &other)
+				{
+					destroy();
+					swap(other);
+				}
+				return *this;
+			}
+
+			~FlatHashTable()
+			{
+				destroy();
+			}
+
+			iterator begin()
+			{
+				iterator it(_ctrl, _ctrl + _capacity, _slots);
+				it.skip_empty_slots();
+				return it;
+			}
+
+			iterator end()
+			{
+				return iterator(_ctrl + _capacity, _ctrl + _capacity, _slots + _capacity);
+			}
+
+			const_iterator begin() const
+			{
+				const_iterator it(_ctrl, _ctrl + _capacity, _slots);
+				it.skip_empty_slots();
+				return it;
+			}
+
+			const_iterator end() const
+			{
+				return const_iterator(_ctrl + _capacity, _ctrl + _capacity, _slots + _capacity);
+			}
+
+			const_iterator cbegin() const
+			{
+				return begin();
+			}
+
+			const_iterator cend() const
+			{
+				return end();
+			}
+
+			size_t size() const
+			{
+				return _size;
+			}
+
+			bool empty() const
+			{
+				return _size == 0;
+			}
+
+			size_t capacity() const
+			{
+				return _capacity;
+			}
+
+			iterator find(const Key& key)
+			{
+				size_t index = find_index(key, hash_key(key));
+				return index == _capacity ? end() : iterator_at(index);
+			}
+
+			const_iterator find(const Key& key) const
+			{
+				size_t index = find_index(key, hash_key(key));
+				return index == _capacity ? end() : const_iterator_at(index);
+			}
+
+			bool contains(const Key& key) const
+			{
+				return find_index(key, hash_key(key)) != _capacity;
+			}
+
+			size_t count(const Key& key) const
+			{
+				return contains(key) ? 1 : 0;
+			}
+
+			iterator erase(const_iterator it)
+			{
+				size_t index = it._slot - _slots;
+				erase_at(index);
+				iterator next = iterator_at(index);
+				++next;
+				return next;
+			}
+
+			iterator erase(iterator it)
+			{
+				return erase(const_iterator(it));
+			}
+
+			size_t erase(const Key& key)
+			{
+				size_t index = find_index(key, hash_key(key));
+				if (index == _capacity)
+					return 0;
+				erase_at(index);
+				return 1;
+			}
+
+			void clear()
+			{
+				if (!_capacity)
+					return;
+				destroy_slots();
+				reset_ctrl();
+				_size = 0;
+				_growthLeft = capacity_to_growth(_capacity);
+			}
+
+			// Guarantees that the next count - size() insertions won't rehash the table
+			void reserve(size_t count)
+			{
+				size_t newCapacity = flat_hash::GROUP_WIDTH;
+				while (capacity_to_growth(newCapacity) < count)
+					newCapacity *= 2;
+				if (newCapacity > _capacity)
+					rehash(newCapacity);
+			}
+
+			void swap(FlatHashTable& other) noexcept
+			{
+				std::swap(_ctrl, other._ctrl);
+				std::swap(_slots, other._slots);
+				std::swap(_capacity, other._capacity);
+				std::swap(_size, other._size);
+				std::swap(_growthLeft, other._growthLeft);
+			}
+
+		protected:
+			// Returns index of the slot with the key. If the key was not found, prepares an empty slot that must be constructed by the caller
+			std::pair<size_t, bool> find_or_prepare_insert(const Key& key)
+			{
+				uint64_t hash = hash_key(key);
+				size_t index = find_index(key, hash);
+				if (index != _capacity)
+					return { index, true };
+				return { prepare_insert(hash), false };
+			}
+
+			template<typename ...ARGS>
+			void construct_slot(size_t index, ARGS&&... args)
+			{
+				new(get_slot_address(index)) Slot(std::forward<ARGS>(args)...);
+			}
+
+			std::pair<iterator, bool> emplace_slot(const Slot& slot)
+			{
+				auto [index, found] = find_or_prepare_insert(KeyExtractor::get(slot));
+				if (!found)
+					construct_slot(index, slot);
+				return { iterator_at(index), !found };
+			}
+
+			std::pair<iterator, bool> emplace_slot(std::remove_const_t<Slot>&& slot)
+			{
+				auto [index, found] = find_or_prepare_insert(KeyExtractor::get(slot));
+				if (!found)
+					construct_slot(index, std::move(slot));
+				return { iterator_at(index), !found };
+			}
+
+			iterator iterator_at(size_t index)
+			{
+				return iterator(_ctrl + index, _ctrl + _capacity, _slots + index);
+			}
+
+			const_iterator const_iterator_at(size_t index) const
+			{
+				return const_iterator(_ctrl + index, _ctrl + _capacity, _slots + index);
+			}
+
+			Slot& get_slot(size_t index)
+			{
+				return _slots[index];
+			}
+
+		private:
+			// _ctrl has GROUP_WIDTH extra bytes at the end that mirror the first GROUP_WIDTH bytes,
+			// so a group can be loaded from any position without wrapping around
+			Control* _ctrl{ nullptr };
+			Slot* _slots{ nullptr };
+			size_t _capacity{ 0 };		// 0 or power of two that is not less than GROUP_WIDTH
+			size_t _size{ 0 };
+			size_t _growthLeft{ 0 };	// Number of empty slots that can be filled before rehashing, deleted slots are not counted
+
+			static uint64_t hash_key(const Key& key)
+			{
+				return flat_hash::mix(static_cast<uint64_t>(Hash()(key)));
+			}
+
+			// Max load factor is 7/8
+			static size_t capacity_to_growth(size_t capacity)
+			{
+				return capacity - capacity / 8;
+			}
+
+			void* get_slot_address(size_t index)
+			{
+				return const_cast<void*>(static_cast<const void*>(_slots + index));
+			}
+
+			// Probing is triangular over groups, so all groups are visited because the number of groups is power of two
+			size_t find_index(const Key& key, uint64_t hash) const
+			{
+				if (!_capacity)
+					return _capacity;
+
+				size_t mask = _capacity - 1;
+				size_t offset = flat_hash::get_h1(hash) & mask;
+				size_t step = 0;
+				Control h2 = flat_hash::get_h2(hash);
+				while (true)
+				{
+					flat_hash::Group group(_ctrl + offset);
+					for (auto bitMask = group.match(h2); bitMask; ++bitMask)
+					{
+						size_t index = (offset + bitMask.get_lowest_bit_index()) & mask;
+						if (KeyEqual()(KeyExtractor::get(_slots[index]), key))
+							return index;
+					}
+					if (group.match_empty())
+						return _capacity;
+					step += flat_hash::GROUP_WIDTH;
+					offset = (offset + step) & mask;
+					assert(step <= _capacity && "FlatHashTable::find_index(): Table is full");
+				}
+			}
+
+			size_t find_first_non_full(uint64_t hash) const
+			{
+				size_t mask = _capacity - 1;
+				size_t offset = flat_hash::get_h1(hash) & mask;
+				size_t step = 0;
+				while (true)
+				{
+					flat_hash::Group group(_ctrl + offset);
+					auto bitMask = group.match_empty_or_deleted();
+					if (bitMask)
+						return (offset + bitMask.get_lowest_bit_index()) & mask;
+					step += flat_hash::GROUP_WIDTH;
+					offset = (offset + step) & mask;
+				}
+			}
+
+			size_t prepare_insert(uint64_t hash)
+			{
+				size_t index = _capacity ? find_first_non_full(hash) : 0;
+				if (!_growthLeft && (!_capacity || _ctrl[index] != flat_hash::DELETED))
+				{
+					grow();
+					index = find_first_non_full(hash);
+				}
+
+				if (_ctrl[index] == flat_hash::EMPTY)
+					--_growthLeft;
+				set_ctrl(index, flat_hash::get_h2(hash));
+				++_size;
+				return index;
+			}
+
+			void set_ctrl(size_t index, Control value)
+			{
+				_ctrl[index] = value;
+				if (index < flat_hash::GROUP_WIDTH)
+					_ctrl[index + _capacity] = value;
+			}
+
+			void erase_at(size_t index)
+			{
+				_slots[index].~Slot();
+				set_ctrl(index, flat_hash::DELETED);
+				--_size;
+			}
+
+			// If most of the used slots are deleted, the table is rehashed without growing to drop them
+			void grow()
+			{
+				if (_capacity && _size <= capacity_to_growth(_capacity) / 2)
+					rehash(_capacity);
+				else
+					rehash(_capacity ? _capacity * 2 : flat_hash::GROUP_WIDTH);
+			}
+
+			void rehash(size_t newCapacity)
+			{
+				Control* oldCtrl = _ctrl;
+				Slot* oldSlots = _slots;
+				size_t oldCapacity = _capacity;
+
+				_capacity = newCapacity;
+				_ctrl = new Control[_capacity + flat_hash::GROUP_WIDTH];
+				_slots = static_cast<Slot*>(::operator new(sizeof(Slot) * _capacity, std::align_val_t(alignof(Slot))));
+				reset_ctrl();
+				_growthLeft = capacity_to_growth(_capacity) - _size;
+
+				for (size_t i = 0; i != oldCapacity; ++i)
+				{
+					if (oldCtrl[i] < 0)
+						continue;
+					uint64_t hash = hash_key(KeyExtractor::get(oldSlots[i]));
+					size_t index = find_first_non_full(hash);
+					set_ctrl(index, flat_hash::get_h2(hash));
+					new(get_slot_address(index)) Slot(std::move(const_cast<std::remove_const_t<Slot>&>(oldSlots[i])));
+					oldSlots[i].~Slot();
+				}
+
+				delete[] oldCtrl;
+				if (oldSlots)
+					::operator delete(const_cast<void*>(static_cast<const void*>(oldSlots)), std::align_val_t(alignof(Slot)));
+			}
+
+			void reset_ctrl()
+			{
+				memset(_ctrl, flat_hash::EMPTY, _capacity + flat_hash::GROUP_WIDTH);
+			}
+
+			void destroy_slots()
+			{
+				if constexpr (!std::is_trivially_destructible_v<Slot>)
+				{
+					for (size_t i = 0; i != _capacity; ++i)
+					{
+						if (_ctrl[i] >= 0)
+							_slots[i].~Slot();
+					}
+				}
+			}
+
+			void destroy()
+			{
+				if (!_capacity)
+					return;
+				destroy_slots();
+				delete[] _ctrl;
+				::operator delete(const_cast<void*>(static_cast<const void*>(_slots)), std::align_val_t(alignof(Slot)));
+				_ctrl = nullptr;
+				_slots = nullptr;
+				_capacity = 0;
+				_size = 0;
+				_growthLeft = 0;
+			}
+	};
+
+	// Drop-in replacement for std::unordered_map on hot paths. See FlatHashTable for iteration and invalidation rules
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class FlatHashMap : public FlatHashTable<Key, std::pair<const Key, Value>, Hash, KeyEqual>
+	{
+		using Base = FlatHashTable<Key, std::pair<const Key, Value>, Hash, KeyEqual>;
+
+		public:
+			using mapped_type = Value;
+			using typename Base::value_type;
+			using typename Base::iterator;
+			using typename Base::const_iterator;
+
+			FlatHashMap() = default;
+
+			FlatHashMap(std::initializer_list<value_type> values)
+			{
+				insert(values.begin(), values.end());
+			}
+
+			template<typename K, typename ...ARGS>
+			std::pair<iterator, bool> try_emplace(K&& key, ARGS&&... args)
+			{
+				auto [index, found] = this->find_or_prepare_insert(key);
+				if (!found)
+				{
+					this->construct_slot(
+						index,
+						std::piecewise_construct,
+						std::forward_as_tuple(std::forward<K>(key)),
+						std::forward_as_tuple(std::forward<ARGS>(args)...));
+				}
+				return { this->iterator_at(index), !found };
+			}
+
+			template<typename K, typename ...ARGS>
+			std::pair<iterator, bool> emplace(K&& key, ARGS&&... args)
+			{
+				return try_emplace(std::forward<K>(key), std::forward<ARGS>(args)...);
+			}
+
+			std::pair<iterator, bool> insert(const value_type& value)
+			{
+				return this->emplace_slot(value);
+			}
+
+			std::pair<iterator, bool> insert(value_type&& value)
+			{
+				return this->emplace_slot(std::move(value));
+			}
+
+			template<typename InputIt>
+			void insert(InputIt first, InputIt last)
+			{
+				for (; first != last; ++first)
+					try_emplace(first->first, first->second);
+			}
+
+			template<typename V>
+			std::pair<iterator, bool> insert_or_assign(const Key& key, V&& value)
+			{
+				auto result = try_emplace(key, std::forward<V>(value));
+				if (!result.second)
+					result.first->second = std::forward<V>(value);
+				return result;
+			}
+
+			Value& operator[](const Key& key)
+			{
+				return try_emplace(key).first->second;
+			}
+
+			Value& operator[](Key&& key)
+			{
+				return try_emplace(std::move(key)).first->second;
+			}
+
+			Value& at(const Key& key)
+			{
+				auto it = this->find(key);
+				assert(it != this->end() && "FlatHashMap::at(): Key does not exist");
+				return it->second;
+			}
+
+			const Value& at(const Key& key) const
+			{
+				auto it = this->find(key);
+				assert(it != this->end() && "FlatHashMap::at(): Key does not exist");
+				return it->second;
+			}
+	};
+
+	// Elements are immutable, so iterator and const_iterator both give const references
+	template<typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+	class FlatHashSet : public FlatHashTable<Key, const Key, Hash, KeyEqual>
+	{
+		using Base = FlatHashTable<Key, const Key, Hash, KeyEqual>;
+
+		public:
+			using typename Base::iterator;
+			using typename Base::const_iterator;
+
+			FlatHashSet() = default;
+
+			FlatHashSet(std::initializer_list<Key> keys)
+			{
+				insert(keys.begin(), keys.end());
+			}
+
+			std::pair<iterator, bool> insert(const Key& key)
+			{
+				return this->emplace_slot(key);
+			}
+
+			std::pair<iterator, bool> insert(Key&& key)
+			{
+				return this->emplace_slot(std::move(key));
+			}
+
+			template<typename InputIt>
+			void insert(InputIt first, InputIt last)
+			{
+				for (; first != last; ++first)
+					insert(*first);
+			}
+
+			template<typename ...ARGS>
+			std::pair<iterator, bool> emplace(ARGS&&... args)
+			{
+				return insert(Key(std::forward<ARGS>(args)...));
+			}
+	};
+}
@@ -0,0 +1,139 @@
+#include "frame_scratch_allocator.h"
+#include "memory_tracker.h"
+#include "profiler/logger.h"
+
+#include <algorithm>
+
+using namespace ad_astris;
+
+static std::atomic<uint64_t> g_nextScratchAllocatorID{ 1 };
+
+FrameScratchAllocator::FrameScratchAllocator(size_t capacityPerThread)
+	: _capacityPerThread(capacityPerThread), _id(g_nextScratchAllocatorID.fetch_add(1))
+{
+
+}
+
+FrameScratchAllocator::~FrameScratchAllocator()
+{
+	for (auto& threadScratch : _threadScratches)
+	{
+		for (auto& buffer : threadScratch->buffers)
+		{
+			for (auto block : buffer.overflowBlocks)
+				MemoryUtils::free_aligned_memory(block);
+		}
+		MemoryTracker::record_free(MemoryTag::FRAME_SCRATCH, _capacityPerThread * 2);
+	}
+}
+
+void FrameScratchAllocator::begin_frame()
+{
+	_frameIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint8_t* FrameScratchAllocator::allocate(size_t size, size_t alignment)
+{
+	ThreadScratch& threadScratch = get_thread_scratch();
+	uint64_t frameIndex = _frameIndex.load(std::memory_order_relaxed);
+	ScratchBuffer& buffer = threadScratch.buffers[frameIndex % 2];
+	if (buffer.frameIndex.load(std::memory_order_relaxed) != frameIndex)
+		reset_buffer(buffer, frameIndex);
+
+	uint8_t* ptr = buffer.allocator.allocate(size, alignment);
+	if (!ptr)
+	{
+		if (buffer.overflowBlocks.empty())
+		{
+			LOG_WARNING("FrameScratchAllocator::allocate(): Scratch buffer of {} bytes is full. Heap will be used until the end of the frame", _capacityPerThread)
+		}
+
+		ptr = static_cast<uint8_t*>(MemoryUtils::allocate_aligned_memory(size, std::max(alignment, sizeof(void*))));
+		if (!ptr)
+			LOG_FATAL("FrameScratchAllocator::allocate(): Failed to allocate {} bytes", size)
+
+		buffer.overflowBlocks.push_back(ptr);
+		buffer.overflowBytes.store(buffer.overflowBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+	}
+
+	uint64_t usedBytes = buffer.allocator.get_offset() + buffer.overflowBytes.load(std::memory_order_relaxed);
+	buffer.usedBytes.store(usedBytes, std::memory_order_relaxed);
+	if (usedBytes > threadScratch.highWater.load(std::memory_order_relaxed))
+		threadScratch.highWater.store(usedBytes, std::memory_order_relaxed);
+
+	return ptr;
+}
+
+FrameScratchUsage FrameScratchAllocator::get_usage() const
+{
+	FrameScratchUsage usage;
+	uint64_t frameIndex = _frameIndex.load(std::memory_order_relaxed);
+
+	std::scoped_lock<std::mutex> locker(_threadScratchMutex);
+	for (auto& threadScratch : _threadScratches)
+	{
+		const ScratchBuffer& buffer = threadScratch->buffers[frameIndex % 2];
+		usage.capacity += _capacityPerThread;
+		if (buffer.frameIndex.load(std::memory_order_relaxed) == frameIndex)
+		{
+			usage.used += buffer.usedBytes.load(std::memory_order_relaxed);
+			usage.overflow += buffer.overflowBytes.load(std::memory_order_relaxed);
+		}
+		usage.highWater = std::max(usage.highWater, threadScratch->highWater.load(std::memory_order_relaxed));
+	}
+	usage.threadCount = _threadScratches.size();
+
+	return usage;
+}
+
+FrameScratchAllocator::ThreadScratch& FrameScratchAllocator::get_thread_scratch()
+{
+	// Module DLLs link engine_core statically, so every module has its own copy of this cache.
+	// That's why the cache only stores the result of the lookup and threads are registered inside the allocator.
+	struct ThreadScratchCache
+	{
+		const FrameScratchAllocator* owner{ nullptr };
+		uint64_t ownerID{ 0 };
+		ThreadScratch* threadScratch{ nullptr };
+	};
+	thread_local ThreadScratchCache cache;
+
+	if (cache.owner != this || cache.ownerID != _id)
+	{
+		cache.threadScratch = register_thread();
+		cache.owner = this;
+		cache.ownerID = _id;
+	}
+
+	return *cache.threadScratch;
+}
+
+FrameScratchAllocator::ThreadScratch* FrameScratchAllocator::register_thread()
+{
+	std::scoped_lock<std::mutex> locker(_threadScratchMutex);
+	auto it = _threadScratchByThreadID.find(std::this_thread::get_id());
+	if (it != _threadScratchByThreadID.end())
+		return it->second;
+
+	ThreadScratch* threadScratch = _threadScratches.emplace_back(new ThreadScratch()).get();
+	for (auto& buffer : threadScratch->buffers)
+	{
+		buffer.allocator.reserve(_capacityPerThread, FRAME_SCRATCH_ALIGNMENT);
+		buffer.frameIndex.store(_frameIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	_threadScratchByThreadID[std::this_thread::get_id()] = threadScratch;
+	MemoryTracker::record_allocation(MemoryTag::FRAME_SCRATCH, _capacityPerThread * 2);
+
+	return threadScratch;
+}
+
+void FrameScratchAllocator::reset_buffer(ScratchBuffer& buffer, uint64_t frameIndex)
+{
+	for (auto block : buffer.overflowBlocks)
+		MemoryUtils::free_aligned_memory(block);
+	buffer.overflowBlocks.clear();
+	buffer.allocator.reset();
+	buffer.usedBytes.store(0, std::memory_order_relaxed);
+	buffer.overflowBytes.store(0, std::memory_order_relaxed);
+	buffer.frameIndex.store(frameIndex, std::memory_order_relaxed);
+}
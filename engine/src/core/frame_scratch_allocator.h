@@ -0,0 +1,145 @@
+#pragma once
+
+#include "linear_allocator.h"
+#include "non_copyable_non_movable.h"
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace ad_astris
+{
+	constexpr size_t FRAME_SCRATCH_DEFAULT_CAPACITY = 4 * 1024 * 1024;
+	constexpr size_t FRAME_SCRATCH_ALIGNMENT = 16;
+
+	struct FrameScratchUsage
+	{
+		uint64_t capacity{ 0 };			// Capacity of all buffers that belong to the current frame
+		uint64_t used{ 0 };				// Bytes allocated during the current frame by all threads
+		uint64_t highWater{ 0 };		// Max bytes that one thread allocated during one frame since startup
+		uint64_t overflow{ 0 };			// Bytes that did not fit into scratch buffers and were allocated on the heap
+		uint32_t threadCount{ 0 };
+	};
+
+	// Each thread that allocates gets two linear buffers. Frame N uses buffer N % 2, so memory allocated
+	// during frame N stays valid until the end of frame N + 1. This is enough for data that is produced in one frame
+	// and consumed in the next one, for example, events that are dispatched after Engine::execute().
+	// Buffers are reset lazily by the owning thread, begin_frame() only increments the frame counter,
+	// so the allocator never touches memory of other threads.
+	// Only frame-bound work may allocate: the main thread and tasks that are waited for before the next begin_frame().
+	// Work that can finish in any frame, like completions of asynchronous loads, must use the heap or a pool,
+	// otherwise its memory can be reused while it is still referenced.
+	class FrameScratchAllocator : public NonCopyableNonMovable
+	{
+		public:
+			FrameScratchAllocator(size_t capacityPerThread = FRAME_SCRATCH_DEFAULT_CAPACITY);
+			~FrameScratchAllocator();
+
+			// Must be called from the main thread when no task from the frame N - 1 allocates anymore
+			void begin_frame();
+
+			// Any power of two alignment is supported. If the buffer of the thread is full, memory is allocated on the heap
+			// and released together with the buffer
+			uint8_t* allocate(size_t size, size_t alignment = FRAME_SCRATCH_ALIGNMENT);
+
+			template<typename T>
+			T* allocate(size_t count)
+			{
+				return reinterpret_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+			}
+
+			template<typename T, typename ...ARGS>
+			T* construct(ARGS&&... args)
+			{
+				return new(allocate(sizeof(T), alignof(T))) T(std::forward<ARGS>(args)...);
+			}
+
+			FrameScratchUsage get_usage() const;
+
+			uint64_t get_frame_index() const
+			{
+				return _frameIndex.load(std::memory_order_relaxed);
+			}
+
+			size_t get_capacity_per_thread() const
+			{
+				return _capacityPerThread;
+			}
+
+		private:
+			struct ScratchBuffer
+			{
+				LinearAllocator allocator;
+				std::vector<uint8_t*> overflowBlocks;
+				std::atomic<uint64_t> frameIndex{ 0 };
+				std::atomic<uint64_t> usedBytes{ 0 };
+				std::atomic<uint64_t> overflowBytes{ 0 };
+			};
+
+			struct ThreadScratch
+			{
+				ScratchBuffer buffers[2];
+				std::atomic<uint64_t> highWater{ 0 };
+			};
+
+			std::vector<std::unique_ptr<ThreadScratch>> _threadScratches;
+			std::unordered_map<std::thread::id, ThreadScratch*> _threadScratchByThreadID;
+			mutable std::mutex _threadScratchMutex;
+			std::atomic<uint64_t> _frameIndex{ 0 };
+			size_t _capacityPerThread{ 0 };
+			uint64_t _id{ 0 };
+
+			ThreadScratch& get_thread_scratch();
+			ThreadScratch* register_thread();
+			void reset_buffer(ScratchBuffer& buffer, uint64_t frameIndex);
+	};
+
+	// Memory is released only when the owning scratch buffer is reset, so deallocate() does nothing.
+	// Containers that use this allocator must not outlive the frame after the one where they were filled.
+	template<typename T>
+	class FrameScratchStlAllocator
+	{
+		public:
+			using value_type = T;
+
+			FrameScratchStlAllocator(FrameScratchAllocator* allocator) noexcept : _allocator(allocator) { }
+
+			template<typename U>
+			FrameScratchStlAllocator(const FrameScratchStlAllocator<U>& other) noexcept : _allocator(other.get_scratch_allocator()) { }
+
+			T* allocate(size_t count)
+			{
+				return _allocator->allocate<T>(count);
+			}
+
+			void deallocate(T*, size_t) noexcept { }
+
+			FrameScratchAllocator* get_scratch_allocator() const
+			{
+				return _allocator;
+			}
+
+			template<typename U>
+			bool operator==(const FrameScratchStlAllocator<U>& other) const
+			{
+				return _allocator == other.get_scratch_allocator();
+			}
+
+			template<typename U>
+			bool operator!=(const FrameScratchStlAllocator<U>& other) const
+			{
+				return _allocator != other.get_scratch_allocator();
+			}
+
+		private:
+			FrameScratchAllocator* _allocator{ nullptr };
+	};
+
+	template<typename T>
+	using FrameVector = std::vector<T, FrameScratchStlAllocator<T>>;
+	using FrameString = std::basic_string<char, std::char_traits<char>, FrameScratchStlAllocator<char>>;
+}
@@ -20,6 +20,11 @@ void GlobalObjects::init_task_composer(uint32_t threadCount)
 	_globalObjectContext->taskComposer = std::make_unique<tasks::TaskComposer>(threadCount);
 }
 
+void GlobalObjects::init_async_io_service()
+{
+	_globalObjectContext->asyncIOService = std::make_unique<io::AsyncIOService>(FILE_SYSTEM(), TASK_COMPOSER());
+}
+
 void GlobalObjects::init_event_manager()
 {
 	_globalObjectContext->eventManager = std::make_unique<events::EventManager>();
@@ -57,3 +62,8 @@ void GlobalObjects::init_profiler_instance()
 	profiler::ProfilerInstanceInitContext initContext{};
 	_globalObjectContext->profilerInstance = std::make_unique<profiler::ProfilerInstance>(initContext);
 }
+
+void GlobalObjects::init_frame_scratch_allocator()
+{
+	_globalObjectContext->frameScratchAllocator = std::make_unique<FrameScratchAllocator>();
+}
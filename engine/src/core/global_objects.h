@@ -1,11 +1,16 @@
 ﻿#pragma once
 
 #include "common.h"
+#include "frame_scratch_allocator.h"
+#include "memory_tracker.h"
+#include "name_table.h"
+#include "engine_core/uuid.h"
 #include "resource_manager/resource_manager.h"
 #include "resource_manager/resource_manager2.h"
 #include "multithreading/task_composer.h"
 #include "events/event_manager.h"
 #include "file_system/file_system.h"
+#include "file_system/async_io.h"
 #include "engine_core/world.h"
 #include "ecs/system_manager.h"
 #include "module_manager.h"
@@ -17,9 +22,17 @@ namespace ad_astris
 {
 	struct GlobalObjectContext
 	{
+		// Declared first to be destroyed last, other global objects log and record freed memory in their destructors
+		profiler::LoggerInstance logger;
+		MemoryTrackerInstance memoryTracker;
+		NameTableInstance nameTable;
+		UUIDGeneratorInstance uuidGenerator;
+		// Destroyed after the event manager, which destroys queued events that live in scratch memory
+		std::unique_ptr<FrameScratchAllocator> frameScratchAllocator{ nullptr };
 		std::unique_ptr<io::FileSystem> fileSystem{ nullptr };
 		std::unique_ptr<ModuleManager> moduleManager{ nullptr };
 		std::unique_ptr<tasks::TaskComposer> taskComposer{ nullptr };
+		std::unique_ptr<io::AsyncIOService> asyncIOService{ nullptr };
 		std::unique_ptr<resource::ResourceManager> resourceManager{ nullptr };
 		std::unique_ptr<events::EventManager> eventManager{ nullptr };
 		std::unique_ptr<ecore::World> world{ nullptr };
@@ -36,16 +49,22 @@ namespace ad_astris
 			static void init_file_system();
 			static void init_module_manager();
 			static void init_task_composer(uint32_t threadCount = ~0u);
+			static void init_async_io_service();
 			static void init_event_manager();
 			static void init_resource_manager();
 			static void init_world();
 			static void init_system_manager();
 			static void init_profiler_instance();
+			static void init_frame_scratch_allocator();
 		
 			static void set_global_object_context(GlobalObjectContext* context)
 			{
 				assert(context);
 				_globalObjectContext = context;
+				Logger::init(&context->logger);
+				MemoryTracker::init(&context->memoryTracker);
+				NameTable::init(&context->nameTable);
+				UUIDGenerator::init(&context->uuidGenerator);
 			}
 
 			static GlobalObjectContext* get_global_object_context()
@@ -60,6 +79,7 @@ namespace ad_astris
 		
 			FORCE_INLINE static io::FileSystem* get_file_system() { return _globalObjectContext->fileSystem.get(); }
 			FORCE_INLINE static tasks::TaskComposer* get_task_composer() { return _globalObjectContext->taskComposer.get(); }
+			FORCE_INLINE static io::AsyncIOService* get_async_io_service() { return _globalObjectContext->asyncIOService.get(); }
 			FORCE_INLINE static resource::ResourceManager* get_resource_manager() { return _globalObjectContext->resourceManager.get(); }
 			FORCE_INLINE static events::EventManager* get_event_manager() { return _globalObjectContext->eventManager.get(); }
 			FORCE_INLINE static ecore::World* get_world() { return _globalObjectContext->world.get(); }
@@ -69,6 +89,7 @@ namespace ad_astris
 			FORCE_INLINE static profiler::ProfilerInstance* get_profiler_instance() { return _globalObjectContext->profilerInstance.get(); }
 			FORCE_INLINE static uicore::ECSUiManager* get_ecs_ui_manager() { return _globalObjectContext->ecsUIManager.get(); }
 			FORCE_INLINE static rhi::IImGuiBackend* get_imgui_backend() { return _globalObjectContext->imguiBackend; }
+			FORCE_INLINE static FrameScratchAllocator* get_frame_scratch_allocator() { return _globalObjectContext->frameScratchAllocator.get(); }
 		
 		private:
 			inline static GlobalObjectContext* _globalObjectContext{ nullptr };
@@ -77,6 +98,7 @@ namespace ad_astris
 
 #define FILE_SYSTEM() ::ad_astris::GlobalObjects::get_file_system()
 #define TASK_COMPOSER() ::ad_astris::GlobalObjects::get_task_composer()
+#define ASYNC_IO_SERVICE() ::ad_astris::GlobalObjects::get_async_io_service()
 #define RESOURCE_MANAGER() ::ad_astris::GlobalObjects::get_resource_manager()
 #define EVENT_MANAGER() ::ad_astris::GlobalObjects::get_event_manager()
 #define WORLD() ::ad_astris::GlobalObjects::get_world()
@@ -87,3 +109,4 @@ namespace ad_astris
 #define ECS_UI_MANAGER() ::ad_astris::GlobalObjects::get_ecs_ui_manager()
 #define ENTITY_MANAGER() WORLD()->get_entity_manager()
 #define IMGUI_BACKEND() ::ad_astris::GlobalObjects::get_imgui_backend()
+#define FRAME_SCRATCH_ALLOCATOR() ::ad_astris::GlobalObjects::get_frame_scratch_allocator()
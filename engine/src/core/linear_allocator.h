@@ -37,6 +37,20 @@ namespace ad_astris
 				}
 				return nullptr;
 			}
+			// Aligns the address of the allocation instead of the size, so allocations with different alignment can share
+			// one buffer. Alignment can be bigger than the alignment of the buffer
+			uint8_t* allocate(size_t size, size_t align)
+			{
+				uintptr_t address = reinterpret_cast<uintptr_t>(buffer) + offset;
+				size_t alignedOffset = offset + (Align(address, align) - address);
+				if (alignedOffset + size <= capacity)
+				{
+					uint8_t* ret = &buffer[alignedOffset];
+					offset = alignedOffset + size;
+					return ret;
+				}
+				return nullptr;
+			}
 			constexpr void free(size_t size)
 			{
 				size = Align(size, alignment);
@@ -47,6 +61,10 @@ namespace ad_astris
 			{
 				offset = 0;
 			}
+			constexpr size_t get_offset() const
+			{
+				return offset;
+			}
 			constexpr uint8_t* top()
 			{
 				return &buffer[offset];
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "common.h"
+#include "memory_utils.h"
+#include "non_copyable_non_movable.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Counters are relaxed atomics placed on separate cache lines, so tracking stays enabled in release builds
+#ifndef MEMORY_TRACKING_ENABLED
+#define MEMORY_TRACKING_ENABLED 1
+#endif
+
+namespace ad_astris
+{
+	enum class MemoryTag : uint8_t
+	{
+		UNTAGGED = 0,
+		ECS,
+		RESOURCES,
+		IMPORTER,
+		RENDERER,
+		FRAME_SCRATCH,
+		COUNT
+	};
+
+	constexpr size_t MEMORY_TAG_COUNT = static_cast<size_t>(MemoryTag::COUNT);
+
+	struct MemoryTagStats
+	{
+		uint64_t liveBytes{ 0 };
+		uint64_t peakBytes{ 0 };
+		uint64_t allocationCount{ 0 };
+		uint64_t freeCount{ 0 };
+	};
+
+	using MemoryTagStatsArray = std::array<MemoryTagStats, MEMORY_TAG_COUNT>;
+
+	class MemoryTrackerInstance : public NonCopyableNonMovable
+	{
+		public:
+			void record_allocation(MemoryTag tag, uint64_t size)
+			{
+				TagCounters& counters = _counters[static_cast<size_t>(tag)];
+				uint64_t liveBytes = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+				counters.allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+				uint64_t peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+				while (liveBytes > peakBytes && !counters.peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed))
+				{
+
+				}
+			}
+
+			void record_free(MemoryTag tag, uint64_t size)
+			{
+				TagCounters& counters = _counters[static_cast<size_t>(tag)];
+				counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+				counters.freeCount.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			MemoryTagStats get_stats(MemoryTag tag) const
+			{
+				const TagCounters& counters = _counters[static_cast<size_t>(tag)];
+				MemoryTagStats stats;
+				stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+				stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+				stats.allocationCount = counters.allocationCount.load(std::memory_order_relaxed);
+				stats.freeCount = counters.freeCount.load(std::memory_order_relaxed);
+				return stats;
+			}
+
+		private:
+			struct alignas(64) TagCounters
+			{
+				std::atomic<uint64_t> liveBytes{ 0 };
+				std::atomic<uint64_t> peakBytes{ 0 };
+				std::atomic<uint64_t> allocationCount{ 0 };
+				std::atomic<uint64_t> freeCount{ 0 };
+			};
+
+			TagCounters _counters[MEMORY_TAG_COUNT];
+	};
+
+	// MemoryTrackerInstance is owned by GlobalObjectContext. Each module gets the pointer to it
+	// in GlobalObjects::set_global_object_context(), allocations before that are not tracked.
+	class MemoryTracker
+	{
+		public:
+			static void init(MemoryTrackerInstance* memoryTrackerInstance)
+			{
+				_memoryTrackerInstance = memoryTrackerInstance;
+			}
+
+			FORCE_INLINE static void record_allocation(MemoryTag tag, uint64_t size)
+			{
+#if MEMORY_TRACKING_ENABLED
+				if (_memoryTrackerInstance)
+					_memoryTrackerInstance->record_allocation(tag, size);
+#endif
+			}
+
+			FORCE_INLINE static void record_free(MemoryTag tag, uint64_t size)
+			{
+#if MEMORY_TRACKING_ENABLED
+				if (_memoryTrackerInstance)
+					_memoryTrackerInstance->record_free(tag, size);
+#endif
+			}
+
+			static void* allocate(MemoryTag tag, size_t size, size_t alignment)
+			{
+				void* ptr = MemoryUtils::allocate_aligned_memory(size, alignment);
+				if (ptr)
+					record_allocation(tag, size);
+				return ptr;
+			}
+
+			static void free(MemoryTag tag, void* ptr, size_t size)
+			{
+				if (!ptr)
+					return;
+				MemoryUtils::free_aligned_memory(ptr);
+				record_free(tag, size);
+			}
+
+			static MemoryTagStats get_stats(MemoryTag tag)
+			{
+				if (_memoryTrackerInstance)
+					return _memoryTrackerInstance->get_stats(tag);
+				return MemoryTagStats();
+			}
+
+			static MemoryTagStatsArray get_all_stats()
+			{
+				MemoryTagStatsArray allStats;
+				for (size_t i = 0; i != MEMORY_TAG_COUNT; ++i)
+					allStats[i] = get_stats(static_cast<MemoryTag>(i));
+				return allStats;
+			}
+
+			static const char* get_tag_name(MemoryTag tag)
+			{
+				switch (tag)
+				{
+					case MemoryTag::UNTAGGED:
+						return "untagged";
+					case MemoryTag::ECS:
+						return "ecs";
+					case MemoryTag::RESOURCES:
+						return "resources";
+					case MemoryTag::IMPORTER:
+						return "importer";
+					case MemoryTag::RENDERER:
+						return "renderer";
+					case MemoryTag::FRAME_SCRATCH:
+						return "frame_scratch";
+					default:
+						return "unknown";
+				}
+			}
+
+		private:
+			inline static MemoryTrackerInstance* _memoryTrackerInstance{ nullptr };
+	};
+
+	// Records memory that is owned by the current scope, for example, temporary importer buffers
+	class ScopedMemoryRecord : public NonCopyableNonMovable
+	{
+		public:
+			ScopedMemoryRecord(MemoryTag tag, uint64_t size) : _tag(tag), _size(size)
+			{
+				MemoryTracker::record_allocation(_tag, _size);
+			}
+
+			~ScopedMemoryRecord()
+			{
+				MemoryTracker::record_free(_tag, _size);
+			}
+
+		private:
+			MemoryTag _tag;
+			uint64_t _size;
+	};
+
+	template<typename T, MemoryTag Tag>
+	class TaggedStlAllocator
+	{
+		public:
+			using value_type = T;
+
+			template<typename U>
+			struct rebind
+			{
+				using other = TaggedStlAllocator<U, Tag>;
+			};
+
+			TaggedStlAllocator() noexcept = default;
+
+			template<typename U>
+			TaggedStlAllocator(const TaggedStlAllocator<U, Tag>& other) noexcept { }
+
+			T* allocate(size_t count)
+			{
+				MemoryTracker::record_allocation(Tag, count * sizeof(T));
+				return std::allocator<T>().allocate(count);
+			}
+
+			void deallocate(T* ptr, size_t count) noexcept
+			{
+				MemoryTracker::record_free(Tag, count * sizeof(T));
+				std::allocator<T>().deallocate(ptr, count);
+			}
+
+			template<typename U>
+			bool operator==(const TaggedStlAllocator<U, Tag>& other) const
+			{
+				return true;
+			}
+
+			template<typename U>
+			bool operator!=(const TaggedStlAllocator<U, Tag>& other) const
+			{
+				return false;
+			}
+	};
+
+	template<typename T, MemoryTag Tag>
+	using TaggedVector = std::vector<T, TaggedStlAllocator<T, Tag>>;
+}
@@ -2,6 +2,8 @@
 
 #ifdef _WIN32
 	#include <malloc.h>
+#else
+	#include <cstdlib>
 #endif
 
 using namespace ad_astris;
@@ -10,6 +12,9 @@ void* MemoryUtils::allocate_aligned_memory(size_t size, size_t alignment)
 {
 #if defined(_WIN32)
 	return _aligned_malloc(size, alignment);
+#else
+	// aligned_alloc requires the size to be a multiple of the alignment
+	return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
 #endif
 }
 
@@ -17,5 +22,7 @@ void MemoryUtils::free_aligned_memory(void* ptr)
 {
 #if defined(_WIN32)
 	_aligned_free(ptr);
+#else
+	std::free(ptr);
 #endif
 }
@@ -0,0 +1,143 @@
+#include "name_table.h"
+#include "profiler/logger.h"
+
+#include <cassert>
+#include <cstring>
+
+using namespace ad_astris;
+
+NameTableInstance::NameTableInstance()
+{
+	for (auto& page : _pages)
+		page.store(nullptr, std::memory_order_relaxed);
+
+	// Entry with NAME_NONE_ID is an empty string
+	get_or_allocate_entry(NAME_NONE_ID);
+}
+
+NameTableInstance::~NameTableInstance()
+{
+	for (auto& page : _pages)
+		delete[] page.load(std::memory_order_relaxed);
+}
+
+uint32_t NameTableInstance::intern(std::string_view str)
+{
+	return intern(str, hash_string(str));
+}
+
+uint32_t NameTableInstance::intern(std::string_view str, uint64_t hash)
+{
+	if (str.empty())
+		return NAME_NONE_ID;
+
+	assert(hash == hash_string(str) && "NameTableInstance::intern(): Hash does not match the string");
+	HashedString key{ str, hash };
+	Shard& shard = _shards[key.hash % SHARD_COUNT];
+
+	{
+		std::shared_lock<std::shared_mutex> locker(shard.mutex);
+		auto it = shard.idByString.find(key);
+		if (it != shard.idByString.end())
+			return it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> locker(shard.mutex);
+	auto it = shard.idByString.find(key);
+	if (it != shard.idByString.end())
+		return it->second;
+
+	uint32_t id = _nextID.fetch_add(1, std::memory_order_relaxed);
+	if ((id >> ENTRY_PAGE_SHIFT) >= MAX_ENTRY_PAGES)
+		LOG_FATAL("NameTableInstance::intern(): Name table is full, can't intern {}", str)
+
+	NameEntry& entry = get_or_allocate_entry(id);
+	entry.str = copy_string(shard, str);
+	entry.length = static_cast<uint32_t>(str.size());
+	entry.hash = key.hash;
+
+	// The key must point to the table's copy of the string because the source string can be temporary
+	shard.idByString.emplace(HashedString{ std::string_view(entry.str, entry.length), key.hash }, id);
+	return id;
+}
+
+uint32_t NameTableInstance::find(std::string_view str) const
+{
+	if (str.empty())
+		return NAME_NONE_ID;
+
+	HashedString key{ str, hash_string(str) };
+	const Shard& shard = _shards[key.hash % SHARD_COUNT];
+
+	std::shared_lock<std::shared_mutex> locker(shard.mutex);
+	auto it = shard.idByString.find(key);
+	return it != shard.idByString.end() ? it->second : NAME_NONE_ID;
+}
+
+uint64_t NameTableInstance::get_string_memory_size() const
+{
+	uint64_t size = 0;
+	for (auto& shard : _shards)
+	{
+		std::shared_lock<std::shared_mutex> locker(shard.mutex);
+		size += shard.stringMemorySize;
+	}
+	return size;
+}
+
+uint64_t NameTableInstance::hash_string(std::string_view str)
+{
+	// compile_time_fnv1() hashes the literal from the null terminator to the first character
+	uint64_t hash = fnv_iterate(0xcbf29ce484222325ull, 0);
+	for (auto it = str.rbegin(); it != str.rend(); ++it)
+		hash = fnv_iterate(hash, static_cast<uint8_t>(*it));
+	return hash;
+}
+
+const char* NameTableInstance::copy_string(Shard& shard, std::string_view str)
+{
+	size_t size = str.size() + 1;
+	char* dst = nullptr;
+	if (size > STRING_BLOCK_SIZE / 4)
+	{
+		// Long strings get their own block so the current block is not wasted
+		dst = shard.stringBlocks.emplace_back(new char[size]).get();
+		shard.stringMemorySize += size;
+	}
+	else
+	{
+		if (shard.blockOffset + size > STRING_BLOCK_SIZE)
+		{
+			shard.stringBlocks.emplace_back(new char[STRING_BLOCK_SIZE]);
+			shard.blockOffset = 0;
+			shard.stringMemorySize += STRING_BLOCK_SIZE;
+		}
+		dst = shard.stringBlocks.back().get() + shard.blockOffset;
+		shard.blockOffset += size;
+	}
+
+	memcpy(dst, str.data(), str.size());
+	dst[str.size()] = '\0';
+	return dst;
+}
+
+NameEntry& NameTableInstance::get_or_allocate_entry(uint32_t id)
+{
+	std::atomic<NameEntry*>& page = _pages[id >> ENTRY_PAGE_SHIFT];
+	NameEntry* entries = page.load(std::memory_order_acquire);
+	if (!entries)
+	{
+		NameEntry* newEntries = new NameEntry[ENTRY_PAGE_SIZE];
+		if (page.compare_exchange_strong(entries, newEntries, std::memory_order_acq_rel))
+			entries = newEntries;
+		else
+			delete[] newEntries;
+	}
+	return entries[id & (ENTRY_PAGE_SIZE - 1)];
+}
+
+NameTableInstance* NameTable::get_local_instance()
+{
+	static NameTableInstance nameTableInstance;
+	return &nameTableInstance;
+}
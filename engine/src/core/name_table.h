@@ -0,0 +1,194 @@
+#pragma once
+
+#include "common.h"
+#include "compile_time_hash.h"
+#include "flat_hash_map.h"
+#include "non_copyable_non_movable.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace ad_astris
+{
+	constexpr uint32_t NAME_NONE_ID = 0;
+
+	struct NameEntry
+	{
+		const char* str{ "" };
+		uint32_t length{ 0 };
+		uint64_t hash{ 0 };		// Equals compile_time_fnv1() of the same string literal
+	};
+
+	// Interned strings are never released. Each unique string gets a sequential ID, so IDs are compact
+	// and can be used as indices. String lookup is done in one of the shards chosen by the string hash, each shard
+	// has its own lock. Getting an entry by ID is lock-free because entry pages are never reallocated.
+	class NameTableInstance : public NonCopyableNonMovable
+	{
+		public:
+			NameTableInstance();
+			~NameTableInstance();
+
+			uint32_t intern(std::string_view str);
+			// The hash must be equal to hash_string(str), for example, compile_time_fnv1() of the same literal
+			uint32_t intern(std::string_view str, uint64_t hash);
+			// Returns NAME_NONE_ID if the string has not been interned
+			uint32_t find(std::string_view str) const;
+
+			const NameEntry& get_entry(uint32_t id) const
+			{
+				const NameEntry* page = _pages[id >> ENTRY_PAGE_SHIFT].load(std::memory_order_acquire);
+				return page[id & (ENTRY_PAGE_SIZE - 1)];
+			}
+
+			uint32_t get_name_count() const
+			{
+				return _nextID.load(std::memory_order_relaxed);
+			}
+
+			uint64_t get_string_memory_size() const;
+
+			static uint64_t hash_string(std::string_view str);
+
+		private:
+			inline static constexpr uint32_t SHARD_COUNT = 16;
+			inline static constexpr uint32_t ENTRY_PAGE_SHIFT = 12;
+			inline static constexpr uint32_t ENTRY_PAGE_SIZE = 1u << ENTRY_PAGE_SHIFT;
+			inline static constexpr uint32_t MAX_ENTRY_PAGES = 1024;
+			inline static constexpr size_t STRING_BLOCK_SIZE = 64 * 1024;
+
+			struct HashedString
+			{
+				std::string_view str;
+				uint64_t hash;
+			};
+
+			struct HashedStringHash
+			{
+				uint64_t operator()(const HashedString& key) const
+				{
+					return key.hash;
+				}
+			};
+
+			struct HashedStringEqual
+			{
+				bool operator()(const HashedString& first, const HashedString& second) const
+				{
+					return first.hash == second.hash && first.str == second.str;
+				}
+			};
+
+			struct alignas(64) Shard
+			{
+				FlatHashMap<HashedString, uint32_t, HashedStringHash, HashedStringEqual> idByString;
+				std::vector<std::unique_ptr<char[]>> stringBlocks;
+				size_t blockOffset{ STRING_BLOCK_SIZE };
+				uint64_t stringMemorySize{ 0 };
+				mutable std::shared_mutex mutex;
+			};
+
+			Shard _shards[SHARD_COUNT];
+			std::atomic<NameEntry*> _pages[MAX_ENTRY_PAGES];
+			std::atomic<uint32_t> _nextID{ NAME_NONE_ID + 1 };
+
+			const char* copy_string(Shard& shard, std::string_view str);
+			NameEntry& get_or_allocate_entry(uint32_t id);
+	};
+
+	// NameTableInstance is owned by GlobalObjectContext, so the same string has the same ID in all modules.
+	// Names must not be created before GlobalObjects::set_global_object_context(). Tools and tests that don't
+	// create the context use a module-local table.
+	class NameTable
+	{
+		public:
+			static void init(NameTableInstance* nameTableInstance)
+			{
+				_nameTableInstance = nameTableInstance;
+			}
+
+			// The module-local table is a function-local static, so its initialization is thread-safe
+			FORCE_INLINE static NameTableInstance* get_instance()
+			{
+				return _nameTableInstance ? _nameTableInstance : get_local_instance();
+			}
+
+		private:
+			inline static NameTableInstance* _nameTableInstance{ nullptr };
+
+			static NameTableInstance* get_local_instance();
+	};
+
+	// Handle to the interned string. Comparing and hashing are integer operations. Ordering is by ID,
+	// use get_string_view() to sort names alphabetically.
+	class Name
+	{
+		public:
+			Name() = default;
+			Name(const char* str) : Name(std::string_view(str ? str : "")) { }
+			Name(const std::string& str) : Name(std::string_view(str)) { }
+			Name(std::string_view str) : _id(str.empty() ? NAME_NONE_ID : NameTable::get_instance()->intern(str)) { }
+			// Skips hashing, used by names of string literals that have been hashed at compile time
+			Name(std::string_view str, uint64_t hash) : _id(str.empty() ? NAME_NONE_ID : NameTable::get_instance()->intern(str, hash)) { }
+
+			// Returns none Name if the string has not been interned, does not add the string to the table
+			static Name find(std::string_view str)
+			{
+				Name name;
+				if (!str.empty())
+					name._id = NameTable::get_instance()->find(str);
+				return name;
+			}
+
+			FORCE_INLINE uint32_t get_id() const { return _id; }
+			FORCE_INLINE bool is_none() const { return _id == NAME_NONE_ID; }
+
+			const char* c_str() const
+			{
+				return is_none() ? "" : NameTable::get_instance()->get_entry(_id).str;
+			}
+
+			std::string_view get_string_view() const
+			{
+				if (is_none())
+					return std::string_view();
+				const NameEntry& entry = NameTable::get_instance()->get_entry(_id);
+				return std::string_view(entry.str, entry.length);
+			}
+
+			std::string to_string() const
+			{
+				return std::string(get_string_view());
+			}
+
+			// Stable string hash, unlike ID it does not depend on the interning order
+			uint64_t get_hash() const
+			{
+				return is_none() ? 0 : NameTable::get_instance()->get_entry(_id).hash;
+			}
+
+			FORCE_INLINE bool operator==(const Name& other) const { return _id == other._id; }
+			FORCE_INLINE bool operator!=(const Name& other) const { return _id != other._id; }
+			FORCE_INLINE bool operator<(const Name& other) const { return _id < other._id; }
+
+		private:
+			uint32_t _id{ NAME_NONE_ID };
+	};
+}
+
+namespace std
+{
+	template<>
+	struct hash<ad_astris::Name>
+	{
+		size_t operator()(const ad_astris::Name& name) const
+		{
+			return name.get_id();
+		}
+	};
+}
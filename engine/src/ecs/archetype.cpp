@@ -1,5 +1,6 @@
 #include "archetype.h"
 #include "profiler/logger.h"
+#include "core/memory_tracker.h"
 
 #include <cstdlib>
 
@@ -8,6 +9,7 @@ using namespace ad_astris;
 ecs::ArchetypeChunk::ArchetypeChunk(uint32_t chunkSize, ChunkStructure& chunkStructure) : _chunkSize(chunkSize)
 {
 	_chunk = static_cast<uint8_t*>(std::malloc(chunkSize));
+	MemoryTracker::record_allocation(MemoryTag::ECS, chunkSize);
 
 	uint32_t prevSubchunkSizes = 0;
 	for (auto& id : chunkStructure.componentIds)
@@ -24,8 +26,32 @@ ecs::ArchetypeChunk::ArchetypeChunk(uint32_t chunkSize, ChunkStructure& chunkStr
 
 ecs::ArchetypeChunk::~ArchetypeChunk()
 {
-	if (_chunkSize)
-		std::free(_chunk);
+	free_chunk();
+}
+
+ecs::ArchetypeChunk::ArchetypeChunk(ArchetypeChunk&& other) noexcept
+	: _chunk(other._chunk), _componentIdToSubchunk(std::move(other._componentIdToSubchunk)),
+	_chunkSize(other._chunkSize), _elementsCount(other._elementsCount)
+{
+	other._chunk = nullptr;
+	other._chunkSize = 0;
+	other._elementsCount = 0;
+}
+
+ecs::ArchetypeChunk& ecs::ArchetypeChunk::operator=(ArchetypeChunk&& other) noexcept
+{
+	if (this != &other)
+	{
+		free_chunk();
+		_chunk = other._chunk;
+		_componentIdToSubchunk = std::move(other._componentIdToSubchunk);
+		_chunkSize = other._chunkSize;
+		_elementsCount = other._elementsCount;
+		other._chunk = nullptr;
+		other._chunkSize = 0;
+		other._elementsCount = 0;
+	}
+	return *this;
 }
 
 void ecs::ArchetypeChunk::add_several_instances(uint32_t count)
@@ -38,7 +64,7 @@ void ecs::ArchetypeChunk::remove_several_instances(uint32_t count)
 	if (_elementsCount - count <= 0)
 	{
 		_elementsCount = 0;
-		std::free(_chunk);
+		free_chunk();
 	}
 	else
 	{
@@ -89,6 +115,17 @@ uint8_t* ecs::ArchetypeChunk::get_entity_component(uint32_t column, uint64_t com
 	return subchunk.get_ptr() + column * subchunk.get_structure_size(); 
 }
 
+void ecs::ArchetypeChunk::free_chunk()
+{
+	if (!_chunk)
+		return;
+	
+	std::free(_chunk);
+	MemoryTracker::record_free(MemoryTag::ECS, _chunkSize);
+	_chunk = nullptr;
+	_chunkSize = 0;
+}
+
 ecs::Archetype::Archetype(ArchetypeCreationContext& context)
 {
 	_chunkStructure.sizeOfOneColumn = context._allComponentsSize;
@@ -3,8 +3,8 @@
 #include "archetype_types.h"
 #include "entity_types.h"
 #include "core/tuple.h"
+#include "core/flat_hash_map.h"
 #include <vector>
-#include <unordered_set>
 
 namespace ad_astris::ecs
 {
@@ -47,9 +47,9 @@ namespace ad_astris::ecs
 	struct ChunkStructure
 	{
 		std::vector<uint64_t> componentIds;
-		std::unordered_map<uint64_t, uint32_t> sizeByComponentID;	// should be sorted
+		FlatHashMap<uint64_t, uint32_t> sizeByComponentID;
 		std::vector<uint64_t> tagIDs;
-		std::unordered_set<uint64_t> tagIDsSet;
+		FlatHashSet<uint64_t> tagIDsSet;
 		uint32_t numEntitiesPerChunk{ 0 };
 		uint32_t sizeOfOneColumn{ 0 };
 	};
@@ -59,6 +59,11 @@ namespace ad_astris::ecs
 		public:
 			ArchetypeChunk(uint32_t chunkSize, ChunkStructure& chunkStructure);
 			~ArchetypeChunk();
+			// Chunks own raw memory, so copying would lead to double free when std::vector reallocates
+			ArchetypeChunk(const ArchetypeChunk&) = delete;
+			ArchetypeChunk& operator=(const ArchetypeChunk&) = delete;
+			ArchetypeChunk(ArchetypeChunk&& other) noexcept;
+			ArchetypeChunk& operator=(ArchetypeChunk&& other) noexcept;
 		
 			void add_several_instances(uint32_t count);
 			void remove_several_instances(uint32_t count);
@@ -75,9 +80,11 @@ namespace ad_astris::ecs
 
 		private:
 			uint8_t* _chunk{ nullptr };
-			std::unordered_map<uint64_t, Subchunk> _componentIdToSubchunk;
+			FlatHashMap<uint64_t, Subchunk> _componentIdToSubchunk;
 			uint32_t _chunkSize{ 0 };
 			uint32_t _elementsCount{ 0 };
+
+			void free_chunk();
 	};
 
 	class Archetype
@@ -187,7 +194,7 @@ namespace ad_astris::ecs
 			void* get_component_by_type_id(Entity& entity, uint32_t columnIndex, uint64_t typeID);
 		
 		private:
-			std::unordered_map<Entity, uint16_t> _entityToChunk;
+			FlatHashMap<Entity, uint16_t> _entityToChunk;
 			std::vector<ArchetypeChunk> _chunks;
 			std::vector<uint32_t> _freeColumns;
 
@@ -53,7 +53,7 @@ namespace ad_astris::ecs
 			}
 			
 		protected:
-			std::unordered_map<uint64_t, uint32_t> _sizeByComponentID;
+			FlatHashMap<uint64_t, uint32_t> _sizeByComponentID;
 			uint32_t _allComponentsSize{ 0 };
 			uint32_t _entityCount{ 1024 };
 			std::vector<uint64_t> _componentIDs;
@@ -27,7 +27,7 @@ ArchetypeHandle EntityManager::create_archetype(ArchetypeCreationContext& contex
 	
 	Archetype archetype(context);
 	uint32_t archetypeId = _archetypes.size();
-	_archetypes.push_back(archetype);
+	_archetypes.push_back(std::move(archetype));
 	_lastCreatedArchetypes.push_back(archetypeId);
 	_componentsHashToArchetypeId[mainHash] = archetypeId;
 
@@ -78,7 +78,7 @@ ArchetypeHandle EntityManager::create_archetype(ArchetypeExtensionContext& conte
 
 	Archetype newArchetype{ creationContext };
 	uint32_t newArchetypeId = _archetypes.size();
-	_archetypes.push_back(newArchetype);
+	_archetypes.push_back(std::move(newArchetype));
 	_lastCreatedArchetypes.push_back(newArchetypeId);
 	_componentsHashToArchetypeId[newHash] = newArchetypeId;
 
@@ -4,8 +4,8 @@
 #include "archetype_types.h"
 #include "archetype.h"
 #include "core/serialization.h"
+#include "core/flat_hash_map.h"
 #include <vector>
-#include <unordered_map>
 #include <mutex>
 
 namespace ad_astris::ecs
@@ -246,8 +246,8 @@ namespace ad_astris::ecs
 		
 			std::vector<Archetype> _archetypes;
 			std::vector<uint32_t> _lastCreatedArchetypes;
-			std::unordered_map<size_t, uint32_t> _componentsHashToArchetypeId;
-			std::unordered_map<Entity, EntityInArchetypeInfo> _entityToItsInfoInArchetype;
+			FlatHashMap<size_t, uint32_t> _componentsHashToArchetypeId;
+			FlatHashMap<Entity, EntityInArchetypeInfo> _entityToItsInfoInArchetype;
 			std::mutex _archetypeMutex;
 			std::mutex _entityMutex;
 			std::mutex _componentMutex;
@@ -5,7 +5,6 @@
 
 #include <vector>
 #include <functional>
-#include <unordered_map>
 
 namespace ad_astris::ecs
 {
@@ -32,7 +31,7 @@ namespace ad_astris::ecs
 			}
 
 		protected:
-			std::unordered_map<uint64_t, ComponentAccess> _componentIDToAccess;
+			FlatHashMap<uint64_t, ComponentAccess> _componentIDToAccess;
 			std::vector<uint64_t> _requiredComponentIDs;
 			std::vector<uint64_t> _requiredTagIDs;
 	};
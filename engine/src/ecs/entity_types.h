@@ -4,6 +4,7 @@
 #include "engine_core/uuid.h"
 #include "profiler/logger.h"
 #include "type_info_table.h"
+#include "core/flat_hash_map.h"
 
 #include <unordered_map>
 #include <vector>
@@ -311,7 +312,7 @@ namespace ad_astris::ecs
 			uint32_t _allComponentsSize{ 0 };
 			std::vector<uint64_t> _componentIDs;
 			std::unordered_map<uint64_t, std::unique_ptr<IComponent>> _componentsMap;
-			std::unordered_map<uint64_t, uint32_t> _sizeByTypeID;
+			FlatHashMap<uint64_t, uint32_t> _sizeByTypeID;
 			std::vector<uint64_t> _tagIDs;
 
 			bool check_component(uint64_t id, uint32_t size)
@@ -6,9 +6,9 @@
 #include "profiler/logger.h"
 #include "core/reflection.h"
 #include "core/array_view.h"
+#include "core/flat_hash_map.h"
 
 #include <vector>
-#include <unordered_map>
 
 namespace ad_astris::ecs
 {
@@ -21,7 +21,7 @@ namespace ad_astris::ecs
 	class ExecutionContext
 	{
 		public:
-			ExecutionContext(Archetype* archetype, std::unordered_map<uint64_t, ComponentAccess>& accessByComponentID);
+			ExecutionContext(Archetype* archetype, FlatHashMap<uint64_t, ComponentAccess>& accessByComponentID);
 		
 			template<typename T>
 			ConstArrayView<T> get_immutable_components()
@@ -83,8 +83,8 @@ namespace ad_astris::ecs
 			uint32_t get_entities_count();
 
 		private:
-			std::unordered_map<uint64_t, ComponentAccess>& _accessByComponentID;
-			std::unordered_map<uint64_t, std::vector<Subchunk>> _loadedSubchunks;
+			FlatHashMap<uint64_t, ComponentAccess>& _accessByComponentID;
+			FlatHashMap<uint64_t, std::vector<Subchunk>> _loadedSubchunks;
 			Archetype* _archetype;
 			uint32_t _chunkIndex{ 0 };
 
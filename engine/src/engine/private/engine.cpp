@@ -40,15 +40,25 @@ void Engine::init(EngineInitializationContext& engineInitContext)
 
 void Engine::execute()
 {
+	FRAME_SCRATCH_ALLOCATOR()->begin_frame();
 	profiler::Profiler::begin_cpu_frame();
-	_resourceLoader->load_new_resources();
-	_engineObjectsCreator->create_new_objects();
-	pre_update();
-	SYSTEM_MANAGER()->execute();
-	renderer::DrawContext drawContext;
-	drawContext.activeCamera = _activeCamera;
-	drawContext.deltaTime = 0.0f;	// TODO
-	_renderer->draw(drawContext);
+	{
+		PROFILER_SCOPE_CATEGORY("Resource loading", profiler::ScopeCategory::RESOURCES);
+		_resourceLoader->load_new_resources();
+		_engineObjectsCreator->create_new_objects();
+		pre_update();
+	}
+	{
+		PROFILER_SCOPE_CATEGORY("Systems", profiler::ScopeCategory::ECS);
+		SYSTEM_MANAGER()->execute();
+	}
+	{
+		PROFILER_SCOPE_CATEGORY("Renderer", profiler::ScopeCategory::RENDERER);
+		renderer::DrawContext drawContext;
+		drawContext.activeCamera = _activeCamera;
+		drawContext.deltaTime = 0.0f;	// TODO
+		_renderer->draw(drawContext);
+	}
 	profiler::Profiler::end_frame();
 }
 
@@ -67,6 +77,9 @@ void Engine::init_global_objects()
 {	
 	GlobalObjects::init_task_composer();
 	LOG_INFO("Engine::init(): Initialized TaskComposer")
+
+	GlobalObjects::init_async_io_service();
+	LOG_INFO("Engine::init(): Initialized AsyncIOService")
 	
 	GlobalObjects::init_resource_manager();
 	LOG_INFO("Engine::init(): Initialized ResourceManager")
@@ -86,6 +99,7 @@ void Engine::init_global_objects()
 
 	GlobalObjects::init_profiler_instance();
 	profiler::Profiler::init(PROFILER_INSTANCE());
+	profiler::Serializer::init(PROFILER_INSTANCE(), FILE_SYSTEM());
 	LOG_INFO("Engine::init(): Initialized Profiler.")
 }
 
@@ -99,6 +113,7 @@ void Engine::init_renderer(EngineInitializationContext& engineInitContext)
 	_renderer = rendererModule->get_renderer();
 	_renderer->init(rendererInitContext);
 	PROFILER_INSTANCE()->set_rhi(_renderer->get_rhi());
+	PROFILER_INSTANCE()->set_frame_scratch_allocator(FRAME_SCRATCH_ALLOCATOR());
 	LOG_INFO("Engine::init(): Loaded and initialized Renderer module")
 }
 
@@ -15,7 +15,12 @@ namespace ad_astris::ecore
 			Sound() = default;
 			Sound(const SoundInfo& info, ObjectName* name);
 
-			void set_info(const SoundInfo& info) { _info = info; }
+			void set_info(const SoundInfo& info)
+			{
+				_isDirty = true;
+				_info = info;
+			}
+
 			const SoundInfo& get_info() const { return _info; }
 
 			void serialize(io::File* file) override;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <stdint.h>
+
+namespace ad_astris::ecore
+{
+	constexpr uint32_t BINARY_METADATA_MAGIC = 0x4D424141;			// "AABM", JSON metadata starts with '{'
+
+	// Starts the fixed-layout header of every binary metadata. Fields are only appended to headers, so a reader
+	// copies as many bytes as the file has and keeps default values of fields that were added later.
+	// Variable-size data follows the header
+	struct BinaryMetadataHeader
+	{
+		uint32_t magic{ BINARY_METADATA_MAGIC };
+		uint16_t version{ 0 };
+		uint16_t headerSize{ 0 };
+	};
+
+	class BinaryMetadataWriter
+	{
+		public:
+			BinaryMetadataWriter(std::string& outMetadata) : _metadata(outMetadata)
+			{
+				_metadata.clear();
+			}
+
+			// Header type must start with BinaryMetadataHeader
+			template<typename Header>
+			void write_header(Header header, uint16_t version)
+			{
+				static_assert(std::is_trivially_copyable_v<Header>);
+				header.base = BinaryMetadataHeader{ BINARY_METADATA_MAGIC, version, static_cast<uint16_t>(sizeof(Header)) };
+				write(&header, sizeof(Header));
+			}
+
+			template<typename T>
+			void write_array(const T* data, uint32_t count)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				write(data, sizeof(T) * count);
+			}
+
+			void write_string(const std::string& str)
+			{
+				uint32_t size = str.size();
+				write(&size, sizeof(uint32_t));
+				write(str.data(), size);
+			}
+
+		private:
+			std::string& _metadata;
+
+			void write(const void* data, size_t size)
+			{
+				_metadata.append(static_cast<const char*>(data), size);
+			}
+	};
+
+	// Reads the metadata in place, values are copied with memcpy, so the metadata doesn't have to be aligned
+	class BinaryMetadataReader
+	{
+		public:
+			BinaryMetadataReader(const std::string& metadata) : _metadata(metadata) { }
+
+			static bool is_binary_metadata(const std::string& metadata)
+			{
+				uint32_t magic = 0;
+				if (metadata.size() < sizeof(BinaryMetadataHeader))
+					return false;
+				memcpy(&magic, metadata.data(), sizeof(uint32_t));
+				return magic == BINARY_METADATA_MAGIC;
+			}
+
+			// Returns false if the metadata is not binary, its version is newer than maxVersion or it is truncated
+			template<typename Header>
+			bool read_header(Header& outHeader, uint16_t maxVersion)
+			{
+				static_assert(std::is_trivially_copyable_v<Header>);
+				BinaryMetadataHeader base;
+				if (!is_binary_metadata(_metadata))
+					return false;
+				memcpy(&base, _metadata.data(), sizeof(BinaryMetadataHeader));
+				if (base.version > maxVersion || base.headerSize < sizeof(BinaryMetadataHeader) || base.headerSize > _metadata.size())
+					return false;
+
+				memcpy(&outHeader, _metadata.data(), std::min<size_t>(base.headerSize, sizeof(Header)));
+				_offset = base.headerSize;
+				return true;
+			}
+
+			template<typename T>
+			bool read_array(T* outData, uint32_t count)
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				return read(outData, sizeof(T) * count);
+			}
+
+			bool read_string(std::string& outString)
+			{
+				uint32_t size = 0;
+				if (!read(&size, sizeof(uint32_t)) || size > _metadata.size() - _offset)
+					return false;
+				outString.assign(_metadata.data() + _offset, size);
+				_offset += size;
+				return true;
+			}
+
+		private:
+			const std::string& _metadata;
+			size_t _offset{ 0 };
+
+			bool read(void* outData, size_t size)
+			{
+				if (size > _metadata.size() - _offset)
+					return false;
+				memcpy(outData, _metadata.data() + _offset, size);
+				_offset += size;
+				return true;
+			}
+	};
+}
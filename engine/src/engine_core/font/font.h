@@ -21,7 +21,12 @@ namespace ad_astris::ecore
 			Font() = default;
 			Font(const FontInfo& info, ObjectName* name);
 
-			void set_info(const FontInfo& info) { _info = info; }
+			void set_info(const FontInfo& info)
+			{
+				_isDirty = true;
+				_info = info;
+			}
+
 			const FontInfo& get_info() const { return _info; }
 
 			void serialize(io::File* file) override;
@@ -20,7 +20,12 @@ namespace ad_astris::ecore
 			Material() = default;
 			Material(const MaterialInfo& info, ObjectName* name);
 
-			void set_info(const MaterialInfo& info) { _info = info; }
+			void set_info(const MaterialInfo& info)
+			{
+				_isDirty = true;
+				_info = info;
+			}
+
 			const MaterialInfo& get_info() const { return _info; }
 
 			void serialize(io::File* file) override;
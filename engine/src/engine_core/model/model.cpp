@@ -1,7 +1,7 @@
 ﻿#include "model.h"
 #include "profiler/logger.h"
-#include "core/constants.h"
 #include "core/custom_objects_to_json.h"
+#include "engine_core/binary_metadata.h"
 #include <json/json.hpp>
 
 using namespace ad_astris;
@@ -25,107 +25,201 @@ constexpr const char* ATLAS_OFFSET_KEY = "atlas_offset";
 constexpr const char* COLORS_OFFSET_KEY = "colors_offset";
 constexpr const char* WIND_WEIGHTS_KEY = "wind_weights_offset";
 
+constexpr uint16_t MODEL_METADATA_VERSION = 1;
+constexpr uint64_t INVALID_BLOB_OFFSET = ~0ull;
+
+// Followed by meshes, the original file and material names
+struct ModelMetadataHeader
+{
+	BinaryMetadataHeader base;
+	uint64_t uuid{ 0 };
+	uint64_t vertexCount{ 0 };
+	uint64_t indexCount{ 0 };
+	uint64_t uvSet0Offset{ INVALID_BLOB_OFFSET };
+	uint64_t uvSet1Offset{ INVALID_BLOB_OFFSET };
+	uint64_t boneIndicesOffset{ INVALID_BLOB_OFFSET };
+	uint64_t boneWeightsOffset{ INVALID_BLOB_OFFSET };
+	uint64_t atlasOffset{ INVALID_BLOB_OFFSET };
+	uint64_t colorsOffset{ INVALID_BLOB_OFFSET };
+	uint64_t windWeightsOffset{ INVALID_BLOB_OFFSET };
+	XMFLOAT3 sphereBoundsOrigin{ 0.0f, 0.0f, 0.0f };
+	float sphereBoundsRadius{ 1.0f };
+	uint32_t meshCount{ 0 };
+	uint32_t materialNameCount{ 0 };
+};
+
+static_assert(sizeof(ModelMetadataHeader) == 112);
+
 template<typename T>
-size_t get_byte_size(const std::vector<T>& vec)
+size_t get_byte_size(const ConstArrayView<T>& view)
 {
-	return vec.size() * sizeof(T);
+	return view.size() * sizeof(T);
 }
 
 template<typename T>
-void add_data_to_blob(uint8_t* dstBlob, const std::vector<T>& src, uint64_t& offset)
+void add_data_to_blob(uint8_t* dstBlob, const ConstArrayView<T>& src, uint64_t& offset)
 {
 	memcpy(dstBlob + offset, src.data(), get_byte_size(src));
 	offset += get_byte_size(src);
 }
 
+// Returns false if the array is out of the blob
+template<typename T>
+bool get_view_from_blob(const uint8_t* srcBlob, uint64_t blobSize, ConstArrayView<T>& dst, uint64_t count, uint64_t offset)
+{
+	if (offset == INVALID_BLOB_OFFSET)
+		return true;
+	if (offset > blobSize || count > (blobSize - offset) / sizeof(T))
+		return false;
+	dst = ConstArrayView<T>(reinterpret_cast<const T*>(srcBlob + offset), count);
+	return true;
+}
+
 template<typename T>
-uint64_t get_data_from_blob(uint8_t* srcBlob, std::vector<T>& dst, uint64_t vertexCount, uint64_t offset)
+ConstArrayView<T> get_view(const std::vector<T>& vec)
+{
+	return ConstArrayView<T>(vec.data(), vec.size());
+}
+
+template<typename T>
+void copy_view(const ConstArrayView<T>& src, std::vector<T>& dst)
+{
+	dst.assign(src.data(), src.data() + src.size());
+}
+
+bool read_binary_metadata(const std::string& metadata, ModelMetadataHeader& outHeader, ModelInfo& outModelInfo)
 {
-	dst.resize(vertexCount);
-	memcpy(dst.data(), srcBlob + offset, vertexCount * sizeof(T));
-	return offset + vertexCount * sizeof(T);
+	BinaryMetadataReader reader(metadata);
+	if (!reader.read_header(outHeader, MODEL_METADATA_VERSION))
+		return false;
+
+	outModelInfo.meshes.resize(outHeader.meshCount);
+	outModelInfo.materialNames.resize(outHeader.materialNameCount);
+	if (!reader.read_array(outModelInfo.meshes.data(), outHeader.meshCount) || !reader.read_string(outModelInfo.originalFile))
+		return false;
+	for (auto& materialName : outModelInfo.materialNames)
+	{
+		if (!reader.read_string(materialName))
+			return false;
+	}
+	return true;
+}
+
+// Models that were saved before binary metadata
+bool read_json_metadata(const std::string& metadata, ModelMetadataHeader& outHeader, ModelInfo& outModelInfo)
+{
+	nlohmann::json metadataJson = nlohmann::json::parse(metadata, nullptr, false);
+	if (metadataJson.is_discarded())
+		return false;
+
+	outHeader.uuid = metadataJson[UUID_KEY].get<uint64_t>();
+	outHeader.vertexCount = metadataJson[VERTEX_COUNT_KEY];
+	outHeader.indexCount = metadataJson[INDEX_COUNT_KEY];
+	outHeader.sphereBoundsOrigin = metadataJson[SPHERE_BOUNDS_ORIGIN_KEY];
+	outHeader.sphereBoundsRadius = metadataJson[SPHERE_BOUNDS_RADIUS_KEY];
+	outModelInfo.originalFile = metadataJson[ORIGINAL_FILE_KEY];
+	outModelInfo.materialNames = metadataJson[MATERIAL_NAMES_KEY].get<std::vector<std::string>>();
+
+	for (auto& pair : metadataJson[MESHES_KEY].items())
+	{
+		ModelInfo::Mesh& mesh = outModelInfo.meshes.emplace_back();
+		nlohmann::json& meshJson = pair.value();
+		mesh.indexCount = meshJson[INDEX_COUNT_KEY];
+		mesh.indexOffset = meshJson[INDEX_OFFSET_KEY];
+		mesh.materialIndex = meshJson[MATERIAL_INDEX_KEY];
+	}
+
+	std::pair<const char*, uint64_t*> offsets[] = {
+		{ UV_SET0_OFFSET_KEY, &outHeader.uvSet0Offset },
+		{ UV_SET1_OFFSET_KEY, &outHeader.uvSet1Offset },
+		{ BONE_INDICES_OFFSET_KEY, &outHeader.boneIndicesOffset },
+		{ BONE_WEIGHTS_OFFSET_KEY, &outHeader.boneWeightsOffset },
+		{ ATLAS_OFFSET_KEY, &outHeader.atlasOffset },
+		{ COLORS_OFFSET_KEY, &outHeader.colorsOffset },
+		{ WIND_WEIGHTS_KEY, &outHeader.windWeightsOffset } };
+	for (auto& [key, offset] : offsets)
+	{
+		if (metadataJson.contains(key))
+			*offset = metadataJson[key];
+	}
+	return true;
 }
 
 Model::Model(const ModelInfo& modelInfo, ObjectName* name) : _modelInfo(modelInfo)
 {
 	_name = name;
+	update_data_view();
 }
 
 void Model::serialize(io::File* file)
 {
-	if (_modelInfo.indices.empty() && _modelInfo.vertexPositions.empty() && _modelInfo.vertexNormals.empty() && _modelInfo.vertexTangents.empty())
+	if (!_dataView.indices.size() && !_dataView.vertexPositions.size() && !_dataView.vertexNormals.size() && !_dataView.vertexTangents.size())
 	{
 		LOG_ERROR("Model::serialize(): Failed to serialize model because it does not have indices, positions, normals and tangents.")
 		return;
 	}
 	
-	nlohmann::json metadata;
-	metadata[UUID_KEY] = _uuid;
-	metadata[ORIGINAL_FILE_KEY] = _modelInfo.originalFile;
-	metadata[VERTEX_COUNT_KEY] = _modelInfo.vertexPositions.size();
-	metadata[INDEX_COUNT_KEY] = _modelInfo.indices.size();
-	metadata[MATERIAL_NAMES_KEY] = _modelInfo.materialNames;
-	metadata[SPHERE_BOUNDS_ORIGIN_KEY] = _modelInfo.sphereBounds.origin;
-	metadata[SPHERE_BOUNDS_RADIUS_KEY] = _modelInfo.sphereBounds.radius;
-
-	nlohmann::json meshesJson;
-	size_t meshCounter = 0;
-	for (auto& mesh : _modelInfo.meshes)
-	{
-		nlohmann::json meshJson;
-		meshJson[INDEX_COUNT_KEY] = mesh.indexCount;
-		meshJson[INDEX_OFFSET_KEY] = mesh.indexOffset;
-		meshJson[MATERIAL_INDEX_KEY] = mesh.materialIndex;
-		meshesJson["mesh" + std::to_string(meshCounter++)] = meshJson;
-	}
-	metadata[MESHES_KEY] = meshesJson;
+	ModelMetadataHeader header;
+	header.uuid = _uuid;
+	header.vertexCount = _dataView.vertexPositions.size();
+	header.indexCount = _dataView.indices.size();
+	header.sphereBoundsOrigin = _modelInfo.sphereBounds.origin;
+	header.sphereBoundsRadius = _modelInfo.sphereBounds.radius;
+	header.meshCount = _modelInfo.meshes.size();
+	header.materialNameCount = _modelInfo.materialNames.size();
 	
 	uint64_t offset = 0;
 	const uint64_t blobSize = get_size();
 	uint8_t* blob = new uint8_t[blobSize];
-	add_data_to_blob(blob, _modelInfo.indices, offset);
-	add_data_to_blob(blob, _modelInfo.vertexPositions, offset);
-	add_data_to_blob(blob, _modelInfo.vertexNormals, offset);
-	add_data_to_blob(blob, _modelInfo.vertexTangents, offset);
+	add_data_to_blob(blob, _dataView.indices, offset);
+	add_data_to_blob(blob, _dataView.vertexPositions, offset);
+	add_data_to_blob(blob, _dataView.vertexNormals, offset);
+	add_data_to_blob(blob, _dataView.vertexTangents, offset);
 	
-	if (!_modelInfo.vertexUVSet0.empty())
+	if (_dataView.vertexUVSet0.size())
 	{
-		metadata[UV_SET0_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexUVSet0, offset);
+		header.uvSet0Offset = offset;
+		add_data_to_blob(blob, _dataView.vertexUVSet0, offset);
 	}
-	if (!_modelInfo.vertexUVSet1.empty())
+	if (_dataView.vertexUVSet1.size())
 	{
-		metadata[UV_SET1_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexUVSet1, offset);
+		header.uvSet1Offset = offset;
+		add_data_to_blob(blob, _dataView.vertexUVSet1, offset);
 	}
-	if (!_modelInfo.vertexBoneIndices.empty())
+	if (_dataView.vertexBoneIndices.size())
 	{
-		metadata[BONE_INDICES_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexBoneIndices, offset);
+		header.boneIndicesOffset = offset;
+		add_data_to_blob(blob, _dataView.vertexBoneIndices, offset);
 	}
-	if (!_modelInfo.vertexBoneWeights.empty())
+	if (_dataView.vertexBoneWeights.size())
 	{
-		metadata[BONE_WEIGHTS_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexBoneWeights, offset);
+		header.boneWeightsOffset = offset;
+		add_data_to_blob(blob, _dataView.vertexBoneWeights, offset);
 	}
-	if (!_modelInfo.vertexAtlas.empty())
+	if (_dataView.vertexAtlas.size())
 	{
-		metadata[ATLAS_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexAtlas, offset);
+		header.atlasOffset = offset;
+		add_data_to_blob(blob, _dataView.vertexAtlas, offset);
 	}
-	if (!_modelInfo.vertexColors.empty())
+	if (_dataView.vertexColors.size())
 	{
-		metadata[COLORS_OFFSET_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexColors, offset);
+		header.colorsOffset = offset;
+		add_data_to_blob(blob, _dataView.vertexColors, offset);
 	}
-	if (!_modelInfo.vertexWindWeights.empty())
+	if (_dataView.vertexWindWeights.size())
 	{
-		metadata[WIND_WEIGHTS_KEY] = offset;
-		add_data_to_blob(blob, _modelInfo.vertexWindWeights, offset);
+		header.windWeightsOffset = offset;
+		add_data_to_blob(blob, _dataView.vertexWindWeights, offset);
 	}
 	
+	BinaryMetadataWriter writer(file->get_metadata());
+	writer.write_header(header, MODEL_METADATA_VERSION);
+	writer.write_array(_modelInfo.meshes.data(), header.meshCount);
+	writer.write_string(_modelInfo.originalFile);
+	for (auto& materialName : _modelInfo.materialNames)
+		writer.write_string(materialName);
+	
 	file->set_binary_blob(blob, blobSize);
-	file->set_metadata(metadata.dump(JSON_INDENT));
 }
 
 void Model::deserialize(io::File* file, ObjectName* objectName)
@@ -133,62 +227,103 @@ void Model::deserialize(io::File* file, ObjectName* objectName)
 	_path = file->get_file_path();
 	_name = objectName;
 
-	nlohmann::json metadata = nlohmann::json::parse(file->get_metadata());
-	_uuid = metadata[UUID_KEY];
-	_modelInfo.originalFile = metadata[ORIGINAL_FILE_KEY];
-	_modelInfo.materialNames = metadata[MATERIAL_NAMES_KEY].get<std::vector<std::string>>();
-	_modelInfo.sphereBounds.origin = metadata[SPHERE_BOUNDS_ORIGIN_KEY];
-	_modelInfo.sphereBounds.radius = metadata[SPHERE_BOUNDS_RADIUS_KEY];
+	ModelMetadataHeader header;
+	const std::string& metadata = file->get_metadata();
+	bool isRead = BinaryMetadataReader::is_binary_metadata(metadata)
+		? read_binary_metadata(metadata, header, _modelInfo)
+		: read_json_metadata(metadata, header, _modelInfo);
+	if (!isRead)
+	{
+		LOG_ERROR("Model::deserialize(): Metadata of {} is invalid or has unsupported version", _path.c_str())
+		return;
+	}
+
+	_uuid = header.uuid;
+	_modelInfo.sphereBounds.origin = header.sphereBoundsOrigin;
+	_modelInfo.sphereBounds.radius = header.sphereBoundsRadius;
+
+	// Mandatory arrays are stored one after another from the beginning of the blob
+	const uint8_t* srcBlob = file->get_binary_blob();
+	const uint64_t blobSize = file->get_binary_blob_size();
+	const uint64_t vertexCount = header.vertexCount;
+	const uint64_t positionsOffset = header.indexCount * sizeof(uint32_t);
+	const uint64_t normalsOffset = positionsOffset + vertexCount * sizeof(XMFLOAT3);
+	const uint64_t tangentsOffset = normalsOffset + vertexCount * sizeof(XMFLOAT3);
 
-	nlohmann::json meshesJson = metadata[MESHES_KEY];
-	for (auto& pair : meshesJson.items())
+	ModelDataView blobView;
+	bool isValid = srcBlob
+		&& get_view_from_blob(srcBlob, blobSize, blobView.indices, header.indexCount, 0)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexPositions, vertexCount, positionsOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexNormals, vertexCount, normalsOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexTangents, vertexCount, tangentsOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexUVSet0, vertexCount, header.uvSet0Offset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexUVSet1, vertexCount, header.uvSet1Offset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexBoneIndices, vertexCount, header.boneIndicesOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexBoneWeights, vertexCount, header.boneWeightsOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexAtlas, vertexCount, header.atlasOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexColors, vertexCount, header.colorsOffset)
+		&& get_view_from_blob(srcBlob, blobSize, blobView.vertexWindWeights, vertexCount, header.windWeightsOffset);
+	if (!isValid)
 	{
-		ModelInfo::Mesh& mesh = _modelInfo.meshes.emplace_back();
-		nlohmann::json meshJson = pair.value();
-		mesh.indexCount = meshJson[INDEX_COUNT_KEY];
-		mesh.indexOffset = meshJson[INDEX_OFFSET_KEY];
-		mesh.materialIndex = meshJson[MATERIAL_INDEX_KEY];
+		LOG_ERROR("Model::deserialize(): Vertex data of {} is out of the blob", _path.c_str())
+		return;
 	}
 
-	uint64_t offset = 0;
-	uint8_t* srcBlob = file->get_binary_blob();
-	_modelInfo.indices.resize(metadata[INDEX_COUNT_KEY]);
-	memcpy(_modelInfo.indices.data(), srcBlob, get_byte_size(_modelInfo.indices));
-	offset += get_byte_size(_modelInfo.indices);
-	const uint64_t vertexCount = metadata[VERTEX_COUNT_KEY];
-	offset = get_data_from_blob(srcBlob, _modelInfo.vertexPositions, vertexCount, offset);
-	offset = get_data_from_blob(srcBlob, _modelInfo.vertexNormals, vertexCount, offset);
-	get_data_from_blob(srcBlob, _modelInfo.vertexTangents, vertexCount, offset);
-
-	if (metadata.contains(UV_SET0_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexUVSet0, vertexCount, metadata[UV_SET0_OFFSET_KEY]);
-	if (metadata.contains(UV_SET1_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexUVSet1, vertexCount, metadata[UV_SET1_OFFSET_KEY]);
-	if (metadata.contains(BONE_INDICES_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexBoneIndices, vertexCount, metadata[BONE_INDICES_OFFSET_KEY]);
-	if (metadata.contains(BONE_WEIGHTS_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexBoneWeights, vertexCount, metadata[BONE_WEIGHTS_OFFSET_KEY]);
-	if (metadata.contains(ATLAS_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexAtlas, vertexCount, metadata[ATLAS_OFFSET_KEY]);
-	if (metadata.contains(COLORS_OFFSET_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexColors, vertexCount, metadata[COLORS_OFFSET_KEY]);
-	if (metadata.contains(WIND_WEIGHTS_KEY))
-		get_data_from_blob(srcBlob, _modelInfo.vertexWindWeights, vertexCount, metadata[WIND_WEIGHTS_KEY]);
+	// Data is uploaded to the GPU straight from the blob, so it is not copied to ModelInfo
+	if (file->are_blob_views_enabled())
+	{
+		_blob = file->share_binary_blob();
+		_dataView = blobView;
+		return;
+	}
+
+	copy_view(blobView.indices, _modelInfo.indices);
+	copy_view(blobView.vertexPositions, _modelInfo.vertexPositions);
+	copy_view(blobView.vertexNormals, _modelInfo.vertexNormals);
+	copy_view(blobView.vertexTangents, _modelInfo.vertexTangents);
+	copy_view(blobView.vertexUVSet0, _modelInfo.vertexUVSet0);
+	copy_view(blobView.vertexUVSet1, _modelInfo.vertexUVSet1);
+	copy_view(blobView.vertexBoneIndices, _modelInfo.vertexBoneIndices);
+	copy_view(blobView.vertexBoneWeights, _modelInfo.vertexBoneWeights);
+	copy_view(blobView.vertexAtlas, _modelInfo.vertexAtlas);
+	copy_view(blobView.vertexColors, _modelInfo.vertexColors);
+	copy_view(blobView.vertexWindWeights, _modelInfo.vertexWindWeights);
+	update_data_view();
+}
+
+ModelInfo Model::copy_info() const
+{
+	ModelInfo modelInfo = _modelInfo;
+	if (!has_blob_views())
+		return modelInfo;
+
+	copy_view(_dataView.indices, modelInfo.indices);
+	copy_view(_dataView.vertexPositions, modelInfo.vertexPositions);
+	copy_view(_dataView.vertexNormals, modelInfo.vertexNormals);
+	copy_view(_dataView.vertexTangents, modelInfo.vertexTangents);
+	copy_view(_dataView.vertexUVSet0, modelInfo.vertexUVSet0);
+	copy_view(_dataView.vertexUVSet1, modelInfo.vertexUVSet1);
+	copy_view(_dataView.vertexBoneIndices, modelInfo.vertexBoneIndices);
+	copy_view(_dataView.vertexBoneWeights, modelInfo.vertexBoneWeights);
+	copy_view(_dataView.vertexAtlas, modelInfo.vertexAtlas);
+	copy_view(_dataView.vertexColors, modelInfo.vertexColors);
+	copy_view(_dataView.vertexWindWeights, modelInfo.vertexWindWeights);
+	return modelInfo;
 }
 
 uint64_t Model::get_size()
 {
-	uint64_t size = get_byte_size(_modelInfo.indices);
-	size += get_byte_size(_modelInfo.vertexPositions);
-	size += get_byte_size(_modelInfo.vertexNormals);
-	size += get_byte_size(_modelInfo.vertexTangents);
-	size += get_byte_size(_modelInfo.vertexUVSet0);
-	size += get_byte_size(_modelInfo.vertexUVSet1);
-	size += get_byte_size(_modelInfo.vertexBoneIndices);
-	size += get_byte_size(_modelInfo.vertexBoneWeights);
-	size += get_byte_size(_modelInfo.vertexAtlas);
-	size += get_byte_size(_modelInfo.vertexColors);
-	size += get_byte_size(_modelInfo.vertexWindWeights);
+	uint64_t size = get_byte_size(_dataView.indices);
+	size += get_byte_size(_dataView.vertexPositions);
+	size += get_byte_size(_dataView.vertexNormals);
+	size += get_byte_size(_dataView.vertexTangents);
+	size += get_byte_size(_dataView.vertexUVSet0);
+	size += get_byte_size(_dataView.vertexUVSet1);
+	size += get_byte_size(_dataView.vertexBoneIndices);
+	size += get_byte_size(_dataView.vertexBoneWeights);
+	size += get_byte_size(_dataView.vertexAtlas);
+	size += get_byte_size(_dataView.vertexColors);
+	size += get_byte_size(_dataView.vertexWindWeights);
 	return size;
 }
 
@@ -196,3 +331,18 @@ void Model::accept(resource::IResourceVisitor& resourceVisitor)
 {
 	// TODO
 }
+
+void Model::update_data_view()
+{
+	_dataView.indices = get_view(_modelInfo.indices);
+	_dataView.vertexPositions = get_view(_modelInfo.vertexPositions);
+	_dataView.vertexNormals = get_view(_modelInfo.vertexNormals);
+	_dataView.vertexTangents = get_view(_modelInfo.vertexTangents);
+	_dataView.vertexUVSet0 = get_view(_modelInfo.vertexUVSet0);
+	_dataView.vertexUVSet1 = get_view(_modelInfo.vertexUVSet1);
+	_dataView.vertexBoneIndices = get_view(_modelInfo.vertexBoneIndices);
+	_dataView.vertexBoneWeights = get_view(_modelInfo.vertexBoneWeights);
+	_dataView.vertexAtlas = get_view(_modelInfo.vertexAtlas);
+	_dataView.vertexColors = get_view(_modelInfo.vertexColors);
+	_dataView.vertexWindWeights = get_view(_modelInfo.vertexWindWeights);
+}
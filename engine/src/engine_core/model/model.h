@@ -2,6 +2,9 @@
 
 #include "engine_core/object.h"
 #include "core/math_base.h"
+#include "core/array_view.h"
+#include <cassert>
+#include <memory>
 
 namespace ad_astris::ecore
 {
@@ -41,19 +44,52 @@ namespace ad_astris::ecore
 		std::string originalFile;
 	};
 	
+	// Vertex data of a model. Views point to ModelInfo or to the blob of the resource file if the model has been
+	// loaded with blob views, see io::File::set_blob_views_enabled(). Views are invalidated by Model::set_info()
+	struct ModelDataView
+	{
+		ConstArrayView<uint32_t> indices{ nullptr, 0 };
+		ConstArrayView<XMFLOAT3> vertexPositions{ nullptr, 0 };
+		ConstArrayView<XMFLOAT3> vertexNormals{ nullptr, 0 };
+		ConstArrayView<XMFLOAT4> vertexTangents{ nullptr, 0 };
+		ConstArrayView<XMFLOAT2> vertexUVSet0{ nullptr, 0 };
+		ConstArrayView<XMFLOAT2> vertexUVSet1{ nullptr, 0 };
+		ConstArrayView<XMUINT4> vertexBoneIndices{ nullptr, 0 };
+		ConstArrayView<XMFLOAT4> vertexBoneWeights{ nullptr, 0 };
+		ConstArrayView<XMFLOAT2> vertexAtlas{ nullptr, 0 };
+		ConstArrayView<uint32_t> vertexColors{ nullptr, 0 };
+		ConstArrayView<uint8_t> vertexWindWeights{ nullptr, 0 };
+	};
+	
 	class Model : public Object
 	{
 		public:
 			Model() = default;
 			Model(const ModelInfo& modelInfo, ObjectName* name);
 
+			// The data view can point to ModelInfo of the model, so copies would point to the original
+			Model(const Model&) = delete;
+			Model& operator=(const Model&) = delete;
+
 			void set_info(const ModelInfo& modelInfo)
 			{
 				_isDirty = true;
 				_modelInfo = modelInfo;
+				_blob.reset();
+				update_data_view();
 			}
 		
-			const ModelInfo& get_info() const { return _modelInfo; }
+			// If the model has blob views, vertex data is not copied to ModelInfo and must be read with get_data_view()
+			// or copied with copy_info()
+			const ModelInfo& get_info() const
+			{
+				assert(!has_blob_views());
+				return _modelInfo;
+			}
+			// Vertex arrays are copied from the data view, so it works for models with blob views
+			ModelInfo copy_info() const;
+			const ModelDataView& get_data_view() const { return _dataView; }
+			bool has_blob_views() const { return _blob != nullptr; }
 			SphereBounds& get_sphere_bounds() { return _modelInfo.sphereBounds; }
 			const SphereBounds& get_sphere_bounds() const { return _modelInfo.sphereBounds; }
 		
@@ -72,7 +108,11 @@ namespace ad_astris::ecore
  		
 		private:
 			ModelInfo _modelInfo;
+			ModelDataView _dataView;
+			std::shared_ptr<uint8_t> _blob{ nullptr };
 			UUID _uuid;
+
+			void update_data_view();
 	};
 
 	struct ModelConversionContext
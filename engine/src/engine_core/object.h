@@ -60,6 +60,8 @@ namespace ad_astris::ecore
 			virtual void accept(resource::IResourceVisitor& resourceVisitor) { }
 			bool is_dirty() const { return _isDirty; }
 			void make_dirty() { _isDirty = true; }
+			// Resource tables clear the flag before the resource is serialized, so changes made during a save mark it again
+			void clear_dirty() { _isDirty = false; }
 
 			/** Changes filename in the engine and on disc. 
 			 * @param newName can consist of two types of name. If you pass an absolute path to the file, the engine object will be
@@ -153,7 +153,7 @@ bool ecore::NameIDTable::is_empty()
 	return _table.empty();
 }
 
-std::map<std::string, ecore::NameIDTable> ecore::ObjectName::_nameTable;
+FlatHashMap<Name, ecore::NameIDTable> ecore::ObjectName::_nameTable;
 
 ecore::ObjectName::ObjectName(const char* newName)
 {
@@ -218,7 +218,7 @@ void ecore::ObjectName::change_name(const char* newName)
 		return;
 	}
 	
-	if (!_name.empty())
+	if (!_name.is_none())
 	{
 		delete_name_from_table();
 	}
@@ -239,7 +239,7 @@ void ecore::ObjectName::change_name(const char* newName)
 
 void ecore::ObjectName::change_name(ObjectName& otherName)
 {
-	if (!_name.empty())
+	if (!_name.is_none())
 	{
 		delete_name_from_table();
 	}
@@ -251,12 +251,12 @@ void ecore::ObjectName::change_name(ObjectName& otherName)
 void ecore::ObjectName::destroy_name()
 {
 	delete_name_from_table();
-	_name.clear();
+	_name = Name();
 }
 
 std::string ecore::ObjectName::get_full_name()
 {
-	std::string name = _name;
+	std::string name = _name.to_string();
 	if (_nameID.get_id() > 0)
 		name += "_" + std::to_string(_nameID);
 	return name;
@@ -264,7 +264,7 @@ std::string ecore::ObjectName::get_full_name()
 
 std::string ecore::ObjectName::get_name_without_id()
 {
-	return std::string{_name};
+	return _name.to_string();
 }
 
 ecore::NameID ecore::ObjectName::get_name_id()
@@ -286,7 +286,7 @@ bool ecore::ObjectName::operator==(const ObjectName& name) const
 
 bool ecore::ObjectName::operator<(const ObjectName& name) const
 {
-	return _name < name._name;
+	return _name != name._name && _name.get_string_view() < name._name.get_string_view();
 }
 
 // Have to make improvements to handle more situation
@@ -296,9 +296,7 @@ void ecore::ObjectName::delete_name_from_table()
 
 	if (it != _nameTable.end())
 	{
-		NameIDTable table = it->second;
-		table.remove_id(_nameID);
-		_nameTable[_name] = table;
+		it->second.remove_id(_nameID);
 		if (it->second.is_empty())
 		{
 			//delete[] it->first._name;
@@ -1,7 +1,8 @@
 #pragma once
 
+#include "core/name_table.h"
+#include "core/flat_hash_map.h"
 #include <stdint.h>
-#include <map>
 #include <vector>
 #include <string>
 
@@ -45,7 +46,8 @@ namespace ad_astris::ecore
 	/** Name for engine objects. The name consists of a string + the number of instances of the name. \n 
 	 * \n If count = 0, no number will be added to the name.
 	 * Otherwise, _{instances count} will be appended to the name \n
-	 * \n 128 is maximum name size 
+	 * \n 128 is maximum name size \n
+	 * \n The string is interned, so comparing names compares interned IDs
 	 */
 	class ObjectName
 	{
@@ -63,16 +65,17 @@ namespace ad_astris::ecore
 			std::string get_full_name();
 			std::string get_name_without_id();
 			NameID get_name_id();
+			Name get_interned_name() const { return _name; }
 
 			ObjectName& operator=(const ObjectName& otherName);
 			bool operator==(const ObjectName& name) const;
 			bool operator<(const ObjectName& name) const;
 		
 		private:
-			std::string _name;
+			Name _name;
 			NameID _nameID;
 		
-			static std::map<std::string, NameIDTable> _nameTable;
+			static FlatHashMap<Name, NameIDTable> _nameTable;
 		
 			void delete_name_from_table();
 			void add_new_name_to_table(NameID nameID = 0);
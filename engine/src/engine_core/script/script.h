@@ -20,7 +20,12 @@ namespace ad_astris::ecore
 			Script() = default;
 			Script(const ScriptInfo& info, ObjectName* name);
 
-			void set_info(const ScriptInfo& info) { _info = info; }
+			void set_info(const ScriptInfo& info)
+			{
+				_isDirty = true;
+				_info = info;
+			}
+
 			const ScriptInfo& get_info() const { return _info; }
 
 			void serialize(io::File* file) override;
@@ -1,7 +1,8 @@
 ﻿#include "texture.h"
 #include "rhi/utils.h"
-#include "core/constants.h"
 #include "core/custom_objects_to_json.h"
+#include "core/memory_tracker.h"
+#include "engine_core/binary_metadata.h"
 #include <json/json.hpp>
 
 using namespace ad_astris;
@@ -22,14 +23,64 @@ constexpr const char* BRIGHTNESS_KEY = "brightness";
 constexpr const char* SATURATION_KEY = "saturation";
 constexpr const char* IS_16_BIT_KEY = "is_16_bit";
 
+constexpr uint16_t TEXTURE_METADATA_VERSION = 1;
+
+// Enums are stored by value, so new values must be added to the end of enums
+struct TextureMetadataHeader
+{
+	BinaryMetadataHeader base;
+	uint64_t uuid{ 0 };
+	uint64_t size{ 0 };
+	uint64_t width{ 0 };
+	uint64_t height{ 0 };
+	uint64_t depth{ 0 };
+	texture::MipmapMode mipmapMode{ texture::MipmapMode::BASE_MIPMAPPING };
+	texture::RuntimeCompressionMode runtimeCompressionMode{ texture::RuntimeCompressionMode::DISABLED };
+	rhi::AddressMode tilingX{ rhi::AddressMode::REPEAT };
+	rhi::AddressMode tilingY{ rhi::AddressMode::REPEAT };
+	rhi::Format format{ rhi::Format::UNDEFINED };
+	rhi::ComponentMapping mapping;
+	float brightness{ 1.0f };
+	float saturation{ 1.0f };
+	uint32_t is16Bit{ 0 };
+};
+
+static_assert(sizeof(TextureMetadataHeader) == 96);
+
+// Textures that were saved before binary metadata
+bool read_json_metadata(const std::string& metadata, TextureMetadataHeader& outHeader)
+{
+	nlohmann::json metadataJson = nlohmann::json::parse(metadata, nullptr, false);
+	if (metadataJson.is_discarded())
+		return false;
+
+	outHeader.uuid = metadataJson[UUID_KEY].get<uint64_t>();
+	outHeader.size = metadataJson[SIZE_KEY];
+	outHeader.width = metadataJson[WIDTH_KEY];
+	outHeader.height = metadataJson[HEIGHT_KEY];
+	outHeader.depth = metadataJson[DEPTH_KEY];
+	outHeader.mipmapMode = texture::Utils::get_enum_mipmap_mode(metadataJson[MIPMAP_MODE_KEY]);
+	outHeader.runtimeCompressionMode = texture::Utils::get_enum_runtime_compression(metadataJson[COMPRESSION_MODE_KEY]);
+	outHeader.tilingX = rhi::Utils::get_address_mode_enum(metadataJson[TILING_X_KEY]);
+	outHeader.tilingY = rhi::Utils::get_address_mode_enum(metadataJson[TILING_Y_KEY]);
+	outHeader.format = rhi::Utils::get_format_enum(metadataJson[FORMAT_KEY]);
+	outHeader.mapping = rhi::Utils::get_component_mapping(metadataJson[COMPONENT_MAPPING_KEY]);
+	outHeader.brightness = metadataJson[BRIGHTNESS_KEY];
+	outHeader.saturation = metadataJson[SATURATION_KEY];
+	outHeader.is16Bit = metadataJson[IS_16_BIT_KEY].get<bool>();
+	return true;
+}
+
 Texture::Texture(const TextureInfo& textureInfo, ObjectName* name) : _textureInfo(textureInfo)
 {
 	_name = name;
+	if (_textureInfo.data)
+		MemoryTracker::record_allocation(MemoryTag::RESOURCES, _textureInfo.size);
 }
 
 Texture::~Texture()
 {
-	delete[] _textureInfo.data;
+	destroy_texture_data();
 }
 
 void Texture::serialize(io::File* file)
@@ -42,47 +93,68 @@ void Texture::serialize(io::File* file)
 	uint8_t* blob = new uint8_t[_textureInfo.size];
 	memcpy(blob, _textureInfo.data, _textureInfo.size);
 
-	nlohmann::json metadata;
-	metadata[UUID_KEY] = _uuid;
-	metadata[SIZE_KEY] = _textureInfo.size;
-	metadata[WIDTH_KEY] = _textureInfo.width;
-	metadata[HEIGHT_KEY] = _textureInfo.height;
-	metadata[DEPTH_KEY] = _textureInfo.depth;
-	metadata[MIPMAP_MODE_KEY] = texture::Utils::get_str_mipmap_mode(_textureInfo.mipmapMode);
-	metadata[COMPRESSION_MODE_KEY] = texture::Utils::get_str_runtime_compression(_textureInfo.runtimeCompressionMode);
-	metadata[TILING_X_KEY] = rhi::Utils::get_address_mode_str(_textureInfo.tilingX);
-	metadata[TILING_Y_KEY] = rhi::Utils::get_address_mode_str(_textureInfo.tilingY);
-	metadata[FORMAT_KEY] = rhi::Utils::get_format_str(_textureInfo.format);
-	metadata[COMPONENT_MAPPING_KEY] = rhi::Utils::get_component_mapping_str(_textureInfo.mapping);
-	metadata[BRIGHTNESS_KEY] = _textureInfo.brightness;
-	metadata[SATURATION_KEY] = _textureInfo.saturation;
-	metadata[IS_16_BIT_KEY] = _textureInfo.is16Bit;
+	TextureMetadataHeader header;
+	header.uuid = _uuid;
+	header.size = _textureInfo.size;
+	header.width = _textureInfo.width;
+	header.height = _textureInfo.height;
+	header.depth = _textureInfo.depth;
+	header.mipmapMode = _textureInfo.mipmapMode;
+	header.runtimeCompressionMode = _textureInfo.runtimeCompressionMode;
+	header.tilingX = _textureInfo.tilingX;
+	header.tilingY = _textureInfo.tilingY;
+	header.format = _textureInfo.format;
+	header.mapping = _textureInfo.mapping;
+	header.brightness = _textureInfo.brightness;
+	header.saturation = _textureInfo.saturation;
+	header.is16Bit = _textureInfo.is16Bit;
 
+	BinaryMetadataWriter writer(file->get_metadata());
+	writer.write_header(header, TEXTURE_METADATA_VERSION);
 	file->set_binary_blob(blob, _textureInfo.size);
-	file->set_metadata(metadata.dump(JSON_INDENT));
 }
 
 void Texture::deserialize(io::File* file, ObjectName* objectName)
 {
 	_name = objectName;
 
-	nlohmann::json metadata = nlohmann::json::parse(file->get_metadata());
-	_uuid = metadata[UUID_KEY];
-	_textureInfo.size = metadata[SIZE_KEY];
-	_textureInfo.width = metadata[WIDTH_KEY];
-	_textureInfo.height = metadata[HEIGHT_KEY];
-	_textureInfo.depth = metadata[DEPTH_KEY];
-	_textureInfo.mipmapMode = texture::Utils::get_enum_mipmap_mode(metadata[MIPMAP_MODE_KEY]);
-	_textureInfo.runtimeCompressionMode = texture::Utils::get_enum_runtime_compression(metadata[COMPRESSION_MODE_KEY]);
-	_textureInfo.tilingX = rhi::Utils::get_address_mode_enum(metadata[TILING_X_KEY]);
-	_textureInfo.tilingY = rhi::Utils::get_address_mode_enum(metadata[TILING_Y_KEY]);
-	_textureInfo.format = rhi::Utils::get_format_enum(metadata[FORMAT_KEY]);
-	_textureInfo.mapping = rhi::Utils::get_component_mapping(metadata[COMPONENT_MAPPING_KEY]);
-	_textureInfo.brightness = metadata[BRIGHTNESS_KEY];
-	_textureInfo.saturation = metadata[SATURATION_KEY];
-	_textureInfo.is16Bit = metadata[IS_16_BIT_KEY];
+	TextureMetadataHeader header;
+	const std::string& metadata = file->get_metadata();
+	bool isRead = BinaryMetadataReader::is_binary_metadata(metadata)
+		? BinaryMetadataReader(metadata).read_header(header, TEXTURE_METADATA_VERSION)
+		: read_json_metadata(metadata, header);
+	if (!isRead)
+	{
+		LOG_ERROR("Texture::deserialize(): Metadata of {} is invalid or has unsupported version", file->get_file_path().c_str())
+		return;
+	}
+
+	_uuid = header.uuid;
+	_textureInfo.size = header.size;
+	_textureInfo.width = header.width;
+	_textureInfo.height = header.height;
+	_textureInfo.depth = header.depth;
+	_textureInfo.mipmapMode = header.mipmapMode;
+	_textureInfo.runtimeCompressionMode = header.runtimeCompressionMode;
+	_textureInfo.tilingX = header.tilingX;
+	_textureInfo.tilingY = header.tilingY;
+	_textureInfo.format = header.format;
+	_textureInfo.mapping = header.mapping;
+	_textureInfo.brightness = header.brightness;
+	_textureInfo.saturation = header.saturation;
+	_textureInfo.is16Bit = header.is16Bit;
 	
-	_textureInfo.data = new uint8_t[file->get_binary_blob_size()];
+	destroy_texture_data();
+	_textureInfo.size = file->get_binary_blob_size();
+	// Data is uploaded to the GPU straight from the blob, which stays tracked until its last reference is released
+	if (file->are_blob_views_enabled())
+	{
+		_blob = file->share_binary_blob();
+		_textureInfo.data = _blob.get();
+		return;
+	}
+	_textureInfo.data = new uint8_t[_textureInfo.size];
+	MemoryTracker::record_allocation(MemoryTag::RESOURCES, _textureInfo.size);
 	memcpy(_textureInfo.data, file->get_binary_blob(), file->get_binary_blob_size());
 }
 
@@ -93,15 +165,42 @@ void Texture::accept(resource::IResourceVisitor& resourceVisitor)
 
 void Texture::update_texture(uint8_t* textureData, uint64_t sizeInBytes)
 {
-	delete[] _textureInfo.data;
+	destroy_texture_data();
 
 	_textureInfo.data = new uint8_t[sizeInBytes];
 	_textureInfo.size = sizeInBytes;
+	MemoryTracker::record_allocation(MemoryTag::RESOURCES, _textureInfo.size);
 	memcpy(_textureInfo.data, textureData, sizeInBytes);
+	_isDirty = true;
+}
+
+TextureInfo Texture::detach_info()
+{
+	TextureInfo textureInfo = _textureInfo;
+	if (_blob)
+	{
+		textureInfo.data = new uint8_t[_textureInfo.size];
+		memcpy(textureInfo.data, _textureInfo.data, _textureInfo.size);
+		_blob.reset();
+	}
+	else if (_textureInfo.data)
+	{
+		MemoryTracker::record_free(MemoryTag::RESOURCES, _textureInfo.size);
+	}
+	_textureInfo.data = nullptr;
+	return textureInfo;
 }
 
 void Texture::destroy_texture_data()
 {
+	if (_blob)
+	{
+		_blob.reset();
+		_textureInfo.data = nullptr;
+		return;
+	}
+	if (_textureInfo.data)
+		MemoryTracker::record_free(MemoryTag::RESOURCES, _textureInfo.size);
 	delete[] _textureInfo.data;
 	_textureInfo.data = nullptr;
 }
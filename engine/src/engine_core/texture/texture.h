@@ -3,6 +3,7 @@
 #include "texture_common.h"
 #include "engine_core/object.h"
 #include "rhi/resources.h"
+#include <memory>
 
 namespace ad_astris::ecore
 {
@@ -34,8 +35,22 @@ namespace ad_astris::ecore
 			void update_texture(uint8_t* textureData, uint64_t sizeInBytes);
 			void destroy_texture_data();
 
-			void set_info(const TextureInfo& textureInfo) { _textureInfo = textureInfo; }
+			void set_info(const TextureInfo& textureInfo)
+			{
+				_isDirty = true;
+				if (textureInfo.data != _textureInfo.data)
+					_blob.reset();
+				_textureInfo = textureInfo;
+			}
+
+			// If the texture has a blob view, data points into the blob of the resource file,
+			// see io::File::set_blob_views_enabled()
 			const TextureInfo& get_info() const { return _textureInfo; }
+			bool has_blob_view() const { return _blob != nullptr; }
+
+			// Returns the info and gives up ownership of its data, which is no longer tracked by the texture.
+			// Data of a blob view is copied
+			TextureInfo detach_info();
 		
 			void change_mipmap_mode(texture::MipmapMode mode)
 			{
@@ -89,6 +104,7 @@ namespace ad_astris::ecore
 		
 		private:
 			TextureInfo _textureInfo;
+			std::shared_ptr<uint8_t> _blob{ nullptr };
 			UUID _uuid;
 	};
 }
\ No newline at end of file
@@ -1,20 +1,77 @@
 #include "uuid.h"
 #include <random>
+#include <chrono>
 
 using namespace ad_astris;
 
-static std::random_device sRandomDevice;
-static std::mt19937_64 sRandomEngine(sRandomDevice());
-static std::uniform_int_distribution<uint64_t> sUniformDistribution;
+static std::atomic<uint64_t> g_nextUUIDGeneratorID{ 1 };
 
-UUID::UUID() : _uuid(sUniformDistribution(sRandomEngine))
+UUIDGeneratorInstance::UUIDGeneratorInstance() : _id(g_nextUUIDGeneratorID.fetch_add(1))
 {
-	if (_uuid == 0)
-		_uuid = sUniformDistribution(sRandomEngine);
+	std::random_device randomDevice;
+	_key = (uint64_t(randomDevice()) << 32) ^ randomDevice();
+	// Some implementations of random_device are deterministic
+	_key ^= static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
+
+namespace
+{
+	struct ThreadUUIDStream
+	{
+		const UUIDGeneratorInstance* owner{ nullptr };
+		uint64_t ownerID{ 0 };
+		uint64_t counter{ 0 };
+		uint64_t end{ 0 };
+	};
+
+	thread_local ThreadUUIDStream t_uuidStream;
+
+	inline uint64_t get_next_uuid(UUIDGeneratorInstance* instance, ThreadUUIDStream& stream)
+	{
+		uint64_t uuid = 0;
+		// Zero is used as an invalid UUID
+		while (uuid == 0)
+		{
+			if (stream.owner != instance || stream.ownerID != instance->get_id() || stream.counter == stream.end)
+			{
+				stream.owner = instance;
+				stream.ownerID = instance->get_id();
+				stream.counter = instance->acquire_stream();
+				stream.end = stream.counter + UUIDGeneratorInstance::STREAM_SIZE;
+			}
+			uuid = instance->get_uuid(stream.counter++);
+		}
+		return uuid;
+	}
+}
+
+uint64_t UUIDGenerator::generate()
+{
+	return get_next_uuid(get_instance(), t_uuidStream);
+}
+
+void UUIDGenerator::generate(UUID* uuids, size_t count)
+{
+	UUIDGeneratorInstance* instance = get_instance();
+	ThreadUUIDStream& stream = t_uuidStream;
+	for (size_t i = 0; i != count; ++i)
+		uuids[i] = get_next_uuid(instance, stream);
+}
+
+UUIDGeneratorInstance* UUIDGenerator::get_instance()
+{
+	if (_uuidGeneratorInstance)
+		return _uuidGeneratorInstance;
+	static UUIDGeneratorInstance uuidGeneratorInstance;
+	return &uuidGeneratorInstance;
+}
+
+UUID::UUID() : _uuid(UUIDGenerator::generate())
+{
+
 }
 
 UUID::UUID(uint64_t uuid) : _uuid(uuid)
 {
 	
 }
-
@@ -1,5 +1,7 @@
 #pragma once
+#include "core/non_copyable_non_movable.h"
 #include <stdint.h>
+#include <atomic>
 #include <functional>
 
 namespace ad_astris
@@ -18,6 +20,58 @@ namespace ad_astris
 		private:
 			uint64_t _uuid;
 	};
+
+	// Each thread takes a stream of STREAM_SIZE sequential counters and maps them to UUIDs with a keyed bijective mix,
+	// so generation doesn't need synchronisation and UUIDs from the same instance never collide.
+	// The key is random, so UUIDs from different processes collide only with the probability of random 64-bit numbers.
+	class UUIDGeneratorInstance : public NonCopyableNonMovable
+	{
+		public:
+			UUIDGeneratorInstance();
+
+			uint64_t get_id() const { return _id; }
+
+			uint64_t acquire_stream()
+			{
+				return _nextStream.fetch_add(1, std::memory_order_relaxed) << STREAM_COUNTER_BITS;
+			}
+
+			uint64_t get_uuid(uint64_t counter) const
+			{
+				uint64_t value = counter ^ _key;
+				value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+				value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+				return value ^ (value >> 31);
+			}
+
+			inline static constexpr uint64_t STREAM_COUNTER_BITS = 40;
+			inline static constexpr uint64_t STREAM_SIZE = 1ull << STREAM_COUNTER_BITS;
+
+		private:
+			uint64_t _key{ 0 };
+			uint64_t _id{ 0 };
+			std::atomic<uint64_t> _nextStream{ 0 };
+	};
+
+	// UUIDGeneratorInstance is owned by GlobalObjectContext, so all modules share one key and one stream counter.
+	// Tools and tests that don't create the context use a module-local instance.
+	class UUIDGenerator
+	{
+		public:
+			static void init(UUIDGeneratorInstance* uuidGeneratorInstance)
+			{
+				_uuidGeneratorInstance = uuidGeneratorInstance;
+			}
+
+			static uint64_t generate();
+			// Fills the array with unique UUIDs, faster than generating them one by one
+			static void generate(UUID* uuids, size_t count);
+
+		private:
+			inline static UUIDGeneratorInstance* _uuidGeneratorInstance{ nullptr };
+
+			static UUIDGeneratorInstance* get_instance();
+	};
 }
 
 namespace std
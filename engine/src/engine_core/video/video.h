@@ -15,7 +15,12 @@ namespace ad_astris::ecore
 			Video() = default;
 			Video(const VideoInfo& info, ObjectName* name);
 
-			void set_info(const VideoInfo& info) { _info = info; }
+			void set_info(const VideoInfo& info)
+			{
+				_isDirty = true;
+				_info = info;
+			}
+
 			const VideoInfo& get_info() const { return _info; }
 
 			void serialize(io::File* file) override;
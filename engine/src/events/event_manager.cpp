@@ -37,14 +37,10 @@ void EventManager::unsubscribe(uint64_t eventID, const std::string& eventHandler
 void EventManager::trigger_event(IEvent& event)
 {
 	std::lock_guard<std::mutex> locker(_eventQueueMutex);
-	auto it = _handlersByEventID.find(event.get_type_id());
-	if (it == _handlersByEventID.end())
+	if (_handlersByEventID.find(event.get_type_id()) == _handlersByEventID.end())
 		return;
 
-	for (auto& handler : it->second)
-	{
-		handler->execute(event);
-	}
+	execute_handlers(event);
 	event.cleanup();
 }
 
@@ -53,25 +49,24 @@ void EventManager::dispatch_events()
 	while (!_eventsQueue.empty())
 	{
 		IEvent* event = _eventsQueue.front().get();
-		auto it = _handlersByEventID.find(event->get_type_id());
-		if (it == _handlersByEventID.end())
-		{
-			event->cleanup();
-			_eventsQueue.pop();
-			continue;
-		}
-		
-		auto& handlers = it->second;
-		for (auto& handler : handlers)
-		{
-			handler->execute(*event);
-		}
-
+		execute_handlers(*event);
 		event->cleanup();
 		_eventsQueue.pop();
 	}
 }
 
+void EventManager::execute_handlers(IEvent& event)
+{
+	uint64_t eventID = event.get_type_id();
+	for (size_t i = 0; ; ++i)
+	{
+		auto it = _handlersByEventID.find(eventID);
+		if (it == _handlersByEventID.end() || i >= it->second.size())
+			return;
+		it->second[i]->execute(event);
+	}
+}
+
 
 void EventManagerTests::main_loop()
 {
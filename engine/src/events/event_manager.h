@@ -2,11 +2,13 @@
 
 #include "event_handler.h"
 #include "profiler/logger.h"
+#include "core/frame_scratch_allocator.h"
+#include "core/flat_hash_map.h"
+#include "core/pool_allocator.h"
 
 #include <mutex>
 #include <memory>
 #include <queue>
-#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -46,21 +48,81 @@ namespace ad_astris::events
 		
 			void unsubscribe(uint64_t eventID, const std::string& eventHandlerTypeName);
 
+			// Enqueued events are dispatched at the end of the same frame, so their copies can live in the frame scratch memory
 			template<typename CustomEvent>
 			void enqueue_event(CustomEvent& event)
 			{
+				if (_frameScratchAllocator)
+				{
+					CustomEvent* eventCopy = _frameScratchAllocator->construct<CustomEvent>(event);
+					std::scoped_lock<std::mutex> locker(_eventQueueMutex);
+					_eventsQueue.emplace(eventCopy, EventDeleter{ true });
+					return;
+				}
+				
+				std::scoped_lock<std::mutex> locker(_eventQueueMutex);
+				_eventsQueue.emplace(new CustomEvent(event), EventDeleter{ false });
+			}
+
+			// Events enqueued from worker threads can be dispatched in the next frame, and the frame scratch memory
+			// of the thread can be reset while they are enqueued, so their copies are allocated from a pool of the type
+			template<typename CustomEvent>
+			void enqueue_async_event(CustomEvent& event)
+			{
+				CustomEvent* eventCopy = get_event_pool<CustomEvent>().allocate(event);
 				std::scoped_lock<std::mutex> locker(_eventQueueMutex);
-				_eventsQueue.emplace(new CustomEvent(event));
+				_eventsQueue.emplace(eventCopy, EventDeleter{ false, &free_pool_event<CustomEvent> });
 			}
 		
 			void trigger_event(IEvent& event);
 			void dispatch_events();
+
+			void set_frame_scratch_allocator(FrameScratchAllocator* frameScratchAllocator)
+			{
+				_frameScratchAllocator = frameScratchAllocator;
+			}
 		
 		private:
-			std::queue<std::unique_ptr<IEvent>> _eventsQueue;
+			struct EventDeleter
+			{
+				using FreeFuncPtr = void(*)(IEvent*);
+			
+				bool isScratchMemory{ false };
+				FreeFuncPtr freePoolEvent{ nullptr };
+				
+				void operator()(IEvent* event) const
+				{
+					if (freePoolEvent)
+						freePoolEvent(event);
+					else if (isScratchMemory)
+						event->~IEvent();
+					else
+						delete event;
+				}
+			};
+
+			template<typename CustomEvent>
+			static ThreadSafePoolAllocator<CustomEvent>& get_event_pool()
+			{
+				static ThreadSafePoolAllocator<CustomEvent> eventPool;
+				return eventPool;
+			}
+
+			template<typename CustomEvent>
+			static void free_pool_event(IEvent* event)
+			{
+				get_event_pool<CustomEvent>().free(static_cast<CustomEvent*>(event));
+			}
+		
+			std::queue<std::unique_ptr<IEvent, EventDeleter>> _eventsQueue;
 			std::mutex _eventQueueMutex;
-			std::unordered_map<uint64_t, std::vector<std::unique_ptr<IEventHandler>>> _handlersByEventID;
+			FlatHashMap<uint64_t, std::vector<std::unique_ptr<IEventHandler>>> _handlersByEventID;
 			std::mutex _handlersByEventIDMutex;
+			FrameScratchAllocator* _frameScratchAllocator{ nullptr };
+
+			// Handlers can subscribe while they are executed, which can rehash the map or grow the vector of handlers,
+			// so handlers are looked up again by the event ID and their index
+			void execute_handlers(IEvent& event);
 	};
 
 	class Event1 : public IEvent
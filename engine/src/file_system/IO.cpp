@@ -1,63 +1,270 @@
 #include "IO.h"
 #include "profiler/logger.h"
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <string>
 
 namespace ad_astris
 {
-	io::EngineFileStream::EngineFileStream(FILE* file)
+	io::EngineFileStream::EngineFileStream(NativeFileHandle file, bool isAppend, uint32_t bufferSize)
+		: _file(file), _isAppend(isAppend), _bufferCapacity(std::max(1u, bufferSize))
 	{
-		this->file = file;
-		assert(this->file);
+		_size.store(NativeFile::get_size(_file));
+		if (_isAppend)
+			_position = _size.load();
 	}
 
 	io::EngineFileStream::~EngineFileStream()
 	{
-		assert(file);
-		fclose(file);
-		file = nullptr;
+		flush();
+		NativeFile::close(_file);
 	}
 
 	size_t io::EngineFileStream::read(void* data, size_t size, size_t count)
 	{
-		assert(file && "EngineFileStream::File is invalid");
-		return fread(data, size, count, file);
+		uint64_t requestedSize = size * count;
+		if (!requestedSize)
+			return 0;
+		if (_isBufferDirty)
+			flush();
+
+		uint8_t* outputData = static_cast<uint8_t*>(data);
+		uint64_t readSize = 0;
+		while (readSize < requestedSize)
+		{
+			if (_bufferSize && _position >= _bufferOffset && _position < _bufferOffset + _bufferSize)
+			{
+				uint64_t chunkSize = std::min(requestedSize - readSize, _bufferOffset + _bufferSize - _position);
+				memcpy(outputData + readSize, _buffer.get() + (_position - _bufferOffset), chunkSize);
+				readSize += chunkSize;
+				_position += chunkSize;
+				continue;
+			}
+
+			// Large reads bypass the buffer, so they are not copied twice
+			uint64_t remainingSize = requestedSize - readSize;
+			if (remainingSize >= _bufferCapacity)
+			{
+				int64_t chunkSize = NativeFile::read_at(_file, outputData + readSize, remainingSize, _position);
+				if (chunkSize > 0)
+				{
+					readSize += chunkSize;
+					_position += chunkSize;
+				}
+				break;
+			}
+
+			if (!_buffer)
+				_buffer.reset(new uint8_t[_bufferCapacity]);
+			int64_t chunkSize = NativeFile::read_at(_file, _buffer.get(), _bufferCapacity, _position);
+			if (chunkSize <= 0)
+			{
+				_bufferSize = 0;
+				break;
+			}
+			_bufferOffset = _position;
+			_bufferSize = static_cast<uint32_t>(chunkSize);
+		}
+
+		return readSize / size;
 	}
 
 	size_t io::EngineFileStream::write(const void* data, size_t size, size_t count)
 	{
-		assert(file && "EngineFileStream::File is invalid");
-		return fwrite(data, size, count, file);
+		uint64_t requestedSize = size * count;
+		if (!requestedSize)
+			return 0;
+
+		if (_isAppend)
+			_position = _size.load();
+		discard_read_buffer();
+		// Buffered writes must be contiguous
+		if (_isBufferDirty && _position != _bufferOffset + _bufferSize)
+			flush();
+
+		if (requestedSize > _bufferCapacity - _bufferSize)
+		{
+			flush();
+			if (requestedSize >= _bufferCapacity)
+			{
+				int64_t writtenSize = NativeFile::write_at(_file, data, requestedSize, _position);
+				if (writtenSize < 0)
+				{
+					LOG_ERROR("EngineFileStream::write(): Failed to write {} bytes", requestedSize)
+					return 0;
+				}
+				_position += writtenSize;
+				update_size(_position);
+				return writtenSize / size;
+			}
+		}
+
+		if (!_buffer)
+			_buffer.reset(new uint8_t[_bufferCapacity]);
+		if (!_isBufferDirty)
+		{
+			_bufferOffset = _position;
+			_bufferSize = 0;
+			_isBufferDirty = true;
+		}
+		memcpy(_buffer.get() + _bufferSize, data, requestedSize);
+		_bufferSize += requestedSize;
+		_position += requestedSize;
+		update_size(_position);
+		return count;
+	}
+
+	uint64_t io::EngineFileStream::write_vectored(const WriteBuffer* buffers, uint32_t bufferCount)
+	{
+		uint64_t requestedSize = 0;
+		for (uint32_t i = 0; i != bufferCount; ++i)
+			requestedSize += buffers[i].size;
+		if (!requestedSize)
+			return 0;
+
+		if (_isAppend)
+			_position = _size.load();
+		discard_read_buffer();
+		if (_isBufferDirty && _position != _bufferOffset + _bufferSize)
+			flush();
+
+		// Small buffers are gathered in the stream buffer
+		if (requestedSize <= _bufferCapacity - _bufferSize)
+		{
+			for (uint32_t i = 0; i != bufferCount; ++i)
+				write(buffers[i].data, 1, buffers[i].size);
+			return requestedSize;
+		}
+
+		flush();
+		int64_t writtenSize = NativeFile::write_vectored_at(_file, buffers, bufferCount, _position);
+		if (writtenSize < 0)
+		{
+			LOG_ERROR("EngineFileStream::write_vectored(): Failed to write {} buffers", bufferCount)
+			return 0;
+		}
+		_position += writtenSize;
+		update_size(_position);
+		return writtenSize;
 	}
 
-	uint64_t io::EngineFileStream::size() const
+	uint64_t io::EngineFileStream::read_at(void* data, uint64_t size, uint64_t offset)
 	{
-		assert(file && "EngineFileStream::File is invalid");
-		long position = ftell(file);
-		fseek(file, 0, SEEK_END);
-		long size = ftell(file);
-		fseek(file, position, SEEK_SET);
-		return static_cast<uint64_t>(size);
+		int64_t readSize = NativeFile::read_at(_file, data, size, offset);
+		return readSize > 0 ? readSize : 0;
 	}
 
-	io::EngineFileSystem::EngineFileSystem(const char* engineRootPath)
+	uint64_t io::EngineFileStream::write_at(const void* data, uint64_t size, uint64_t offset)
+	{
+		int64_t writtenSize = NativeFile::write_at(_file, data, size, offset);
+		if (writtenSize < 0)
+		{
+			LOG_ERROR("EngineFileStream::write_at(): Failed to write {} bytes", size)
+			return 0;
+		}
+		update_size(offset + writtenSize);
+		return writtenSize;
+	}
+
+	void io::EngineFileStream::seek(uint64_t position)
+	{
+		// Buffers stay valid, read() and write() check if they contain the new position
+		_position = position;
+	}
+
+	bool io::EngineFileStream::flush()
+	{
+		if (!_isBufferDirty)
+			return true;
+
+		int64_t writtenSize = NativeFile::write_at(_file, _buffer.get(), _bufferSize, _bufferOffset);
+		bool isFlushed = writtenSize == static_cast<int64_t>(_bufferSize);
+		if (!isFlushed)
+		{
+			LOG_ERROR("EngineFileStream::flush(): Failed to write {} bytes", _bufferSize)
+		}
+		_isBufferDirty = false;
+		_bufferSize = 0;
+		return isFlushed;
+	}
+
+	void io::EngineFileStream::discard_read_buffer()
+	{
+		if (!_isBufferDirty)
+			_bufferSize = 0;
+	}
+
+	void io::EngineFileStream::update_size(uint64_t endOffset)
+	{
+		uint64_t size = _size.load();
+		while (size < endOffset && !_size.compare_exchange_weak(size, endOffset));
+	}
+
+	size_t io::PakFileStream::read(void* data, size_t size, size_t count)
+	{
+		uint64_t readSize = read_at(data, size * count, _position);
+		_position += readSize;
+		return size ? readSize / size : 0;
+	}
+
+	size_t io::PakFileStream::write(const void*, size_t, size_t)
+	{
+		LOG_ERROR("PakFileStream::write(): Files from pak archives are read-only")
+		return 0;
+	}
+
+	uint64_t io::PakFileStream::write_vectored(const WriteBuffer*, uint32_t)
+	{
+		LOG_ERROR("PakFileStream::write_vectored(): Files from pak archives are read-only")
+		return 0;
+	}
+
+	uint64_t io::PakFileStream::read_at(void* data, uint64_t size, uint64_t offset)
+	{
+		if (offset >= _mappedFile.size())
+			return 0;
+		uint64_t readSize = std::min(size, _mappedFile.size() - offset);
+		memcpy(data, _mappedFile.data() + offset, readSize);
+		return readSize;
+	}
+
+	uint64_t io::PakFileStream::write_at(const void*, uint64_t, uint64_t)
+	{
+		LOG_ERROR("PakFileStream::write_at(): Files from pak archives are read-only")
+		return 0;
+	}
+
+	io::EngineFileSystem::EngineFileSystem(const char* engineRootPath, uint32_t streamBufferSize) : _streamBufferSize(streamBufferSize)
 	{
 		_engineRootPath = std::filesystem::path(engineRootPath);
 		_streamPool.allocate_new_pool(512);
+		_pakStreamPool.allocate_new_pool(64);
 	}
 
 	io::EngineFileSystem::~EngineFileSystem()
 	{
 		_streamPool.cleanup();
+		_pakStreamPool.cleanup();
 	}
 
-	io::EngineFileStream* io::EngineFileSystem::open(const io::URI& uri, const char* mode)
+	io::Stream* io::EngineFileSystem::open(const io::URI& uri, const char* mode)
 	{
-		std::filesystem::path path = std::filesystem::path(uri.c_str());
-		if (!path.is_absolute())
-			path = _engineRootPath / path;
+		std::filesystem::path path = get_absolute_path(uri);
+		bool isRead = strchr(mode, 'r');
+		bool isAppend = strchr(mode, 'a');
+		bool isUpdate = strchr(mode, '+');
+		if (!isRead && !isAppend && !strchr(mode, 'w'))
+		{
+			LOG_ERROR("EngineFileSystem::open(): Mode {} is invalid", mode)
+			return nullptr;
+		}
 
-		if (!std::filesystem::exists(path) && strcmp(mode, "wb") != 0)
+		MappedFile packedFile;
+		if (isRead && !isUpdate && map_packed_file(path, MapAccess::DEFAULT, &packedFile))
+			return _pakStreamPool.allocate(std::move(packedFile));
+
+		if (!std::filesystem::exists(path) && isRead)
 		{
 			LOG_ERROR("Path {} is invlaid", path.string().c_str())
 			return nullptr;
@@ -69,67 +276,166 @@ namespace ad_astris
 			return nullptr;
 		}
 			
-		FILE* file = fopen(path.string().c_str(), mode);
-		assert(file && "EngineFileSystem::File is invalid after opening");
-		return _streamPool.allocate(file);
+		NativeFileAccess access = isRead ? NativeFileAccess::READ : NativeFileAccess::WRITE | NativeFileAccess::CREATE;
+		if (isUpdate)
+			access |= NativeFileAccess::READ | NativeFileAccess::WRITE;
+		if (!isRead && !isAppend)
+			access |= NativeFileAccess::TRUNCATE;
+
+		NativeFileHandle file;
+		if (!NativeFile::open(path, access, file))
+		{
+			LOG_ERROR("EngineFileSystem::open(): Failed to open file {}", path.string())
+			return nullptr;
+		}
+		return _streamPool.allocate(file, isAppend, _streamBufferSize);
 	}
 
 	bool io::EngineFileSystem::close(io::Stream* stream)
 	{
 		assert(stream);
-		_streamPool.free(static_cast<EngineFileStream*>(stream));
+		if (auto pakStream = dynamic_cast<PakFileStream*>(stream))
+			_pakStreamPool.free(pakStream);
+		else
+			_streamPool.free(static_cast<EngineFileStream*>(stream));
 		return true;
 	}
 
-	void* io::EngineFileSystem::map_to_read(const URI& path, size_t& size, const char* mode)
+	io::MappedFile io::EngineFileSystem::map_file(const URI& uri, MapAccess access)
 	{
-		EngineFileStream* stream = open(path, mode);
+		std::filesystem::path path = get_absolute_path(uri);
+		MappedFile packedFile;
+		if (map_packed_file(path, access, &packedFile))
+			return packedFile;
+		return MappedFile::map(path, access);
+	}
+
+	void io::EngineFileSystem::write(const URI& uri, void* data, size_t objectSize, size_t count, const char* mode)
+	{
+		if (!data || count == 0 || objectSize == 0)
+		{
+			LOG_ERROR("FileSystem::write(): Can't write file when data or size is invalid")
+			return;
+		}
+		
+		Stream* stream = open(uri, mode);
+		if (!stream)
+			return;
+		stream->write(data, objectSize, count);
+		close(stream);
+	}
+
+	void io::EngineFileSystem::write(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount)
+	{
+		Stream* stream = open(uri, "wb");
 		if (!stream)
+			return;
+		stream->write_vectored(buffers, bufferCount);
+		close(stream);
+	}
+
+	bool io::EngineFileSystem::write_atomic(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount)
+	{
+		std::filesystem::path path = get_absolute_path(uri);
+		if (!path.has_extension())
 		{
-			LOG_ERROR("Stream is invalid. Path {}", path.c_str())
-			return nullptr;
+			LOG_ERROR("EngineFileSystem::write_atomic(): File from path {} has no extension", path.string())
+			return false;
 		}
 
-		size = stream->size();
-		if (!size)
+		uint64_t size = 0;
+		for (uint32_t i = 0; i != bufferCount; ++i)
+			size += buffers[i].size;
+
+		// The counter makes names unique when the same file is written from several threads
+		std::filesystem::path tempPath = path;
+		tempPath += fmt::format(".{}.tmp", _tempFileCounter.fetch_add(1));
+
+		NativeFileHandle file;
+		if (!NativeFile::open(tempPath, NativeFileAccess::WRITE | NativeFileAccess::CREATE | NativeFileAccess::TRUNCATE, file))
 		{
-			LOG_ERROR("File {} is empty", path.c_str())
-			return nullptr;
+			LOG_ERROR("EngineFileSystem::write_atomic(): Failed to open file {}", tempPath.string())
+			return false;
 		}
-		
-		uint8_t* data = new uint8_t[size];
+		int64_t writtenSize = NativeFile::write_vectored_at(file, buffers, bufferCount, 0);
+		// Data must be on disk before the rename, otherwise a crash can leave the renamed file empty or partially written
+		bool isFlushed = NativeFile::flush(file);
+		NativeFile::close(file);
 
-		size_t readElements = stream->read(data, sizeof(uint8_t), size);
-		assert(readElements == size && ("Data " + std::string(path.c_str()) + " is invalid").c_str());
-		assert(data && ("Data " + std::string(path.c_str()) + " is invalid").c_str());
+		std::error_code errorCode;
+		if (writtenSize < 0 || static_cast<uint64_t>(writtenSize) != size || !isFlushed)
+		{
+			LOG_ERROR("EngineFileSystem::write_atomic(): Failed to write {} bytes to {}", size, tempPath.string())
+			std::filesystem::remove(tempPath, errorCode);
+			return false;
+		}
+		std::filesystem::rename(tempPath, path, errorCode);
+		if (errorCode)
+		{
+			LOG_ERROR("EngineFileSystem::write_atomic(): Failed to rename {} to {}", tempPath.string(), path.string())
+			std::filesystem::remove(tempPath, errorCode);
+			return false;
+		}
+		return true;
+	}
 
-		bool afterClose = close(stream);
-		assert(afterClose && "Error while closing stream");
+	bool io::EngineFileSystem::mount_pak(const URI& pakPath, const URI& mountPoint)
+	{
+		std::unique_ptr<PakArchive> archive = PakArchive::open(get_absolute_path(pakPath));
+		if (!archive)
+		{
+			LOG_ERROR("EngineFileSystem::mount_pak(): Failed to mount {}", pakPath.c_str())
+			return false;
+		}
 
-		return data;
+		LOG_INFO("EngineFileSystem::mount_pak(): Mounted {} with {} files", pakPath.c_str(), archive->get_entry_count())
+		std::unique_lock<std::shared_mutex> lock(_mountsMutex);
+		_mounts.push_back({ std::move(archive), get_absolute_path(mountPoint).lexically_normal() });
+		return true;
 	}
 
-	bool io::EngineFileSystem::unmap_after_reading(void* data)
+	bool io::EngineFileSystem::unmount_pak(const URI& pakPath)
 	{
-		assert(data);
-		uint8_t* newData = reinterpret_cast<uint8_t*>(data);
-		delete[] newData;
-		data = nullptr;
+		std::filesystem::path path = get_absolute_path(pakPath);
+		std::unique_lock<std::shared_mutex> lock(_mountsMutex);
+		auto it = std::find_if(_mounts.begin(), _mounts.end(), [&](const Mount& mount)
+		{
+			return mount.archive->get_path() == path;
+		});
+		if (it == _mounts.end())
+			return false;
 
+		// Views of packed files keep the archive mapping alive
+		_mounts.erase(it);
 		return true;
 	}
 
-	void io::EngineFileSystem::write(const URI& uri, void* data, size_t objectSize, size_t count, const char* mode)
+	bool io::EngineFileSystem::is_packed(const URI& uri)
 	{
-		if (!data || count == 0 || objectSize == 0)
+		return map_packed_file(get_absolute_path(uri), MapAccess::DEFAULT, nullptr);
+	}
+
+	bool io::EngineFileSystem::map_packed_file(const std::filesystem::path& path, MapAccess access, MappedFile* outMappedFile)
+	{
+		std::shared_lock<std::shared_mutex> lock(_mountsMutex);
+		if (_mounts.empty())
+			return false;
+
+		std::filesystem::path normalizedPath = path.lexically_normal();
+		for (auto it = _mounts.rbegin(); it != _mounts.rend(); ++it)
 		{
-			LOG_ERROR("FileSystem::write(): Can't write file when data or size is invalid")
-			return;
+			std::filesystem::path relativePath = normalizedPath.lexically_relative(it->mountPoint);
+			if (relativePath.empty() || *relativePath.begin() == "..")
+				continue;
+
+			if (const PakEntry* entry = it->archive->find_entry(PakArchive::normalize_path(relativePath)))
+			{
+				if (outMappedFile)
+					*outMappedFile = it->archive->map_entry(*entry, access);
+				return true;
+			}
 		}
-		
-		EngineFileStream* stream = open(uri, mode);
-		stream->write(data, objectSize, count);
-		close(stream);
+		return false;
 	}
 }
 
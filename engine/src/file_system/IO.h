@@ -1,38 +1,110 @@
 #pragma once
 
 #include "file_system.h"
+#include "pak_archive.h"
 #include "core/pool_allocator.h"
+#include <atomic>
 #include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
 
 namespace ad_astris::io
 {
+	constexpr uint32_t DEFAULT_STREAM_BUFFER_SIZE = 1024 * 1024;
+
+	// Modes are parsed like fopen() modes, files are always opened in binary mode
 	class EngineFileStream : public Stream
 	{
 		public:
-			EngineFileStream(FILE* file);
+			// The buffer is allocated on the first buffered transfer that is smaller than the buffer
+			EngineFileStream(NativeFileHandle file, bool isAppend, uint32_t bufferSize);
 			virtual ~EngineFileStream() final;
 
 			virtual size_t read(void* data, size_t size, size_t count) final;
 			virtual size_t write(const void* data, size_t size, size_t count) final;
-			virtual uint64_t size() const final;
+			virtual uint64_t write_vectored(const WriteBuffer* buffers, uint32_t bufferCount) final;
+			virtual uint64_t read_at(void* data, uint64_t size, uint64_t offset) final;
+			virtual uint64_t write_at(const void* data, uint64_t size, uint64_t offset) final;
+			virtual void seek(uint64_t position) final;
+			virtual uint64_t tell() const final { return _position; }
+			virtual bool flush() final;
+			// Cached when the file is opened and updated by writes of the stream
+			virtual uint64_t size() const final { return _size.load(); }
 
 		private:
-			FILE* file;
+			NativeFileHandle _file;
+			bool _isAppend{ false };
+			uint64_t _position{ 0 };
+			std::atomic<uint64_t> _size{ 0 };
+
+			// The buffer contains either read data or writes that have not been flushed
+			std::unique_ptr<uint8_t[]> _buffer{ nullptr };
+			uint32_t _bufferCapacity{ 0 };
+			uint32_t _bufferSize{ 0 };
+			uint64_t _bufferOffset{ 0 };			// File offset of the first byte of the buffer
+			bool _isBufferDirty{ false };
+
+			void discard_read_buffer();
+			void update_size(uint64_t endOffset);
+	};
+
+	// Read-only stream of a file from a pak archive
+	class PakFileStream : public Stream
+	{
+		public:
+			PakFileStream(MappedFile mappedFile) : _mappedFile(std::move(mappedFile)) { }
+
+			virtual size_t read(void* data, size_t size, size_t count) final;
+			virtual size_t write(const void* data, size_t size, size_t count) final;
+			virtual uint64_t write_vectored(const WriteBuffer* buffers, uint32_t bufferCount) final;
+			virtual uint64_t read_at(void* data, uint64_t size, uint64_t offset) final;
+			virtual uint64_t write_at(const void* data, uint64_t size, uint64_t offset) final;
+			virtual void seek(uint64_t position) final { _position = position; }
+			virtual uint64_t tell() const final { return _position; }
+			virtual bool flush() final { return true; }
+			virtual uint64_t size() const final { return _mappedFile.size(); }
+
+		private:
+			MappedFile _mappedFile;
+			uint64_t _position{ 0 };
 	};
 
 	class EngineFileSystem : public FileSystem
 	{
 		public:
-			EngineFileSystem(const char* engineRootPath);
+			EngineFileSystem(const char* engineRootPath, uint32_t streamBufferSize = DEFAULT_STREAM_BUFFER_SIZE);
 			virtual ~EngineFileSystem() final;
 
-			virtual EngineFileStream* open(const URI& path, const char* mode) final;
+			virtual Stream* open(const URI& path, const char* mode) final;
 			virtual bool close(Stream* stream) final;
-			virtual void* map_to_read(const URI& uri, size_t& size, const char* mode = "rb") final;
-			virtual bool unmap_after_reading(void* data) final;
+			virtual MappedFile map_file(const URI& uri, MapAccess access = MapAccess::DEFAULT) final;
 			virtual void write(const URI& uri, void* data, size_t objectSize, size_t count, const char* mode = "wb") override;
+			virtual void write(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount) override;
+			virtual bool write_atomic(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount) override;
+			virtual bool mount_pak(const URI& pakPath, const URI& mountPoint) override;
+			virtual bool unmount_pak(const URI& pakPath) override;
+			virtual bool is_packed(const URI& uri) override;
+
+			// Used by streams that are opened after the call
+			void set_stream_buffer_size(uint32_t bufferSize) { _streamBufferSize = bufferSize; }
 
 		private:
+			struct Mount
+			{
+				std::unique_ptr<PakArchive> archive;
+				std::filesystem::path mountPoint;
+			};
+
 			ThreadSafePoolAllocator<EngineFileStream> _streamPool;
+			ThreadSafePoolAllocator<PakFileStream> _pakStreamPool;
+			uint32_t _streamBufferSize{ DEFAULT_STREAM_BUFFER_SIZE };
+			// Archives that are mounted later are searched first, so patches can override files
+			std::vector<Mount> _mounts;
+			std::shared_mutex _mountsMutex;
+			std::atomic<uint64_t> _tempFileCounter{ 0 };
+
+			// Returns false if the file is not packed. If outMappedFile is nullptr, the file is not mapped
+			bool map_packed_file(const std::filesystem::path& path, MapAccess access, MappedFile* outMappedFile);
 	};
 }
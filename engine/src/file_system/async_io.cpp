@@ -0,0 +1,252 @@
+#include "async_io.h"
+#include "async_io_backends.h"
+#include "profiler/logger.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <thread>
+
+using namespace ad_astris;
+using namespace io;
+
+AsyncIOService::AsyncIOService(FileSystem* fileSystem, tasks::TaskComposer* taskComposer, const AsyncIOSettings& settings)
+	: _fileSystem(fileSystem), _taskComposer(taskComposer), _settings(settings)
+{
+	assert(_fileSystem);
+	_settings.queueDepth = std::max(1u, _settings.queueDepth);
+	_requestPool.allocate_new_pool(_settings.queueDepth * 4);
+	_statisticsResetTime = Clock::now();
+
+	impl::IOCompletionCallback completionCallback = [this](impl::IORequestState* requestState)
+	{
+		complete_issued_request(requestState);
+	};
+
+#ifdef __linux__
+	if (_settings.isIOUringEnabled)
+		_backend = impl::IOUringIOBackend::create(_settings.queueDepth, completionCallback);
+#endif
+	if (!_backend)
+		_backend = std::make_unique<impl::ThreadPoolIOBackend>(_settings.workerThreadCount, completionCallback);
+
+	LOG_INFO("AsyncIOService::AsyncIOService(): Backend: {}, queue depth: {}", _backend->get_name(), _settings.queueDepth)
+}
+
+AsyncIOService::~AsyncIOService()
+{
+	for (size_t i = 0; i != IO_PRIORITY_COUNT; ++i)
+	{
+		std::vector<impl::IORequestState*> canceledRequests;
+		{
+			std::scoped_lock<std::mutex> lock(_queueMutex);
+			canceledRequests.assign(_pendingRequests[i].begin(), _pendingRequests[i].end());
+			_pendingRequestCount -= canceledRequests.size();
+			_pendingRequests[i].clear();
+		}
+		for (auto& requestState : canceledRequests)
+		{
+			requestState->result.status = IOStatus::CANCELED;
+			finish_request(requestState);
+		}
+	}
+
+	// Handlers that are queued in TaskComposer use the request pool
+	while (_liveRequestCount.load())
+		std::this_thread::yield();
+
+	_backend.reset();
+	_requestPool.cleanup();
+}
+
+IOBatchID AsyncIOService::submit(std::vector<IORequest> requests, tasks::TaskGroup& taskGroup)
+{
+	if (requests.empty())
+		return INVALID_IO_BATCH_ID;
+
+	IOBatchID batchID = _nextBatchID.fetch_add(1);
+	Clock::time_point submitTime = Clock::now();
+	taskGroup.increase_task_count(requests.size());
+	_liveRequestCount.fetch_add(requests.size());
+
+	std::vector<impl::IORequestState*> requestStates;
+	requestStates.reserve(requests.size());
+	for (auto& request : requests)
+	{
+		impl::IORequestState* requestState = _requestPool.allocate();
+		requestState->path = _fileSystem->get_absolute_path(request.path);
+		requestState->request = std::move(request);
+		requestState->batchID = batchID;
+		requestState->taskGroup = &taskGroup;
+		requestState->submitTime = submitTime;
+		requestStates.push_back(requestState);
+	}
+
+	{
+		std::scoped_lock<std::mutex> lock(_queueMutex);
+		for (auto& requestState : requestStates)
+			_pendingRequests[static_cast<size_t>(requestState->request.priority)].push_back(requestState);
+		_pendingRequestCount += requestStates.size();
+
+		std::scoped_lock<std::mutex> statisticsLock(_statisticsMutex);
+		_statistics.maxQueueDepth = std::max(_statistics.maxQueueDepth, _pendingRequestCount + _issuedRequestCount);
+	}
+
+	issue_pending_requests();
+	return batchID;
+}
+
+uint32_t AsyncIOService::cancel(IOBatchID batchID)
+{
+	std::vector<impl::IORequestState*> canceledRequests;
+	{
+		std::scoped_lock<std::mutex> lock(_queueMutex);
+		for (auto& requests : _pendingRequests)
+		{
+			auto it = std::remove_if(requests.begin(), requests.end(), [&](impl::IORequestState* requestState)
+			{
+				if (requestState->batchID != batchID)
+					return false;
+				canceledRequests.push_back(requestState);
+				return true;
+			});
+			requests.erase(it, requests.end());
+		}
+		_pendingRequestCount -= canceledRequests.size();
+	}
+
+	for (auto& requestState : canceledRequests)
+	{
+		requestState->result.status = IOStatus::CANCELED;
+		finish_request(requestState);
+	}
+
+	return canceledRequests.size();
+}
+
+IOStatistics AsyncIOService::get_statistics()
+{
+	IOStatistics statistics;
+	{
+		std::scoped_lock<std::mutex> lock(_queueMutex);
+		std::scoped_lock<std::mutex> statisticsLock(_statisticsMutex);
+		statistics = _statistics;
+		statistics.queueDepth = _pendingRequestCount + _issuedRequestCount;
+		statistics.issuedRequestCount = _issuedRequestCount;
+		_latencyHistory.calculate_statistics(statistics.latency, _latencyScratch);
+	}
+
+	double elapsedSeconds = std::chrono::duration<double>(Clock::now() - _statisticsResetTime).count();
+	if (elapsedSeconds > 0.0)
+		statistics.bytesPerSecond = (double)(statistics.readBytes + statistics.writtenBytes) / elapsedSeconds;
+	return statistics;
+}
+
+void AsyncIOService::reset_statistics()
+{
+	std::scoped_lock<std::mutex> lock(_statisticsMutex);
+	_statistics = IOStatistics();
+	_latencyHistory.reset();
+	_statisticsResetTime = Clock::now();
+}
+
+const char* AsyncIOService::get_backend_name() const
+{
+	return _backend->get_name();
+}
+
+void AsyncIOService::issue_pending_requests()
+{
+	while (true)
+	{
+		impl::IORequestState* requestState = nullptr;
+		{
+			std::scoped_lock<std::mutex> lock(_queueMutex);
+			if (_issuedRequestCount >= _settings.queueDepth || !_pendingRequestCount)
+				return;
+
+			for (size_t i = IO_PRIORITY_COUNT; i != 0; --i)
+			{
+				auto& requests = _pendingRequests[i - 1];
+				if (!requests.empty())
+				{
+					requestState = requests.front();
+					requests.pop_front();
+					break;
+				}
+			}
+			--_pendingRequestCount;
+			++_issuedRequestCount;
+		}
+
+		// Requests that are finished without issuing don't call the completion callback, so they are finished here
+		// instead of recursing from the callback
+		if (!_backend->submit(requestState))
+		{
+			{
+				std::scoped_lock<std::mutex> lock(_queueMutex);
+				--_issuedRequestCount;
+			}
+			finish_request(requestState);
+		}
+	}
+}
+
+void AsyncIOService::complete_issued_request(impl::IORequestState* requestState)
+{
+	{
+		std::scoped_lock<std::mutex> lock(_queueMutex);
+		--_issuedRequestCount;
+	}
+	finish_request(requestState);
+	issue_pending_requests();
+}
+
+void AsyncIOService::finish_request(impl::IORequestState* requestState)
+{
+	IOResult& result = requestState->result;
+	result.latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - requestState->submitTime).count();
+
+	{
+		std::scoped_lock<std::mutex> lock(_statisticsMutex);
+		switch (result.status)
+		{
+			case IOStatus::COMPLETED:
+			{
+				++_statistics.completedRequestCount;
+				if (requestState->request.type == IORequestType::READ)
+					_statistics.readBytes += result.size;
+				else
+					_statistics.writtenBytes += result.size;
+				_latencyHistory.add_timing((profiler::Timing)result.latencyMs, INFINITY);
+				break;
+			}
+			case IOStatus::CANCELED:
+				++_statistics.canceledRequestCount;
+				break;
+			default:
+				++_statistics.failedRequestCount;
+				break;
+		}
+	}
+
+	tasks::TaskGroup* taskGroup = requestState->taskGroup;
+	auto completeRequest = [this, requestState]()
+	{
+		if (requestState->request.completionHandler)
+			requestState->request.completionHandler(requestState->result);
+		_requestPool.free(requestState);
+		_liveRequestCount.fetch_sub(1);
+	};
+
+	if (_taskComposer && requestState->request.completionHandler)
+	{
+		// The continuation is added before the request task is removed, so the group can't become idle in between
+		_taskComposer->execute(*taskGroup, [completeRequest](tasks::TaskExecutionInfo) { completeRequest(); });
+	}
+	else
+	{
+		completeRequest();
+	}
+	taskGroup->decrease_task_count(1);
+}
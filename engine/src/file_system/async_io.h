@@ -0,0 +1,147 @@
+#pragma once
+
+#include "file_system.h"
+#include "multithreading/task_composer.h"
+#include "profiler/range_statistics.h"
+#include "core/pool_allocator.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ad_astris::io
+{
+	enum class IORequestType
+	{
+		READ,
+		WRITE
+	};
+
+	// Pending requests with higher priority are issued first. Requests that have been issued are not reordered
+	enum class IOPriority : uint8_t
+	{
+		LOW,
+		NORMAL,
+		HIGH,
+		CRITICAL,
+		COUNT
+	};
+
+	constexpr size_t IO_PRIORITY_COUNT = static_cast<size_t>(IOPriority::COUNT);
+
+	enum class IOStatus
+	{
+		PENDING,
+		COMPLETED,
+		CANCELED,
+		FAILED
+	};
+
+	using IOBatchID = uint64_t;
+	constexpr IOBatchID INVALID_IO_BATCH_ID = 0;
+
+	struct IOResult
+	{
+		IOStatus status{ IOStatus::PENDING };
+		uint8_t* data{ nullptr };						// IORequest::data or ownedData
+		uint64_t size{ 0 };								// Transferred bytes, can be less than requested if the file ends earlier
+		std::unique_ptr<uint8_t[]> ownedData{ nullptr };	// Allocated by the service if IORequest::data is null, can be moved out
+		double latencyMs{ 0 };							// From submitting to completion, includes time in the queue
+	};
+
+	using IOCompletionHandler = std::function<void(IOResult&)>;
+
+	struct IORequest
+	{
+		IORequestType type{ IORequestType::READ };
+		IOPriority priority{ IOPriority::NORMAL };
+		URI path;										// Relative paths are relative to the engine root
+		uint64_t offset{ 0 };
+		uint64_t size{ 0 };								// If 0, the file is read from offset to the end. Required for writes
+		// Destination of reads, must be at least size bytes. Source of writes, must be alive until completion
+		void* data{ nullptr };
+		// Executed as a TaskComposer task. Writes with zero offset replace the file
+		IOCompletionHandler completionHandler;
+	};
+
+	// Counters are accumulated since the last reset. Latency percentiles are calculated over the last
+	// profiler::RANGE_TIMING_WINDOW_SIZE requests
+	struct IOStatistics
+	{
+		uint32_t queueDepth{ 0 };						// Pending and issued requests at the moment
+		uint32_t issuedRequestCount{ 0 };
+		uint32_t maxQueueDepth{ 0 };
+		uint64_t completedRequestCount{ 0 };
+		uint64_t canceledRequestCount{ 0 };
+		uint64_t failedRequestCount{ 0 };
+		uint64_t readBytes{ 0 };
+		uint64_t writtenBytes{ 0 };
+		double bytesPerSecond{ 0 };
+		profiler::RangeStatistics latency;				// Milliseconds
+	};
+
+	struct AsyncIOSettings
+	{
+		uint32_t queueDepth{ 64 };						// Requests that are issued to the OS at the same time
+		uint32_t workerThreadCount{ 4 };				// Used only by the thread pool backend
+		bool isIOUringEnabled{ true };					// If io_uring is unavailable, the thread pool backend is used
+	};
+
+	namespace impl
+	{
+		struct IORequestState;
+		class IAsyncIOBackend;
+	}
+
+	// Accepts batches of requests from any thread and completes them into TaskComposer continuations. Each request
+	// of a batch adds a task to the task group, so TaskComposer::wait() returns when all requests and their handlers
+	// are finished. On Linux requests are issued using io_uring, other platforms use a thread pool with blocking
+	// positional reads and writes
+	class AsyncIOService
+	{
+		public:
+			// If taskComposer is null, handlers are executed on the backend thread that completed the request
+			AsyncIOService(FileSystem* fileSystem, tasks::TaskComposer* taskComposer, const AsyncIOSettings& settings = AsyncIOSettings());
+			~AsyncIOService();
+
+			IOBatchID submit(std::vector<IORequest> requests, tasks::TaskGroup& taskGroup);
+			// Requests that have not been issued are completed with IOStatus::CANCELED. Returns the number of
+			// canceled requests, issued requests are finished normally
+			uint32_t cancel(IOBatchID batchID);
+
+			IOStatistics get_statistics();
+			void reset_statistics();
+			const char* get_backend_name() const;
+
+		private:
+			using Clock = std::chrono::steady_clock;
+
+			FileSystem* _fileSystem{ nullptr };
+			tasks::TaskComposer* _taskComposer{ nullptr };
+			AsyncIOSettings _settings;
+			std::unique_ptr<impl::IAsyncIOBackend> _backend{ nullptr };
+			ThreadSafePoolAllocator<impl::IORequestState> _requestPool;
+			std::atomic<IOBatchID> _nextBatchID{ 1 };
+			std::atomic<uint32_t> _liveRequestCount{ 0 };		// Requests whose handlers have not finished
+
+			std::mutex _queueMutex;
+			std::array<std::deque<impl::IORequestState*>, IO_PRIORITY_COUNT> _pendingRequests;
+			uint32_t _pendingRequestCount{ 0 };
+			uint32_t _issuedRequestCount{ 0 };
+
+			std::mutex _statisticsMutex;
+			IOStatistics _statistics;
+			profiler::RangeTimingHistory _latencyHistory;
+			std::vector<profiler::Timing> _latencyScratch;
+			Clock::time_point _statisticsResetTime;
+
+			void issue_pending_requests();
+			void complete_issued_request(impl::IORequestState* requestState);
+			void finish_request(impl::IORequestState* requestState);
+	};
+}
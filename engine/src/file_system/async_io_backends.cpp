@@ -0,0 +1,368 @@
+#include "async_io_backends.h"
+#include "profiler/logger.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using namespace ad_astris;
+using namespace io;
+using namespace impl;
+
+namespace
+{
+	// Opens the file and calculates the size of the transfer. Destination of reads is allocated if the request
+	// doesn't provide it. Returns false if the request has been finished, the file is closed in this case
+	bool open_request_file(IORequestState* requestState)
+	{
+		IORequest& request = requestState->request;
+		IOResult& result = requestState->result;
+		bool isRead = request.type == IORequestType::READ;
+		if (!isRead && (!request.size || !request.data))
+		{
+			LOG_ERROR("AsyncIOService: Can't write {} when data or size is invalid", requestState->path.string())
+			result.status = IOStatus::FAILED;
+			return false;
+		}
+
+		NativeFileAccess access = isRead ? NativeFileAccess::READ : NativeFileAccess::WRITE | NativeFileAccess::CREATE;
+		// Writes with zero offset replace the file
+		if (!isRead && !request.offset)
+			access |= NativeFileAccess::TRUNCATE;
+		NativeFileHandle file;
+		if (!NativeFile::open(requestState->path, access, file))
+		{
+			LOG_ERROR("AsyncIOService: Failed to open file {}", requestState->path.string())
+			result.status = IOStatus::FAILED;
+			return false;
+		}
+		uint64_t fileSize = NativeFile::get_size(file);
+		requestState->file = file;
+
+		if (!isRead)
+		{
+			requestState->requestedSize = request.size;
+			result.data = static_cast<uint8_t*>(request.data);
+			return true;
+		}
+
+		uint64_t availableSize = request.offset < fileSize ? fileSize - request.offset : 0;
+		requestState->requestedSize = request.size ? (std::min)(request.size, availableSize) : availableSize;
+		if (!requestState->requestedSize)
+		{
+			NativeFile::close(file);
+			result.status = IOStatus::COMPLETED;
+			return false;
+		}
+
+		if (request.data)
+		{
+			result.data = static_cast<uint8_t*>(request.data);
+		}
+		else
+		{
+			result.ownedData.reset(new uint8_t[requestState->requestedSize]);
+			result.data = result.ownedData.get();
+		}
+		return true;
+	}
+
+	void close_request_file(IORequestState* requestState)
+	{
+		NativeFile::close(requestState->file);
+	}
+
+	void transfer_blocking(IORequestState* requestState)
+	{
+		IORequest& request = requestState->request;
+		IOResult& result = requestState->result;
+		int64_t transferredSize = request.type == IORequestType::READ
+			? NativeFile::read_at(requestState->file, result.data, requestState->requestedSize, request.offset)
+			: NativeFile::write_at(requestState->file, result.data, requestState->requestedSize, request.offset);
+		if (transferredSize < 0)
+		{
+			LOG_ERROR("AsyncIOService: Failed to transfer data of file {}", requestState->path.string())
+			result.status = IOStatus::FAILED;
+			return;
+		}
+		// Reads can be short if the file has been truncated after opening
+		result.size = transferredSize;
+		result.status = IOStatus::COMPLETED;
+	}
+}
+
+ThreadPoolIOBackend::ThreadPoolIOBackend(uint32_t threadCount, const IOCompletionCallback& completionCallback)
+	: _completionCallback(completionCallback)
+{
+	threadCount = (std::max)(1u, threadCount);
+	_threads.reserve(threadCount);
+	for (uint32_t i = 0; i != threadCount; ++i)
+	{
+		_threads.emplace_back([this]()
+		{
+			while (true)
+			{
+				IORequestState* requestState = nullptr;
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					_wakeCondition.wait(lock, [this]() { return !_isAlive || !_requests.empty(); });
+					if (_requests.empty())
+						return;
+					requestState = _requests.front();
+					_requests.pop_front();
+				}
+
+				if (open_request_file(requestState))
+				{
+					transfer_blocking(requestState);
+					close_request_file(requestState);
+				}
+				_completionCallback(requestState);
+			}
+		});
+	}
+}
+
+ThreadPoolIOBackend::~ThreadPoolIOBackend()
+{
+	{
+		std::scoped_lock<std::mutex> lock(_mutex);
+		_isAlive = false;
+	}
+	_wakeCondition.notify_all();
+	for (auto& thread : _threads)
+		thread.join();
+}
+
+bool ThreadPoolIOBackend::submit(IORequestState* requestState)
+{
+	{
+		std::scoped_lock<std::mutex> lock(_mutex);
+		_requests.push_back(requestState);
+	}
+	_wakeCondition.notify_one();
+	return true;
+}
+
+#ifdef __linux__
+namespace
+{
+	// liburing is not used, the ring is set up with raw system calls
+	int io_uring_setup(uint32_t entryCount, io_uring_params* params)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entryCount, params));
+	}
+
+	int io_uring_enter(int ringFile, uint32_t submitCount, uint32_t minCompleteCount, uint32_t flags)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, ringFile, submitCount, minCompleteCount, flags, nullptr, 0));
+	}
+
+	template<typename T>
+	T* offset_pointer(void* base, uint32_t offset)
+	{
+		return reinterpret_cast<T*>(static_cast<uint8_t*>(base) + offset);
+	}
+}
+
+std::unique_ptr<IOUringIOBackend> IOUringIOBackend::create(uint32_t queueDepth, const IOCompletionCallback& completionCallback)
+{
+	std::unique_ptr<IOUringIOBackend> backend(new IOUringIOBackend(completionCallback));
+	if (!backend->init(queueDepth))
+		return nullptr;
+	return backend;
+}
+
+bool IOUringIOBackend::init(uint32_t queueDepth)
+{
+	io_uring_params params{};
+	// One more entry is used to stop the completion thread
+	_ringFile = io_uring_setup(queueDepth + 1, &params);
+	if (_ringFile < 0)
+	{
+		LOG_INFO("IOUringIOBackend::init(): io_uring is unavailable, error {}", errno)
+		return false;
+	}
+
+	_submissionQueue.ringSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	_completionQueue.ringSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	bool isSingleMapping = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (isSingleMapping)
+		_submissionQueue.ringSize = _completionQueue.ringSize = std::max(_submissionQueue.ringSize, _completionQueue.ringSize);
+
+	_submissionQueue.ring = mmap(nullptr, _submissionQueue.ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFile, IORING_OFF_SQ_RING);
+	if (_submissionQueue.ring == MAP_FAILED)
+	{
+		LOG_ERROR("IOUringIOBackend::init(): Failed to map submission queue")
+		_submissionQueue.ring = nullptr;
+		return false;
+	}
+
+	if (isSingleMapping)
+	{
+		_completionQueue.ring = _submissionQueue.ring;
+	}
+	else
+	{
+		_completionQueue.ring = mmap(nullptr, _completionQueue.ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFile, IORING_OFF_CQ_RING);
+		if (_completionQueue.ring == MAP_FAILED)
+		{
+			LOG_ERROR("IOUringIOBackend::init(): Failed to map completion queue")
+			_completionQueue.ring = nullptr;
+			return false;
+		}
+	}
+
+	_submissionQueue.entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	_submissionQueue.entries = mmap(nullptr, _submissionQueue.entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFile, IORING_OFF_SQES);
+	if (_submissionQueue.entries == MAP_FAILED)
+	{
+		LOG_ERROR("IOUringIOBackend::init(): Failed to map submission queue entries")
+		_submissionQueue.entries = nullptr;
+		return false;
+	}
+
+	_submissionQueue.head = offset_pointer<uint32_t>(_submissionQueue.ring, params.sq_off.head);
+	_submissionQueue.tail = offset_pointer<uint32_t>(_submissionQueue.ring, params.sq_off.tail);
+	_submissionQueue.mask = offset_pointer<uint32_t>(_submissionQueue.ring, params.sq_off.ring_mask);
+	_submissionQueue.array = offset_pointer<uint32_t>(_submissionQueue.ring, params.sq_off.array);
+	_submissionQueue.entryCount = params.sq_entries;
+	_completionQueue.head = offset_pointer<uint32_t>(_completionQueue.ring, params.cq_off.head);
+	_completionQueue.tail = offset_pointer<uint32_t>(_completionQueue.ring, params.cq_off.tail);
+	_completionQueue.mask = offset_pointer<uint32_t>(_completionQueue.ring, params.cq_off.ring_mask);
+	_completionQueue.entries = offset_pointer<void>(_completionQueue.ring, params.cq_off.cqes);
+
+	_completionThread = std::thread([this]() { reap_completions(); });
+	return true;
+}
+
+IOUringIOBackend::~IOUringIOBackend()
+{
+	if (_completionThread.joinable())
+	{
+		push_submission(nullptr);
+		_completionThread.join();
+	}
+
+	if (_submissionQueue.entries)
+		munmap(_submissionQueue.entries, _submissionQueue.entriesSize);
+	if (_completionQueue.ring && _completionQueue.ring != _submissionQueue.ring)
+		munmap(_completionQueue.ring, _completionQueue.ringSize);
+	if (_submissionQueue.ring)
+		munmap(_submissionQueue.ring, _submissionQueue.ringSize);
+	if (_ringFile >= 0)
+		close(_ringFile);
+}
+
+bool IOUringIOBackend::submit(IORequestState* requestState)
+{
+	if (!open_request_file(requestState))
+		return false;
+
+	requestState->ioVector.iov_base = requestState->result.data;
+	requestState->ioVector.iov_len = requestState->requestedSize;
+	if (!push_submission(requestState))
+	{
+		requestState->result.status = IOStatus::FAILED;
+		close_request_file(requestState);
+		return false;
+	}
+	return true;
+}
+
+bool IOUringIOBackend::push_submission(IORequestState* requestState)
+{
+	std::scoped_lock<std::mutex> lock(_submissionMutex);
+	// The service doesn't issue more requests than the queue depth, so the queue always has a free entry
+	uint32_t tail = *_submissionQueue.tail;
+	uint32_t index = tail & *_submissionQueue.mask;
+	io_uring_sqe* entry = static_cast<io_uring_sqe*>(_submissionQueue.entries) + index;
+	memset(entry, 0, sizeof(io_uring_sqe));
+
+	if (requestState)
+	{
+		// Vectored operations are used because they are supported by all kernels with io_uring
+		entry->opcode = requestState->request.type == IORequestType::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+		entry->fd = requestState->file;
+		entry->off = requestState->request.offset + requestState->result.size;
+		entry->addr = reinterpret_cast<uint64_t>(&requestState->ioVector);
+		entry->len = 1;
+	}
+	else
+	{
+		entry->opcode = IORING_OP_NOP;
+	}
+	entry->user_data = reinterpret_cast<uint64_t>(requestState);
+
+	_submissionQueue.array[index] = index;
+	__atomic_store_n(_submissionQueue.tail, tail + 1, __ATOMIC_RELEASE);
+
+	while (io_uring_enter(_ringFile, 1, 0, 0) < 0)
+	{
+		if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// The entry has not been consumed, it is removed so it isn't submitted with the next request
+		LOG_ERROR("IOUringIOBackend::push_submission(): Failed to submit the request, error {}", errno)
+		if (__atomic_load_n(_submissionQueue.head, __ATOMIC_ACQUIRE) == tail)
+			__atomic_store_n(_submissionQueue.tail, tail, __ATOMIC_RELEASE);
+		return false;
+	}
+	return true;
+}
+
+void IOUringIOBackend::reap_completions()
+{
+	while (true)
+	{
+		uint32_t head = *_completionQueue.head;
+		if (head == __atomic_load_n(_completionQueue.tail, __ATOMIC_ACQUIRE))
+		{
+			io_uring_enter(_ringFile, 0, 1, IORING_ENTER_GETEVENTS);
+			continue;
+		}
+
+		io_uring_cqe* entry = static_cast<io_uring_cqe*>(_completionQueue.entries) + (head & *_completionQueue.mask);
+		IORequestState* requestState = reinterpret_cast<IORequestState*>(entry->user_data);
+		int32_t transferred = entry->res;
+		__atomic_store_n(_completionQueue.head, head + 1, __ATOMIC_RELEASE);
+
+		if (!requestState)
+			return;
+
+		IOResult& result = requestState->result;
+		if (transferred < 0)
+		{
+			LOG_ERROR("IOUringIOBackend::reap_completions(): Failed to transfer data of file {}, error {}", requestState->path.string(), -transferred)
+			result.status = IOStatus::FAILED;
+		}
+		else
+		{
+			result.size += transferred;
+			// Transfers can be short, for example, if they are larger than the kernel limit for one operation
+			if (transferred && result.size < requestState->requestedSize)
+			{
+				requestState->ioVector.iov_base = result.data + result.size;
+				requestState->ioVector.iov_len = requestState->requestedSize - result.size;
+				if (push_submission(requestState))
+					continue;
+				result.status = IOStatus::FAILED;
+			}
+			else
+			{
+				result.status = IOStatus::COMPLETED;
+			}
+		}
+
+		close_request_file(requestState);
+		_completionCallback(requestState);
+	}
+}
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "async_io.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+namespace ad_astris::io::impl
+{
+	struct IORequestState
+	{
+		IORequest request;
+		IOResult result;
+		std::filesystem::path path;
+		IOBatchID batchID{ INVALID_IO_BATCH_ID };
+		tasks::TaskGroup* taskGroup{ nullptr };
+		std::chrono::steady_clock::time_point submitTime;
+		NativeFileHandle file;
+		uint64_t requestedSize{ 0 };					// Known after the file has been opened
+#ifdef __linux__
+		iovec ioVector;									// Remaining part of the transfer
+#endif
+	};
+
+	using IOCompletionCallback = std::function<void(IORequestState*)>;
+
+	class IAsyncIOBackend
+	{
+		public:
+			virtual ~IAsyncIOBackend() = default;
+
+			// Returns false if the request has been finished without issuing, for example, the file doesn't exist or
+			// there is nothing to read. The callback is not called in this case, otherwise it is called once from
+			// a backend thread
+			virtual bool submit(IORequestState* requestState) = 0;
+			virtual const char* get_name() const = 0;
+	};
+
+	// Every worker performs one blocking request at a time
+	class ThreadPoolIOBackend final : public IAsyncIOBackend
+	{
+		public:
+			ThreadPoolIOBackend(uint32_t threadCount, const IOCompletionCallback& completionCallback);
+			virtual ~ThreadPoolIOBackend() override;
+
+			virtual bool submit(IORequestState* requestState) override;
+			virtual const char* get_name() const override { return "Thread pool"; }
+
+		private:
+			IOCompletionCallback _completionCallback;
+			std::vector<std::thread> _threads;
+			std::deque<IORequestState*> _requests;
+			std::mutex _mutex;
+			std::condition_variable _wakeCondition;
+			bool _isAlive{ true };
+	};
+
+#ifdef __linux__
+	// Files are opened on the submitting thread, reads and writes are issued to the ring and completions are
+	// reaped by one thread. Short transfers are resubmitted for the remaining bytes
+	class IOUringIOBackend final : public IAsyncIOBackend
+	{
+		public:
+			// Returns null if io_uring is not supported or disabled by the kernel
+			static std::unique_ptr<IOUringIOBackend> create(uint32_t queueDepth, const IOCompletionCallback& completionCallback);
+			virtual ~IOUringIOBackend() override;
+
+			virtual bool submit(IORequestState* requestState) override;
+			virtual const char* get_name() const override { return "io_uring"; }
+
+		private:
+			struct SubmissionQueue
+			{
+				uint32_t* head{ nullptr };
+				uint32_t* tail{ nullptr };
+				uint32_t* mask{ nullptr };
+				uint32_t* array{ nullptr };
+				void* entries{ nullptr };						// io_uring_sqe array
+				uint32_t entryCount{ 0 };
+				void* ring{ nullptr };
+				size_t ringSize{ 0 };
+				size_t entriesSize{ 0 };
+			};
+
+			struct CompletionQueue
+			{
+				uint32_t* head{ nullptr };
+				uint32_t* tail{ nullptr };
+				uint32_t* mask{ nullptr };
+				void* entries{ nullptr };						// io_uring_cqe array
+				void* ring{ nullptr };
+				size_t ringSize{ 0 };
+			};
+
+			IOCompletionCallback _completionCallback;
+			int _ringFile{ -1 };
+			SubmissionQueue _submissionQueue;
+			CompletionQueue _completionQueue;
+			std::mutex _submissionMutex;
+			std::thread _completionThread;
+
+			IOUringIOBackend(const IOCompletionCallback& completionCallback) : _completionCallback(completionCallback) { }
+
+			bool init(uint32_t queueDepth);
+			// Null request state is used to wake up and stop the completion thread. Returns false if the ring
+			// has rejected the submission, the request has not been issued in this case
+			bool push_submission(IORequestState* requestState);
+			void reap_completions();
+	};
+#endif
+}
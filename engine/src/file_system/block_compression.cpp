@@ -0,0 +1,234 @@
+#include "block_compression.h"
+#include "profiler/logger.h"
+
+#include <lz4/lz4.h>
+#include <lz4/lz4hc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+using namespace ad_astris;
+using namespace io;
+
+namespace
+{
+	// Blocks are taken by tasks one by one, so tasks that get incompressible blocks don't wait for others
+	template<typename BlockHandler>
+	void execute_for_blocks(uint32_t blockCount, tasks::TaskComposer* taskComposer, const BlockHandler& blockHandler)
+	{
+		if (!taskComposer || blockCount < 2)
+		{
+			for (uint32_t i = 0; i != blockCount; ++i)
+				blockHandler(i);
+			return;
+		}
+
+		std::atomic<uint32_t> nextBlockIndex{ 0 };
+		auto taskHandler = [&](tasks::TaskExecutionInfo)
+		{
+			for (uint32_t i = nextBlockIndex.fetch_add(1); i < blockCount; i = nextBlockIndex.fetch_add(1))
+				blockHandler(i);
+		};
+
+		tasks::TaskGroup taskGroup;
+		uint32_t taskCount = std::min(blockCount, taskComposer->get_thread_count());
+		for (uint32_t i = 0; i != taskCount; ++i)
+			taskComposer->execute(taskGroup, taskHandler);
+		taskComposer->wait(taskGroup);
+	}
+}
+
+void BlockCompressor::compress(
+	const uint8_t* data,
+	uint64_t size,
+	const BlockCompressionSettings& settings,
+	std::vector<CompressedBlock>& outBlocks,
+	std::vector<uint8_t>& outData,
+	tasks::TaskComposer* taskComposer)
+{
+	uint32_t blockSize = get_block_size(settings);
+	uint32_t blockCount = (size + blockSize - 1) / blockSize;
+	outBlocks.resize(blockCount);
+	outData.clear();
+
+	if (settings.codec == BlockCodec::NONE)
+	{
+		for (uint32_t i = 0; i != blockCount; ++i)
+		{
+			CompressedBlock& block = outBlocks[i];
+			block.offset = uint64_t(i) * blockSize;
+			block.size = std::min<uint64_t>(blockSize, size - block.offset);
+			block.codec = BlockCodec::NONE;
+		}
+		return;
+	}
+
+	// Each block is compressed into its own slot of the staging buffer, then slots are packed
+	uint64_t slotSize = LZ4_compressBound(blockSize);
+	std::unique_ptr<uint8_t[]> stagingData(new uint8_t[slotSize * blockCount]);
+	execute_for_blocks(blockCount, taskComposer, [&](uint32_t blockIndex)
+	{
+		uint64_t sourceOffset = uint64_t(blockIndex) * blockSize;
+		int sourceSize = std::min<uint64_t>(blockSize, size - sourceOffset);
+		const char* source = reinterpret_cast<const char*>(data + sourceOffset);
+		char* destination = reinterpret_cast<char*>(stagingData.get() + slotSize * blockIndex);
+
+		int compressedSize = 0;
+		if (settings.codec == BlockCodec::LZ4_HC)
+		{
+			int level = settings.level ? settings.level : LZ4HC_CLEVEL_DEFAULT;
+			compressedSize = LZ4_compress_HC(source, destination, sourceSize, slotSize, level);
+		}
+		else
+		{
+			compressedSize = LZ4_compress_default(source, destination, sourceSize, slotSize);
+		}
+
+		CompressedBlock& block = outBlocks[blockIndex];
+		if (compressedSize > 0 && compressedSize < sourceSize)
+		{
+			block.size = compressedSize;
+			block.codec = settings.codec == BlockCodec::LZ4_HC ? BlockCodec::LZ4 : settings.codec;
+		}
+		else
+		{
+			memcpy(destination, source, sourceSize);
+			block.size = sourceSize;
+			block.codec = BlockCodec::NONE;
+		}
+	});
+
+	uint64_t dataSize = 0;
+	for (auto& block : outBlocks)
+	{
+		block.offset = dataSize;
+		dataSize += block.size;
+	}
+	outData.resize(dataSize);
+	for (uint32_t i = 0; i != blockCount; ++i)
+		memcpy(outData.data() + outBlocks[i].offset, stagingData.get() + slotSize * i, outBlocks[i].size);
+}
+
+uint32_t BlockCompressor::get_block_size(const BlockCompressionSettings& settings)
+{
+	return std::min<uint32_t>(settings.blockSize ? settings.blockSize : DEFAULT_COMPRESSION_BLOCK_SIZE, LZ4_MAX_INPUT_SIZE);
+}
+
+bool BlockFileView::is_block_file(const uint8_t* data, uint64_t size)
+{
+	uint64_t magic = 0;
+	if (size < sizeof(BlockFileHeader))
+		return false;
+	memcpy(&magic, data, sizeof(uint64_t));
+	return magic == BLOCK_FILE_MAGIC;
+}
+
+bool BlockFileView::init(const uint8_t* data, uint64_t size)
+{
+	if (!is_block_file(data, size))
+		return false;
+
+	const BlockFileHeader* header = reinterpret_cast<const BlockFileHeader*>(data);
+	uint64_t tableSize = uint64_t(header->blockCount) * sizeof(CompressedBlock);
+	uint64_t headerSize = sizeof(BlockFileHeader) + tableSize;
+	if (header->version != BLOCK_FILE_VERSION || headerSize > size || header->metadataSize > size - headerSize)
+	{
+		LOG_ERROR("BlockFileView::init(): File has unsupported version or its header is out of bounds")
+		return false;
+	}
+	if (header->blobSize && (!header->blockSize || (header->blobSize + header->blockSize - 1) / header->blockSize != header->blockCount))
+	{
+		LOG_ERROR("BlockFileView::init(): Block count {} doesn't match blob size {}", header->blockCount, header->blobSize)
+		return false;
+	}
+
+	const CompressedBlock* blocks = reinterpret_cast<const CompressedBlock*>(data + sizeof(BlockFileHeader));
+	uint64_t blockDataSize = size - headerSize - header->metadataSize;
+	for (uint32_t i = 0; i != header->blockCount; ++i)
+	{
+		if (blocks[i].offset > blockDataSize || blocks[i].size > blockDataSize - blocks[i].offset)
+		{
+			LOG_ERROR("BlockFileView::init(): Block {} is out of bounds", i)
+			return false;
+		}
+	}
+
+	_header = header;
+	_blocks = blocks;
+	_metadata = reinterpret_cast<const char*>(data + headerSize);
+	_blockData = data + headerSize + header->metadataSize;
+	return true;
+}
+
+bool BlockFileView::read_blob(uint8_t* destination, uint64_t offset, uint64_t size, tasks::TaskComposer* taskComposer) const
+{
+	if (offset > _header->blobSize || size > _header->blobSize - offset)
+	{
+		LOG_ERROR("BlockFileView::read_blob(): Range [{}, {}) is out of the blob of size {}", offset, offset + size, _header->blobSize)
+		return false;
+	}
+	if (!size)
+		return true;
+
+	uint32_t firstBlock = offset / _header->blockSize;
+	uint32_t lastBlock = (offset + size - 1) / _header->blockSize;
+	std::atomic_bool isSucceeded{ true };
+	execute_for_blocks(lastBlock - firstBlock + 1, taskComposer, [&](uint32_t index)
+	{
+		uint32_t blockIndex = firstBlock + index;
+		uint64_t blockOffset = uint64_t(blockIndex) * _header->blockSize;
+		uint64_t rangeBegin = std::max(offset, blockOffset);
+		uint64_t rangeEnd = std::min(offset + size, blockOffset + _header->blockSize);
+		if (!read_block(blockIndex, destination + rangeBegin - offset, rangeBegin - blockOffset, rangeEnd - rangeBegin))
+			isSucceeded.store(false);
+	});
+
+	if (!isSucceeded.load())
+	{
+		LOG_ERROR("BlockFileView::read_blob(): Failed to decompress blocks")
+		return false;
+	}
+	return true;
+}
+
+bool BlockFileView::read_block(uint32_t blockIndex, uint8_t* destination, uint64_t offsetInBlock, uint64_t size) const
+{
+	const CompressedBlock& block = _blocks[blockIndex];
+	uint64_t blockOffset = uint64_t(blockIndex) * _header->blockSize;
+	uint64_t uncompressedSize = std::min<uint64_t>(_header->blockSize, _header->blobSize - blockOffset);
+	const uint8_t* source = _blockData + block.offset;
+
+	if (block.codec == BlockCodec::NONE)
+	{
+		if (block.size != uncompressedSize)
+			return false;
+		memcpy(destination, source + offsetInBlock, size);
+		return true;
+	}
+	if (block.codec != BlockCodec::LZ4)
+		return false;
+
+	// Whole blocks are decompressed straight into the destination. Edges of the range need a temporary block,
+	// but the prefix of a block is decompressed partially
+	if (!offsetInBlock)
+	{
+		int decompressedSize = size == uncompressedSize
+			? LZ4_decompress_safe(reinterpret_cast<const char*>(source), reinterpret_cast<char*>(destination), block.size, size)
+			: LZ4_decompress_safe_partial(reinterpret_cast<const char*>(source), reinterpret_cast<char*>(destination), block.size, size, size);
+		return decompressedSize == static_cast<int>(size);
+	}
+
+	std::unique_ptr<uint8_t[]> blockData(new uint8_t[offsetInBlock + size]);
+	int decompressedSize = LZ4_decompress_safe_partial(
+		reinterpret_cast<const char*>(source),
+		reinterpret_cast<char*>(blockData.get()),
+		block.size,
+		offsetInBlock + size,
+		offsetInBlock + size);
+	if (decompressedSize != static_cast<int>(offsetInBlock + size))
+		return false;
+	memcpy(destination, blockData.get() + offsetInBlock, size);
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "multithreading/task_composer.h"
+
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+namespace ad_astris::io
+{
+	constexpr uint64_t BLOCK_FILE_MAGIC = 0x3246454C49464141;		// "AAFILEF2", can't be a metadata size of v1 files
+	constexpr uint32_t BLOCK_FILE_VERSION = 2;
+	constexpr uint32_t DEFAULT_COMPRESSION_BLOCK_SIZE = 256 * 1024;
+
+	enum class BlockCodec : uint32_t
+	{
+		NONE = 0,
+		LZ4 = 1,
+		LZ4_HC = 2			// Slower compression, same decompression speed as LZ4
+	};
+
+	struct BlockCompressionSettings
+	{
+		BlockCodec codec{ BlockCodec::LZ4 };
+		int32_t level{ 0 };							// Used only by LZ4_HC, 0 means LZ4HC_CLEVEL_DEFAULT
+		uint32_t blockSize{ DEFAULT_COMPRESSION_BLOCK_SIZE };
+	};
+
+	// Layout of v2 files: header, block table, metadata, block data. Blocks of the binary blob are compressed
+	// independently, so they are decompressed in parallel and a range of the blob is read without the rest
+	struct BlockFileHeader
+	{
+		uint64_t magic{ BLOCK_FILE_MAGIC };
+		uint32_t version{ BLOCK_FILE_VERSION };
+		uint32_t blockSize{ 0 };
+		uint64_t metadataSize{ 0 };
+		uint64_t blobSize{ 0 };
+		uint32_t blockCount{ 0 };
+		uint32_t reserved{ 0 };
+	};
+
+	struct CompressedBlock
+	{
+		uint64_t offset{ 0 };						// Offset in block data
+		uint32_t size{ 0 };							// Size in the file
+		BlockCodec codec{ BlockCodec::NONE };		// Blocks that don't become smaller are stored uncompressed
+	};
+
+	static_assert(sizeof(BlockFileHeader) == 40);
+	static_assert(sizeof(CompressedBlock) == 16);
+
+	class BlockCompressor
+	{
+		public:
+			// If the codec is NONE, outData stays empty and blocks describe the source data, so it can be written
+			// without copying. Blocks are compressed in parallel if taskComposer is not null
+			static void compress(
+				const uint8_t* data,
+				uint64_t size,
+				const BlockCompressionSettings& settings,
+				std::vector<CompressedBlock>& outBlocks,
+				std::vector<uint8_t>& outData,
+				tasks::TaskComposer* taskComposer = nullptr);
+
+			// Block size that is used with the settings
+			static uint32_t get_block_size(const BlockCompressionSettings& settings);
+	};
+
+	// Points into serialized data, for example a file mapping, so nothing is copied before decompression
+	class BlockFileView
+	{
+		public:
+			static bool is_block_file(const uint8_t* data, uint64_t size);
+
+			// Returns false if data is not a valid v2 file
+			bool init(const uint8_t* data, uint64_t size);
+
+			// Decompresses [offset, offset + size) of the blob straight into destination. Only blocks that overlap
+			// the range are decompressed. Blocks are decompressed in parallel if taskComposer is not null
+			bool read_blob(uint8_t* destination, uint64_t offset, uint64_t size, tasks::TaskComposer* taskComposer = nullptr) const;
+
+			std::string_view get_metadata() const
+			{
+				return std::string_view(_metadata, _header->metadataSize);
+			}
+
+			uint64_t get_blob_size() const { return _header->blobSize; }
+			uint32_t get_block_size() const { return _header->blockSize; }
+			uint32_t get_block_count() const { return _header->blockCount; }
+
+		private:
+			const BlockFileHeader* _header{ nullptr };
+			const CompressedBlock* _blocks{ nullptr };
+			const char* _metadata{ nullptr };
+			const uint8_t* _blockData{ nullptr };
+
+			bool read_block(uint32_t blockIndex, uint8_t* destination, uint64_t offsetInBlock, uint64_t size) const;
+	};
+}
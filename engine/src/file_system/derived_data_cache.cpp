@@ -0,0 +1,282 @@
+#include "derived_data_cache.h"
+#include "profiler/logger.h"
+
+#include <lz4/xxhash.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <vector>
+
+using namespace ad_astris;
+using namespace io;
+
+namespace
+{
+	const std::string ENTRY_EXTENSION = ".aaddc";
+	const std::string TEMP_EXTENSION = ".tmp";
+
+	struct DerivedDataHeader
+	{
+		uint64_t magic{ DERIVED_DATA_MAGIC };
+		uint32_t version{ DERIVED_DATA_VERSION };
+		uint32_t reserved{ 0 };
+		DerivedDataKey key;
+		uint64_t dataSize{ 0 };
+		uint64_t dataHash{ 0 };
+	};
+
+	static_assert(sizeof(DerivedDataHeader) == 56);
+}
+
+uint64_t DerivedDataKey::get_hash() const
+{
+	return XXH64(this, sizeof(DerivedDataKey), 0);
+}
+
+DerivedDataCache::DerivedDataCache(const std::filesystem::path& directory, uint64_t maxSize)
+	: _directory(directory), _maxSize(maxSize)
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(_directory, errorCode);
+	if (errorCode)
+	{
+		LOG_ERROR("DerivedDataCache::DerivedDataCache(): Failed to create directory {}", _directory.string())
+		return;
+	}
+	scan_directory();
+}
+
+bool DerivedDataCache::load(const DerivedDataKey& key, std::string& outData)
+{
+	uint64_t hash = key.get_hash();
+	{
+		std::scoped_lock<std::mutex> lock(_mutex);
+		if (_entryByHash.find(hash) == _entryByHash.end())
+		{
+			++_statistics.missCount;
+			return false;
+		}
+	}
+
+	// Files are read without the lock, an entry that is evicted meanwhile fails to open and is a miss
+	std::filesystem::path entryPath = get_entry_path(hash);
+	std::ifstream stream(entryPath, std::ios::binary | std::ios::ate);
+	uint64_t fileSize = stream ? static_cast<uint64_t>(stream.tellg()) : 0;
+	DerivedDataHeader header;
+	bool isValid = fileSize >= sizeof(DerivedDataHeader);
+	if (isValid)
+	{
+		stream.seekg(0);
+		isValid = stream.read(reinterpret_cast<char*>(&header), sizeof(DerivedDataHeader))
+			&& header.magic == DERIVED_DATA_MAGIC
+			&& header.version == DERIVED_DATA_VERSION
+			&& header.dataSize == fileSize - sizeof(DerivedDataHeader);
+	}
+
+	// Another key with the same hash, the entry is valid and is replaced by the next store
+	if (isValid && !(header.key == key))
+	{
+		std::scoped_lock<std::mutex> lock(_mutex);
+		++_statistics.missCount;
+		return false;
+	}
+
+	if (isValid)
+	{
+		outData.resize(header.dataSize);
+		isValid = stream.read(outData.data(), header.dataSize) && XXH64(outData.data(), outData.size(), 0) == header.dataHash;
+	}
+	stream.close();
+
+	std::scoped_lock<std::mutex> lock(_mutex);
+	if (!isValid)
+	{
+		LOG_WARNING("DerivedDataCache::load(): Entry {} is invalid and is removed", entryPath.string())
+		outData.clear();
+		remove_entry(hash);
+		++_statistics.invalidEntryCount;
+		++_statistics.missCount;
+		return false;
+	}
+
+	auto it = _entryByHash.find(hash);
+	if (it != _entryByHash.end())
+		it->second.lastUseIndex = ++_useCounter;
+	++_statistics.hitCount;
+
+	std::error_code errorCode;
+	std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), errorCode);
+	return true;
+}
+
+bool DerivedDataCache::store(const DerivedDataKey& key, const void* data, uint64_t size)
+{
+	uint64_t hash = key.get_hash();
+	uint64_t entrySize = sizeof(DerivedDataHeader) + size;
+	std::filesystem::path tempPath;
+	{
+		std::scoped_lock<std::mutex> lock(_mutex);
+		if (entrySize > _maxSize)
+			return false;
+		tempPath = _directory / fmt::format("{:016x}.{}{}", hash, _tempFileCounter++, TEMP_EXTENSION);
+	}
+
+	DerivedDataHeader header;
+	header.key = key;
+	header.dataSize = size;
+	header.dataHash = XXH64(data, size, 0);
+
+	std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(DerivedDataHeader));
+	stream.write(static_cast<const char*>(data), size);
+	stream.close();
+
+	std::error_code errorCode;
+	std::filesystem::path entryPath = get_entry_path(hash);
+	if (!stream)
+	{
+		LOG_ERROR("DerivedDataCache::store(): Failed to write {}", tempPath.string())
+		std::filesystem::remove(tempPath, errorCode);
+		return false;
+	}
+	std::filesystem::rename(tempPath, entryPath, errorCode);
+	if (errorCode)
+	{
+		LOG_ERROR("DerivedDataCache::store(): Failed to rename {} to {}", tempPath.string(), entryPath.string())
+		std::filesystem::remove(tempPath, errorCode);
+		return false;
+	}
+
+	std::scoped_lock<std::mutex> lock(_mutex);
+	auto it = _entryByHash.find(hash);
+	if (it != _entryByHash.end())
+	{
+		_statistics.size -= it->second.size;
+		--_statistics.entryCount;
+	}
+	_entryByHash[hash] = Entry{ entrySize, ++_useCounter };
+	_statistics.size += entrySize;
+	++_statistics.entryCount;
+	++_statistics.storeCount;
+	evict();
+	return true;
+}
+
+void DerivedDataCache::remove(const DerivedDataKey& key)
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	remove_entry(key.get_hash());
+}
+
+void DerivedDataCache::clear()
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	while (!_entryByHash.empty())
+		remove_entry(_entryByHash.begin()->first);
+}
+
+void DerivedDataCache::set_max_size(uint64_t maxSize)
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	_maxSize = maxSize;
+	evict();
+}
+
+uint64_t DerivedDataCache::get_max_size() const
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	return _maxSize;
+}
+
+DerivedDataCacheStatistics DerivedDataCache::get_statistics() const
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	return _statistics;
+}
+
+std::filesystem::path DerivedDataCache::get_entry_path(uint64_t hash) const
+{
+	return _directory / fmt::format("{:016x}{}", hash, ENTRY_EXTENSION);
+}
+
+void DerivedDataCache::scan_directory()
+{
+	struct ScannedEntry
+	{
+		uint64_t hash;
+		uint64_t size;
+		std::filesystem::file_time_type lastWriteTime;
+	};
+
+	std::vector<ScannedEntry> scannedEntries;
+	std::error_code errorCode;
+	for (auto& directoryEntry : std::filesystem::directory_iterator(_directory, errorCode))
+	{
+		const std::filesystem::path& path = directoryEntry.path();
+		// Temporary files are left by processes that were terminated while storing an entry
+		if (path.extension() == TEMP_EXTENSION)
+		{
+			std::filesystem::remove(path, errorCode);
+			continue;
+		}
+
+		std::string stem = path.stem().string();
+		bool isHash = stem.size() == 16 && std::all_of(stem.begin(), stem.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; });
+		if (path.extension() != ENTRY_EXTENSION || !isHash || !directoryEntry.is_regular_file(errorCode))
+			continue;
+
+		ScannedEntry scannedEntry;
+		scannedEntry.hash = std::stoull(stem, nullptr, 16);
+		scannedEntry.size = directoryEntry.file_size(errorCode);
+		scannedEntry.lastWriteTime = directoryEntry.last_write_time(errorCode);
+		scannedEntries.push_back(scannedEntry);
+	}
+
+	std::sort(scannedEntries.begin(), scannedEntries.end(), [](const ScannedEntry& first, const ScannedEntry& second)
+	{
+		return first.lastWriteTime < second.lastWriteTime;
+	});
+
+	std::scoped_lock<std::mutex> lock(_mutex);
+	for (auto& scannedEntry : scannedEntries)
+	{
+		_entryByHash[scannedEntry.hash] = Entry{ scannedEntry.size, ++_useCounter };
+		_statistics.size += scannedEntry.size;
+		++_statistics.entryCount;
+	}
+	evict();
+}
+
+void DerivedDataCache::remove_entry(uint64_t hash)
+{
+	auto it = _entryByHash.find(hash);
+	if (it == _entryByHash.end())
+		return;
+
+	std::error_code errorCode;
+	std::filesystem::remove(get_entry_path(hash), errorCode);
+	_statistics.size -= it->second.size;
+	--_statistics.entryCount;
+	_entryByHash.erase(it);
+}
+
+void DerivedDataCache::evict()
+{
+	if (_statistics.size <= _maxSize)
+		return;
+
+	std::vector<std::pair<uint64_t, uint64_t>> hashesByLastUse;
+	hashesByLastUse.reserve(_entryByHash.size());
+	for (auto& [hash, entry] : _entryByHash)
+		hashesByLastUse.emplace_back(entry.lastUseIndex, hash);
+	std::sort(hashesByLastUse.begin(), hashesByLastUse.end());
+
+	for (auto& [lastUseIndex, hash] : hashesByLastUse)
+	{
+		if (_statistics.size <= _maxSize)
+			break;
+		remove_entry(hash);
+		++_statistics.evictionCount;
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace ad_astris::io
+{
+	constexpr uint64_t DERIVED_DATA_MAGIC = 0x4344444146414141;		// "AAAFADDC"
+	constexpr uint32_t DERIVED_DATA_VERSION = 1;
+	constexpr uint64_t DEFAULT_DERIVED_DATA_CACHE_SIZE = 4ull * 1024 * 1024 * 1024;
+
+	// Identifies data that was produced from a source. If any field changes, the data is produced again
+	struct DerivedDataKey
+	{
+		uint64_t sourceHash{ 0 };			// Hash of the source file and files it depends on
+		uint64_t settingsHash{ 0 };			// Hash of settings that change the output
+		uint32_t producerVersion{ 0 };		// Must be increased when the producer changes its output
+		uint32_t type{ 0 };
+
+		bool operator==(const DerivedDataKey& other) const
+		{
+			return sourceHash == other.sourceHash && settingsHash == other.settingsHash
+				&& producerVersion == other.producerVersion && type == other.type;
+		}
+
+		uint64_t get_hash() const;
+	};
+
+	static_assert(sizeof(DerivedDataKey) == 24);
+
+	struct DerivedDataCacheStatistics
+	{
+		uint64_t hitCount{ 0 };
+		uint64_t missCount{ 0 };
+		uint64_t storeCount{ 0 };
+		uint64_t evictionCount{ 0 };
+		uint64_t invalidEntryCount{ 0 };		// Entries that were removed because they were truncated or corrupted
+		uint64_t size{ 0 };
+		uint64_t entryCount{ 0 };
+	};
+
+	// Content-addressed cache of derived data on disk, one file per entry. Entry files are named by the key hash
+	// and store the key and a hash of the data, so collisions and corrupted entries are treated as misses.
+	// Entries are written to a temporary file and renamed, so readers never see a partially written entry.
+	// When the cache is larger than its limit, least recently used entries are removed. The order is kept
+	// in last write times of entries, so it survives restarts. Thread-safe
+	class DerivedDataCache
+	{
+		public:
+			DerivedDataCache(const std::filesystem::path& directory, uint64_t maxSize = DEFAULT_DERIVED_DATA_CACHE_SIZE);
+
+			DerivedDataCache(const DerivedDataCache&) = delete;
+			DerivedDataCache& operator=(const DerivedDataCache&) = delete;
+
+			bool load(const DerivedDataKey& key, std::string& outData);
+			// Replaces the previous entry with the same key. Data larger than the limit is not stored
+			bool store(const DerivedDataKey& key, const void* data, uint64_t size);
+			void remove(const DerivedDataKey& key);
+			void clear();
+
+			// Evicts entries immediately if the cache is larger than the new limit
+			void set_max_size(uint64_t maxSize);
+			uint64_t get_max_size() const;
+			DerivedDataCacheStatistics get_statistics() const;
+			const std::filesystem::path& get_directory() const { return _directory; }
+
+		private:
+			struct Entry
+			{
+				uint64_t size{ 0 };
+				uint64_t lastUseIndex{ 0 };
+			};
+
+			std::filesystem::path _directory;
+			mutable std::mutex _mutex;
+			std::unordered_map<uint64_t, Entry> _entryByHash;
+			DerivedDataCacheStatistics _statistics;
+			uint64_t _maxSize{ 0 };
+			uint64_t _useCounter{ 0 };
+			uint64_t _tempFileCounter{ 0 };
+
+			std::filesystem::path get_entry_path(uint64_t hash) const;
+			void scan_directory();
+			void remove_entry(uint64_t hash);
+			void evict();
+	};
+}
@@ -11,56 +11,74 @@ using namespace io;
 
 File::~File()
 {
-	delete[] _binBlob;
+	release_binary_blob();
 }
 
-void File::serialize(
-	std::vector<uint8_t>& inputBinData,
-	std::string& inputMetadata,
-	std::vector<uint8_t>& outputData)
+std::shared_ptr<uint8_t> File::share_binary_blob()
 {
-	uint64_t metadataSize = inputMetadata.size();
-	uint64_t binDataSize = inputBinData.size();
-	uint64_t compressedBinDataSize = 0;
-	std::vector<uint8_t> compressedBinData;
+	if (!_binBlob)
+		return nullptr;
+	if (_sharedBinBlob)
+		return _sharedBinBlob;
 
-	if (binDataSize)
+	// Tracking is moved to the reference, so the blob is recorded as freed when the last reference is released
+	uint64_t trackedSize = _trackedBinBlobSize;
+	_trackedBinBlobSize = 0;
+	_sharedBinBlob = std::shared_ptr<uint8_t>(_binBlob, [trackedSize](uint8_t* blob)
 	{
-		uint64_t compressStaging = binDataSize ? LZ4_compressBound(binDataSize) : 0;
-		compressedBinData.resize(compressStaging);
-		compressedBinDataSize = LZ4_compress_default(
-		   (const char*)inputBinData.data(),
-		   (char*)compressedBinData.data(),
-		   binDataSize,
-		   compressStaging);
-		compressedBinData.resize(compressedBinDataSize);
-	}
+		if (trackedSize)
+			MemoryTracker::record_free(MemoryTag::RESOURCES, trackedSize);
+		delete[] blob;
+	});
+	return _sharedBinBlob;
+}
 
-	uint64_t outputDataSize = sizeof(uint64_t) * 3 + metadataSize + compressedBinDataSize;
-	outputData.resize(outputDataSize);
-	uint8_t* outputDataPtr = outputData.data();
-	
-	std::vector<uint64_t> sizes = { metadataSize, compressedBinDataSize, binDataSize };
-	memcpy(outputDataPtr, sizes.data(), sizeof(uint64_t) * sizes.size());
-	outputDataPtr += sizeof(uint64_t) * sizes.size();
-	
-	if (metadataSize)
+void File::release_binary_blob()
+{
+	if (!_sharedBinBlob)
 	{
-		memcpy(outputDataPtr, inputMetadata.c_str(), metadataSize);
-		outputDataPtr += metadataSize;
+		untrack_binary_blob();
+		delete[] _binBlob;
 	}
+	_sharedBinBlob.reset();
+	_binBlob = nullptr;
+}
 
-	if (compressedBinDataSize)
+void File::serialize(
+	std::vector<uint8_t>& inputBinData,
+	std::string& inputMetadata,
+	std::vector<uint8_t>& outputData)
+{
+	SerializedFile serializedFile;
+	serialize_blocks(inputBinData.data(), inputBinData.size(), inputMetadata, _compressionSettings, _taskComposer, serializedFile);
+
+	outputData.resize(serializedFile.get_size());
+	uint8_t* outputDataPtr = outputData.data();
+	for (auto& part : serializedFile.parts)
 	{
-		memcpy(outputDataPtr, compressedBinData.data(), compressedBinDataSize);
+		memcpy(outputDataPtr, part.data, part.size);
+		outputDataPtr += part.size;
 	}
 }
 
-void File::deserialize(
+bool File::deserialize(
 	std::vector<uint8_t>& inputData,
 	std::vector<uint8_t>& outputBinData,
 	std::string& outputMetadata)
 {
+	if (BlockFileView::is_block_file(inputData.data(), inputData.size()))
+	{
+		BlockFileView view;
+		if (!view.init(inputData.data(), inputData.size()))
+		{
+			LOG_ERROR("File::deserialize(): Block file {} is invalid", _path.c_str())
+			return false;
+		}
+		outputMetadata = view.get_metadata();
+		outputBinData.resize(view.get_blob_size());
+		return view.read_blob(outputBinData.data(), 0, outputBinData.size(), _taskComposer);
+	}
+
 	uint8_t* inputDataPtr = inputData.data();
 	
 	uint64_t metadataSize = 0;
@@ -87,12 +105,18 @@ void File::deserialize(
 		std::vector<uint8_t> compressedBin(compressedBinDataSize);
 		memcpy(compressedBin.data(), inputDataPtr, compressedBinDataSize);
 		outputBinData.resize(binDataSize);
-		LZ4_decompress_safe(
+		int decompressedSize = LZ4_decompress_safe(
 			(char*)compressedBin.data(),
 			(char*)outputBinData.data(),
 			compressedBinDataSize,
 			binDataSize);
+		if (static_cast<uint64_t>(decompressedSize) != binDataSize)
+		{
+			LOG_ERROR("File::deserialize(): Failed to decompress the blob of {}", _path.c_str())
+			return false;
+		}
 	}
+	return true;
 }
 
 void File::serialize(uint8_t*& data, uint64_t& size)
@@ -102,45 +126,86 @@ void File::serialize(uint8_t*& data, uint64_t& size)
 
 void File::serialize(uint8_t** outputData, uint64_t* outputDataSize) const
 {
-	uint64_t compressedBinDataSize = 0;
-	std::vector<uint8_t> compressedBinData;
+	SerializedFile serializedFile;
+	serialize(serializedFile);
 
-	if (_binBlob && _binBlobSize)
+	*outputDataSize = serializedFile.get_size();
+	*outputData = new uint8_t[*outputDataSize];
+
+	uint8_t* tempDataPtr = *outputData;
+	for (auto& part : serializedFile.parts)
 	{
-		uint64_t compressStaging = LZ4_compressBound(_binBlobSize);
-		compressedBinData.resize(compressStaging);
-		compressedBinDataSize = LZ4_compress_default(
-		   (const char*)_binBlob,
-		   (char*)compressedBinData.data(),
-		   _binBlobSize,
-		   compressStaging);
-		compressedBinData.resize(compressedBinDataSize);
+		memcpy(tempDataPtr, part.data, part.size);
+		tempDataPtr += part.size;
 	}
+}
 
-	*outputDataSize = sizeof(uint64_t) * 3 + _metadata.size() + compressedBinDataSize;
-	*outputData = new uint8_t[*outputDataSize];
+void File::serialize(SerializedFile& outputFile) const
+{
+	serialize_blocks(_binBlob, _binBlob ? _binBlobSize : 0, _metadata, _compressionSettings, _taskComposer, outputFile);
+}
 
-	uint8_t* tempDataPtr = *outputData;
-	
-	std::vector<uint64_t> sizes = { _metadata.size(), compressedBinDataSize, _binBlobSize };
-	memcpy(tempDataPtr, sizes.data(), sizeof(uint64_t) * sizes.size());
-	tempDataPtr += sizeof(uint64_t) * sizes.size();
-	
-	if (_metadata.size())
+void File::serialize_blocks(
+	const uint8_t* binData,
+	uint64_t binDataSize,
+	const std::string& metadata,
+	const BlockCompressionSettings& settings,
+	tasks::TaskComposer* taskComposer,
+	SerializedFile& outputFile)
+{
+	BlockCompressor::compress(binData, binDataSize, settings, outputFile.blocks, outputFile.compressedBinBlob, taskComposer);
+
+	BlockFileHeader& header = outputFile.blockFileHeader;
+	header = BlockFileHeader();
+	header.blockSize = BlockCompressor::get_block_size(settings);
+	header.metadataSize = metadata.size();
+	header.blobSize = binDataSize;
+	header.blockCount = outputFile.blocks.size();
+
+	// Uncompressed blobs are written from the file itself
+	bool isCompressed = settings.codec != BlockCodec::NONE;
+	outputFile.parts = {
+		{ &header, sizeof(BlockFileHeader) },
+		{ outputFile.blocks.data(), outputFile.blocks.size() * sizeof(CompressedBlock) },
+		{ metadata.data(), metadata.size() },
+		{ isCompressed ? outputFile.compressedBinBlob.data() : binData, isCompressed ? outputFile.compressedBinBlob.size() : binDataSize } };
+}
+
+bool File::deserialize(const uint8_t* data, uint64_t size)
+{
+	if (BlockFileView::is_block_file(data, size))
 	{
-		memcpy(tempDataPtr, _metadata.c_str(), _metadata.size());
-		tempDataPtr += _metadata.size();
+		BlockFileView view;
+		if (!view.init(data, size))
+		{
+			LOG_ERROR("File::deserialize(): Block file {} is invalid", _path.c_str())
+			return false;
+		}
+		_metadata = view.get_metadata();
+		_binBlobSize = view.get_blob_size();
+		if (_binBlobSize)
+		{
+			// Data can be a file mapping, blocks are decompressed from it straight into the blob
+			_binBlob = new uint8_t[_binBlobSize];
+			track_binary_blob();
+			if (!view.read_blob(_binBlob, 0, _binBlobSize, _taskComposer))
+			{
+				release_binary_blob();
+				return false;
+			}
+		}
+		return true;
 	}
 
-	if (!compressedBinData.empty())
+	// Legacy layout: metadata size, compressed blob size and blob size followed by metadata and the compressed blob
+	constexpr uint64_t HEADER_SIZE = 3 * sizeof(uint64_t);
+	if (size < HEADER_SIZE)
 	{
-		memcpy(tempDataPtr, compressedBinData.data(), compressedBinDataSize);
+		LOG_ERROR("File::deserialize(): File {} is smaller than its header", _path.c_str())
+		return false;
 	}
-}
 
-void File::deserialize(uint8_t* data, uint64_t size)
-{
-	uint8_t* tempInputDataPtr = data;
+	const uint8_t* tempInputDataPtr = data;
 	
 	uint64_t metadataSize = 0;
 	memcpy(&metadataSize, tempInputDataPtr, sizeof(uint64_t));
@@ -150,9 +215,24 @@ void File::deserialize(uint8_t* data, uint64_t size)
 	memcpy(&compressedBinDataSize, tempInputDataPtr, sizeof(uint64_t));
 	tempInputDataPtr += sizeof(uint64_t);
 	
-	memcpy(&_binBlobSize, tempInputDataPtr, sizeof(uint64_t));
+	uint64_t binBlobSize = 0;
+	memcpy(&binBlobSize, tempInputDataPtr, sizeof(uint64_t));
 	tempInputDataPtr += sizeof(uint64_t);
 
+	// Sizes are checked one by one, so the subtractions can't overflow
+	if (metadataSize > size - HEADER_SIZE || compressedBinDataSize > size - HEADER_SIZE - metadataSize)
+	{
+		LOG_ERROR("File::deserialize(): Sizes in the header of {} exceed the file size {}", _path.c_str(), size)
+		return false;
+	}
+	// The legacy blob is compressed as a single LZ4 block
+	if (compressedBinDataSize > LZ4_MAX_INPUT_SIZE || binBlobSize > LZ4_MAX_INPUT_SIZE)
+	{
+		LOG_ERROR("File::deserialize(): Blob of {} is too large for LZ4", _path.c_str())
+		return false;
+	}
+	_binBlobSize = binBlobSize;
+
 	if (metadataSize)
 	{
 		_metadata.resize(metadataSize);
@@ -162,14 +242,21 @@ void File::deserialize(uint8_t* data, uint64_t size)
 
 	if (compressedBinDataSize && _binBlobSize)
 	{
-		std::vector<uint8_t> compressedBin(compressedBinDataSize);
-		memcpy(compressedBin.data(), tempInputDataPtr, compressedBinDataSize);
+		// Data can be a file mapping, the blob is decompressed without copying compressed data
 		_binBlob = new uint8_t[_binBlobSize];
-		LZ4_decompress_safe(
-			(char*)compressedBin.data(),
+		track_binary_blob();
+		int decompressedSize = LZ4_decompress_safe(
+			(const char*)tempInputDataPtr,
 			(char*)_binBlob,
 			compressedBinDataSize,
 			_binBlobSize);
+		if (static_cast<uint64_t>(decompressedSize) != _binBlobSize)
+		{
+			LOG_ERROR("File::deserialize(): Failed to decompress the blob of {}", _path.c_str())
+			release_binary_blob();
+			return false;
+		}
 	}
+	return true;
 }
 
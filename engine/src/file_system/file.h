@@ -1,14 +1,36 @@
 #pragma once
 
 #include "file_system.h"
+#include "block_compression.h"
 #include "utils.h"
 #include "core/visitor.h"
+#include "core/memory_tracker.h"
 
+#include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace ad_astris::io
 {
+	// Parts of a serialized file that can be written with one vectored write without concatenating them
+	struct SerializedFile
+	{
+		std::vector<uint64_t> header;				// Used by files with their own layout
+		BlockFileHeader blockFileHeader;
+		std::vector<CompressedBlock> blocks;
+		std::vector<uint8_t> compressedBinBlob;
+		std::vector<WriteBuffer> parts;			// Point to the headers, the metadata and the blob of the file
+
+		uint64_t get_size() const
+		{
+			uint64_t size = 0;
+			for (auto& part : parts)
+				size += part.size;
+			return size;
+		}
+	};
+
 	class File
 	{
 		public:
@@ -18,12 +40,16 @@ namespace ad_astris::io
 		
 			virtual void serialize(uint8_t*& data, uint64_t& size);
 			virtual void serialize(uint8_t** outputData, uint64_t* outputDataSize) const;
-			virtual void deserialize(uint8_t* data, uint64_t size);
+			// Parts point to the metadata of the file, so the file must not be changed while they are used.
+			// Files are written in the v2 block format, see BlockFileHeader
+			virtual void serialize(SerializedFile& outputFile) const;
+			// Reads v2 files and v1 files with a single LZ4 blob. Returns false if the data is corrupted
+			virtual bool deserialize(const uint8_t* data, uint64_t size);
 			virtual void serialize(
 				std::vector<uint8_t>& inputBinData,
 				std::string& inputMetadata,
 				std::vector<uint8_t>& outputBinBlob);
-			virtual void deserialize(
+			virtual bool deserialize(
 				std::vector<uint8_t>& inputData,
 				std::vector<uint8_t>& outputBinData,
 				std::string& outputMetadata);
@@ -33,9 +59,38 @@ namespace ad_astris::io
 			{
 				return _binBlob && !_metadata.empty();
 			}
+
+			void set_compression_settings(const BlockCompressionSettings& settings)
+			{
+				_compressionSettings = settings;
+			}
+
+			// If set, blocks are compressed and decompressed in parallel
+			void set_task_composer(tasks::TaskComposer* taskComposer)
+			{
+				_taskComposer = taskComposer;
+			}
+		
+			// Resources that support blob views keep a reference to the blob instead of copying data from it.
+			// Must be set before the resource is deserialized
+			void set_blob_views_enabled(bool isEnabled)
+			{
+				_areBlobViewsEnabled = isEnabled;
+			}
+
+			bool are_blob_views_enabled() const
+			{
+				return _areBlobViewsEnabled;
+			}
+
+			// Returns a reference that keeps the blob alive after the file is destroyed or gets another blob.
+			// The file still points to the blob
+			std::shared_ptr<uint8_t> share_binary_blob();
 		
 			void set_binary_blob(uint8_t* blob, uint64_t blobSize)
 			{
+				// The previous blob is freed by its references
+				_sharedBinBlob.reset();
 				_binBlob = blob;
 				_binBlobSize = blobSize;
 			}
@@ -81,5 +136,37 @@ namespace ad_astris::io
 			URI _path;
 			uint8_t* _binBlob{ nullptr };
 			uint64_t _binBlobSize{ 0 };
+			uint64_t _trackedBinBlobSize{ 0 };
+			std::shared_ptr<uint8_t> _sharedBinBlob{ nullptr };
+			bool _areBlobViewsEnabled{ false };
+			BlockCompressionSettings _compressionSettings;
+			tasks::TaskComposer* _taskComposer{ nullptr };
+
+			static void serialize_blocks(
+				const uint8_t* binData,
+				uint64_t binDataSize,
+				const std::string& metadata,
+				const BlockCompressionSettings& settings,
+				tasks::TaskComposer* taskComposer,
+				SerializedFile& outputFile);
+
+			// Frees the blob unless it has been shared, in which case the last reference frees it
+			void release_binary_blob();
+
+			// Must be called when the file allocates the binary blob or takes ownership of it
+			void track_binary_blob()
+			{
+				untrack_binary_blob();
+				_trackedBinBlobSize = _binBlobSize;
+				MemoryTracker::record_allocation(MemoryTag::RESOURCES, _trackedBinBlobSize);
+			}
+
+			void untrack_binary_blob()
+			{
+				if (!_trackedBinBlobSize)
+					return;
+				MemoryTracker::record_free(MemoryTag::RESOURCES, _trackedBinBlobSize);
+				_trackedBinBlobSize = 0;
+			}
 	};
 }
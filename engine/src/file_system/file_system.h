@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mapped_file.h"
+#include "native_file.h"
 #include <filesystem>
 #include <cstdlib>
 #include <cstdio>
@@ -69,11 +71,21 @@ namespace ad_astris::io
 			std::string data;
 	};
 
+	// read() and write() are buffered and use the position of the stream, so they must be called from one thread.
+	// Positional functions don't use the buffer or the position and can be called from several threads at the same
+	// time, buffered writes must be flushed before they are visible to them
 	class Stream
 	{
 		public:	
 			virtual size_t read(void* data, size_t size, size_t count) = 0;
 			virtual size_t write(const void* data, size_t size, size_t count) = 0;
+			// Writes buffers at the position of the stream
+			virtual uint64_t write_vectored(const WriteBuffer* buffers, uint32_t bufferCount) = 0;
+			virtual uint64_t read_at(void* data, uint64_t size, uint64_t offset) = 0;
+			virtual uint64_t write_at(const void* data, uint64_t size, uint64_t offset) = 0;
+			virtual void seek(uint64_t position) = 0;
+			virtual uint64_t tell() const = 0;
+			virtual bool flush() = 0;
 			virtual uint64_t size() const = 0;
 
 			virtual ~Stream() {}
@@ -84,9 +96,20 @@ namespace ad_astris::io
 		public:
 			virtual Stream* open(const URI& path, const char* mode) = 0;
 			virtual bool close(Stream* stream) = 0;
-			virtual void* map_to_read(const URI& uri, size_t& size, const char* mode = "rb") = 0;
-			virtual bool unmap_after_reading(void* data) = 0;
+			// Returns an invalid view if the file can't be mapped. Relative paths are relative to the engine root
+			virtual MappedFile map_file(const URI& uri, MapAccess access = MapAccess::DEFAULT) = 0;
 			virtual void write(const URI& uri, void* data, size_t objectSize, size_t count, const char* mode = "wb") = 0;
+			// Replaces the file with buffers using one vectored write
+			virtual void write(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount) = 0;
+			// Writes buffers to a temporary file in the same directory and renames it, so the previous file stays
+			// valid if the write fails and readers never see a partially written file. Thread-safe
+			virtual bool write_atomic(const URI& uri, const WriteBuffer* buffers, uint32_t bufferCount) = 0;
+
+			// Files of a mounted archive shadow loose files in the mount point for map_file() and read-only open().
+			// Writes always go to loose files
+			virtual bool mount_pak(const URI& pakPath, const URI& mountPoint) = 0;
+			virtual bool unmount_pak(const URI& pakPath) = 0;
+			virtual bool is_packed(const URI& uri) = 0;
 		
 			URI get_engine_root_path()
 			{
@@ -103,6 +126,15 @@ namespace ad_astris::io
 				return _projectRootPath.string().c_str(); 
 			}
 
+			// Relative paths are relative to the engine root
+			std::filesystem::path get_absolute_path(const URI& uri) const
+			{
+				std::filesystem::path path = std::filesystem::path(uri.c_str());
+				if (!path.is_absolute())
+					path = _engineRootPath / path;
+				return path;
+			}
+
 			virtual ~FileSystem() {}
 
 		protected:
@@ -0,0 +1,274 @@
+#include "file_watcher.h"
+#include "profiler/logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace ad_astris;
+using namespace io;
+
+#ifdef _WIN32
+struct FileWatcher::DirectoryWatch
+{
+	HANDLE handle{ INVALID_HANDLE_VALUE };
+	std::string directory;
+	OVERLAPPED overlapped{};
+	alignas(DWORD) uint8_t buffer[64 * 1024];
+};
+#endif
+
+FileWatcher::FileWatcher()
+{
+#ifdef _WIN32
+	_completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+	_isSupported = _completionPort != nullptr;
+#elif defined(__linux__)
+	_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	_wakeUpEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	_isSupported = _inotify >= 0 && _wakeUpEvent >= 0;
+#endif
+
+	if (!_isSupported)
+	{
+		LOG_WARNING("FileWatcher::FileWatcher(): File watching is not supported, changes must be detected with timestamps")
+	}
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (_isRunning.exchange(false))
+	{
+#ifdef _WIN32
+		PostQueuedCompletionStatus(_completionPort, 0, 0, nullptr);
+#elif defined(__linux__)
+		uint64_t value = 1;
+		write(_wakeUpEvent, &value, sizeof(value));
+#endif
+		_thread.join();
+	}
+
+#ifdef _WIN32
+	// The OS writes to the buffer of a watch until the canceled request is completed
+	for (auto& [watch, directoryWatch] : _directoryWatches)
+	{
+		DWORD size = 0;
+		CancelIoEx(directoryWatch->handle, &directoryWatch->overlapped);
+		GetOverlappedResult(directoryWatch->handle, &directoryWatch->overlapped, &size, TRUE);
+		CloseHandle(directoryWatch->handle);
+	}
+	if (_completionPort)
+		CloseHandle(_completionPort);
+#elif defined(__linux__)
+	if (_inotify >= 0)
+		close(_inotify);
+	if (_wakeUpEvent >= 0)
+		close(_wakeUpEvent);
+#endif
+}
+
+bool FileWatcher::watch(const std::filesystem::path& directory)
+{
+	if (!_isSupported)
+		return false;
+
+	std::string normalizedDirectory = normalize_path(directory);
+	std::scoped_lock<std::mutex> lock(_mutex);
+	if (_watchByDirectory.find(normalizedDirectory) != _watchByDirectory.end())
+		return true;
+
+#ifdef _WIN32
+	HANDLE handle = CreateFileW(
+		directory.c_str(),
+		FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	auto directoryWatch = std::make_unique<DirectoryWatch>();
+	directoryWatch->handle = handle;
+	directoryWatch->directory = normalizedDirectory;
+	intptr_t watch = reinterpret_cast<intptr_t>(directoryWatch.get());
+	if (!CreateIoCompletionPort(handle, _completionPort, static_cast<ULONG_PTR>(watch), 0) || !request_changes(directoryWatch.get()))
+	{
+		CloseHandle(handle);
+		return false;
+	}
+	_directoryWatches[watch] = std::move(directoryWatch);
+#elif defined(__linux__)
+	uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_ONLYDIR;
+	intptr_t watch = inotify_add_watch(_inotify, normalizedDirectory.c_str(), mask);
+	if (watch < 0)
+		return false;
+	// Several paths to one directory share a watch, events are reported for the first one
+	_directoryByWatch.emplace(watch, normalizedDirectory);
+#endif
+
+	_watchByDirectory[normalizedDirectory] = watch;
+	if (!_isRunning.exchange(true))
+		_thread = std::thread([this]() { process_events(); });
+	return true;
+}
+
+bool FileWatcher::is_watched(const std::filesystem::path& directory)
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	return _watchByDirectory.find(normalize_path(directory)) != _watchByDirectory.end();
+}
+
+bool FileWatcher::consume_changed_files(std::vector<std::string>& outPaths)
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	outPaths.insert(outPaths.end(), _changedFiles.begin(), _changedFiles.end());
+	_changedFiles.clear();
+	bool isComplete = !_isOverflowed;
+	_isOverflowed = false;
+	return isComplete;
+}
+
+std::string FileWatcher::normalize_path(const std::filesystem::path& path)
+{
+	return path.lexically_normal().generic_string();
+}
+
+#ifdef _WIN32
+bool FileWatcher::request_changes(DirectoryWatch* directoryWatch)
+{
+	DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_CREATION;
+	directoryWatch->overlapped = OVERLAPPED{};
+	return ReadDirectoryChangesW(
+		directoryWatch->handle,
+		directoryWatch->buffer,
+		sizeof(directoryWatch->buffer),
+		FALSE,
+		filter,
+		nullptr,
+		&directoryWatch->overlapped,
+		nullptr);
+}
+
+void FileWatcher::process_events()
+{
+	while (true)
+	{
+		DWORD size = 0;
+		ULONG_PTR key = 0;
+		OVERLAPPED* overlapped = nullptr;
+		BOOL isSucceeded = GetQueuedCompletionStatus(_completionPort, &size, &key, &overlapped, INFINITE);
+		// The destructor posts a packet without a watch
+		if (!key)
+			break;
+
+		DirectoryWatch* directoryWatch = reinterpret_cast<DirectoryWatch*>(key);
+		{
+			std::scoped_lock<std::mutex> lock(_mutex);
+			// Empty notification means that changes didn't fit into the buffer. Requests also fail when
+			// the directory is removed or changes were lost, so callers must check all files again
+			if (!isSucceeded || !size)
+				_isOverflowed = true;
+
+			for (uint8_t* notification = directoryWatch->buffer; isSucceeded && size;)
+			{
+				FILE_NOTIFY_INFORMATION* information = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(notification);
+				std::wstring fileName(information->FileName, information->FileNameLength / sizeof(WCHAR));
+				add_changed_file(directoryWatch->directory, fileName);
+				if (!information->NextEntryOffset)
+					break;
+				notification += information->NextEntryOffset;
+			}
+		}
+
+		if (!request_changes(directoryWatch))
+		{
+			LOG_WARNING("FileWatcher::process_events(): Failed to watch directory {}, it is not watched anymore", directoryWatch->directory)
+			std::scoped_lock<std::mutex> lock(_mutex);
+			// The directory can be watched again by watch() if it is recreated
+			_isOverflowed = true;
+			_watchByDirectory.erase(directoryWatch->directory);
+			CloseHandle(directoryWatch->handle);
+			_directoryWatches.erase(static_cast<intptr_t>(key));
+		}
+	}
+}
+#elif defined(__linux__)
+void FileWatcher::process_events()
+{
+	pollfd descriptors[2] = { { _inotify, POLLIN, 0 }, { _wakeUpEvent, POLLIN, 0 } };
+	alignas(inotify_event) char buffer[64 * 1024];
+
+	while (_isRunning.load())
+	{
+		if (poll(descriptors, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			LOG_ERROR("FileWatcher::process_events(): Failed to wait for events")
+			break;
+		}
+
+		ssize_t size;
+		while ((size = read(_inotify, buffer, sizeof(buffer))) > 0)
+		{
+			std::scoped_lock<std::mutex> lock(_mutex);
+			for (char* eventData = buffer; eventData < buffer + size;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(eventData);
+				eventData += sizeof(inotify_event) + event->len;
+
+				if (event->mask & IN_Q_OVERFLOW)
+				{
+					_isOverflowed = true;
+					continue;
+				}
+
+				// A renamed directory is still watched with its old path, so the watch is removed like the watch
+				// of a removed directory. The directory can be watched again by watch() if it is recreated
+				if (event->mask & IN_MOVE_SELF)
+				{
+					inotify_rm_watch(_inotify, event->wd);
+					continue;
+				}
+				if (event->mask & IN_IGNORED)
+				{
+					LOG_WARNING("FileWatcher::process_events(): Directory {} is not watched anymore", _directoryByWatch[event->wd])
+					_isOverflowed = true;
+					_directoryByWatch.erase(event->wd);
+					for (auto watchIt = _watchByDirectory.begin(); watchIt != _watchByDirectory.end();)
+					{
+						if (watchIt->second == event->wd)
+							watchIt = _watchByDirectory.erase(watchIt);
+						else
+							++watchIt;
+					}
+					continue;
+				}
+
+				// Events without a name are reported for the watched directory itself
+				auto it = _directoryByWatch.find(event->wd);
+				if (event->len && it != _directoryByWatch.end())
+					add_changed_file(it->second, event->name);
+			}
+		}
+	}
+}
+#else
+void FileWatcher::process_events()
+{
+
+}
+#endif
+
+void FileWatcher::add_changed_file(const std::string& directory, const std::filesystem::path& fileName)
+{
+	_changedFiles.insert(normalize_path(std::filesystem::path(directory) / fileName));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ad_astris::io
+{
+	// Watches directories in a background thread and keeps a set of changed files, so caches check only files
+	// that were changed instead of comparing timestamps of every file. Directories are watched without
+	// subdirectories. Uses inotify on Linux and ReadDirectoryChangesW on Windows. On other platforms
+	// is_supported() returns false and callers must check timestamps
+	class FileWatcher
+	{
+		public:
+			FileWatcher();
+			~FileWatcher();
+
+			FileWatcher(const FileWatcher&) = delete;
+			FileWatcher& operator=(const FileWatcher&) = delete;
+
+			bool is_supported() const { return _isSupported; }
+
+			// Changes that happen after the call are recorded. Watching a directory twice does nothing.
+			// Returns false if the directory can't be watched
+			bool watch(const std::filesystem::path& directory);
+			bool is_watched(const std::filesystem::path& directory);
+
+			// Appends files that were created, modified, removed or renamed since the previous call. Paths are
+			// normalized with normalize_path(). Returns false if the OS dropped events, in which case any watched
+			// file could have changed
+			bool consume_changed_files(std::vector<std::string>& outPaths);
+
+			static std::string normalize_path(const std::filesystem::path& path);
+
+		private:
+			bool _isSupported{ false };
+			std::atomic_bool _isRunning{ false };
+			std::thread _thread;
+
+			std::mutex _mutex;
+			std::unordered_map<std::string, intptr_t> _watchByDirectory;
+			std::unordered_set<std::string> _changedFiles;
+			bool _isOverflowed{ false };
+
+#ifdef _WIN32
+			struct DirectoryWatch;
+			void* _completionPort{ nullptr };
+			std::unordered_map<intptr_t, std::unique_ptr<DirectoryWatch>> _directoryWatches;
+			bool request_changes(DirectoryWatch* directoryWatch);
+#elif defined(__linux__)
+			int _inotify{ -1 };
+			int _wakeUpEvent{ -1 };
+			std::unordered_map<intptr_t, std::string> _directoryByWatch;
+#endif
+
+			void process_events();
+			void add_changed_file(const std::string& directory, const std::filesystem::path& fileName);
+	};
+}
@@ -0,0 +1,212 @@
+#include "mapped_file.h"
+#include "profiler/logger.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ad_astris;
+using namespace io;
+
+namespace
+{
+#ifndef _WIN32
+	// madvise() requires page aligned addresses
+	uint64_t get_page_size()
+	{
+		static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+		return pageSize;
+	}
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: _data(other._data), _size(other._size), _owner(std::move(other._owner)), _isMemory(other._isMemory)
+{
+	other._data = nullptr;
+	other._size = 0;
+	other._isMemory = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+		_data = other._data;
+		_size = other._size;
+		_owner = std::move(other._owner);
+		_isMemory = other._isMemory;
+		other._data = nullptr;
+		other._size = 0;
+		other._isMemory = false;
+	}
+	return *this;
+}
+
+MappedFile MappedFile::map(const std::filesystem::path& path, MapAccess access)
+{
+	MappedFile mappedFile;
+
+#ifdef _WIN32
+	// Scan hints are used by the cache manager when it reads pages of the mapping
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+	if (has_flag(access, MapAccess::SEQUENTIAL))
+		flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+	else if (has_flag(access, MapAccess::RANDOM))
+		flags |= FILE_FLAG_RANDOM_ACCESS;
+
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERROR("MappedFile::map(): Failed to open file {}", path.string())
+		return mappedFile;
+	}
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart)
+	{
+		LOG_ERROR("MappedFile::map(): File {} is empty", path.string())
+		CloseHandle(file);
+		return mappedFile;
+	}
+
+	// The view keeps the file and the mapping object alive, so handles are closed right after mapping
+	HANDLE fileMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!fileMapping)
+	{
+		LOG_ERROR("MappedFile::map(): Failed to create file mapping for {}", path.string())
+		return mappedFile;
+	}
+
+	void* data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(fileMapping);
+	if (!data)
+	{
+		LOG_ERROR("MappedFile::map(): Failed to map file {}", path.string())
+		return mappedFile;
+	}
+	mappedFile._size = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+	{
+		LOG_ERROR("MappedFile::map(): Failed to open file {}", path.string())
+		return mappedFile;
+	}
+
+	struct stat fileStat{};
+	if (fstat(file, &fileStat) || !fileStat.st_size)
+	{
+		LOG_ERROR("MappedFile::map(): File {} is empty", path.string())
+		close(file);
+		return mappedFile;
+	}
+
+	// The mapping keeps a reference to the file, so the descriptor is closed right after mapping
+	void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		LOG_ERROR("MappedFile::map(): Failed to map file {}", path.string())
+		return mappedFile;
+	}
+	mappedFile._size = static_cast<uint64_t>(fileStat.st_size);
+#endif
+
+	mappedFile._data = static_cast<const uint8_t*>(data);
+	if (access != MapAccess::DEFAULT)
+		mappedFile.advise(access);
+	return mappedFile;
+}
+
+MappedFile MappedFile::create_view(std::shared_ptr<const MappedFile> mappedFile, uint64_t offset, uint64_t size)
+{
+	MappedFile view;
+	if (!mappedFile || !mappedFile->is_valid() || offset > mappedFile->size() || size > mappedFile->size() - offset || !size)
+		return view;
+
+	view._data = mappedFile->data() + offset;
+	view._size = size;
+	view._owner = std::move(mappedFile);
+	return view;
+}
+
+MappedFile MappedFile::create_from_memory(std::unique_ptr<uint8_t[]> data, uint64_t size)
+{
+	MappedFile view;
+	if (!data || !size)
+		return view;
+
+	view._data = data.get();
+	view._size = size;
+	view._owner = std::shared_ptr<uint8_t[]>(std::move(data));
+	view._isMemory = true;
+	return view;
+}
+
+void MappedFile::advise(MapAccess access, uint64_t offset, uint64_t size) const
+{
+	if (!_data || _isMemory || offset >= _size)
+		return;
+	if (!size || size > _size - offset)
+		size = _size - offset;
+
+#ifdef _WIN32
+	// Access patterns can be set only when the file is opened, Windows has no madvise() equivalent for views
+	if (has_flag(access, MapAccess::WILL_NEED))
+	{
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(_data + offset);
+		range.NumberOfBytes = static_cast<SIZE_T>(size);
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	// Views of pak archives don't have to start at a page boundary
+	uintptr_t rangeStart = reinterpret_cast<uintptr_t>(_data + offset);
+	uintptr_t alignedRangeStart = rangeStart - rangeStart % get_page_size();
+	void* address = reinterpret_cast<void*>(alignedRangeStart);
+	size += rangeStart - alignedRangeStart;
+
+	if (has_flag(access, MapAccess::SEQUENTIAL))
+		madvise(address, size, MADV_SEQUENTIAL);
+	else if (has_flag(access, MapAccess::RANDOM))
+		madvise(address, size, MADV_RANDOM);
+
+	if (has_flag(access, MapAccess::WILL_NEED))
+		madvise(address, size, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::unmap()
+{
+	if (!_data)
+		return;
+
+	if (_owner)
+	{
+		_owner.reset();
+	}
+	else
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(_data);
+#else
+		munmap(const_cast<uint8_t*>(_data), _size);
+#endif
+	}
+	_data = nullptr;
+	_size = 0;
+	_isMemory = false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/flags_operations.h"
+#include <filesystem>
+#include <memory>
+#include <stdint.h>
+
+namespace ad_astris::io
+{
+	// Hints are passed to the OS, they don't change the content of the mapping
+	enum class MapAccess : uint32_t
+	{
+		DEFAULT = 0,
+		SEQUENTIAL = 1 << 0,		// Aggressive read-ahead, pages can be dropped soon after they have been read
+		RANDOM = 1 << 1,			// Read-ahead is disabled, useful when only headers or a few blocks are read
+		WILL_NEED = 1 << 2,			// The range is read in the background before it is accessed
+	};
+}
+
+ENABLE_BIT_MASK(ad_astris::io::MapAccess)
+
+namespace ad_astris::io
+{
+	// Read-only view of a whole file. Pages are loaded on first access, so reading a header of a large file
+	// doesn't read the rest of it. The view is unmapped when it is destroyed, the file can be modified or
+	// removed after mapping but changes of its size are undefined behaviour for the view.
+	// Files from pak archives are views of the archive mapping or decompressed copies that are owned by the view
+	class MappedFile
+	{
+		public:
+			MappedFile() = default;
+			~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+			MappedFile(MappedFile&& other) noexcept;
+			MappedFile& operator=(MappedFile&& other) noexcept;
+
+			// Returns an invalid view if the file doesn't exist, is empty or can't be mapped
+			static MappedFile map(const std::filesystem::path& path, MapAccess access = MapAccess::DEFAULT);
+			// The view keeps the mapping alive, so it can outlive other views of the same mapping
+			static MappedFile create_view(std::shared_ptr<const MappedFile> mappedFile, uint64_t offset, uint64_t size);
+			static MappedFile create_from_memory(std::unique_ptr<uint8_t[]> data, uint64_t size);
+
+			// Changes hints for a part of the view, for example, WILL_NEED before reading a blob after the header.
+			// If size is 0, hints are applied to the range from offset to the end of the view
+			void advise(MapAccess access, uint64_t offset = 0, uint64_t size = 0) const;
+			void unmap();
+
+			const uint8_t* data() const { return _data; }
+			uint64_t size() const { return _size; }
+			bool is_valid() const { return _data != nullptr; }
+
+		private:
+			const uint8_t* _data{ nullptr };
+			uint64_t _size{ 0 };
+			// Mapping or memory that contains the data. If it is set, the data is not unmapped by the view
+			std::shared_ptr<const void> _owner{ nullptr };
+			bool _isMemory{ false };
+	};
+}
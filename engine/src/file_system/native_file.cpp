@@ -0,0 +1,229 @@
+#include "native_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using namespace ad_astris;
+using namespace io;
+
+namespace
+{
+#ifdef _WIN32
+	// ReadFile() and WriteFile() transfer at most 4 GB at once
+	constexpr uint64_t MAX_TRANSFER_SIZE = 1ull << 30;
+
+	int64_t transfer_at(HANDLE handle, uint8_t* data, uint64_t size, uint64_t offset, bool isRead)
+	{
+		uint64_t transferredSize = 0;
+		while (transferredSize < size)
+		{
+			uint64_t currentOffset = offset + transferredSize;
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(currentOffset);
+			overlapped.OffsetHigh = static_cast<DWORD>(currentOffset >> 32);
+			DWORD chunkSize = static_cast<DWORD>(std::min(size - transferredSize, MAX_TRANSFER_SIZE));
+			DWORD chunkTransferredSize = 0;
+			BOOL isSucceeded = isRead
+				? ReadFile(handle, data + transferredSize, chunkSize, &chunkTransferredSize, &overlapped)
+				: WriteFile(handle, data + transferredSize, chunkSize, &chunkTransferredSize, &overlapped);
+			if (!isSucceeded)
+			{
+				if (isRead && GetLastError() == ERROR_HANDLE_EOF)
+					break;
+				return -1;
+			}
+			if (!chunkTransferredSize)
+				break;
+			transferredSize += chunkTransferredSize;
+		}
+		return static_cast<int64_t>(transferredSize);
+	}
+#endif
+}
+
+bool NativeFile::open(const std::filesystem::path& path, NativeFileAccess access, NativeFileHandle& outHandle)
+{
+#ifdef _WIN32
+	DWORD desiredAccess = 0;
+	if (has_flag(access, NativeFileAccess::READ))
+		desiredAccess |= GENERIC_READ;
+	if (has_flag(access, NativeFileAccess::WRITE))
+		desiredAccess |= GENERIC_WRITE;
+
+	DWORD creationDisposition = OPEN_EXISTING;
+	if (has_flag(access, NativeFileAccess::CREATE))
+		creationDisposition = has_flag(access, NativeFileAccess::TRUNCATE) ? CREATE_ALWAYS : OPEN_ALWAYS;
+	else if (has_flag(access, NativeFileAccess::TRUNCATE))
+		creationDisposition = TRUNCATE_EXISTING;
+
+	// Files may be read, written or renamed by other handles at the same time, like on other platforms
+	DWORD shareMode = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+	HANDLE handle = CreateFileW(path.c_str(), desiredAccess, shareMode, nullptr, creationDisposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+	outHandle = handle;
+	return true;
+#else
+	int flags = O_CLOEXEC;
+	bool isRead = has_flag(access, NativeFileAccess::READ);
+	bool isWrite = has_flag(access, NativeFileAccess::WRITE);
+	flags |= isRead && isWrite ? O_RDWR : isWrite ? O_WRONLY : O_RDONLY;
+	if (has_flag(access, NativeFileAccess::CREATE))
+		flags |= O_CREAT;
+	if (has_flag(access, NativeFileAccess::TRUNCATE))
+		flags |= O_TRUNC;
+
+	int handle = ::open(path.c_str(), flags, 0644);
+	if (handle < 0)
+		return false;
+	outHandle = handle;
+	return true;
+#endif
+}
+
+void NativeFile::close(NativeFileHandle handle)
+{
+#ifdef _WIN32
+	CloseHandle(handle);
+#else
+	::close(handle);
+#endif
+}
+
+bool NativeFile::flush(NativeFileHandle handle)
+{
+#ifdef _WIN32
+	return FlushFileBuffers(handle);
+#else
+	return fsync(handle) == 0;
+#endif
+}
+
+uint64_t NativeFile::get_size(NativeFileHandle handle)
+{
+#ifdef _WIN32
+	LARGE_INTEGER size{};
+	GetFileSizeEx(handle, &size);
+	return static_cast<uint64_t>(size.QuadPart);
+#else
+	struct stat fileStat{};
+	fstat(handle, &fileStat);
+	return static_cast<uint64_t>(fileStat.st_size);
+#endif
+}
+
+int64_t NativeFile::read_at(NativeFileHandle handle, void* data, uint64_t size, uint64_t offset)
+{
+#ifdef _WIN32
+	return transfer_at(handle, static_cast<uint8_t*>(data), size, offset, true);
+#else
+	uint64_t readSize = 0;
+	while (readSize < size)
+	{
+		ssize_t chunkSize = pread(handle, static_cast<uint8_t*>(data) + readSize, size - readSize, offset + readSize);
+		if (chunkSize < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (!chunkSize)
+			break;
+		readSize += chunkSize;
+	}
+	return static_cast<int64_t>(readSize);
+#endif
+}
+
+int64_t NativeFile::write_at(NativeFileHandle handle, const void* data, uint64_t size, uint64_t offset)
+{
+#ifdef _WIN32
+	return transfer_at(handle, static_cast<uint8_t*>(const_cast<void*>(data)), size, offset, false);
+#else
+	uint64_t writtenSize = 0;
+	while (writtenSize < size)
+	{
+		ssize_t chunkSize = pwrite(handle, static_cast<const uint8_t*>(data) + writtenSize, size - writtenSize, offset + writtenSize);
+		if (chunkSize < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		writtenSize += chunkSize;
+	}
+	return static_cast<int64_t>(writtenSize);
+#endif
+}
+
+int64_t NativeFile::write_vectored_at(NativeFileHandle handle, const WriteBuffer* buffers, uint32_t bufferCount, uint64_t offset)
+{
+	uint64_t writtenSize = 0;
+#ifdef _WIN32
+	for (uint32_t i = 0; i != bufferCount; ++i)
+	{
+		int64_t bufferWrittenSize = write_at(handle, buffers[i].data, buffers[i].size, offset + writtenSize);
+		if (bufferWrittenSize < 0)
+			return -1;
+		writtenSize += bufferWrittenSize;
+	}
+#else
+	std::vector<iovec> ioVectors;
+	ioVectors.reserve(std::min<uint32_t>(bufferCount, IOV_MAX));
+	uint32_t nextBuffer = 0;
+	while (nextBuffer != bufferCount)
+	{
+		ioVectors.clear();
+		for (; nextBuffer != bufferCount && ioVectors.size() != IOV_MAX; ++nextBuffer)
+		{
+			if (buffers[nextBuffer].size)
+				ioVectors.push_back({ const_cast<void*>(buffers[nextBuffer].data), buffers[nextBuffer].size });
+		}
+		if (ioVectors.empty())
+			break;
+
+		ssize_t batchWrittenSize = 0;
+		do
+		{
+			batchWrittenSize = pwritev(handle, ioVectors.data(), ioVectors.size(), offset + writtenSize);
+		}
+		while (batchWrittenSize < 0 && errno == EINTR);
+		if (batchWrittenSize < 0)
+			return -1;
+
+		// The rest of a partial write is written buffer by buffer
+		uint64_t remainingSize = batchWrittenSize;
+		for (auto& ioVector : ioVectors)
+		{
+			uint64_t bufferWrittenSize = std::min<uint64_t>(remainingSize, ioVector.iov_len);
+			remainingSize -= bufferWrittenSize;
+			if (bufferWrittenSize != ioVector.iov_len)
+			{
+				int64_t restSize = write_at(
+					handle,
+					static_cast<uint8_t*>(ioVector.iov_base) + bufferWrittenSize,
+					ioVector.iov_len - bufferWrittenSize,
+					offset + writtenSize + bufferWrittenSize);
+				if (restSize < 0)
+					return -1;
+			}
+			writtenSize += ioVector.iov_len;
+		}
+	}
+#endif
+	return static_cast<int64_t>(writtenSize);
+}
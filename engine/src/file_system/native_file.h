@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/flags_operations.h"
+#include <filesystem>
+#include <stdint.h>
+
+namespace ad_astris::io
+{
+#ifdef _WIN32
+	using NativeFileHandle = void*;
+#else
+	using NativeFileHandle = int;
+#endif
+
+	enum class NativeFileAccess : uint32_t
+	{
+		READ = 1 << 0,
+		WRITE = 1 << 1,
+		CREATE = 1 << 2,			// The file is created if it doesn't exist
+		TRUNCATE = 1 << 3,
+	};
+
+	// One part of a vectored write
+	struct WriteBuffer
+	{
+		const void* data{ nullptr };
+		uint64_t size{ 0 };
+	};
+}
+
+ENABLE_BIT_MASK(ad_astris::io::NativeFileAccess)
+
+namespace ad_astris::io
+{
+	// Thin wrapper over OS file handles. Reads and writes are positional, so one handle can be used by several
+	// threads at the same time. Transfers are repeated until all bytes are transferred or the end of the file is
+	// reached, functions return the number of transferred bytes or -1 on error
+	class NativeFile
+	{
+		public:
+			static bool open(const std::filesystem::path& path, NativeFileAccess access, NativeFileHandle& outHandle);
+			static void close(NativeFileHandle handle);
+			// Waits until written data reaches the storage device
+			static bool flush(NativeFileHandle handle);
+			static uint64_t get_size(NativeFileHandle handle);
+
+			static int64_t read_at(NativeFileHandle handle, void* data, uint64_t size, uint64_t offset);
+			static int64_t write_at(NativeFileHandle handle, const void* data, uint64_t size, uint64_t offset);
+			// Uses one system call for up to IOV_MAX buffers on POSIX. Windows has no gather writes for buffered
+			// handles, so buffers are written one by one
+			static int64_t write_vectored_at(NativeFileHandle handle, const WriteBuffer* buffers, uint32_t bufferCount, uint64_t offset);
+	};
+}
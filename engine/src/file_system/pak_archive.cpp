@@ -0,0 +1,236 @@
+#include "pak_archive.h"
+#include "native_file.h"
+#include "core/compile_time_hash.h"
+#include "profiler/logger.h"
+
+#include <lz4/lz4.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace ad_astris;
+using namespace io;
+
+std::unique_ptr<PakArchive> PakArchive::open(const std::filesystem::path& path)
+{
+	// Only the table of contents is accessed when the archive is mounted, file data is read on demand
+	auto mappedFile = std::make_shared<MappedFile>(MappedFile::map(path, MapAccess::RANDOM));
+	if (!mappedFile->is_valid())
+		return nullptr;
+
+	const uint8_t* data = mappedFile->data();
+	uint64_t size = mappedFile->size();
+	const PakHeader* header = reinterpret_cast<const PakHeader*>(data);
+	if (size < sizeof(PakHeader) || header->magic != PAK_MAGIC || header->version != PAK_VERSION)
+	{
+		LOG_ERROR("PakArchive::open(): File {} is not a pak archive or has unsupported version", path.string())
+		return nullptr;
+	}
+
+	uint64_t tocSize = header->entryCount * sizeof(PakEntry);
+	if (header->tocOffset > size || tocSize > size - header->tocOffset
+		|| header->pathsOffset > size || header->pathsSize > size - header->pathsOffset)
+	{
+		LOG_ERROR("PakArchive::open(): Table of contents of {} is out of bounds", path.string())
+		return nullptr;
+	}
+
+	const PakEntry* entries = reinterpret_cast<const PakEntry*>(data + header->tocOffset);
+	for (uint32_t i = 0; i != header->entryCount; ++i)
+	{
+		const PakEntry& entry = entries[i];
+		if (entry.offset > size || entry.size > size - entry.offset
+			|| entry.pathOffset > header->pathsSize || entry.pathSize > header->pathsSize - entry.pathOffset)
+		{
+			LOG_ERROR("PakArchive::open(): Entry {} of {} is out of bounds", i, path.string())
+			return nullptr;
+		}
+		// find_entry() is a binary search by path hash
+		if (i && entries[i - 1].pathHash > entry.pathHash)
+		{
+			LOG_ERROR("PakArchive::open(): Table of contents of {} is not sorted by path hash", path.string())
+			return nullptr;
+		}
+	}
+
+	std::unique_ptr<PakArchive> archive(new PakArchive());
+	archive->_path = path;
+	archive->_header = header;
+	archive->_entries = entries;
+	archive->_paths = reinterpret_cast<const char*>(data + header->pathsOffset);
+	archive->_mappedFile = std::move(mappedFile);
+	return archive;
+}
+
+uint64_t PakArchive::hash_path(std::string_view path)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (char c : path)
+		hash = fnv_iterate(hash, uint8_t(c));
+	return hash;
+}
+
+std::string PakArchive::normalize_path(const std::filesystem::path& path)
+{
+	return path.lexically_normal().generic_string();
+}
+
+const PakEntry* PakArchive::find_entry(std::string_view path) const
+{
+	uint64_t hash = hash_path(path);
+	const PakEntry* entriesEnd = _entries + _header->entryCount;
+	const PakEntry* entry = std::lower_bound(_entries, entriesEnd, hash, [](const PakEntry& entry, uint64_t hash)
+	{
+		return entry.pathHash < hash;
+	});
+
+	for (; entry != entriesEnd && entry->pathHash == hash; ++entry)
+	{
+		if (get_entry_path(*entry) == path)
+			return entry;
+	}
+	return nullptr;
+}
+
+MappedFile PakArchive::map_entry(const PakEntry& entry, MapAccess access) const
+{
+	if (entry.compression == PakCompression::NONE)
+	{
+		MappedFile mappedFile = MappedFile::create_view(_mappedFile, entry.offset, entry.size);
+		if (access != MapAccess::DEFAULT)
+			mappedFile.advise(access);
+		return mappedFile;
+	}
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[entry.uncompressedSize]);
+	int decompressedSize = LZ4_decompress_safe(
+		reinterpret_cast<const char*>(_mappedFile->data() + entry.offset),
+		reinterpret_cast<char*>(data.get()),
+		entry.size,
+		entry.uncompressedSize);
+	if (decompressedSize < 0 || static_cast<uint64_t>(decompressedSize) != entry.uncompressedSize)
+	{
+		LOG_ERROR("PakArchive::map_entry(): Failed to decompress {} from {}", get_entry_path(entry), _path.string())
+		return MappedFile();
+	}
+	return MappedFile::create_from_memory(std::move(data), entry.uncompressedSize);
+}
+
+std::string_view PakArchive::get_entry_path(const PakEntry& entry) const
+{
+	return std::string_view(_paths + entry.pathOffset, entry.pathSize);
+}
+
+void PakWriter::add_file(const std::filesystem::path& sourcePath, const std::filesystem::path& pakPath)
+{
+	_files.push_back({ sourcePath, PakArchive::normalize_path(pakPath) });
+}
+
+void PakWriter::add_directory(const std::filesystem::path& directory)
+{
+	for (auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (entry.is_regular_file())
+			add_file(entry.path(), entry.path().lexically_relative(directory));
+	}
+}
+
+bool PakWriter::write(const std::filesystem::path& outputPath, PakCompression compression)
+{
+	// Files are written in path order, so files of one folder are close to each other
+	std::sort(_files.begin(), _files.end(), [](const SourceFile& first, const SourceFile& second)
+	{
+		return first.pakPath < second.pakPath;
+	});
+	auto duplicate = std::adjacent_find(_files.begin(), _files.end(), [](const SourceFile& first, const SourceFile& second)
+	{
+		return first.pakPath == second.pakPath;
+	});
+	if (duplicate != _files.end())
+	{
+		LOG_ERROR("PakWriter::write(): File {} is added twice", duplicate->pakPath)
+		return false;
+	}
+
+	NativeFileHandle file;
+	if (!NativeFile::open(outputPath, NativeFileAccess::WRITE | NativeFileAccess::CREATE | NativeFileAccess::TRUNCATE, file))
+	{
+		LOG_ERROR("PakWriter::write(): Failed to open file {}", outputPath.string())
+		return false;
+	}
+
+	PakHeader header;
+	header.entryCount = _files.size();
+	std::vector<PakEntry> entries(_files.size());
+	std::string paths;
+	std::vector<uint8_t> compressedData;
+	uint64_t offset = PAK_DATA_ALIGNMENT;
+	bool isWritten = true;
+
+	for (size_t i = 0; i != _files.size() && isWritten; ++i)
+	{
+		PakEntry& entry = entries[i];
+		entry.pathHash = PakArchive::hash_path(_files[i].pakPath);
+		entry.pathOffset = paths.size();
+		entry.pathSize = _files[i].pakPath.size();
+		entry.offset = offset;
+		paths += _files[i].pakPath;
+
+		std::error_code errorCode;
+		if (!std::filesystem::file_size(_files[i].sourcePath, errorCode) && !errorCode)
+			continue;
+
+		MappedFile sourceFile = MappedFile::map(_files[i].sourcePath, MapAccess::SEQUENTIAL);
+		if (!sourceFile.is_valid())
+		{
+			isWritten = false;
+			break;
+		}
+
+		const uint8_t* data = sourceFile.data();
+		entry.size = entry.uncompressedSize = sourceFile.size();
+		if (compression == PakCompression::LZ4 && sourceFile.size() <= LZ4_MAX_INPUT_SIZE)
+		{
+			compressedData.resize(LZ4_compressBound(sourceFile.size()));
+			int compressedSize = LZ4_compress_default(
+				reinterpret_cast<const char*>(sourceFile.data()),
+				reinterpret_cast<char*>(compressedData.data()),
+				sourceFile.size(),
+				compressedData.size());
+			if (compressedSize > 0 && static_cast<uint64_t>(compressedSize) < sourceFile.size())
+			{
+				data = compressedData.data();
+				entry.size = compressedSize;
+				entry.compression = PakCompression::LZ4;
+			}
+		}
+
+		isWritten = NativeFile::write_at(file, data, entry.size, entry.offset) == static_cast<int64_t>(entry.size);
+		offset += (entry.size + PAK_DATA_ALIGNMENT - 1) / PAK_DATA_ALIGNMENT * PAK_DATA_ALIGNMENT;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const PakEntry& first, const PakEntry& second)
+	{
+		return first.pathHash < second.pathHash;
+	});
+
+	header.tocOffset = offset;
+	header.pathsOffset = offset + entries.size() * sizeof(PakEntry);
+	header.pathsSize = paths.size();
+	WriteBuffer buffers[] = {
+		{ entries.data(), entries.size() * sizeof(PakEntry) },
+		{ paths.data(), paths.size() } };
+	isWritten = isWritten
+		&& NativeFile::write_vectored_at(file, buffers, 2, header.tocOffset) == static_cast<int64_t>(buffers[0].size + buffers[1].size)
+		&& NativeFile::write_at(file, &header, sizeof(PakHeader), 0) == static_cast<int64_t>(sizeof(PakHeader));
+	NativeFile::close(file);
+
+	if (!isWritten)
+	{
+		LOG_ERROR("PakWriter::write(): Failed to write file {}", outputPath.string())
+		std::error_code errorCode;
+		std::filesystem::remove(outputPath, errorCode);
+		return false;
+	}
+	return true;
+}
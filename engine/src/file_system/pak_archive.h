@@ -0,0 +1,104 @@
+#pragma once
+
+#include "mapped_file.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+namespace ad_astris::io
+{
+	constexpr uint32_t PAK_MAGIC = 0x4B504141;			// "AAPK"
+	constexpr uint32_t PAK_VERSION = 1;
+	// File data starts at page boundaries, so packed files are mapped like loose files
+	constexpr uint32_t PAK_DATA_ALIGNMENT = 4096;
+	constexpr const char* PAK_FILE_EXTENSION = ".aapak";
+
+	enum class PakCompression : uint32_t
+	{
+		NONE = 0,
+		LZ4 = 1
+	};
+
+	// Layout: header, aligned file data, table of contents sorted by path hash, paths of files
+	struct PakHeader
+	{
+		uint32_t magic{ PAK_MAGIC };
+		uint32_t version{ PAK_VERSION };
+		uint32_t alignment{ PAK_DATA_ALIGNMENT };
+		uint32_t entryCount{ 0 };
+		uint64_t tocOffset{ 0 };
+		uint64_t pathsOffset{ 0 };
+		uint64_t pathsSize{ 0 };
+	};
+
+	struct PakEntry
+	{
+		uint64_t pathHash{ 0 };
+		uint64_t offset{ 0 };
+		uint64_t size{ 0 };						// Size of the data in the archive
+		uint64_t uncompressedSize{ 0 };
+		uint32_t pathOffset{ 0 };				// Offset in the path block, paths are used to resolve hash collisions
+		uint32_t pathSize{ 0 };
+		PakCompression compression{ PakCompression::NONE };
+		uint32_t reserved{ 0 };
+	};
+
+	static_assert(sizeof(PakHeader) == 40);
+	static_assert(sizeof(PakEntry) == 48);
+
+	// Read-only archive. The whole archive is mapped once and the table of contents is used directly from the
+	// mapping, so mounting doesn't read or parse file data. Paths are relative to the packed directory and use
+	// forward slashes
+	class PakArchive
+	{
+		public:
+			// Returns nullptr if the file is not a valid archive
+			static std::unique_ptr<PakArchive> open(const std::filesystem::path& path);
+
+			static uint64_t hash_path(std::string_view path);
+			// Converts a relative path to the form that is used in archives
+			static std::string normalize_path(const std::filesystem::path& path);
+
+			const PakEntry* find_entry(std::string_view path) const;
+			// Uncompressed files are views of the archive mapping, compressed files are decompressed into memory
+			MappedFile map_entry(const PakEntry& entry, MapAccess access = MapAccess::DEFAULT) const;
+
+			std::string_view get_entry_path(const PakEntry& entry) const;
+			const PakEntry* get_entries() const { return _entries; }
+			uint32_t get_entry_count() const { return _header->entryCount; }
+			const std::filesystem::path& get_path() const { return _path; }
+
+		private:
+			std::filesystem::path _path;
+			std::shared_ptr<const MappedFile> _mappedFile;
+			const PakHeader* _header{ nullptr };
+			const PakEntry* _entries{ nullptr };
+			const char* _paths{ nullptr };
+	};
+
+	// Used by the packer. Files are read when write() is called, so they must not be changed before that
+	class PakWriter
+	{
+		public:
+			void add_file(const std::filesystem::path& sourcePath, const std::filesystem::path& pakPath);
+			// Adds all regular files of the directory with paths relative to it
+			void add_directory(const std::filesystem::path& directory);
+
+			// Compressed data is stored only for files that become smaller
+			bool write(const std::filesystem::path& outputPath, PakCompression compression = PakCompression::NONE);
+
+			uint32_t get_file_count() const { return _files.size(); }
+
+		private:
+			struct SourceFile
+			{
+				std::filesystem::path sourcePath;
+				std::string pakPath;
+			};
+
+			std::vector<SourceFile> _files;
+	};
+}
@@ -142,29 +142,22 @@ io::URI io::Utils::find_file_with_specific_extension(const URI& folderPath, cons
 
 void io::Utils::read_file(FileSystem* fileSystem, const URI& path, std::vector<uint8_t>& dataStorage)
 {
-	size_t size = 0;
-	uint8_t* tempData = static_cast<uint8_t*>(fileSystem->map_to_read(path, size));
-	dataStorage.resize(size);
-	memcpy(dataStorage.data(), tempData, size);
-	fileSystem->unmap_after_reading(tempData);
+	MappedFile mappedFile = fileSystem->map_file(path, MapAccess::SEQUENTIAL);
+	dataStorage.assign(mappedFile.data(), mappedFile.data() + mappedFile.size());
 }
 
 void io::Utils::read_file(FileSystem* fileSystem, const URI& path, uint8_t** dataStorage)
 {
-	size_t size = 0;
-	uint8_t* tempData = static_cast<uint8_t*>(fileSystem->map_to_read(path, size));
-	*dataStorage = new uint8_t[size];
-	memcpy(*dataStorage, tempData, size);
-	fileSystem->unmap_after_reading(tempData);
+	MappedFile mappedFile = fileSystem->map_file(path, MapAccess::SEQUENTIAL);
+	*dataStorage = new uint8_t[mappedFile.size()];
+	if (mappedFile.is_valid())
+		memcpy(*dataStorage, mappedFile.data(), mappedFile.size());
 }
 
 void io::Utils::read_file(FileSystem* fileSystem, const URI& path, std::string& outputData)
 {
-	size_t size = 0;
-	uint8_t* tempData = static_cast<uint8_t*>(fileSystem->map_to_read(path, size));
-	outputData.resize(size);
-	memcpy(outputData.data(), tempData, size);
-	fileSystem->unmap_after_reading(tempData);
+	MappedFile mappedFile = fileSystem->map_file(path, MapAccess::SEQUENTIAL);
+	outputData.assign(reinterpret_cast<const char*>(mappedFile.data()), mappedFile.size());
 }
 
 void io::Utils::write_file(FileSystem* fileSystem, const URI& path, const uint8_t* data, size_t dataSize, const std::string& writeMode)
@@ -198,7 +191,7 @@ void io::Utils::serialize_file(
 	write_file(fileSystem, path, outputData.data(), outputData.size());
 }
 
-void io::Utils::deserialize_file(
+bool io::Utils::deserialize_file(
 	FileSystem* fileSystem,
 	const URI& path,
 	std::vector<uint8_t>& outputBinData,
@@ -206,8 +199,8 @@ void io::Utils::deserialize_file(
 {
 	std::vector<uint8_t> inputData;
 	read_file(fileSystem, path, inputData);
-	File file;
-	file.deserialize(inputData, outputBinData, outputMetadata);
+	File file(path);
+	return file.deserialize(inputData, outputBinData, outputMetadata);
 }
 
 uint64_t io::Utils::get_last_write_time(const URI& absolutePath)
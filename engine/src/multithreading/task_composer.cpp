@@ -1,5 +1,6 @@
 ﻿#include "task_composer.h"
 #include "profiler/logger.h"
+#include "profiler/profiler.h"
 #include "core/timer.h"
 #include <cassert>
 #include <exception>
@@ -24,8 +25,16 @@ TaskComposer::TaskComposer(uint32_t maxThreadCount)
 	{
 		_threads.emplace_back([this, threadID]
 		{
+			// TaskComposer is created before the profiler, so the thread is named when the profiler becomes available
+			bool isThreadNamed = false;
 			while (_isAlive.load())
 			{
+				if (!isThreadNamed && profiler::Profiler::get_profiler_instance())
+				{
+					profiler::Profiler::set_thread_name(fmt::format("Worker {}", threadID));
+					isThreadNamed = true;
+				}
+
 				execute_tasks(threadID);
 
 				std::unique_lock<std::mutex> lock(_mutex);
@@ -59,6 +68,8 @@ TaskComposer::~TaskComposer()
 
 void TaskComposer::execute(TaskGroup& taskGroup, const TaskHandler& taskHandler)
 {
+	PROFILER_SCOPE_CATEGORY("TaskComposer::execute", profiler::ScopeCategory::TASKS);
+
 	taskGroup.increase_task_count(1);
 
 	Task task;
@@ -77,6 +88,8 @@ void TaskComposer::dispatch(TaskGroup& taskGroup, uint32_t taskCount, uint32_t g
 	if (taskCount == 0 || groupSize == 0)
 		return;
 
+	PROFILER_SCOPE_CATEGORY("TaskComposer::dispatch", profiler::ScopeCategory::TASKS);
+
 	uint32_t groupCount = calculate_group_count(taskCount, groupSize);
 	taskGroup.increase_task_count(groupCount);
 
@@ -106,12 +119,17 @@ void TaskComposer::wait(TaskGroup& taskGroup)
 {
 	if (is_busy(taskGroup))
 	{
+		PROFILER_SCOPE_CATEGORY("TaskComposer::wait", profiler::ScopeCategory::TASKS);
+
 		_wakeCondition.notify_all();
 		execute_tasks(_taskQueueGroup->get_next_queue_index());
 
+		// Tasks of the group can be added while waiting, for example by IO completions. They are executed
+		// by the waiting thread too, so waiting from tasks doesn't block when all threads wait
 		while (is_busy(taskGroup))
 		{
 			std::this_thread::yield();
+			execute_tasks(_taskQueueGroup->get_next_queue_index());
 		}
 	}
 }
@@ -126,6 +144,8 @@ void TaskComposer::execute_tasks(uint32_t beginningQueueIndex)
 		while (taskQueue.pop_front(task))
 		{
 			task.taskGroup->wait_for_other_groups();
+			// One scope per subgroup, dispatch() can create thousands of small tasks
+			PROFILER_SCOPE_CATEGORY("Task", profiler::ScopeCategory::TASKS);
 			//TaskExecutionInfo* executionInfo = _taskExecutionInfoPool.allocate();
 			executionInfo.taskSubgroupID = task.taskSubgroupID;
 
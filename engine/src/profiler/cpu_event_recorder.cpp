@@ -0,0 +1,174 @@
+#include "cpu_event_recorder.h"
+#include "logger.h"
+
+using namespace ad_astris;
+using namespace profiler;
+
+static std::atomic<uint64_t> g_nextCPUEventRecorderID{ 1 };
+
+CPUEventRecorder::CPUEventRecorder(uint32_t eventCapacityPerThread)
+	: _eventCapacityPerThread(eventCapacityPerThread), _id(g_nextCPUEventRecorderID.fetch_add(1))
+{
+	_frameBeginTicks = CPUClock::get_ticks();
+}
+
+void CPUEventRecorder::begin_scope(Name name, ScopeCategory category, uint32_t color)
+{
+	ThreadEvents& threadEvents = get_thread_events();
+	uint32_t depth = threadEvents.depth++;
+	if (depth >= CPU_SCOPE_MAX_DEPTH)
+		return;
+
+	uint64_t frameIndex = _frameIndex.load(std::memory_order_relaxed);
+	EventBuffer& buffer = threadEvents.buffers[frameIndex % 2];
+	if (buffer.frameIndex.load(std::memory_order_relaxed) != frameIndex)
+	{
+		buffer.eventCount.store(0, std::memory_order_relaxed);
+		buffer.droppedEventCount.store(0, std::memory_order_relaxed);
+		buffer.frameIndex.store(frameIndex, std::memory_order_release);
+	}
+
+	OpenScope& scope = threadEvents.openScopes[depth];
+	uint32_t eventIndex = buffer.eventCount.load(std::memory_order_relaxed);
+	if (eventIndex == _eventCapacityPerThread)
+	{
+		buffer.droppedEventCount.store(buffer.droppedEventCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		scope.event = nullptr;
+		return;
+	}
+
+	// Scopes that were opened during the previous frame are not parents because their events are in another timeline
+	uint32_t parentIndex = INVALID_CPU_EVENT_INDEX;
+	if (depth)
+	{
+		const OpenScope& parentScope = threadEvents.openScopes[depth - 1];
+		if (parentScope.event && parentScope.frameIndex == frameIndex)
+			parentIndex = parentScope.eventIndex;
+	}
+
+	Event& event = buffer.events[eventIndex];
+	event.name = name;
+	event.parentIndex = parentIndex;
+	event.color = color;
+	event.depth = static_cast<uint16_t>(depth);
+	event.category = category;
+	event.endTicks.store(0, std::memory_order_relaxed);
+	event.beginTicks = CPUClock::get_ticks();
+	buffer.eventCount.store(eventIndex + 1, std::memory_order_release);
+
+	scope.event = &event;
+	scope.frameIndex = frameIndex;
+	scope.eventIndex = eventIndex;
+}
+
+void CPUEventRecorder::end_scope()
+{
+	uint64_t endTicks = CPUClock::get_ticks();
+	ThreadEvents& threadEvents = get_thread_events();
+	if (!threadEvents.depth)
+	{
+		LOG_ERROR("CPUEventRecorder::end_scope(): No open scopes in thread {}", threadEvents.info.threadIndex)
+		return;
+	}
+
+	uint32_t depth = --threadEvents.depth;
+	if (depth >= CPU_SCOPE_MAX_DEPTH)
+		return;
+
+	// If the scope has been opened two frames ago, its buffer may be reused by the current frame
+	const OpenScope& scope = threadEvents.openScopes[depth];
+	const EventBuffer& buffer = threadEvents.buffers[scope.frameIndex % 2];
+	if (scope.event && buffer.frameIndex.load(std::memory_order_relaxed) == scope.frameIndex)
+		scope.event->endTicks.store(endTicks, std::memory_order_relaxed);
+}
+
+void CPUEventRecorder::set_thread_name(const std::string& threadName)
+{
+	ThreadEvents& threadEvents = get_thread_events();
+	std::scoped_lock<std::mutex> locker(_threadEventsMutex);
+	threadEvents.info.name = threadName;
+}
+
+void CPUEventRecorder::end_frame(CPUTimeline& outTimeline)
+{
+	uint64_t frameEndTicks = CPUClock::get_ticks();
+	uint64_t frameIndex = _frameIndex.fetch_add(1, std::memory_order_acq_rel);
+	_clockCalibration.calibrate();
+
+	outTimeline.clear();
+	outTimeline.frameID = frameIndex;
+	outTimeline.frameBeginNs = _clockCalibration.to_nanoseconds(_frameBeginTicks);
+	outTimeline.frameEndNs = _clockCalibration.to_nanoseconds(frameEndTicks);
+	_frameBeginTicks = frameEndTicks;
+
+	std::scoped_lock<std::mutex> locker(_threadEventsMutex);
+	for (auto& threadEvents : _threadEvents)
+	{
+		outTimeline.threads.push_back(threadEvents->info);
+
+		const EventBuffer& buffer = threadEvents->buffers[frameIndex % 2];
+		if (buffer.frameIndex.load(std::memory_order_acquire) != frameIndex)
+			continue;
+
+		uint32_t eventCount = buffer.eventCount.load(std::memory_order_acquire);
+		outTimeline.droppedEventCount += buffer.droppedEventCount.load(std::memory_order_relaxed);
+		uint32_t firstEventIndex = outTimeline.events.size();
+		for (uint32_t i = 0; i != eventCount; ++i)
+		{
+			const Event& event = buffer.events[i];
+			uint64_t endTicks = event.endTicks.load(std::memory_order_relaxed);
+
+			CPUTimelineEvent& timelineEvent = outTimeline.events.emplace_back();
+			timelineEvent.name = event.name;
+			timelineEvent.threadIndex = threadEvents->info.threadIndex;
+			timelineEvent.depth = event.depth;
+			timelineEvent.color = event.color;
+			timelineEvent.category = event.category;
+			if (event.parentIndex != INVALID_CPU_EVENT_INDEX)
+				timelineEvent.parentIndex = firstEventIndex + event.parentIndex;
+			timelineEvent.isFinished = endTicks != 0;
+			timelineEvent.beginNs = _clockCalibration.to_nanoseconds(event.beginTicks);
+			timelineEvent.endNs = _clockCalibration.to_nanoseconds(endTicks ? endTicks : frameEndTicks);
+		}
+	}
+}
+
+CPUEventRecorder::ThreadEvents& CPUEventRecorder::get_thread_events()
+{
+	// Module DLLs link engine_core statically, so every module has its own copy of this cache.
+	// Threads are registered inside the recorder, the cache only stores the result of the lookup
+	struct ThreadEventsCache
+	{
+		const CPUEventRecorder* owner{ nullptr };
+		uint64_t ownerID{ 0 };
+		ThreadEvents* threadEvents{ nullptr };
+	};
+	thread_local ThreadEventsCache cache;
+
+	if (cache.owner != this || cache.ownerID != _id)
+	{
+		cache.threadEvents = register_thread();
+		cache.owner = this;
+		cache.ownerID = _id;
+	}
+
+	return *cache.threadEvents;
+}
+
+CPUEventRecorder::ThreadEvents* CPUEventRecorder::register_thread()
+{
+	std::scoped_lock<std::mutex> locker(_threadEventsMutex);
+	auto it = _threadEventsByThreadID.find(std::this_thread::get_id());
+	if (it != _threadEventsByThreadID.end())
+		return it->second;
+
+	ThreadEvents* threadEvents = _threadEvents.emplace_back(new ThreadEvents()).get();
+	for (auto& buffer : threadEvents->buffers)
+		buffer.events.reset(new Event[_eventCapacityPerThread]);
+	threadEvents->info.threadID = std::this_thread::get_id();
+	threadEvents->info.threadIndex = _threadEvents.size() - 1;
+	threadEvents->info.name = "Thread " + std::to_string(threadEvents->info.threadIndex);
+	_threadEventsByThreadID[threadEvents->info.threadID] = threadEvents;
+
+	return threadEvents;
+}
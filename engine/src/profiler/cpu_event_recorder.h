@@ -0,0 +1,90 @@
+#pragma once
+
+#include "cpu_timeline.h"
+#include "core/non_copyable_non_movable.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ad_astris::profiler
+{
+	constexpr uint32_t CPU_EVENT_DEFAULT_CAPACITY = 16 * 1024;
+	constexpr uint32_t CPU_SCOPE_MAX_DEPTH = 64;
+
+	// Each thread that opens scopes gets two event buffers. Frame N is written to buffer N % 2 only by the owning thread,
+	// so begin_scope() and end_scope() don't take locks. end_frame() switches threads to the next buffer and merges
+	// the finished one into CPUTimeline. The buffer is reset lazily by the owning thread when frame N + 2 begins.
+	class CPUEventRecorder : public NonCopyableNonMovable
+	{
+		public:
+			CPUEventRecorder(uint32_t eventCapacityPerThread = CPU_EVENT_DEFAULT_CAPACITY);
+
+			void begin_scope(Name name, ScopeCategory category = ScopeCategory::GENERAL, uint32_t color = SCOPE_COLOR_DEFAULT);
+			void end_scope();
+
+			void set_thread_name(const std::string& threadName);
+
+			// Must be called from one thread, usually from the main thread at the end of the frame
+			void end_frame(CPUTimeline& outTimeline);
+
+			uint64_t get_frame_index() const
+			{
+				return _frameIndex.load(std::memory_order_relaxed);
+			}
+
+			uint64_t get_current_time_ns() const
+			{
+				return _clockCalibration.to_nanoseconds(CPUClock::get_ticks());
+			}
+
+		private:
+			// 32 bytes, so two events share a cache line
+			struct Event
+			{
+				Name name;
+				uint32_t parentIndex;
+				uint32_t color;
+				uint16_t depth;
+				ScopeCategory category;
+				uint64_t beginTicks;
+				std::atomic<uint64_t> endTicks;
+			};
+
+			struct EventBuffer
+			{
+				std::unique_ptr<Event[]> events;
+				std::atomic<uint32_t> eventCount{ 0 };
+				std::atomic<uint32_t> droppedEventCount{ 0 };
+				std::atomic<uint64_t> frameIndex{ 0 };
+			};
+
+			struct OpenScope
+			{
+				Event* event;
+				uint64_t frameIndex;
+				uint32_t eventIndex;
+			};
+
+			struct ThreadEvents
+			{
+				EventBuffer buffers[2];
+				// Accessed only by the owning thread
+				OpenScope openScopes[CPU_SCOPE_MAX_DEPTH];
+				uint32_t depth{ 0 };
+				CPUThreadInfo info;
+			};
+
+			std::vector<std::unique_ptr<ThreadEvents>> _threadEvents;
+			std::unordered_map<std::thread::id, ThreadEvents*> _threadEventsByThreadID;
+			mutable std::mutex _threadEventsMutex;
+			std::atomic<uint64_t> _frameIndex{ 0 };
+			CPUClockCalibration _clockCalibration;
+			uint64_t _frameBeginTicks{ 0 };
+			uint32_t _eventCapacityPerThread{ 0 };
+			uint64_t _id{ 0 };
+
+			ThreadEvents& get_thread_events();
+			ThreadEvents* register_thread();
+	};
+}
@@ -0,0 +1,27 @@
+#include "cpu_timeline.h"
+
+using namespace ad_astris;
+using namespace profiler;
+
+constexpr std::chrono::microseconds INITIAL_CALIBRATION_TIME(500);
+
+CPUClockCalibration::CPUClockCalibration()
+{
+	_baseTime = std::chrono::steady_clock::now();
+	_baseTicks = CPUClock::get_ticks();
+
+	// Short busy wait to get approximate frequency for the first frames
+	while (std::chrono::steady_clock::now() - _baseTime < INITIAL_CALIBRATION_TIME)
+	{
+
+	}
+	calibrate();
+}
+
+void CPUClockCalibration::calibrate()
+{
+	uint64_t ticks = CPUClock::get_ticks();
+	std::chrono::nanoseconds elapsedTime = std::chrono::steady_clock::now() - _baseTime;
+	if (ticks > _baseTicks)
+		_nanosecondsPerTick = static_cast<double>(elapsedTime.count()) / static_cast<double>(ticks - _baseTicks);
+}
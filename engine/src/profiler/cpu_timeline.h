@@ -0,0 +1,104 @@
+#pragma once
+
+#include "scope_descriptor.h"
+#include "core/common.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PROFILER_USE_RDTSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILER_USE_RDTSC 0
+#endif
+
+namespace ad_astris::profiler
+{
+	constexpr uint32_t INVALID_CPU_EVENT_INDEX = ~0u;
+
+	// rdtsc is used where it is available because it is several times faster than clock::now().
+	// Ticks are converted to nanoseconds once per frame using CPUClockCalibration
+	class CPUClock
+	{
+		public:
+			FORCE_INLINE static uint64_t get_ticks()
+			{
+#if PROFILER_USE_RDTSC
+				return __rdtsc();
+#else
+				return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+			}
+	};
+
+	class CPUClockCalibration
+	{
+		public:
+			CPUClockCalibration();
+
+			// Updates ticks frequency using the time passed since construction
+			void calibrate();
+
+			uint64_t to_nanoseconds(uint64_t ticks) const
+			{
+				if (ticks < _baseTicks)
+					return 0;
+				return static_cast<uint64_t>(static_cast<double>(ticks - _baseTicks) * _nanosecondsPerTick);
+			}
+
+		private:
+			uint64_t _baseTicks{ 0 };
+			std::chrono::steady_clock::time_point _baseTime;
+			double _nanosecondsPerTick{ 1.0 };
+	};
+
+	struct CPUThreadInfo
+	{
+		std::thread::id threadID;
+		uint32_t threadIndex{ 0 };
+		std::string name;
+	};
+
+	struct CPUTimelineEvent
+	{
+		Name name;
+		uint32_t threadIndex{ 0 };
+		uint32_t depth{ 0 };
+		uint32_t parentIndex{ INVALID_CPU_EVENT_INDEX };	// Index in CPUTimeline::events
+		uint32_t color{ SCOPE_COLOR_DEFAULT };
+		ScopeCategory category{ ScopeCategory::GENERAL };
+		bool isFinished{ true };		// false if the scope was still open when the frame ended
+		uint64_t beginNs{ 0 };			// Nanoseconds since the profiler was created
+		uint64_t endNs{ 0 };
+
+		double get_duration_ms() const
+		{
+			return static_cast<double>(endNs - beginNs) / 1000000.0;
+		}
+	};
+
+	// Events of one frame from all threads. Events of each thread are stored contiguously in the order
+	// their scopes were opened, so parent events always precede child events
+	struct CPUTimeline
+	{
+		uint64_t frameID{ 0 };
+		uint64_t frameBeginNs{ 0 };
+		uint64_t frameEndNs{ 0 };
+		uint64_t droppedEventCount{ 0 };
+		std::vector<CPUTimelineEvent> events;
+		std::vector<CPUThreadInfo> threads;
+
+		void clear()
+		{
+			events.clear();
+			threads.clear();
+			droppedEventCount = 0;
+		}
+	};
+}
@@ -8,6 +8,10 @@
 #ifdef _WIN32
 #include <windows.h>
 #include <psapi.h>
+#elif defined(__linux__)
+#include <sys/sysinfo.h>
+#include <unistd.h>
+#include <cstdio>
 #endif
 
 using namespace ad_astris;
@@ -16,6 +20,7 @@ using namespace nlohmann;
 
 constexpr const char* CPU_RANGES_KEY = "cpu_ranges";
 constexpr const char* GPU_RANGES_KEY = "gpu_ranges";
+constexpr const char* PIPELINE_STATISTICS_KEY = "pipeline_statistics";
 constexpr const char* FRAME_NAME_KEY = "frame_name";
 constexpr const char* FRAME_ID_KEY = "frame_id";
 constexpr const char* CPU_TOTAL_PHYSICAL_MEMORY_KEY = "cpu_total_physical_memory";
@@ -24,34 +29,59 @@ constexpr const char* CPU_PROCESSED_PHYSICAL_MEMORY_KEY = "cpu_processed_physica
 constexpr const char* CPU_PROCESSED_VIRTUAL_MEMORY_KEY = "cpu_processed_virtual_memory";
 constexpr const char* GPU_TOTAL_MEMORY_KEY = "gpu_total_memory";
 constexpr const char* GPU_USAGE_KEY = "gpu_usage";
+constexpr const char* FRAME_SCRATCH_CAPACITY_KEY = "frame_scratch_capacity";
+constexpr const char* FRAME_SCRATCH_USED_KEY = "frame_scratch_used";
+constexpr const char* FRAME_SCRATCH_HIGH_WATER_KEY = "frame_scratch_high_water";
+constexpr const char* FRAME_SCRATCH_OVERFLOW_KEY = "frame_scratch_overflow";
+constexpr const char* FRAME_SCRATCH_THREAD_COUNT_KEY = "frame_scratch_thread_count";
+constexpr const char* MEMORY_TAGS_KEY = "memory_tags";
+constexpr const char* MEMORY_TAG_LIVE_KEY = "live";
+constexpr const char* MEMORY_TAG_PEAK_KEY = "peak";
+constexpr const char* MEMORY_TAG_ALLOCATIONS_KEY = "allocations";
+constexpr const char* MEMORY_TAG_FREES_KEY = "frees";
+constexpr const char* RESOURCE_RESIDENCY_KEY = "resource_residency";
+constexpr const char* RESIDENT_SIZE_KEY = "resident_size";
+constexpr const char* BUDGET_KEY = "budget";
+constexpr const char* RESIDENT_COUNT_KEY = "resident_count";
+constexpr const char* REFERENCED_COUNT_KEY = "referenced_count";
+constexpr const char* LOAD_COUNT_KEY = "load_count";
+constexpr const char* EVICTION_COUNT_KEY = "eviction_count";
+constexpr const char* EVICTED_SIZE_KEY = "evicted_size";
 
 FrameStats::FrameStats(FrameID frameID) : _frameID(frameID)
 {
 	generate_frame_name();
 }
 
-void FrameStats::add_range(CPURange* cpuRange)
+void FrameStats::add_cpu_timing(Name rangeName, Timing time)
 {
-	auto it = _cpuRangeTimingByRangeName.find(cpuRange->name);
-	if (it != _cpuRangeTimingByRangeName.end())
-	{
-		LOG_WARNING("FrameStats::add_range(): CPU range with name {} exists", cpuRange->name)
-		return;
-	}
-
-	_cpuRangeTimingByRangeName[cpuRange->name] = cpuRange->time;
+	_cpuRangeTimings[rangeName] += time;
 }
 
-void FrameStats::add_range(GPURange* gpuRange)
+void FrameStats::add_range(const GPURange* gpuRange)
 {
-	auto it = _cpuRangeTimingByRangeName.find(gpuRange->name);
-	if (it != _cpuRangeTimingByRangeName.end())
+	auto result = _gpuRangeTimings.try_emplace(gpuRange->name, gpuRange->time);
+	if (!result.second)
 	{
-		LOG_WARNING("FrameStats::add_range(): GPU range with name {} exists", gpuRange->name)
-		return;
+		LOG_WARNING("FrameStats::add_range(): GPU range with name {} exists", gpuRange->name.c_str())
 	}
 
-	_gpuRangeTimingByRangeName[gpuRange->name] = gpuRange->time;
+	if (gpuRange->pipelineStatisticsQueryIndex < 0)
+		return;
+
+	const rhi::PipelineStatistics& src = gpuRange->pipelineStatistics;
+	rhi::PipelineStatistics& dst = _pipelineStatistics[gpuRange->name];
+	dst.inputAssemblyVertices += src.inputAssemblyVertices;
+	dst.inputAssemblyPrimitives += src.inputAssemblyPrimitives;
+	dst.vertexShaderInvocations += src.vertexShaderInvocations;
+	dst.geometryShaderInvocations += src.geometryShaderInvocations;
+	dst.geometryShaderPrimitives += src.geometryShaderPrimitives;
+	dst.clippingInvocations += src.clippingInvocations;
+	dst.clippingPrimitives += src.clippingPrimitives;
+	dst.fragmentShaderInvocations += src.fragmentShaderInvocations;
+	dst.tessellationControlShaderPatches += src.tessellationControlShaderPatches;
+	dst.tessellationEvaluationShaderInvocations += src.tessellationEvaluationShaderInvocations;
+	dst.computeShaderInvocations += src.computeShaderInvocations;
 }
 
 void FrameStats::calculate_memory_usage(rhi::RHI* rhi)
@@ -69,28 +99,67 @@ void FrameStats::calculate_memory_usage(rhi::RHI* rhi)
 
 	PROCESS_MEMORY_COUNTERS_EX processMemory{};
 	GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&processMemory, sizeof(processMemory));
-	_cpuMemoryUsage.processedPhysical += processMemory.WorkingSetSize;
-	_cpuMemoryUsage.processedVirtual += processMemory.PrivateUsage;
+	_cpuMemoryUsage.processedPhysical = processMemory.WorkingSetSize;
+	_cpuMemoryUsage.processedVirtual = processMemory.PrivateUsage;
+#elif defined(__linux__)
+	struct sysinfo memoryInfo{};
+	if (!sysinfo(&memoryInfo))
+	{
+		_cpuMemoryUsage.totalPhysical = (uint64_t)memoryInfo.totalram * memoryInfo.mem_unit;
+		_cpuMemoryUsage.totalVirtual = ((uint64_t)memoryInfo.totalram + memoryInfo.totalswap) * memoryInfo.mem_unit;
+	}
+
+	// /proc/self/statm contains sizes in pages: total program size, resident set size, ...
+	if (FILE* statm = fopen("/proc/self/statm", "r"))
+	{
+		uint64_t virtualPages = 0, residentPages = 0;
+		if (fscanf(statm, "%lu %lu", &virtualPages, &residentPages) == 2)
+		{
+			uint64_t pageSize = sysconf(_SC_PAGESIZE);
+			_cpuMemoryUsage.processedPhysical = residentPages * pageSize;
+			_cpuMemoryUsage.processedVirtual = virtualPages * pageSize;
+		}
+		fclose(statm);
+	}
 #endif
+
+	_memoryTagStats = MemoryTracker::get_all_stats();
+}
+
+void FrameStats::set_frame_scratch_usage(const FrameScratchUsage& frameScratchUsage)
+{
+	_frameScratchUsage = frameScratchUsage;
 }
 
 void FrameStats::serialize(std::string& outputMetadata)
 {
 	json cpuRangesJson;
-	for (auto& pair : _cpuRangeTimingByRangeName)
+	for (auto& pair : _cpuRangeTimings)
 	{
-		cpuRangesJson[pair.first] = pair.second;
+		cpuRangesJson[pair.first.to_string()] = pair.second;
 	}
 
 	json gpuRangesJson;
-	for (auto& pair : _gpuRangeTimingByRangeName)
+	for (auto& pair : _gpuRangeTimings)
 	{
-		gpuRangesJson[pair.first] = pair.second;
+		gpuRangesJson[pair.first.to_string()] = pair.second;
+	}
+	
+	json pipelineStatisticsJson = json::object();
+	for (auto& pair : _pipelineStatistics)
+	{
+		json& rangeJson = pipelineStatisticsJson[pair.first.to_string()];
+		for (size_t i = 0; i != PIPELINE_STATISTIC_COUNT; ++i)
+		{
+			PipelineStatisticType type = static_cast<PipelineStatisticType>(i);
+			rangeJson[get_pipeline_statistic_name(type)] = get_pipeline_statistic(pair.second, type);
+		}
 	}
 	
 	json frameStatsJson;
 	frameStatsJson[CPU_RANGES_KEY] = cpuRangesJson;
 	frameStatsJson[GPU_RANGES_KEY] = gpuRangesJson;
+	frameStatsJson[PIPELINE_STATISTICS_KEY] = pipelineStatisticsJson;
 	frameStatsJson[FRAME_NAME_KEY] = _frameName;
 	frameStatsJson[FRAME_ID_KEY] = _frameID;
 	frameStatsJson[CPU_TOTAL_PHYSICAL_MEMORY_KEY] = _cpuMemoryUsage.totalPhysical;
@@ -99,6 +168,37 @@ void FrameStats::serialize(std::string& outputMetadata)
 	frameStatsJson[CPU_PROCESSED_VIRTUAL_MEMORY_KEY] = _cpuMemoryUsage.processedVirtual;
 	frameStatsJson[GPU_TOTAL_MEMORY_KEY] = _gpuMemoryUsage.total;
 	frameStatsJson[GPU_USAGE_KEY] = _gpuMemoryUsage.usage;
+	frameStatsJson[FRAME_SCRATCH_CAPACITY_KEY] = _frameScratchUsage.capacity;
+	frameStatsJson[FRAME_SCRATCH_USED_KEY] = _frameScratchUsage.used;
+	frameStatsJson[FRAME_SCRATCH_HIGH_WATER_KEY] = _frameScratchUsage.highWater;
+	frameStatsJson[FRAME_SCRATCH_OVERFLOW_KEY] = _frameScratchUsage.overflow;
+	frameStatsJson[FRAME_SCRATCH_THREAD_COUNT_KEY] = _frameScratchUsage.threadCount;
+
+	json memoryTagsJson;
+	for (size_t i = 0; i != MEMORY_TAG_COUNT; ++i)
+	{
+		const MemoryTagStats& tagStats = _memoryTagStats[i];
+		json& tagJson = memoryTagsJson[MemoryTracker::get_tag_name(static_cast<MemoryTag>(i))];
+		tagJson[MEMORY_TAG_LIVE_KEY] = tagStats.liveBytes;
+		tagJson[MEMORY_TAG_PEAK_KEY] = tagStats.peakBytes;
+		tagJson[MEMORY_TAG_ALLOCATIONS_KEY] = tagStats.allocationCount;
+		tagJson[MEMORY_TAG_FREES_KEY] = tagStats.freeCount;
+	}
+	frameStatsJson[MEMORY_TAGS_KEY] = memoryTagsJson;
+
+	json resourceResidencyJson = json::object();
+	for (auto& usage : _resourceResidencyUsage)
+	{
+		json& typeJson = resourceResidencyJson[usage.typeName];
+		typeJson[RESIDENT_SIZE_KEY] = usage.residentSize;
+		typeJson[BUDGET_KEY] = usage.budget;
+		typeJson[RESIDENT_COUNT_KEY] = usage.residentCount;
+		typeJson[REFERENCED_COUNT_KEY] = usage.referencedCount;
+		typeJson[LOAD_COUNT_KEY] = usage.loadCount;
+		typeJson[EVICTION_COUNT_KEY] = usage.evictionCount;
+		typeJson[EVICTED_SIZE_KEY] = usage.evictedSize;
+	}
+	frameStatsJson[RESOURCE_RESIDENCY_KEY] = resourceResidencyJson;
 
 	outputMetadata = frameStatsJson.dump(4);
 }
@@ -114,16 +214,70 @@ void FrameStats::deserialize(std::string& inputMetadata)
 	_cpuMemoryUsage.processedVirtual = frameStatsJson[CPU_PROCESSED_VIRTUAL_MEMORY_KEY];
 	_gpuMemoryUsage.total = frameStatsJson[GPU_TOTAL_MEMORY_KEY];
 	_gpuMemoryUsage.usage = frameStatsJson[GPU_USAGE_KEY];
+	// Frame stats files that were saved before frame scratch memory was added don't have these keys
+	_frameScratchUsage.capacity = frameStatsJson.value(FRAME_SCRATCH_CAPACITY_KEY, 0ull);
+	_frameScratchUsage.used = frameStatsJson.value(FRAME_SCRATCH_USED_KEY, 0ull);
+	_frameScratchUsage.highWater = frameStatsJson.value(FRAME_SCRATCH_HIGH_WATER_KEY, 0ull);
+	_frameScratchUsage.overflow = frameStatsJson.value(FRAME_SCRATCH_OVERFLOW_KEY, 0ull);
+	_frameScratchUsage.threadCount = frameStatsJson.value(FRAME_SCRATCH_THREAD_COUNT_KEY, 0u);
+	auto memoryTagsIt = frameStatsJson.find(MEMORY_TAGS_KEY);
+	if (memoryTagsIt != frameStatsJson.end())
+	{
+		for (size_t i = 0; i != MEMORY_TAG_COUNT; ++i)
+		{
+			auto tagIt = memoryTagsIt->find(MemoryTracker::get_tag_name(static_cast<MemoryTag>(i)));
+			if (tagIt == memoryTagsIt->end())
+				continue;
+			MemoryTagStats& tagStats = _memoryTagStats[i];
+			tagStats.liveBytes = tagIt->value(MEMORY_TAG_LIVE_KEY, 0ull);
+			tagStats.peakBytes = tagIt->value(MEMORY_TAG_PEAK_KEY, 0ull);
+			tagStats.allocationCount = tagIt->value(MEMORY_TAG_ALLOCATIONS_KEY, 0ull);
+			tagStats.freeCount = tagIt->value(MEMORY_TAG_FREES_KEY, 0ull);
+		}
+	}
+	auto resourceResidencyIt = frameStatsJson.find(RESOURCE_RESIDENCY_KEY);
+	if (resourceResidencyIt != frameStatsJson.end())
+	{
+		_resourceResidencyUsage.clear();
+		for (auto& keyValue : resourceResidencyIt->items())
+		{
+			const json& typeJson = keyValue.value();
+			ResourceResidencyUsage& usage = _resourceResidencyUsage.emplace_back();
+			usage.typeName = keyValue.key();
+			usage.residentSize = typeJson.value(RESIDENT_SIZE_KEY, 0ull);
+			usage.budget = typeJson.value(BUDGET_KEY, 0ull);
+			usage.residentCount = typeJson.value(RESIDENT_COUNT_KEY, 0ull);
+			usage.referencedCount = typeJson.value(REFERENCED_COUNT_KEY, 0ull);
+			usage.loadCount = typeJson.value(LOAD_COUNT_KEY, 0ull);
+			usage.evictionCount = typeJson.value(EVICTION_COUNT_KEY, 0ull);
+			usage.evictedSize = typeJson.value(EVICTED_SIZE_KEY, 0ull);
+		}
+	}
 	json cpuRangesJson = frameStatsJson[CPU_RANGES_KEY];
 	json gpuRangesJson = frameStatsJson[GPU_RANGES_KEY];
 	for (auto& keyValue : cpuRangesJson.items())
 	{
-		_cpuRangeTimingByRangeName[keyValue.key()] = keyValue.value();
+		_cpuRangeTimings[Name(keyValue.key())] = keyValue.value();
 	}
 
 	for (auto& keyValue : gpuRangesJson.items())
 	{
-		_gpuRangeTimingByRangeName[keyValue.key()] = keyValue.value();
+		_gpuRangeTimings[Name(keyValue.key())] = keyValue.value();
+	}
+
+	auto pipelineStatisticsIt = frameStatsJson.find(PIPELINE_STATISTICS_KEY);
+	if (pipelineStatisticsIt != frameStatsJson.end())
+	{
+		for (auto& keyValue : pipelineStatisticsIt->items())
+		{
+			const json& rangeJson = keyValue.value();
+			rhi::PipelineStatistics& statistics = _pipelineStatistics[Name(keyValue.key())];
+			statistics.vertexShaderInvocations = rangeJson.value(get_pipeline_statistic_name(PipelineStatisticType::VERTEX_SHADER_INVOCATIONS), 0ull);
+			statistics.fragmentShaderInvocations = rangeJson.value(get_pipeline_statistic_name(PipelineStatisticType::FRAGMENT_SHADER_INVOCATIONS), 0ull);
+			statistics.computeShaderInvocations = rangeJson.value(get_pipeline_statistic_name(PipelineStatisticType::COMPUTE_SHADER_INVOCATIONS), 0ull);
+			statistics.inputAssemblyPrimitives = rangeJson.value(get_pipeline_statistic_name(PipelineStatisticType::INPUT_ASSEMBLY_PRIMITIVES), 0ull);
+			statistics.clippingPrimitives = rangeJson.value(get_pipeline_statistic_name(PipelineStatisticType::CLIPPING_PRIMITIVES), 0ull);
+		}
 	}
 }
 
@@ -132,8 +286,10 @@ void FrameStats::reset(FrameID frameID)
 	_frameID = frameID;
 	generate_frame_name();
 	// Maybe I don't need this and I have to remove warnings in add_range methods.
-	_cpuRangeTimingByRangeName.clear();
-	_gpuRangeTimingByRangeName.clear();
+	_cpuRangeTimings.clear();
+	_gpuRangeTimings.clear();
+	_pipelineStatistics.clear();
+	_resourceResidencyUsage.clear();
 }
 
 void FrameStats::generate_frame_name()
@@ -2,7 +2,9 @@
 
 #include "types.h"
 #include "rhi/engine_rhi.h"
-#include <unordered_map>
+#include "core/frame_scratch_allocator.h"
+#include "core/memory_tracker.h"
+#include "range_statistics.h"
 
 namespace ad_astris::profiler
 {
@@ -12,23 +14,36 @@ namespace ad_astris::profiler
 			FrameStats() = default;
 			FrameStats(FrameID frameID);
 
-			void add_range(CPURange* cpuRange);
-			void add_range(GPURange* gpuRange);
+			// Timings of scopes with the same name are summed
+			void add_cpu_timing(Name rangeName, Timing time);
+			// Pipeline statistics are added only if they were collected for the range
+			void add_range(const GPURange* gpuRange);
 			void calculate_memory_usage(rhi::RHI* rhi);
+			void set_frame_scratch_usage(const FrameScratchUsage& frameScratchUsage);
+			// Filled by IResourceResidencyProvider at the end of the frame
+			std::vector<ResourceResidencyUsage>& get_resource_residency_usage()
+			{
+				return _resourceResidencyUsage;
+			}
 
 			void serialize(std::string& outputMetadata);
 			void deserialize(std::string& inputMetadata);
 
 			void reset(FrameID frameID);
 
-			const std::unordered_map<RangeName, Timing>& get_cpu_timings() const
+			const RangeTimingTable& get_cpu_timings() const
 			{
-				return _cpuRangeTimingByRangeName;
+				return _cpuRangeTimings;
 			}
 
-			const std::unordered_map<RangeName, Timing>& get_gpu_timings() const
+			const RangeTimingTable& get_gpu_timings() const
 			{
-				return _gpuRangeTimingByRangeName;
+				return _gpuRangeTimings;
+			}
+
+			const PipelineStatisticsTable& get_pipeline_statistics() const
+			{
+				return _pipelineStatistics;
 			}
 
 			const CPUMemoryUsage& get_cpu_memory_usage() const
@@ -41,6 +56,21 @@ namespace ad_astris::profiler
 				return _gpuMemoryUsage;
 			}
 
+			const FrameScratchUsage& get_frame_scratch_usage() const
+			{
+				return _frameScratchUsage;
+			}
+
+			const std::vector<ResourceResidencyUsage>& get_resource_residency_usage() const
+			{
+				return _resourceResidencyUsage;
+			}
+
+			const MemoryTagStatsArray& get_memory_tag_stats() const
+			{
+				return _memoryTagStats;
+			}
+
 			FrameID get_id() const
 			{
 				return _frameID;
@@ -59,10 +89,14 @@ namespace ad_astris::profiler
 		private:
 			FrameID _frameID;
 			FrameName _frameName;
-			std::unordered_map<RangeName, Timing> _cpuRangeTimingByRangeName;
-			std::unordered_map<RangeName, Timing> _gpuRangeTimingByRangeName;
+			RangeTimingTable _cpuRangeTimings;
+			RangeTimingTable _gpuRangeTimings;
+			PipelineStatisticsTable _pipelineStatistics;
 			CPUMemoryUsage _cpuMemoryUsage;
 			rhi::GPUMemoryUsage _gpuMemoryUsage;
+			FrameScratchUsage _frameScratchUsage;
+			MemoryTagStatsArray _memoryTagStats;
+			std::vector<ResourceResidencyUsage> _resourceResidencyUsage;
 
 			void generate_frame_name();
 	};
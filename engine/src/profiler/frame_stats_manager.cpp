@@ -1,4 +1,5 @@
 ﻿#include "frame_stats_manager.h"
+#include <cmath>
 
 using namespace ad_astris;
 using namespace profiler;
@@ -45,3 +46,68 @@ FrameStats* FrameStatsManager::build_frame_stats(std::string& inputSerializedMet
 
 	return frameStats;
 }
+
+void FrameStatsManager::update_range_statistics(const FrameStats& frameStats)
+{
+	update_range_histories(frameStats.get_cpu_timings(), _cpuRangeHistories);
+	update_range_histories(frameStats.get_gpu_timings(), _gpuRangeHistories);
+
+	// Counts don't have hitches, an infinite threshold disables hitch detection
+	for (auto& [rangeName, statistics] : frameStats.get_pipeline_statistics())
+	{
+		auto& histories = _pipelineStatisticsHistories[rangeName];
+		for (size_t i = 0; i != PIPELINE_STATISTIC_COUNT; ++i)
+		{
+			Timing value = static_cast<Timing>(get_pipeline_statistic(statistics, static_cast<PipelineStatisticType>(i)));
+			histories[i].add_timing(value, INFINITY);
+		}
+	}
+}
+
+void FrameStatsManager::capture_range_statistics(RangeStatisticsCapture& outCapture) const
+{
+	capture_range_histories(_cpuRangeHistories, outCapture.cpuRanges);
+	capture_range_histories(_gpuRangeHistories, outCapture.gpuRanges);
+
+	outCapture.pipelineStatistics.clear();
+	outCapture.pipelineStatistics.reserve(_pipelineStatisticsHistories.size());
+	for (auto& [rangeName, histories] : _pipelineStatisticsHistories)
+	{
+		PipelineStatisticsSummary& summary = outCapture.pipelineStatistics[rangeName];
+		for (size_t i = 0; i != PIPELINE_STATISTIC_COUNT; ++i)
+			histories[i].calculate_statistics(summary[i], _percentileScratch);
+	}
+}
+
+void FrameStatsManager::reset_range_statistics()
+{
+	for (auto& [rangeName, history] : _cpuRangeHistories)
+		history.reset();
+	for (auto& [rangeName, history] : _gpuRangeHistories)
+		history.reset();
+	for (auto& [rangeName, histories] : _pipelineStatisticsHistories)
+	{
+		for (auto& history : histories)
+			history.reset();
+	}
+	_hitchCount = 0;
+}
+
+void FrameStatsManager::update_range_histories(const RangeTimingTable& timings, FlatHashMap<Name, RangeTimingHistory>& histories)
+{
+	for (auto& [rangeName, time] : timings)
+	{
+		if (histories[rangeName].add_timing(time, _hitchThreshold))
+			++_hitchCount;
+	}
+}
+
+void FrameStatsManager::capture_range_histories(
+	const FlatHashMap<Name, RangeTimingHistory>& histories,
+	RangeStatisticsTable& outStatistics) const
+{
+	outStatistics.clear();
+	outStatistics.reserve(histories.size());
+	for (auto& [rangeName, history] : histories)
+		history.calculate_statistics(outStatistics[rangeName], _percentileScratch);
+}
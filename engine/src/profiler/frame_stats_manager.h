@@ -20,11 +20,39 @@ namespace ad_astris::profiler
 			{
 				return _frameStatsHistory[frameID % _frameStatsHistoryCapacity];
 			}
+
+			// Adds timings of the finished frame to the streaming statistics. Must be called from one thread
+			void update_range_statistics(const FrameStats& frameStats);
+			void capture_range_statistics(RangeStatisticsCapture& outCapture) const;
+			// Starts collecting statistics from scratch, for example, before a benchmark run
+			void reset_range_statistics();
+
+			void set_hitch_threshold(double hitchThreshold)
+			{
+				_hitchThreshold = hitchThreshold;
+			}
+
+			uint64_t get_hitch_count() const
+			{
+				return _hitchCount;
+			}
 		
 		private:
 			ThreadSafePoolAllocator<FrameStats> _frameStatsPool;
 			std::vector<FrameStats*> _frameStatsHistory;
 			std::unordered_map<FrameName, FrameStats*> _loadedFrameStatsByFrameName;
 			uint64_t _frameStatsHistoryCapacity{ 0 };
+
+			FlatHashMap<Name, RangeTimingHistory> _cpuRangeHistories;
+			FlatHashMap<Name, RangeTimingHistory> _gpuRangeHistories;
+			FlatHashMap<Name, std::array<RangeTimingHistory, PIPELINE_STATISTIC_COUNT>> _pipelineStatisticsHistories;
+			mutable std::vector<Timing> _percentileScratch;
+			double _hitchThreshold{ DEFAULT_HITCH_THRESHOLD };
+			uint64_t _hitchCount{ 0 };		// Range timings that were marked as hitches since the last reset
+
+			void update_range_histories(const RangeTimingTable& timings, FlatHashMap<Name, RangeTimingHistory>& histories);
+			void capture_range_histories(
+				const FlatHashMap<Name, RangeTimingHistory>& histories,
+				RangeStatisticsTable& outStatistics) const;
 	};
 }
\ No newline at end of file
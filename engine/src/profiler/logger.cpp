@@ -0,0 +1,483 @@
+#include "logger.h"
+#include <fmt_lib/fmt/color.h>
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+
+using namespace ad_astris;
+using namespace profiler;
+
+constexpr std::chrono::milliseconds BACKEND_IDLE_TIME(2);
+
+static std::atomic<uint64_t> g_nextLoggerInstanceID{ 1 };
+
+namespace
+{
+	std::string_view get_log_type_tag(LogType logType)
+	{
+		switch (logType)
+		{
+			case LogType::FATAL:
+				return "[FATAL]:   ";
+			case LogType::ERROR_TYPE:
+				return "[ERROR]:   ";
+			case LogType::WARNING:
+				return "[WARNING]: ";
+			case LogType::INFO:
+				return "[INFO]:    ";
+			default:
+				return "[SUCCESS]: ";
+		}
+	}
+
+	fmt::text_style get_log_type_style(LogType logType)
+	{
+		switch (logType)
+		{
+			case LogType::FATAL:
+				return fg(fmt::color::dark_red) | fmt::emphasis::bold;
+			case LogType::ERROR_TYPE:
+				return fg(fmt::color::red) | fmt::emphasis::bold;
+			case LogType::WARNING:
+				return fg(fmt::color::dark_violet) | fmt::emphasis::bold;
+			case LogType::INFO:
+				return fg(fmt::color::royal_blue) | fmt::emphasis::bold;
+			default:
+				return fg(fmt::color::lime_green) | fmt::emphasis::bold;
+		}
+	}
+
+	std::filesystem::path get_rotated_log_file_path(const std::filesystem::path& filePath, uint32_t index)
+	{
+		if (!index)
+			return filePath;
+
+		std::filesystem::path rotatedPath = filePath;
+		rotatedPath.replace_filename(filePath.stem().string() + "." + std::to_string(index) + filePath.extension().string());
+		return rotatedPath;
+	}
+}
+
+LogRecordQueue::LogRecordQueue(uint32_t capacity)
+{
+	assert(capacity >= LOG_RECORD_ALIGNMENT && (capacity & (capacity - 1)) == 0);
+	_capacity = capacity;
+	_blocks.reset(new Block[_capacity / LOG_RECORD_ALIGNMENT]);
+}
+
+std::byte* LogRecordQueue::try_reserve(uint32_t size)
+{
+	uint64_t writePosition = _writePosition.load(std::memory_order_relaxed);
+	uint64_t tailSize = _capacity - (writePosition & (_capacity - 1));
+	uint64_t requiredSize = size <= tailSize ? size : tailSize + size;
+	if (writePosition + requiredSize - _cachedReadPosition > _capacity)
+	{
+		_cachedReadPosition = _readPosition.load(std::memory_order_acquire);
+		if (writePosition + requiredSize - _cachedReadPosition > _capacity)
+			return nullptr;
+	}
+
+	if (size > tailSize)
+	{
+		LogRecordHeader* padding = reinterpret_cast<LogRecordHeader*>(get_data(writePosition));
+		padding->size = static_cast<uint32_t>(tailSize);
+		padding->formatFunction = nullptr;
+		writePosition += tailSize;
+		_writePosition.store(writePosition, std::memory_order_release);
+	}
+
+	return get_data(writePosition);
+}
+
+std::byte* LogRecordQueue::get_record(uint64_t& position, uint64_t endPosition)
+{
+	while (position != endPosition)
+	{
+		std::byte* record = get_data(position);
+		const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(record);
+		if (header->formatFunction)
+			return record;
+		position += header->size;
+	}
+	return nullptr;
+}
+
+LoggerInstance::LoggerInstance(LogBackendMode backendMode, uint32_t queueCapacityPerThread)
+	: _backendMode(backendMode), _queueCapacityPerThread(queueCapacityPerThread), _id(g_nextLoggerInstanceID.fetch_add(1))
+{
+	// Padding before the record can take almost the whole record size, so one record must fit into half of the queue
+	_maxRecordSize = _queueCapacityPerThread / 2;
+	_startTime = std::chrono::steady_clock::now();
+	if (_backendMode == LogBackendMode::ASYNC)
+	{
+		_isBackendRunning = true;
+		_backendThread = std::thread([this]{ run_backend(); });
+	}
+}
+
+LoggerInstance::~LoggerInstance()
+{
+	if (_backendThread.joinable())
+	{
+		{
+			std::scoped_lock<std::mutex> locker(_backendMutex);
+			_isBackendRunning = false;
+		}
+		_backendCondition.notify_one();
+		_backendThread.join();
+	}
+
+	std::scoped_lock<std::mutex> locker(_outputMutex);
+	process_records();
+	if (_file)
+		std::fclose(_file);
+}
+
+void LoggerInstance::flush()
+{
+	if (_backendMode == LogBackendMode::SYNC)
+	{
+		std::scoped_lock<std::mutex> locker(_outputMutex);
+		process_records();
+		return;
+	}
+
+	std::unique_lock<std::mutex> locker(_backendMutex);
+	uint64_t flushRequest = ++_flushRequest;
+	_backendCondition.notify_one();
+	_flushCondition.wait(locker, [&]{ return _completedFlushRequest >= flushRequest || !_isBackendRunning; });
+}
+
+bool LoggerInstance::open_log_file(const LogFileSettings& settings)
+{
+	std::scoped_lock<std::mutex> locker(_outputMutex);
+	process_records();
+	if (_file)
+	{
+		std::fclose(_file);
+		_file = nullptr;
+	}
+
+	_fileSettings = settings;
+	_fileSettings.maxFileCount = std::max(_fileSettings.maxFileCount, 1u);
+	std::error_code errorCode;
+	std::filesystem::path filePath(_fileSettings.filePath);
+	if (filePath.has_parent_path())
+		std::filesystem::create_directories(filePath.parent_path(), errorCode);
+	if (std::filesystem::exists(filePath, errorCode))
+		rotate_log_files();
+
+	return open_file();
+}
+
+void LoggerInstance::close_log_file()
+{
+	std::scoped_lock<std::mutex> locker(_outputMutex);
+	process_records();
+	if (_file)
+	{
+		std::fclose(_file);
+		_file = nullptr;
+	}
+}
+
+LogRecordQueue& LoggerInstance::get_thread_queue()
+{
+	// Module DLLs link engine_core statically, so every module has its own copy of this cache.
+	// Queues are registered inside the logger instance, the cache only stores the result of the lookup.
+	// A queue of the instance that the thread has switched from is kept until that instance is destroyed
+	struct ThreadQueueCache
+	{
+		const LoggerInstance* owner{ nullptr };
+		uint64_t ownerID{ 0 };
+		std::shared_ptr<LogRecordQueue> queue;
+
+		~ThreadQueueCache()
+		{
+			if (queue)
+				queue->set_producer_exited();
+		}
+	};
+	thread_local ThreadQueueCache cache;
+
+	if (cache.owner != this || cache.ownerID != _id)
+	{
+		cache.queue = register_thread();
+		cache.owner = this;
+		cache.ownerID = _id;
+	}
+
+	return *cache.queue;
+}
+
+std::shared_ptr<LogRecordQueue> LoggerInstance::register_thread()
+{
+	std::scoped_lock<std::mutex> locker(_queuesMutex);
+	// The ID of an exited thread can be reused by a new thread before the queue of the exited thread is drained
+	auto it = _queuesByThreadID.find(std::this_thread::get_id());
+	if (it != _queuesByThreadID.end() && !it->second->is_producer_exited())
+	{
+		for (auto& queue : _queues)
+		{
+			if (queue.get() == it->second)
+				return queue;
+		}
+	}
+
+	std::shared_ptr<LogRecordQueue>& queue = _queues.emplace_back(std::make_shared<LogRecordQueue>(_queueCapacityPerThread));
+	_queuesByThreadID[std::this_thread::get_id()] = queue.get();
+	return queue;
+}
+
+uint32_t LoggerInstance::get_thread_queue_count()
+{
+	std::scoped_lock<std::mutex> locker(_queuesMutex);
+	return static_cast<uint32_t>(_queues.size());
+}
+
+std::byte* LoggerInstance::reserve_record(LogRecordQueue& queue, uint32_t size)
+{
+	std::byte* record = queue.try_reserve(size);
+	while (!record)
+	{
+		// The producer waits instead of dropping messages, logs are expected to be complete
+		if (_backendMode == LogBackendMode::ASYNC)
+		{
+			_backendCondition.notify_one();
+			std::this_thread::yield();
+		}
+		else
+		{
+			std::scoped_lock<std::mutex> locker(_outputMutex);
+			process_records();
+		}
+		record = queue.try_reserve(size);
+	}
+	return record;
+}
+
+void LoggerInstance::commit_record(LogRecordQueue& queue, uint32_t size)
+{
+	queue.commit(size);
+	if (_backendMode == LogBackendMode::SYNC)
+	{
+		std::scoped_lock<std::mutex> locker(_outputMutex);
+		process_records();
+	}
+}
+
+void LoggerInstance::log_heap_message(LogType logType, std::string_view format, fmt::format_args args)
+{
+	std::string* message = new std::string();
+	try
+	{
+		*message = fmt::vformat(format, args);
+	}
+	catch (const fmt::format_error& error)
+	{
+		*message = fmt::format("Failed to format \"{}\": {}", format, error.what());
+	}
+
+	constexpr std::string_view heapMessageFormat = "{}";
+	LogHeapMessage heapMessage{ message };
+	size_t size = LogArgument<LogHeapMessage>::get_size(sizeof(LogRecordHeader) + heapMessageFormat.size(), heapMessage);
+	write_record<LogHeapMessage>(logType, heapMessageFormat, static_cast<uint32_t>(align_log_offset(size, LOG_RECORD_ALIGNMENT)), heapMessage);
+}
+
+void LoggerInstance::run_backend()
+{
+	std::unique_lock<std::mutex> backendLocker(_backendMutex);
+	while (true)
+	{
+		// Records that have been committed before the request or before the stop are processed in this iteration
+		uint64_t flushRequest = _flushRequest;
+		bool isRunning = _isBackendRunning;
+		backendLocker.unlock();
+
+		bool hasRecords = false;
+		{
+			std::scoped_lock<std::mutex> outputLocker(_outputMutex);
+			hasRecords = process_records();
+		}
+
+		backendLocker.lock();
+		if (_completedFlushRequest != flushRequest)
+		{
+			_completedFlushRequest = flushRequest;
+			_flushCondition.notify_all();
+		}
+
+		if (!isRunning)
+			break;
+
+		if (!hasRecords && _flushRequest == flushRequest && _isBackendRunning)
+			_backendCondition.wait_for(backendLocker, BACKEND_IDLE_TIME);
+	}
+	_flushCondition.notify_all();
+}
+
+bool LoggerInstance::process_records()
+{
+	_processedQueues.clear();
+	{
+		std::scoped_lock<std::mutex> locker(_queuesMutex);
+		for (auto& queue : _queues)
+			_processedQueues.push_back(queue.get());
+	}
+
+	_pendingRecords.clear();
+	_processedPositions.resize(_processedQueues.size());
+	for (size_t i = 0; i != _processedQueues.size(); ++i)
+	{
+		LogRecordQueue* queue = _processedQueues[i];
+		uint64_t position = queue->get_read_position();
+		uint64_t endPosition = queue->get_write_position();
+		while (std::byte* record = queue->get_record(position, endPosition))
+		{
+			const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(record);
+			_pendingRecords.push_back({ record, header->timeNs });
+			position += header->size;
+		}
+		_processedPositions[i] = position;
+	}
+
+	if (_pendingRecords.empty())
+	{
+		for (size_t i = 0; i != _processedQueues.size(); ++i)
+			_processedQueues[i]->release(_processedPositions[i]);
+		remove_exited_queues();
+		return false;
+	}
+
+	// Each queue is already ordered, merging keeps messages of different threads in the order they were logged
+	std::stable_sort(_pendingRecords.begin(), _pendingRecords.end(), [](const PendingRecord& a, const PendingRecord& b)
+	{
+		return a.timeNs < b.timeNs;
+	});
+
+	for (PendingRecord& pendingRecord : _pendingRecords)
+	{
+		_message.clear();
+		const LogRecordHeader& header = *reinterpret_cast<const LogRecordHeader*>(pendingRecord.record);
+		header.formatFunction(pendingRecord.record, _message);
+		write_message(header);
+	}
+
+	for (size_t i = 0; i != _processedQueues.size(); ++i)
+		_processedQueues[i]->release(_processedPositions[i]);
+	remove_exited_queues();
+
+	write_outputs();
+	return true;
+}
+
+void LoggerInstance::remove_exited_queues()
+{
+	std::scoped_lock<std::mutex> locker(_queuesMutex);
+	for (auto it = _queues.begin(); it != _queues.end();)
+	{
+		LogRecordQueue* queue = it->get();
+		// Records are committed before the thread exits, so the queue is drained if the read position is at the end
+		if (!queue->is_producer_exited() || queue->get_read_position() != queue->get_write_position())
+		{
+			++it;
+			continue;
+		}
+
+		for (auto threadIt = _queuesByThreadID.begin(); threadIt != _queuesByThreadID.end(); ++threadIt)
+		{
+			if (threadIt->second == queue)
+			{
+				_queuesByThreadID.erase(threadIt);
+				break;
+			}
+		}
+		it = _queues.erase(it);
+	}
+}
+
+void LoggerInstance::write_message(const LogRecordHeader& header)
+{
+	uint64_t milliseconds = header.timeNs / 1000000;
+	uint64_t seconds = milliseconds / 1000;
+	auto write_line = [&](fmt::memory_buffer& buffer, bool isColored)
+	{
+		fmt::format_to(fmt::appender(buffer), "[{:02}:{:02}.{:03}]", seconds / 60, seconds % 60, milliseconds % 1000);
+		if (isColored)
+			fmt::format_to(fmt::appender(buffer), get_log_type_style(header.type), "{}", get_log_type_tag(header.type));
+		else
+			buffer.append(get_log_type_tag(header.type));
+		buffer.append(_message);
+		buffer.push_back('\n');
+	};
+
+	if (_isConsoleOutputEnabled.load(std::memory_order_relaxed))
+		write_line(_consoleBuffer, true);
+	if (_file)
+		write_line(_fileBuffer, false);
+}
+
+void LoggerInstance::write_outputs()
+{
+	if (_consoleBuffer.size())
+	{
+		std::fwrite(_consoleBuffer.data(), 1, _consoleBuffer.size(), stdout);
+		std::fflush(stdout);
+		_consoleBuffer.clear();
+	}
+
+	if (_fileBuffer.size())
+	{
+		std::fwrite(_fileBuffer.data(), 1, _fileBuffer.size(), _file);
+		std::fflush(_file);
+		_fileSize += _fileBuffer.size();
+		_fileBuffer.clear();
+
+		// The file is rotated between batches, so it can exceed the limit by one batch
+		if (_fileSize >= _fileSettings.maxFileSize)
+		{
+			std::fclose(_file);
+			_file = nullptr;
+			rotate_log_files();
+			open_file();
+		}
+	}
+}
+
+bool LoggerInstance::open_file()
+{
+	_file = std::fopen(_fileSettings.filePath.c_str(), "wb");
+	_fileSize = 0;
+	if (!_file)
+	{
+		// Can't use LOG_ERROR here, the message would be written by this instance
+		fmt::print(stderr, "LoggerInstance::open_file(): Failed to open log file {}\n", _fileSettings.filePath);
+		return false;
+	}
+	return true;
+}
+
+void LoggerInstance::rotate_log_files()
+{
+	std::filesystem::path filePath(_fileSettings.filePath);
+	std::error_code errorCode;
+	if (_fileSettings.maxFileCount == 1)
+	{
+		std::filesystem::remove(filePath, errorCode);
+		return;
+	}
+
+	std::filesystem::remove(get_rotated_log_file_path(filePath, _fileSettings.maxFileCount - 1), errorCode);
+	for (uint32_t i = _fileSettings.maxFileCount - 1; i != 0; --i)
+	{
+		std::filesystem::path oldPath = get_rotated_log_file_path(filePath, i - 1);
+		if (std::filesystem::exists(oldPath, errorCode))
+			std::filesystem::rename(oldPath, get_rotated_log_file_path(filePath, i), errorCode);
+	}
+}
+
+LoggerInstance* Logger::get_local_instance()
+{
+	static LoggerInstance loggerInstance(LogBackendMode::SYNC);
+	return &loggerInstance;
+}
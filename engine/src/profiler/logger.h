@@ -1,52 +1,75 @@
 #pragma once
 
-#include <string_view>
-#include <fmt_lib/fmt/os.h>
+#include "core/common.h"
+#include "core/non_copyable_non_movable.h"
 #include <fmt_lib/fmt/core.h>
-#include <fmt_lib/fmt/color.h>
+#include <fmt_lib/fmt/format.h>
+#include <atomic>
 #include <chrono>
-#include <fmt_lib/fmt/chrono.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
-#define LOG_FATAL_ENABLED 1
-#define LOG_ERROR_ENABLED 1
-#define LOG_WARNING_ENABLED 1
-#define LOG_INFO_ENABLED 1
-#define LOG_INFO_SUCCESS 1
+// Messages with lower severity than LOG_SEVERITY_LEVEL are removed by the preprocessor, their arguments are not evaluated
+#define LOG_SEVERITY_NONE 0
+#define LOG_SEVERITY_FATAL 1
+#define LOG_SEVERITY_ERROR 2
+#define LOG_SEVERITY_WARNING 3
+#define LOG_SEVERITY_INFO 4
+#define LOG_SEVERITY_SUCCESS 5
 
+#ifndef LOG_SEVERITY_LEVEL
 #ifdef VK_RELEASE
-#define LOG_FATAL_ENABLED 0
-#define LOG_ERROR_ENABLED 0
-#define LOG_WARNING_ENABLED 0
-#define LOG_INFO_ENABLED 0
-#define LOG_INFO_SUCCESS 0
+#define LOG_SEVERITY_LEVEL LOG_SEVERITY_NONE
+#else
+#define LOG_SEVERITY_LEVEL LOG_SEVERITY_SUCCESS
 #endif
+#endif
+
+#define LOG_FATAL_ENABLED (LOG_SEVERITY_LEVEL >= LOG_SEVERITY_FATAL)
+#define LOG_ERROR_ENABLED (LOG_SEVERITY_LEVEL >= LOG_SEVERITY_ERROR)
+#define LOG_WARNING_ENABLED (LOG_SEVERITY_LEVEL >= LOG_SEVERITY_WARNING)
+#define LOG_INFO_ENABLED (LOG_SEVERITY_LEVEL >= LOG_SEVERITY_INFO)
+#define LOG_INFO_SUCCESS (LOG_SEVERITY_LEVEL >= LOG_SEVERITY_SUCCESS)
 
 #if LOG_FATAL_ENABLED == 1
-#define LOG_FATAL(message,...) Logger::get_logger().log(LogType::FATAL, message, ##__VA_ARGS__);
+#define LOG_FATAL(message,...) Logger::log(LogType::FATAL, message, ##__VA_ARGS__);
 #else
 #define LOG_FATAL(message,...)
 #endif
 
 #if LOG_ERROR_ENABLED == 1
-#define LOG_ERROR(message,...) Logger::get_logger().log(LogType::ERROR_TYPE, message, ##__VA_ARGS__);
+#define LOG_ERROR(message,...) Logger::log(LogType::ERROR_TYPE, message, ##__VA_ARGS__);
 #else
 #define LOG_ERROR(message,...)
 #endif
 
 #if LOG_WARNING_ENABLED == 1
-#define LOG_WARNING(message,...) Logger::get_logger().log(LogType::WARNING, message, ##__VA_ARGS__);
+#define LOG_WARNING(message,...) Logger::log(LogType::WARNING, message, ##__VA_ARGS__);
 #else
 #define LOG_WARNING(message,...)
 #endif
 
 #if LOG_INFO_ENABLED == 1
-#define LOG_INFO(message,...) Logger::get_logger().log(LogType::INFO, message, ##__VA_ARGS__);
+#define LOG_INFO(message,...) Logger::log(LogType::INFO, message, ##__VA_ARGS__);
 #else
 #define LOG_INFO(message,...)
 #endif
 
 #if LOG_INFO_SUCCESS == 1
-#define LOG_SUCCESS(message,...) Logger::get_logger().log(LogType::SUCCESS, message, ##__VA_ARGS__);
+#define LOG_SUCCESS(message,...) Logger::log(LogType::SUCCESS, message, ##__VA_ARGS__);
 #else
 #define LOG_SUCCESS(message,...)
 #endif
@@ -60,58 +83,425 @@ enum class LogType
 	SUCCESS
 };
 
-class Logger
+namespace ad_astris::profiler
 {
-	public:
-		template <typename... Args>
-		static void print(std::string_view message, Args... args)
+	constexpr uint32_t LOG_QUEUE_DEFAULT_CAPACITY = 256 * 1024;
+	constexpr uint32_t LOG_RECORD_ALIGNMENT = 16;
+	constexpr uint64_t LOG_FILE_DEFAULT_MAX_SIZE = 16 * 1024 * 1024;
+	constexpr uint32_t LOG_FILE_DEFAULT_MAX_COUNT = 5;
+
+	FORCE_INLINE constexpr size_t align_log_offset(size_t offset, size_t alignment)
+	{
+		return (offset + alignment - 1) & ~(alignment - 1);
+	}
+
+	// Formats the record into outMessage and destroys copied arguments
+	using LogFormatFunction = void(*)(std::byte* record, fmt::memory_buffer& outMessage);
+
+	// Record layout: header, format string, arguments. The format string is copied, so it may be a temporary string
+	struct LogRecordHeader
+	{
+		uint32_t size;							// Aligned size of the whole record
+		uint32_t formatLength;
+		LogFormatFunction formatFunction;		// nullptr if the record is padding at the end of the queue
+		uint64_t timeNs;
+		LogType type;
+	};
+
+	// Arguments are copied into the record and formatted later by the backend
+	template<typename T>
+	struct LogArgument
+	{
+		static_assert(alignof(T) <= LOG_RECORD_ALIGNMENT, "LogArgument: Argument alignment is too large");
+
+		using DecodedType = const T&;
+
+		static size_t get_size(size_t offset, const T&)
 		{
-			fmt::print((message), args...);
-			fmt::print("\n");
+			return align_log_offset(offset, alignof(T)) + sizeof(T);
 		}
 
-		template <typename... Args>
-		static void log(LogType logType, std::string_view message, Args... args)
-		{
-			print_time();
-
-			switch (logType)
-			{
-				case(LogType::FATAL):
-					fmt::print(fg(fmt::color::dark_red) | fmt::emphasis::bold, "[FATAL]:   ");
-					break;
-				case(LogType::ERROR_TYPE):
-					fmt::print(fg(fmt::color::red) | fmt::emphasis::bold, "[ERROR]:   ");
-					break;
-				case(LogType::WARNING):
-					fmt::print(fg(fmt::color::dark_violet) | fmt::emphasis::bold, "[WARNING]: ");
-					break;
-				case(LogType::INFO):
-					fmt::print(fg(fmt::color::royal_blue) | fmt::emphasis::bold, "[INFO]:    ");
-					break;
-				case(LogType::SUCCESS):
-					fmt::print(fg(fmt::color::lime_green) | fmt::emphasis::bold, "[SUCCESS]: ");
-					break;
+		static void encode(std::byte* record, size_t& offset, const T& value)
+		{
+			offset = align_log_offset(offset, alignof(T));
+			new (record + offset) T(value);
+			offset += sizeof(T);
+		}
+
+		static const T& decode(std::byte* record, size_t& offset)
+		{
+			offset = align_log_offset(offset, alignof(T));
+			const T* value = std::launder(reinterpret_cast<T*>(record + offset));
+			offset += sizeof(T);
+			return *value;
+		}
+
+		static void destroy(std::byte* record, size_t& offset)
+		{
+			offset = align_log_offset(offset, alignof(T));
+			if constexpr (!std::is_trivially_destructible_v<T>)
+				std::launder(reinterpret_cast<T*>(record + offset))->~T();
+			offset += sizeof(T);
+		}
+	};
+
+	// Pointers and views may be invalid when the backend formats the record, so characters are copied
+	struct LogStringArgument
+	{
+		using DecodedType = std::string_view;
+
+		static size_t get_size(size_t offset, std::string_view str)
+		{
+			return align_log_offset(offset, alignof(uint32_t)) + sizeof(uint32_t) + str.size();
+		}
+
+		static void encode(std::byte* record, size_t& offset, std::string_view str)
+		{
+			offset = align_log_offset(offset, alignof(uint32_t));
+			uint32_t length = static_cast<uint32_t>(str.size());
+			memcpy(record + offset, &length, sizeof(uint32_t));
+			memcpy(record + offset + sizeof(uint32_t), str.data(), length);
+			offset += sizeof(uint32_t) + length;
+		}
+
+		static std::string_view decode(std::byte* record, size_t& offset)
+		{
+			offset = align_log_offset(offset, alignof(uint32_t));
+			uint32_t length;
+			memcpy(&length, record + offset, sizeof(uint32_t));
+			std::string_view str(reinterpret_cast<const char*>(record + offset + sizeof(uint32_t)), length);
+			offset += sizeof(uint32_t) + length;
+			return str;
+		}
+
+		static void destroy(std::byte* record, size_t& offset)
+		{
+			decode(record, offset);
+		}
+	};
+
+	struct LogCStringArgument : LogStringArgument
+	{
+		static std::string_view to_string_view(const char* str)
+		{
+			return str ? std::string_view(str) : std::string_view();
+		}
+
+		static size_t get_size(size_t offset, const char* str)
+		{
+			return LogStringArgument::get_size(offset, to_string_view(str));
+		}
+
+		static void encode(std::byte* record, size_t& offset, const char* str)
+		{
+			LogStringArgument::encode(record, offset, to_string_view(str));
+		}
+	};
+
+	template<> struct LogArgument<const char*> : LogCStringArgument { };
+	template<> struct LogArgument<char*> : LogCStringArgument { };
+	template<> struct LogArgument<std::string> : LogStringArgument { };
+	template<> struct LogArgument<std::string_view> : LogStringArgument { };
+
+	// Message that doesn't fit the queue, formatted by the producer
+	struct LogHeapMessage
+	{
+		std::string* message;
+	};
+
+	template<>
+	struct LogArgument<LogHeapMessage>
+	{
+		using DecodedType = std::string_view;
+
+		static size_t get_size(size_t offset, const LogHeapMessage&)
+		{
+			return LogArgument<std::string*>::get_size(offset, nullptr);
+		}
+
+		static void encode(std::byte* record, size_t& offset, const LogHeapMessage& message)
+		{
+			LogArgument<std::string*>::encode(record, offset, message.message);
+		}
+
+		static std::string_view decode(std::byte* record, size_t& offset)
+		{
+			return *LogArgument<std::string*>::decode(record, offset);
+		}
+
+		static void destroy(std::byte* record, size_t& offset)
+		{
+			delete LogArgument<std::string*>::decode(record, offset);
+		}
+	};
+
+	template<typename... Args>
+	void format_log_record(std::byte* record, fmt::memory_buffer& outMessage)
+	{
+		const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(record);
+		std::string_view format(reinterpret_cast<const char*>(record + sizeof(LogRecordHeader)), header->formatLength);
+		size_t argsOffset = sizeof(LogRecordHeader) + header->formatLength;
+
+		// Braced initialization decodes arguments from left to right
+		[[maybe_unused]] size_t offset = argsOffset;
+		std::tuple<typename LogArgument<Args>::DecodedType...> args{ LogArgument<Args>::decode(record, offset)... };
+		try
+		{
+			std::apply([&](const auto&... decodedArgs)
+			{
+				fmt::vformat_to(fmt::appender(outMessage), format, fmt::make_format_args(decodedArgs...));
+			}, args);
+		}
+		catch (const fmt::format_error& error)
+		{
+			fmt::format_to(fmt::appender(outMessage), "Failed to format \"{}\": {}", format, error.what());
+		}
+
+		offset = argsOffset;
+		(LogArgument<Args>::destroy(record, offset), ...);
+	}
+
+	// Single producer single consumer ring of variable-size records. Positions grow monotonically, the record that
+	// doesn't fit before the end of the buffer is preceded by a padding record
+	class LogRecordQueue
+	{
+		public:
+			LogRecordQueue(uint32_t capacity);
+
+			// Producer. Returns nullptr if the queue doesn't have enough free space
+			std::byte* try_reserve(uint32_t size);
+
+			void commit(uint32_t size)
+			{
+				_writePosition.store(_writePosition.load(std::memory_order_relaxed) + size, std::memory_order_release);
 			}
 
-			print(message, args...);
+			// Consumer. Returns nullptr if position has reached endPosition, skips padding
+			std::byte* get_record(uint64_t& position, uint64_t endPosition);
 
-			if (logType == LogType::FATAL)
-				abort();
+			uint64_t get_read_position() const
+			{
+				return _readPosition.load(std::memory_order_relaxed);
+			}
+
+			uint64_t get_write_position() const
+			{
+				return _writePosition.load(std::memory_order_acquire);
+			}
+
+			void release(uint64_t position)
+			{
+				_readPosition.store(position, std::memory_order_release);
+			}
+
+			uint32_t get_capacity() const
+			{
+				return _capacity;
+			}
+
+			// Called when the producer thread exits, the queue is freed after its remaining records are written
+			void set_producer_exited()
+			{
+				_isProducerExited.store(true, std::memory_order_release);
+			}
+
+			bool is_producer_exited() const
+			{
+				return _isProducerExited.load(std::memory_order_acquire);
+			}
+
+		private:
+			struct alignas(LOG_RECORD_ALIGNMENT) Block
+			{
+				std::byte bytes[LOG_RECORD_ALIGNMENT];
+			};
+
+			std::unique_ptr<Block[]> _blocks;
+			uint32_t _capacity{ 0 };
+			alignas(64) std::atomic<uint64_t> _writePosition{ 0 };
+			uint64_t _cachedReadPosition{ 0 };
+			alignas(64) std::atomic<uint64_t> _readPosition{ 0 };
+			std::atomic<bool> _isProducerExited{ false };
+
+			std::byte* get_data(uint64_t position)
+			{
+				return _blocks[0].bytes + (position & (_capacity - 1));
+			}
+	};
+
+	struct LogFileSettings
+	{
+		std::string filePath;
+		// The file is rotated when its size reaches maxFileSize. Previous files are renamed to name.1.ext, name.2.ext, ...
+		uint64_t maxFileSize{ LOG_FILE_DEFAULT_MAX_SIZE };
+		uint32_t maxFileCount{ LOG_FILE_DEFAULT_MAX_COUNT };		// Including the current file
+	};
+
+	enum class LogBackendMode
+	{
+		ASYNC,			// Records are formatted and written by the backend thread
+		SYNC			// Records are formatted and written by the thread that has logged them
+	};
+
+	// Each thread writes records to its own LogRecordQueue without locks and without formatting. The backend thread
+	// merges queues by time, formats messages, writes them to the console and to the log file and flushes outputs.
+	// FATAL messages are flushed before abort()
+	class LoggerInstance : public NonCopyableNonMovable
+	{
+		public:
+			LoggerInstance(LogBackendMode backendMode = LogBackendMode::ASYNC, uint32_t queueCapacityPerThread = LOG_QUEUE_DEFAULT_CAPACITY);
+			~LoggerInstance();
+
+			template<typename... Args>
+			void log(LogType logType, std::string_view format, const Args&... args)
+			{
+				size_t size = sizeof(LogRecordHeader) + format.size();
+				((size = LogArgument<std::decay_t<Args>>::get_size(size, args)), ...);
+				size = align_log_offset(size, LOG_RECORD_ALIGNMENT);
+				if (size > _maxRecordSize)
+					log_heap_message(logType, format, fmt::make_format_args(args...));
+				else
+					write_record<std::decay_t<Args>...>(logType, format, static_cast<uint32_t>(size), args...);
+			}
+
+			// Blocks until all records that have been logged before the call are written
+			void flush();
+
+			// Returns false if the file can't be opened. The existing file is rotated, so the previous session log is kept
+			bool open_log_file(const LogFileSettings& settings);
+			void close_log_file();
+
+			void set_console_output(bool isEnabled)
+			{
+				_isConsoleOutputEnabled.store(isEnabled, std::memory_order_relaxed);
+			}
+
+			LogBackendMode get_backend_mode() const
+			{
+				return _backendMode;
+			}
+
+			// Queues of exited threads are not counted after they have been drained
+			uint32_t get_thread_queue_count();
+
+		private:
+			struct PendingRecord
+			{
+				std::byte* record;
+				uint64_t timeNs;
+			};
+
+			LogBackendMode _backendMode;
+			uint32_t _queueCapacityPerThread{ 0 };
+			uint32_t _maxRecordSize{ 0 };
+			uint64_t _id{ 0 };
+			std::chrono::steady_clock::time_point _startTime;
+
+			// Thread caches share queues, so a queue outlives the instance until its thread exits
+			std::vector<std::shared_ptr<LogRecordQueue>> _queues;
+			std::unordered_map<std::thread::id, LogRecordQueue*> _queuesByThreadID;
+			std::mutex _queuesMutex;
+
+			std::thread _backendThread;
+			std::mutex _backendMutex;
+			std::condition_variable _backendCondition;
+			std::condition_variable _flushCondition;
+			uint64_t _flushRequest{ 0 };
+			uint64_t _completedFlushRequest{ 0 };
+			bool _isBackendRunning{ false };
+
+			// Guards the consumer side of queues and outputs
+			std::mutex _outputMutex;
+			std::vector<LogRecordQueue*> _processedQueues;
+			std::vector<uint64_t> _processedPositions;
+			std::vector<PendingRecord> _pendingRecords;
+			fmt::memory_buffer _message;
+			fmt::memory_buffer _consoleBuffer;
+			fmt::memory_buffer _fileBuffer;
+			std::atomic<bool> _isConsoleOutputEnabled{ true };
+			LogFileSettings _fileSettings;
+			FILE* _file{ nullptr };
+			uint64_t _fileSize{ 0 };
+
+			uint64_t get_time_ns() const
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startTime).count();
+			}
+
+			template<typename... StoredArgs, typename... Args>
+			void write_record(LogType logType, std::string_view format, uint32_t size, const Args&... args)
+			{
+				LogRecordQueue& queue = get_thread_queue();
+				std::byte* record = reserve_record(queue, size);
+
+				LogRecordHeader* header = reinterpret_cast<LogRecordHeader*>(record);
+				header->size = size;
+				header->formatLength = static_cast<uint32_t>(format.size());
+				header->formatFunction = &format_log_record<StoredArgs...>;
+				header->timeNs = get_time_ns();
+				header->type = logType;
+				memcpy(record + sizeof(LogRecordHeader), format.data(), format.size());
+
+				[[maybe_unused]] size_t offset = sizeof(LogRecordHeader) + format.size();
+				(LogArgument<StoredArgs>::encode(record, offset, args), ...);
+
+				commit_record(queue, size);
+			}
+
+			LogRecordQueue& get_thread_queue();
+			std::shared_ptr<LogRecordQueue> register_thread();
+			std::byte* reserve_record(LogRecordQueue& queue, uint32_t size);
+			void commit_record(LogRecordQueue& queue, uint32_t size);
+			void log_heap_message(LogType logType, std::string_view format, fmt::format_args args);
+
+			void run_backend();
+			// Must be called with locked _outputMutex. Returns false if there were no records
+			bool process_records();
+			// Must be called with locked _outputMutex after records have been released
+			void remove_exited_queues();
+			void write_message(const LogRecordHeader& header);
+			void write_outputs();
+			bool open_file();
+			void rotate_log_files();
+	};
+}
+
+// LoggerInstance is owned by GlobalObjectContext, so all modules write to one backend. Tools, tests and modules
+// that log before GlobalObjects::set_global_object_context() use a module-local synchronous instance
+class Logger
+{
+	public:
+		static void init(ad_astris::profiler::LoggerInstance* loggerInstance)
+		{
+			if (_loggerInstance && _loggerInstance != loggerInstance)
+				_loggerInstance->flush();
+			_loggerInstance = loggerInstance;
 		}
 
-		static Logger& get_logger()
+		// The module-local instance is a function-local static, so its initialization is thread-safe
+		FORCE_INLINE static ad_astris::profiler::LoggerInstance* get_instance()
 		{
-			static Logger logger{};
-			return logger;
+			return _loggerInstance ? _loggerInstance : get_local_instance();
 		}
 
-		static void print_time()
+		template <typename... Args>
+		static void log(LogType logType, std::string_view message, const Args&... args)
 		{
-			std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
-			auto time_point = now - Logger::get_logger().start_time;
-			return fmt::print("[{:%M:%S}]", time_point);
+			get_instance()->log(logType, message, args...);
+			if (logType == LogType::FATAL)
+			{
+				get_instance()->flush();
+				abort();
+			}
 		}
 
-		std::chrono::time_point<std::chrono::system_clock> start_time;
+		static void flush()
+		{
+			get_instance()->flush();
+		}
+
+	private:
+		inline static ad_astris::profiler::LoggerInstance* _loggerInstance{ nullptr };
+
+		static ad_astris::profiler::LoggerInstance* get_local_instance();
 };
@@ -13,6 +13,12 @@ namespace ad_astris::profiler
 				_profilerInstance = profilerInstance;
 			}
 
+			// Detaches the instance, profiler calls do nothing until the next init()
+			static void reset()
+			{
+				_profilerInstance = nullptr;
+			}
+
 			static void set_enable(bool isEnabled)
 			{
 				if (_profilerInstance)
@@ -43,12 +49,13 @@ namespace ad_astris::profiler
 					_profilerInstance->end_frame();
 			}
 
-			[[nodiscard]] static RangeID begin_gpu_range(const std::string& rangeName, rhi::CommandBuffer& cmd)
+			// Pipeline statistics queries can't be nested, collect them only for ranges that don't overlap
+			[[nodiscard]] static RangeID begin_gpu_range(Name rangeName, rhi::CommandBuffer& cmd, bool collectPipelineStatistics = false)
 			{
 				if (_profilerInstance)
-					return _profilerInstance->begin_gpu_range(rangeName, cmd);
+					return _profilerInstance->begin_gpu_range(rangeName, cmd, collectPipelineStatistics);
 
-				return 0;
+				return INVALID_RANGE_ID;
 			}
 
 			static void end_gpu_range(RangeID rangeID)
@@ -57,30 +64,33 @@ namespace ad_astris::profiler
 					_profilerInstance->end_gpu_range(rangeID);
 			}
 
-			[[nodiscard]] static RangeID begin_cpu_range(const std::string& rangeName)
+			// Scopes are recorded per thread without locks. Scope names should be created once, not every frame.
+			// Returns false if the scope has not begun because the profiler is disabled
+			static bool begin_cpu_scope(
+				Name scopeName,
+				ScopeCategory category = ScopeCategory::GENERAL,
+				uint32_t color = SCOPE_COLOR_DEFAULT)
 			{
-				if (_profilerInstance)
-					return _profilerInstance->begin_cpu_range(rangeName);
-
-				return 0;
+				return _profilerInstance && _profilerInstance->begin_cpu_scope(scopeName, category, color);
 			}
 
-			static void end_cpu_range(RangeID rangeID)
+			static void end_cpu_scope()
 			{
 				if (_profilerInstance)
-					_profilerInstance->end_cpu_range(rangeID);
+					_profilerInstance->end_cpu_scope();
 			}
 
-			static void start_collecting_pipeline_statistics(const std::string& pipelineName, rhi::CommandBuffer& cmd)
+			static void set_thread_name(const std::string& threadName)
 			{
 				if (_profilerInstance)
-					_profilerInstance->start_collecting_pipeline_statistics(pipelineName, cmd);
+					_profilerInstance->set_thread_name(threadName);
 			}
 
-			static void finish_collecting_pipeline_statistics()
+			// Frames of the last traceCaptureDuration seconds are always captured, the trace can be dumped at any moment
+			static void set_trace_capture_duration(double captureDuration)
 			{
 				if (_profilerInstance)
-					_profilerInstance->finish_collecting_pipeline_statistics();
+					_profilerInstance->set_trace_capture_duration(captureDuration);
 			}
 
 			static void set_frame_name(FrameID frameID, const FrameName& frameName)
@@ -104,4 +114,57 @@ namespace ad_astris::profiler
 		private:
 			inline static ProfilerInstance* _profilerInstance{ nullptr };
 	};
-}
\ No newline at end of file
+
+	// The scope is ended only if it has begun, so the profiler can be enabled or disabled inside the scope
+	class ScopedCPURange
+	{
+		public:
+			ScopedCPURange(Name scopeName) : _isActive(Profiler::begin_cpu_scope(scopeName))
+			{
+
+			}
+
+			ScopedCPURange(const ScopeDescriptor& descriptor)
+				: _isActive(Profiler::begin_cpu_scope(descriptor.name, descriptor.category, descriptor.color))
+			{
+
+			}
+
+			~ScopedCPURange()
+			{
+				if (_isActive)
+					Profiler::end_cpu_scope();
+			}
+
+			ScopedCPURange(const ScopedCPURange&) = delete;
+			ScopedCPURange& operator=(const ScopedCPURange&) = delete;
+
+		private:
+			bool _isActive{ false };
+	};
+}
+
+// Set PROFILER_ENABLED to 0 to compile all PROFILER_SCOPE macros to nothing
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#if PROFILER_ENABLED == 1
+// Name must be a string literal. The descriptor is created once per call site, so when the profiler is disabled
+// at runtime the scope costs a guard check of the static variable and a flag check
+#define PROFILER_SCOPE_COLORED(name, category, color) \
+	static const ::ad_astris::profiler::ScopeDescriptor PROFILER_CONCAT(profilerScopeDescriptor, __LINE__)( \
+		name, \
+		std::integral_constant<uint64_t, ::ad_astris::compile_time_fnv1(name)>::value, \
+		category, \
+		color); \
+	::ad_astris::profiler::ScopedCPURange PROFILER_CONCAT(profilerScope, __LINE__)(PROFILER_CONCAT(profilerScopeDescriptor, __LINE__))
+#else
+#define PROFILER_SCOPE_COLORED(name, category, color)
+#endif
+
+#define PROFILER_SCOPE_CATEGORY(name, category) PROFILER_SCOPE_COLORED(name, category, ::ad_astris::profiler::SCOPE_COLOR_DEFAULT)
+#define PROFILER_SCOPE(name) PROFILER_SCOPE_CATEGORY(name, ::ad_astris::profiler::ScopeCategory::GENERAL)
\ No newline at end of file
@@ -9,6 +9,9 @@ ProfilerInstance::ProfilerInstance(ProfilerInstanceInitContext& initContext)
 {
 	_isEnabled = initContext.isEnabled;
 	_frameStatsManager = std::make_unique<FrameStatsManager>(initContext.frameStatsHistoryCapacity);
+	_traceCapture.set_capture_duration(initContext.traceCaptureDuration);
+	_cpuFrameScopeName = "CPU Frame";
+	_gpuFrameRangeName = "GPU range";
 
 	if (!_isEnabled)
 		return;
@@ -16,7 +19,6 @@ ProfilerInstance::ProfilerInstance(ProfilerInstanceInitContext& initContext)
 
 ProfilerInstance::~ProfilerInstance()
 {
-	_cpuRangePool.cleanup();
 	_gpuRangePool.cleanup();
 }
 
@@ -26,50 +28,105 @@ void ProfilerInstance::begin_cpu_frame()
 		return;
 
 	if (!_isInitialized)
+	{
 		init();
+		_cpuEventRecorder.set_thread_name("Main thread");
+	}
 
-	_cpuFrame = begin_cpu_range("CPU Frame");
+	begin_cpu_scope(_cpuFrameScopeName);
 	_activeFrameStats = _frameStatsManager->allocate_frame_stats(_currentFrameID);
+	_isFrameEnabled = true;
 }
 
 void ProfilerInstance::begin_gpu_frame()
 {
-	if (!_isEnabled)
+	// Resolved ranges are added to stats in end_frame(), so the GPU frame is recorded only inside a profiled CPU frame
+	if (!_isEnabled || !_isFrameEnabled)
 		return;
 
 	if (!_isInitialized)
 		init();
 
+	uint32_t bufferIndex = get_current_buffer_index();
+	resolve_gpu_ranges(bufferIndex);
+	_pendingGPUFrameIDs[bufferIndex] = _currentFrameID;
+	_firstBufferQuery = bufferIndex * RANGE_COUNT;
+
 	_rhi->begin_command_buffer(&_profilerCmd);
-	_rhi->reset_query(&_profilerCmd, &_timestampQueryPool, 0, _timestampQueryPool.info.queryCount);
-	//_rhi->reset_query(&_profilerCmd, &_pipelineStatisticsQueryPool, 0, _pipelineStatisticsQueryPool.info.queryCount);
-	_gpuFrame = begin_gpu_range("GPU range", _profilerCmd);
+	_rhi->reset_query(&_profilerCmd, &_timestampQueryPool, _firstBufferQuery, RANGE_COUNT);
+	_rhi->reset_query(&_profilerCmd, &_pipelineStatisticsQueryPool, _firstBufferQuery, RANGE_COUNT);
+	_gpuFrame = begin_gpu_range(_gpuFrameRangeName, _profilerCmd);
 }
 
 void ProfilerInstance::end_gpu_frame()
 {
-	if (!_isEnabled)
+	// Doesn't check _isEnabled, the GPU frame must be ended if it has begun
+	if (_gpuFrame == INVALID_RANGE_ID)
 		return;
-	
+
+	std::scoped_lock<std::mutex> locker(_gpuRangeMutex);
 	GPURange* gpuFrameRange = _activeGPURanges[_gpuFrame];
-	gpuFrameRange->endTimeQueryIndex = _nextTimestampQuery.fetch_add(1);
 	GPURange* lastGpuRange = _activeGPURanges.back();
+	gpuFrameRange->isFinished = true;
 	_rhi->end_query(&lastGpuRange->cmd, &_timestampQueryPool, gpuFrameRange->endTimeQueryIndex);
-	const rhi::Buffer& buffer = get_current_result_buffer();
-	_rhi->copy_query_pool_results(&lastGpuRange->cmd, &_timestampQueryPool, 0, _nextTimestampQuery.load(), sizeof(uint64_t), &buffer);
+
+	uint32_t bufferIndex = get_current_buffer_index();
+	_rhi->copy_query_pool_results(
+		&lastGpuRange->cmd,
+		&_timestampQueryPool,
+		_firstBufferQuery,
+		_nextTimestampQuery.load(),
+		sizeof(uint64_t),
+		&_queryResultBuffers[bufferIndex]);
+	uint32_t pipelineStatisticsQueryCount = _nextPipelineStatisticsQuery.load();
+	if (pipelineStatisticsQueryCount)
+	{
+		_rhi->copy_query_pool_results(
+			&lastGpuRange->cmd,
+			&_pipelineStatisticsQueryPool,
+			_firstBufferQuery,
+			pipelineStatisticsQueryCount,
+			sizeof(rhi::PipelineStatistics),
+			&_pipelineStatisticsResultBuffers[bufferIndex]);
+	}
+
+	_pendingGPURanges[bufferIndex].swap(_activeGPURanges);
+	_activeGPURanges.clear();
+	_nextTimestampQuery.store(0);
+	_nextPipelineStatisticsQuery.store(0);
+	_gpuFrame = INVALID_RANGE_ID;
+	++_gpuFrameCount;
 }
 
-RangeID ProfilerInstance::begin_gpu_range(const std::string& rangeName, const rhi::CommandBuffer& cmd)
+RangeID ProfilerInstance::begin_gpu_range(Name rangeName, const rhi::CommandBuffer& cmd, bool collectPipelineStatistics)
 {
 	if (!_isEnabled)
-		return 0;
+		return INVALID_RANGE_ID;
 
 	std::scoped_lock<std::mutex> locker(_gpuRangeMutex);
+	// Both timestamp queries are reserved when the range begins, so ending a range can't run out of queries
+	if (_nextTimestampQuery.load() + 2 > RANGE_COUNT)
+	{
+		LOG_WARNING("ProfilerInstance::begin_gpu_range(): Can't begin GPU range {}, all timestamp queries of the frame are used", rangeName.c_str())
+		return INVALID_RANGE_ID;
+	}
+	if (collectPipelineStatistics && _nextPipelineStatisticsQuery.load() == RANGE_COUNT)
+	{
+		LOG_WARNING("ProfilerInstance::begin_gpu_range(): Can't collect pipeline statistics for GPU range {}, all queries of the frame are used", rangeName.c_str())
+		collectPipelineStatistics = false;
+	}
+
 	GPURange* range = _gpuRangePool.allocate();
 	range->name = rangeName;
 	range->cmd = cmd;
-	range->beginTimeQueryIndex = _nextTimestampQuery.fetch_add(1);
+	range->beginTimeQueryIndex = _firstBufferQuery + _nextTimestampQuery.fetch_add(2);
+	range->endTimeQueryIndex = range->beginTimeQueryIndex + 1;
 	_rhi->end_query(&cmd, &_timestampQueryPool, range->beginTimeQueryIndex);
+	if (collectPipelineStatistics)
+	{
+		range->pipelineStatisticsQueryIndex = _firstBufferQuery + _nextPipelineStatisticsQuery.fetch_add(1);
+		_rhi->begin_query(&cmd, &_pipelineStatisticsQueryPool, range->pipelineStatisticsQueryIndex);
+	}
 
 	RangeID rangeID = _activeGPURanges.size();
 	_activeGPURanges.push_back(range);
@@ -79,41 +136,54 @@ RangeID ProfilerInstance::begin_gpu_range(const std::string& rangeName, const rh
 
 void ProfilerInstance::end_frame()
 {
-	if (!_isEnabled)
+	// The frame is ended if it has begun even if the profiler has been disabled inside it, and isn't if the profiler
+	// has been enabled inside it
+	if (!_isFrameEnabled)
 		return;
+	_isFrameEnabled = false;
 
 	_activeFrameStats->calculate_memory_usage(_rhi);
+	if (_frameScratchAllocator)
+		_activeFrameStats->set_frame_scratch_usage(_frameScratchAllocator->get_usage());
+	if (_resourceResidencyProvider)
+		_resourceResidencyProvider->get_residency_usage(_activeFrameStats->get_resource_residency_usage());
 	
-	end_cpu_range(_cpuFrame);
-	_activeCPURanges.clear();
+	end_cpu_scope();
+	CapturedFrame& capturedFrame = _traceCapture.add_frame();
+	CPUTimeline& cpuTimeline = capturedFrame.cpuTimeline;
+	_cpuEventRecorder.end_frame(cpuTimeline);
+	cpuTimeline.frameID = _currentFrameID;
+	for (auto& event : cpuTimeline.events)
+		_activeFrameStats->add_cpu_timing(event.name, event.get_duration_ms());
 
 	++_currentFrameID;
-	
-	const uint64_t* queryResults = (const uint64_t*)get_current_result_buffer().mappedData;
-	double timestampFrequence = (double)_rhi->get_timestamp_frequency() / 1000.0;
-	
-	for (auto& range : _activeGPURanges)
+
+	// GPU ranges were resolved in begin_gpu_frame() of this frame but belong to the frame that used the same buffer.
+	// Its CPU timeline is used to place GPU events, they are dropped if the frame has been evicted
+	if (!_resolvedGPUEvents.empty())
+	{
+		if (CapturedFrame* gpuFrame = _traceCapture.get_frame(_resolvedGPUFrameID))
+			gpuFrame->gpuEvents.assign(_resolvedGPUEvents.begin(), _resolvedGPUEvents.end());
+	}
+	for (auto& range : _resolvedGPURanges)
 	{
-		const uint64_t beginTime = queryResults[range->beginTimeQueryIndex];
-		const uint64_t endTime = queryResults[range->endTimeQueryIndex];
-		range->time = (float)abs((double)(endTime - beginTime) / timestampFrequence);
 		_activeFrameStats->add_range(range);
 		_gpuRangePool.free(range);
 	}
+	_resolvedGPURanges.clear();
+	_resolvedGPUEvents.clear();
 
-	_activeGPURanges.clear();
-	
-	_nextTimestampQuery.store(0);
-	_nextPipelineStatisticsQuery.store(0);
+	_frameStatsManager->update_range_statistics(*_activeFrameStats);
 }
 
 void ProfilerInstance::end_gpu_range(RangeID rangeID)
 {
-	if (!_isEnabled)
+	// Doesn't check _isEnabled, the range must be ended even if the profiler has been disabled inside it
+	if (rangeID == INVALID_RANGE_ID)
 		return;
 
 	std::scoped_lock<std::mutex> locker(_gpuRangeMutex);
-	if (rangeID > _activeGPURanges.size())
+	if (rangeID >= _activeGPURanges.size())
 	{
 		LOG_ERROR("ProfilerInstance::end_gpu_range(): Invalid gpu range id {}", rangeID)
 		return;
@@ -122,65 +192,20 @@ void ProfilerInstance::end_gpu_range(RangeID rangeID)
 	GPURange* range = _activeGPURanges[rangeID];
 	if (range->isFinished)
 	{
-		LOG_ERROR("ProfilerInstance::end_gpu_range(): GPU range {} has been already finished", range->name)
+		LOG_ERROR("ProfilerInstance::end_gpu_range(): GPU range {} has been already finished", range->name.c_str())
 		return;
 	}
 
-	range->endTimeQueryIndex = _nextTimestampQuery.fetch_add(1);
+	if (range->pipelineStatisticsQueryIndex >= 0)
+		_rhi->end_query(&range->cmd, &_pipelineStatisticsQueryPool, range->pipelineStatisticsQueryIndex);
 	_rhi->end_query(&range->cmd, &_timestampQueryPool, range->endTimeQueryIndex);
-}
-
-RangeID ProfilerInstance::begin_cpu_range(const std::string& rangeName)
-{
-	if (!_isEnabled)
-		return 0;
-
-	std::scoped_lock<std::mutex> locker(_cpuRangeMutex);
-	CPURange* range = _cpuRangePool.allocate();
-	range->name = rangeName;
-	range->timer.record();
-	
-	RangeID rangeID = _activeCPURanges.size();
-	_activeCPURanges.push_back(range);
-	return rangeID;
-}
-
-void ProfilerInstance::end_cpu_range(RangeID rangeID)
-{
-	if (!_isEnabled)
-		return;
-
-	if (rangeID > _activeCPURanges.size())
-	{
-		LOG_ERROR("ProfilerInstance::end_cpu_range(): Invalid cpu range id {}", rangeID)
-		return;
-	}
-
-	CPURange* range = _activeCPURanges[rangeID];
-	if (range->isFinished)
-	{
-		LOG_ERROR("ProfilerInstance::end_cpu_range(): CPU range {} has been already finished", range->name)
-		return;
-	}
-
-	range->time = range->timer.elapsed_milliseconds();
 	range->isFinished = true;
-
-	std::scoped_lock<std::mutex> locker(_cpuRangeMutex);
-	_activeFrameStats->add_range(range);
-	_cpuRangePool.free(range);
-}
-
-void ProfilerInstance::start_collecting_pipeline_statistics(const std::string& pipelineName, const rhi::CommandBuffer& cmd)
-{
-	if (!_isEnabled)
-		return;
 }
 
-void ProfilerInstance::finish_collecting_pipeline_statistics()
+const CPUTimeline* ProfilerInstance::get_cpu_timeline(FrameID frameID) const
 {
-	if (!_isEnabled)
-		return;
+	const CapturedFrame* capturedFrame = _traceCapture.get_frame(frameID);
+	return capturedFrame ? &capturedFrame->cpuTimeline : nullptr;
 }
 
 void ProfilerInstance::init()
@@ -188,18 +213,19 @@ void ProfilerInstance::init()
 	if (_isInitialized)
 		return;
 	
+	uint32_t bufferCount = _rhi->get_buffer_count();
 	_timestampQueryPool.info.type = rhi::QueryType::TIMESTAMP;
-	_timestampQueryPool.info.queryCount = RANGE_COUNT;
+	_timestampQueryPool.info.queryCount = RANGE_COUNT * bufferCount;
 	_rhi->create_query_pool(&_timestampQueryPool);
 
 	_pipelineStatisticsQueryPool.info.type = rhi::QueryType::PIPELINE_STATISTICS;
-	_pipelineStatisticsQueryPool.info.queryCount = RANGE_COUNT;
+	_pipelineStatisticsQueryPool.info.queryCount = RANGE_COUNT * bufferCount;
 	_rhi->create_query_pool(&_pipelineStatisticsQueryPool);
 
-	_cpuRangePool.allocate_new_pool(RANGE_COUNT);
-	_gpuRangePool.allocate_new_pool(RANGE_COUNT);
+	_gpuRangePool.allocate_new_pool(RANGE_COUNT * bufferCount);
+	_pendingGPURanges.resize(bufferCount);
+	_pendingGPUFrameIDs.resize(bufferCount);
 
-	uint32_t bufferCount = _rhi->get_buffer_count();
 	for (auto i = 0; i != bufferCount; ++i)
 	{
 		rhi::Buffer& buffer = _queryResultBuffers.emplace_back();
@@ -207,12 +233,65 @@ void ProfilerInstance::init()
 		buffer.bufferInfo.bufferUsage = rhi::ResourceUsage::TRANSFER_DST;
 		buffer.bufferInfo.memoryUsage = rhi::MemoryUsage::CPU;
 		_rhi->create_buffer(&buffer);
+
+		rhi::Buffer& pipelineStatisticsBuffer = _pipelineStatisticsResultBuffers.emplace_back();
+		pipelineStatisticsBuffer.bufferInfo.size = sizeof(rhi::PipelineStatistics) * RANGE_COUNT;
+		pipelineStatisticsBuffer.bufferInfo.bufferUsage = rhi::ResourceUsage::TRANSFER_DST;
+		pipelineStatisticsBuffer.bufferInfo.memoryUsage = rhi::MemoryUsage::CPU;
+		_rhi->create_buffer(&pipelineStatisticsBuffer);
 	}
 
 	_isInitialized = true;
 }
 
-const rhi::Buffer& ProfilerInstance::get_current_result_buffer()
+uint64_t ProfilerInstance::get_gpu_time_ns(uint64_t timestamp, uint64_t gpuFrameBeginTimestamp)
+{
+	if (timestamp < gpuFrameBeginTimestamp)
+		return 0;
+	return (uint64_t)((double)(timestamp - gpuFrameBeginTimestamp) * 1000000000.0 / (double)_rhi->get_timestamp_frequency());
+}
+
+void ProfilerInstance::resolve_gpu_ranges(uint32_t bufferIndex)
+{
+	std::vector<GPURange*>& ranges = _pendingGPURanges[bufferIndex];
+	if (ranges.empty())
+		return;
+	_resolvedGPUFrameID = _pendingGPUFrameIDs[bufferIndex];
+
+	// Results were copied at the end of the frame, buffers contain only queries of this buffer
+	const uint64_t* timestamps = (const uint64_t*)_queryResultBuffers[bufferIndex].mappedData;
+	const rhi::PipelineStatistics* pipelineStatistics = (const rhi::PipelineStatistics*)_pipelineStatisticsResultBuffers[bufferIndex].mappedData;
+	uint32_t firstQuery = bufferIndex * RANGE_COUNT;
+	double timestampFrequency = (double)_rhi->get_timestamp_frequency() / 1000.0;
+	// The GPU frame range is always begun first
+	uint64_t gpuFrameBeginTime = timestamps[ranges.front()->beginTimeQueryIndex - firstQuery];
+
+	for (auto& range : ranges)
+	{
+		if (!range->isFinished)
+		{
+			LOG_WARNING("ProfilerInstance::resolve_gpu_ranges(): GPU range {} has not been finished", range->name.c_str())
+			_gpuRangePool.free(range);
+			continue;
+		}
+
+		const uint64_t beginTime = timestamps[range->beginTimeQueryIndex - firstQuery];
+		const uint64_t endTime = timestamps[range->endTimeQueryIndex - firstQuery];
+		range->time = (float)abs((double)(endTime - beginTime) / timestampFrequency);
+		if (range->pipelineStatisticsQueryIndex >= 0)
+			range->pipelineStatistics = pipelineStatistics[range->pipelineStatisticsQueryIndex - firstQuery];
+
+		GPUTimelineEvent& gpuEvent = _resolvedGPUEvents.emplace_back();
+		gpuEvent.name = range->name;
+		gpuEvent.beginNs = get_gpu_time_ns(beginTime, gpuFrameBeginTime);
+		gpuEvent.endNs = get_gpu_time_ns(endTime, gpuFrameBeginTime);
+
+		_resolvedGPURanges.push_back(range);
+	}
+	ranges.clear();
+}
+
+uint32_t ProfilerInstance::get_current_buffer_index() const
 {
-	return _queryResultBuffers[_currentFrameID % _rhi->get_buffer_count()];
+	return _gpuFrameCount % _rhi->get_buffer_count();
 }
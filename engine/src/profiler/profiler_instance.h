@@ -1,7 +1,10 @@
 ﻿#pragma once
 
 #include "frame_stats_manager.h"
+#include "cpu_event_recorder.h"
+#include "trace_capture.h"
 #include "core/pool_allocator.h"
+#include "core/frame_scratch_allocator.h"
 #include "file_system/file_system.h"
 #include "rhi/engine_rhi.h"
 
@@ -13,6 +16,7 @@ namespace ad_astris::profiler
 	{
 		bool isEnabled{ true };
 		uint64_t frameStatsHistoryCapacity{ FRAME_STATS_HISTORY_CAPACITY };
+		double traceCaptureDuration{ DEFAULT_TRACE_CAPTURE_DURATION };		// Seconds
 	};
 	
 	class ProfilerInstance
@@ -22,50 +26,105 @@ namespace ad_astris::profiler
 			~ProfilerInstance();
 
 			void begin_cpu_frame();
+			// Must be called after the fence of the current buffer has been waited. Query results of the frame that
+			// used the same buffer are read back here, so GPU timings are added to frame stats bufferCount frames late.
+			// GPU events of the trace capture are added to the frame that recorded them
 			void begin_gpu_frame();
 			void end_gpu_frame();
 			void end_frame();
 
-			[[nodiscard]] RangeID begin_gpu_range(const std::string& rangeName, const rhi::CommandBuffer& cmd);
+			// Returns INVALID_RANGE_ID if the profiler is disabled or all queries of the frame have been used
+			[[nodiscard]] RangeID begin_gpu_range(Name rangeName, const rhi::CommandBuffer& cmd, bool collectPipelineStatistics = false);
 			void end_gpu_range(RangeID);
-			[[nodiscard]] RangeID begin_cpu_range(const std::string& rangeName);
-			void end_cpu_range(RangeID);
 
-			void start_collecting_pipeline_statistics(const std::string& pipelineName, const rhi::CommandBuffer& cmd);
-			void finish_collecting_pipeline_statistics();
-		
+			// Returns false if the profiler is disabled, end_cpu_scope() must be called only for scopes that have begun
+			bool begin_cpu_scope(
+				Name scopeName,
+				ScopeCategory category = ScopeCategory::GENERAL,
+				uint32_t color = SCOPE_COLOR_DEFAULT)
+			{
+				if (!_isEnabled)
+					return false;
+				_cpuEventRecorder.begin_scope(scopeName, category, color);
+				return true;
+			}
+
+			// Doesn't check _isEnabled, the scope must be ended even if the profiler has been disabled inside it
+			void end_cpu_scope()
+			{
+				_cpuEventRecorder.end_scope();
+			}
+
+			void set_thread_name(const std::string& threadName)
+			{
+				_cpuEventRecorder.set_thread_name(threadName);
+			}
+
+			// Returns nullptr if the frame is older than the trace capture duration or has not ended yet
+			[[nodiscard]] const CPUTimeline* get_cpu_timeline(FrameID frameID) const;
+
+			// Exports frames of the last traceCaptureDuration seconds in Chrome trace event format.
+			// Must be called from the thread that calls end_frame()
+			void export_trace(std::string& outTrace) const
+			{
+				_traceCapture.export_chrome_trace(outTrace);
+			}
+
+			void set_trace_capture_duration(double captureDuration)
+			{
+				_traceCapture.set_capture_duration(captureDuration);
+			}
+
 			[[nodiscard]] bool is_enabled() const { return _isEnabled; }
 			[[nodiscard]] FrameStatsManager& get_frame_stats_manager() const { return *_frameStatsManager; }
 			void set_rhi(rhi::RHI* rhi) { _rhi = rhi; }
+			void set_frame_scratch_allocator(FrameScratchAllocator* frameScratchAllocator) { _frameScratchAllocator = frameScratchAllocator; }
+			// Pass nullptr before the provider is destroyed
+			void set_resource_residency_provider(IResourceResidencyProvider* provider) { _resourceResidencyProvider = provider; }
+			// Frames that have begun are ended and captured even if the profiler is disabled inside them
 			void set_enable(bool isEnabled) { _isEnabled = isEnabled; }
 		
 		private:
 			rhi::RHI* _rhi{ nullptr };
+			FrameScratchAllocator* _frameScratchAllocator{ nullptr };
+			IResourceResidencyProvider* _resourceResidencyProvider{ nullptr };
 			rhi::CommandBuffer _profilerCmd;
+			// Query pools are split into RANGE_COUNT queries per buffer, so queries of frames in flight are not reset
 			std::vector<rhi::Buffer> _queryResultBuffers;
+			std::vector<rhi::Buffer> _pipelineStatisticsResultBuffers;
 			rhi::QueryPool _timestampQueryPool;
 			rhi::QueryPool _pipelineStatisticsQueryPool;
 			std::atomic<uint32_t> _nextTimestampQuery{ 0 };
 			std::atomic<uint32_t> _nextPipelineStatisticsQuery{ 0 };
+			uint32_t _firstBufferQuery{ 0 };
+			uint64_t _gpuFrameCount{ 0 };
 		
 			std::unique_ptr<FrameStatsManager> _frameStatsManager{ nullptr };
 
 			FrameStats* _activeFrameStats{ nullptr };
-			PoolAllocator<CPURange> _cpuRangePool;
+			CPUEventRecorder _cpuEventRecorder;
+			TraceCapture _traceCapture;
+			Name _cpuFrameScopeName;
+			Name _gpuFrameRangeName;
 			PoolAllocator<GPURange> _gpuRangePool;
-			std::vector<CPURange*> _activeCPURanges;
 			std::vector<GPURange*> _activeGPURanges;
-			std::mutex _cpuRangeMutex;
+			std::vector<std::vector<GPURange*>> _pendingGPURanges;		// Ranges of frames in flight per buffer
+			std::vector<FrameID> _pendingGPUFrameIDs;					// Frames that used each buffer
+			std::vector<GPURange*> _resolvedGPURanges;
+			std::vector<GPUTimelineEvent> _resolvedGPUEvents;
+			FrameID _resolvedGPUFrameID{ 0 };
 			std::mutex _gpuRangeMutex;
-			RangeID _cpuFrame{ 0 };
-			RangeID _gpuFrame{ 0 };
+			RangeID _gpuFrame{ INVALID_RANGE_ID };
 		
 			FrameID _currentFrameID{ 0 };
 		
 			bool _isEnabled{ true };
+			bool _isFrameEnabled{ false };		// Latched in begin_cpu_frame(), so a frame is ended only if it has begun
 			bool _isInitialized{ false };
 
 			void init();
-			const rhi::Buffer& get_current_result_buffer();
+			void resolve_gpu_ranges(uint32_t bufferIndex);
+			uint32_t get_current_buffer_index() const;
+			uint64_t get_gpu_time_ns(uint64_t timestamp, uint64_t gpuFrameBeginTimestamp);
 	};
 }
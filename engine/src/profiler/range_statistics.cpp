@@ -0,0 +1,297 @@
+#include "range_statistics.h"
+#include <json.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace ad_astris;
+using namespace profiler;
+using namespace nlohmann;
+
+constexpr const char* CAPTURE_NAME_KEY = "capture_name";
+constexpr const char* CPU_RANGES_KEY = "cpu_ranges";
+constexpr const char* GPU_RANGES_KEY = "gpu_ranges";
+constexpr const char* PIPELINE_STATISTICS_KEY = "pipeline_statistics";
+constexpr const char* SAMPLE_COUNT_KEY = "sample_count";
+constexpr const char* HITCH_COUNT_KEY = "hitch_count";
+constexpr const char* MIN_KEY = "min";
+constexpr const char* MAX_KEY = "max";
+constexpr const char* AVERAGE_KEY = "average";
+constexpr const char* STANDARD_DEVIATION_KEY = "standard_deviation";
+constexpr const char* P50_KEY = "p50";
+constexpr const char* P95_KEY = "p95";
+constexpr const char* P99_KEY = "p99";
+
+namespace
+{
+	// Nearest-rank percentile, sortedTimings must not be empty
+	Timing get_percentile(const std::vector<Timing>& sortedTimings, double percentile)
+	{
+		size_t rank = static_cast<size_t>(std::ceil(percentile * sortedTimings.size()));
+		return sortedTimings[std::max<size_t>(rank, 1) - 1];
+	}
+
+	void serialize_statistics(const RangeStatistics& statistics, json& outJson)
+	{
+		outJson[SAMPLE_COUNT_KEY] = statistics.sampleCount;
+		outJson[HITCH_COUNT_KEY] = statistics.hitchCount;
+		outJson[MIN_KEY] = statistics.min;
+		outJson[MAX_KEY] = statistics.max;
+		outJson[AVERAGE_KEY] = statistics.average;
+		outJson[STANDARD_DEVIATION_KEY] = statistics.standardDeviation;
+		outJson[P50_KEY] = statistics.p50;
+		outJson[P95_KEY] = statistics.p95;
+		outJson[P99_KEY] = statistics.p99;
+	}
+
+	void deserialize_statistics(const json& statisticsJson, RangeStatistics& outStatistics)
+	{
+		outStatistics.sampleCount = statisticsJson.value(SAMPLE_COUNT_KEY, 0ull);
+		outStatistics.hitchCount = statisticsJson.value(HITCH_COUNT_KEY, 0ull);
+		outStatistics.min = statisticsJson.value(MIN_KEY, 0.0f);
+		outStatistics.max = statisticsJson.value(MAX_KEY, 0.0f);
+		outStatistics.average = statisticsJson.value(AVERAGE_KEY, 0.0);
+		outStatistics.standardDeviation = statisticsJson.value(STANDARD_DEVIATION_KEY, 0.0);
+		outStatistics.p50 = statisticsJson.value(P50_KEY, 0.0f);
+		outStatistics.p95 = statisticsJson.value(P95_KEY, 0.0f);
+		outStatistics.p99 = statisticsJson.value(P99_KEY, 0.0f);
+	}
+
+	json serialize_ranges(const RangeStatisticsTable& ranges)
+	{
+		json rangesJson = json::object();
+		for (auto& [rangeName, statistics] : ranges)
+			serialize_statistics(statistics, rangesJson[rangeName.to_string()]);
+		return rangesJson;
+	}
+
+	void deserialize_ranges(const json& rangesJson, RangeStatisticsTable& outRanges)
+	{
+		for (auto& keyValue : rangesJson.items())
+			deserialize_statistics(keyValue.value(), outRanges[Name(keyValue.key())]);
+	}
+
+	json serialize_pipeline_statistics(const PipelineStatisticsSummaryTable& ranges)
+	{
+		json rangesJson = json::object();
+		for (auto& [rangeName, summary] : ranges)
+		{
+			json& rangeJson = rangesJson[rangeName.to_string()];
+			for (size_t i = 0; i != PIPELINE_STATISTIC_COUNT; ++i)
+				serialize_statistics(summary[i], rangeJson[get_pipeline_statistic_name(static_cast<PipelineStatisticType>(i))]);
+		}
+		return rangesJson;
+	}
+
+	void deserialize_pipeline_statistics(const json& rangesJson, PipelineStatisticsSummaryTable& outRanges)
+	{
+		for (auto& keyValue : rangesJson.items())
+		{
+			const json& rangeJson = keyValue.value();
+			PipelineStatisticsSummary& summary = outRanges[Name(keyValue.key())];
+			for (size_t i = 0; i != PIPELINE_STATISTIC_COUNT; ++i)
+			{
+				auto it = rangeJson.find(get_pipeline_statistic_name(static_cast<PipelineStatisticType>(i)));
+				if (it != rangeJson.end())
+					deserialize_statistics(*it, summary[i]);
+			}
+		}
+	}
+
+	void compare_ranges(
+		const RangeStatisticsTable& baselineRanges,
+		const RangeStatisticsTable& currentRanges,
+		bool isGPURange,
+		const RegressionSettings& settings,
+		std::vector<RangeRegression>& outRegressions)
+	{
+		for (auto& [rangeName, current] : currentRanges)
+		{
+			auto it = baselineRanges.find(rangeName);
+			if (it == baselineRanges.end())
+				continue;
+
+			const RangeStatistics& baseline = it->second;
+			if (baseline.sampleCount < 2 || current.sampleCount < 2)
+				continue;
+
+			RangeRegression regression;
+			double increase = current.average - baseline.average;
+			regression.relativeIncrease = baseline.average > 0.0 ? increase / baseline.average : 0.0;
+
+			double baselineN = static_cast<double>(baseline.sampleCount);
+			double currentN = static_cast<double>(current.sampleCount);
+			double standardError = std::sqrt(
+				baseline.standardDeviation * baseline.standardDeviation / baselineN +
+				current.standardDeviation * current.standardDeviation / currentN);
+			if (standardError > 0.0)
+				regression.averageTStatistic = increase / standardError;
+			else if (increase > 0.0)
+				regression.averageTStatistic = INFINITY;
+
+			regression.isAverageRegressed = regression.averageTStatistic > settings.averageTThreshold
+				&& regression.relativeIncrease > settings.minRelativeIncrease
+				&& increase > settings.minAbsoluteIncrease;
+
+			double baselineHitchRate = static_cast<double>(baseline.hitchCount) / baselineN;
+			double currentHitchRate = static_cast<double>(current.hitchCount) / currentN;
+			double pooledHitchRate = static_cast<double>(baseline.hitchCount + current.hitchCount) / (baselineN + currentN);
+			double hitchRateError = std::sqrt(pooledHitchRate * (1.0 - pooledHitchRate) * (1.0 / baselineN + 1.0 / currentN));
+			if (hitchRateError > 0.0)
+				regression.hitchRateZStatistic = (currentHitchRate - baselineHitchRate) / hitchRateError;
+			regression.isHitchRateRegressed = regression.hitchRateZStatistic > settings.hitchRateZThreshold;
+
+			if (!regression.isAverageRegressed && !regression.isHitchRateRegressed)
+				continue;
+
+			regression.rangeName = rangeName;
+			regression.isGPURange = isGPURange;
+			regression.baseline = baseline;
+			regression.current = current;
+			outRegressions.push_back(regression);
+		}
+	}
+}
+
+const char* ad_astris::profiler::get_pipeline_statistic_name(PipelineStatisticType type)
+{
+	switch (type)
+	{
+		case PipelineStatisticType::VERTEX_SHADER_INVOCATIONS:
+			return "vertex_shader_invocations";
+		case PipelineStatisticType::FRAGMENT_SHADER_INVOCATIONS:
+			return "fragment_shader_invocations";
+		case PipelineStatisticType::COMPUTE_SHADER_INVOCATIONS:
+			return "compute_shader_invocations";
+		case PipelineStatisticType::INPUT_ASSEMBLY_PRIMITIVES:
+			return "input_assembly_primitives";
+		case PipelineStatisticType::CLIPPING_PRIMITIVES:
+			return "clipping_primitives";
+		default:
+			return "unknown";
+	}
+}
+
+uint64_t ad_astris::profiler::get_pipeline_statistic(const rhi::PipelineStatistics& statistics, PipelineStatisticType type)
+{
+	switch (type)
+	{
+		case PipelineStatisticType::VERTEX_SHADER_INVOCATIONS:
+			return statistics.vertexShaderInvocations;
+		case PipelineStatisticType::FRAGMENT_SHADER_INVOCATIONS:
+			return statistics.fragmentShaderInvocations;
+		case PipelineStatisticType::COMPUTE_SHADER_INVOCATIONS:
+			return statistics.computeShaderInvocations;
+		case PipelineStatisticType::INPUT_ASSEMBLY_PRIMITIVES:
+			return statistics.inputAssemblyPrimitives;
+		case PipelineStatisticType::CLIPPING_PRIMITIVES:
+			return statistics.clippingPrimitives;
+		default:
+			return 0;
+	}
+}
+
+RangeTimingHistory::RangeTimingHistory(uint32_t windowSize) : _windowSize(std::max(windowSize, 1u))
+{
+	_window.reserve(_windowSize);
+}
+
+bool RangeTimingHistory::add_timing(Timing time, double hitchThreshold)
+{
+	bool isHitch = _sampleCount >= HITCH_WARMUP_SAMPLE_COUNT && time > hitchThreshold * _average;
+	if (isHitch)
+		++_hitchCount;
+
+	if (_window.size() < _windowSize)
+	{
+		_window.push_back(time);
+	}
+	else
+	{
+		_window[_nextWindowIndex] = time;
+		_nextWindowIndex = (_nextWindowIndex + 1) % _windowSize;
+	}
+
+	if (!_sampleCount)
+	{
+		_min = time;
+		_max = time;
+	}
+	_min = std::min(_min, time);
+	_max = std::max(_max, time);
+
+	++_sampleCount;
+	double delta = time - _average;
+	_average += delta / static_cast<double>(_sampleCount);
+	_squaredDeviationSum += delta * (time - _average);
+
+	return isHitch;
+}
+
+void RangeTimingHistory::calculate_statistics(RangeStatistics& outStatistics, std::vector<Timing>& scratch) const
+{
+	outStatistics.sampleCount = _sampleCount;
+	outStatistics.hitchCount = _hitchCount;
+	outStatistics.min = _min;
+	outStatistics.max = _max;
+	outStatistics.average = _average;
+	outStatistics.standardDeviation = _sampleCount > 1 ? std::sqrt(_squaredDeviationSum / static_cast<double>(_sampleCount - 1)) : 0.0;
+
+	if (_window.empty())
+	{
+		outStatistics.p50 = outStatistics.p95 = outStatistics.p99 = 0;
+		return;
+	}
+
+	scratch.assign(_window.begin(), _window.end());
+	std::sort(scratch.begin(), scratch.end());
+	outStatistics.p50 = get_percentile(scratch, 0.50);
+	outStatistics.p95 = get_percentile(scratch, 0.95);
+	outStatistics.p99 = get_percentile(scratch, 0.99);
+}
+
+void RangeTimingHistory::reset()
+{
+	_window.clear();
+	_nextWindowIndex = 0;
+	_sampleCount = 0;
+	_hitchCount = 0;
+	_min = 0;
+	_max = 0;
+	_average = 0;
+	_squaredDeviationSum = 0;
+}
+
+void RangeStatisticsCapture::serialize(std::string& outputMetadata) const
+{
+	json captureJson;
+	captureJson[CAPTURE_NAME_KEY] = name;
+	captureJson[CPU_RANGES_KEY] = serialize_ranges(cpuRanges);
+	captureJson[GPU_RANGES_KEY] = serialize_ranges(gpuRanges);
+	captureJson[PIPELINE_STATISTICS_KEY] = serialize_pipeline_statistics(pipelineStatistics);
+	outputMetadata = captureJson.dump(4);
+}
+
+void RangeStatisticsCapture::deserialize(const std::string& inputMetadata)
+{
+	json captureJson = json::parse(inputMetadata);
+	name = captureJson.value(CAPTURE_NAME_KEY, std::string());
+	cpuRanges.clear();
+	gpuRanges.clear();
+	pipelineStatistics.clear();
+	deserialize_ranges(captureJson[CPU_RANGES_KEY], cpuRanges);
+	deserialize_ranges(captureJson[GPU_RANGES_KEY], gpuRanges);
+	// Captures that were saved before pipeline statistics were added don't have this key
+	auto pipelineStatisticsIt = captureJson.find(PIPELINE_STATISTICS_KEY);
+	if (pipelineStatisticsIt != captureJson.end())
+		deserialize_pipeline_statistics(*pipelineStatisticsIt, pipelineStatistics);
+}
+
+void ad_astris::profiler::find_regressions(
+	const RangeStatisticsCapture& baseline,
+	const RangeStatisticsCapture& current,
+	const RegressionSettings& settings,
+	std::vector<RangeRegression>& outRegressions)
+{
+	compare_ranges(baseline.cpuRanges, current.cpuRanges, false, settings, outRegressions);
+	compare_ranges(baseline.gpuRanges, current.gpuRanges, true, settings, outRegressions);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "types.h"
+#include "core/name_table.h"
+#include "core/flat_hash_map.h"
+#include <vector>
+#include <array>
+
+namespace ad_astris::profiler
+{
+	constexpr uint32_t RANGE_TIMING_WINDOW_SIZE = 1024;
+	constexpr uint32_t HITCH_WARMUP_SAMPLE_COUNT = 30;
+	constexpr double DEFAULT_HITCH_THRESHOLD = 2.0;
+
+	// Sample count, min, max, average, standard deviation and hitch count are calculated over all samples since
+	// the last reset. Percentiles are calculated over the last RANGE_TIMING_WINDOW_SIZE samples
+	struct RangeStatistics
+	{
+		uint64_t sampleCount{ 0 };
+		uint64_t hitchCount{ 0 };
+		Timing min{ 0 };
+		Timing max{ 0 };
+		double average{ 0 };
+		double standardDeviation{ 0 };
+		Timing p50{ 0 };
+		Timing p95{ 0 };
+		Timing p99{ 0 };
+	};
+
+	// Streaming statistics of one range. The average and the variance are updated using Welford's algorithm,
+	// so the history doesn't store all samples
+	class RangeTimingHistory
+	{
+		public:
+			RangeTimingHistory(uint32_t windowSize = RANGE_TIMING_WINDOW_SIZE);
+
+			// Returns true if the timing is hitchThreshold times longer than the average of previous samples
+			bool add_timing(Timing time, double hitchThreshold);
+			// Scratch is used to sort window samples, pass the same vector to avoid allocations
+			void calculate_statistics(RangeStatistics& outStatistics, std::vector<Timing>& scratch) const;
+			void reset();
+
+		private:
+			std::vector<Timing> _window;
+			uint32_t _windowSize{ 0 };
+			uint32_t _nextWindowIndex{ 0 };
+			uint64_t _sampleCount{ 0 };
+			uint64_t _hitchCount{ 0 };
+			Timing _min{ 0 };
+			Timing _max{ 0 };
+			double _average{ 0 };
+			double _squaredDeviationSum{ 0 };
+	};
+
+	// Keys are interned, so filling timings doesn't allocate strings. Tables keep their capacity when
+	// FrameStats is reset for a new frame
+	using RangeTimingTable = FlatHashMap<Name, Timing>;
+	using RangeStatisticsTable = FlatHashMap<Name, RangeStatistics>;
+
+	// Pipeline statistics that are aggregated per GPU range. Other statistics of rhi::PipelineStatistics
+	// are collected by query pools but are not tracked
+	enum class PipelineStatisticType
+	{
+		VERTEX_SHADER_INVOCATIONS,
+		FRAGMENT_SHADER_INVOCATIONS,
+		COMPUTE_SHADER_INVOCATIONS,
+		INPUT_ASSEMBLY_PRIMITIVES,
+		CLIPPING_PRIMITIVES,
+		COUNT
+	};
+
+	constexpr size_t PIPELINE_STATISTIC_COUNT = static_cast<size_t>(PipelineStatisticType::COUNT);
+
+	const char* get_pipeline_statistic_name(PipelineStatisticType type);
+	uint64_t get_pipeline_statistic(const rhi::PipelineStatistics& statistics, PipelineStatisticType type);
+
+	// Pipeline statistics of ranges with the same name are summed like CPU scope timings
+	using PipelineStatisticsTable = FlatHashMap<Name, rhi::PipelineStatistics>;
+	// Statistics of each PipelineStatisticType, values are invocation or primitive counts instead of milliseconds
+	// and hitches are not detected
+	using PipelineStatisticsSummary = std::array<RangeStatistics, PIPELINE_STATISTIC_COUNT>;
+	using PipelineStatisticsSummaryTable = FlatHashMap<Name, PipelineStatisticsSummary>;
+
+	// Statistics of all ranges at some moment, can be saved to a file and compared with another capture
+	struct RangeStatisticsCapture
+	{
+		std::string name;
+		RangeStatisticsTable cpuRanges;
+		RangeStatisticsTable gpuRanges;
+		PipelineStatisticsSummaryTable pipelineStatistics;
+
+		void serialize(std::string& outputMetadata) const;
+		void deserialize(const std::string& inputMetadata);
+	};
+
+	struct RegressionSettings
+	{
+		double minRelativeIncrease{ 0.05 };		// Smaller changes of the average are ignored even if they are significant
+		double minAbsoluteIncrease{ 0.01 };		// Milliseconds
+		// Frame timings are autocorrelated, so thresholds are higher than the usual 1.96 for 95% confidence
+		double averageTThreshold{ 3.0 };		// Welch's t statistic
+		double hitchRateZThreshold{ 3.0 };		// Two-proportion z statistic
+	};
+
+	struct RangeRegression
+	{
+		Name rangeName;
+		bool isGPURange{ false };
+		bool isAverageRegressed{ false };
+		bool isHitchRateRegressed{ false };
+		double relativeIncrease{ 0 };
+		double averageTStatistic{ 0 };
+		double hitchRateZStatistic{ 0 };
+		RangeStatistics baseline;
+		RangeStatistics current;
+	};
+
+	// Compares ranges that exist in both captures. A range is regressed if its average has increased significantly
+	// according to Welch's t-test or its hitch rate has increased according to the two-proportion z-test
+	void find_regressions(
+		const RangeStatisticsCapture& baseline,
+		const RangeStatisticsCapture& current,
+		const RegressionSettings& settings,
+		std::vector<RangeRegression>& outRegressions);
+}
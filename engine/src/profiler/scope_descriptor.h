@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/name_table.h"
+#include <cstdint>
+
+namespace ad_astris::profiler
+{
+	enum class ScopeCategory : uint8_t
+	{
+		GENERAL = 0,
+		ENGINE,
+		ECS,
+		TASKS,
+		RENDERER,
+		RESOURCES,
+		IO,
+		COUNT
+	};
+
+	// 0xRRGGBB, SCOPE_COLOR_DEFAULT lets the viewer choose the colour
+	constexpr uint32_t SCOPE_COLOR_DEFAULT = 0xFFFFFFFF;
+
+	inline const char* get_scope_category_name(ScopeCategory category)
+	{
+		switch (category)
+		{
+			case ScopeCategory::ENGINE:
+				return "engine";
+			case ScopeCategory::ECS:
+				return "ecs";
+			case ScopeCategory::TASKS:
+				return "tasks";
+			case ScopeCategory::RENDERER:
+				return "renderer";
+			case ScopeCategory::RESOURCES:
+				return "resources";
+			case ScopeCategory::IO:
+				return "io";
+			default:
+				return "general";
+		}
+	}
+
+	// Static metadata of the profiling scope. PROFILER_SCOPE macros create one descriptor per call site,
+	// the name is interned once using the hash that has been calculated at compile time
+	struct ScopeDescriptor
+	{
+		Name name;
+		uint64_t hash{ 0 };
+		uint32_t color{ SCOPE_COLOR_DEFAULT };
+		ScopeCategory category{ ScopeCategory::GENERAL };
+
+		ScopeDescriptor(std::string_view scopeName, uint64_t scopeHash, ScopeCategory scopeCategory, uint32_t scopeColor)
+			: name(scopeName, scopeHash), hash(scopeHash), color(scopeColor), category(scopeCategory)
+		{
+
+		}
+	};
+}
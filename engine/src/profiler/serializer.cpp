@@ -7,6 +7,8 @@
 using namespace ad_astris::profiler;
 
 constexpr const char* FRAME_STATS_FILE_EXTENSION = "aaframestats";
+constexpr const char* TRACE_FILE_EXTENSION = "json";
+constexpr const char* RANGE_STATISTICS_FILE_EXTENSION = "aarangestats";
 
 void Serializer::init(const ProfilerInstance* profilerInstance, io::FileSystem* fileSystem)
 {
@@ -37,6 +39,69 @@ void Serializer::save_frame_stats_file(FrameStats* frameStats)
 	LOG_INFO("profiler::Serializer::save_frame_stats_file(): Saved frame stats file {}", frameStats->get_name())
 }
 
+void Serializer::save_trace_file(const std::string& traceName)
+{
+	if (!is_initialized())
+	{
+		LOG_ERROR("profiler::Serializer::save_trace_file(): Serializer is not initialized")
+		return;
+	}
+
+	std::string trace;
+	_profilerInstance->export_trace(trace);
+
+	io::URI traceFilePath{
+		fmt::format(
+			"{}/intermediate/profiler_stats/{}.{}",
+			_fileSystem->get_project_root_path().c_str(),
+			traceName,
+			TRACE_FILE_EXTENSION) };
+
+	io::Utils::write_file(_fileSystem, traceFilePath, trace);
+	LOG_INFO("profiler::Serializer::save_trace_file(): Saved trace file {}", traceName)
+}
+
+void Serializer::save_range_statistics_file(const std::string& captureName)
+{
+	if (!is_initialized())
+	{
+		LOG_ERROR("profiler::Serializer::save_range_statistics_file(): Serializer is not initialized")
+		return;
+	}
+
+	RangeStatisticsCapture capture;
+	capture.name = captureName;
+	_profilerInstance->get_frame_stats_manager().capture_range_statistics(capture);
+
+	std::string serializedMetadata;
+	capture.serialize(serializedMetadata);
+
+	io::URI captureFilePath{
+		fmt::format(
+			"{}/intermediate/profiler_stats/{}.{}",
+			_fileSystem->get_project_root_path().c_str(),
+			captureName,
+			RANGE_STATISTICS_FILE_EXTENSION) };
+
+	io::Utils::write_file(_fileSystem, captureFilePath, serializedMetadata);
+	LOG_INFO("profiler::Serializer::save_range_statistics_file(): Saved range statistics file {}", captureName)
+}
+
+bool Serializer::read_range_statistics_file(const io::URI& captureFilePath, RangeStatisticsCapture& outCapture)
+{
+	std::string extension = io::Utils::get_file_extension(captureFilePath);
+	if (extension != RANGE_STATISTICS_FILE_EXTENSION)
+	{
+		LOG_ERROR("profiler::Serializer::read_range_statistics_file(): File has extension {} not {}", extension, RANGE_STATISTICS_FILE_EXTENSION)
+		return false;
+	}
+
+	std::string serializedMetadata;
+	io::Utils::read_file(_fileSystem, captureFilePath, serializedMetadata);
+	outCapture.deserialize(serializedMetadata);
+	return true;
+}
+
 void Serializer::read_frame_stats_file(const io::URI& frameStatsFilePath)
 {
 	std::string extension = io::Utils::get_file_extension(frameStatsFilePath);
@@ -11,6 +11,12 @@ namespace ad_astris::profiler
 
 			static void save_frame_stats_file(FrameStats* frameStats);
 			static void read_frame_stats_file(const io::URI& frameStatsFilePath);
+			// Saves captured frames to intermediate/profiler_stats/<traceName>.json. The file can be opened
+			// in chrome://tracing or Perfetto UI
+			static void save_trace_file(const std::string& traceName);
+			// Range statistics captures are compared with find_regressions() to detect performance regressions
+			static void save_range_statistics_file(const std::string& captureName);
+			static bool read_range_statistics_file(const io::URI& captureFilePath, RangeStatisticsCapture& outCapture);
 
 		private:
 			inline static const ProfilerInstance* _profilerInstance{ nullptr };
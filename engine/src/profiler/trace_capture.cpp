@@ -0,0 +1,164 @@
+#include "trace_capture.h"
+#include <fmt/format.h>
+
+using namespace ad_astris;
+using namespace profiler;
+
+constexpr uint32_t CPU_PROCESS_ID = 1;
+constexpr uint32_t GPU_PROCESS_ID = 2;
+
+namespace
+{
+	void write_json_string(fmt::memory_buffer& buffer, std::string_view str)
+	{
+		buffer.push_back('"');
+		for (char c : str)
+		{
+			switch (c)
+			{
+				case '"':
+					buffer.append(std::string_view("\\\""));
+					break;
+				case '\\':
+					buffer.append(std::string_view("\\\\"));
+					break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						fmt::format_to(std::back_inserter(buffer), "\\u{:04x}", static_cast<uint32_t>(c));
+					else
+						buffer.push_back(c);
+			}
+		}
+		buffer.push_back('"');
+	}
+
+	void write_metadata_event(fmt::memory_buffer& buffer, const char* type, uint32_t processID, uint32_t threadID, std::string_view name)
+	{
+		fmt::format_to(std::back_inserter(buffer), "{{\"ph\":\"M\",\"name\":\"{}\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":", type, processID, threadID);
+		write_json_string(buffer, name);
+		buffer.append(std::string_view("}},"));
+	}
+
+	void write_complete_event(
+		fmt::memory_buffer& buffer,
+		std::string_view name,
+		const char* category,
+		uint32_t processID,
+		uint32_t threadID,
+		uint64_t beginNs,
+		uint64_t endNs,
+		uint32_t color = SCOPE_COLOR_DEFAULT)
+	{
+		buffer.append(std::string_view("{\"ph\":\"X\",\"name\":"));
+		write_json_string(buffer, name);
+		uint64_t durationNs = endNs > beginNs ? endNs - beginNs : 0;
+		fmt::format_to(
+			std::back_inserter(buffer),
+			",\"cat\":\"{}\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+			category,
+			processID,
+			threadID,
+			static_cast<double>(beginNs) / 1000.0,
+			static_cast<double>(durationNs) / 1000.0);
+
+		// Chrome trace has only a fixed palette, so the colour is written as an argument
+		if (color != SCOPE_COLOR_DEFAULT)
+			fmt::format_to(std::back_inserter(buffer), ",\"args\":{{\"color\":\"#{:06x}\"}}", color);
+		buffer.append(std::string_view("},"));
+	}
+}
+
+TraceCapture::TraceCapture(double captureDuration)
+{
+	set_capture_duration(captureDuration);
+}
+
+CapturedFrame& TraceCapture::add_frame()
+{
+	if (!_frames.empty())
+	{
+		uint64_t lastFrameEndNs = _frames.back().cpuTimeline.frameEndNs;
+		while (_frames.size() > 1 && _frames.front().cpuTimeline.frameEndNs + _captureDurationNs < lastFrameEndNs)
+		{
+			_freeFrames.push_back(std::move(_frames.front()));
+			_frames.pop_front();
+		}
+	}
+
+	if (_freeFrames.empty())
+		return _frames.emplace_back();
+
+	CapturedFrame& frame = _frames.emplace_back(std::move(_freeFrames.back()));
+	_freeFrames.pop_back();
+	frame.cpuTimeline.clear();
+	frame.gpuEvents.clear();
+	return frame;
+}
+
+const CapturedFrame* TraceCapture::get_frame(FrameID frameID) const
+{
+	if (_frames.empty() || frameID < _frames.front().cpuTimeline.frameID)
+		return nullptr;
+
+	// Frame IDs are sequential, so the frame can be found by its offset from the oldest frame
+	FrameID frameIndex = frameID - _frames.front().cpuTimeline.frameID;
+	if (frameIndex >= _frames.size() || _frames[frameIndex].cpuTimeline.frameID != frameID)
+		return nullptr;
+
+	return &_frames[frameIndex];
+}
+
+CapturedFrame* TraceCapture::get_frame(FrameID frameID)
+{
+	return const_cast<CapturedFrame*>(static_cast<const TraceCapture&>(*this).get_frame(frameID));
+}
+
+void TraceCapture::export_chrome_trace(std::string& outTrace) const
+{
+	fmt::memory_buffer buffer;
+	// Every event is followed by a comma, the last one is removed before closing the array
+	buffer.append(std::string_view("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+	write_metadata_event(buffer, "process_name", CPU_PROCESS_ID, 0, "CPU");
+	write_metadata_event(buffer, "process_name", GPU_PROCESS_ID, 0, "GPU");
+	write_metadata_event(buffer, "thread_name", GPU_PROCESS_ID, 0, "GPU queue");
+
+	// Threads are never unregistered, so the last frame knows about all threads
+	if (!_frames.empty())
+	{
+		for (auto& thread : _frames.back().cpuTimeline.threads)
+			write_metadata_event(buffer, "thread_name", CPU_PROCESS_ID, thread.threadIndex, thread.name);
+	}
+
+	for (auto& frame : _frames)
+	{
+		const CPUTimeline& cpuTimeline = frame.cpuTimeline;
+		for (auto& event : cpuTimeline.events)
+		{
+			write_complete_event(
+				buffer,
+				event.name.get_string_view(),
+				get_scope_category_name(event.category),
+				CPU_PROCESS_ID,
+				event.threadIndex,
+				event.beginNs,
+				event.endNs,
+				event.color);
+		}
+
+		for (auto& event : frame.gpuEvents)
+		{
+			write_complete_event(
+				buffer,
+				event.name.get_string_view(),
+				"gpu",
+				GPU_PROCESS_ID,
+				0,
+				cpuTimeline.frameBeginNs + event.beginNs,
+				cpuTimeline.frameBeginNs + event.endNs);
+		}
+	}
+
+	buffer.resize(buffer.size() - 1);
+	buffer.append(std::string_view("]}"));
+	outTrace.assign(buffer.data(), buffer.size());
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.h"
+#include "cpu_timeline.h"
+#include <deque>
+
+namespace ad_astris::profiler
+{
+	constexpr double DEFAULT_TRACE_CAPTURE_DURATION = 10.0;
+
+	struct GPUTimelineEvent
+	{
+		Name name;
+		uint64_t beginNs{ 0 };		// Relative to the beginning of the GPU frame
+		uint64_t endNs{ 0 };
+	};
+
+	struct CapturedFrame
+	{
+		CPUTimeline cpuTimeline;
+		std::vector<GPUTimelineEvent> gpuEvents;
+	};
+
+	// Keeps timelines of frames that ended during the last captureDuration seconds. Evicted frames are reused,
+	// so capturing does not allocate once event vectors have grown to the usual frame size.
+	class TraceCapture
+	{
+		public:
+			TraceCapture(double captureDuration = DEFAULT_TRACE_CAPTURE_DURATION);
+
+			// Evicts old frames and returns a frame that must be filled by the caller
+			CapturedFrame& add_frame();
+
+			// Returns nullptr if the frame has been evicted or has not been captured yet
+			const CapturedFrame* get_frame(FrameID frameID) const;
+			CapturedFrame* get_frame(FrameID frameID);
+
+			// Writes captured frames in Chrome trace event format, the file can be opened in chrome://tracing or Perfetto UI.
+			// CPU scopes are grouped by threads and use scope categories, GPU ranges are aligned to the beginning of the CPU frame that
+			// recorded them because RHI doesn't provide calibrated CPU and GPU timestamps
+			void export_chrome_trace(std::string& outTrace) const;
+
+			void set_capture_duration(double captureDuration)
+			{
+				_captureDurationNs = static_cast<uint64_t>(captureDuration * 1000000000.0);
+			}
+
+			uint64_t get_captured_frame_count() const
+			{
+				return _frames.size();
+			}
+
+		private:
+			std::deque<CapturedFrame> _frames;
+			std::vector<CapturedFrame> _freeFrames;
+			uint64_t _captureDurationNs{ 0 };
+	};
+}
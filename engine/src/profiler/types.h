@@ -2,8 +2,10 @@
 
 #include "core/timer.h"
 #include "rhi/resources.h"
+#include "core/name_table.h"
 #include <thread>
 #include <string>
+#include <vector>
 
 namespace ad_astris::profiler
 {
@@ -13,25 +15,24 @@ namespace ad_astris::profiler
 	using RangeName = std::string;
 	using FrameName = std::string;
 	using Timing = float;
+
+	// Returned by begin_gpu_range() if the range was not recorded, end_gpu_range() ignores it
+	constexpr RangeID INVALID_RANGE_ID = ~RangeID(0);
 	
 	struct Range
 	{
-		RangeName name;
+		Name name;
 		float time{ 0 };
 		bool isFinished{ false };
 	};
 	
-	struct CPURange : public Range
-	{
-		Timer timer;
-		ThreadId threadId;
-	};
-	
 	struct GPURange : public Range
 	{
 		rhi::CommandBuffer cmd;
 		int32_t beginTimeQueryIndex{ 0 };
 		int32_t endTimeQueryIndex{ 0 };
+		int32_t pipelineStatisticsQueryIndex{ -1 };		// -1 if pipeline statistics are not collected
+		rhi::PipelineStatistics pipelineStatistics;
 	};
 
 	struct CPUMemoryUsage
@@ -41,4 +42,26 @@ namespace ad_astris::profiler
 		uint64_t processedPhysical{ 0 };
 		uint64_t processedVirtual{ 0 };
 	};
+
+	// Memory of loaded resources of one type
+	struct ResourceResidencyUsage
+	{
+		std::string typeName;
+		uint64_t residentSize{ 0 };
+		uint64_t budget{ 0 };				// 0 if the type has no budget
+		uint64_t residentCount{ 0 };
+		uint64_t referencedCount{ 0 };		// Resident resources that can't be evicted
+		uint64_t loadCount{ 0 };
+		uint64_t evictionCount{ 0 };
+		uint64_t evictedSize{ 0 };
+	};
+
+	// Implemented by the resource manager, so the profiler doesn't depend on it
+	class IResourceResidencyProvider
+	{
+		public:
+			virtual ~IResourceResidencyProvider() = default;
+			// Must be thread-safe, because it is called at the end of the frame while resources can be loaded
+			virtual void get_residency_usage(std::vector<ResourceResidencyUsage>& outUsage) const = 0;
+	};
 }
\ No newline at end of file
@@ -47,6 +47,16 @@ rhi::Pipeline* PipelineManager::get_builtin_pipeline(BuiltinPipelineType pipelin
 	return &it->second.pipeline;
 }
 
+void PipelineManager::reload_changed_shaders()
+{
+	if (!_shaderManager->reload_changed_shaders())
+		return;
+
+	// Previous pipelines are released by the RHI on cleanup
+	_rhi->wait_for_gpu();
+	create_builtin_pipelines();
+}
+
 void PipelineManager::load_builtin_shaders()
 {
 	tasks::TaskGroup taskGroup;
@@ -12,6 +12,7 @@ namespace ad_astris::rcore::impl
 			virtual void bind_render_pass_to_pipeline(IRenderPass* renderPass, BuiltinPipelineType type) override;
 			virtual void create_builtin_pipelines() override;
 			virtual rhi::Pipeline* get_builtin_pipeline(BuiltinPipelineType pipelineType) override;
+			virtual void reload_changed_shaders() override;
 
 		private:
 			IRendererResourceManager* _rendererResourceManager{ nullptr };
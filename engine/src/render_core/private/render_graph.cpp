@@ -1,6 +1,8 @@
 #include "render_graph.h"
 #include "render_pass.h"
 #include "profiler/logger.h"
+#include "profiler/profiler.h"
+#include "core/global_objects.h"
 
 #include <algorithm>
 
@@ -16,6 +18,7 @@ RenderGraph::RenderGraph(IRendererResourceManager* rendererResourceManager) : _r
 void RenderGraph::init(rhi::RHI* engineRHI)
 {
 	_rhi = engineRHI;
+	profiler::Profiler::init(PROFILER_INSTANCE());
 }
 
 void RenderGraph::cleanup()
@@ -82,6 +85,11 @@ void RenderGraph::bake()
 	build_physical_resources();
 	build_rendering_begin_info();
 	build_barriers();
+
+	// Names are interned once, so beginning GPU ranges every frame doesn't hash pass names
+	_passRangeNames.clear();
+	for (auto& pass : _logicalPasses)
+		_passRangeNames.emplace_back(pass->get_name());
 }
 
 void RenderGraph::log()
@@ -155,6 +163,8 @@ void RenderGraph::draw(tasks::TaskGroup* taskGroup)
 		if (it != _invalidatingPipelineBarriersByPassIndex.end())
 			_rhi->add_pipeline_barriers(&cmd, it->second);
 		
+		// Pipeline statistics queries can't be nested, so executors must not collect them inside passes
+		profiler::RangeID rangeID = profiler::Profiler::begin_gpu_range(_passRangeNames[passIndex], cmd, true);
 		RenderPass* renderPass = _logicalPasses[passIndex].get();
 		if (check_if_graphics(renderPass))
 			_rhi->begin_rendering(&cmd, &_renderingBeginInfoByPassIndex[passIndex]);
@@ -163,6 +173,7 @@ void RenderGraph::draw(tasks::TaskGroup* taskGroup)
 
 		if (check_if_graphics(renderPass))
 			_rhi->end_rendering(&cmd);
+		profiler::Profiler::end_gpu_range(rangeID);
 		
 		auto it2 = _flushingPipelineBarriersByPassIndex.find(passIndex);
 		if (it2 != _flushingPipelineBarriersByPassIndex.end())
@@ -56,6 +56,7 @@ namespace ad_astris::rcore::impl
 			std::unordered_map<std::string, uint16_t> _logicalPassIndexByItsName;
 
 			std::vector<uint32_t> _sortedPasses;
+			std::vector<Name> _passRangeNames;		// GPU profiler range names by logical pass index
 			std::vector<std::unordered_set<uint32_t>> _passDependencies;
 		
 			std::vector<std::unique_ptr<ResourceDesc>> _logicalResources;
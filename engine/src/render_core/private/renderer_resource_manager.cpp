@@ -35,7 +35,7 @@ rhi::Buffer* RendererResourceManager::allocate_buffer(rhi::BufferInfo& bufferInf
 	return buffer;
 }
 
-rhi::Buffer* RendererResourceManager::allocate_buffer(const std::string& bufferName, rhi::BufferInfo& bufferInfo)
+rhi::Buffer* RendererResourceManager::allocate_buffer(Name bufferName, rhi::BufferInfo& bufferInfo)
 {
 	rhi::Buffer* buffer = check_buffer(bufferName);
 	if (buffer)
@@ -49,7 +49,7 @@ rhi::Buffer* RendererResourceManager::allocate_buffer(const std::string& bufferN
 	return buffer;
 }
 
-rhi::Buffer* RendererResourceManager::allocate_gpu_buffer(const std::string& bufferName, uint64_t size, rhi::ResourceUsage bufferUsage)
+rhi::Buffer* RendererResourceManager::allocate_gpu_buffer(Name bufferName, uint64_t size, rhi::ResourceUsage bufferUsage)
 {
 	rhi::Buffer* buffer = check_buffer(bufferName);
 	if (buffer)
@@ -62,12 +62,12 @@ rhi::Buffer* RendererResourceManager::allocate_gpu_buffer(const std::string& buf
 	return buffer;
 }
 
-rhi::Buffer* RendererResourceManager::allocate_vertex_buffer(const std::string& bufferName, uint64_t size)
+rhi::Buffer* RendererResourceManager::allocate_vertex_buffer(Name bufferName, uint64_t size)
 {
 	return allocate_gpu_buffer(bufferName, size, rhi::ResourceUsage::VERTEX_BUFFER | rhi::ResourceUsage::TRANSFER_DST);
 }
 
-rhi::Buffer* RendererResourceManager::allocate_index_buffer(const std::string& bufferName, uint64_t size)
+rhi::Buffer* RendererResourceManager::allocate_index_buffer(Name bufferName, uint64_t size)
 {
 	return allocate_gpu_buffer(bufferName, size, rhi::ResourceUsage::INDEX_BUFFER | rhi::ResourceUsage::TRANSFER_DST);
 }
@@ -77,7 +77,7 @@ rhi::Buffer* RendererResourceManager::allocate_indirect_buffer(uint64_t size)
 	return allocate_gpu_buffer(size, rhi::ResourceUsage::INDIRECT_BUFFER | rhi::ResourceUsage::TRANSFER_DST | rhi::ResourceUsage::STORAGE_BUFFER);
 }
 
-rhi::Buffer* RendererResourceManager::allocate_indirect_buffer(const std::string& bufferName, uint64_t size)
+rhi::Buffer* RendererResourceManager::allocate_indirect_buffer(Name bufferName, uint64_t size)
 {
 	return allocate_gpu_buffer(bufferName, size, rhi::ResourceUsage::INDIRECT_BUFFER | rhi::ResourceUsage::TRANSFER_DST | rhi::ResourceUsage::STORAGE_BUFFER);
 }
@@ -87,7 +87,7 @@ rhi::Buffer* RendererResourceManager::allocate_storage_buffer(uint64_t size)
 	return allocate_gpu_buffer(size, rhi::ResourceUsage::STORAGE_BUFFER | rhi::ResourceUsage::TRANSFER_DST);
 }
 
-rhi::Buffer* RendererResourceManager::allocate_storage_buffer(const std::string& bufferName, uint64_t size)
+rhi::Buffer* RendererResourceManager::allocate_storage_buffer(Name bufferName, uint64_t size)
 {
 	return allocate_gpu_buffer(bufferName, size, rhi::ResourceUsage::STORAGE_BUFFER | rhi::ResourceUsage::TRANSFER_DST);
 }
@@ -114,7 +114,7 @@ void RendererResourceManager::reallocate_buffer(rhi::Buffer* buffer, uint64_t ne
 	}
 }
 
-rhi::Buffer* RendererResourceManager::reallocate_buffer(const std::string& bufferName, uint64_t newSize)
+rhi::Buffer* RendererResourceManager::reallocate_buffer(Name bufferName, uint64_t newSize)
 {
 	rhi::Buffer* buffer = get_buffer(bufferName);
 	reallocate_buffer(buffer, newSize);
@@ -123,7 +123,7 @@ rhi::Buffer* RendererResourceManager::reallocate_buffer(const std::string& buffe
 
 bool RendererResourceManager::update_buffer(
 	rhi::CommandBuffer* cmd,
-	const std::string& bufferName,
+	Name bufferName,
 	uint64_t objectSizeInBytes,
 	void* allObjects,
 	uint64_t allObjectCount,
@@ -158,8 +158,8 @@ bool RendererResourceManager::update_buffer(
 
 bool RendererResourceManager::update_buffer(
 	rhi::CommandBuffer* cmd,
-	const std::string& srcBufferName, 
-	const std::string& dstBufferName,
+	Name srcBufferName, 
+	Name dstBufferName,
 	uint64_t objectSizeInBytes,
 	uint64_t allObjectCount,
 	uint64_t newObjectCount)
@@ -198,27 +198,27 @@ bool RendererResourceManager::update_buffer(
 	return false;
 }
 
-rhi::Buffer* RendererResourceManager::get_buffer(const std::string& bufferName)
+rhi::Buffer* RendererResourceManager::get_buffer(Name bufferName)
 {
 	std::scoped_lock<std::mutex> locker(_gpuBufferMutex);
 	auto it = _bufferByItsName.find(bufferName);
 	if (it == _bufferByItsName.end())
-		LOG_FATAL("RenderResourceManager::get_buffer(): No buffer with name {}", bufferName)
+		LOG_FATAL("RenderResourceManager::get_buffer(): No buffer with name {}", bufferName.c_str())
 
 	return it->second;
 }
 
-void RendererResourceManager::add_buffer(const std::string& bufferName, rhi::Buffer& buffer)
+void RendererResourceManager::add_buffer(Name bufferName, rhi::Buffer& buffer)
 {
 	// TODO
 }
 
-void RendererResourceManager::bind_buffer_to_name(const std::string& bufferName, rhi::Buffer* buffer)
+void RendererResourceManager::bind_buffer_to_name(Name bufferName, rhi::Buffer* buffer)
 {
 	_bufferByItsName[bufferName] = buffer;
 }
 
-rhi::Texture* RendererResourceManager::allocate_texture(const std::string& textureName, rhi::TextureInfo& textureInfo)
+rhi::Texture* RendererResourceManager::allocate_texture(Name textureName, rhi::TextureInfo& textureInfo)
 {
 	rhi::Texture* texture = check_texture(textureName);
 	if (texture)
@@ -233,7 +233,7 @@ rhi::Texture* RendererResourceManager::allocate_texture(const std::string& textu
 }
 
 rhi::Texture* RendererResourceManager::allocate_gpu_texture(
-	const std::string& textureName,
+	Name textureName,
 	uint64_t width,
 	uint64_t height,
 	rhi::Format format,
@@ -266,7 +266,7 @@ rhi::Texture* RendererResourceManager::allocate_gpu_texture(
 }
 
 rhi::Texture* RendererResourceManager::allocate_color_attachment(
-	const std::string& textureName,
+	Name textureName,
 	uint64_t width,
 	uint64_t height,
 	rhi::ResourceFlags flags,
@@ -285,7 +285,7 @@ rhi::Texture* RendererResourceManager::allocate_color_attachment(
 }
 
 rhi::Texture* RendererResourceManager::allocate_depth_stencil_attachment(
-	const std::string& textureName,
+	Name textureName,
 	uint64_t width,
 	uint64_t height,
 	rhi::ResourceFlags flags,
@@ -304,7 +304,7 @@ rhi::Texture* RendererResourceManager::allocate_depth_stencil_attachment(
 }
 
 rhi::Texture* RendererResourceManager::allocate_cubemap(
-	const std::string& textureName,
+	Name textureName,
 	uint64_t width,
 	uint64_t height,
 	rhi::Format format,
@@ -316,7 +316,7 @@ rhi::Texture* RendererResourceManager::allocate_cubemap(
 }
 
 rhi::Texture* RendererResourceManager::allocate_custom_texture(
-	const std::string& textureName,
+	Name textureName,
 	uint64_t width,
 	uint64_t height,
 	rhi::ResourceFlags flags,
@@ -335,8 +335,8 @@ rhi::Texture* RendererResourceManager::allocate_custom_texture(
 }
 
 rhi::TextureView* RendererResourceManager::allocate_texture_view(
-	const std::string& textureViewName,
-	const std::string& textureName,
+	Name textureViewName,
+	Name textureName,
 	rhi::TextureViewInfo& info)
 {
 	rhi::TextureView* textureView = check_texture_view(textureViewName);
@@ -348,7 +348,7 @@ rhi::TextureView* RendererResourceManager::allocate_texture_view(
 		std::scoped_lock<std::mutex> _locker(_textureMutex);
 		auto it = _textureByItsName.find(textureName);
 		if (it == _textureByItsName.end())
-			LOG_FATAL("RendererResourceManager::allocate_texture_view(): Can't create texture view for the texture {}", textureName)
+			LOG_FATAL("RendererResourceManager::allocate_texture_view(): Can't create texture view for the texture {}", textureName.c_str())
 		texture = it->second;
 	}
 
@@ -361,8 +361,8 @@ rhi::TextureView* RendererResourceManager::allocate_texture_view(
 }
 
 rhi::TextureView* RendererResourceManager::allocate_texture_view(
-	const std::string& textureViewName,
-	const std::string& textureName,
+	Name textureViewName,
+	Name textureName,
 	uint32_t baseMipLevel,
 	uint32_t mipLevels,
 	uint32_t baseLayer,
@@ -378,7 +378,7 @@ rhi::TextureView* RendererResourceManager::allocate_texture_view(
 		std::scoped_lock<std::mutex> _locker(_textureMutex);
 		auto it = _textureByItsName.find(textureName);
 		if (it == _textureByItsName.end())
-			LOG_FATAL("RendererResourceManager::allocate_texture_view(): Can't create texture view for the texture {}", textureName)
+			LOG_FATAL("RendererResourceManager::allocate_texture_view(): Can't create texture view for the texture {}", textureName.c_str())
 		texture = it->second;
 	}
 
@@ -396,7 +396,7 @@ rhi::TextureView* RendererResourceManager::allocate_texture_view(
 	return textureView;
 }
 
-void RendererResourceManager::update_2d_texture(rhi::CommandBuffer* cmd, const std::string& textureName, void* textureData, uint32_t width, uint32_t height)
+void RendererResourceManager::update_2d_texture(rhi::CommandBuffer* cmd, Name textureName, void* textureData, uint32_t width, uint32_t height)
 {
 	rhi::Texture* texture = get_texture(textureName);
 
@@ -406,7 +406,7 @@ void RendererResourceManager::update_2d_texture(rhi::CommandBuffer* cmd, const s
 	_rhi->copy_buffer_to_texture(cmd, &buffer, texture);
 }
 
-void RendererResourceManager::generate_mipmaps(rhi::CommandBuffer* cmd, const std::string& textureName)
+void RendererResourceManager::generate_mipmaps(rhi::CommandBuffer* cmd, Name textureName)
 {
 	generate_mipmaps(cmd, get_texture(textureName));
 }
@@ -460,32 +460,32 @@ void RendererResourceManager::generate_mipmaps(rhi::CommandBuffer* cmd, rhi::Tex
 	_rhi->add_pipeline_barriers(cmd, { barrier });
 }
 
-rhi::Texture* RendererResourceManager::get_texture(const std::string& textureName)
+rhi::Texture* RendererResourceManager::get_texture(Name textureName)
 {
 	std::scoped_lock<std::mutex> locker(_textureMutex);
 	auto it = _textureByItsName.find(textureName);
 	if (it == _textureByItsName.end())
-		LOG_FATAL("RenderResourceManager::get_texture(): No texture with name {}", textureName)
+		LOG_FATAL("RenderResourceManager::get_texture(): No texture with name {}", textureName.c_str())
 
 	return it->second;
 }
 
-rhi::TextureView* RendererResourceManager::get_texture_view(const std::string& textureViewName)
+rhi::TextureView* RendererResourceManager::get_texture_view(Name textureViewName)
 {
 	std::scoped_lock<std::mutex> locker(_textureViewMutex);
     auto it = _textureViewByItsName.find(textureViewName);
     if (it == _textureViewByItsName.end())
-    	LOG_FATAL("RenderResourceManager::get_texture_view(): No texture view with name {}", textureViewName)
+    	LOG_FATAL("RenderResourceManager::get_texture_view(): No texture view with name {}", textureViewName.c_str())
 
     return it->second;
 }
 
-void RendererResourceManager::add_texture(const std::string& textureName, rhi::Texture& texture)
+void RendererResourceManager::add_texture(Name textureName, rhi::Texture& texture)
 {
 	// TODO
 }
 
-void RendererResourceManager::add_texture_view(const std::string& textureViewName, rhi::TextureView& textureView)
+void RendererResourceManager::add_texture_view(Name textureViewName, rhi::TextureView& textureView)
 {
 	// TODO
 }
@@ -520,37 +520,37 @@ rhi::Buffer& RendererResourceManager::get_new_staging_buffer()
 	return _stagingBuffers.emplace_back();
 }
 
-rhi::Buffer* RendererResourceManager::check_buffer(const std::string& bufferName)
+rhi::Buffer* RendererResourceManager::check_buffer(Name bufferName)
 {
 	std::scoped_lock<std::mutex> locker(_gpuBufferMutex);
 	auto it = _bufferByItsName.find(bufferName);
 	if (it != _bufferByItsName.end())
 	{
-		LOG_WARNING("RendererResourceManager::allocate_gpu_buffer(): Buffer with name {} has been already created.", bufferName)
+		LOG_WARNING("RendererResourceManager::allocate_gpu_buffer(): Buffer with name {} has been already created.", bufferName.c_str())
 		return it->second;
 	}
 	return nullptr;
 }
 
-rhi::Texture* RendererResourceManager::check_texture(const std::string& textureName)
+rhi::Texture* RendererResourceManager::check_texture(Name textureName)
 {
 	std::scoped_lock<std::mutex> locker(_textureMutex);
 	auto it = _textureByItsName.find(textureName);
 	if (it != _textureByItsName.end())
 	{
-		LOG_WARNING("RendererResourceManager::allocate_gpu_texture(): Texture with name {} has been already created.", textureName)
+		LOG_WARNING("RendererResourceManager::allocate_gpu_texture(): Texture with name {} has been already created.", textureName.c_str())
 		return it->second;
 	}
 	return nullptr;
 }
 
-rhi::TextureView* RendererResourceManager::check_texture_view(const std::string& textureViewName)
+rhi::TextureView* RendererResourceManager::check_texture_view(Name textureViewName)
 {
 	std::scoped_lock<std::mutex> locker(_textureViewMutex);
 	auto it = _textureViewByItsName.find(textureViewName);
 	if (it != _textureViewByItsName.end())
 	{
-		LOG_WARNING("RendererResourceManager::allocate_gpu_texture(): Texture view with name {} has been already created.", textureViewName)
+		LOG_WARNING("RendererResourceManager::allocate_gpu_texture(): Texture view with name {} has been already created.", textureViewName.c_str())
 		return it->second;
 	}
 	return nullptr;
@@ -4,6 +4,8 @@
 #include "profiler/logger.h"
 #include <json/json.hpp>
 
+#include <algorithm>
+
 using namespace ad_astris;
 using namespace rcore;
 using namespace impl;
@@ -32,14 +34,22 @@ bool ShaderCache::is_shader_outdated(const io::URI& shaderRelativePath, bool isE
 	io::URI shaderMetadataRelativePath = "intermediate/shader_cache/metadata/" + shaderName + ".aameta";
 	io::URI rootPath = isEngineShader ? FILE_SYSTEM()->get_engine_root_path() : FILE_SYSTEM()->get_project_root_path();
 	
-	io::URI shaderSourceAbsolutePath = io::Utils::get_absolute_path_to_file(rootPath, shaderRelativePath);
 	io::URI shaderBinObjectAbsolutePath = io::Utils::get_absolute_path_to_file(rootPath, shaderBinObjectRelativePath);
 	io::URI shaderBinObjectMetadataPath = io::Utils::get_absolute_path_to_file(rootPath, shaderMetadataRelativePath);
 
+	std::string sourcePath = get_source_path(shaderRelativePath, isEngineShader);
+	{
+		std::scoped_lock<std::mutex> lock(_stateMutex);
+		apply_file_changes();
+		auto it = _shaderStateBySource.find(sourcePath);
+		if (it != _shaderStateBySource.end())
+			return it->second.isOutdated;
+	}
+
 	if (!io::Utils::exists(shaderBinObjectAbsolutePath) || !io::Utils::exists(shaderBinObjectMetadataPath))
 		return true;
 
-	uint64_t shaderSourceTimeStamp = io::Utils::get_last_write_time(shaderSourceAbsolutePath);
+	uint64_t shaderSourceTimeStamp = get_last_write_time(sourcePath);
 	uint64_t shaderBinObjectTimeStamp = io::Utils::get_last_write_time(shaderBinObjectAbsolutePath);
 
 	if (shaderBinObjectTimeStamp < shaderSourceTimeStamp)
@@ -52,19 +62,23 @@ bool ShaderCache::is_shader_outdated(const io::URI& shaderRelativePath, bool isE
 	memcpy(strMetadata.data(), outputData.data(), outputData.size());
 
 	nlohmann::json shaderBinObjectMetadata = nlohmann::json::parse(strMetadata);
+	std::vector<std::string> files = { sourcePath };
 	uint64_t dependencyTimeStamp = 0;
 	for (auto& keyAndValue : shaderBinObjectMetadata.items())
 	{
 		std::string dependencyAbsolutePath = keyAndValue.key();
 		if (io::Utils::exists(dependencyAbsolutePath))
 		{
-			dependencyTimeStamp = io::Utils::get_last_write_time(dependencyAbsolutePath);
+			// Dependencies are usually shared, so their timestamps are cached
+			files.push_back(io::FileWatcher::normalize_path(dependencyAbsolutePath));
+			dependencyTimeStamp = get_last_write_time(files.back());
 
 			if (shaderBinObjectTimeStamp < dependencyTimeStamp)
 				return true;
 		}
 	}
 
+	set_shader_state(sourcePath, files);
 	return false;
 }
 
@@ -83,13 +97,19 @@ void ShaderCache::update_shader_cache(ShaderInputDesc& inputDesc, ShaderOutputDe
 	io::Utils::write_file(FILE_SYSTEM(), shaderBinObjectAbsolutePath, outputDesc.data, outputDesc.dataSize);
 
 	nlohmann::json shaderMetadata;
+	std::vector<std::string> files = { io::FileWatcher::normalize_path(inputDesc.shaderPath.c_str()) };
 	for (auto& dependency : outputDesc.dependencies)
 	{
 		shaderMetadata[dependency] = 0;
+		files.push_back(io::FileWatcher::normalize_path(dependency));
 	}
 
 	std::string strShaderMetadata = shaderMetadata.dump();
 	io::Utils::write_file(FILE_SYSTEM(), shaderBinObjectMetadataPath, strShaderMetadata.c_str(), strShaderMetadata.size());
+
+	for (auto& file : files)
+		_fileWatcher.watch(std::filesystem::path(file).parent_path());
+	set_shader_state(files.front(), files);
 }
 
 void ShaderCache::load_shader_bin(const std::string& shaderName, std::vector<uint8_t>& outputData, bool isEngineShader)
@@ -101,6 +121,31 @@ void ShaderCache::load_shader_bin(const std::string& shaderName, std::vector<uin
 	io::Utils::read_file(FILE_SYSTEM(), absolutePath, outputData);
 }
 
+bool ShaderCache::has_outdated_shaders()
+{
+	if (!_fileWatcher.is_supported())
+		return false;
+
+	std::scoped_lock<std::mutex> lock(_stateMutex);
+	if (!apply_file_changes())
+		return true;
+	for (auto& [sourcePath, shaderState] : _shaderStateBySource)
+	{
+		if (shaderState.isOutdated)
+			return true;
+	}
+	return false;
+}
+
+void ShaderCache::reset_outdated_state(const io::URI& shaderRelativePath, bool isEngineShader)
+{
+	std::string sourcePath = get_source_path(shaderRelativePath, isEngineShader);
+	std::scoped_lock<std::mutex> lock(_stateMutex);
+	auto it = _shaderStateBySource.find(sourcePath);
+	if (it != _shaderStateBySource.end())
+		it->second.isOutdated = false;
+}
+
 void ShaderCache::get_shader_object_relative_path(std::string& shaderName, io::URI& output)
 {
 	output= "intermediate/shader_cache";
@@ -115,3 +160,74 @@ void ShaderCache::get_shader_object_relative_path(std::string& shaderName, io::U
 		break;
 	}
 }
+
+std::string ShaderCache::get_source_path(const io::URI& shaderRelativePath, bool isEngineShader)
+{
+	io::URI rootPath = isEngineShader ? FILE_SYSTEM()->get_engine_root_path() : FILE_SYSTEM()->get_project_root_path();
+	io::URI shaderSourceAbsolutePath = io::Utils::get_absolute_path_to_file(rootPath, shaderRelativePath);
+	return io::FileWatcher::normalize_path(shaderSourceAbsolutePath.c_str());
+}
+
+bool ShaderCache::apply_file_changes()
+{
+	std::vector<std::string> changedFiles;
+	if (!_fileWatcher.consume_changed_files(changedFiles))
+	{
+		// Some changes were lost, so all shaders are checked with timestamps again
+		_shaderStateBySource.clear();
+		_shadersByFile.clear();
+		_lastWriteTimeByFile.clear();
+		return false;
+	}
+
+	for (auto& file : changedFiles)
+	{
+		_lastWriteTimeByFile.erase(file);
+		auto it = _shadersByFile.find(file);
+		if (it == _shadersByFile.end())
+			continue;
+		for (auto& sourcePath : it->second)
+			_shaderStateBySource[sourcePath].isOutdated = true;
+	}
+	return true;
+}
+
+uint64_t ShaderCache::get_last_write_time(const std::string& path)
+{
+	{
+		std::scoped_lock<std::mutex> lock(_stateMutex);
+		auto it = _lastWriteTimeByFile.find(path);
+		if (it != _lastWriteTimeByFile.end())
+			return it->second;
+	}
+
+	// The directory is watched before the timestamp is read, so changes after reading are not lost
+	bool isWatched = _fileWatcher.watch(std::filesystem::path(path).parent_path());
+	uint64_t lastWriteTime = io::Utils::get_last_write_time(path);
+	if (isWatched)
+	{
+		std::scoped_lock<std::mutex> lock(_stateMutex);
+		_lastWriteTimeByFile[path] = lastWriteTime;
+	}
+	return lastWriteTime;
+}
+
+void ShaderCache::set_shader_state(const std::string& sourcePath, std::vector<std::string>& files)
+{
+	// Without the watcher changes are not reported, so shaders are always checked with timestamps
+	if (!_fileWatcher.is_supported())
+		return;
+
+	std::scoped_lock<std::mutex> lock(_stateMutex);
+	ShaderState& shaderState = _shaderStateBySource[sourcePath];
+	for (auto& file : shaderState.files)
+	{
+		std::vector<std::string>& shaders = _shadersByFile[file];
+		shaders.erase(std::remove(shaders.begin(), shaders.end(), sourcePath), shaders.end());
+	}
+
+	shaderState.files = files;
+	shaderState.isOutdated = false;
+	for (auto& file : files)
+		_shadersByFile[file].push_back(sourcePath);
+}
@@ -1,6 +1,9 @@
 ﻿#pragma once
 
 #include "render_core/public/render_core_module.h"
+#include "file_system/file_watcher.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace ad_astris::rcore::impl
 {
@@ -10,9 +13,16 @@ namespace ad_astris::rcore::impl
 			ShaderCache() = default;
 			ShaderCache(ShaderCompilerInitContext& initContext);
 		
+			// Shaders that were checked or compiled before are outdated only if the file watcher reported changes
+			// of their sources or dependencies. Other shaders are checked with timestamps
 			bool is_shader_outdated(const io::URI& shaderRelativePath, bool isEngineShader);
 			void update_shader_cache(ShaderInputDesc& inputDesc, ShaderOutputDesc& outputDesc, bool isEngineShader);
 			void load_shader_bin(const std::string& shaderName, std::vector<uint8_t>& outputData, bool isEngineShader);
+			// Returns true if the file watcher reported changes of shaders that were checked or compiled before.
+			// If some changes were lost, all shaders must be checked again. Always false without the file watcher
+			bool has_outdated_shaders();
+			// The shader is not reported as outdated until its files change again
+			void reset_outdated_state(const io::URI& shaderRelativePath, bool isEngineShader);
 
 			ShaderCacheType get_cache_type()
 			{
@@ -20,8 +30,25 @@ namespace ad_astris::rcore::impl
 			}
 
 		private:
+			struct ShaderState
+			{
+				std::vector<std::string> files;			// The source and its dependencies
+				bool isOutdated{ false };
+			};
+		
 			ShaderCacheType _cacheType;
+			io::FileWatcher _fileWatcher;
+			std::mutex _stateMutex;
+			std::unordered_map<std::string, ShaderState> _shaderStateBySource;
+			std::unordered_map<std::string, std::vector<std::string>> _shadersByFile;
+			// Timestamps of files in watched directories are valid until the watcher reports changes
+			std::unordered_map<std::string, uint64_t> _lastWriteTimeByFile;
 
 			void get_shader_object_relative_path(std::string& shaderName, io::URI& output);
+			std::string get_source_path(const io::URI& shaderRelativePath, bool isEngineShader);
+			// Returns false if some changes were lost, then states of all shaders are cleared
+			bool apply_file_changes();
+			uint64_t get_last_write_time(const std::string& path);
+			void set_shader_state(const std::string& sourcePath, std::vector<std::string>& files);
 	};
 }
\ No newline at end of file
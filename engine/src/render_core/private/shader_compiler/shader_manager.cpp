@@ -14,7 +14,7 @@ void ShaderManager::init(ShaderManagerInitContext& shaderManagerInitContext)
 	ShaderCompilerInitContext shaderCompilerInitContext;
 	shaderCompilerInitContext.cacheType = shaderManagerInitContext.cacheType;
 	
-	_shaderCache = ShaderCache(shaderCompilerInitContext);
+	_shaderCache = std::make_unique<ShaderCache>(shaderCompilerInitContext);
 	_shaderCompiler = std::make_unique<ShaderCompiler>(shaderCompilerInitContext);
 }
 
@@ -25,86 +25,145 @@ rhi::Shader* ShaderManager::load_shader(
 	rhi::HLSLShaderModel minHlslShaderModel,
 	const std::vector<std::string>& shaderDefines)
 {
-	auto it = _shaderByRelativePath.find(relativeShaderPath.c_str());
-	if (it != _shaderByRelativePath.end())
-		return it->second.get();
+	{
+		std::scoped_lock<std::mutex> lock(_shadersMutex);
+		auto it = _loadedShaderByRelativePath.find(relativeShaderPath.c_str());
+		if (it != _loadedShaderByRelativePath.end())
+			return it->second.shader.get();
+	}
+
+	// Shaders are compiled without the lock, so builtin shaders can be loaded in parallel
+	LoadedShader loadedShader;
+	loadedShader.type = shaderType;
+	loadedShader.isEngineShader = isEngineShader;
+	loadedShader.minHlslShaderModel = minHlslShaderModel;
+	loadedShader.defines = shaderDefines;
+	if (!create_shader(relativeShaderPath, loadedShader))
+	{
+		LOG_ERROR("ShaderManager::load_shader(): Failed to load shader {}", relativeShaderPath.c_str())
+		return nullptr;
+	}
+
+	std::scoped_lock<std::mutex> lock(_shadersMutex);
+	auto it = _loadedShaderByRelativePath.try_emplace(relativeShaderPath.c_str(), std::move(loadedShader)).first;
+	return it->second.shader.get();
+}
+
+rhi::Shader* ShaderManager::get_shader(const io::URI& relativeShaderPath)
+{
+	std::scoped_lock<std::mutex> lock(_shadersMutex);
+	auto it = _loadedShaderByRelativePath.find(relativeShaderPath.c_str());
+	if (it != _loadedShaderByRelativePath.end())
+		return it->second.shader.get();
+	LOG_FATAL("ShaderManager::get_shader(): There is no shader {}", relativeShaderPath.c_str())
+}
 
-	io::URI rootPath = isEngineShader ? FILE_SYSTEM()->get_engine_root_path() : FILE_SYSTEM()->get_project_root_path();
+uint32_t ShaderManager::reload_changed_shaders()
+{
+	if (!_shaderCache->has_outdated_shaders())
+		return 0;
 
-	if (_shaderCache.is_shader_outdated(relativeShaderPath, isEngineShader))
+	std::scoped_lock<std::mutex> lock(_shadersMutex);
+	uint32_t reloadedShaderCount = 0;
+	for (auto& [relativeShaderPath, loadedShader] : _loadedShaderByRelativePath)
 	{
-		// LOG_INFO("SHADER {} IS OUTDATED", relativeShaderPath.c_str())
-		rhi::ShaderFormat shaderFormat{ rhi::ShaderFormat::UNDEFINED };
-		std::string shaderExtension = io::Utils::get_file_extension(relativeShaderPath);
-		if (shaderExtension == "hlsl")
-		{
-			switch (_shaderCache.get_cache_type())
-			{
-				case ShaderCacheType::SPIRV:
-					shaderFormat = rhi::ShaderFormat::HLSL_TO_SPIRV;
-					break;
-				case ShaderCacheType::DXIL:
-					shaderFormat = rhi::ShaderFormat::HLSL6;
-					break;
-			}
-		}
-		else
-		{
-			switch (_shaderCache.get_cache_type())
-			{
-				case ShaderCacheType::SPIRV:
-					shaderFormat = rhi::ShaderFormat::GLSL_TO_SPIRV;
-					break;
-				case ShaderCacheType::DXIL:
-					shaderFormat = rhi::ShaderFormat::GLSL_TO_HLSL6;
-					break;
-			}
-		}
-		
-		ShaderInputDesc inputDesc;
-		inputDesc.shaderPath = rootPath + "/" + relativeShaderPath;
-		inputDesc.format = shaderFormat;
-		inputDesc.type = shaderType;
-		inputDesc.minHlslShaderModel = minHlslShaderModel;
-		inputDesc.defines = shaderDefines;
-		inputDesc.includePaths.push_back((FILE_SYSTEM()->get_engine_root_path() + "/engine/shaders").c_str());
-		if (!isEngineShader)
-			inputDesc.includePaths.push_back(FILE_SYSTEM()->get_project_root_path().c_str());
+		if (!_shaderCache->is_shader_outdated(relativeShaderPath, loadedShader.isEngineShader))
+			continue;
 
+		// The old shader is kept if the new version has errors, the shader is not compiled again until its files change
+		rhi::ShaderInfo shaderInfo;
 		ShaderOutputDesc outputDesc;
-		_shaderCompiler->compile(inputDesc, outputDesc);
-		_shaderCache.update_shader_cache(inputDesc, outputDesc, isEngineShader);
+		if (!compile_shader(relativeShaderPath, loadedShader, shaderInfo, outputDesc))
+		{
+			LOG_ERROR("ShaderManager::reload_changed_shaders(): Failed to compile shader {}, the previous version is used", relativeShaderPath)
+			_shaderCache->reset_outdated_state(relativeShaderPath, loadedShader.isEngineShader);
+			continue;
+		}
 
-		rhi::ShaderInfo shaderInfo;
-		shaderInfo.shaderType = shaderType;
-		shaderInfo.data = const_cast<uint8_t*>(outputDesc.data);
-		shaderInfo.size = outputDesc.dataSize;
+		// Callers keep pointers to shaders, so the new shader is created in the same object.
+		// The previous shader object is released by the RHI on cleanup
+		_rhi->create_shader(loadedShader.shader.get(), &shaderInfo);
+		++reloadedShaderCount;
+		LOG_INFO("ShaderManager::reload_changed_shaders(): Shader {} has been reloaded", relativeShaderPath)
+	}
+	return reloadedShaderCount;
+}
 
-		_shaderByRelativePath[relativeShaderPath.c_str()] = std::make_unique<rhi::Shader>();
-		_rhi->create_shader(_shaderByRelativePath[relativeShaderPath.c_str()].get(), &shaderInfo);
+bool ShaderManager::create_shader(const io::URI& relativeShaderPath, LoadedShader& loadedShader)
+{
+	rhi::ShaderInfo shaderInfo;
+	ShaderOutputDesc outputDesc;
+	std::vector<uint8_t> shaderData;
+	if (_shaderCache->is_shader_outdated(relativeShaderPath, loadedShader.isEngineShader))
+	{
+		if (!compile_shader(relativeShaderPath, loadedShader, shaderInfo, outputDesc))
+			return false;
 	}
 	else
 	{
-		// LOG_INFO("LOAD SHADER")
-		std::vector<uint8_t> shaderData;
-		_shaderCache.load_shader_bin(io::Utils::get_file_name(relativeShaderPath), shaderData, isEngineShader);
-
-		rhi::ShaderInfo shaderInfo;
+		_shaderCache->load_shader_bin(io::Utils::get_file_name(relativeShaderPath), shaderData, loadedShader.isEngineShader);
 		shaderInfo.data = shaderData.data();
 		shaderInfo.size = shaderData.size();
-		shaderInfo.shaderType = shaderType;
-
-		_shaderByRelativePath[relativeShaderPath.c_str()] = std::make_unique<rhi::Shader>();
-		_rhi->create_shader(_shaderByRelativePath[relativeShaderPath.c_str()].get(), &shaderInfo);
+		shaderInfo.shaderType = loadedShader.type;
 	}
 
-	return _shaderByRelativePath[relativeShaderPath.c_str()].get();
+	loadedShader.shader = std::make_unique<rhi::Shader>();
+	_rhi->create_shader(loadedShader.shader.get(), &shaderInfo);
+	return true;
 }
 
-rhi::Shader* ShaderManager::get_shader(const io::URI& relativeShaderPath)
+bool ShaderManager::compile_shader(
+	const io::URI& relativeShaderPath,
+	const LoadedShader& loadedShader,
+	rhi::ShaderInfo& outShaderInfo,
+	ShaderOutputDesc& outputDesc)
 {
-	auto it = _shaderByRelativePath.find(relativeShaderPath.c_str());
-	if (it != _shaderByRelativePath.end())
-		return it->second.get();
-	LOG_FATAL("ShaderManager::get_shader(): There is no shader {}", relativeShaderPath.c_str())
+	io::URI rootPath = loadedShader.isEngineShader ? FILE_SYSTEM()->get_engine_root_path() : FILE_SYSTEM()->get_project_root_path();
+
+	rhi::ShaderFormat shaderFormat{ rhi::ShaderFormat::UNDEFINED };
+	std::string shaderExtension = io::Utils::get_file_extension(relativeShaderPath);
+	if (shaderExtension == "hlsl")
+	{
+		switch (_shaderCache->get_cache_type())
+		{
+			case ShaderCacheType::SPIRV:
+				shaderFormat = rhi::ShaderFormat::HLSL_TO_SPIRV;
+				break;
+			case ShaderCacheType::DXIL:
+				shaderFormat = rhi::ShaderFormat::HLSL6;
+				break;
+		}
+	}
+	else
+	{
+		switch (_shaderCache->get_cache_type())
+		{
+			case ShaderCacheType::SPIRV:
+				shaderFormat = rhi::ShaderFormat::GLSL_TO_SPIRV;
+				break;
+			case ShaderCacheType::DXIL:
+				shaderFormat = rhi::ShaderFormat::GLSL_TO_HLSL6;
+				break;
+		}
+	}
+	
+	ShaderInputDesc inputDesc;
+	inputDesc.shaderPath = rootPath + "/" + relativeShaderPath;
+	inputDesc.format = shaderFormat;
+	inputDesc.type = loadedShader.type;
+	inputDesc.minHlslShaderModel = loadedShader.minHlslShaderModel;
+	inputDesc.defines = loadedShader.defines;
+	inputDesc.includePaths.push_back((FILE_SYSTEM()->get_engine_root_path() + "/engine/shaders").c_str());
+	if (!loadedShader.isEngineShader)
+		inputDesc.includePaths.push_back(FILE_SYSTEM()->get_project_root_path().c_str());
+
+	_shaderCompiler->compile(inputDesc, outputDesc);
+	if (!outputDesc.data)
+		return false;
+	_shaderCache->update_shader_cache(inputDesc, outputDesc, loadedShader.isEngineShader);
+
+	outShaderInfo.shaderType = loadedShader.type;
+	outShaderInfo.data = const_cast<uint8_t*>(outputDesc.data);
+	outShaderInfo.size = outputDesc.dataSize;
+	return true;
 }
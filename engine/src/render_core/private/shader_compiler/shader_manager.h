@@ -2,6 +2,7 @@
 
 #include "../api.h"
 #include "shader_cache.h"
+#include <mutex>
 #include <unordered_map>
 
 namespace ad_astris::rcore::impl
@@ -17,6 +18,7 @@ namespace ad_astris::rcore::impl
 				rhi::HLSLShaderModel minHlslShaderModel = rhi::HLSLShaderModel::SM_6_0,
 				const std::vector<std::string>& shaderDefines = {}) override;
 			virtual rhi::Shader* get_shader(const io::URI& relativeShaderPath) override;
+			virtual uint32_t reload_changed_shaders() override;
 		
 			virtual IShaderCompiler* get_shader_compiler() override
 			{
@@ -24,9 +26,25 @@ namespace ad_astris::rcore::impl
 			}
 		
 		private:
+			// Parameters are kept to recompile the shader when its files change
+			struct LoadedShader
+			{
+				std::unique_ptr<rhi::Shader> shader;
+				rhi::ShaderType type{ rhi::ShaderType::UNDEFINED };
+				bool isEngineShader{ true };
+				rhi::HLSLShaderModel minHlslShaderModel{ rhi::HLSLShaderModel::SM_6_0 };
+				std::vector<std::string> defines;
+			};
+		
 			rhi::RHI* _rhi{ nullptr };
-			std::unordered_map<std::string, std::unique_ptr<rhi::Shader>> _shaderByRelativePath;
+			std::unordered_map<std::string, LoadedShader> _loadedShaderByRelativePath;
+			std::mutex _shadersMutex;
 			std::unique_ptr<IShaderCompiler> _shaderCompiler{ nullptr };
-			ShaderCache _shaderCache;
+			std::unique_ptr<ShaderCache> _shaderCache{ nullptr };
+
+			// Compiles the shader if the cache is outdated, otherwise loads the cached binary.
+			// Returns false if the shader has not been compiled, loadedShader is not changed in this case
+			bool create_shader(const io::URI& relativeShaderPath, LoadedShader& loadedShader);
+			bool compile_shader(const io::URI& relativeShaderPath, const LoadedShader& loadedShader, rhi::ShaderInfo& outShaderInfo, ShaderOutputDesc& outputDesc);
 	};
 }
\ No newline at end of file
@@ -33,6 +33,9 @@ namespace ad_astris::rcore
 			virtual void bind_render_pass_to_pipeline(IRenderPass* renderPass, BuiltinPipelineType type) = 0;
 			virtual void create_builtin_pipelines() = 0;
 			virtual rhi::Pipeline* get_builtin_pipeline(BuiltinPipelineType pipelineType) = 0;
+			// Reloads changed shaders and recreates builtin pipelines if any shader has been reloaded.
+			// Must be called between frames because pipelines may be used by command buffers that are executed
+			virtual void reload_changed_shaders() = 0;
 				
 			// virtual rhi::Pipeline* create_custom_pipeline() = 0;
 			// virtual rhi::Pipeline* get_custom_pipeline() = 0;
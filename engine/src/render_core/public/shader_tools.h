@@ -60,6 +60,8 @@ namespace ad_astris::rcore
 				rhi::HLSLShaderModel shaderModel = rhi::HLSLShaderModel::SM_6_0,
 				const std::vector<std::string>& shaderDefines = {}) = 0;
 			virtual rhi::Shader* get_shader(const io::URI& relativeShaderPath) = 0;
+			// Recompiles loaded shaders whose sources or dependencies were changed. Returns the number of reloaded shaders
+			virtual uint32_t reload_changed_shaders() = 0;
 			virtual IShaderCompiler* get_shader_compiler() = 0;
 	};
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#include "depth_reduce.h"
 #include "shader_interop_renderer.h"
 #include "../utils.h"
+#include "renderer/public/attachment_name.h"
 
 using namespace ad_astris;
 using namespace renderer::impl;
@@ -15,9 +16,11 @@ void DepthReduce::prepare_render_pass()
 
 void DepthReduce::execute(rhi::CommandBuffer* cmd)
 {
+	// Interned once instead of on every frame
+	static const Name gDepthStencilName(renderer::AttachmentName::G_DEPTH_STENCIL);
 	DepthPyramid& depthPyramid = Utils::get_depth_pyramid(STATIC_OPAQUE_FILTER, ecore::MAIN_CAMERA);
-	rhi::Texture* gDepthStencilTexture = RENDERER_RESOURCE_MANAGER()->get_texture("gDepthStencil");
-	rhi::TextureView* gDepthStencilView = RENDERER_RESOURCE_MANAGER()->get_texture_view("gDepthStencil");
+	rhi::Texture* gDepthStencilTexture = RENDERER_RESOURCE_MANAGER()->get_texture(gDepthStencilName);
+	rhi::TextureView* gDepthStencilView = RENDERER_RESOURCE_MANAGER()->get_texture_view(gDepthStencilName);
 	uint32_t mipLevels = depthPyramid.get_mip_levels();
 	
 	rhi::Pipeline* pipeline = PIPELINE_MANAGER()->get_builtin_pipeline(rcore::BuiltinPipelineType::DEPTH_REDUCE);
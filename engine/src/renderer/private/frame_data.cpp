@@ -16,11 +16,17 @@ void FrameData::init()
 	bufferInfo.bufferUsage = rhi::ResourceUsage::UNIFORM_BUFFER | rhi::ResourceUsage::TRANSFER_DST;
 	bufferInfo.memoryUsage = rhi::MemoryUsage::CPU_TO_GPU;
 	for (uint32_t i = 0; i != RHI()->get_buffer_count(); ++i)
-		RENDERER_RESOURCE_MANAGER()->allocate_buffer(get_buffer_name(CAMERA_UB_NAME, i), bufferInfo);
+	{
+		_cameraBufferNames.push_back(get_buffer_name(CAMERA_UB_NAME, i));
+		RENDERER_RESOURCE_MANAGER()->allocate_buffer(_cameraBufferNames.back(), bufferInfo);
+	}
 
 	bufferInfo.size = sizeof(FrameUB);
 	for (uint32_t i = 0; i != RHI()->get_buffer_count(); ++i)
-		RENDERER_RESOURCE_MANAGER()->allocate_buffer(get_buffer_name(FRAME_UB_NAME, i), bufferInfo);
+	{
+		_frameBufferNames.push_back(get_buffer_name(FRAME_UB_NAME, i));
+		RENDERER_RESOURCE_MANAGER()->allocate_buffer(_frameBufferNames.back(), bufferInfo);
+	}
 }
 
 void FrameData::update_uniform_buffers(DrawContext& drawContext)
@@ -44,7 +50,7 @@ void FrameData::setup_cameras(DrawContext& drawContext)
 	_cameras[0].zFar = cameraComponent->zFar;
 	_cameras[0].up = cameraComponent->up;
 	_cameras[0].create_frustum();
-	rhi::Buffer* cameraUB = RENDERER_RESOURCE_MANAGER()->get_buffer(get_buffer_name(CAMERA_UB_NAME));
+	rhi::Buffer* cameraUB = RENDERER_RESOURCE_MANAGER()->get_buffer(_cameraBufferNames[FRAME_INDEX]);
 	RHI()->update_buffer_data(cameraUB, sizeof(RendererCamera) * MAX_CAMERA_COUNT, _cameras.data());
 	RHI()->bind_uniform_buffer(cameraUB, UB_CAMERA_SLOT);
 }
@@ -62,7 +68,7 @@ void FrameData::setup_frame_data(DrawContext& drawContext)
 	_frameData.modelInstanceIDBufferIndex = RHI()->get_descriptor_index(modelInstanceIDBuffer);
 	_frameData.lightArrayOffset = 0;
 	_frameData.lightArrayCount = SCENE_MANAGER()->get_light_count();	// TODO Take info from scene manager
-	rhi::Buffer* frameUB = RENDERER_RESOURCE_MANAGER()->get_buffer(get_buffer_name(FRAME_UB_NAME));
+	rhi::Buffer* frameUB = RENDERER_RESOURCE_MANAGER()->get_buffer(_frameBufferNames[FRAME_INDEX]);
 	RHI()->update_buffer_data(frameUB, sizeof(FrameUB), &_frameData);
 	RHI()->bind_uniform_buffer(frameUB, UB_FRAME_SLOT);
 }
@@ -18,14 +18,12 @@ namespace ad_astris::renderer::impl
 		private:
 			FrameUB _frameData{};
 			std::array<RendererCamera, MAX_CAMERA_COUNT> _cameras{};
+			// Names are interned once in init() so per-frame buffer lookups don't build or hash strings
+			std::vector<Name> _cameraBufferNames;
+			std::vector<Name> _frameBufferNames;
 
 			void setup_cameras(DrawContext& drawContext);
 			void setup_frame_data(DrawContext& drawContext);
-
-			FORCE_INLINE std::string get_buffer_name(const std::string& name)
-			{
-				return name + std::to_string(FRAME_INDEX);
-			}
 		
 			FORCE_INLINE std::string get_buffer_name(const std::string& name, uint32_t frameIndex)
 			{
@@ -1,7 +1,6 @@
 ﻿#include "deferred_lighting.h"
 #include "shader_interop_renderer.h"
 #include "renderer/public/attachment_name.h"
-#include "profiler/profiler.h"
 
 using namespace ad_astris;
 using namespace renderer;
@@ -36,7 +35,6 @@ void GBuffer::prepare_render_pass()
 
 void GBuffer::execute(rhi::CommandBuffer* cmd)
 {
-	auto rangeID = profiler::Profiler::begin_gpu_range("GBuffer", *cmd);
 	rhi::Viewport viewport;
 	viewport.width = IMAGE_WIDTH;
 	viewport.height = IMAGE_HEIGHT;
@@ -64,8 +62,6 @@ void GBuffer::execute(rhi::CommandBuffer* cmd)
 		RHI()->draw_indexed_indirect(cmd, indirectBuffer, offset, 1, sizeof(DrawIndexedIndirectCommand));
 		offset += (i + 1) * sizeof(DrawIndexedIndirectCommand);
 	}
-
-	profiler::Profiler::end_gpu_range(rangeID);
 }
 
 void DeferredLighting::prepare_render_pass()
@@ -91,7 +87,6 @@ void DeferredLighting::prepare_render_pass()
 
 void DeferredLighting::execute(rhi::CommandBuffer* cmd)
 {
-	profiler::RangeID rangeID = profiler::Profiler::begin_gpu_range("Deferred lighting", *cmd);
 	rhi::Viewport viewport;
 	viewport.width = IMAGE_WIDTH;
 	viewport.height = IMAGE_HEIGHT;
@@ -112,5 +107,4 @@ void DeferredLighting::execute(rhi::CommandBuffer* cmd)
 	RHI()->bind_vertex_buffer(cmd, vertexBufffer);
 	
 	RHI()->draw(cmd, 6);
-	profiler::Profiler::end_gpu_range(rangeID);
 }
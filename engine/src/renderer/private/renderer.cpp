@@ -8,6 +8,7 @@
 #include "postprocessing/temporal_filter.h"
 #include "swap_chain_pass.h"
 #include "shader_interop_renderer.h"
+#include "renderer/public/attachment_name.h"
 
 using namespace ad_astris;
 using namespace renderer;
@@ -68,12 +69,13 @@ void Renderer::bake()
 
 	RENDER_GRAPH()->log();
 	
-	set_backbuffer("DeferredLightingOutput");
+	set_backbuffer(Name(AttachmentName::DEFERRED_LIGHTING_OUTPUT));
 	LOG_INFO("Renderer::bake(): Finished baking")
 }
 
 void Renderer::draw(DrawContext& drawContext)
 {
+	PIPELINE_MANAGER()->reload_changed_shaders();
 	RHI()->reset_cmd_buffers(FRAME_INDEX);
 	
 	profiler::Profiler::begin_gpu_frame();
@@ -119,7 +121,7 @@ void Renderer::get_next_frame_index()
 		FRAME_INDEX = 0;
 }
 
-void Renderer::set_backbuffer(const std::string& textureName)
+void Renderer::set_backbuffer(Name textureName)
 {
 	IMGUI_BACKEND()->set_backbuffer(RENDERER_RESOURCE_MANAGER()->get_texture_view(textureName), SCENE_MANAGER()->get_sampler(SAMPLER_LINEAR_CLAMP));
 }
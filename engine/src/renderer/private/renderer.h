@@ -37,6 +37,6 @@ namespace ad_astris::renderer::impl
 			void init_global_objects();
 			void init_module_objects();
 			void get_next_frame_index();
-			void set_backbuffer(const std::string& textureName);
+			void set_backbuffer(Name textureName);
 	};
 }
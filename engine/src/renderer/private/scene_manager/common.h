@@ -3,9 +3,9 @@
 #include "rhi/resources.h"
 #include "events/event.h"
 #include "ecs/ecs.h"
+#include "core/flat_hash_map.h"
 #include <mutex>
 #include <vector>
-#include <unordered_map>
 
 namespace ad_astris::renderer::impl
 {
@@ -82,7 +82,7 @@ namespace ad_astris::renderer::impl
 				
 		private:
 			std::vector<T> _array;
-			std::unordered_map<ecs::Entity, uint32_t> _objectIndexByEntity;
+			FlatHashMap<ecs::Entity, uint32_t> _objectIndexByEntity;
 			std::mutex _mutex;
 	};
 }
\ No newline at end of file
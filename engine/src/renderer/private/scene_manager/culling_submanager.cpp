@@ -186,8 +186,9 @@ DepthPyramid::DepthPyramid(size_t entityFilterHash) : _entityFilterHash(entityFi
 	_width = math::previous_pow2(IMAGE_WIDTH);
 	_height = math::previous_pow2(IMAGE_HEIGHT);
 	_mipLevels = math::get_mip_levels(_width, _height);
+	_textureName = get_str_with_id(DEPTH_PYRAMID_NAME);
 	RENDERER_RESOURCE_MANAGER()->allocate_gpu_texture(
-		get_str_with_id(DEPTH_PYRAMID_NAME),
+		_textureName,
 		_width,
 		_height,
 		rhi::Format::R32_SFLOAT,
@@ -195,15 +196,11 @@ DepthPyramid::DepthPyramid(size_t entityFilterHash) : _entityFilterHash(entityFi
 		rhi::ResourceFlags::UNDEFINED,
 		_mipLevels);
 	
-	RENDERER_RESOURCE_MANAGER()->allocate_texture_view(
-		get_str_with_id(DEPTH_PYRAMID_NAME),
-		get_str_with_id(DEPTH_PYRAMID_NAME));
+	RENDERER_RESOURCE_MANAGER()->allocate_texture_view(_textureName, _textureName);
 
 	for (uint32_t i = 0; i != _mipLevels; ++i)
 	{
-		RENDERER_RESOURCE_MANAGER()->allocate_texture_view(
-			get_str_with_id(DEPTH_PYRAMID_MIPMAP_NAME) + std::to_string(i),
-			get_str_with_id(DEPTH_PYRAMID_NAME),
-			i, 1);
+		_mipmapNames.push_back(get_str_with_id(DEPTH_PYRAMID_MIPMAP_NAME) + std::to_string(i));
+		RENDERER_RESOURCE_MANAGER()->allocate_texture_view(_mipmapNames.back(), _textureName, i, 1);
 	}
 }
@@ -9,6 +9,8 @@
 #include "../renderer_array.h"
 #include "../renderer_resource_collection.h"
 #include "core/non_copyable_non_movable.h"
+#include "core/frame_scratch_allocator.h"
+#include "core/flat_hash_map.h"
 
 namespace ad_astris::renderer::impl
 {
@@ -19,23 +21,23 @@ namespace ad_astris::renderer::impl
 
 			rhi::Texture* get_texture() const
 			{
-				return RENDERER_RESOURCE_MANAGER()->get_texture(get_str_with_id(DEPTH_PYRAMID_NAME));
+				return RENDERER_RESOURCE_MANAGER()->get_texture(_textureName);
 			}
 
 			rhi::TextureView* get_texture_view() const
 			{
-				return RENDERER_RESOURCE_MANAGER()->get_texture_view(get_str_with_id(DEPTH_PYRAMID_NAME));
+				return RENDERER_RESOURCE_MANAGER()->get_texture_view(_textureName);
 			}
 		
 			rhi::TextureView* get_mipmap(size_t index) const
 			{
-				return RENDERER_RESOURCE_MANAGER()->get_texture_view(get_str_with_id(DEPTH_PYRAMID_MIPMAP_NAME) + std::to_string(index));
+				return RENDERER_RESOURCE_MANAGER()->get_texture_view(_mipmapNames[index]);
 			}
 		
 			uint32_t get_width() const { return _width; }
 			uint32_t get_height() const { return _height; }
 			uint32_t get_mip_levels() const { return _mipLevels; }
-			std::string get_depth_pyramid_name() const { return get_str_with_id(DEPTH_PYRAMID_NAME); }
+			std::string get_depth_pyramid_name() const { return _textureName.to_string(); }
 		
 		private:
 			inline static constexpr const char* DEPTH_PYRAMID_NAME = "DepthPyramid";
@@ -45,6 +47,9 @@ namespace ad_astris::renderer::impl
 			uint32_t _height{ 0 };
 			uint32_t _mipLevels{ 0 };
 			size_t _entityFilterHash{ 0 };
+			// Texture and texture view have the same name
+			Name _textureName;
+			std::vector<Name> _mipmapNames;
 				
 			std::string get_str_with_id(const std::string& str) const
 			{
@@ -124,9 +129,10 @@ namespace ad_astris::renderer::impl
 				return it2->second;
 			}
 		
-			FORCE_INLINE std::vector<IndirectBuffers*> get_light_indirect_buffers(ecs::Entity lightSource)
+			// Returned vector is valid until the end of the next frame
+			FORCE_INLINE FrameVector<IndirectBuffers*> get_light_indirect_buffers(ecs::Entity lightSource)
 			{
-				std::vector<IndirectBuffers*> buffers;
+				FrameVector<IndirectBuffers*> buffers(FRAME_SCRATCH_ALLOCATOR());
 				for (auto& pair : _shadowsCullingContextByEntityFilterHash)
 				{
 					ShadowsCullingContext& cullingContext = pair.second;
@@ -220,14 +226,14 @@ namespace ad_astris::renderer::impl
 					size_t instanceCount;
 				};
 				
-				std::unordered_map<UUID, IndirectBatchMisc> indirectBatchMiscByModelUUID;
+				FlatHashMap<UUID, IndirectBatchMisc> indirectBatchMiscByModelUUID;
 				uint32_t instanceCount{ 0 };
 				size_t entityFilterHash{ 0 };
 			};
 		
 			struct SceneCullingContext : BaseCullingContext
 			{
-				std::unordered_map<ecore::CameraIndex, IndirectBuffers> indirectBuffersByCameraIndex;
+				FlatHashMap<ecore::CameraIndex, IndirectBuffers> indirectBuffersByCameraIndex;
 				
 				template<typename ...ARGS>
 				void init(const ecs::EntityFilter<ARGS...>& filter, ecore::CameraIndex cameraIndex, uint32_t cullingParamsIndex)
@@ -259,15 +265,15 @@ namespace ad_astris::renderer::impl
 
 			struct ShadowsCullingContext : BaseCullingContext
 			{
-				std::unordered_map<ecs::Entity, IndirectBuffers> indirectBuffersByLightSource;
+				FlatHashMap<ecs::Entity, IndirectBuffers> indirectBuffersByLightSource;
 				void add_light(ecs::Entity light, uint32_t cullingParamsIndex);
 			};
 
 			ecs::Entity _cameras[ecore::CAMERA_COUNT];
 			std::vector<std::unique_ptr<ecs::IEntityFilter>> _sceneEntityFilters;
-			std::unordered_map<size_t, SceneCullingContext> _sceneCullingContextByEntityFilterHash;
+			FlatHashMap<size_t, SceneCullingContext> _sceneCullingContextByEntityFilterHash;
 			std::vector<std::unique_ptr<ecs::IEntityFilter>> _shadowsEntityFilters;
-			std::unordered_map<size_t, ShadowsCullingContext> _shadowsCullingContextByEntityFilterHash;
+			FlatHashMap<size_t, ShadowsCullingContext> _shadowsCullingContextByEntityFilterHash;
 			std::unique_ptr<RendererArray<CullingParams>> _cullingParamsCpuBuffer;
 			rhi::Buffer* _cullingParamsBuffer;
 
@@ -4,6 +4,7 @@
 #include "../renderer_resource_collection.h"
 #include "../module_objects.h"
 #include "shader_interop_renderer.h"
+#include "core/flat_hash_map.h"
 
 namespace ad_astris::renderer::impl
 {
@@ -32,8 +33,8 @@ namespace ad_astris::renderer::impl
 			const std::string MATERIAL_BUFFER_NAME = "MaterialBuffer";
 		
 			std::unique_ptr<RendererResourceCollection<RendererMaterial>> _rendererMaterials{ nullptr };
-			std::unordered_map<UUID, uint32_t> _gpuOpaqueMaterialIndexByCPUMaterialUUID;
-			std::unordered_map<UUID, rhi::TextureView*> _gpuTextureViewByCPUTextureUUID;
+			FlatHashMap<UUID, uint32_t> _gpuOpaqueMaterialIndexByCPUMaterialUUID;
+			FlatHashMap<UUID, rhi::TextureView*> _gpuTextureViewByCPUTextureUUID;
 			tasks::TaskGroup _textureLoadingTaskGroup;
 			rhi::Sampler _samplers[SAMPLER_COUNT];
 		
@@ -8,7 +8,8 @@ using namespace ad_astris;
 using namespace renderer::impl;
 
 ModelSubmanager::ModelSubmanager(MaterialSubmanager* materialSubmanager, CullingSubmanager* indirectDrawingSubmanager)
-	: _materialSubmanager(materialSubmanager), _indirectDrawingSubmanager(indirectDrawingSubmanager)
+	: _materialSubmanager(materialSubmanager), _createdModels(FRAME_SCRATCH_ALLOCATOR()),
+	_indirectDrawingSubmanager(indirectDrawingSubmanager)
 {
 	subscribe_to_events();
 	_staticModelEntities.reserve(MODEL_INSTANCES_INIT_NUMBER);
@@ -23,7 +24,8 @@ void ModelSubmanager::cleanup_after_update()
 {
 	_loadedModelsVertexArraySize_F32PNTC = 0;
 	_loadedModelsIndexArraySize_F32PNTC = 0;
-	_createdModels.clear();
+	// clear() keeps the capacity, which points to the scratch memory that will be reset in the next frames
+	_createdModels = FrameVector<ecs::Entity>(FRAME_SCRATCH_ALLOCATOR());
 	_modelInstances->clear();
 }
 
@@ -5,6 +5,8 @@
 #include "material_submanager.h"
 #include "resource_manager/resource_events.h"
 #include "shader_interop_renderer.h"
+#include "core/frame_scratch_allocator.h"
+#include "core/memory_tracker.h"
 
 namespace ad_astris::renderer::impl
 {
@@ -42,20 +44,21 @@ namespace ad_astris::renderer::impl
 			void add_model(ecs::Entity entity);
 
 		private:
-			const std::string VERTEX_BUFFER_F32PNTC_NAME = "VertexBufferF32PNTC";
-			const std::string INDEX_BUFFER_F32PNTC_NAME = "IndexBufferF32PNTC";
-			const std::string OUTPUT_PLANE_VERTEX_BUFFER_NAME = "OutputPlaneBuffer";
+			const Name VERTEX_BUFFER_F32PNTC_NAME = "VertexBufferF32PNTC";
+			const Name INDEX_BUFFER_F32PNTC_NAME = "IndexBufferF32PNTC";
+			const Name OUTPUT_PLANE_VERTEX_BUFFER_NAME = "OutputPlaneBuffer";
 			const std::string MODEL_INSTANCE_BUFFER_NAME = "ModelInstanceBuffer";
 
 			MaterialSubmanager* _materialSubmanager;
 		
 			bool _areGPUBuffersAllocated{ false };
-			std::unordered_map<UUID, std::vector<ecs::Entity>> _entitiesByModelUUID;
+			FlatHashMap<UUID, std::vector<ecs::Entity>> _entitiesByModelUUID;
 
-			std::vector<uint8_t> _vertexArray_F32PNTC;		// Contains all vertices of all models with vertex format Float32 Position Normal Tangent TexCoord
-			std::vector<uint8_t> _indexArray_F32PNTC;
+			TaggedVector<uint8_t, MemoryTag::RENDERER> _vertexArray_F32PNTC;		// Contains all vertices of all models with vertex format Float32 Position Normal Tangent TexCoord
+			TaggedVector<uint8_t, MemoryTag::RENDERER> _indexArray_F32PNTC;
 
-			std::vector<ecs::Entity> _createdModels;
+			// Filled when events are dispatched at the end of the frame N and cleared after the update in the frame N + 1
+			FrameVector<ecs::Entity> _createdModels;
 			uint64_t _loadedModelsVertexArraySize_F32PNTC{ 0 };
 			uint64_t _loadedModelsIndexArraySize_F32PNTC{ 0 };
 		
@@ -458,3 +458,52 @@ bool GLTFImporter::import(
 
 	return true;
 }
+
+void GLTFImporter::collect_dependencies(const std::string& path, std::vector<std::string>& outPaths)
+{
+	constexpr uint32_t GLB_HEADER_SIZE = 12;
+	constexpr uint32_t GLB_CHUNK_HEADER_SIZE = 8;
+	constexpr uint32_t GLB_JSON_CHUNK_TYPE = 0x4E4F534A;		// "JSON"
+
+	std::vector<uint8_t> fileData;
+	io::Utils::read_file(FILE_SYSTEM(), path, fileData);
+
+	const uint8_t* jsonData = fileData.data();
+	uint64_t jsonSize = fileData.size();
+	if (io::Utils::get_file_extension(path) == "glb")
+	{
+		uint32_t chunkSize = 0, chunkType = 0;
+		if (fileData.size() < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE)
+			return;
+		memcpy(&chunkSize, fileData.data() + GLB_HEADER_SIZE, sizeof(uint32_t));
+		memcpy(&chunkType, fileData.data() + GLB_HEADER_SIZE + sizeof(uint32_t), sizeof(uint32_t));
+		if (chunkType != GLB_JSON_CHUNK_TYPE || chunkSize > fileData.size() - GLB_HEADER_SIZE - GLB_CHUNK_HEADER_SIZE)
+			return;
+		jsonData += GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+		jsonSize = chunkSize;
+	}
+
+	nlohmann::json json = nlohmann::json::parse(jsonData, jsonData + jsonSize, nullptr, false);
+	if (json.is_discarded())
+		return;
+
+	std::string baseDir = tinygltf::GetBaseDir(path);
+	for (const char* key : { "buffers", "images" })
+	{
+		auto it = json.find(key);
+		if (it == json.end() || !it->is_array())
+			continue;
+
+		for (auto& element : *it)
+		{
+			auto uriIt = element.find("uri");
+			if (uriIt == element.end() || !uriIt->is_string() || tinygltf::IsDataURI(uriIt->get<std::string>()))
+				continue;
+
+			std::string uri;
+			if (!tinygltf::URIDecode(uriIt->get<std::string>(), &uri, nullptr))
+				continue;
+			outPaths.push_back(baseDir.empty() ? uri : baseDir + "/" + uri);
+		}
+	}
+}
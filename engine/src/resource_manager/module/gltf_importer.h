@@ -13,5 +13,8 @@ namespace ad_astris::resource::impl
 				std::vector<TextureCreateInfo>& outTextureInfos,
 				std::vector<MaterialCreateInfo>& materialInfos,
 				const ecore::ModelConversionContext& conversionContext);
+
+			// Appends external buffers and images that are referenced by the model. Embedded data is skipped
+			static void collect_dependencies(const std::string& path, std::vector<std::string>& outPaths);
 	};
 }
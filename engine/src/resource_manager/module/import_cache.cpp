@@ -0,0 +1,223 @@
+#include "import_cache.h"
+#include "texture_importer.h"
+#include "engine_core/binary_metadata.h"
+#include "resource_manager/resource_formats.h"
+#include "core/global_objects.h"
+
+#include <lz4/xxhash.h>
+
+using namespace ad_astris;
+using namespace resource::impl;
+
+namespace
+{
+	constexpr uint16_t IMPORT_CACHE_VERSION = 1;
+
+	struct ImportCacheHeader
+	{
+		ecore::BinaryMetadataHeader base;
+		uint32_t modelCount{ 0 };
+		uint32_t textureCount{ 0 };
+		uint32_t materialCount{ 0 };
+	};
+
+	uint64_t hash_source_files(const std::vector<std::string>& paths)
+	{
+		// Sizes are hashed too, so missing files and empty files don't produce the same hash as other files
+		std::vector<uint64_t> hashes;
+		for (auto& path : paths)
+		{
+			io::MappedFile mappedFile = FILE_SYSTEM()->map_file(path, io::MapAccess::SEQUENTIAL);
+			hashes.push_back(mappedFile.size());
+			hashes.push_back(mappedFile.is_valid() ? XXH64(mappedFile.data(), mappedFile.size(), 0) : 0);
+		}
+		return XXH64(hashes.data(), hashes.size() * sizeof(uint64_t), 0);
+	}
+
+	std::string serialize_resource(ecore::Object& resource)
+	{
+		io::File file;
+		resource.serialize(&file);
+		io::SerializedFile serializedFile;
+		file.serialize(serializedFile);
+
+		std::string data;
+		data.reserve(serializedFile.get_size());
+		for (auto& part : serializedFile.parts)
+			data.append(static_cast<const char*>(part.data), part.size);
+		return data;
+	}
+
+	bool deserialize_resource(const std::string& data, ecore::Object& resource)
+	{
+		io::File file;
+		if (!file.deserialize(reinterpret_cast<const uint8_t*>(data.data()), data.size()) || !file.is_valid())
+			return false;
+		resource.deserialize(&file, nullptr);
+		return true;
+	}
+}
+
+ImportCache::ImportCache(const io::URI& directory, uint64_t maxSize) : _cache(directory.c_str(), maxSize)
+{
+
+}
+
+io::DerivedDataKey ImportCache::get_model_key(const io::URI& path, const ecore::ModelConversionContext& conversionContext) const
+{
+	std::vector<std::string> sourcePaths;
+	ModelImporter::collect_source_files(path, sourcePaths);
+
+	uint8_t settings[] = {
+		conversionContext.mergeMeshes,
+		conversionContext.loadTextures,
+		conversionContext.generateMaterials,
+		conversionContext.generateTangents
+	};
+
+	io::DerivedDataKey key;
+	key.sourceHash = hash_source_files(sourcePaths);
+	key.settingsHash = XXH64(settings, sizeof(settings), 0);
+	key.producerVersion = ModelImporter::VERSION;
+	key.type = static_cast<uint32_t>(ResourceType::MODEL);
+	return key;
+}
+
+io::DerivedDataKey ImportCache::get_texture_key(const io::URI& path) const
+{
+	io::DerivedDataKey key;
+	key.sourceHash = hash_source_files({ path.c_str() });
+	key.producerVersion = TextureImporter::VERSION;
+	key.type = static_cast<uint32_t>(ResourceType::TEXTURE);
+	return key;
+}
+
+bool ImportCache::load(const io::DerivedDataKey& key, ModelImportContext& outContext)
+{
+	return load(key, outContext.modelCreateInfos, outContext.textureCreateInfos, outContext.materialCreateInfos);
+}
+
+void ImportCache::store(const io::DerivedDataKey& key, const ModelImportContext& context)
+{
+	store(key, context.modelCreateInfos, context.textureCreateInfos, context.materialCreateInfos);
+}
+
+bool ImportCache::load(const io::DerivedDataKey& key, ecore::TextureInfo& outTextureInfo)
+{
+	std::vector<ModelCreateInfo> modelCreateInfos;
+	std::vector<TextureCreateInfo> textureCreateInfos;
+	std::vector<MaterialCreateInfo> materialCreateInfos;
+	if (!load(key, modelCreateInfos, textureCreateInfos, materialCreateInfos))
+		return false;
+
+	if (textureCreateInfos.size() != 1)
+	{
+		for (auto& textureCreateInfo : textureCreateInfos)
+			delete[] textureCreateInfo.info.data;
+		return false;
+	}
+	outTextureInfo = textureCreateInfos[0].info;
+	return true;
+}
+
+void ImportCache::store(const io::DerivedDataKey& key, const ecore::TextureInfo& textureInfo)
+{
+	store(key, {}, { TextureCreateInfo{ textureInfo, "" } }, {});
+}
+
+void ImportCache::store(
+	const io::DerivedDataKey& key,
+	const std::vector<ModelCreateInfo>& modelCreateInfos,
+	const std::vector<TextureCreateInfo>& textureCreateInfos,
+	const std::vector<MaterialCreateInfo>& materialCreateInfos)
+{
+	std::string data;
+	ecore::BinaryMetadataWriter writer(data);
+	ImportCacheHeader header;
+	header.modelCount = modelCreateInfos.size();
+	header.textureCount = textureCreateInfos.size();
+	header.materialCount = materialCreateInfos.size();
+	writer.write_header(header, IMPORT_CACHE_VERSION);
+
+	for (auto& modelCreateInfo : modelCreateInfos)
+	{
+		ecore::Model model(modelCreateInfo.info, nullptr);
+		writer.write_string(modelCreateInfo.name);
+		writer.write_string(serialize_resource(model));
+	}
+
+	for (auto& textureCreateInfo : textureCreateInfos)
+	{
+		if (!textureCreateInfo.info.data)
+			return;
+		// Data still belongs to the importer, so the texture gives it back instead of freeing it
+		ecore::Texture texture(textureCreateInfo.info, nullptr);
+		writer.write_string(textureCreateInfo.name);
+		writer.write_string(serialize_resource(texture));
+		texture.detach_info();
+	}
+
+	for (auto& materialCreateInfo : materialCreateInfos)
+		writer.write_string(materialCreateInfo.name);
+
+	_cache.store(key, data.data(), data.size());
+}
+
+bool ImportCache::load(
+	const io::DerivedDataKey& key,
+	std::vector<ModelCreateInfo>& outModelCreateInfos,
+	std::vector<TextureCreateInfo>& outTextureCreateInfos,
+	std::vector<MaterialCreateInfo>& outMaterialCreateInfos)
+{
+	std::string data;
+	if (!_cache.load(key, data))
+		return false;
+
+	ecore::BinaryMetadataReader reader(data);
+	ImportCacheHeader header;
+	if (!reader.read_header(header, IMPORT_CACHE_VERSION))
+		return false;
+
+	std::vector<ModelCreateInfo> modelCreateInfos(header.modelCount);
+	std::vector<TextureCreateInfo> textureCreateInfos;
+	std::vector<MaterialCreateInfo> materialCreateInfos(header.materialCount);
+	bool isValid = true;
+	std::string resourceData;
+
+	for (uint32_t i = 0; isValid && i != header.modelCount; ++i)
+	{
+		ecore::Model model;
+		isValid = reader.read_string(modelCreateInfos[i].name)
+			&& reader.read_string(resourceData)
+			&& deserialize_resource(resourceData, model);
+		modelCreateInfos[i].info = model.copy_info();
+	}
+
+	for (uint32_t i = 0; isValid && i != header.textureCount; ++i)
+	{
+		ecore::Texture texture;
+		TextureCreateInfo& textureCreateInfo = textureCreateInfos.emplace_back();
+		isValid = reader.read_string(textureCreateInfo.name)
+			&& reader.read_string(resourceData)
+			&& deserialize_resource(resourceData, texture);
+		// Data is owned by the create info until the texture is added to the resource table
+		textureCreateInfo.info = texture.detach_info();
+	}
+
+	for (uint32_t i = 0; isValid && i != header.materialCount; ++i)
+		isValid = reader.read_string(materialCreateInfos[i].name);
+
+	if (!isValid)
+	{
+		LOG_ERROR("ImportCache::load(): Cached import is invalid, the source is imported again")
+		for (auto& textureCreateInfo : textureCreateInfos)
+			delete[] textureCreateInfo.info.data;
+		_cache.remove(key);
+		return false;
+	}
+
+	outModelCreateInfos.insert(outModelCreateInfos.end(), modelCreateInfos.begin(), modelCreateInfos.end());
+	outTextureCreateInfos.insert(outTextureCreateInfos.end(), textureCreateInfos.begin(), textureCreateInfos.end());
+	outMaterialCreateInfos.insert(outMaterialCreateInfos.end(), materialCreateInfos.begin(), materialCreateInfos.end());
+	return true;
+}
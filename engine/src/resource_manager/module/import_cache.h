@@ -0,0 +1,42 @@
+#pragma once
+
+#include "model_importer.h"
+#include "file_system/derived_data_cache.h"
+
+namespace ad_astris::resource::impl
+{
+	// Stores results of model and texture imports in the derived data cache, so sources that were imported
+	// with the same settings and importer versions are not decoded again. Resources are stored as serialized
+	// resource files. Materials are stored by name because MaterialInfo has no data yet
+	class ImportCache
+	{
+		public:
+			ImportCache(const io::URI& directory, uint64_t maxSize);
+
+			// Keys hash the contents of the source files, so touching or moving a file doesn't invalidate its entry
+			io::DerivedDataKey get_model_key(const io::URI& path, const ecore::ModelConversionContext& conversionContext) const;
+			io::DerivedDataKey get_texture_key(const io::URI& path) const;
+
+			bool load(const io::DerivedDataKey& key, ModelImportContext& outContext);
+			void store(const io::DerivedDataKey& key, const ModelImportContext& context);
+			// The caller owns data of the texture info
+			bool load(const io::DerivedDataKey& key, ecore::TextureInfo& outTextureInfo);
+			void store(const io::DerivedDataKey& key, const ecore::TextureInfo& textureInfo);
+
+			io::DerivedDataCache& get_cache() { return _cache; }
+
+		private:
+			io::DerivedDataCache _cache;
+
+			void store(
+				const io::DerivedDataKey& key,
+				const std::vector<ModelCreateInfo>& modelCreateInfos,
+				const std::vector<TextureCreateInfo>& textureCreateInfos,
+				const std::vector<MaterialCreateInfo>& materialCreateInfos);
+			bool load(
+				const io::DerivedDataKey& key,
+				std::vector<ModelCreateInfo>& outModelCreateInfos,
+				std::vector<TextureCreateInfo>& outTextureCreateInfos,
+				std::vector<MaterialCreateInfo>& outMaterialCreateInfos);
+	};
+}
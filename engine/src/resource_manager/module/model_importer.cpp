@@ -11,47 +11,62 @@ ModelImportContext::ModelImportContext(void* conversionContext)
 	this->conversionContext = static_cast<ecore::ModelConversionContext*>(conversionContext);
 }
 
+void ModelImportContext::destroy_texture_data()
+{
+	for (auto& textureCreateInfo : textureCreateInfos)
+	{
+		delete[] textureCreateInfo.info.data;
+		textureCreateInfo.info.data = nullptr;
+	}
+}
+
 bool ModelImporter::import(const io::URI& path, ModelImportContext& context)
 {
 	const std::string extension = io::Utils::get_file_extension(path);
+	bool isImported = true;
 	if (extension == "gltf" || extension == "glb")
 	{
-		if (!GLTFImporter::import(
+		isImported = GLTFImporter::import(
 			path.c_str(),
 			context.modelCreateInfos,
 			context.textureCreateInfos,
 			context.materialCreateInfos,
-			*context.conversionContext))
-		{
-			LOG_ERROR("ResourceManager::convert_to_engine_format(): Failed to import 3D model {}", path.c_str())
-			return false;
-		}
+			*context.conversionContext);
 	}
 	else if (extension == "obj")
 	{
-		if (!OBJImporter::import(
+		isImported = OBJImporter::import(
 			path.c_str(),
 			context.modelCreateInfos,
 			context.textureCreateInfos,
 			context.materialCreateInfos,
-			*context.conversionContext))
-		{
-			LOG_ERROR("ResourceManager::convert_to_engine_format(): Failed to import 3D model {}", path.c_str())
-			return false;
-		}
+			*context.conversionContext);
 	}
 	else if (extension == "fbx")
 	{
-		if (!FBXImporter::import(
+		isImported = FBXImporter::import(
 			path.c_str(),
 			context.modelCreateInfos,
 			context.textureCreateInfos,
 			context.materialCreateInfos,
-			*context.conversionContext))
-		{
-			LOG_ERROR("ResourceManager::convert_to_engine_format(): Failed to import 3D model {}", path.c_str())
-			return false;
-		}
+			*context.conversionContext);
+	}
+
+	if (!isImported)
+	{
+		// Textures that were imported before the failure are not added to the table
+		LOG_ERROR("ResourceManager::convert_to_engine_format(): Failed to import 3D model {}", path.c_str())
+		context.destroy_texture_data();
+		return false;
 	}
 	return true;
 }
+
+void ModelImporter::collect_source_files(const io::URI& path, std::vector<std::string>& outPaths)
+{
+	outPaths.push_back(path.c_str());
+	// OBJ materials are not imported yet, so .mtl files don't affect the result
+	const std::string extension = io::Utils::get_file_extension(path);
+	if (extension == "gltf" || extension == "glb")
+		GLTFImporter::collect_dependencies(path.c_str(), outPaths);
+}
@@ -7,6 +7,10 @@ namespace ad_astris::resource::impl
 	struct ModelImportContext
 	{
 		ModelImportContext(void* conversionContext);
+
+		// Texture data is owned by create infos until textures are created from them, so data of a failed
+		// import must be destroyed
+		void destroy_texture_data();
 		
 		std::vector<ModelCreateInfo> modelCreateInfos;
 		std::vector<TextureCreateInfo> textureCreateInfos;
@@ -17,6 +21,11 @@ namespace ad_astris::resource::impl
 	class ModelImporter
 	{
 		public:
+			// Must be increased when the importers change their output, so cached imports are not used
+			static constexpr uint32_t VERSION = 1;
+
 			static bool import(const io::URI& path, ModelImportContext& context);
+			// Appends the model file and files that it references, the import result depends on all of them
+			static void collect_source_files(const io::URI& path, std::vector<std::string>& outPaths);
 	};
 }
\ No newline at end of file
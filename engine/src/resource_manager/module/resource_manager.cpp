@@ -1,9 +1,17 @@
 #include "resource_manager.h"
 #include "model_importer.h"
 #include "texture_importer.h"
+#include "import_cache.h"
 #include "resource_manager/utils.h"
 #include "resource_manager/resource_events.h"
 #include "core/global_objects.h"
+#include "core/timer.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
 
 using namespace ad_astris;
 using namespace resource;
@@ -30,21 +38,33 @@ void impl::ResourceManager::init()
 {
 	_resourcePool = std::make_unique<ResourcePool>();
 	_resourceTable = std::make_unique<ResourceTable>(_resourcePool.get());
+	_importCache = std::make_unique<ImportCache>(
+		FILE_SYSTEM()->get_project_root_path() + "/intermediate/derived_data_cache",
+		io::DEFAULT_DERIVED_DATA_CACHE_SIZE);
 	TextureImporter::init();
+	if (PROFILER_INSTANCE())
+		PROFILER_INSTANCE()->set_resource_residency_provider(_resourceTable.get());
 }
 
 void impl::ResourceManager::cleanup()
 {
+	if (PROFILER_INSTANCE())
+		PROFILER_INSTANCE()->set_resource_residency_provider(nullptr);
+	_resourceTable->wait_for_loads();
 	_resourcePool->cleanup();
 }
 
 template<typename Resource>
 constexpr ResourceType get_resource_type()
 {
-	if constexpr (std::is_same_v<ResourceType, ecore::Model>)
+	if constexpr (std::is_same_v<Resource, ecore::Model>)
 		return ResourceType::MODEL;
-	if constexpr (std::is_same_v<ResourceType, ecore::Texture>)
+	if constexpr (std::is_same_v<Resource, ecore::Texture>)
 		return ResourceType::TEXTURE;
+	if constexpr (std::is_same_v<Resource, ecore::Material>)
+		return ResourceType::MATERIAL;
+	if constexpr (std::is_same_v<Resource, ecore::Font>)
+		return ResourceType::FONT;
 	return ResourceType::UNDEFINED;
 }
 
@@ -81,7 +101,9 @@ UUID add_resource_to_table(
 	impl::ResourceTable* resourceTable,
 	const ResourceInfo& resourceInfo,
 	const std::string& resourceName,
-	const io::URI& engineResourcePath)
+	const io::URI& engineResourcePath,
+	std::vector<impl::ResourceDesc>* outUnsavedResourceDescs,
+	bool areEventsEnqueued)
 {
 	constexpr ResourceType resourceType = get_resource_type<Resource>();
 	
@@ -93,9 +115,21 @@ UUID add_resource_to_table(
 		{
 			case resourceType:
 			{
-				Resource* resource = static_cast<Resource*>(resourceDesc->resource);
+				// Resources of the table that were not loaded yet are loaded to keep their UUIDs. Unsaved resources
+				// are referenced, so they are not evicted by the memory budget before they are saved
+				Resource* resource = outUnsavedResourceDescs
+					? resourceTable->acquire_resource<Resource>(uuid, resourceType)
+					: resourceTable->load_resource<Resource>(uuid, resourceType);
+				if (!resource)
+				{
+					LOG_ERROR("ResourceManager::add_resource_to_table(): Failed to load resource {} to recreate it", resourceName)
+					return {};
+				}
 				resource->set_info(resourceInfo);
-				enqueue_event<Resource, EventType::RECREATE>(resource);
+				if (areEventsEnqueued)
+					enqueue_event<Resource, EventType::RECREATE>(resource);
+				if (outUnsavedResourceDescs)
+					outUnsavedResourceDescs->push_back(*resourceTable->get_resource_desc(uuid));
 				return uuid;
 			}
 			default:
@@ -108,13 +142,21 @@ UUID add_resource_to_table(
 
 	impl::ResourceDesc resourceDesc;
 	resourceDesc.type = resourceType;
-	resourceDesc.resourceName = resourceTable->get_resource_pool()->allocate<ecore::ObjectName>(resourceName.c_str());
+	resourceDesc.resourceName = resourceTable->allocate_resource_name(resourceName);
 	resourceDesc.path = engineResourcePath + "/" + resourceDesc.resourceName->get_full_name() + ".aares";
 	resourceDesc.resource = resourceTable->get_resource_pool()->allocate<Resource>(resourceInfo, resourceDesc.resourceName);
 	resourceDesc.resource->make_dirty();
-	enqueue_event<Resource, EventType::CREATE>(resourceDesc.resource);
-	resourceTable->add_resource(resourceDesc);
-	resourceTable->save_resource(resourceDesc.resource->get_uuid());
+	if (!resourceTable->add_resource(resourceDesc, outUnsavedResourceDescs != nullptr))
+	{
+		resourceTable->get_resource_pool()->free(static_cast<Resource*>(resourceDesc.resource));
+		return {};
+	}
+	if (areEventsEnqueued)
+		enqueue_event<Resource, EventType::CREATE>(resourceDesc.resource);
+	if (outUnsavedResourceDescs)
+		outUnsavedResourceDescs->push_back(resourceDesc);
+	else
+		resourceTable->save_resource(resourceDesc.resource->get_uuid());
 	return resourceDesc.resource->get_uuid();
 }
 
@@ -122,17 +164,227 @@ std::vector<UUID> impl::ResourceManager::convert_to_engine_format(
 	const io::URI& originalResourcePath,
 	const io::URI& engineResourcePath,
 	void* conversionContext)
+{
+	ResourceType resourceType = get_source_resource_type(originalResourcePath);
+	if (resourceType == ResourceType::UNDEFINED)
+		return {};
+
+	ImportedSource importedSource;
+	if (!import_source(originalResourcePath, resourceType, conversionContext, importedSource))
+		return {};
+	return add_imported_resources(importedSource, originalResourcePath, engineResourcePath);
+}
+
+experimental::ResourceImportResult impl::ResourceManager::import_resources(
+	const std::vector<experimental::ResourceImportRequest>& requests,
+	const experimental::ResourceImportSettings& settings,
+	const experimental::ResourceImportProgressCallback& progressCallback)
+{
+	struct SourceState
+	{
+		ImportedSource importedSource;
+		std::vector<ResourceDesc> resourceDescs;		// Added to the table and written by the write task
+		std::vector<uint8_t> areWritten;				// Resources that failed to be written stay dirty
+		uint64_t sourceSize{ 0 };
+		uint64_t inFlightSize{ 0 };
+		uint64_t writtenSize{ 0 };
+		bool isImported{ false };
+	};
+
+	experimental::ResourceImportResult result;
+	experimental::ResourceImportProgress& progress = result.progress;
+	progress.sourceCount = requests.size();
+	std::vector<SourceState> sources(requests.size());
+
+	// Tasks report completed stages, the calling thread adds resources to the table and starts next stages
+	std::mutex mutex;
+	std::condition_variable completionCondition;
+	std::vector<uint32_t> decodedSources;
+	std::vector<uint32_t> writtenSources;
+	tasks::TaskGroup decodeTaskGroup;
+	tasks::TaskGroup writeTaskGroup;
+	std::unordered_multiset<std::string> resourceNamesInWrite;
+	uint64_t inFlightSize = 0;
+	uint32_t nextSourceIndex = 0;
+	uint32_t activeSourceCount = 0;
+	Timer timer;
+
+	auto complete_source = [&](SourceState& source)
+	{
+		inFlightSize -= source.inFlightSize;
+		--activeSourceCount;
+		++progress.completedSourceCount;
+		progress.sourceSize += source.sourceSize;
+		progress.elapsedSeconds = timer.elapsed_seconds();
+		if (progressCallback)
+			progressCallback(progress);
+	};
+
+	auto take_completed_sources = [&](std::vector<uint32_t>& completedSources, std::vector<uint32_t>& outSources)
+	{
+		outSources.insert(outSources.end(), completedSources.begin(), completedSources.end());
+		completedSources.clear();
+	};
+
+	auto finish_written_sources = [&](std::vector<uint32_t>& writtenSourceIndices)
+	{
+		for (uint32_t sourceIndex : writtenSourceIndices)
+		{
+			SourceState& source = sources[sourceIndex];
+			for (size_t i = 0; i != source.resourceDescs.size(); ++i)
+			{
+				ResourceDesc& resourceDesc = source.resourceDescs[i];
+				auto it = resourceNamesInWrite.find(resourceDesc.resourceName->get_full_name());
+				if (it != resourceNamesInWrite.end())
+					resourceNamesInWrite.erase(it);
+				bool isWritten = source.areWritten[i];
+				if (!isWritten)
+					resourceDesc.resource->make_dirty();
+				// The resource can be evicted when its reference is released
+				UUID uuid = resourceDesc.resource->get_uuid();
+				_resourceTable->release_reference(uuid);
+				if (settings.areResourcesUnloaded && isWritten)
+					_resourceTable->unload_resource(uuid);
+			}
+			progress.writtenResourceCount += source.resourceDescs.size();
+			progress.writtenSize += source.writtenSize;
+			source.resourceDescs.clear();
+			complete_source(source);
+		}
+		writtenSourceIndices.clear();
+	};
+
+	std::vector<uint32_t> decoded;
+	std::vector<uint32_t> written;
+	while (progress.completedSourceCount != progress.sourceCount)
+	{
+		// Decoded size is unknown before decoding, so the source size is reserved and corrected
+		// after resources are added to the table. A source larger than the limit is imported alone
+		while (nextSourceIndex != requests.size())
+		{
+			SourceState& source = sources[nextSourceIndex];
+			std::error_code errorCode;
+			source.sourceSize = std::filesystem::file_size(requests[nextSourceIndex].originalResourcePath.c_str(), errorCode);
+			if (errorCode)
+				source.sourceSize = 0;
+			if (activeSourceCount && inFlightSize + source.sourceSize > settings.maxInFlightSize)
+				break;
+			
+			source.inFlightSize = source.sourceSize;
+			inFlightSize += source.inFlightSize;
+			++activeSourceCount;
+
+			TASK_COMPOSER()->execute(decodeTaskGroup, [&, sourceIndex = nextSourceIndex++](tasks::TaskExecutionInfo)
+			{
+				const experimental::ResourceImportRequest& request = requests[sourceIndex];
+				SourceState& source = sources[sourceIndex];
+				ResourceType resourceType = get_source_resource_type(request.originalResourcePath);
+				void* conversionContext = const_cast<ecore::ModelConversionContext*>(&request.modelConversionContext);
+				source.isImported = resourceType != ResourceType::UNDEFINED
+					&& import_source(request.originalResourcePath, resourceType, conversionContext, source.importedSource);
+
+				std::scoped_lock<std::mutex> lock(mutex);
+				decodedSources.push_back(sourceIndex);
+				completionCondition.notify_one();
+			});
+		}
+		progress.peakInFlightSize = std::max(progress.peakInFlightSize, inFlightSize);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			completionCondition.wait(lock, [&]() { return !decodedSources.empty() || !writtenSources.empty(); });
+			take_completed_sources(decodedSources, decoded);
+			take_completed_sources(writtenSources, written);
+		}
+
+		for (uint32_t sourceIndex : decoded)
+		{
+			const experimental::ResourceImportRequest& request = requests[sourceIndex];
+			SourceState& source = sources[sourceIndex];
+			if (!source.isImported)
+			{
+				LOG_ERROR("ResourceManager::import_resources(): Failed to import {}", request.originalResourcePath.c_str())
+				++progress.failedSourceCount;
+				complete_source(source);
+				continue;
+			}
+
+			// A resource that is imported again is recreated, so the previous write of the resource must be finished
+			// and the resource must not be unloaded after it is recreated
+			std::vector<std::string> resourceNames = get_resource_names(source.importedSource, request.originalResourcePath);
+			auto is_in_write = [&](const std::string& name) { return resourceNamesInWrite.count(name) != 0; };
+			if (std::any_of(resourceNames.begin(), resourceNames.end(), is_in_write))
+			{
+				TASK_COMPOSER()->wait(writeTaskGroup);
+				{
+					std::scoped_lock<std::mutex> lock(mutex);
+					take_completed_sources(writtenSources, written);
+				}
+				finish_written_sources(written);
+			}
+
+			std::vector<UUID> uuids = add_imported_resources(
+				source.importedSource,
+				request.originalResourcePath,
+				request.engineResourcePath,
+				&source.resourceDescs,
+				!settings.areResourcesUnloaded);
+			result.uuids.insert(result.uuids.end(), uuids.begin(), uuids.end());
+			if (source.importedSource.isCached)
+				++progress.cachedSourceCount;
+			source.importedSource = ImportedSource();
+
+			uint64_t resourceSize = 0;
+			for (auto& resourceDesc : source.resourceDescs)
+			{
+				resourceSize += resourceDesc.resource->get_size();
+				resourceNamesInWrite.insert(resourceDesc.resourceName->get_full_name());
+				// Written by the task below, so the next save_resources() doesn't write it again
+				resourceDesc.resource->clear_dirty();
+			}
+			source.areWritten.assign(source.resourceDescs.size(), 0);
+			inFlightSize = inFlightSize - source.inFlightSize + resourceSize;
+			source.inFlightSize = resourceSize;
+			progress.peakInFlightSize = std::max(progress.peakInFlightSize, inFlightSize);
+
+			TASK_COMPOSER()->execute(writeTaskGroup, [&, sourceIndex](tasks::TaskExecutionInfo)
+			{
+				SourceState& source = sources[sourceIndex];
+				for (size_t i = 0; i != source.resourceDescs.size(); ++i)
+				{
+					uint64_t writtenSize = ResourceTable::write_resource(source.resourceDescs[i]);
+					source.areWritten[i] = writtenSize != 0;
+					source.writtenSize += writtenSize;
+				}
+
+				std::scoped_lock<std::mutex> lock(mutex);
+				writtenSources.push_back(sourceIndex);
+				completionCondition.notify_one();
+			});
+		}
+		decoded.clear();
+
+		finish_written_sources(written);
+	}
+
+	TASK_COMPOSER()->wait(decodeTaskGroup);
+	TASK_COMPOSER()->wait(writeTaskGroup);
+	progress.elapsedSeconds = timer.elapsed_seconds();
+	return result;
+}
+
+ResourceType impl::ResourceManager::get_source_resource_type(const io::URI& originalResourcePath) const
 {
 	if (!io::Utils::exists(FILE_SYSTEM(), originalResourcePath))
 	{
 		LOG_ERROR("ResourceManager::convert_to_engine_format(): No file with path {}", originalResourcePath.c_str())
-		return {};
+		return ResourceType::UNDEFINED;
 	}
 
 	if (io::Utils::is_relative(originalResourcePath))
 	{
 		LOG_ERROR("ResourceManager::convert_to_engine_format(): Can't use relative path {}", originalResourcePath.c_str())
-		return {};
+		return ResourceType::UNDEFINED;
 	}
 	
 	ResourceType resourceType{ ResourceType::UNDEFINED };
@@ -148,27 +400,112 @@ std::vector<UUID> impl::ResourceManager::convert_to_engine_format(
 	else if (is_sound_format_supported(extension))
 		resourceType = ResourceType::SOUND;
 
-	std::vector<UUID> outputUUIDs;
+	if (resourceType != ResourceType::MODEL && resourceType != ResourceType::TEXTURE && resourceType != ResourceType::FONT)
+	{
+		LOG_ERROR("ResourceManager::convert_to_engine_format(): Resource with type {} can't be converted to engine format", Utils::get_str_resource_type(resourceType))
+		return ResourceType::UNDEFINED;
+	}
+	return resourceType;
+}
 
-	switch (resourceType)
+bool impl::ResourceManager::import_source(
+	const io::URI& originalResourcePath,
+	ResourceType type,
+	void* conversionContext,
+	ImportedSource& outSource)
+{
+	outSource.type = type;
+	bool isImportCacheEnabled = _isImportCacheEnabled.load();
+	io::DerivedDataKey importKey;
+
+	switch (type)
 	{
 		case ResourceType::MODEL:
 		{
 			if (!conversionContext)
 			{
 				LOG_ERROR("ResourceManager::convert_to_engine_format(): ModelConversionContext is nullptr")
-				return {};
+				return false;
+			}
+			outSource.modelImportContext = std::make_unique<ModelImportContext>(conversionContext);
+			ModelImportContext& importContext = *outSource.modelImportContext;
+			if (isImportCacheEnabled)
+			{
+				importKey = _importCache->get_model_key(originalResourcePath, *importContext.conversionContext);
+				outSource.isCached = _importCache->load(importKey, importContext);
+			}
+			if (!outSource.isCached)
+			{
+				if (!ModelImporter::import(originalResourcePath, importContext))
+					return false;
+				if (isImportCacheEnabled)
+					_importCache->store(importKey, importContext);
+			}
+			return true;
+		}
+		case ResourceType::TEXTURE:
+		{
+			if (isImportCacheEnabled)
+			{
+				importKey = _importCache->get_texture_key(originalResourcePath);
+				outSource.isCached = _importCache->load(importKey, outSource.textureInfo);
+			}
+			if (!outSource.isCached)
+			{
+				TextureImporter::import(originalResourcePath.c_str(), outSource.textureInfo);
+				if (!outSource.textureInfo.data)
+				{
+					LOG_ERROR("ResourceManager::import_source(): Failed to decode texture {}", originalResourcePath.c_str())
+					return false;
+				}
+				if (isImportCacheEnabled)
+					_importCache->store(importKey, outSource.textureInfo);
 			}
-			ModelImportContext importContext(conversionContext);
-			ModelImporter::import(originalResourcePath, importContext);
+			return true;
+		}
+		case ResourceType::FONT:
+		{
+			io::MappedFile mappedFile = FILE_SYSTEM()->map_file(originalResourcePath, io::MapAccess::SEQUENTIAL);
+			if (!mappedFile.is_valid())
+			{
+				LOG_ERROR("ResourceManager::import_source(): Failed to map font file {}", originalResourcePath.c_str())
+				return false;
+			}
+			outSource.fontInfo.init(mappedFile.data(), mappedFile.size());
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
 
+std::vector<UUID> impl::ResourceManager::add_imported_resources(
+	ImportedSource& source,
+	const io::URI& originalResourcePath,
+	const io::URI& engineResourcePath,
+	std::vector<ResourceDesc>* outUnsavedResourceDescs,
+	bool areEventsEnqueued)
+{
+	std::vector<UUID> outputUUIDs;
+	std::vector<std::string> resourceNames = get_resource_names(source, originalResourcePath);
+	auto name = resourceNames.begin();
+
+	switch (source.type)
+	{
+		case ResourceType::MODEL:
+		{
+			ModelImportContext& importContext = *source.modelImportContext;
 			for (auto& modelInfo : importContext.modelCreateInfos)
 			{
 				outputUUIDs.push_back(add_resource_to_table<ecore::Model>(
 					_resourceTable.get(),
 					modelInfo.info,
-					modelInfo.name.empty() ? io::Utils::get_file_name(originalResourcePath) : modelInfo.name,
-					engineResourcePath));
+					*name++,
+					engineResourcePath,
+					outUnsavedResourceDescs,
+					areEventsEnqueued));
 			}
 
 			for (auto& textureInfo : importContext.textureCreateInfos)
@@ -176,8 +513,10 @@ std::vector<UUID> impl::ResourceManager::convert_to_engine_format(
 				outputUUIDs.push_back(add_resource_to_table<ecore::Texture>(
 					_resourceTable.get(),
 					textureInfo.info,
-					textureInfo.name,
-					engineResourcePath));
+					*name++,
+					engineResourcePath,
+					outUnsavedResourceDescs,
+					areEventsEnqueued));
 			}
 			
 			for (auto& materialInfo : importContext.materialCreateInfos)
@@ -185,62 +524,66 @@ std::vector<UUID> impl::ResourceManager::convert_to_engine_format(
 				outputUUIDs.push_back(add_resource_to_table<ecore::Material>(
 					_resourceTable.get(),
 					materialInfo.info,
-					materialInfo.name,
-					engineResourcePath));
+					*name++,
+					engineResourcePath,
+					outUnsavedResourceDescs,
+					areEventsEnqueued));
 			}
-
 			break;
 		}
 		case ResourceType::TEXTURE:
 		{
-			ecore::TextureInfo textureInfo;
-			TextureImporter::import(originalResourcePath.c_str(), textureInfo);
 			outputUUIDs.push_back(add_resource_to_table<ecore::Texture>(
 				_resourceTable.get(),
-				textureInfo,
-				io::Utils::get_file_name(originalResourcePath),
-				engineResourcePath));
-			break;
-		}
-		case ResourceType::VIDEO:
-		{
-			// TODO
+				source.textureInfo,
+				*name,
+				engineResourcePath,
+				outUnsavedResourceDescs,
+				areEventsEnqueued));
 			break;
 		}
 		case ResourceType::FONT:
 		{
-			size_t size = 0;
-			uint8_t* data = static_cast<uint8_t*>(FILE_SYSTEM()->map_to_read(originalResourcePath, size));
-			
-			ecore::FontInfo fontInfo;
-			fontInfo.init(data, size);
 			outputUUIDs.push_back(add_resource_to_table<ecore::Font>(
 				_resourceTable.get(),
-				fontInfo,
-				io::Utils::get_file_name(originalResourcePath),
-				engineResourcePath));
-			
-			FILE_SYSTEM()->unmap_after_reading(data);
-			break;
-		}
-		case ResourceType::SOUND:
-		{
-			// TODO
+				source.fontInfo,
+				*name,
+				engineResourcePath,
+				outUnsavedResourceDescs,
+				areEventsEnqueued));
 			break;
 		}
 		default:
 		{
-			LOG_ERROR("ResourceManager::convert_to_engine_format(): Resource with type {} can't be converted to engine format", Utils::get_str_resource_type(resourceType))
-			return {};
+			break;
 		}
 	}
 	
 	return outputUUIDs;
 }
 
+std::vector<std::string> impl::ResourceManager::get_resource_names(const ImportedSource& source, const io::URI& originalResourcePath)
+{
+	std::vector<std::string> resourceNames;
+	if (source.type != ResourceType::MODEL)
+	{
+		resourceNames.push_back(io::Utils::get_file_name(originalResourcePath));
+		return resourceNames;
+	}
+
+	ModelImportContext& importContext = *source.modelImportContext;
+	for (auto& modelInfo : importContext.modelCreateInfos)
+		resourceNames.push_back(modelInfo.name.empty() ? io::Utils::get_file_name(originalResourcePath) : modelInfo.name);
+	for (auto& textureInfo : importContext.textureCreateInfos)
+		resourceNames.push_back(textureInfo.name);
+	for (auto& materialInfo : importContext.materialCreateInfos)
+		resourceNames.push_back(materialInfo.name);
+	return resourceNames;
+}
+
 void impl::ResourceManager::save_resources() const
 {
-	_resourceTable->save_config();
+	_resourceTable->save_index();
 	_resourceTable->save_resources();
 }
 
@@ -279,10 +622,14 @@ ResourceAccessor<ecore::Level> impl::ResourceManager::create_level(const ecore::
 	ResourceDesc resourceDesc;
 	resourceDesc.type = ResourceType::LEVEL;
 	resourceDesc.path = createInfo.path + "/" + createInfo.name + ".aalevel";
-	resourceDesc.resourceName = _resourcePool->allocate<ecore::ObjectName>(createInfo.name.c_str());
+	resourceDesc.resourceName = _resourceTable->allocate_resource_name(createInfo.name);
 	ecore::LevelInfo levelInfo;
 	resourceDesc.resource = _resourcePool->allocate<ecore::Level>(levelInfo, resourceDesc.resourceName);
-	_resourceTable->add_resource(resourceDesc);
+	if (!_resourceTable->add_resource(resourceDesc))
+	{
+		_resourcePool->free(static_cast<ecore::Level*>(resourceDesc.resource));
+		return nullptr;
+	}
 	_resourceTable->save_resource(resourceDesc.resource->get_uuid());
 	return resourceDesc.resource;
 }
@@ -292,9 +639,13 @@ ResourceAccessor<ecore::MaterialTemplate> impl::ResourceManager::create_material
 	ResourceDesc resourceDesc;
 	resourceDesc.type = ResourceType::MATERIAL_TEMPLATE;
 	resourceDesc.path = createInfo.resourceFolderPath + "/" + createInfo.name + ".aares";
-	resourceDesc.resourceName = _resourcePool->allocate<ecore::ObjectName>(createInfo.name.c_str());
+	resourceDesc.resourceName = _resourceTable->allocate_resource_name(createInfo.name);
 	resourceDesc.resource = _resourcePool->allocate<ecore::MaterialTemplate>(createInfo, resourceDesc.resourceName);
-	_resourceTable->add_resource(resourceDesc);
+	if (!_resourceTable->add_resource(resourceDesc))
+	{
+		_resourcePool->free(static_cast<ecore::MaterialTemplate*>(resourceDesc.resource));
+		return nullptr;
+	}
 	_resourceTable->save_resource(resourceDesc.resource->get_uuid());
 	return resourceDesc.resource;
 }
@@ -399,6 +750,124 @@ ResourceAccessor<ecore::Sound> impl::ResourceManager::get_sound(const std::strin
 	return _resourceTable->load_resource<ecore::Sound>(get_resource_uuid(soundName), ResourceType::SOUND);
 }
 
+ResourceLoadHandle<ecore::Model> impl::ResourceManager::load_model_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Model>(uuid, ResourceType::MODEL, priority);
+}
+
+ResourceLoadHandle<ecore::Texture> impl::ResourceManager::load_texture_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Texture>(uuid, ResourceType::TEXTURE, priority);
+}
+
+ResourceLoadHandle<ecore::Level> impl::ResourceManager::load_level_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Level>(uuid, ResourceType::LEVEL, priority);
+}
+
+ResourceLoadHandle<ecore::Material> impl::ResourceManager::load_material_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Material>(uuid, ResourceType::MATERIAL, priority);
+}
+
+ResourceLoadHandle<ecore::MaterialTemplate> impl::ResourceManager::load_material_template_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::MaterialTemplate>(uuid, ResourceType::MATERIAL_TEMPLATE, priority);
+}
+
+ResourceLoadHandle<ecore::Script> impl::ResourceManager::load_script_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Script>(uuid, ResourceType::SCRIPT, priority);
+}
+
+ResourceLoadHandle<ecore::Video> impl::ResourceManager::load_video_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Video>(uuid, ResourceType::VIDEO, priority);
+}
+
+ResourceLoadHandle<ecore::Font> impl::ResourceManager::load_font_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Font>(uuid, ResourceType::FONT, priority);
+}
+
+ResourceLoadHandle<ecore::Sound> impl::ResourceManager::load_sound_async(UUID uuid, ResourceLoadPriority priority) const
+{
+	return _resourceTable->load_resource_async<ecore::Sound>(uuid, ResourceType::SOUND, priority);
+}
+
+void impl::ResourceManager::set_blob_views_enabled(ResourceType type, bool isEnabled)
+{
+	_resourceTable->set_blob_views_enabled(type, isEnabled);
+}
+
+void impl::ResourceManager::set_import_cache_enabled(bool isEnabled)
+{
+	_isImportCacheEnabled.store(isEnabled);
+}
+
+void impl::ResourceManager::set_import_cache_max_size(uint64_t maxSize)
+{
+	_importCache->get_cache().set_max_size(maxSize);
+}
+
+io::DerivedDataCacheStatistics impl::ResourceManager::get_import_cache_statistics() const
+{
+	return _importCache->get_cache().get_statistics();
+}
+
+void* impl::ResourceManager::acquire_resource(UUID uuid, ResourceType type)
+{
+	switch (type)
+	{
+		case ResourceType::MODEL:
+			return _resourceTable->acquire_resource<ecore::Model>(uuid, type);
+		case ResourceType::TEXTURE:
+			return _resourceTable->acquire_resource<ecore::Texture>(uuid, type);
+		case ResourceType::LEVEL:
+			return _resourceTable->acquire_resource<ecore::Level>(uuid, type);
+		case ResourceType::MATERIAL:
+			return _resourceTable->acquire_resource<ecore::Material>(uuid, type);
+		case ResourceType::MATERIAL_TEMPLATE:
+			return _resourceTable->acquire_resource<ecore::MaterialTemplate>(uuid, type);
+		case ResourceType::SCRIPT:
+			return _resourceTable->acquire_resource<ecore::Script>(uuid, type);
+		case ResourceType::VIDEO:
+			return _resourceTable->acquire_resource<ecore::Video>(uuid, type);
+		case ResourceType::FONT:
+			return _resourceTable->acquire_resource<ecore::Font>(uuid, type);
+		case ResourceType::SOUND:
+			return _resourceTable->acquire_resource<ecore::Sound>(uuid, type);
+		default:
+			LOG_ERROR("ResourceManager::acquire_resource(): Resource with type {} can't be acquired", Utils::get_str_resource_type(type))
+			return nullptr;
+	}
+}
+
+void impl::ResourceManager::add_resource_reference(UUID uuid)
+{
+	_resourceTable->add_reference(uuid);
+}
+
+void impl::ResourceManager::release_resource(UUID uuid)
+{
+	_resourceTable->release_reference(uuid);
+}
+
+void impl::ResourceManager::set_memory_budget(ResourceType type, uint64_t budget)
+{
+	_resourceTable->set_memory_budget(type, budget);
+}
+
+uint64_t impl::ResourceManager::get_memory_budget(ResourceType type) const
+{
+	return _resourceTable->get_memory_budget(type);
+}
+
+profiler::ResourceResidencyUsage impl::ResourceManager::get_residency_usage(ResourceType type) const
+{
+	return _resourceTable->get_residency_usage(type);
+}
+
 ResourceType impl::ResourceManager::get_resource_type(UUID uuid) const
 {
 	return _resourceTable->get_resource_type(uuid);
@@ -2,6 +2,7 @@
 
 #include "api.h"
 #include "resource_table.h"
+#include "import_cache.h"
 #include "resource_manager/resource_manager2.h"
 
 namespace ad_astris::resource::impl
@@ -16,6 +17,10 @@ namespace ad_astris::resource::impl
 				const io::URI& originalResourcePath,
 				const io::URI& engineResourcePath,
 				void* conversionContext) override;
+			experimental::ResourceImportResult import_resources(
+				const std::vector<experimental::ResourceImportRequest>& requests,
+				const experimental::ResourceImportSettings& settings,
+				const experimental::ResourceImportProgressCallback& progressCallback) override;
 			void save_resources() const override;
 			void save_resource(UUID uuid) const override;
 			void save_resource(const std::string& name) const override;
@@ -48,6 +53,28 @@ namespace ad_astris::resource::impl
 			ResourceAccessor<ecore::Sound> get_sound(UUID uuid) const override;
 			ResourceAccessor<ecore::Sound> get_sound(const std::string& soundName) const override;
 		
+			ResourceLoadHandle<ecore::Model> load_model_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Texture> load_texture_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Level> load_level_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Material> load_material_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::MaterialTemplate> load_material_template_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Script> load_script_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Video> load_video_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Font> load_font_async(UUID uuid, ResourceLoadPriority priority) const override;
+			ResourceLoadHandle<ecore::Sound> load_sound_async(UUID uuid, ResourceLoadPriority priority) const override;
+
+			void set_blob_views_enabled(ResourceType type, bool isEnabled) override;
+			void set_import_cache_enabled(bool isEnabled) override;
+			void set_import_cache_max_size(uint64_t maxSize) override;
+			io::DerivedDataCacheStatistics get_import_cache_statistics() const override;
+
+			void* acquire_resource(UUID uuid, ResourceType type) override;
+			void add_resource_reference(UUID uuid) override;
+			void release_resource(UUID uuid) override;
+			void set_memory_budget(ResourceType type, uint64_t budget) override;
+			uint64_t get_memory_budget(ResourceType type) const override;
+			profiler::ResourceResidencyUsage get_residency_usage(ResourceType type) const override;
+
 			ResourceType get_resource_type(UUID uuid) const override;
 			std::string get_resource_name(UUID uuid) const override;
 			UUID get_resource_uuid(const std::string& resourceName) const override;
@@ -60,7 +87,33 @@ namespace ad_astris::resource::impl
 			bool is_sound_format_supported(const std::string& extension) const override;
 
 		private:
+			// Result of decoding and converting one source file, resources are not added to the table yet
+			struct ImportedSource
+			{
+				ResourceType type{ ResourceType::UNDEFINED };
+				std::unique_ptr<ModelImportContext> modelImportContext{ nullptr };
+				ecore::TextureInfo textureInfo;
+				ecore::FontInfo fontInfo;
+				bool isCached{ false };
+			};
+
 			std::unique_ptr<ResourcePool> _resourcePool;
 			std::unique_ptr<ResourceTable> _resourceTable;
+			std::unique_ptr<ImportCache> _importCache;
+			std::atomic_bool _isImportCacheEnabled{ true };
+
+			// Logs an error and returns UNDEFINED if the file can't be converted
+			ResourceType get_source_resource_type(const io::URI& originalResourcePath) const;
+			// Thread-safe, doesn't access the resource table
+			bool import_source(const io::URI& originalResourcePath, ResourceType type, void* conversionContext, ImportedSource& outSource);
+			// If outUnsavedResourceDescs is not null, resources are not saved and their descs are appended to it.
+			// These resources are referenced, the caller must release them after they are saved
+			std::vector<UUID> add_imported_resources(
+				ImportedSource& source,
+				const io::URI& originalResourcePath,
+				const io::URI& engineResourcePath,
+				std::vector<ResourceDesc>* outUnsavedResourceDescs = nullptr,
+				bool areEventsEnqueued = true);
+			static std::vector<std::string> get_resource_names(const ImportedSource& source, const io::URI& originalResourcePath);
 	};
 }
\ No newline at end of file
@@ -2,98 +2,322 @@
 #include "engine_core/model/model.h"
 #include "engine_core/texture/texture.h"
 #include "engine_core/level/level.h"
+#include "engine_core/material/material.h"
+#include "engine_core/material/material_template.h"
+#include "engine_core/script/script.h"
+#include "engine_core/video/video.h"
+#include "engine_core/font/font.h"
+#include "engine_core/audio/sound.h"
 #include "resource_manager/resource_events.h"
 
 using namespace ad_astris;
 using namespace resource::impl;
 
-ResourceTable::ResourceTable(ResourcePool* resourcePool) : _resourcePool(resourcePool)
+std::shared_ptr<ResourceLoadRequest> ResourceLoadRequest::create_loaded(UUID uuid, ecore::Object* resource)
 {
-	setup_resource_vtables();
-	load_config();
+	auto request = std::make_shared<ResourceLoadRequest>(uuid);
+	request->finish(ResourceLoadStatus::LOADED, resource);
+	return request;
 }
 
-void ResourceTable::save_config()
+resource::ResourceLoadStatus ResourceLoadRequest::get_status() const
 {
-	for (auto& pair : _resourceDescByUUID)
+	std::scoped_lock<std::mutex> locker(_mutex);
+	return _status;
+}
+
+void* ResourceLoadRequest::wait()
+{
+	TASK_COMPOSER()->wait(_taskGroup);
+	std::scoped_lock<std::mutex> locker(_mutex);
+	return _resource;
+}
+
+void ResourceLoadRequest::cancel()
+{
+	io::AsyncIOService* ioService = nullptr;
+	io::IOBatchID batchID = io::INVALID_IO_BATCH_ID;
 	{
-		ResourceDesc& resourceDesc = pair.second;
-		
-		io::URI relativePath = io::Utils::get_relative_path_to_file(FILE_SYSTEM()->get_project_root_path(), resourceDesc.path);
-			
-		io::Utils::replace_back_slash_to_forward(relativePath);
-		Section newSection(relativePath.c_str());
-		
-		newSection.set_option("UUID", (uint64_t)pair.first);
-		newSection.set_option("Type", Utils::get_str_resource_type(resourceDesc.type));
-		newSection.set_option("Name", resourceDesc.resourceName->get_name_without_id());
-		newSection.set_option("NameID", (uint64_t)resourceDesc.resourceName->get_name_id());
-		
-		_config.set_section(newSection);
+		std::scoped_lock<std::mutex> locker(_mutex);
+		if (!_requesterCount || --_requesterCount || _status != ResourceLoadStatus::PENDING)
+			return;
+		_isCanceled.store(true);
+		ioService = _ioService;
+		batchID = _ioBatchID;
 	}
+	// If the read has been issued, the completion handler sees the flag and skips deserialization
+	if (ioService && batchID != io::INVALID_IO_BATCH_ID)
+		ioService->cancel(batchID);
+}
 
-	_config.save(FILE_SYSTEM());
+bool ResourceLoadRequest::add_requester()
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	if (_isCanceled.load())
+		return false;
+	++_requesterCount;
+	return true;
 }
 
-void ResourceTable::save_resource(UUID uuid)
+void ResourceLoadRequest::set_io_batch(io::AsyncIOService* ioService, io::IOBatchID batchID)
 {
-	ResourceDesc* resourceDesc = get_resource_desc(uuid);
-	save_resource_internal(resourceDesc);
+	{
+		std::scoped_lock<std::mutex> locker(_mutex);
+		_ioService = ioService;
+		_ioBatchID = batchID;
+		if (!_isCanceled.load())
+			return;
+	}
+	ioService->cancel(batchID);
 }
 
-void ResourceTable::save_resources()
+void ResourceLoadRequest::finish(ResourceLoadStatus status, ecore::Object* resource)
 {
-	for (auto& pair : _resourceDescByUUID)
 	{
-		save_resource_internal(&pair.second);
+		std::scoped_lock<std::mutex> locker(_mutex);
+		if (_status != ResourceLoadStatus::PENDING)
+			return;
+		_status = status;
+		_resource = resource;
 	}
+	_taskGroup.decrease_task_count(1);
+}
+
+ResourceTable::ResourceTable(ResourcePool* resourcePool) : _resourcePool(resourcePool)
+{
+	setup_resource_vtables();
+	load_index();
+}
+
+void ResourceTable::wait_for_loads()
+{
+	TASK_COMPOSER()->wait(_loadTaskGroup);
 }
 
-void ResourceTable::add_resource(const ResourceDesc& resourceDesc)
+void ResourceTable::add_reference(UUID uuid)
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _resourceDescByUUID.find(resourceDesc.resource->get_uuid());
-	if (it != _resourceDescByUUID.end())
+	auto it = _resourceDescByUUID.find(uuid);
+	if (it == _resourceDescByUUID.end() || !it->second.resource)
 	{
-		if (it->second.resource)
-			destroy_resource(it->first);
-		_resourceDescByUUID[it->first] = resourceDesc;
+		LOG_ERROR("ResourceTable::add_reference(): Resource with UUID {} is not loaded", uuid)
+		return;
 	}
+	add_reference_internal(it->second);
+}
+
+void ResourceTable::release_reference(UUID uuid)
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	// The resource could have been destroyed while it was referenced
+	auto it = _resourceDescByUUID.find(uuid);
+	if (it == _resourceDescByUUID.end() || !it->second.referenceCount)
+		return;
+
+	ResourceDesc& resourceDesc = it->second;
+	if (--resourceDesc.referenceCount)
+		return;
+	ResidencyState& residencyState = _residencyByResourceType[resourceDesc.type];
+	--residencyState.referencedCount;
+	resourceDesc.evictionIt = residencyState.evictionOrder.insert(residencyState.evictionOrder.end(), uuid);
+	resourceDesc.isEvictable = true;
+	evict_resources(residencyState, UUID(0));
+}
+
+void ResourceTable::set_memory_budget(ResourceType type, uint64_t budget)
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	ResidencyState& residencyState = _residencyByResourceType[type];
+	residencyState.budget = budget;
+	evict_resources(residencyState, UUID(0));
+}
+
+uint64_t ResourceTable::get_memory_budget(ResourceType type) const
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	auto it = _residencyByResourceType.find(type);
+	return it != _residencyByResourceType.end() ? it->second.budget : 0;
+}
+
+profiler::ResourceResidencyUsage ResourceTable::get_residency_usage(ResourceType type) const
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	auto it = _residencyByResourceType.find(type);
+	if (it == _residencyByResourceType.end())
+		return get_residency_usage_internal(type, ResidencyState());
+	return get_residency_usage_internal(type, it->second);
+}
+
+void ResourceTable::get_residency_usage(std::vector<profiler::ResourceResidencyUsage>& outUsage) const
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	outUsage.clear();
+	for (auto& pair : _residencyByResourceType)
+		outUsage.push_back(get_residency_usage_internal(pair.first, pair.second));
+}
+
+void ResourceTable::set_blob_views_enabled(ResourceType type, bool isEnabled)
+{
+	if (type == ResourceType::UNDEFINED)
+		return;
+	uint32_t typeBit = 1u << static_cast<uint32_t>(type);
+	if (isEnabled)
+		_blobViewTypeMask.fetch_or(typeBit);
 	else
+		_blobViewTypeMask.fetch_and(~typeBit);
+}
+
+void ResourceTable::save_index()
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	if (_index.is_compaction_needed())
+		_index.save();
+}
+
+void ResourceTable::save_resource(UUID uuid)
+{
+	ResourceDesc resourceDesc;
 	{
-		_resourceDescByUUID[resourceDesc.resource->get_uuid()] = resourceDesc;
+		std::scoped_lock<std::mutex> locker(_mutex);
+		auto it = _resourceDescByUUID.find(uuid);
+		if (it == _resourceDescByUUID.end() || !it->second.resource)
+		{
+			LOG_ERROR("ResourceTable::save_resource(): Resource is not loaded")
+			return;
+		}
+		add_reference_internal(it->second);
+		it->second.resource->clear_dirty();
+		resourceDesc = it->second;
 	}
+
+	if (!write_resource(resourceDesc))
+		resourceDesc.resource->make_dirty();
+	release_reference(uuid);
 }
 
-void ResourceTable::unload_resource(UUID uuid)
+void ResourceTable::save_resources()
+{
+	// Dirty resources are referenced, so they are not evicted while they are serialized
+	std::vector<UUID> uuids;
+	std::vector<ResourceDesc> resourceDescs;
+	{
+		std::scoped_lock<std::mutex> locker(_mutex);
+		for (auto& pair : _resourceDescByUUID)
+		{
+			ResourceDesc& resourceDesc = pair.second;
+			if (!resourceDesc.resource || !resourceDesc.resource->is_dirty())
+				continue;
+			add_reference_internal(resourceDesc);
+			resourceDesc.resource->clear_dirty();
+			uuids.push_back(pair.first);
+			resourceDescs.push_back(resourceDesc);
+		}
+	}
+	if (resourceDescs.empty())
+		return;
+
+	// Each task serializes and writes a batch of small resources, so tasks are not dominated by scheduling
+	std::vector<uint8_t> areWritten(resourceDescs.size(), 0);
+	tasks::TaskGroup taskGroup;
+	TASK_COMPOSER()->dispatch(taskGroup, resourceDescs.size(), SAVE_BATCH_SIZE, [&](tasks::TaskExecutionInfo executionInfo)
+	{
+		uint32_t index = executionInfo.globalTaskIndex;
+		areWritten[index] = write_resource(resourceDescs[index]) != 0;
+	});
+	TASK_COMPOSER()->wait(taskGroup);
+
+	uint32_t failedCount = 0;
+	for (size_t i = 0; i != resourceDescs.size(); ++i)
+	{
+		if (!areWritten[i])
+		{
+			resourceDescs[i].resource->make_dirty();
+			++failedCount;
+		}
+		release_reference(uuids[i]);
+	}
+	if (failedCount)
+	{
+		LOG_ERROR("ResourceTable::save_resources(): Failed to save {} of {} resources, they stay dirty", failedCount, resourceDescs.size())
+	}
+}
+
+bool ResourceTable::add_resource(const ResourceDesc& resourceDesc, bool isReferenced)
 {
-	ResourceDesc* resourceDesc = get_resource_desc(uuid);
-	if (resourceDesc && resourceDesc->resource)
+	UUID uuid = resourceDesc.resource->get_uuid();
+	io::URI relativePath = io::Utils::get_relative_path_to_file(FILE_SYSTEM()->get_project_root_path(), resourceDesc.path);
+	io::Utils::replace_back_slash_to_forward(relativePath);
+	ResourceIndexRecord record;
+	record.uuid = uuid;
+	record.type = resourceDesc.type;
+	record.path = relativePath.c_str();
+	record.name = resourceDesc.resourceName->get_name_without_id();
+	record.nameID = resourceDesc.resourceName->get_name_id();
+
+	std::scoped_lock<std::mutex> locker(_mutex);
+	auto it = _resourceDescByUUID.find(uuid);
+	if (it != _resourceDescByUUID.end() && it->second.resource)
 	{
-		_vtableByResourceType[resourceDesc->type].destroy(resourceDesc->resource);
-		resourceDesc->resource = nullptr;
+		// Referencing code keeps pointers to the resident resource
+		if (it->second.referenceCount)
+		{
+			LOG_ERROR("ResourceTable::add_resource(): Resource {} is referenced and can't be replaced", resourceDesc.resourceName->get_full_name())
+			return false;
+		}
+		make_nonresident(it->second);
 	}
+	_index.add(record);
+
+	ResourceDesc& newResourceDesc = _resourceDescByUUID[uuid];
+	newResourceDesc = resourceDesc;
+	newResourceDesc.referenceCount = 0;
+	newResourceDesc.isEvictable = false;
+	make_resident(uuid, newResourceDesc, false);
+	if (isReferenced)
+		add_reference_internal(newResourceDesc);
+	return true;
 }
 
-void ResourceTable::destroy_resource(UUID uuid)
+void ResourceTable::unload_resource(UUID uuid)
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
 	auto it = _resourceDescByUUID.find(uuid);
 	if (it == _resourceDescByUUID.end())
 	{
-		LOG_ERROR("ResourceTable::destroy_resource(): ResourceTable does not have resource with UUID {}", uuid)
+		// Resources of the index that have not been accessed are not loaded
+		if (!_index.contains(uuid))
+		{
+			LOG_ERROR("ResourceTable::unload_resource(): UUID is invalid")
+		}
 		return;
 	}
 
 	ResourceDesc& resourceDesc = it->second;
+	if (resourceDesc.referenceCount)
+	{
+		LOG_WARNING("ResourceTable::unload_resource(): Resource {} is referenced and can't be unloaded", resourceDesc.resourceName->get_full_name())
+		return;
+	}
 	if (resourceDesc.resource)
+		make_nonresident(resourceDesc);
+}
+
+void ResourceTable::destroy_resource(UUID uuid)
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	ResourceDesc* resourceDesc = find_resource_desc(uuid);
+	if (!resourceDesc)
 	{
-		_vtableByResourceType[resourceDesc.type].destroy(resourceDesc.resource);
+		LOG_ERROR("ResourceTable::destroy_resource(): ResourceTable does not have resource with UUID {}", uuid)
+		return;
 	}
-	remove(resourceDesc.path.c_str());
-	std::string name = resourceDesc.resourceName->get_full_name();
-	_uuidByName.erase(_uuidByName.find(name));
-	_resourceDescByUUID.erase(it);
+
+	if (resourceDesc->resource)
+		make_nonresident(*resourceDesc);
+	remove(resourceDesc->path.c_str());
+	std::string name = resourceDesc->resourceName->get_full_name();
+	_index.remove(uuid);
+	_resourceDescByUUID.erase(uuid);
 	LOG_INFO("ResourceTable::destroy_resource(): Destroyed resource {}", name)
 }
 
@@ -109,10 +333,10 @@ bool ResourceTable::is_resource_loaded(UUID uuid) const
 bool ResourceTable::is_resource_loaded(const std::string& name) const
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _uuidByName.find(name);
-	if (it == _uuidByName.end())
+	UUID uuid = _index.find_uuid(name);
+	if (!uuid)
 		return false;
-	auto it2 = _resourceDescByUUID.find(it->second);
+	auto it2 = _resourceDescByUUID.find(uuid);
 	if (it2 == _resourceDescByUUID.end() || it2->second.resource == nullptr)
 		return false;
 	return true;
@@ -121,67 +345,65 @@ bool ResourceTable::is_resource_loaded(const std::string& name) const
 bool ResourceTable::is_resource_desc_valid(UUID uuid) const
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _resourceDescByUUID.find(uuid);
-	if (it == _resourceDescByUUID.end())
-		return false;
-	return true;
+	return _index.contains(uuid);
 }
 
 bool ResourceTable::is_resource_desc_valid(const std::string& name) const
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _uuidByName.find(name);
-	if (it == _uuidByName.end())
-		return false;
-	auto it2 = _resourceDescByUUID.find(it->second);
-	if (it2 == _resourceDescByUUID.end())
-		return false;
-	return true;
+	return _index.find_uuid(name) != UUID(0);
 }
 
 bool ResourceTable::is_uuid_valid(UUID uuid) const
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _resourceDescByUUID.find(uuid);
-	if (it == _resourceDescByUUID.end())
-		return false;
-	return true;
+	return _index.contains(uuid);
 }
 
 UUID ResourceTable::get_resource_uuid(const std::string& name) const
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _uuidByName.find(name);
-	if (it == _uuidByName.end())
+	UUID uuid = _index.find_uuid(name);
+	if (!uuid)
 	{
 		LOG_ERROR("ResourceTable::get_resource_uuid(): ResourceTable does not have name {}", name)
 		return UUID();
 	}
-	return it->second;
+	return uuid;
 }
 
-ResourceDesc* ResourceTable::get_resource_desc(UUID uuid) const
+ResourceDesc* ResourceTable::get_resource_desc(UUID uuid)
 {
 	std::scoped_lock<std::mutex> locker(_mutex);
-	auto it = _resourceDescByUUID.find(uuid);
-	if (it == _resourceDescByUUID.end())
+	ResourceDesc* resourceDesc = find_resource_desc(uuid);
+	if (!resourceDesc)
 	{
 		LOG_ERROR("ResourceTable::get_resource_desc(): UUID is invalid")
 		return nullptr;
 	}
-	return &const_cast<ResourceDesc&>(it->second);
+	return resourceDesc;
 }
 
-resource::ResourceType ResourceTable::get_resource_type(UUID uuid) const
+resource::ResourceType ResourceTable::get_resource_type(UUID uuid)
 {
 	return get_resource_desc(uuid)->type;
 }
 
-ecore::ObjectName* ResourceTable::get_resource_name(UUID uuid) const
+ecore::ObjectName* ResourceTable::get_resource_name(UUID uuid)
 {
 	return get_resource_desc(uuid)->resourceName;
 }
 
+ecore::ObjectName* ResourceTable::allocate_resource_name(const std::string& name)
+{
+	std::scoped_lock<std::mutex> locker(_mutex);
+	std::vector<UUID> uuids;
+	_index.find_uuids_by_base_name(name, uuids);
+	for (UUID uuid : uuids)
+		find_resource_desc(uuid);
+	return _resourcePool->allocate<ecore::ObjectName>(name.c_str());
+}
+
 void ResourceTable::setup_resource_vtables()
 {
 	_vtableByResourceType[ResourceType::MODEL] = { [this](ecore::Object* resource)
@@ -198,42 +420,215 @@ void ResourceTable::setup_resource_vtables()
 	{
 		_resourcePool->free(static_cast<ecore::Level*>(resource));
 	} };
+
+	_vtableByResourceType[ResourceType::MATERIAL] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::Material*>(resource));
+	} };
+
+	_vtableByResourceType[ResourceType::MATERIAL_TEMPLATE] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::MaterialTemplate*>(resource));
+	} };
+
+	_vtableByResourceType[ResourceType::SCRIPT] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::Script*>(resource));
+	} };
+
+	_vtableByResourceType[ResourceType::VIDEO] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::Video*>(resource));
+	} };
+
+	_vtableByResourceType[ResourceType::FONT] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::Font*>(resource));
+	} };
+
+	_vtableByResourceType[ResourceType::SOUND] = { [this](ecore::Object* resource)
+	{
+		_resourcePool->free(static_cast<ecore::Sound*>(resource));
+	} };
+}
+
+void ResourceTable::load_index()
+{
+	_index.load_project(FILE_SYSTEM(), FILE_SYSTEM()->get_project_root_path());
+}
+
+uint64_t ResourceTable::write_resource(const ResourceDesc& resourceDesc)
+{
+	io::File file;
+	ecore::Object* resource = resourceDesc.resource;
+	resource->serialize(&file);
+	file.set_compression_settings(Utils::get_compression_settings(resourceDesc.type));
+	file.set_task_composer(TASK_COMPOSER());
+
+	io::SerializedFile serializedFile;
+	file.serialize(serializedFile);
+	if (!FILE_SYSTEM()->write_atomic(resourceDesc.path, serializedFile.parts.data(), serializedFile.parts.size()))
+		return 0;
+	return serializedFile.get_size();
+}
+
+void ResourceTable::make_resident(UUID uuid, ResourceDesc& resourceDesc, bool isLoaded)
+{
+	ResidencyState& residencyState = _residencyByResourceType[resourceDesc.type];
+	resourceDesc.residentSize = resourceDesc.resource->get_size();
+	residencyState.residentSize += resourceDesc.residentSize;
+	++residencyState.residentCount;
+	if (isLoaded)
+		++residencyState.loadCount;
+	resourceDesc.evictionIt = residencyState.evictionOrder.insert(residencyState.evictionOrder.end(), uuid);
+	resourceDesc.isEvictable = true;
+	evict_resources(residencyState, uuid);
+}
+
+void ResourceTable::make_nonresident(ResourceDesc& resourceDesc)
+{
+	ResidencyState& residencyState = _residencyByResourceType[resourceDesc.type];
+	residencyState.residentSize -= resourceDesc.residentSize;
+	--residencyState.residentCount;
+	if (resourceDesc.isEvictable)
+		residencyState.evictionOrder.erase(resourceDesc.evictionIt);
+	else if (resourceDesc.referenceCount)
+		--residencyState.referencedCount;
+
+	_vtableByResourceType[resourceDesc.type].destroy(resourceDesc.resource);
+	resourceDesc.resource = nullptr;
+	resourceDesc.residentSize = 0;
+	resourceDesc.referenceCount = 0;
+	resourceDesc.isEvictable = false;
 }
 
-void ResourceTable::load_config()
+void ResourceTable::touch_resource(ResourceDesc& resourceDesc)
 {
-	io::URI path = FILE_SYSTEM()->get_project_root_path() + "/configs/resource_table.ini";
-	_config.load_from_file(path);
+	if (!resourceDesc.isEvictable)
+		return;
+	std::list<UUID>& evictionOrder = _residencyByResourceType[resourceDesc.type].evictionOrder;
+	evictionOrder.splice(evictionOrder.end(), evictionOrder, resourceDesc.evictionIt);
+}
 
-	for (auto section : _config)
+void ResourceTable::add_reference_internal(ResourceDesc& resourceDesc)
+{
+	if (resourceDesc.referenceCount++)
+		return;
+	ResidencyState& residencyState = _residencyByResourceType[resourceDesc.type];
+	++residencyState.referencedCount;
+	residencyState.evictionOrder.erase(resourceDesc.evictionIt);
+	resourceDesc.isEvictable = false;
+}
+
+void ResourceTable::evict_resources(ResidencyState& residencyState, UUID protectedUUID)
+{
+	// Dirty resources would lose their changes, they are evicted when their references are released after saving
+	auto it = residencyState.evictionOrder.begin();
+	while (residencyState.budget && residencyState.residentSize > residencyState.budget && it != residencyState.evictionOrder.end())
 	{
-		UUID uuid = section.get_option_value<uint64_t>("UUID");
-		if (is_uuid_valid(uuid))
+		UUID uuid = *it++;
+		ResourceDesc& resourceDesc = _resourceDescByUUID[uuid];
+		if (uuid == protectedUUID || resourceDesc.resource->is_dirty())
 			continue;
-		uint32_t nameID = section.get_option_value<uint64_t>("NameID");
-		std::string name = section.get_option_value<std::string>("Name");
-		
-		ResourceDesc resourceDesc{};
-		resourceDesc.path = io::Utils::get_absolute_path_to_file(FILE_SYSTEM()->get_project_root_path(), section.get_name().c_str());
-		resourceDesc.type = Utils::get_enum_resource_type(section.get_option_value<std::string>("Type"));
-		resourceDesc.resourceName = _resourcePool->allocate<ecore::ObjectName>(name.c_str(), nameID);
-		_resourceDescByUUID[uuid] = resourceDesc;
-		_uuidByName[resourceDesc.resourceName->get_full_name()] = uuid;
+		++residencyState.evictionCount;
+		residencyState.evictedSize += resourceDesc.residentSize;
+		make_nonresident(resourceDesc);
 	}
-	_config.unload();
 }
 
-void ResourceTable::save_resource_internal(ResourceDesc* resourceDesc)
+profiler::ResourceResidencyUsage ResourceTable::get_residency_usage_internal(ResourceType type, const ResidencyState& residencyState) const
 {
-	if (!resourceDesc->resource && !resourceDesc->resource->is_dirty())
-		return;
-	io::File file;
-	ecore::Object* resource = resourceDesc->resource;
-	resource->serialize(&file);
+	profiler::ResourceResidencyUsage usage;
+	usage.typeName = Utils::get_str_resource_type(type);
+	usage.residentSize = residencyState.residentSize;
+	usage.budget = residencyState.budget;
+	usage.residentCount = residencyState.residentCount;
+	usage.referencedCount = residencyState.referencedCount;
+	usage.loadCount = residencyState.loadCount;
+	usage.evictionCount = residencyState.evictionCount;
+	usage.evictedSize = residencyState.evictedSize;
+	return usage;
+}
+
+ResourceDesc* ResourceTable::find_resource_desc(UUID uuid)
+{
+	auto it = _resourceDescByUUID.find(uuid);
+	if (it != _resourceDescByUUID.end())
+		return &it->second;
+
+	ResourceIndexRecord record;
+	if (!_index.find(uuid, record))
+		return nullptr;
+
+	io::URI rootPath = record.isBuiltin ? FILE_SYSTEM()->get_engine_root_path() : FILE_SYSTEM()->get_project_root_path();
+	ResourceDesc& resourceDesc = _resourceDescByUUID[uuid];
+	resourceDesc.path = io::Utils::get_absolute_path_to_file(rootPath, record.path.c_str());
+	resourceDesc.type = record.type;
+	resourceDesc.resourceName = _resourcePool->allocate<ecore::ObjectName>(record.name.c_str(), record.nameID);
+	return &resourceDesc;
+}
+
+ResourceDesc* ResourceTable::find_resource_desc(UUID uuid, ResourceType desiredResourceType)
+{
+	ResourceDesc* resourceDesc = find_resource_desc(uuid);
+	if (!resourceDesc)
+	{
+		LOG_ERROR("ResourceTable::find_resource_desc(): ResourceTable does not have resource with UUID {}", uuid)
+		return nullptr;
+	}
+
+	if (resourceDesc->type != desiredResourceType)
+	{
+		LOG_ERROR("ResourceTable::find_resource_desc(): ResourceDesc type is {}, while passed ResourceType is {}",
+			Utils::get_str_resource_type(resourceDesc->type),
+			Utils::get_str_resource_type(desiredResourceType))
+		return nullptr;
+	}
+	return resourceDesc;
+}
+
+std::shared_ptr<ResourceLoadRequest> ResourceTable::begin_load_request(UUID uuid, bool& isNewRequest)
+{
+	auto it = _loadRequestByUUID.find(uuid);
+	if (it != _loadRequestByUUID.end() && it->second->add_requester())
+	{
+		isNewRequest = false;
+		return it->second;
+	}
+
+	// A canceled request is replaced, it removes itself from the map only if it is still there
+	isNewRequest = true;
+	auto request = std::make_shared<ResourceLoadRequest>(uuid);
+	_loadRequestByUUID[uuid] = request;
+	return request;
+}
 
-	uint8_t* outputData{ nullptr };
-	uint64_t outputDataSize = 0;
-	file.serialize(&outputData, &outputDataSize);
-	io::Utils::write_file(FILE_SYSTEM(), resourceDesc->path, outputData, outputDataSize);
-	delete[] outputData;
+void ResourceTable::finish_load_request(const std::shared_ptr<ResourceLoadRequest>& request, ResourceLoadStatus status, ecore::Object* resource)
+{
+	{
+		std::scoped_lock<std::mutex> locker(_mutex);
+		auto it = _loadRequestByUUID.find(request->get_uuid());
+		if (it != _loadRequestByUUID.end() && it->second == request)
+			_loadRequestByUUID.erase(it);
+	}
+	request->finish(status, resource);
+}
+
+bool ResourceTable::fill_file(io::File& file, ResourceType type, const uint8_t* data, uint64_t size, std::unique_ptr<uint8_t[]> ownedData)
+{
+	if (type != ResourceType::SCRIPT)
+	{
+		file.set_blob_views_enabled(_blobViewTypeMask.load() & (1u << static_cast<uint32_t>(type)));
+		file.set_task_composer(TASK_COMPOSER());
+		return file.deserialize(data, size);
+	}
+
+	// The file owns the blob, so it can't point to the mapping
+	if (!ownedData || ownedData.get() != data)
+	{
+		ownedData.reset(new uint8_t[size]);
+		memcpy(ownedData.get(), data, size);
+	}
+	file.set_binary_blob(ownedData.release(), size);
+	return true;
 }
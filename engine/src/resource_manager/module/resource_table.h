@@ -5,9 +5,16 @@
 #include "resource_manager/resource_formats.h"
 #include "file_system/file_system.h"
 #include "resource_manager/utils.h"
+#include "resource_manager/resource_index.h"
 #include "core/global_objects.h"
-#include "core/config_base.h"
+#include "core/flat_hash_map.h"
 #include "resource_manager/resource_events.h"
+#include "profiler/types.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <unordered_map>
 
 namespace ad_astris::resource::impl
 {
@@ -17,63 +24,228 @@ namespace ad_astris::resource::impl
 		ResourceType type{ ResourceType::UNDEFINED };
 		ecore::ObjectName* resourceName{ nullptr };
 		ecore::Object* resource{ nullptr };
+		uint64_t residentSize{ 0 };				// Size of the resource when it became resident
+		uint32_t referenceCount{ 0 };
+		bool isEvictable{ false };				// Resident and unreferenced
+		std::list<UUID>::iterator evictionIt;	// Position in the eviction order of the type if the resource is evictable
+	};
+
+	class ResourceLoadRequest : public IResourceLoadRequest
+	{
+		public:
+			ResourceLoadRequest(UUID uuid) : _uuid(uuid) { _taskGroup.increase_task_count(1); }
+
+			static std::shared_ptr<ResourceLoadRequest> create_loaded(UUID uuid, ecore::Object* resource);
+
+			ResourceLoadStatus get_status() const override;
+			void* wait() override;
+			void cancel() override;
+
+			// Returns false if the request has been canceled, so a new request must be created
+			bool add_requester();
+			bool is_canceled() const { return _isCanceled.load(); }
+			// If the request has been canceled before the batch was submitted, the batch is canceled immediately
+			void set_io_batch(io::AsyncIOService* ioService, io::IOBatchID batchID);
+			void finish(ResourceLoadStatus status, ecore::Object* resource);
+
+			UUID get_uuid() const { return _uuid; }
+
+		private:
+			UUID _uuid;
+			mutable std::mutex _mutex;
+			// Has one pending task until the request is finished, so waiting executes tasks that finish it
+			tasks::TaskGroup _taskGroup;
+			ResourceLoadStatus _status{ ResourceLoadStatus::PENDING };
+			ecore::Object* _resource{ nullptr };
+			uint32_t _requesterCount{ 1 };
+			std::atomic_bool _isCanceled{ false };
+			io::AsyncIOService* _ioService{ nullptr };
+			io::IOBatchID _ioBatchID{ io::INVALID_IO_BATCH_ID };
 	};
 	
-	class ResourceTable
+	// Resident resources are tracked per type. If a type has a memory budget, unreferenced resources of the type
+	// are evicted in least recently used order when the type is over the budget. The resource that has just been
+	// loaded is never evicted by its own load
+	class ResourceTable : public profiler::IResourceResidencyProvider
 	{
 		public:
 			ResourceTable(ResourcePool* resourcePool);
 
-			void save_config();
+			// Changes of the table are logged by the index when they are made. The log is merged into the index file
+			// when it becomes long
+			void save_index();
+			// Writes the resource even if it is not dirty. The resource must be loaded
 			void save_resource(UUID uuid);
+			// Only dirty resources are saved. They are serialized, compressed and written in batches on TaskComposer
+			// threads, resources that failed to be written stay dirty
 			void save_resources();
-			void add_resource(const ResourceDesc& resourceDesc);
+			// If isReferenced is true, a reference is added before the budget of the type can evict the resource.
+			// A resident resource with the same UUID is replaced only if it is not referenced, otherwise false is
+			// returned and the caller keeps ownership of the new resource
+			bool add_resource(const ResourceDesc& resourceDesc, bool isReferenced = false);
+			// Serializes, compresses and atomically replaces the file of the resource. Returns the size of the file or 0
+			// if it failed to be written. Doesn't access the table, so it can be called from tasks while other
+			// resources are added
+			static uint64_t write_resource(const ResourceDesc& resourceDesc);
 
 			template<typename Resource>
 			Resource* load_resource(UUID uuid, ResourceType desiredResourceType)
 			{
-				auto it = _resourceDescByUUID.find(uuid);
-				if (it == _resourceDescByUUID.end())
-				{
-					LOG_ERROR("ResourceTable::load_resource(): ResourceTable does not have resource with UUID {}", uuid)
+				std::unique_lock<std::mutex> locker(_mutex);
+				ResourceDesc* resourceDesc = find_resource_desc(uuid, desiredResourceType);
+				if (!resourceDesc)
 					return nullptr;
+				if (resourceDesc->resource)
+				{
+					touch_resource(*resourceDesc);
+					return static_cast<Resource*>(resourceDesc->resource);
 				}
 
-				ResourceDesc& resourceDesc = it->second;
+				// If the resource is being loaded asynchronously, the load is joined instead of reading the file twice
+				bool isNewRequest = false;
+				std::shared_ptr<ResourceLoadRequest> request = begin_load_request(uuid, isNewRequest);
+				io::URI path = resourceDesc->path;
+				locker.unlock();
 
-				if (resourceDesc.type != desiredResourceType)
+				if (isNewRequest)
 				{
-					LOG_ERROR("ResourceTable::load_resource(): ResourceDesc type is {}, while passed ResourceType is {}",
-						Utils::get_str_resource_type(resourceDesc.type),
-						Utils::get_str_resource_type(desiredResourceType))
-					return nullptr;
+					// Compressed data is decompressed straight from the mapping
+					io::MappedFile mappedFile = FILE_SYSTEM()->map_file(path, io::MapAccess::SEQUENTIAL);
+					if (!mappedFile.is_valid())
+					{
+						LOG_ERROR("ResourceTable::load_resource(): Failed to map resource file {}", path.c_str())
+						finish_load_request(request, ResourceLoadStatus::FAILED);
+						return nullptr;
+					}
+					io::File file(path);
+					if (!fill_file(file, desiredResourceType, mappedFile.data(), mappedFile.size(), nullptr))
+					{
+						LOG_ERROR("ResourceTable::load_resource(): Failed to deserialize resource file {}", path.c_str())
+						finish_load_request(request, ResourceLoadStatus::FAILED);
+						return nullptr;
+					}
+					complete_load_request<Resource>(request, file);
 				}
-	
-				if (resourceDesc.resource)
-					return static_cast<Resource*>(resourceDesc.resource);
-
-				size_t blobSize = 0;
-				uint8_t* blob = static_cast<uint8_t*>(FILE_SYSTEM()->map_to_read(resourceDesc.path, blobSize));
-				io::File file(resourceDesc.path);
+				return static_cast<Resource*>(request->wait());
+			}
 
-				if (resourceDesc.type != ResourceType::SCRIPT)
+			// Files are read by AsyncIOService, decompression and deserialization are done in the completion
+			// handler on TaskComposer threads. Packed files are mapped from the mounted archive in a task, because
+			// AsyncIOService reads only loose files
+			template<typename Resource>
+			ResourceLoadHandle<Resource> load_resource_async(UUID uuid, ResourceType desiredResourceType, ResourceLoadPriority priority)
+			{
+				std::unique_lock<std::mutex> locker(_mutex);
+				ResourceDesc* resourceDesc = find_resource_desc(uuid, desiredResourceType);
+				if (!resourceDesc)
+					return ResourceLoadHandle<Resource>();
+				if (resourceDesc->resource)
 				{
-					file.deserialize(blob, blobSize);
+					touch_resource(*resourceDesc);
+					return ResourceLoadHandle<Resource>(ResourceLoadRequest::create_loaded(uuid, resourceDesc->resource));
 				}
-				else
+
+				bool isNewRequest = false;
+				std::shared_ptr<ResourceLoadRequest> request = begin_load_request(uuid, isNewRequest);
+				if (!isNewRequest)
+					return ResourceLoadHandle<Resource>(request);
+				io::URI path = resourceDesc->path;
+				locker.unlock();
+
+				io::AsyncIOService* ioService = ASYNC_IO_SERVICE();
+				if (!ioService || FILE_SYSTEM()->is_packed(path))
 				{
-					file.set_binary_blob(blob, blobSize);
+					TASK_COMPOSER()->execute(_loadTaskGroup, [this, request, path, desiredResourceType](tasks::TaskExecutionInfo)
+					{
+						if (request->is_canceled())
+						{
+							finish_load_request(request, ResourceLoadStatus::CANCELED);
+							return;
+						}
+						io::MappedFile mappedFile = FILE_SYSTEM()->map_file(path, io::MapAccess::SEQUENTIAL);
+						if (!mappedFile.is_valid())
+						{
+							LOG_ERROR("ResourceTable::load_resource_async(): Failed to map resource file {}", path.c_str())
+							finish_load_request(request, ResourceLoadStatus::FAILED);
+							return;
+						}
+						io::File file(path);
+						if (!fill_file(file, desiredResourceType, mappedFile.data(), mappedFile.size(), nullptr))
+						{
+							LOG_ERROR("ResourceTable::load_resource_async(): Failed to deserialize resource file {}", path.c_str())
+							finish_load_request(request, ResourceLoadStatus::FAILED);
+							return;
+						}
+						complete_load_request<Resource>(request, file);
+					});
+					return ResourceLoadHandle<Resource>(request);
 				}
 
-				resourceDesc.resource = _resourcePool->allocate<Resource>();
-				resourceDesc.resource->deserialize(&file, resourceDesc.resourceName);
-				ResourceLoadedEvent<Resource> event(static_cast<Resource*>(resourceDesc.resource));
-				EVENT_MANAGER()->enqueue_event(event);
+				std::vector<io::IORequest> ioRequests(1);
+				ioRequests[0].priority = static_cast<io::IOPriority>(priority);
+				ioRequests[0].path = path;
+				ioRequests[0].completionHandler = [this, request, path, desiredResourceType](io::IOResult& result)
+				{
+					if (result.status != io::IOStatus::COMPLETED)
+					{
+						if (result.status == io::IOStatus::FAILED)
+						{
+							LOG_ERROR("ResourceTable::load_resource_async(): Failed to read resource file {}", path.c_str())
+						}
+						finish_load_request(request, result.status == io::IOStatus::CANCELED ? ResourceLoadStatus::CANCELED : ResourceLoadStatus::FAILED);
+						return;
+					}
+					if (request->is_canceled())
+					{
+						finish_load_request(request, ResourceLoadStatus::CANCELED);
+						return;
+					}
+					io::File file(path);
+					if (!fill_file(file, desiredResourceType, result.data, result.size, std::move(result.ownedData)))
+					{
+						LOG_ERROR("ResourceTable::load_resource_async(): Failed to deserialize resource file {}", path.c_str())
+						finish_load_request(request, ResourceLoadStatus::FAILED);
+						return;
+					}
+					complete_load_request<Resource>(request, file);
+				};
+				request->set_io_batch(ioService, ioService->submit(std::move(ioRequests), _loadTaskGroup));
+				return ResourceLoadHandle<Resource>(request);
+			}
 
-				FILE_SYSTEM()->unmap_after_reading(blob);
-				return static_cast<Resource*>(resourceDesc.resource);
+			// Loads the resource and adds a reference, so it is not evicted until release_reference() is called
+			template<typename Resource>
+			Resource* acquire_resource(UUID uuid, ResourceType desiredResourceType)
+			{
+				// The resource can be evicted by another thread before the reference is added, then it is loaded again
+				while (Resource* resource = load_resource<Resource>(uuid, desiredResourceType))
+				{
+					std::scoped_lock<std::mutex> locker(_mutex);
+					ResourceDesc* resourceDesc = find_resource_desc(uuid, desiredResourceType);
+					if (resourceDesc && resourceDesc->resource == resource)
+					{
+						add_reference_internal(*resourceDesc);
+						return resource;
+					}
+				}
+				return nullptr;
 			}
+
+			// The resource must be resident
+			void add_reference(UUID uuid);
+			void release_reference(UUID uuid);
+			// 0 disables the budget. Resources are evicted immediately if the type is over the new budget
+			void set_memory_budget(ResourceType type, uint64_t budget);
+			uint64_t get_memory_budget(ResourceType type) const;
+			profiler::ResourceResidencyUsage get_residency_usage(ResourceType type) const;
+			void get_residency_usage(std::vector<profiler::ResourceResidencyUsage>& outUsage) const override;
+
+			// Must be called before the resource pool is cleaned up
+			void wait_for_loads();
+			// Affects only files that are read after the call
+			void set_blob_views_enabled(ResourceType type, bool isEnabled);
 		
+			// Referenced resources are not unloaded
 			void unload_resource(UUID uuid);
 			void destroy_resource(UUID uuid);
 
@@ -84,9 +256,12 @@ namespace ad_astris::resource::impl
 			bool is_uuid_valid(UUID uuid) const;
 		
 			UUID get_resource_uuid(const std::string& name) const;
-			ResourceDesc* get_resource_desc(UUID uuid) const;
-			ResourceType get_resource_type(UUID uuid) const;
-			ecore::ObjectName* get_resource_name(UUID uuid) const;
+			ResourceDesc* get_resource_desc(UUID uuid);
+			ResourceType get_resource_type(UUID uuid);
+			ecore::ObjectName* get_resource_name(UUID uuid);
+			// Name IDs are assigned by the global name table, so names of resources that were not accessed yet
+			// are registered before a new name is allocated
+			ecore::ObjectName* allocate_resource_name(const std::string& name);
 
 			ResourcePool* get_resource_pool() const { return _resourcePool; }
 		
@@ -96,16 +271,112 @@ namespace ad_astris::resource::impl
 				using DestroyFuncPtr = std::function<void(ecore::Object*)>;
 				DestroyFuncPtr destroy{ nullptr };
 			};
+
+			struct ResidencyState
+			{
+				uint64_t budget{ 0 };
+				uint64_t residentSize{ 0 };
+				uint64_t residentCount{ 0 };
+				uint64_t referencedCount{ 0 };
+				uint64_t loadCount{ 0 };
+				uint64_t evictionCount{ 0 };
+				uint64_t evictedSize{ 0 };
+				std::list<UUID> evictionOrder;		// Evictable resources, least recently used first
+			};
 		
-			Config _config;
 			mutable std::mutex _mutex;
 			ResourcePool* _resourcePool{ nullptr };
-			std::unordered_map<std::string, UUID> _uuidByName;
+			ResourceIndex _index;
+			// Descs are added when resources of the index are accessed. The map is node-based, so pointers returned
+			// by get_resource_desc() stay valid when other descs are added or erased
 			std::unordered_map<UUID, ResourceDesc> _resourceDescByUUID;
-			std::unordered_map<ResourceType, ResourceVTable> _vtableByResourceType;
+			FlatHashMap<ResourceType, ResourceVTable> _vtableByResourceType;
+			FlatHashMap<ResourceType, ResidencyState> _residencyByResourceType;
+			FlatHashMap<UUID, std::shared_ptr<ResourceLoadRequest>> _loadRequestByUUID;
+			tasks::TaskGroup _loadTaskGroup;
+			std::atomic<uint32_t> _blobViewTypeMask{ 0 };
 
 			void setup_resource_vtables();
-			void load_config();
-			void save_resource_internal(ResourceDesc* resourceDesc);
+			void load_index();
+
+			// Must be called under the mutex. Adds the desc of the resource from the index if it has not been accessed yet,
+			// returns nullptr if the UUID is invalid
+			ResourceDesc* find_resource_desc(UUID uuid);
+			// Must be called under the mutex. Logs an error and returns nullptr if the UUID or type is invalid
+			ResourceDesc* find_resource_desc(UUID uuid, ResourceType desiredResourceType);
+			// Residency functions must be called under the mutex. The resource of the desc must be set before
+			// make_resident(), which evicts other resources of the type if it is over its budget
+			void make_resident(UUID uuid, ResourceDesc& resourceDesc, bool isLoaded);
+			void make_nonresident(ResourceDesc& resourceDesc);
+			void touch_resource(ResourceDesc& resourceDesc);
+			void add_reference_internal(ResourceDesc& resourceDesc);
+			void evict_resources(ResidencyState& residencyState, UUID protectedUUID);
+			profiler::ResourceResidencyUsage get_residency_usage_internal(ResourceType type, const ResidencyState& residencyState) const;
+
+			// Must be called under the mutex. Returns the load that is in flight or registers a new one
+			std::shared_ptr<ResourceLoadRequest> begin_load_request(UUID uuid, bool& isNewRequest);
+			void finish_load_request(const std::shared_ptr<ResourceLoadRequest>& request, ResourceLoadStatus status, ecore::Object* resource = nullptr);
+			// Scripts own their blob, so data is copied unless ownedData is passed. Returns false if the data is corrupted
+			bool fill_file(io::File& file, ResourceType type, const uint8_t* data, uint64_t size, std::unique_ptr<uint8_t[]> ownedData);
+
+			// The resource is allocated and published under the mutex, deserialization is done without it
+			template<typename Resource>
+			void complete_load_request(const std::shared_ptr<ResourceLoadRequest>& request, io::File& file)
+			{
+				Resource* resource = nullptr;
+				ecore::ObjectName* resourceName = nullptr;
+				{
+					std::scoped_lock<std::mutex> locker(_mutex);
+					auto it = _resourceDescByUUID.find(request->get_uuid());
+					if (it != _resourceDescByUUID.end() && !request->is_canceled())
+					{
+						resource = _resourcePool->allocate<Resource>();
+						resourceName = it->second.resourceName;
+					}
+				}
+				if (!resource)
+				{
+					finish_load_request(request, ResourceLoadStatus::CANCELED);
+					return;
+				}
+
+				resource->deserialize(&file, resourceName);
+
+				bool isLoaded = false;
+				{
+					std::scoped_lock<std::mutex> locker(_mutex);
+					auto it = _resourceDescByUUID.find(request->get_uuid());
+					if (it == _resourceDescByUUID.end() || request->is_canceled())
+					{
+						_resourcePool->free(resource);
+						resource = nullptr;
+					}
+					else if (it->second.resource)
+					{
+						// add_resource() made another resource resident while the file was read, it is kept
+						_resourcePool->free(resource);
+						resource = static_cast<Resource*>(it->second.resource);
+						touch_resource(it->second);
+					}
+					else
+					{
+						it->second.resource = resource;
+						make_resident(it->first, it->second, true);
+						isLoaded = true;
+					}
+				}
+				if (!resource)
+				{
+					finish_load_request(request, ResourceLoadStatus::CANCELED);
+					return;
+				}
+
+				if (isLoaded)
+				{
+					ResourceLoadedEvent<Resource> event(resource);
+					EVENT_MANAGER()->enqueue_async_event(event);
+				}
+				finish_load_request(request, ResourceLoadStatus::LOADED, resource);
+			}
 	};
 }
@@ -17,6 +17,7 @@ void TextureImporter::import(const io::URI& path, ecore::TextureInfo& outTexture
 {
 	std::vector<uint8_t> textureRawData;
 	io::Utils::read_file(FILE_SYSTEM(), path, textureRawData);
+	ScopedMemoryRecord rawDataRecord(MemoryTag::IMPORTER, textureRawData.size());
 	std::string extension = io::Utils::get_file_extension(path);
 
 	if (extension == "basis")
@@ -37,6 +38,7 @@ void TextureImporter::import(const io::URI& path, ecore::TextureInfo& outTexture
 		if (stbi_is_16_bit_from_memory(textureRawData.data(), textureRawData.size()))
 		{
 			void* textureData = stbi_load_16_from_memory(textureRawData.data(), textureRawData.size(), &width, &height, &channels, 0);
+			ScopedMemoryRecord decodedDataRecord(MemoryTag::IMPORTER, width * height * channels * sizeof(uint16_t));
 			
 			outTextureInfo.width = width;
 			outTextureInfo.height = height;
@@ -96,6 +98,7 @@ void TextureImporter::import(const io::URI& path, ecore::TextureInfo& outTexture
 		else
 		{
 			void* textureData = stbi_load_from_memory(textureRawData.data(), textureRawData.size(), &width, &height, &channels, 0);
+			ScopedMemoryRecord decodedDataRecord(MemoryTag::IMPORTER, width * height * channels);
 
 			outTextureInfo.width = width;
 			outTextureInfo.height = height;
@@ -7,6 +7,9 @@ namespace ad_astris::resource::impl
 	class TextureImporter
 	{
 		public:
+			// Must be increased when the importer changes its output, so cached imports are not used
+			static constexpr uint32_t VERSION = 1;
+
 			static void init();
 			static void import(const io::URI& path, ecore::TextureInfo& outTextureInfo);
 	};
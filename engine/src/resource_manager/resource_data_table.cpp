@@ -1,6 +1,7 @@
 #include "resource_data_table.h"
 #include "file_system/utils.h"
 #include "utils.h"
+#include "core/global_objects.h"
 
 #include <lz4/lz4.h>
 
@@ -24,92 +25,59 @@ resource::ResourceDataTable::~ResourceDataTable()
 
 void resource::ResourceDataTable::load_table(BuiltinResourcesContext& context)
 {
-	io::URI path = _fileSystem->get_project_root_path() + "/configs/resource_table.ini";
-	_config.load_from_file(path);
-
-	for (auto section : _config)
-	{
-		UUID uuid = section.get_option_value<uint64_t>("UUID");
-		if (check_uuid_in_table(uuid))
-			continue;
-		uint32_t nameID = section.get_option_value<uint64_t>("NameID");
-		std::string name = section.get_option_value<std::string>("Name");
-
-		bool builtin = section.get_option_value<bool>("Builtin");
-		ResourceData resData{};
-		if (builtin)
-		{
-			resData.metadata.path = io::Utils::get_absolute_path_to_file(_fileSystem->get_engine_root_path(), section.get_name().c_str());
-		}
-		else
-		{
-			resData.metadata.path = io::Utils::get_absolute_path_to_file(_fileSystem->get_project_root_path(), section.get_name().c_str());
-		}
-		resData.metadata.type = Utils::get_enum_resource_type(section.get_option_value<std::string>("Type"));
-		resData.metadata.objectName = _resourcePool->allocate<ecore::ObjectName>(name.c_str(), nameID);
-		resData.metadata.builtin = builtin;
-		if (resData.metadata.type == ResourceType::MATERIAL_TEMPLATE)
-			context.materialTemplateNames.push_back(uuid);
-		_uuidToResourceData[uuid] = resData;
-		_nameToUUID[resData.metadata.objectName->get_full_name()] = uuid;
-	}
-	_config.unload();
+	std::scoped_lock<std::mutex> lock(_mutex);
+	_index.load_project(_fileSystem, _fileSystem->get_project_root_path());
+	_index.get_uuids(ResourceType::MATERIAL_TEMPLATE, context.materialTemplateNames);
 }
 
 void resource::ResourceDataTable::save_table()
 {
-	for (auto& data : _uuidToResourceData)
-	{
-		ResourceData& resData = data.second;
-		
-		io::URI relativePath;
-		if (resData.metadata.builtin)
-		{
-			relativePath = io::Utils::get_relative_path_to_file(_fileSystem->get_engine_root_path(), resData.metadata.path);
-		}
-		else
-		{
-			relativePath = io::Utils::get_relative_path_to_file(_fileSystem->get_project_root_path(), resData.metadata.path);
-		}
-			
-		io::Utils::replace_back_slash_to_forward(relativePath);
-		Section newSection(relativePath.c_str());
-		
-		newSection.set_option("UUID", (uint64_t)data.first);
-		newSection.set_option("Type", Utils::get_str_resource_type(resData.metadata.type));
-		newSection.set_option("Builtin", resData.metadata.builtin);
-		newSection.set_option("Name", resData.metadata.objectName->get_name_without_id());
-		newSection.set_option("NameID", (uint64_t)resData.metadata.objectName->get_name_id());
-		
-		_config.set_section(newSection);
-	}
-
-	_config.save(_fileSystem);
+	std::scoped_lock<std::mutex> lock(_mutex);
+	if (_index.is_compaction_needed())
+		_index.save();
 }
 
-// TODO CHECK IF OBJECT IS NULLPTR TO CONTINUE ON THE NEXT ITERATION
 void resource::ResourceDataTable::save_resources()
 {
+	// Dirty flags are cleared before serialization, so changes that are made during the save mark resources again
+	std::vector<ResourceData*> dirtyResources;
 	for (auto& pair : _uuidToResourceData)
 	{
 		ResourceData& resourceData = pair.second;
-
 		if (resourceData.metadata.type == ResourceType::SHADER || !resourceData.object || !resourceData.object->is_dirty())
 			continue;
-		
+		resourceData.object->clear_dirty();
+		dirtyResources.push_back(&resourceData);
+	}
+	if (dirtyResources.empty())
+		return;
+
+	// Every resource has its own file, so batches of resources are serialized and written on TaskComposer threads
+	std::vector<uint8_t> areWritten(dirtyResources.size(), 0);
+	tasks::TaskGroup taskGroup;
+	TASK_COMPOSER()->dispatch(taskGroup, dirtyResources.size(), SAVE_BATCH_SIZE, [&](tasks::TaskExecutionInfo executionInfo)
+	{
+		ResourceData& resourceData = *dirtyResources[executionInfo.globalTaskIndex];
 		io::File* file = resourceData.file;
-		ecore::Object* object = resourceData.object;
-		ResourceMetadata& metadata = resourceData.metadata;
-
-		uint8_t* data{ nullptr };
-		uint64_t size = 0;
-		object->serialize(file);
-		file->serialize(data, size);
-
-		io::Stream* stream = _fileSystem->open(file->get_file_path(), "wb");
-		stream->write(data, sizeof(uint8_t), size);
-		_fileSystem->close(stream);
-		delete[] data;
+		resourceData.object->serialize(file);
+		file->set_compression_settings(Utils::get_compression_settings(resourceData.metadata.type));
+
+		io::SerializedFile serializedFile;
+		file->serialize(serializedFile);
+		areWritten[executionInfo.globalTaskIndex] = _fileSystem->write_atomic(
+			file->get_file_path(),
+			serializedFile.parts.data(),
+			serializedFile.parts.size());
+	});
+	TASK_COMPOSER()->wait(taskGroup);
+
+	for (size_t i = 0; i != dirtyResources.size(); ++i)
+	{
+		if (!areWritten[i])
+		{
+			LOG_ERROR("ResourceDataTable::save_resources(): Failed to save {}, it stays dirty", dirtyResources[i]->metadata.path.c_str())
+			dirtyResources[i]->object->make_dirty();
+		}
 	}
 }
 
@@ -126,49 +94,40 @@ bool resource::ResourceDataTable::check_name_in_table(io::URI& path)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
 	std::string name = io::Utils::get_file_name(path);
-	auto it = _nameToUUID.find(name);
-	if (it != _nameToUUID.end())
-		return true;
-	return false;
+	return _index.find_uuid(name) != UUID(0);
 }
 
 bool resource::ResourceDataTable::check_name_in_table(const std::string& name)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _nameToUUID.find(name);
-	if (it != _nameToUUID.end())
-		return true;
-	return false;
+	return _index.find_uuid(name) != UUID(0);
 }
 
 bool resource::ResourceDataTable::check_uuid_in_table(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	if (it != _uuidToResourceData.end())
-		return true;
-	return false;
+	return _index.contains(uuid);
 }
 
 UUID resource::ResourceDataTable::get_uuid_by_name(io::URI& path)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
 	std::string name = io::Utils::get_file_name(path);
-	auto it = _nameToUUID.find(name);
-	return it->second;
+	return _index.find_uuid(name);
 }
 
 UUID resource::ResourceDataTable::get_uuid_by_name(const std::string& name)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _nameToUUID.find(name);
-	return it->second;
+	return _index.find_uuid(name);
 }
 
 void resource::ResourceDataTable::add_resource(ResourceData* resource)
 {
-	std::scoped_lock<std::mutex> lock(_mutex);
 	UUID uuid = resource->object->get_uuid();
+	ResourceIndexRecord record = create_index_record(uuid, resource->metadata);
+	std::scoped_lock<std::mutex> lock(_mutex);
+	_index.add(record);
 	auto it = _uuidToResourceData.find(uuid);
 	if (it != _uuidToResourceData.end() && resource)
 	{
@@ -186,18 +145,17 @@ void resource::ResourceDataTable::add_resource(ResourceData* resource)
 	else if (it == _uuidToResourceData.end() && resource)
 	{
 		_uuidToResourceData[uuid] = *resource;
-		_nameToUUID[resource->object->get_name()->get_full_name()] = uuid;
 	}
 }
 
 void resource::ResourceDataTable::add_empty_resource(ResourceData* resource, UUID uuid)
 {
+	ResourceIndexRecord record = create_index_record(uuid, resource->metadata);
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	if (it == _uuidToResourceData.end())
+	if (!_index.contains(uuid))
 	{
+		_index.add(record);
 		_uuidToResourceData[uuid] = *resource;
-		_nameToUUID[resource->metadata.objectName->get_full_name()] = uuid;
 	}
 	else
 	{
@@ -208,23 +166,23 @@ void resource::ResourceDataTable::add_empty_resource(ResourceData* resource, UUI
 void resource::ResourceDataTable::destroy_resource(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	if (it == _uuidToResourceData.end())
+	ResourceData* resourceDataPtr = find_resource_data(uuid);
+	if (!resourceDataPtr)
 	{
 		LOG_ERROR("ResourceDataTable::destroy_resource(): Invalid UUID")
 		return;
 	}
 
-	if (io::Utils::exists(_fileSystem, it->second.object->get_path()))
-		remove(it->second.object->get_path().c_str());
+	if (io::Utils::exists(_fileSystem, resourceDataPtr->object->get_path()))
+		remove(resourceDataPtr->object->get_path().c_str());
 	
-	ResourceData resourceData = it->second;
-	std::string name = it->second.metadata.objectName->get_full_name();
-	_nameToUUID.erase(_nameToUUID.find(name));
+	ResourceData resourceData = *resourceDataPtr;
+	std::string name = resourceData.metadata.objectName->get_full_name();
+	_index.remove(uuid);
 	resourceData.object->accept(_resourceDeleterVisitor);
 	_resourcePool->free(resourceData.metadata.objectName);
 	
-	_uuidToResourceData.erase(it);
+	_uuidToResourceData.erase(uuid);
 	LOG_INFO("ResourceDataTable::destroy_resource(): Destroyed resource {}", name)
 }
 
@@ -233,33 +191,74 @@ void resource::ResourceDataTable::destroy_resource(UUID& uuid)
 io::File* resource::ResourceDataTable::get_resource_file(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	return it->second.file;
+	return find_resource_data(uuid)->file;
 }
 
 ecore::Object* resource::ResourceDataTable::get_resource_object(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	return it->second.object;
+	return find_resource_data(uuid)->object;
 }
 
 resource::ResourceData* resource::ResourceDataTable::get_resource_data(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	return &_uuidToResourceData.find(uuid)->second;
+	return find_resource_data(uuid);
 }
 
 resource::ResourceType resource::ResourceDataTable::get_resource_type(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
-	auto it = _uuidToResourceData.find(uuid);
-	return it->second.metadata.type;
+	return find_resource_data(uuid)->metadata.type;
 }
 
 io::URI resource::ResourceDataTable::get_resource_path(UUID& uuid)
 {
 	std::scoped_lock<std::mutex> lock(_mutex);
+	return find_resource_data(uuid)->metadata.path;
+}
+
+ecore::ObjectName* resource::ResourceDataTable::allocate_resource_name(const std::string& name)
+{
+	std::scoped_lock<std::mutex> lock(_mutex);
+	std::vector<UUID> uuids;
+	_index.find_uuids_by_base_name(name, uuids);
+	for (UUID uuid : uuids)
+		find_resource_data(uuid);
+	return _resourcePool->allocate<ecore::ObjectName>(name.c_str());
+}
+
+resource::ResourceData* resource::ResourceDataTable::find_resource_data(UUID uuid)
+{
 	auto it = _uuidToResourceData.find(uuid);
-	return it->second.metadata.path;
+	if (it != _uuidToResourceData.end())
+		return &it->second;
+
+	ResourceIndexRecord record;
+	if (!_index.find(uuid, record))
+		return nullptr;
+
+	ResourceData& resourceData = _uuidToResourceData[uuid];
+	io::URI rootPath = record.isBuiltin ? _fileSystem->get_engine_root_path() : _fileSystem->get_project_root_path();
+	resourceData.metadata.path = io::Utils::get_absolute_path_to_file(rootPath, record.path.c_str());
+	resourceData.metadata.type = record.type;
+	resourceData.metadata.objectName = _resourcePool->allocate<ecore::ObjectName>(record.name.c_str(), record.nameID);
+	resourceData.metadata.builtin = record.isBuiltin;
+	return &resourceData;
+}
+
+resource::ResourceIndexRecord resource::ResourceDataTable::create_index_record(UUID uuid, const ResourceMetadata& metadata) const
+{
+	io::URI rootPath = metadata.builtin ? _fileSystem->get_engine_root_path() : _fileSystem->get_project_root_path();
+	io::URI relativePath = io::Utils::get_relative_path_to_file(rootPath, metadata.path);
+	io::Utils::replace_back_slash_to_forward(relativePath);
+
+	ResourceIndexRecord record;
+	record.uuid = uuid;
+	record.type = metadata.type;
+	record.path = relativePath.c_str();
+	record.name = metadata.objectName->get_name_without_id();
+	record.nameID = metadata.objectName->get_name_id();
+	record.isBuiltin = metadata.builtin;
+	return record;
 }
@@ -5,7 +5,7 @@
 #include "file_system/file_system.h"
 #include "engine_core/object.h"
 #include "resource_formats.h"
-#include "core/config_base.h"
+#include "resource_index.h"
 #include <mutex>
 
 namespace ad_astris::resource
@@ -44,18 +44,18 @@ namespace ad_astris::resource
 				_resourcePool = other._resourcePool;
 				_resourceDeleterVisitor = other._resourceDeleterVisitor;
 				_uuidToResourceData = other._uuidToResourceData;
-				_nameToUUID = other._nameToUUID;
-				_config = other._config;
+				// The index is not copied, it is loaded by load_table()
 				return *this;
 			}
 			
-			// Load uuids and paths from aarestable file
+			// Load the resource index of the project. Resources are added to the table when they are accessed
 			void load_table(BuiltinResourcesContext& context);
 
-			// Upload aarestable file
+			// Changes are logged by the index when they are made, the log is merged into the index file when it becomes long
 			void save_table();
 
-			// Upload .aares and .aalevel files
+			// Upload .aares and .aalevel files of dirty resources. Files are replaced atomically, resources that failed
+			// to be written stay dirty
 			void save_resources();
 
 			// Checks if a resource was loaded
@@ -82,14 +82,21 @@ namespace ad_astris::resource
 			ResourceData* get_resource_data(UUID& uuid);
 			ResourceType get_resource_type(UUID& uuid);
 			io::URI get_resource_path(UUID& uuid);
+
+			// Names of resources that were not accessed yet are registered first, so the new name gets a free name ID
+			ecore::ObjectName* allocate_resource_name(const std::string& name);
 		
 		private:
 			io::FileSystem* _fileSystem{ nullptr };
 			ResourcePool* _resourcePool{ nullptr };
 			ResourceDeleterVisitor _resourceDeleterVisitor;
-			std::map<std::string, UUID> _nameToUUID;
+			ResourceIndex _index;
 			std::map<UUID, ResourceData> _uuidToResourceData;
-			Config _config;
 			std::mutex _mutex;
+
+			// Must be called under the mutex. Adds data of the resource from the index if it has not been accessed yet,
+			// returns nullptr if the UUID is invalid
+			ResourceData* find_resource_data(UUID uuid);
+			ResourceIndexRecord create_index_record(UUID uuid, const ResourceMetadata& metadata) const;
 	};
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include "engine_core/model/static_model.h"
 #include "engine_core/texture/texture2D.h"
 #include "engine_core/level/level.h"
-#include <lz4/lz4.h>
+#include "profiler/logger.h"
 #include <json/json.hpp>
 
 using namespace ad_astris;
@@ -19,12 +19,14 @@ template<>
 ResourceFile::ResourceFile(ConversionContext<ecore::StaticModel>& context)
 {
 	context.get_data(_metadata, _binBlob, _binBlobSize, _path);
+	track_binary_blob();
 }
 
 template<>
 ResourceFile::ResourceFile(ConversionContext<ecore::Texture2D>& context)
 {
 	context.get_data(_metadata, _binBlob, _binBlobSize, _path);
+	track_binary_blob();
 }
 
 ResourceFile::ResourceFile(const io::URI& uri)
@@ -34,56 +36,13 @@ ResourceFile::ResourceFile(const io::URI& uri)
 
 inline ResourceFile::~ResourceFile()
 {
-	delete[] _binBlob;
+	// Resets the pointer, so io::File destructor does not delete the blob again
+	destroy_binary_blob();
 }
 
-void ResourceFile::serialize(uint8_t*& data, uint64_t& size)
+bool ResourceFile::deserialize(const uint8_t* data, uint64_t size)
 {
-	int compressStaging = LZ4_compressBound(_binBlobSize);
-	std::vector<char> compressedBinBlob;
-	compressedBinBlob.resize(compressStaging);
-
-	uint64_t compressedSize = LZ4_compress_default(
-		(const char*)_binBlob,
-		compressedBinBlob.data(),
-		_binBlobSize,
-		compressStaging);
-
-	compressedBinBlob.resize(compressedSize);
-	
-	uint64_t metadataSize = _metadata.size();
-	size_t uint64Size = sizeof(uint64_t) * 3;
-	size = uint64Size + compressedBinBlob.size() + metadataSize;
-	data = new uint8_t[size];
-	uint64_t sizes[3] = { metadataSize, compressedSize, _binBlobSize };
-
-	memcpy(data, sizes, uint64Size);
-	memcpy(data + uint64Size, _metadata.data(), _metadata.size());
-	memcpy(data + uint64Size + _metadata.size(), compressedBinBlob.data(), compressedBinBlob.size());
-}
-
-void ResourceFile::deserialize(uint8_t* data, uint64_t size)
-{
-	uint64_t metaDataSize;
-	memcpy(&metaDataSize, data, sizeof(uint64_t));
-	data += sizeof(uint64_t);
-	uint64_t compressedBlobSize;
-	memcpy(&compressedBlobSize, data, sizeof(uint64_t));
-	data += sizeof(uint64_t);
-	memcpy(&_binBlobSize, data, sizeof(uint64_t));
-	data += sizeof(uint64_t);
-	_metadata.resize(metaDataSize);
-	memcpy(_metadata.data(), data, metaDataSize);
-	data += metaDataSize;
-	
-	if (_binBlobSize != 0)
-	{
-		uint8_t* compressedBlob = new uint8_t[compressedBlobSize];
-		_binBlob = new uint8_t[_binBlobSize];
-		memcpy(compressedBlob, data, compressedBlobSize);
-		LZ4_decompress_safe((char*)compressedBlob, (char*)_binBlob, compressedBlobSize, _binBlobSize);
-		delete[] compressedBlob;
-	}
+	return File::deserialize(data, size);
 }
 
 inline bool ResourceFile::is_valid()
@@ -93,8 +52,7 @@ inline bool ResourceFile::is_valid()
 
 inline void ResourceFile::destroy_binary_blob()
 {
-	delete[] _binBlob;
-	_binBlob = nullptr;
+	release_binary_blob();
 }
 
 inline void ResourceFile::accept(IVisitor& visitor)
@@ -112,21 +70,28 @@ LevelFile::~LevelFile()
 	
 }
 
-void LevelFile::serialize(uint8_t*& data, uint64_t& size)
+void LevelFile::serialize(io::SerializedFile& outputFile) const
 {
-	data = new uint8_t[_metadata.size() + sizeof(uint64_t)];
-	uint64_t metadataSize = _metadata.size();
-	memcpy(data, &metadataSize, sizeof(uint64_t));
-	memcpy(data + sizeof(uint64_t), _metadata.data(), metadataSize);
-	size = sizeof(uint64_t) + _metadata.size();
+	outputFile.header = { _metadata.size() };
+	outputFile.compressedBinBlob.clear();
+	outputFile.parts = {
+		{ outputFile.header.data(), sizeof(uint64_t) },
+		{ _metadata.data(), _metadata.size() } };
 }
 
-void LevelFile::deserialize(uint8_t* data, uint64_t size)
+bool LevelFile::deserialize(const uint8_t* data, uint64_t size)
 {
-	uint64_t metadataSize;
-	memcpy(&metadataSize, data, sizeof(uint64_t));
+	uint64_t metadataSize = 0;
+	if (size >= sizeof(uint64_t))
+		memcpy(&metadataSize, data, sizeof(uint64_t));
+	if (size < sizeof(uint64_t) || metadataSize > size - sizeof(uint64_t))
+	{
+		LOG_ERROR("LevelFile::deserialize(): Level file {} is truncated", _path.c_str())
+		return false;
+	}
 	_metadata.resize(metadataSize);
 	memcpy(_metadata.data(), data + sizeof(uint64_t), metadataSize);
+	return true;
 }
 
 inline bool LevelFile::is_valid()
@@ -20,8 +20,7 @@ namespace ad_astris::resource
 			ResourceFile(const io::URI& uri);
 			virtual ~ResourceFile() final override;
 			
-			virtual void serialize(uint8_t*& data, uint64_t& size) final override;
-			virtual void deserialize(uint8_t* data, uint64_t size) final override;
+			virtual bool deserialize(const uint8_t* data, uint64_t size) final override;
 
 			virtual bool is_valid() final override;
 			virtual void destroy_binary_blob() override;
@@ -36,8 +35,8 @@ namespace ad_astris::resource
 				
 			virtual ~LevelFile() final override;
 				
-			virtual void serialize(uint8_t*& data, uint64_t& size) final override;
-			virtual void deserialize(uint8_t* data, uint64_t size) final override;
+			virtual void serialize(io::SerializedFile& outputFile) const final override;
+			virtual bool deserialize(const uint8_t* data, uint64_t size) final override;
 
 			virtual bool is_valid() final override;
 			virtual void accept(IVisitor& visitor) final override;
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <functional>
+#include <memory>
 
 namespace ad_astris::resource
 {
@@ -46,6 +47,156 @@ namespace ad_astris::resource
 			void* _resource{ nullptr };
 	};
 	
+	enum class ResourceLoadStatus
+	{
+		PENDING,
+		LOADED,
+		CANCELED,
+		FAILED
+	};
+
+	// Pending file reads with higher priority are issued first
+	enum class ResourceLoadPriority : uint8_t
+	{
+		LOW,
+		NORMAL,
+		HIGH,
+		CRITICAL
+	};
+
+	// State of an asynchronous load. Requests for a resource that is already being loaded share one state
+	class IResourceLoadRequest
+	{
+		public:
+			virtual ~IResourceLoadRequest() = default;
+
+			virtual ResourceLoadStatus get_status() const = 0;
+			// Blocks until the load is finished and returns the resource or nullptr. TaskComposer tasks are
+			// executed while waiting, so it can be called from tasks
+			virtual void* wait() = 0;
+			// Withdraws one requester. The load is canceled when all requesters have withdrawn it,
+			// a resource that has already been loaded stays loaded
+			virtual void cancel() = 0;
+	};
+
+	template<typename T>
+	class ResourceLoadHandle
+	{
+		public:
+			ResourceLoadHandle() = default;
+			ResourceLoadHandle(std::shared_ptr<IResourceLoadRequest> request) : _request(std::move(request)) { }
+
+			ResourceLoadStatus get_status() const
+			{
+				if (!_request)
+					return ResourceLoadStatus::FAILED;
+				return _request->get_status();
+			}
+
+			bool is_finished() const
+			{
+				return get_status() != ResourceLoadStatus::PENDING;
+			}
+
+			ResourceAccessor<T> wait() const
+			{
+				if (!_request)
+					return ResourceAccessor<T>();
+				return ResourceAccessor<T>(_request->wait());
+			}
+
+			// The handle becomes invalid, so one handle withdraws its request only once
+			void cancel()
+			{
+				if (!_request)
+					return;
+				_request->cancel();
+				_request = nullptr;
+			}
+
+			bool is_valid() const
+			{
+				return _request != nullptr;
+			}
+
+		private:
+			std::shared_ptr<IResourceLoadRequest> _request{ nullptr };
+	};
+
+	class IResourceReferenceCounter
+	{
+		public:
+			virtual ~IResourceReferenceCounter() = default;
+
+			virtual void add_resource_reference(UUID uuid) = 0;
+			// Unreferenced resources can be evicted if their type is over its memory budget
+			virtual void release_resource(UUID uuid) = 0;
+	};
+
+	// Keeps the resource loaded while the handle or its copies exist. Unlike ResourceAccessor, the resource
+	// can't be evicted by the memory budget of its type
+	template<typename T>
+	class ResourceHandle
+	{
+		public:
+			ResourceHandle() = default;
+			// Takes over a reference that has already been added
+			ResourceHandle(T* resource, UUID uuid, IResourceReferenceCounter* referenceCounter)
+				: _resource(resource), _uuid(uuid), _referenceCounter(resource ? referenceCounter : nullptr) { }
+
+			ResourceHandle(const ResourceHandle& other)
+				: _resource(other._resource), _uuid(other._uuid), _referenceCounter(other._referenceCounter)
+			{
+				if (_referenceCounter)
+					_referenceCounter->add_resource_reference(_uuid);
+			}
+
+			ResourceHandle(ResourceHandle&& other) noexcept
+				: _resource(other._resource), _uuid(other._uuid), _referenceCounter(other._referenceCounter)
+			{
+				other._resource = nullptr;
+				other._referenceCounter = nullptr;
+			}
+
+			ResourceHandle& operator=(ResourceHandle other) noexcept
+			{
+				std::swap(_resource, other._resource);
+				std::swap(_uuid, other._uuid);
+				std::swap(_referenceCounter, other._referenceCounter);
+				return *this;
+			}
+
+			~ResourceHandle()
+			{
+				reset();
+			}
+
+			void reset()
+			{
+				if (_referenceCounter)
+					_referenceCounter->release_resource(_uuid);
+				_resource = nullptr;
+				_referenceCounter = nullptr;
+			}
+
+			T* get_resource() const
+			{
+				if (!_resource)
+				{
+					LOG_ERROR("ResourceHandle::get_resource(): Invalid pointer to the resource")
+				}
+				return _resource;
+			}
+
+			bool is_valid() const { return _resource != nullptr; }
+			UUID get_uuid() const { return _uuid; }
+
+		private:
+			T* _resource{ nullptr };
+			UUID _uuid{ 0 };
+			IResourceReferenceCounter* _referenceCounter{ nullptr };
+	};
+	
 	enum class ResourceType
 	{
 		UNDEFINED = -1,
@@ -60,6 +211,9 @@ namespace ad_astris::resource
 		FONT,
 		SOUND
 	};
+
+	// Resource tables serialize dirty resources in batches of this size on TaskComposer threads
+	constexpr uint32_t SAVE_BATCH_SIZE = 8;
 	
 	struct LevelEngineInfo
 	{
@@ -0,0 +1,627 @@
+#include "resource_index.h"
+#include "utils.h"
+#include "core/config_base.h"
+#include "profiler/logger.h"
+
+#include <lz4/xxhash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace ad_astris;
+using namespace resource;
+
+namespace
+{
+	enum class LogRecordType : uint32_t
+	{
+		ADD = 1,
+		REMOVE = 2
+	};
+
+	struct LogHeader
+	{
+		uint32_t magic{ RESOURCE_LOG_MAGIC };
+		uint32_t version{ RESOURCE_LOG_VERSION };
+		uint64_t generation{ 0 };
+	};
+
+	// The hash covers the payload, so a record that was partially written before a crash is detected
+	struct LogRecordHeader
+	{
+		LogRecordType type{ LogRecordType::ADD };
+		uint32_t size{ 0 };
+		uint64_t hash{ 0 };
+	};
+
+	// Payload of ADD records, followed by the path and the name without the ID. REMOVE records contain only the UUID
+	struct LogRecordEntry
+	{
+		uint64_t uuid{ 0 };
+		ResourceType type{ ResourceType::UNDEFINED };
+		ResourceIndexFlags flags{ ResourceIndexFlags::NONE };
+		uint32_t nameID{ 0 };
+		uint32_t pathSize{ 0 };
+		uint32_t nameSize{ 0 };
+		uint32_t reserved{ 0 };
+	};
+
+	static_assert(sizeof(LogHeader) == 16);
+	static_assert(sizeof(LogRecordHeader) == 16);
+	static_assert(sizeof(LogRecordEntry) == 32);
+
+	template<typename T>
+	bool is_in_bounds(uint64_t offset, uint64_t count, uint64_t size)
+	{
+		return offset <= size && count <= (size - offset) / sizeof(T);
+	}
+
+	const ResourceIndexName* find_name(const ResourceIndexName* names, uint32_t count, uint64_t hash)
+	{
+		return std::lower_bound(names, names + count, hash, [](const ResourceIndexName& name, uint64_t hash)
+		{
+			return name.hash < hash;
+		});
+	}
+}
+
+std::string ResourceIndexRecord::get_full_name() const
+{
+	if (!nameID)
+		return name;
+	return name + "_" + std::to_string(nameID);
+}
+
+ResourceIndex::~ResourceIndex()
+{
+	close_log();
+}
+
+bool ResourceIndex::load(io::FileSystem* fileSystem, const io::URI& indexPath, const io::URI& logPath, bool isReadOnly)
+{
+	close_log();
+	unmap_index();
+	_fileSystem = fileSystem;
+	_indexPath = indexPath;
+	_logPath = logPath;
+	_logStateByUUID.clear();
+	_loggedUUIDByName.clear();
+	_logRecordCount = 0;
+	_entryCount = 0;
+	_generation = 0;
+	_isReadOnly = isReadOnly;
+
+	bool isMapped = map_index();
+	if (isMapped)
+	{
+		_generation = _header->generation;
+		_entryCount = _header->entryCount;
+	}
+
+	// New records must not follow a torn record or records of another index, so the log is merged into a new index
+	// before it is appended. If the index was not loaded, the caller saves a new one
+	_isLogAppendable = replay_log() && !_isReadOnly;
+	if (!_isLogAppendable && isMapped && !_isReadOnly)
+		save();
+	return isMapped;
+}
+
+void ResourceIndex::load_project(io::FileSystem* fileSystem, const io::URI& projectRootPath, bool isReadOnly)
+{
+	io::URI configsPath = projectRootPath + "/configs/";
+	if (load(fileSystem, configsPath + RESOURCE_INDEX_FILE_NAME, configsPath + RESOURCE_LOG_FILE_NAME, isReadOnly))
+		return;
+	import_config(configsPath + RESOURCE_TABLE_CONFIG_FILE_NAME);
+	if (!isReadOnly)
+		save();
+}
+
+uint32_t ResourceIndex::import_config(const io::URI& configPath)
+{
+	if (!std::filesystem::exists(_fileSystem->get_absolute_path(configPath)))
+		return 0;
+
+	Config config;
+	if (!config.load_from_file(_fileSystem, configPath))
+		return 0;
+
+	uint32_t count = 0;
+	for (auto section : config)
+	{
+		ResourceIndexRecord record;
+		record.uuid = section.get_option_value<uint64_t>("UUID");
+		record.type = Utils::get_enum_resource_type(section.get_option_value<std::string>("Type"));
+		record.path = section.get_name();
+		record.name = section.get_option_value<std::string>("Name");
+		record.nameID = section.get_option_value<uint64_t>("NameID");
+		record.isBuiltin = section.check_option("Builtin") && section.get_option_value<bool>("Builtin");
+		if (contains(record.uuid))
+			continue;
+		apply_record(record, false);
+		++count;
+	}
+	LOG_INFO("ResourceIndex::import_config(): Imported {} resources from {}", count, configPath.c_str())
+	return count;
+}
+
+bool ResourceIndex::save()
+{
+	if (_isReadOnly)
+	{
+		LOG_ERROR("ResourceIndex::save(): Index {} is read-only", _indexPath.c_str())
+		return false;
+	}
+	std::vector<ResourceIndexRecord> records;
+	records.reserve(_entryCount);
+	for_each([&](const ResourceIndexRecord& record)
+	{
+		records.push_back(record);
+	});
+	std::sort(records.begin(), records.end(), [](const ResourceIndexRecord& first, const ResourceIndexRecord& second)
+	{
+		return static_cast<uint64_t>(first.uuid) < static_cast<uint64_t>(second.uuid);
+	});
+
+	std::vector<ResourceIndexEntry> entries(records.size());
+	std::vector<ResourceIndexName> fullNames(records.size());
+	std::vector<ResourceIndexName> baseNames(records.size());
+	std::string strings;
+	for (uint32_t i = 0; i != records.size(); ++i)
+	{
+		const ResourceIndexRecord& record = records[i];
+		std::string fullName = record.get_full_name();
+		ResourceIndexEntry& entry = entries[i];
+		entry.uuid = record.uuid;
+		entry.type = record.type;
+		entry.flags = record.isBuiltin ? ResourceIndexFlags::BUILTIN : ResourceIndexFlags::NONE;
+		entry.nameID = record.nameID;
+		entry.pathOffset = strings.size();
+		entry.pathSize = record.path.size();
+		strings += record.path;
+		entry.nameOffset = strings.size();
+		entry.nameSize = fullName.size();
+		entry.baseNameSize = record.name.size();
+		strings += fullName;
+
+		fullNames[i] = { hash_name(fullName), i };
+		baseNames[i] = { hash_name(record.name), i };
+	}
+	auto compare_names = [](const ResourceIndexName& first, const ResourceIndexName& second)
+	{
+		return first.hash < second.hash;
+	};
+	std::sort(fullNames.begin(), fullNames.end(), compare_names);
+	std::sort(baseNames.begin(), baseNames.end(), compare_names);
+
+	ResourceIndexHeader header;
+	header.entryCount = entries.size();
+	header.generation = _generation + 1;
+	header.fullNamesOffset = sizeof(ResourceIndexHeader) + entries.size() * sizeof(ResourceIndexEntry);
+	header.baseNamesOffset = header.fullNamesOffset + fullNames.size() * sizeof(ResourceIndexName);
+	header.stringsOffset = header.baseNamesOffset + baseNames.size() * sizeof(ResourceIndexName);
+	header.stringsSize = strings.size();
+
+	io::WriteBuffer buffers[] = {
+		{ &header, sizeof(ResourceIndexHeader) },
+		{ entries.data(), entries.size() * sizeof(ResourceIndexEntry) },
+		{ fullNames.data(), fullNames.size() * sizeof(ResourceIndexName) },
+		{ baseNames.data(), baseNames.size() * sizeof(ResourceIndexName) },
+		{ strings.data(), strings.size() }
+	};
+
+	// Mapped and opened files can't be replaced on Windows
+	close_log();
+	unmap_index();
+	if (!_fileSystem->write_atomic(_indexPath, buffers, std::size(buffers)))
+	{
+		LOG_ERROR("ResourceIndex::save(): Failed to write {}, changes stay in the log", _indexPath.c_str())
+		map_index();
+		return false;
+	}
+
+	// If the log is not replaced, it has the previous generation and is ignored, its records are in the new index
+	LogHeader logHeader;
+	logHeader.generation = header.generation;
+	io::WriteBuffer logBuffer = { &logHeader, sizeof(LogHeader) };
+	if (!_fileSystem->write_atomic(_logPath, &logBuffer, 1))
+	{
+		// Records that are appended to the previous log would be ignored, so it is removed and created again
+		LOG_WARNING("ResourceIndex::save(): Failed to start a new log {}", _logPath.c_str())
+		std::error_code errorCode;
+		std::filesystem::remove(_fileSystem->get_absolute_path(_logPath), errorCode);
+	}
+
+	_logStateByUUID.clear();
+	_loggedUUIDByName.clear();
+	_logRecordCount = 0;
+	_generation = header.generation;
+	_isLogAppendable = true;
+	if (!map_index())
+	{
+		LOG_ERROR("ResourceIndex::save(): Failed to map the saved index {}", _indexPath.c_str())
+		return false;
+	}
+	return true;
+}
+
+bool ResourceIndex::is_compaction_needed() const
+{
+	return _logRecordCount > RESOURCE_LOG_COMPACTION_THRESHOLD && _logRecordCount > _entryCount / 4;
+}
+
+void ResourceIndex::add(const ResourceIndexRecord& record)
+{
+	apply_record(record, false);
+	append_record(record, false);
+}
+
+void ResourceIndex::remove(UUID uuid)
+{
+	if (!contains(uuid))
+		return;
+	ResourceIndexRecord record;
+	record.uuid = uuid;
+	apply_record(record, true);
+	append_record(record, true);
+}
+
+bool ResourceIndex::contains(UUID uuid) const
+{
+	auto it = _logStateByUUID.find(uuid);
+	if (it != _logStateByUUID.end())
+		return !it->second.isRemoved;
+	return find_entry(uuid) != nullptr;
+}
+
+bool ResourceIndex::find(UUID uuid, ResourceIndexRecord& outRecord) const
+{
+	auto it = _logStateByUUID.find(uuid);
+	if (it != _logStateByUUID.end())
+	{
+		if (it->second.isRemoved)
+			return false;
+		outRecord = it->second.record;
+		return true;
+	}
+
+	const ResourceIndexEntry* entry = find_entry(uuid);
+	if (!entry)
+		return false;
+	outRecord = decode_entry(*entry);
+	return true;
+}
+
+UUID ResourceIndex::find_uuid(std::string_view fullName) const
+{
+	auto it = _loggedUUIDByName.find(std::string(fullName));
+	if (it != _loggedUUIDByName.end())
+		return it->second;
+	if (!_header)
+		return UUID(0);
+
+	uint64_t hash = hash_name(fullName);
+	const ResourceIndexName* namesEnd = _fullNames + _header->entryCount;
+	for (const ResourceIndexName* name = find_name(_fullNames, _header->entryCount, hash); name != namesEnd && name->hash == hash; ++name)
+	{
+		const ResourceIndexEntry& entry = _entries[name->entryIndex];
+		if (get_full_name(entry) == fullName && is_entry_visible(entry))
+			return entry.uuid;
+	}
+	return UUID(0);
+}
+
+void ResourceIndex::find_uuids_by_base_name(std::string_view baseName, std::vector<UUID>& outUUIDs) const
+{
+	// The log is short because it is compacted, so it is searched linearly
+	for (auto& pair : _logStateByUUID)
+	{
+		if (!pair.second.isRemoved && pair.second.record.name == baseName)
+			outUUIDs.push_back(pair.first);
+	}
+	if (!_header)
+		return;
+
+	uint64_t hash = hash_name(baseName);
+	const ResourceIndexName* namesEnd = _baseNames + _header->entryCount;
+	for (const ResourceIndexName* name = find_name(_baseNames, _header->entryCount, hash); name != namesEnd && name->hash == hash; ++name)
+	{
+		const ResourceIndexEntry& entry = _entries[name->entryIndex];
+		if (get_full_name(entry).substr(0, entry.baseNameSize) == baseName && is_entry_visible(entry))
+			outUUIDs.push_back(entry.uuid);
+	}
+}
+
+void ResourceIndex::get_uuids(ResourceType type, std::vector<UUID>& outUUIDs) const
+{
+	for (auto& pair : _logStateByUUID)
+	{
+		if (!pair.second.isRemoved && pair.second.record.type == type)
+			outUUIDs.push_back(pair.first);
+	}
+	for (uint32_t i = 0; _header && i != _header->entryCount; ++i)
+	{
+		if (_entries[i].type == type && is_entry_visible(_entries[i]))
+			outUUIDs.push_back(_entries[i].uuid);
+	}
+}
+
+void ResourceIndex::for_each(const std::function<void(const ResourceIndexRecord&)>& callback) const
+{
+	for (auto& pair : _logStateByUUID)
+	{
+		if (!pair.second.isRemoved)
+			callback(pair.second.record);
+	}
+	for (uint32_t i = 0; _header && i != _header->entryCount; ++i)
+	{
+		if (is_entry_visible(_entries[i]))
+			callback(decode_entry(_entries[i]));
+	}
+}
+
+uint64_t ResourceIndex::hash_name(std::string_view name)
+{
+	return XXH64(name.data(), name.size(), 0);
+}
+
+bool ResourceIndex::map_index()
+{
+	if (!std::filesystem::exists(_fileSystem->get_absolute_path(_indexPath)) && !_fileSystem->is_packed(_indexPath))
+		return false;
+
+	// Only entries that are looked up are read
+	io::MappedFile mappedFile = _fileSystem->map_file(_indexPath, io::MapAccess::RANDOM);
+	if (!mappedFile.is_valid())
+		return false;
+
+	const uint8_t* data = mappedFile.data();
+	uint64_t size = mappedFile.size();
+	const ResourceIndexHeader* header = reinterpret_cast<const ResourceIndexHeader*>(data);
+	if (size < sizeof(ResourceIndexHeader) || header->magic != RESOURCE_INDEX_MAGIC || header->version != RESOURCE_INDEX_VERSION)
+	{
+		LOG_ERROR("ResourceIndex::map_index(): File {} is not a resource index or has unsupported version", _indexPath.c_str())
+		return false;
+	}
+
+	if (!is_in_bounds<ResourceIndexEntry>(sizeof(ResourceIndexHeader), header->entryCount, size)
+		|| !is_in_bounds<ResourceIndexName>(header->fullNamesOffset, header->entryCount, size)
+		|| !is_in_bounds<ResourceIndexName>(header->baseNamesOffset, header->entryCount, size)
+		|| !is_in_bounds<char>(header->stringsOffset, header->stringsSize, size))
+	{
+		LOG_ERROR("ResourceIndex::map_index(): Tables of {} are out of bounds", _indexPath.c_str())
+		return false;
+	}
+
+	const ResourceIndexEntry* entries = reinterpret_cast<const ResourceIndexEntry*>(data + sizeof(ResourceIndexHeader));
+	const ResourceIndexName* fullNames = reinterpret_cast<const ResourceIndexName*>(data + header->fullNamesOffset);
+	const ResourceIndexName* baseNames = reinterpret_cast<const ResourceIndexName*>(data + header->baseNamesOffset);
+	for (uint32_t i = 0; i != header->entryCount; ++i)
+	{
+		const ResourceIndexEntry& entry = entries[i];
+		if (entry.pathOffset > header->stringsSize || entry.pathSize > header->stringsSize - entry.pathOffset
+			|| entry.nameOffset > header->stringsSize || entry.nameSize > header->stringsSize - entry.nameOffset
+			|| entry.baseNameSize > entry.nameSize || (i && entries[i - 1].uuid >= entry.uuid)
+			|| fullNames[i].entryIndex >= header->entryCount || baseNames[i].entryIndex >= header->entryCount)
+		{
+			LOG_ERROR("ResourceIndex::map_index(): Entry {} of {} is invalid", i, _indexPath.c_str())
+			return false;
+		}
+	}
+
+	_header = header;
+	_entries = entries;
+	_fullNames = fullNames;
+	_baseNames = baseNames;
+	_strings = reinterpret_cast<const char*>(data + header->stringsOffset);
+	_mappedFile = std::move(mappedFile);
+	return true;
+}
+
+void ResourceIndex::unmap_index()
+{
+	_mappedFile = io::MappedFile();
+	_header = nullptr;
+	_entries = nullptr;
+	_fullNames = nullptr;
+	_baseNames = nullptr;
+	_strings = nullptr;
+}
+
+bool ResourceIndex::replay_log()
+{
+	if (!std::filesystem::exists(_fileSystem->get_absolute_path(_logPath)))
+		return true;
+	io::MappedFile mappedFile = _fileSystem->map_file(_logPath, io::MapAccess::SEQUENTIAL);
+	if (!mappedFile.is_valid())
+		return true;
+
+	const uint8_t* data = mappedFile.data();
+	uint64_t size = mappedFile.size();
+	const LogHeader* logHeader = reinterpret_cast<const LogHeader*>(data);
+	if (size < sizeof(LogHeader) || logHeader->magic != RESOURCE_LOG_MAGIC || logHeader->version != RESOURCE_LOG_VERSION)
+	{
+		LOG_ERROR("ResourceIndex::replay_log(): File {} is not a resource log or has unsupported version", _logPath.c_str())
+		return false;
+	}
+	// The index was saved after the log was written, so records of the log are already in the index
+	if (logHeader->generation != _generation)
+	{
+		LOG_WARNING("ResourceIndex::replay_log(): Log {} was written for another index and is ignored", _logPath.c_str())
+		return false;
+	}
+
+	uint64_t offset = sizeof(LogHeader);
+	while (offset != size)
+	{
+		LogRecordHeader recordHeader;
+		if (size - offset < sizeof(LogRecordHeader))
+			break;
+		memcpy(&recordHeader, data + offset, sizeof(LogRecordHeader));
+		offset += sizeof(LogRecordHeader);
+		const uint8_t* payload = data + offset;
+		if (recordHeader.size > size - offset || XXH64(payload, recordHeader.size, 0) != recordHeader.hash)
+			break;
+		offset += recordHeader.size;
+
+		LogRecordEntry entry;
+		if (recordHeader.type == LogRecordType::REMOVE && recordHeader.size == sizeof(uint64_t))
+		{
+			memcpy(&entry.uuid, payload, sizeof(uint64_t));
+			ResourceIndexRecord record;
+			record.uuid = entry.uuid;
+			apply_record(record, true);
+			++_logRecordCount;
+			continue;
+		}
+		if (recordHeader.type != LogRecordType::ADD || recordHeader.size < sizeof(LogRecordEntry))
+			break;
+		memcpy(&entry, payload, sizeof(LogRecordEntry));
+		if (static_cast<uint64_t>(entry.pathSize) + entry.nameSize != recordHeader.size - sizeof(LogRecordEntry))
+			break;
+
+		const char* strings = reinterpret_cast<const char*>(payload + sizeof(LogRecordEntry));
+		ResourceIndexRecord record;
+		record.uuid = entry.uuid;
+		record.type = entry.type;
+		record.isBuiltin = has_flag(entry.flags, ResourceIndexFlags::BUILTIN);
+		record.nameID = entry.nameID;
+		record.path.assign(strings, entry.pathSize);
+		record.name.assign(strings + entry.pathSize, entry.nameSize);
+		apply_record(record, false);
+		++_logRecordCount;
+	}
+
+	if (offset != size)
+	{
+		LOG_WARNING("ResourceIndex::replay_log(): Log {} ends with a partially written record, it is discarded", _logPath.c_str())
+		return false;
+	}
+	return true;
+}
+
+void ResourceIndex::apply_record(const ResourceIndexRecord& record, bool isRemoved)
+{
+	bool wasContained = contains(record.uuid);
+	auto it = _logStateByUUID.find(record.uuid);
+	if (it != _logStateByUUID.end() && !it->second.isRemoved)
+	{
+		auto nameIt = _loggedUUIDByName.find(it->second.record.get_full_name());
+		if (nameIt != _loggedUUIDByName.end() && nameIt->second == record.uuid)
+			_loggedUUIDByName.erase(nameIt);
+	}
+
+	LogState& logState = _logStateByUUID[record.uuid];
+	logState.record = record;
+	logState.isRemoved = isRemoved;
+	if (!isRemoved)
+		_loggedUUIDByName[record.get_full_name()] = record.uuid;
+
+	if (wasContained && isRemoved)
+		--_entryCount;
+	else if (!wasContained && !isRemoved)
+		++_entryCount;
+}
+
+void ResourceIndex::append_record(const ResourceIndexRecord& record, bool isRemoved)
+{
+	if (!_fileSystem || !_isLogAppendable)
+		return;
+	bool isWritten = true;
+	if (!_logStream)
+	{
+		_logStream = _fileSystem->open(_logPath, "ab");
+		if (!_logStream)
+		{
+			LOG_ERROR("ResourceIndex::append_record(): Failed to open log {}, changes are saved with the index", _logPath.c_str())
+			return;
+		}
+		if (!_logStream->size())
+		{
+			LogHeader logHeader;
+			logHeader.generation = _generation;
+			isWritten = _logStream->write(&logHeader, sizeof(LogHeader), 1) == 1;
+		}
+	}
+
+	std::string payload;
+	if (isRemoved)
+	{
+		uint64_t uuid = record.uuid;
+		payload.assign(reinterpret_cast<const char*>(&uuid), sizeof(uint64_t));
+	}
+	else
+	{
+		LogRecordEntry entry;
+		entry.uuid = record.uuid;
+		entry.type = record.type;
+		entry.flags = record.isBuiltin ? ResourceIndexFlags::BUILTIN : ResourceIndexFlags::NONE;
+		entry.nameID = record.nameID;
+		entry.pathSize = record.path.size();
+		entry.nameSize = record.name.size();
+		payload.assign(reinterpret_cast<const char*>(&entry), sizeof(LogRecordEntry));
+		payload += record.path;
+		payload += record.name;
+	}
+
+	LogRecordHeader recordHeader;
+	recordHeader.type = isRemoved ? LogRecordType::REMOVE : LogRecordType::ADD;
+	recordHeader.size = payload.size();
+	recordHeader.hash = XXH64(payload.data(), payload.size(), 0);
+	isWritten &= _logStream->write(&recordHeader, sizeof(LogRecordHeader), 1) == 1;
+	isWritten &= _logStream->write(payload.data(), payload.size(), 1) == 1;
+	if (!isWritten || !_logStream->flush())
+	{
+		// The log can end with a torn record now, so the record is saved with a new index and a new log
+		LOG_ERROR("ResourceIndex::append_record(): Failed to write log {}, the index is saved", _logPath.c_str())
+		_isLogAppendable = false;
+		close_log();
+		save();
+		return;
+	}
+	++_logRecordCount;
+}
+
+void ResourceIndex::close_log()
+{
+	if (!_logStream)
+		return;
+	_fileSystem->close(_logStream);
+	_logStream = nullptr;
+}
+
+const ResourceIndexEntry* ResourceIndex::find_entry(UUID uuid) const
+{
+	if (!_header)
+		return nullptr;
+	const ResourceIndexEntry* entriesEnd = _entries + _header->entryCount;
+	const ResourceIndexEntry* entry = std::lower_bound(_entries, entriesEnd, static_cast<uint64_t>(uuid), [](const ResourceIndexEntry& entry, uint64_t uuid)
+	{
+		return entry.uuid < uuid;
+	});
+	if (entry == entriesEnd || entry->uuid != uuid)
+		return nullptr;
+	return entry;
+}
+
+bool ResourceIndex::is_entry_visible(const ResourceIndexEntry& entry) const
+{
+	return _logStateByUUID.find(entry.uuid) == _logStateByUUID.end();
+}
+
+ResourceIndexRecord ResourceIndex::decode_entry(const ResourceIndexEntry& entry) const
+{
+	ResourceIndexRecord record;
+	record.uuid = entry.uuid;
+	record.type = entry.type;
+	record.path.assign(_strings + entry.pathOffset, entry.pathSize);
+	record.name.assign(_strings + entry.nameOffset, entry.baseNameSize);
+	record.nameID = entry.nameID;
+	record.isBuiltin = has_flag(entry.flags, ResourceIndexFlags::BUILTIN);
+	return record;
+}
+
+std::string_view ResourceIndex::get_full_name(const ResourceIndexEntry& entry) const
+{
+	return std::string_view(_strings + entry.nameOffset, entry.nameSize);
+}
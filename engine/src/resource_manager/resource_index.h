@@ -0,0 +1,181 @@
+#pragma once
+
+#include "resource_formats.h"
+#include "file_system/file_system.h"
+#include "core/flat_hash_map.h"
+#include "core/flags_operations.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace ad_astris::resource
+{
+	constexpr uint32_t RESOURCE_INDEX_MAGIC = 0x58494141;		// "AAIX"
+	constexpr uint32_t RESOURCE_INDEX_VERSION = 1;
+	constexpr uint32_t RESOURCE_LOG_MAGIC = 0x4C524141;			// "AARL"
+	constexpr uint32_t RESOURCE_LOG_VERSION = 1;
+	// The log is compacted into the index when it has more records than this and than a quarter of entries
+	constexpr uint32_t RESOURCE_LOG_COMPACTION_THRESHOLD = 1024;
+	// Files in the configs folder of the project
+	constexpr const char* RESOURCE_INDEX_FILE_NAME = "resource_table.aaindex";
+	constexpr const char* RESOURCE_LOG_FILE_NAME = "resource_table.aalog";
+	constexpr const char* RESOURCE_TABLE_CONFIG_FILE_NAME = "resource_table.ini";
+
+	enum class ResourceIndexFlags : uint32_t
+	{
+		NONE = 0,
+		BUILTIN = 1 << 0,			// The path is relative to the engine root instead of the project root
+	};
+}
+
+ENABLE_BIT_MASK(ad_astris::resource::ResourceIndexFlags)
+
+namespace ad_astris::resource
+{
+	// Layout: header, entries sorted by UUID, full name lookup table, base name lookup table, strings.
+	// Lookup tables are sorted by name hash
+	struct ResourceIndexHeader
+	{
+		uint32_t magic{ RESOURCE_INDEX_MAGIC };
+		uint32_t version{ RESOURCE_INDEX_VERSION };
+		uint32_t entryCount{ 0 };
+		uint32_t reserved{ 0 };
+		uint64_t generation{ 0 };				// The log is replayed only if it was started after this index was saved
+		uint64_t fullNamesOffset{ 0 };
+		uint64_t baseNamesOffset{ 0 };
+		uint64_t stringsOffset{ 0 };
+		uint64_t stringsSize{ 0 };
+	};
+
+	struct ResourceIndexEntry
+	{
+		uint64_t uuid{ 0 };
+		uint32_t pathOffset{ 0 };				// Offsets in the string block
+		uint32_t pathSize{ 0 };
+		uint32_t nameOffset{ 0 };				// Full name, the name without the ID is its prefix
+		uint32_t nameSize{ 0 };
+		uint32_t baseNameSize{ 0 };
+		uint32_t nameID{ 0 };
+		ResourceType type{ ResourceType::UNDEFINED };
+		ResourceIndexFlags flags{ ResourceIndexFlags::NONE };
+	};
+
+	struct ResourceIndexName
+	{
+		uint64_t hash{ 0 };
+		uint32_t entryIndex{ 0 };
+		uint32_t reserved{ 0 };
+	};
+
+	static_assert(sizeof(ResourceIndexHeader) == 56);
+	static_assert(sizeof(ResourceIndexEntry) == 40);
+	static_assert(sizeof(ResourceIndexName) == 16);
+
+	// Decoded entry of the index
+	struct ResourceIndexRecord
+	{
+		UUID uuid{ 0 };
+		ResourceType type{ ResourceType::UNDEFINED };
+		std::string path;						// Relative path with forward slashes
+		std::string name;						// Name without the ID
+		uint32_t nameID{ 0 };
+		bool isBuiltin{ false };
+
+		// Matches ecore::ObjectName::get_full_name()
+		std::string get_full_name() const;
+	};
+
+	// Persistent table of resources for projects with many resources. The index file is mapped and searched in place,
+	// so loading doesn't parse entries and records are decoded only when they are looked up. Changes are appended to
+	// a log that is replayed over the index when it is loaded, so adding a resource doesn't rewrite the index.
+	// The log is merged into a new index by save(). Not thread-safe, resource tables call it under their mutex
+	class ResourceIndex
+	{
+		public:
+			ResourceIndex() = default;
+			~ResourceIndex();
+
+			ResourceIndex(const ResourceIndex&) = delete;
+			ResourceIndex& operator=(const ResourceIndex&) = delete;
+
+			// Returns false if the index doesn't exist or is invalid, then the index is empty. A log that was
+			// written for another index is ignored, a partially written record at the end of the log is discarded.
+			// A read-only index never writes files, so it can be loaded while another index of the project is used.
+			// Its changes are kept in memory
+			bool load(io::FileSystem* fileSystem, const io::URI& indexPath, const io::URI& logPath, bool isReadOnly = false);
+			// Loads the index from the configs folder of the project. If there is no index, resources are
+			// imported from the INI resource table and a new index is saved unless the index is read-only
+			void load_project(io::FileSystem* fileSystem, const io::URI& projectRootPath, bool isReadOnly = false);
+			// Adds resources from the INI resource table that was used before the index
+			uint32_t import_config(const io::URI& configPath);
+			// Writes all entries to a new index and starts a new log. Both files are replaced atomically.
+			// Returns false if the index is read-only
+			bool save();
+			bool is_compaction_needed() const;
+
+			// Records replace records with the same UUID. Changes are written to the log immediately. If the log
+			// can't be written, the index is saved, and if that fails too, changes are kept until the next save()
+			void add(const ResourceIndexRecord& record);
+			void remove(UUID uuid);
+
+			bool contains(UUID uuid) const;
+			bool find(UUID uuid, ResourceIndexRecord& outRecord) const;
+			// Returns UUID 0 if there is no resource with the name
+			UUID find_uuid(std::string_view fullName) const;
+			// Resources with the same name and different name IDs
+			void find_uuids_by_base_name(std::string_view baseName, std::vector<UUID>& outUUIDs) const;
+			void get_uuids(ResourceType type, std::vector<UUID>& outUUIDs) const;
+			void for_each(const std::function<void(const ResourceIndexRecord&)>& callback) const;
+
+			uint32_t get_entry_count() const { return _entryCount; }
+			uint32_t get_log_record_count() const { return _logRecordCount; }
+
+			static uint64_t hash_name(std::string_view name);
+
+		private:
+			// Records of the log, removed resources are kept to hide entries of the index
+			struct LogState
+			{
+				ResourceIndexRecord record;
+				bool isRemoved{ false };
+			};
+
+			io::FileSystem* _fileSystem{ nullptr };
+			io::URI _indexPath;
+			io::URI _logPath;
+			io::MappedFile _mappedFile;
+			const ResourceIndexHeader* _header{ nullptr };
+			const ResourceIndexEntry* _entries{ nullptr };
+			const ResourceIndexName* _fullNames{ nullptr };
+			const ResourceIndexName* _baseNames{ nullptr };
+			const char* _strings{ nullptr };
+			uint64_t _generation{ 0 };
+
+			FlatHashMap<UUID, LogState> _logStateByUUID;
+			std::unordered_map<std::string, UUID> _loggedUUIDByName;
+			io::Stream* _logStream{ nullptr };
+			uint32_t _logRecordCount{ 0 };
+			uint32_t _entryCount{ 0 };
+			bool _isReadOnly{ false };
+			// False if the index is read-only or the log can end with a torn record that would hide appended records
+			bool _isLogAppendable{ false };
+
+			bool map_index();
+			void unmap_index();
+			// Returns false if the log ends with a partially written record
+			bool replay_log();
+			void apply_record(const ResourceIndexRecord& record, bool isRemoved);
+			void append_record(const ResourceIndexRecord& record, bool isRemoved);
+			void close_log();
+
+			// Returns nullptr if the UUID is not in the index file
+			const ResourceIndexEntry* find_entry(UUID uuid) const;
+			// Entries that were changed or removed by the log are hidden
+			bool is_entry_visible(const ResourceIndexEntry& entry) const;
+			ResourceIndexRecord decode_entry(const ResourceIndexEntry& entry) const;
+			std::string_view get_full_name(const ResourceIndexEntry& entry) const;
+	};
+}
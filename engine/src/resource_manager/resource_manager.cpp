@@ -32,7 +32,7 @@ ResourceManager::~ResourceManager()
 ResourceAccessor<ecore::Level> ResourceManager::create_level(io::URI& path)
 {
 	std::string strLevelName = io::Utils::get_file_name(path);
-	ecore::ObjectName* levelName = _resourcePool.allocate<ecore::ObjectName>(strLevelName.c_str());
+	ecore::ObjectName* levelName = _resourceDataTable.allocate_resource_name(strLevelName);
 	io::File* levelFile = _resourcePool.allocate<ResourceFile>(path);
 	ecore::Level* level = _resourcePool.allocate<ecore::Level>(path, levelName);
 	level->serialize(levelFile);
@@ -59,11 +59,19 @@ ResourceAccessor<ecore::Level> ResourceManager::load_level(io::URI& path)
 	if (file)
 		return level;
 	
-	size_t size = 0;
-	uint8_t* data = static_cast<uint8_t*>(_fileSystem->map_to_read(path, size, "rb"));
+	io::MappedFile mappedFile = _fileSystem->map_file(path, io::MapAccess::SEQUENTIAL);
+	if (!mappedFile.is_valid())
+	{
+		LOG_ERROR("ResourceManager::load_level(): Failed to map level file {}", path.c_str())
+		return nullptr;
+	}
 	file = _resourcePool.allocate<ResourceFile>(path);
-	file->deserialize(data, size);
-	_fileSystem->unmap_after_reading(data);
+	if (!file->deserialize(mappedFile.data(), mappedFile.size()))
+	{
+		LOG_ERROR("ResourceManager::load_level(): Failed to deserialize level file {}", path.c_str())
+		_resourcePool.free(static_cast<ResourceFile*>(file));
+		return nullptr;
+	}
 	
 	level = _resourcePool.allocate<ecore::Level>();
 	level->deserialize(file, resourceData->metadata.objectName);
@@ -89,7 +97,7 @@ template<>
 ResourceAccessor<ecore::OpaquePBRMaterial> ResourceManager::create_new_resource(
 	FirstCreationContext<ecore::OpaquePBRMaterial>& creationContext)
 {
-	ecore::ObjectName* objectName = _resourcePool.allocate<ecore::ObjectName>(creationContext.materialName.c_str());
+	ecore::ObjectName* objectName = _resourceDataTable.allocate_resource_name(creationContext.materialName);
 	
 	io::URI absoluteMaterialPath = creationContext.materialPath + "/" + objectName->get_full_name().c_str() + ".aares";
 	if (io::Utils::is_relative(absoluteMaterialPath))
@@ -116,7 +124,7 @@ template<>
 ResourceAccessor<ecore::TransparentMaterial> ResourceManager::create_new_resource(
 	FirstCreationContext<ecore::TransparentMaterial>& creationContext)
 {
-	ecore::ObjectName* objectName = _resourcePool.allocate<ecore::ObjectName>(creationContext.materialName.c_str());
+	ecore::ObjectName* objectName = _resourceDataTable.allocate_resource_name(creationContext.materialName);
 	
 	io::URI absoluteMaterialPath = creationContext.materialPath + "/" + objectName->get_full_name().c_str() + ".aares";
 	if (io::Utils::is_relative(absoluteMaterialPath))
@@ -148,34 +156,31 @@ void ResourceManager::destroy_resource(UUID uuid)
 	_resourceDataTable.destroy_resource(uuid);
 }
 
-/** @warning MEMORY LEAK, uint8_t* data, should be tested if everything works correct after delete[]
- * 
- */
 void ResourceManager::write_to_disk(io::File* file)
 {
 	io::URI path = file->get_file_path();		// temporary solution
-	uint8_t* data{ nullptr };
-	uint64_t size = 0;
-	file->serialize(data, size);
-	
-	io::Stream* stream = _fileSystem->open(path, "wb");
-	stream->write(data, sizeof(uint8_t), size);
-	_fileSystem->close(stream);
-	delete[] data;
+	io::SerializedFile serializedFile;
+	file->serialize(serializedFile);
+	_fileSystem->write(path, serializedFile.parts.data(), serializedFile.parts.size());
 }
 
 io::File* ResourceManager::read_from_disk(io::URI& path, bool isShader)
 {
-	size_t size = 0;
-	uint8_t* data = static_cast<uint8_t*>(_fileSystem->map_to_read(path, size, "rb"));
+	io::MappedFile mappedFile = _fileSystem->map_file(path, io::MapAccess::SEQUENTIAL);
 	io::File* file = _resourcePool.allocate<resource::ResourceFile>(path);
 	
 	if (isShader)
-		file->set_binary_blob(data, size);
-	else
-		file->deserialize(data, size);
+	{
+		// The file owns the blob, so it can't point to the mapping
+		uint8_t* blob = new uint8_t[mappedFile.size()];
+		memcpy(blob, mappedFile.data(), mappedFile.size());
+		file->set_binary_blob(blob, mappedFile.size());
+	}
+	else if (!file->deserialize(mappedFile.data(), mappedFile.size()))
+	{
+		LOG_ERROR("ResourceManager::read_from_disk(): Failed to deserialize resource file {}", path.c_str())
+	}
 	
-	_fileSystem->unmap_after_reading(data);
 	return file;
 }
 
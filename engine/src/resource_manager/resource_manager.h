@@ -102,7 +102,7 @@ namespace ad_astris::resource
 				}
 				else
 				{
-					newObjectName = _resourcePool.allocate<ecore::ObjectName>(io::Utils::get_file_name(originalResourcePath).c_str());
+					newObjectName = _resourceDataTable.allocate_resource_name(io::Utils::get_file_name(originalResourcePath));
 					conversionContext.filePath = (aaresPath + "/" + newObjectName->get_full_name().c_str() + ".aares").c_str();
 				}
 
@@ -121,6 +121,7 @@ namespace ad_astris::resource
 				resourceData.metadata.type = Utils::get_enum_resource_type(typedObject->get_type());
 				
 				send_resource_created_event(typedObject);			// I have to make it in another thread.
+				file->set_compression_settings(Utils::get_compression_settings(resourceData.metadata.type));
 				write_to_disk(resourceData.file);
 				
 				_resourceDataTable.add_resource(&resourceData);
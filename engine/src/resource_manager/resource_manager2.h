@@ -2,6 +2,8 @@
 
 #include "resource_formats.h"
 #include "core/non_copyable_non_movable.h"
+#include "file_system/derived_data_cache.h"
+#include "profiler/types.h"
 #include "engine_core/model/model.h"
 #include "engine_core/texture/texture.h"
 #include "engine_core/level/level.h"
@@ -14,7 +16,56 @@
 
 namespace ad_astris::resource::experimental
 {
-	class ResourceManager : public NonCopyableNonMovable
+	struct ResourceImportRequest
+	{
+		io::URI originalResourcePath;
+		io::URI engineResourcePath;
+		ecore::ModelConversionContext modelConversionContext;		// Used only by models
+	};
+
+	struct ResourceImportSettings
+	{
+		// Sources are not decoded while their decoded data and the data of sources that are not written yet
+		// exceed the limit. One source is always imported, even if it is larger than the limit
+		uint64_t maxInFlightSize{ 1024ull * 1024 * 1024 };
+		// Resources are unloaded after their files are written, so memory use doesn't grow with the number of
+		// sources. Created and recreated events are not sent for them because they would point to unloaded resources
+		bool areResourcesUnloaded{ false };
+	};
+
+	struct ResourceImportProgress
+	{
+		uint32_t sourceCount{ 0 };
+		uint32_t completedSourceCount{ 0 };		// Includes failed and cached sources
+		uint32_t failedSourceCount{ 0 };
+		uint32_t cachedSourceCount{ 0 };			// Sources that were not decoded because of the import cache
+		uint32_t writtenResourceCount{ 0 };
+		uint64_t sourceSize{ 0 };					// Size of completed source files
+		uint64_t writtenSize{ 0 };					// Size of written resource files
+		uint64_t peakInFlightSize{ 0 };
+		double elapsedSeconds{ 0.0 };
+
+		double get_source_throughput() const
+		{
+			return elapsedSeconds > 0.0 ? sourceSize / (1024.0 * 1024.0) / elapsedSeconds : 0.0;
+		}
+
+		double get_write_throughput() const
+		{
+			return elapsedSeconds > 0.0 ? writtenSize / (1024.0 * 1024.0) / elapsedSeconds : 0.0;
+		}
+	};
+
+	// Called on the thread that imports the batch after each completed source
+	using ResourceImportProgressCallback = std::function<void(const ResourceImportProgress&)>;
+
+	struct ResourceImportResult
+	{
+		std::vector<UUID> uuids;
+		ResourceImportProgress progress;
+	};
+
+	class ResourceManager : public NonCopyableNonMovable, public IResourceReferenceCounter
 	{
 		public:
 			virtual ~ResourceManager() = default;
@@ -38,6 +89,16 @@ namespace ad_astris::resource::experimental
 				const io::URI& originalResourcePath,
 				const io::URI& engineResourcePath,
 				void* conversionContext = nullptr) = 0;
+			/**
+			 * \brief Converts many files like convert_to_engine_format(). Sources are decoded and converted in
+			 * TaskComposer tasks, then resources are added to the table on the calling thread and their files are
+			 * compressed and written in tasks while other sources are decoded.
+			 * \return UUIDs of the resources of all sources that have been imported, failed sources are skipped
+			 */
+			virtual ResourceImportResult import_resources(
+				const std::vector<ResourceImportRequest>& requests,
+				const ResourceImportSettings& settings = ResourceImportSettings(),
+				const ResourceImportProgressCallback& progressCallback = nullptr) = 0;
 			virtual void save_resources() const = 0;
 			virtual void save_resource(UUID uuid) const = 0;
 			virtual void save_resource(const std::string& name) const = 0;
@@ -231,6 +292,60 @@ namespace ad_astris::resource::experimental
 			 */
 			virtual ResourceAccessor<ecore::Sound> get_sound(const std::string& soundName) const = 0;
 
+			/**
+			 * \brief Loads resources asynchronously. Files are read with the passed priority, decompression and
+			 * deserialization are done on TaskComposer threads. Loads of a resource that is already being loaded are joined.
+			 * ResourceLoadedEvent is enqueued when the resource is loaded.
+			 * \param uuid must be a valid UUID of the resource with the appropriate type.
+			 * \return Finished handle if the resource is loaded, invalid handle with FAILED status if UUID is incorrect.
+			 */
+			virtual ResourceLoadHandle<ecore::Model> load_model_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Texture> load_texture_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Level> load_level_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Material> load_material_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::MaterialTemplate> load_material_template_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Script> load_script_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Video> load_video_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Font> load_font_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+			virtual ResourceLoadHandle<ecore::Sound> load_sound_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const = 0;
+
+			/**
+			 * \brief If enabled, loaded resources of the type point into the blob of their file instead of copying data
+			 * from it. The blob is freed when the last resource that points into it is unloaded. Supported by
+			 * ecore::Model and ecore::Texture, other types ignore it. Useful for data that is only uploaded to the GPU.
+			 * Affects only resources that are loaded after the call. Disabled by default: the renderer still uploads
+			 * models through the legacy ResourceManager, so nothing enables it yet. Models with blob views must be read
+			 * with ecore::Model::get_data_view() or ecore::Model::copy_info().
+			 */
+			virtual void set_blob_views_enabled(ResourceType type, bool isEnabled) = 0;
+
+			/**
+			 * \brief Results of model and texture imports are cached in 'intermediate/derived_data_cache' of the project.
+			 * convert_to_engine_format() doesn't decode sources whose contents, conversion settings and importer versions
+			 * match a cached import. If disabled, sources are always imported and results are not cached.
+			 */
+			virtual void set_import_cache_enabled(bool isEnabled) = 0;
+			// Least recently used imports are removed when the cache is larger than the limit
+			virtual void set_import_cache_max_size(uint64_t maxSize) = 0;
+			virtual io::DerivedDataCacheStatistics get_import_cache_statistics() const = 0;
+
+			/**
+			 * \brief Loads the resource like get_resource() and adds a reference to it. See acquire_resource<Resource>().
+			 * \return Pointer to the resource if UUID and type are correct, otherwise nullptr without a reference.
+			 */
+			virtual void* acquire_resource(UUID uuid, ResourceType type) = 0;
+			/**
+			 * \brief Unreferenced resources of the type are evicted in least recently used order when resident resources
+			 * of the type are larger than the budget. The budget is disabled by default. If the budget is enabled, pointers
+			 * from ResourceAccessor can be invalidated by loads of other resources, so resources that are used for more
+			 * than one load must be held by ResourceHandle.
+			 * \param budget in bytes, 0 disables the budget.
+			 */
+			virtual void set_memory_budget(ResourceType type, uint64_t budget) = 0;
+			virtual uint64_t get_memory_budget(ResourceType type) const = 0;
+			// Residency of all types is also added to the frame stats of the profiler
+			virtual profiler::ResourceResidencyUsage get_residency_usage(ResourceType type) const = 0;
+
 			virtual ResourceType get_resource_type(UUID uuid) const = 0;
 			virtual std::string get_resource_name(UUID uuid) const = 0;
 			virtual UUID get_resource_uuid(const std::string& resourceName) const = 0;
@@ -314,5 +429,78 @@ namespace ad_astris::resource::experimental
 				LOG_ERROR("ResourceManager::get_resource(): Engine does not support resource type {}", get_type_name<Resource>())
 				return ResourceAccessor<Resource>{};
 			}
+
+			/**
+			 * \brief If Resource has not previously been loaded, it will be loaded automatically. The resource is not
+			 * evicted by the memory budget of its type while the handle or its copies exist.
+			 * \tparam Resource must be one of the supported Resource types.
+			 * \return Invalid handle if UUID is incorrect.
+			 */
+			template<typename Resource>
+			ResourceHandle<Resource> acquire_resource(UUID uuid)
+			{
+				ResourceType type = ResourceType::UNDEFINED;
+				if constexpr (std::is_same_v<Resource, ecore::Model>)
+					type = ResourceType::MODEL;
+				if constexpr (std::is_same_v<Resource, ecore::Texture>)
+					type = ResourceType::TEXTURE;
+				if constexpr (std::is_same_v<Resource, ecore::Level>)
+					type = ResourceType::LEVEL;
+				if constexpr (std::is_same_v<Resource, ecore::Material>)
+					type = ResourceType::MATERIAL;
+				if constexpr (std::is_same_v<Resource, ecore::MaterialTemplate>)
+					type = ResourceType::MATERIAL_TEMPLATE;
+				if constexpr (std::is_same_v<Resource, ecore::Script>)
+					type = ResourceType::SCRIPT;
+				if constexpr (std::is_same_v<Resource, ecore::Video>)
+					type = ResourceType::VIDEO;
+				if constexpr (std::is_same_v<Resource, ecore::Font>)
+					type = ResourceType::FONT;
+				if constexpr (std::is_same_v<Resource, ecore::Sound>)
+					type = ResourceType::SOUND;
+
+				if (type == ResourceType::UNDEFINED)
+				{
+					LOG_ERROR("ResourceManager::acquire_resource(): Engine does not support resource type {}", get_type_name<Resource>())
+					return ResourceHandle<Resource>{};
+				}
+				return ResourceHandle<Resource>(static_cast<Resource*>(acquire_resource(uuid, type)), uuid, this);
+			}
+
+			template<typename Resource>
+			ResourceHandle<Resource> acquire_resource(const std::string& resourceName)
+			{
+				return acquire_resource<Resource>(get_resource_uuid(resourceName));
+			}
+
+			/**
+			 * \brief Starts an asynchronous load of the Resource. See load_model_async.
+			 * \tparam Resource must be one of the supported Resource types.
+			 */
+			template<typename Resource>
+			ResourceLoadHandle<Resource> load_resource_async(UUID uuid, ResourceLoadPriority priority = ResourceLoadPriority::NORMAL) const
+			{
+				if constexpr (std::is_same_v<Resource, ecore::Model>)
+					return load_model_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Texture>)
+					return load_texture_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Level>)
+					return load_level_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Material>)
+					return load_material_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::MaterialTemplate>)
+					return load_material_template_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Script>)
+					return load_script_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Video>)
+					return load_video_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Font>)
+					return load_font_async(uuid, priority);
+				if constexpr (std::is_same_v<Resource, ecore::Sound>)
+					return load_sound_async(uuid, priority);
+				
+				LOG_ERROR("ResourceManager::load_resource_async(): Engine does not support resource type {}", get_type_name<Resource>())
+				return ResourceLoadHandle<Resource>{};
+			}
 	};
 }
\ No newline at end of file
@@ -51,4 +51,25 @@ ResourceType Utils::get_enum_resource_type(std::string type)
 		return ResourceType::VIDEO;
 	if (type == "sound")
 		return ResourceType::SOUND;
-}
\ No newline at end of file
+}
+
+ad_astris::io::BlockCompressionSettings Utils::get_compression_settings(ResourceType type)
+{
+	io::BlockCompressionSettings settings;
+	switch (type)
+	{
+		case ResourceType::MODEL:
+		case ResourceType::TEXTURE:
+			settings.codec = io::BlockCodec::LZ4_HC;
+			break;
+		case ResourceType::VIDEO:
+		case ResourceType::SOUND:
+		case ResourceType::FONT:
+			settings.codec = io::BlockCodec::NONE;
+			break;
+		default:
+			settings.codec = io::BlockCodec::LZ4;
+			break;
+	}
+	return settings;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "resource_formats.h"
+#include "file_system/block_compression.h"
 #include <string>
 
 namespace ad_astris::resource
@@ -10,5 +11,7 @@ namespace ad_astris::resource
 		public:
 			static std::string get_str_resource_type(ResourceType type);
 			static ResourceType get_enum_resource_type(std::string type);
+			// Resources that are read often are compressed slower for a better ratio, already compressed media is stored as is
+			static io::BlockCompressionSettings get_compression_settings(ResourceType type);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "null_rhi.h"
+#include "profiler/logger.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace ad_astris;
+using namespace rhi;
+
+constexpr uint64_t NULL_RHI_TIMESTAMP_FREQUENCY = 1000000000;
+constexpr uint32_t PIPELINE_STATISTICS_VALUE_COUNT = sizeof(PipelineStatistics) / sizeof(uint64_t);
+
+namespace
+{
+	// Layouts match VkDrawIndirectCommand and VkDrawIndexedIndirectCommand
+	struct NullDrawIndirectCommand
+	{
+		uint32_t vertexCount;
+		uint32_t instanceCount;
+		uint32_t firstVertex;
+		uint32_t firstInstance;
+	};
+
+	struct NullDrawIndexedIndirectCommand
+	{
+		uint32_t indexCount;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		uint32_t firstInstance;
+	};
+
+	void subtract_statistics(const PipelineStatistics& end, const PipelineStatistics& begin, uint64_t* outValues)
+	{
+		const uint64_t* endValues = reinterpret_cast<const uint64_t*>(&end);
+		const uint64_t* beginValues = reinterpret_cast<const uint64_t*>(&begin);
+		for (uint32_t i = 0; i != PIPELINE_STATISTICS_VALUE_COUNT; ++i)
+			outValues[i] = endValues[i] - beginValues[i];
+	}
+}
+
+NullRHI::NullRHI(uint32_t bufferCount, const NullRHICostModel& costModel) : _costModel(costModel)
+{
+	_gpuProperties.bufferCount = bufferCount;
+	_gpuProperties.timestampFrequency = NULL_RHI_TIMESTAMP_FREQUENCY;
+	_gpuProperties.gpuName = "Null GPU";
+}
+
+NullRHI::~NullRHI()
+{
+	cleanup();
+}
+
+void NullRHI::init(RHIInitContext& initContext)
+{
+	if (initContext.swapChainInfo && initContext.swapChainInfo->buffersCount)
+		_gpuProperties.bufferCount = initContext.swapChainInfo->buffersCount;
+	_gpuProperties.validationMode = initContext.validationMode;
+}
+
+void NullRHI::cleanup()
+{
+	_buffers.clear();
+	_queryPools.clear();
+}
+
+void NullRHI::create_buffer(Buffer* buffer, BufferInfo* info, void* data)
+{
+	buffer->bufferInfo = *info;
+	create_buffer(buffer, data);
+}
+
+void NullRHI::create_buffer(Buffer* buffer, void* data)
+{
+	NullBuffer* nullBuffer = _buffers.emplace_back(std::make_unique<NullBuffer>()).get();
+	nullBuffer->data.resize(buffer->bufferInfo.size);
+	if (data)
+		memcpy(nullBuffer->data.data(), data, buffer->bufferInfo.size);
+
+	buffer->type = Resource::ResourceType::BUFFER;
+	buffer->handle = nullBuffer;
+	buffer->mappedData = nullBuffer->data.data();
+	buffer->mappedDataSize = nullBuffer->data.size();
+}
+
+void NullRHI::destroy_buffer(Buffer* buffer)
+{
+	auto it = std::find_if(_buffers.begin(), _buffers.end(), [buffer](const auto& nullBuffer)
+	{
+		return nullBuffer.get() == buffer->handle;
+	});
+	if (it == _buffers.end())
+	{
+		LOG_ERROR("NullRHI::destroy_buffer(): Buffer was not created by NullRHI")
+		return;
+	}
+
+	_buffers.erase(it);
+	buffer->handle = nullptr;
+	buffer->mappedData = nullptr;
+	buffer->mappedDataSize = 0;
+}
+
+void NullRHI::update_buffer_data(Buffer* buffer, uint64_t size, void* data)
+{
+	if (uint8_t* dstData = get_buffer_data(buffer, 0, size))
+		memcpy(dstData, data, size);
+}
+
+void NullRHI::begin_command_buffer(CommandBuffer* cmd, QueueType queueType)
+{
+	cmd->handle = &_commandBufferHandle;
+	cmd->queueType = queueType;
+}
+
+void NullRHI::copy_buffer(
+	CommandBuffer*,
+	Buffer* srcBuffer,
+	Buffer* dstBuffer,
+	uint32_t size,
+	uint32_t srcOffset,
+	uint32_t dstOffset)
+{
+	uint64_t copySize = size ? size : srcBuffer->bufferInfo.size;
+	uint8_t* srcData = get_buffer_data(srcBuffer, srcOffset, copySize);
+	uint8_t* dstData = get_buffer_data(dstBuffer, dstOffset, copySize);
+	if (srcData && dstData)
+		memmove(dstData, srcData, copySize);
+}
+
+void NullRHI::draw(CommandBuffer*, uint64_t vertexCount)
+{
+	execute_draw(vertexCount);
+}
+
+void NullRHI::draw_indexed(
+	CommandBuffer*,
+	uint32_t indexCount,
+	uint32_t instanceCount,
+	uint32_t,
+	int32_t,
+	uint32_t)
+{
+	execute_draw((uint64_t)indexCount * instanceCount);
+}
+
+void NullRHI::draw_indirect(CommandBuffer*, Buffer* buffer, uint32_t offset, uint32_t drawCount, uint32_t stride)
+{
+	for (uint32_t i = 0; i != drawCount; ++i)
+	{
+		uint8_t* data = get_buffer_data(buffer, offset + (uint64_t)i * stride, sizeof(NullDrawIndirectCommand));
+		if (!data)
+			return;
+		NullDrawIndirectCommand command;
+		memcpy(&command, data, sizeof(command));
+		execute_draw((uint64_t)command.vertexCount * command.instanceCount);
+	}
+}
+
+void NullRHI::draw_indexed_indirect(CommandBuffer*, Buffer* buffer, uint32_t offset, uint32_t drawCount, uint32_t stride)
+{
+	for (uint32_t i = 0; i != drawCount; ++i)
+	{
+		uint8_t* data = get_buffer_data(buffer, offset + (uint64_t)i * stride, sizeof(NullDrawIndexedIndirectCommand));
+		if (!data)
+			return;
+		NullDrawIndexedIndirectCommand command;
+		memcpy(&command, data, sizeof(command));
+		execute_draw((uint64_t)command.indexCount * command.instanceCount);
+	}
+}
+
+void NullRHI::dispatch(CommandBuffer*, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	uint64_t invocationCount = (uint64_t)groupCountX * groupCountY * groupCountZ * _costModel.computeGroupSize;
+	_pipelineStatistics.computeShaderInvocations += invocationCount;
+	_gpuTimeNs += _costModel.commandNs + (uint64_t)((double)invocationCount * _costModel.computeInvocationNs);
+}
+
+void NullRHI::fill_buffer(CommandBuffer*, Buffer* buffer, uint32_t dstOffset, uint32_t size, uint32_t data)
+{
+	uint8_t* dstData = get_buffer_data(buffer, dstOffset, size);
+	if (!dstData)
+		return;
+	for (uint32_t i = 0; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t))
+		memcpy(dstData + i, &data, sizeof(uint32_t));
+}
+
+void NullRHI::create_query_pool(QueryPool* queryPool, QueryPoolInfo* queryPoolInfo)
+{
+	queryPool->info = *queryPoolInfo;
+	create_query_pool(queryPool);
+}
+
+void NullRHI::create_query_pool(QueryPool* queryPool)
+{
+	NullQueryPool* nullQueryPool = _queryPools.emplace_back(std::make_unique<NullQueryPool>()).get();
+	if (queryPool->info.type == QueryType::PIPELINE_STATISTICS)
+	{
+		nullQueryPool->valuesPerQuery = PIPELINE_STATISTICS_VALUE_COUNT;
+		nullQueryPool->beginStatistics.resize(queryPool->info.queryCount);
+	}
+	nullQueryPool->results.resize((uint64_t)queryPool->info.queryCount * nullQueryPool->valuesPerQuery);
+	queryPool->handle = nullQueryPool;
+}
+
+void NullRHI::begin_query(const CommandBuffer*, const QueryPool* queryPool, uint32_t queryIndex)
+{
+	NullQueryPool* nullQueryPool = static_cast<NullQueryPool*>(queryPool->handle);
+	if (queryPool->info.type == QueryType::PIPELINE_STATISTICS)
+		nullQueryPool->beginStatistics[queryIndex] = _pipelineStatistics;
+}
+
+void NullRHI::end_query(const CommandBuffer*, const QueryPool* queryPool, uint32_t queryIndex)
+{
+	NullQueryPool* nullQueryPool = static_cast<NullQueryPool*>(queryPool->handle);
+	uint64_t* values = &nullQueryPool->results[(uint64_t)queryIndex * nullQueryPool->valuesPerQuery];
+	switch (queryPool->info.type)
+	{
+		case QueryType::TIMESTAMP:
+			*values = _gpuTimeNs;
+			break;
+		case QueryType::PIPELINE_STATISTICS:
+			subtract_statistics(_pipelineStatistics, nullQueryPool->beginStatistics[queryIndex], values);
+			break;
+		default:
+			break;
+	}
+}
+
+void NullRHI::get_query_pool_result(
+	const QueryPool* queryPool,
+	std::vector<uint64_t>& outputData,
+	uint32_t queryIndex,
+	uint32_t queryCount,
+	uint32_t stride)
+{
+	const NullQueryPool* nullQueryPool = static_cast<const NullQueryPool*>(queryPool->handle);
+	outputData.assign((uint64_t)queryCount * stride / sizeof(uint64_t), 0);
+	uint64_t querySize = std::min<uint64_t>(stride, nullQueryPool->valuesPerQuery * sizeof(uint64_t));
+	for (uint32_t i = 0; i != queryCount; ++i)
+	{
+		const uint64_t* values = &nullQueryPool->results[(uint64_t)(queryIndex + i) * nullQueryPool->valuesPerQuery];
+		memcpy(reinterpret_cast<uint8_t*>(outputData.data()) + (uint64_t)i * stride, values, querySize);
+	}
+}
+
+void NullRHI::copy_query_pool_results(
+	const CommandBuffer*,
+	const QueryPool* queryPool,
+	uint32_t firstQuery,
+	uint32_t queryCount,
+	uint32_t stride,
+	const Buffer* dstBuffer,
+	uint32_t dstOffset)
+{
+	const NullQueryPool* nullQueryPool = static_cast<const NullQueryPool*>(queryPool->handle);
+	uint8_t* dstData = get_buffer_data(dstBuffer, dstOffset, (uint64_t)queryCount * stride);
+	if (!dstData)
+		return;
+
+	uint64_t querySize = std::min<uint64_t>(stride, nullQueryPool->valuesPerQuery * sizeof(uint64_t));
+	for (uint32_t i = 0; i != queryCount; ++i)
+	{
+		const uint64_t* values = &nullQueryPool->results[(uint64_t)(firstQuery + i) * nullQueryPool->valuesPerQuery];
+		memcpy(dstData + (uint64_t)i * stride, values, querySize);
+	}
+}
+
+void NullRHI::reset_query(const CommandBuffer*, const QueryPool* queryPool, uint32_t queryIndex, uint32_t queryCount)
+{
+	NullQueryPool* nullQueryPool = static_cast<NullQueryPool*>(queryPool->handle);
+	auto begin = nullQueryPool->results.begin() + (uint64_t)queryIndex * nullQueryPool->valuesPerQuery;
+	std::fill(begin, begin + (uint64_t)queryCount * nullQueryPool->valuesPerQuery, 0);
+}
+
+GPUMemoryUsage NullRHI::get_memory_usage()
+{
+	GPUMemoryUsage memoryUsage;
+	for (auto& buffer : _buffers)
+		memoryUsage.usage += buffer->data.size();
+	memoryUsage.total = memoryUsage.usage;
+	return memoryUsage;
+}
+
+void NullRHI::execute_draw(uint64_t vertexCount)
+{
+	// Triangle lists are assumed, all primitives pass clipping
+	uint64_t primitiveCount = vertexCount / 3;
+	uint64_t fragmentCount = primitiveCount * _costModel.fragmentsPerPrimitive;
+	_pipelineStatistics.inputAssemblyVertices += vertexCount;
+	_pipelineStatistics.inputAssemblyPrimitives += primitiveCount;
+	_pipelineStatistics.vertexShaderInvocations += vertexCount;
+	_pipelineStatistics.clippingInvocations += primitiveCount;
+	_pipelineStatistics.clippingPrimitives += primitiveCount;
+	_pipelineStatistics.fragmentShaderInvocations += fragmentCount;
+	_gpuTimeNs += _costModel.commandNs
+		+ (uint64_t)((double)vertexCount * _costModel.vertexNs)
+		+ (uint64_t)((double)fragmentCount * _costModel.fragmentNs);
+}
+
+uint8_t* NullRHI::get_buffer_data(const Buffer* buffer, uint64_t offset, uint64_t size)
+{
+	NullBuffer* nullBuffer = static_cast<NullBuffer*>(buffer->handle);
+	if (!nullBuffer || offset + size > nullBuffer->data.size())
+	{
+		LOG_ERROR("NullRHI::get_buffer_data(): Invalid buffer or range [{}, {})", offset, offset + size)
+		return nullptr;
+	}
+	return nullBuffer->data.data() + offset;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "engine_rhi.h"
+#include <memory>
+#include <vector>
+
+namespace ad_astris::rhi
+{
+	// Synthetic GPU costs that are used by NullRHI to advance its clock
+	struct NullRHICostModel
+	{
+		uint64_t commandNs{ 1000 };				// Fixed cost of every draw or dispatch
+		double vertexNs{ 0.01 };
+		double fragmentNs{ 0.005 };
+		double computeInvocationNs{ 0.01 };
+		uint64_t fragmentsPerPrimitive{ 64 };
+		uint32_t computeGroupSize{ 64 };		// Invocations per work group
+	};
+
+	// RHI without a GPU. Buffers are stored in CPU memory and commands are executed immediately in recording order on
+	// one simulated queue. Draws and dispatches advance a clock and pipeline statistics according to NullRHICostModel,
+	// so timestamp and pipeline statistics queries return deterministic results. Results are available as soon as
+	// queries have ended, which makes profiler aggregation testable without a device
+	class NullRHI final : public RHI
+	{
+		public:
+			NullRHI(uint32_t bufferCount = 2, const NullRHICostModel& costModel = NullRHICostModel());
+			virtual ~NullRHI() override;
+
+			virtual void init(RHIInitContext& initContext) override;
+			virtual void cleanup() override;
+
+			virtual void create_swap_chain(SwapChain*, SwapChainInfo*, acore::IWindow*) override { }
+			virtual void destroy_swap_chain(SwapChain*) override { }
+			virtual void get_swap_chain_texture_views(std::vector<TextureView>&) override { }
+			virtual void reset_cmd_buffers(uint32_t) override { }
+
+			virtual void create_buffer(Buffer* buffer, BufferInfo* info, void* data = nullptr) override;
+			virtual void create_buffer(Buffer* buffer, void* data = nullptr) override;
+			virtual void destroy_buffer(Buffer* buffer) override;
+			virtual void update_buffer_data(Buffer* buffer, uint64_t size, void* data) override;
+			virtual void create_texture(Texture*, TextureInfo*) override { }
+			virtual void create_texture(Texture*) override { }
+			virtual void create_texture_view(TextureView*, TextureViewInfo*, Texture*) override { }
+			virtual void create_texture_view(TextureView*, Texture*) override { }
+			virtual void create_buffer_view(BufferView*, BufferViewInfo*, Buffer*) override { }
+			virtual void create_buffer_view(BufferView*, Buffer*) override { }
+			virtual void create_sampler(Sampler*, SamplerInfo*) override { }
+			virtual void create_shader(Shader*, ShaderInfo*) override { }
+			virtual void create_render_pass(RenderPass*, RenderPassInfo*) override { }
+			virtual void create_graphics_pipeline(Pipeline*, GraphicsPipelineInfo*) override { }
+			virtual void create_compute_pipeline(Pipeline*, ComputePipelineInfo*) override { }
+
+			virtual uint32_t get_descriptor_index(Buffer*) override { return 0; }
+			virtual uint32_t get_descriptor_index(TextureView*) override { return 0; }
+			virtual uint32_t get_descriptor_index(BufferView*) override { return 0; }
+			virtual uint32_t get_descriptor_index(Sampler*) override { return 0; }
+			virtual void bind_uniform_buffer(Buffer*, uint32_t, uint32_t = 0, uint32_t = 0) override { }
+
+			virtual void begin_command_buffer(CommandBuffer* cmd, QueueType queueType = QueueType::GRAPHICS) override;
+			virtual void wait_command_buffer(CommandBuffer*, CommandBuffer*) override { }
+			virtual void submit(QueueType = QueueType::GRAPHICS, bool = false) override { }
+			virtual void present() override { }
+			virtual void wait_fences() override { }
+
+			virtual void copy_buffer(
+				CommandBuffer* cmd,
+				Buffer* srcBuffer,
+				Buffer* dstBuffer,
+				uint32_t size = 0,
+				uint32_t srcOffset = 0,
+				uint32_t dstOffset = 0) override;
+			virtual void copy_texture(CommandBuffer*, Texture*, Texture*) override { }
+			virtual void blit_texture(
+				CommandBuffer*,
+				Texture*,
+				Texture*,
+				const std::array<int32_t, 3>&,
+				const std::array<int32_t, 3>&,
+				uint32_t = 0,
+				uint32_t = 0,
+				uint32_t = 0,
+				uint32_t = 0) override { }
+			virtual void copy_buffer_to_texture(CommandBuffer*, Buffer*, Texture*) override { }
+			virtual void copy_texture_to_buffer(CommandBuffer*, Texture*, Buffer*) override { }
+			virtual void set_viewports(CommandBuffer*, std::vector<Viewport>&) override { }
+			virtual void set_scissors(CommandBuffer*, std::vector<Scissor>&) override { }
+			virtual void push_constants(CommandBuffer*, Pipeline*, void*) override { }
+			virtual void bind_vertex_buffer(CommandBuffer*, Buffer*) override { }
+			virtual void bind_index_buffer(CommandBuffer*, Buffer*) override { }
+			virtual void bind_pipeline(CommandBuffer*, Pipeline*) override { }
+			virtual void begin_render_pass(CommandBuffer*, RenderPass*, ClearValues&) override { }
+			virtual void end_render_pass(CommandBuffer*) override { }
+			virtual void begin_rendering(CommandBuffer*, RenderingBeginInfo*) override { }
+			virtual void begin_rendering(CommandBuffer*, SwapChain*, ClearValues*) override { }
+			virtual void end_rendering(CommandBuffer*) override { }
+			virtual void end_rendering(CommandBuffer*, SwapChain*) override { }
+			virtual void draw(CommandBuffer* cmd, uint64_t vertexCount) override;
+			virtual void draw_indexed(
+				CommandBuffer* cmd,
+				uint32_t indexCount,
+				uint32_t instanceCount,
+				uint32_t firstIndex,
+				int32_t vertexOffset,
+				uint32_t firstInstance) override;
+			// Indirect commands are read from buffer data
+			virtual void draw_indirect(CommandBuffer* cmd, Buffer* buffer, uint32_t offset, uint32_t drawCount, uint32_t stride) override;
+			virtual void draw_indexed_indirect(CommandBuffer* cmd, Buffer* buffer, uint32_t offset, uint32_t drawCount, uint32_t stride) override;
+			virtual void dispatch(CommandBuffer* cmd, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+			virtual void fill_buffer(CommandBuffer* cmd, Buffer* buffer, uint32_t dstOffset, uint32_t size, uint32_t data) override;
+			virtual void add_pipeline_barriers(CommandBuffer*, const std::vector<PipelineBarrier>&) override { }
+
+			virtual void wait_for_gpu() override { }
+
+			virtual void create_query_pool(QueryPool* queryPool, QueryPoolInfo* queryPoolInfo) override;
+			virtual void create_query_pool(QueryPool* queryPool) override;
+			virtual void begin_query(const CommandBuffer* cmd, const QueryPool* queryPool, uint32_t queryIndex) override;
+			virtual void end_query(const CommandBuffer* cmd, const QueryPool* queryPool, uint32_t queryIndex) override;
+			virtual void get_query_pool_result(
+				const QueryPool* queryPool,
+				std::vector<uint64_t>& outputData,
+				uint32_t queryIndex,
+				uint32_t queryCount,
+				uint32_t stride) override;
+			virtual void copy_query_pool_results(
+				const CommandBuffer* cmd,
+				const QueryPool* queryPool,
+				uint32_t firstQuery,
+				uint32_t queryCount,
+				uint32_t stride,
+				const Buffer* dstBuffer,
+				uint32_t dstOffset = 0) override;
+			virtual void reset_query(const CommandBuffer* cmd, const QueryPool* queryPool, uint32_t queryIndex, uint32_t queryCount) override;
+
+			virtual GPUMemoryUsage get_memory_usage() override;
+
+			// Simulated time since the RHI was created, the clock doesn't advance between commands
+			uint64_t get_gpu_time_ns() const { return _gpuTimeNs; }
+			// Statistics of all draws and dispatches since the RHI was created
+			const PipelineStatistics& get_pipeline_statistics() const { return _pipelineStatistics; }
+			void set_cost_model(const NullRHICostModel& costModel) { _costModel = costModel; }
+
+		private:
+			struct NullBuffer
+			{
+				std::vector<uint8_t> data;
+			};
+
+			struct NullQueryPool
+			{
+				std::vector<uint64_t> results;		// Timestamps or PipelineStatistics values
+				std::vector<PipelineStatistics> beginStatistics;
+				uint32_t valuesPerQuery{ 1 };
+			};
+
+			NullRHICostModel _costModel;
+			uint64_t _gpuTimeNs{ 0 };
+			PipelineStatistics _pipelineStatistics;
+			std::vector<std::unique_ptr<NullBuffer>> _buffers;
+			std::vector<std::unique_ptr<NullQueryPool>> _queryPools;
+			uint8_t _commandBufferHandle{ 0 };		// All command buffers share one queue
+
+			void execute_draw(uint64_t vertexCount);
+			uint8_t* get_buffer_data(const Buffer* buffer, uint64_t offset, uint64_t size);
+	};
+}
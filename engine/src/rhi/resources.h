@@ -1013,6 +1013,23 @@ namespace ad_astris::rhi
 		QueryPoolInfo info;
 	};
 
+	// Result of one QueryType::PIPELINE_STATISTICS query. Query pools collect all statistics,
+	// so the layout matches the order of statistics in query results
+	struct PipelineStatistics
+	{
+		uint64_t inputAssemblyVertices{ 0 };
+		uint64_t inputAssemblyPrimitives{ 0 };
+		uint64_t vertexShaderInvocations{ 0 };
+		uint64_t geometryShaderInvocations{ 0 };
+		uint64_t geometryShaderPrimitives{ 0 };
+		uint64_t clippingInvocations{ 0 };
+		uint64_t clippingPrimitives{ 0 };
+		uint64_t fragmentShaderInvocations{ 0 };
+		uint64_t tessellationControlShaderPatches{ 0 };
+		uint64_t tessellationEvaluationShaderInvocations{ 0 };
+		uint64_t computeShaderInvocations{ 0 };
+	};
+
 	struct GPUMemoryUsage
 	{
 		uint64_t total{ 0 };
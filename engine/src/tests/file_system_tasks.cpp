@@ -0,0 +1,1249 @@
+#include "file_system/IO.h"
+#include "file_system/async_io.h"
+#include "file_system/derived_data_cache.h"
+#include "file_system/file.h"
+#include "file_system/file_watcher.h"
+#include "file_system/pak_archive.h"
+#include "multithreading/task_composer.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+
+#include <lz4/lz4.h>
+#include <lz4/xxhash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace ad_astris;
+
+constexpr uint64_t BENCHMARK_FILE_SIZE = 256ull * 1024 * 1024;
+constexpr uint64_t HEADER_SIZE = 4096;
+constexpr uint32_t WARM_ITERATION_COUNT = 5;
+constexpr uint32_t ASYNC_FILE_COUNT = 16;
+constexpr uint64_t ASYNC_READ_SIZE = 1024 * 1024;
+constexpr uint32_t ASYNC_READ_COUNT = 256;
+constexpr uint32_t RECORD_SIZE = 64;
+constexpr uint32_t VECTORED_BUFFER_COUNT = 3000;			// More than IOV_MAX
+constexpr uint32_t SAVED_RESOURCE_COUNT = 256;
+constexpr uint32_t PROJECT_FILE_COUNT = 4000;
+constexpr uint64_t MAX_PROJECT_FILE_SIZE = 32 * 1024;
+constexpr uint32_t WATCHED_FILE_COUNT = 5000;
+constexpr uint32_t CHANGED_FILE_COUNT = 10;
+constexpr uint64_t BLOCK_FILE_BLOB_SIZE = 64ull * 1024 * 1024;
+constexpr uint32_t DERIVED_DATA_ENTRY_COUNT = 64;
+constexpr uint64_t DERIVED_DATA_SOURCE_SIZE = 4 * 1024 * 1024;
+
+std::vector<uint8_t> generate_data(uint64_t size)
+{
+	std::vector<uint8_t> data(size);
+	std::mt19937_64 generator(42);
+	for (uint64_t i = 0; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t value = generator();
+		memcpy(&data[i], &value, sizeof(uint64_t));
+	}
+	return data;
+}
+
+// Small values with repeated runs, compresses roughly like vertex and texture data
+std::vector<uint8_t> generate_compressible_data(uint64_t size)
+{
+	std::vector<uint8_t> data(size);
+	std::mt19937 generator(42);
+	for (uint64_t i = 0; i < size;)
+	{
+		uint8_t value = generator() % 16;
+		uint64_t runEnd = std::min<uint64_t>(size, i + 1 + generator() % 8);
+		for (; i != runEnd; ++i)
+			data[i] = value;
+	}
+	return data;
+}
+
+// Sums one byte per page, so every page of the range is faulted in
+uint64_t touch_pages(const uint8_t* data, uint64_t size)
+{
+	uint64_t checksum = 0;
+	for (uint64_t i = 0; i < size; i += 4096)
+		checksum += data[i];
+	return checksum;
+}
+
+// Returns false if the page cache can't be dropped on this platform
+bool evict_from_page_cache(const std::filesystem::path& path)
+{
+#ifdef _WIN32
+	return false;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+	fdatasync(file);
+	bool isEvicted = posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(file);
+	return isEvicted;
+#endif
+}
+
+bool validate_mapped_file(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::vector<uint8_t> data = generate_data(HEADER_SIZE * 3 + 17);
+	std::filesystem::path path = directory / "mapped.bin";
+	fileSystem->write(path.string(), data.data(), 1, data.size());
+
+	io::MappedFile mappedFile = fileSystem->map_file(path.string(), io::MapAccess::SEQUENTIAL);
+	if (!mappedFile.is_valid() || mappedFile.size() != data.size())
+	{
+		LOG_ERROR("Mapped file size is {}, expected {}", mappedFile.size(), data.size())
+		return false;
+	}
+	if (memcmp(mappedFile.data(), data.data(), data.size()) != 0)
+	{
+		LOG_ERROR("Mapped file content differs from the written data")
+		return false;
+	}
+
+	// Hints must be accepted for unaligned ranges and ranges that go out of the view
+	mappedFile.advise(io::MapAccess::RANDOM | io::MapAccess::WILL_NEED, HEADER_SIZE + 5, data.size());
+	mappedFile.advise(io::MapAccess::WILL_NEED, data.size() + 1);
+
+	io::MappedFile movedFile = std::move(mappedFile);
+	if (mappedFile.is_valid() || !movedFile.is_valid() || movedFile.data()[data.size() - 1] != data.back())
+	{
+		LOG_ERROR("Mapped file was not moved")
+		return false;
+	}
+	movedFile.unmap();
+	if (movedFile.is_valid() || movedFile.size())
+	{
+		LOG_ERROR("Mapped file was not unmapped")
+		return false;
+	}
+
+	std::filesystem::path emptyPath = directory / "empty.bin";
+	fileSystem->close(fileSystem->open(emptyPath.string(), "wb"));
+	if (fileSystem->map_file(emptyPath.string()).is_valid() || fileSystem->map_file((directory / "missing.bin").string()).is_valid())
+	{
+		LOG_ERROR("Empty or missing file was mapped")
+		return false;
+	}
+
+	return true;
+}
+
+// The path that was used before mapping: the whole file is copied into a heap buffer
+uint64_t read_with_copy(io::FileSystem* fileSystem, const std::filesystem::path& path, uint64_t accessedSize)
+{
+	io::Stream* stream = fileSystem->open(path.string(), "rb");
+	uint64_t size = stream->size();
+	std::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+	stream->read(data.get(), sizeof(uint8_t), size);
+	fileSystem->close(stream);
+	return touch_pages(data.get(), std::min(size, accessedSize));
+}
+
+uint64_t read_with_mapping(io::FileSystem* fileSystem, const std::filesystem::path& path, uint64_t accessedSize, io::MapAccess access)
+{
+	io::MappedFile mappedFile = fileSystem->map_file(path.string(), access);
+	return touch_pages(mappedFile.data(), std::min(mappedFile.size(), accessedSize));
+}
+
+void benchmark_read_paths(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::filesystem::path path = directory / "benchmark.bin";
+	std::vector<uint8_t> data = generate_data(BENCHMARK_FILE_SIZE);
+	fileSystem->write(path.string(), data.data(), 1, data.size());
+	data.clear();
+	data.shrink_to_fit();
+
+	struct ReadPath
+	{
+		const char* name;
+		std::function<uint64_t()> read;
+	};
+
+	ReadPath readPaths[] = {
+		{ "Copy, whole file", [&]() { return read_with_copy(fileSystem, path, BENCHMARK_FILE_SIZE); } },
+		{ "Mapping, whole file", [&]() { return read_with_mapping(fileSystem, path, BENCHMARK_FILE_SIZE, io::MapAccess::SEQUENTIAL); } },
+		{ "Copy, header", [&]() { return read_with_copy(fileSystem, path, HEADER_SIZE); } },
+		{ "Mapping, header", [&]() { return read_with_mapping(fileSystem, path, HEADER_SIZE, io::MapAccess::RANDOM); } }
+	};
+
+	bool isColdCacheSupported = evict_from_page_cache(path);
+	if (!isColdCacheSupported)
+	{
+		LOG_INFO("Page cache can't be dropped on this platform, only warm cache is measured")
+	}
+
+	for (auto& readPath : readPaths)
+	{
+		if (isColdCacheSupported)
+		{
+			evict_from_page_cache(path);
+			Timer timer;
+			uint64_t checksum = readPath.read();
+			LOG_INFO("{}, cold cache: {} ms, checksum {}", readPath.name, timer.elapsed_milliseconds(), checksum)
+		}
+
+		readPath.read();
+		Timer timer;
+		uint64_t checksum = 0;
+		for (uint32_t i = 0; i != WARM_ITERATION_COUNT; ++i)
+			checksum += readPath.read();
+		LOG_INFO("{}, warm cache: {} ms, checksum {}", readPath.name, timer.elapsed_milliseconds() / WARM_ITERATION_COUNT, checksum)
+	}
+}
+
+bool validate_stream(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::filesystem::path path = directory / "stream.bin";
+	std::vector<uint8_t> data = generate_data(HEADER_SIZE * 20 + 7);
+	io::EngineFileSystem smallBufferFileSystem(directory.string().c_str(), 4096);
+
+	// Small writes are buffered, large writes bypass the buffer, seeking back overwrites data
+	io::Stream* stream = smallBufferFileSystem.open(path.string(), "wb");
+	uint64_t offset = 0;
+	for (uint64_t chunkSize = 1; offset < data.size(); chunkSize *= 3)
+	{
+		chunkSize = std::min<uint64_t>(chunkSize, data.size() - offset);
+		stream->write(&data[offset], 1, chunkSize);
+		offset += chunkSize;
+	}
+	std::vector<uint8_t> patch(100, 0xAB);
+	stream->seek(10);
+	stream->write(patch.data(), 1, patch.size());
+	std::copy(patch.begin(), patch.end(), data.begin() + 10);
+	if (stream->size() != data.size() || stream->tell() != 10 + patch.size())
+	{
+		LOG_ERROR("Stream size {} or position {} is invalid", stream->size(), stream->tell())
+		return false;
+	}
+	smallBufferFileSystem.close(stream);
+
+	// Reads of different sizes and positional reads from several threads
+	stream = smallBufferFileSystem.open(path.string(), "rb");
+	std::vector<uint8_t> readData(data.size());
+	offset = 0;
+	for (uint64_t chunkSize = 1; offset < data.size(); chunkSize *= 2)
+	{
+		chunkSize = std::min<uint64_t>(chunkSize, data.size() - offset);
+		offset += stream->read(&readData[offset], 1, chunkSize);
+	}
+	bool isReadValid = readData == data && stream->read(readData.data(), 1, 1) == 0;
+
+	std::atomic<uint32_t> validThreadCount{ 0 };
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != 4; ++i)
+	{
+		threads.emplace_back([&, i]()
+		{
+			std::vector<uint8_t> threadData(RECORD_SIZE);
+			bool isValid = true;
+			for (uint64_t recordOffset = i * RECORD_SIZE; recordOffset + RECORD_SIZE <= data.size(); recordOffset += 4 * RECORD_SIZE)
+			{
+				isValid &= stream->read_at(threadData.data(), RECORD_SIZE, recordOffset) == RECORD_SIZE
+					&& !memcmp(threadData.data(), &data[recordOffset], RECORD_SIZE);
+			}
+			validThreadCount.fetch_add(isValid);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	smallBufferFileSystem.close(stream);
+
+	if (!isReadValid || validThreadCount.load() != threads.size())
+	{
+		LOG_ERROR("Stream reads are invalid")
+		return false;
+	}
+
+	// Appending and vectored writes with more buffers than one system call accepts
+	std::vector<io::WriteBuffer> buffers;
+	for (uint32_t i = 0; i != VECTORED_BUFFER_COUNT; ++i)
+		buffers.push_back({ &data[i], i % 3 ? 1u : 0u });
+	uint64_t vectoredSize = 0;
+	for (auto& buffer : buffers)
+		vectoredSize += buffer.size;
+
+	stream = fileSystem->open(path.string(), "ab");
+	uint64_t writtenSize = stream->write_vectored(buffers.data(), buffers.size());
+	fileSystem->close(stream);
+	fileSystem->write((directory / "vectored.bin").string(), buffers.data(), buffers.size());
+
+	io::MappedFile appendedFile = fileSystem->map_file(path.string());
+	io::MappedFile vectoredFile = fileSystem->map_file((directory / "vectored.bin").string());
+	bool isVectoredValid = writtenSize == vectoredSize && appendedFile.size() == data.size() + vectoredSize
+		&& vectoredFile.size() == vectoredSize && !memcmp(appendedFile.data(), data.data(), data.size())
+		&& !memcmp(appendedFile.data() + data.size(), vectoredFile.data(), vectoredSize);
+	for (uint32_t i = 0, vectoredOffset = 0; i != VECTORED_BUFFER_COUNT && isVectoredValid; ++i)
+	{
+		if (buffers[i].size)
+			isVectoredValid = vectoredFile.data()[vectoredOffset++] == data[i];
+	}
+	if (!isVectoredValid)
+	{
+		LOG_ERROR("Vectored writes are invalid")
+		return false;
+	}
+
+	return true;
+}
+
+bool validate_pak(const std::filesystem::path& directory)
+{
+	std::filesystem::path projectDirectory = directory / "pak_project";
+	std::filesystem::path pakPath = directory / ("project" + std::string(io::PAK_FILE_EXTENSION));
+	io::EngineFileSystem fileSystem(projectDirectory.string().c_str());
+
+	std::vector<uint8_t> data = generate_data(HEADER_SIZE * 3 + 5);
+	std::string text(HEADER_SIZE * 4, 'a');
+	std::filesystem::create_directories(projectDirectory / "content" / "models");
+	std::filesystem::create_directories(projectDirectory / "configs");
+	fileSystem.write((projectDirectory / "content" / "models" / "model.aares").string(), data.data(), 1, data.size());
+	fileSystem.write((projectDirectory / "configs" / "resource_table.ini").string(), text.data(), 1, text.size());
+	std::ofstream(projectDirectory / "empty.aares").close();
+
+	for (io::PakCompression compression : { io::PakCompression::NONE, io::PakCompression::LZ4 })
+	{
+		io::PakWriter writer;
+		writer.add_directory(projectDirectory);
+		if (!writer.write(pakPath, compression) || !fileSystem.mount_pak(pakPath.string(), projectDirectory.string()))
+			return false;
+
+		// Loose files are changed, so data that is read from them is invalid
+		std::vector<uint8_t> looseData(data.size(), 0);
+		fileSystem.write((projectDirectory / "content" / "models" / "model.aares").string(), looseData.data(), 1, looseData.size());
+		fileSystem.write((projectDirectory / "loose.aares").string(), looseData.data(), 1, looseData.size());
+
+		io::MappedFile model = fileSystem.map_file("content/models/../models/model.aares", io::MapAccess::SEQUENTIAL);
+		io::MappedFile config = fileSystem.map_file((projectDirectory / "configs" / "resource_table.ini").string());
+		io::MappedFile looseFile = fileSystem.map_file("loose.aares");
+		bool isValid = model.size() == data.size() && !memcmp(model.data(), data.data(), data.size())
+			&& config.size() == text.size() && !memcmp(config.data(), text.data(), text.size())
+			&& looseFile.size() == looseData.size() && fileSystem.is_packed("empty.aares") && !fileSystem.is_packed("loose.aares")
+			&& !fileSystem.is_packed("missing.aares") && !fileSystem.is_packed("../pak_project/missing.aares");
+
+		io::Stream* stream = fileSystem.open("content/models/model.aares", "rb");
+		std::vector<uint8_t> streamData(data.size());
+		isValid &= stream && stream->read(streamData.data(), 1, streamData.size()) == data.size() && streamData == data
+			&& stream->write(data.data(), 1, 1) == 0;
+		if (stream)
+			fileSystem.close(stream);
+
+		// Views keep the archive mapping alive after unmounting
+		isValid &= fileSystem.unmount_pak(pakPath.string()) && !fileSystem.is_packed("empty.aares")
+			&& !memcmp(model.data(), data.data(), data.size());
+		io::MappedFile unpackedModel = fileSystem.map_file("content/models/model.aares");
+		isValid &= unpackedModel.size() == looseData.size() && !memcmp(unpackedModel.data(), looseData.data(), looseData.size());
+
+		fileSystem.write((projectDirectory / "content" / "models" / "model.aares").string(), data.data(), 1, data.size());
+		std::filesystem::remove(projectDirectory / "loose.aares");
+		if (!isValid)
+		{
+			LOG_ERROR("Pak archive with compression {} is invalid", static_cast<uint32_t>(compression))
+			return false;
+		}
+	}
+
+	// Lookups are binary searches, so archives with an unsorted table of contents are rejected
+	io::PakWriter writer;
+	writer.add_directory(projectDirectory);
+	if (!writer.write(pakPath))
+		return false;
+	{
+		io::PakHeader header;
+		io::PakEntry entries[2];
+		std::fstream pakFile(pakPath, std::ios::binary | std::ios::in | std::ios::out);
+		pakFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+		pakFile.seekg(header.tocOffset);
+		pakFile.read(reinterpret_cast<char*>(entries), sizeof(entries));
+		std::swap(entries[0], entries[1]);
+		pakFile.seekp(header.tocOffset);
+		pakFile.write(reinterpret_cast<const char*>(entries), sizeof(entries));
+	}
+	if (fileSystem.mount_pak(pakPath.string(), projectDirectory.string()))
+		return false;
+
+	std::filesystem::remove_all(projectDirectory);
+	std::filesystem::remove(pakPath);
+	return true;
+}
+
+// Startup reads the resource table and every resource of a project
+void benchmark_pak(const std::filesystem::path& directory)
+{
+	std::filesystem::path projectDirectory = directory / "pak_benchmark_project";
+	std::filesystem::path pakPath = directory / ("pak_benchmark" + std::string(io::PAK_FILE_EXTENSION));
+	std::vector<std::string> paths;
+	std::string resourceTable;
+	{
+		io::EngineFileSystem fileSystem(projectDirectory.string().c_str());
+		std::vector<uint8_t> data = generate_data(MAX_PROJECT_FILE_SIZE);
+		std::mt19937 generator(42);
+		for (uint32_t i = 0; i != PROJECT_FILE_COUNT; ++i)
+		{
+			std::string path = "content/folder_" + std::to_string(i % 16) + "/resource_" + std::to_string(i) + ".aares";
+			std::filesystem::create_directories((projectDirectory / path).parent_path());
+			fileSystem.write(path, data.data(), 1, generator() % MAX_PROJECT_FILE_SIZE + 1);
+			resourceTable += "[" + path + "]\nUUID=" + std::to_string(i) + "\n";
+			paths.push_back(path);
+		}
+		std::filesystem::create_directories(projectDirectory / "configs");
+		fileSystem.write("configs/resource_table.ini", resourceTable.data(), 1, resourceTable.size());
+		paths.push_back("configs/resource_table.ini");
+	}
+
+	Timer timer;
+	io::PakWriter writer;
+	writer.add_directory(projectDirectory);
+	writer.write(pakPath);
+	LOG_INFO("Packed {} files in {} ms", writer.get_file_count(), timer.elapsed_milliseconds())
+
+	auto load_project = [&](bool isPacked)
+	{
+		io::EngineFileSystem fileSystem(projectDirectory.string().c_str());
+		if (isPacked)
+			fileSystem.mount_pak(pakPath.string(), projectDirectory.string());
+		uint64_t checksum = 0;
+		for (auto& path : paths)
+		{
+			io::MappedFile mappedFile = fileSystem.map_file(path, io::MapAccess::SEQUENTIAL);
+			checksum += touch_pages(mappedFile.data(), mappedFile.size());
+		}
+		return checksum;
+	};
+
+	auto evict_project = [&](bool isPacked)
+	{
+		if (isPacked)
+			return evict_from_page_cache(pakPath);
+		bool isEvicted = true;
+		for (auto& path : paths)
+			isEvicted &= evict_from_page_cache(projectDirectory / path);
+		return isEvicted;
+	};
+
+	for (bool isPacked : { false, true })
+	{
+		const char* name = isPacked ? "Pak" : "Loose files";
+		if (evict_project(isPacked))
+		{
+			timer.record();
+			uint64_t checksum = load_project(isPacked);
+			LOG_INFO("{}, cold cache: {} files loaded in {} ms, checksum {}", name, paths.size(), timer.elapsed_milliseconds(), checksum)
+		}
+
+		load_project(isPacked);
+		timer.record();
+		uint64_t checksum = 0;
+		for (uint32_t i = 0; i != WARM_ITERATION_COUNT; ++i)
+			checksum += load_project(isPacked);
+		LOG_INFO("{}, warm cache: {} files loaded in {} ms, checksum {}", name, paths.size(), timer.elapsed_milliseconds() / WARM_ITERATION_COUNT, checksum)
+	}
+}
+
+// Events are delivered by a background thread, so changes are polled for a limited time
+bool wait_for_changed_files(io::FileWatcher& fileWatcher, std::vector<std::string>& changedFiles, size_t expectedCount)
+{
+	Timer timer;
+	while (changedFiles.size() < expectedCount && timer.elapsed_milliseconds() < 1000.0f)
+	{
+		if (!fileWatcher.consume_changed_files(changedFiles))
+			return false;
+		std::sort(changedFiles.begin(), changedFiles.end());
+		changedFiles.erase(std::unique(changedFiles.begin(), changedFiles.end()), changedFiles.end());
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return changedFiles.size() == expectedCount;
+}
+
+bool validate_file_watcher(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	io::FileWatcher fileWatcher;
+	if (!fileWatcher.is_supported())
+	{
+		LOG_INFO("File watching is not supported on this platform")
+		return true;
+	}
+
+	std::filesystem::path watchedDirectory = directory / "watched";
+	std::filesystem::create_directories(watchedDirectory / "subdirectory");
+	std::vector<uint8_t> data = generate_data(HEADER_SIZE);
+	fileSystem->write((watchedDirectory / "modified.hlsl").string(), data.data(), 1, data.size());
+	fileSystem->write((watchedDirectory / "removed.hlsl").string(), data.data(), 1, data.size());
+	fileSystem->write((watchedDirectory / "renamed.hlsl").string(), data.data(), 1, data.size());
+
+	if (!fileWatcher.watch(watchedDirectory) || !fileWatcher.watch(watchedDirectory / ".") || !fileWatcher.is_watched(watchedDirectory)
+		|| fileWatcher.is_watched(watchedDirectory / "subdirectory") || fileWatcher.watch(directory / "missing"))
+	{
+		LOG_ERROR("Watched directories are invalid")
+		return false;
+	}
+
+	// Subdirectories are not watched
+	fileSystem->write((watchedDirectory / "modified.hlsl").string(), data.data(), 1, data.size(), "ab");
+	fileSystem->write((watchedDirectory / "created.hlsl").string(), data.data(), 1, data.size());
+	fileSystem->write((watchedDirectory / "subdirectory" / "ignored.hlsl").string(), data.data(), 1, data.size());
+	std::filesystem::remove(watchedDirectory / "removed.hlsl");
+	std::filesystem::rename(watchedDirectory / "renamed.hlsl", watchedDirectory / "renamed_new.hlsl");
+
+	std::vector<std::string> changedFiles;
+	std::vector<std::string> expectedFiles;
+	for (const char* fileName : { "created.hlsl", "modified.hlsl", "removed.hlsl", "renamed.hlsl", "renamed_new.hlsl" })
+		expectedFiles.push_back(io::FileWatcher::normalize_path(watchedDirectory / fileName));
+
+	if (!wait_for_changed_files(fileWatcher, changedFiles, expectedFiles.size()) || changedFiles != expectedFiles)
+	{
+		LOG_ERROR("Changed files are invalid, {} files were reported", changedFiles.size())
+		return false;
+	}
+
+	changedFiles.clear();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	if (!fileWatcher.consume_changed_files(changedFiles) || !changedFiles.empty())
+		return false;
+
+	// Removed directories are not watched anymore and callers are told to check all files.
+	// A recreated directory can be watched again
+	std::filesystem::remove_all(watchedDirectory);
+	Timer timer;
+	while (fileWatcher.is_watched(watchedDirectory) && timer.elapsed_milliseconds() < 1000.0f)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	if (fileWatcher.is_watched(watchedDirectory) || fileWatcher.is_watched(watchedDirectory / ".") || fileWatcher.consume_changed_files(changedFiles))
+		return false;
+
+	std::filesystem::create_directories(watchedDirectory);
+	changedFiles.clear();
+	if (!fileWatcher.watch(watchedDirectory))
+		return false;
+	fileSystem->write((watchedDirectory / "created.hlsl").string(), data.data(), 1, data.size());
+	return wait_for_changed_files(fileWatcher, changedFiles, 1) && changedFiles[0] == expectedFiles[0];
+}
+
+// Compares checking timestamps of every file with consuming files that were changed
+void benchmark_file_watcher(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	io::FileWatcher fileWatcher;
+	if (!fileWatcher.is_supported())
+		return;
+
+	std::filesystem::path watchedDirectory = directory / "watched_benchmark";
+	std::filesystem::create_directories(watchedDirectory);
+	std::vector<std::filesystem::path> paths;
+	std::vector<uint8_t> data = generate_data(HEADER_SIZE);
+	for (uint32_t i = 0; i != WATCHED_FILE_COUNT; ++i)
+	{
+		paths.push_back(watchedDirectory / ("shader_" + std::to_string(i) + ".hlsl"));
+		fileSystem->write(paths.back().string(), data.data(), 1, data.size());
+	}
+
+	std::vector<std::filesystem::file_time_type> timeStamps;
+	Timer timer;
+	for (auto& path : paths)
+		timeStamps.push_back(std::filesystem::last_write_time(path));
+	LOG_INFO("Timestamps: {} files checked in {} ms", timeStamps.size(), timer.elapsed_milliseconds())
+
+	fileWatcher.watch(watchedDirectory);
+	for (uint32_t i = 0; i != CHANGED_FILE_COUNT; ++i)
+		fileSystem->write(paths[i * 7].string(), data.data(), 1, data.size(), "ab");
+
+	// Events are delivered by a background thread before they are consumed
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	std::vector<std::string> changedFiles;
+	timer.record();
+	fileWatcher.consume_changed_files(changedFiles);
+	LOG_INFO("File watcher: {} changed files of {} consumed in {} ms", changedFiles.size(), WATCHED_FILE_COUNT, timer.elapsed_milliseconds())
+}
+
+bool validate_async_io(io::FileSystem* fileSystem, const std::filesystem::path& directory, bool isIOUringEnabled)
+{
+	io::AsyncIOSettings settings;
+	settings.isIOUringEnabled = isIOUringEnabled;
+	tasks::TaskComposer taskComposer;
+	io::AsyncIOService service(fileSystem, &taskComposer, settings);
+	tasks::TaskGroup taskGroup;
+
+	std::vector<std::vector<uint8_t>> fileData;
+	std::vector<io::IORequest> writeRequests;
+	for (uint32_t i = 0; i != ASYNC_FILE_COUNT; ++i)
+	{
+		fileData.push_back(generate_data(HEADER_SIZE * (i + 1) + i));
+		io::IORequest& request = writeRequests.emplace_back();
+		request.type = io::IORequestType::WRITE;
+		request.path = (directory / ("async_" + std::to_string(i) + ".bin")).string();
+		request.data = fileData.back().data();
+		request.size = fileData.back().size();
+	}
+	service.submit(writeRequests, taskGroup);
+	taskComposer.wait(taskGroup);
+
+	// Whole files are read into buffers of the service, the second half of each file is read into a user buffer
+	std::atomic<uint32_t> validReadCount{ 0 };
+	std::vector<std::vector<uint8_t>> halves(ASYNC_FILE_COUNT);
+	std::vector<io::IORequest> readRequests;
+	for (uint32_t i = 0; i != ASYNC_FILE_COUNT; ++i)
+	{
+		const std::vector<uint8_t>& data = fileData[i];
+		io::IORequest& request = readRequests.emplace_back();
+		request.path = writeRequests[i].path;
+		request.priority = static_cast<io::IOPriority>(i % io::IO_PRIORITY_COUNT);
+		request.completionHandler = [&data, &validReadCount](io::IOResult& result)
+		{
+			if (result.status == io::IOStatus::COMPLETED && result.size == data.size() && result.ownedData
+				&& !memcmp(result.data, data.data(), data.size()))
+				validReadCount.fetch_add(1);
+		};
+
+		halves[i].resize(data.size() / 2);
+		io::IORequest& halfRequest = readRequests.emplace_back(request);
+		halfRequest.offset = data.size() - halves[i].size();
+		halfRequest.data = halves[i].data();
+		halfRequest.completionHandler = [&data, &half = halves[i], &validReadCount](io::IOResult& result)
+		{
+			if (result.status == io::IOStatus::COMPLETED && result.size == half.size() && !result.ownedData
+				&& !memcmp(half.data(), data.data() + data.size() - half.size(), half.size()))
+				validReadCount.fetch_add(1);
+		};
+	}
+
+	io::IORequest& missingRequest = readRequests.emplace_back();
+	missingRequest.path = (directory / "missing.bin").string();
+	io::IOStatus missingStatus = io::IOStatus::PENDING;
+	missingRequest.completionHandler = [&missingStatus](io::IOResult& result) { missingStatus = result.status; };
+
+	service.submit(readRequests, taskGroup);
+	taskComposer.wait(taskGroup);
+
+	if (validReadCount.load() != ASYNC_FILE_COUNT * 2 || missingStatus != io::IOStatus::FAILED)
+	{
+		LOG_ERROR("{}: {} of {} reads are valid", service.get_backend_name(), validReadCount.load(), ASYNC_FILE_COUNT * 2)
+		return false;
+	}
+
+	io::IOStatistics statistics = service.get_statistics();
+	if (statistics.completedRequestCount != ASYNC_FILE_COUNT * 3 || statistics.failedRequestCount != 1 || statistics.queueDepth)
+	{
+		LOG_ERROR("{}: Statistics are invalid", service.get_backend_name())
+		return false;
+	}
+
+	return true;
+}
+
+// Handlers are executed on the backend thread without TaskComposer, so the order of completions is observable
+bool validate_async_io_priorities(io::FileSystem* fileSystem, const std::filesystem::path& directory, bool isIOUringEnabled)
+{
+	io::AsyncIOSettings settings;
+	settings.isIOUringEnabled = isIOUringEnabled;
+	settings.queueDepth = 1;
+	settings.workerThreadCount = 1;
+	io::AsyncIOService service(fileSystem, nullptr, settings);
+	tasks::TaskGroup lowGroup, highGroup;
+
+	// Only completed requests are recorded, canceled requests are finished on the thread that cancels them
+	std::mutex orderMutex;
+	std::vector<io::IOPriority> completionOrder;
+	uint32_t canceledStatusCount = 0;
+	auto create_requests = [&](io::IOPriority priority)
+	{
+		std::vector<io::IORequest> requests(ASYNC_FILE_COUNT);
+		for (uint32_t i = 0; i != ASYNC_FILE_COUNT; ++i)
+		{
+			requests[i].path = (directory / ("async_" + std::to_string(i) + ".bin")).string();
+			requests[i].priority = priority;
+			requests[i].completionHandler = [&, priority](io::IOResult& result)
+			{
+				std::scoped_lock<std::mutex> lock(orderMutex);
+				if (result.status == io::IOStatus::COMPLETED)
+					completionOrder.push_back(priority);
+				else if (result.status == io::IOStatus::CANCELED)
+					++canceledStatusCount;
+			};
+		}
+		return requests;
+	};
+
+	io::IOBatchID lowBatchID = service.submit(create_requests(io::IOPriority::LOW), lowGroup);
+	service.submit(create_requests(io::IOPriority::HIGH), highGroup);
+	uint32_t canceledCount = service.cancel(lowBatchID);
+	while (lowGroup.get_pending_task_count() || highGroup.get_pending_task_count())
+		std::this_thread::yield();
+
+	// Low priority requests that were issued before the high priority batch was submitted can complete first,
+	// other low priority requests are canceled or completed after the high priority batch
+	uint32_t lowBeforeHigh = 0;
+	while (lowBeforeHigh != completionOrder.size() && completionOrder[lowBeforeHigh] == io::IOPriority::LOW)
+		++lowBeforeHigh;
+	bool isHighBatchContiguous = completionOrder.size() >= lowBeforeHigh + ASYNC_FILE_COUNT
+		&& std::count(completionOrder.begin() + lowBeforeHigh, completionOrder.begin() + lowBeforeHigh + ASYNC_FILE_COUNT, io::IOPriority::HIGH) == ASYNC_FILE_COUNT;
+	if (canceledCount != canceledStatusCount || !isHighBatchContiguous || completionOrder.size() + canceledCount != ASYNC_FILE_COUNT * 2)
+	{
+		LOG_ERROR("{}: Priorities or cancellation are invalid, {} low priority requests were canceled", service.get_backend_name(), canceledCount)
+		return false;
+	}
+
+	LOG_INFO("{}: {} low priority requests completed before high priority ones, {} were canceled", service.get_backend_name(), lowBeforeHigh, canceledCount)
+	return true;
+}
+
+void benchmark_async_io(io::FileSystem* fileSystem, const std::filesystem::path& directory, bool isIOUringEnabled)
+{
+	std::filesystem::path path = directory / "benchmark.bin";
+	std::vector<uint64_t> offsets(ASYNC_READ_COUNT);
+	std::mt19937_64 generator(7);
+	for (auto& offset : offsets)
+		offset = generator() % (BENCHMARK_FILE_SIZE / ASYNC_READ_SIZE) * ASYNC_READ_SIZE;
+	std::vector<uint8_t> buffer(ASYNC_READ_SIZE * ASYNC_READ_COUNT);
+
+	io::AsyncIOSettings settings;
+	settings.isIOUringEnabled = isIOUringEnabled;
+	tasks::TaskComposer taskComposer;
+	io::AsyncIOService service(fileSystem, &taskComposer, settings);
+	tasks::TaskGroup taskGroup;
+
+	std::vector<io::IORequest> requests(ASYNC_READ_COUNT);
+	std::atomic<uint64_t> checksum{ 0 };
+	for (uint32_t i = 0; i != ASYNC_READ_COUNT; ++i)
+	{
+		requests[i].path = path.string();
+		requests[i].offset = offsets[i];
+		requests[i].size = ASYNC_READ_SIZE;
+		requests[i].data = &buffer[i * ASYNC_READ_SIZE];
+		requests[i].completionHandler = [&checksum](io::IOResult& result)
+		{
+			checksum.fetch_add(touch_pages(result.data, result.size));
+		};
+	}
+
+	evict_from_page_cache(path);
+	Timer timer;
+	service.submit(requests, taskGroup);
+	taskComposer.wait(taskGroup);
+	double elapsedMs = timer.elapsed_milliseconds();
+
+	io::IOStatistics statistics = service.get_statistics();
+	LOG_INFO("{}: {} reads of {} KiB in {} ms, {} MiB/s, latency p50 {} ms, p99 {} ms, max queue depth {}, checksum {}",
+		service.get_backend_name(), ASYNC_READ_COUNT, ASYNC_READ_SIZE / 1024, elapsedMs,
+		ASYNC_READ_SIZE * ASYNC_READ_COUNT / (1024.0 * 1024.0) / (elapsedMs / 1000.0),
+		statistics.latency.p50, statistics.latency.p99, statistics.maxQueueDepth, checksum.load())
+}
+
+// Reading small records, the way serializers read files
+void benchmark_stream_reads(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::filesystem::path path = directory / "benchmark.bin";
+	uint64_t recordCount = BENCHMARK_FILE_SIZE / RECORD_SIZE / 4;
+	uint8_t record[RECORD_SIZE];
+
+	Timer timer;
+	uint64_t checksum = 0;
+	FILE* file = fopen(path.string().c_str(), "rb");
+	for (uint64_t i = 0; i != recordCount; ++i)
+	{
+		fread(record, 1, RECORD_SIZE, file);
+		checksum += record[0];
+	}
+	fclose(file);
+	LOG_INFO("stdio: {} records of {} bytes in {} ms, checksum {}", recordCount, RECORD_SIZE, timer.elapsed_milliseconds(), checksum)
+
+	timer.record();
+	checksum = 0;
+	io::Stream* stream = fileSystem->open(path.string(), "rb");
+	for (uint64_t i = 0; i != recordCount; ++i)
+	{
+		stream->read(record, 1, RECORD_SIZE);
+		checksum += record[0];
+	}
+	fileSystem->close(stream);
+	LOG_INFO("Stream: {} records of {} bytes in {} ms, checksum {}", recordCount, RECORD_SIZE, timer.elapsed_milliseconds(), checksum)
+}
+
+bool validate_atomic_write(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	// Threads replace the same file. Renames can fail while another thread replaces the file, e.g. with sharing
+	// violations on Windows, but the file must always hold one complete version
+	std::filesystem::path path = directory / "atomic.bin";
+	std::vector<std::vector<uint8_t>> versions;
+	for (uint32_t i = 0; i != 8; ++i)
+		versions.push_back(std::vector<uint8_t>(RECORD_SIZE * (i + 1), static_cast<uint8_t>(i + 1)));
+
+	std::atomic<uint32_t> writtenCount{ 0 };
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != versions.size(); ++i)
+	{
+		threads.emplace_back([&, i]()
+		{
+			io::WriteBuffer buffers[2] = { { versions[i].data(), RECORD_SIZE }, { versions[i].data() + RECORD_SIZE, versions[i].size() - RECORD_SIZE } };
+			for (uint32_t j = 0; j != 16; ++j)
+				writtenCount.fetch_add(fileSystem->write_atomic(path.string(), buffers, 2));
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	io::MappedFile mappedFile = fileSystem->map_file(path.string());
+	bool isValid = writtenCount.load() != 0 && mappedFile.is_valid()
+		&& mappedFile.size() && mappedFile.size() % RECORD_SIZE == 0 && mappedFile.size() / RECORD_SIZE <= versions.size();
+	if (isValid)
+	{
+		const std::vector<uint8_t>& version = versions[mappedFile.size() / RECORD_SIZE - 1];
+		isValid = !memcmp(mappedFile.data(), version.data(), version.size());
+	}
+	mappedFile = io::MappedFile();
+
+	// Failed writes don't leave temporary files
+	io::WriteBuffer buffer = { versions[0].data(), versions[0].size() };
+	isValid &= !fileSystem->write_atomic((directory / "missing_directory" / "atomic.bin").string(), &buffer, 1);
+	for (auto& entry : std::filesystem::directory_iterator(directory))
+	{
+		if (entry.path().extension() == ".tmp")
+			isValid = false;
+	}
+	if (!isValid)
+	{
+		LOG_ERROR("Atomic writes are invalid")
+		return false;
+	}
+	return true;
+}
+
+// Resources are saved as a header, metadata and a compressed blob
+void benchmark_resource_saving(io::FileSystem* fileSystem, tasks::TaskComposer* taskComposer, const std::filesystem::path& directory)
+{
+	std::vector<uint8_t> blob = generate_data(256 * 1024);
+	std::string metadata(2048, 'm');
+	uint64_t header[3] = { metadata.size(), blob.size(), blob.size() };
+	std::vector<io::WriteBuffer> buffers = { { header, sizeof(header) }, { metadata.data(), metadata.size() }, { blob.data(), blob.size() } };
+
+	Timer timer;
+	for (uint32_t i = 0; i != SAVED_RESOURCE_COUNT; ++i)
+	{
+		uint64_t size = sizeof(header) + metadata.size() + blob.size();
+		std::unique_ptr<uint8_t[]> data(new uint8_t[size]);
+		memcpy(data.get(), header, sizeof(header));
+		memcpy(data.get() + sizeof(header), metadata.data(), metadata.size());
+		memcpy(data.get() + sizeof(header) + metadata.size(), blob.data(), blob.size());
+		fileSystem->write((directory / ("concatenated_" + std::to_string(i) + ".bin")).string(), data.get(), 1, size);
+	}
+	LOG_INFO("Concatenated: {} resources saved in {} ms", SAVED_RESOURCE_COUNT, timer.elapsed_milliseconds())
+
+	timer.record();
+	for (uint32_t i = 0; i != SAVED_RESOURCE_COUNT; ++i)
+		fileSystem->write((directory / ("vectored_" + std::to_string(i) + ".bin")).string(), buffers.data(), buffers.size());
+	LOG_INFO("Vectored: {} resources saved in {} ms", SAVED_RESOURCE_COUNT, timer.elapsed_milliseconds())
+
+	timer.record();
+	for (uint32_t i = 0; i != SAVED_RESOURCE_COUNT; ++i)
+		fileSystem->write_atomic((directory / ("vectored_" + std::to_string(i) + ".bin")).string(), buffers.data(), buffers.size());
+	LOG_INFO("Atomic: {} resources saved in {} ms", SAVED_RESOURCE_COUNT, timer.elapsed_milliseconds())
+
+	// Batches of resources are written from TaskComposer threads, the way resource tables save dirty resources
+	timer.record();
+	tasks::TaskGroup taskGroup;
+	taskComposer->dispatch(taskGroup, SAVED_RESOURCE_COUNT, 8, [&](tasks::TaskExecutionInfo executionInfo)
+	{
+		std::string path = (directory / ("vectored_" + std::to_string(executionInfo.globalTaskIndex) + ".bin")).string();
+		fileSystem->write_atomic(path, buffers.data(), buffers.size());
+	});
+	taskComposer->wait(taskGroup);
+	LOG_INFO("Atomic on TaskComposer: {} resources saved in {} ms", SAVED_RESOURCE_COUNT, timer.elapsed_milliseconds())
+}
+
+// Blocking stdio reads on one thread, the way EngineFileStream reads files
+void benchmark_blocking_io(const std::filesystem::path& directory)
+{
+	std::filesystem::path path = directory / "benchmark.bin";
+	std::mt19937_64 generator(7);
+	std::vector<uint8_t> buffer(ASYNC_READ_SIZE);
+
+	evict_from_page_cache(path);
+	Timer timer;
+	uint64_t checksum = 0;
+	FILE* file = fopen(path.string().c_str(), "rb");
+	for (uint32_t i = 0; i != ASYNC_READ_COUNT; ++i)
+	{
+		uint64_t offset = generator() % (BENCHMARK_FILE_SIZE / ASYNC_READ_SIZE) * ASYNC_READ_SIZE;
+		fseek(file, (long)offset, SEEK_SET);
+		fread(buffer.data(), 1, ASYNC_READ_SIZE, file);
+		checksum += touch_pages(buffer.data(), ASYNC_READ_SIZE);
+	}
+	fclose(file);
+	double elapsedMs = timer.elapsed_milliseconds();
+	LOG_INFO("Blocking: {} reads of {} KiB in {} ms, {} MiB/s, checksum {}", ASYNC_READ_COUNT, ASYNC_READ_SIZE / 1024, elapsedMs,
+		ASYNC_READ_SIZE * ASYNC_READ_COUNT / (1024.0 * 1024.0) / (elapsedMs / 1000.0), checksum)
+}
+
+std::vector<uint8_t> serialize_file(io::File& file)
+{
+	io::SerializedFile serializedFile;
+	file.serialize(serializedFile);
+	std::vector<uint8_t> data;
+	for (auto& part : serializedFile.parts)
+		data.insert(data.end(), static_cast<const uint8_t*>(part.data), static_cast<const uint8_t*>(part.data) + part.size);
+	return data;
+}
+
+// Layout that was written before v2: [metadataSize, compressedSize, blobSize], metadata, one LZ4 block
+std::vector<uint8_t> serialize_legacy_file(const std::vector<uint8_t>& blob, const std::string& metadata)
+{
+	std::vector<uint8_t> compressedData(LZ4_compressBound(blob.size()));
+	int compressedSize = LZ4_compress_default((const char*)blob.data(), (char*)compressedData.data(), blob.size(), compressedData.size());
+	uint64_t header[3] = { metadata.size(), uint64_t(compressedSize), blob.size() };
+	std::vector<uint8_t> data((const uint8_t*)header, (const uint8_t*)header + sizeof(header));
+	data.insert(data.end(), metadata.begin(), metadata.end());
+	data.insert(data.end(), compressedData.begin(), compressedData.begin() + compressedSize);
+	return data;
+}
+
+bool validate_block_file(tasks::TaskComposer* taskComposer)
+{
+	std::string metadata = "{\"name\":\"block_file\"}";
+	std::vector<uint8_t> blobs[] = { generate_compressible_data(1000 * 1000 + 17), generate_data(300 * 1000) };
+	io::BlockCodec codecs[] = { io::BlockCodec::NONE, io::BlockCodec::LZ4, io::BlockCodec::LZ4_HC };
+
+	for (auto& blob : blobs)
+	{
+		for (io::BlockCodec codec : codecs)
+		{
+			io::BlockCompressionSettings settings;
+			settings.codec = codec;
+			settings.blockSize = 64 * 1024;
+
+			io::File file;
+			uint8_t* blobCopy = new uint8_t[blob.size()];
+			memcpy(blobCopy, blob.data(), blob.size());
+			file.set_binary_blob(blobCopy, blob.size());
+			file.set_metadata(metadata);
+			file.set_compression_settings(settings);
+			file.set_task_composer(taskComposer);
+			std::vector<uint8_t> data = serialize_file(file);
+
+			for (tasks::TaskComposer* composer : { (tasks::TaskComposer*)nullptr, taskComposer })
+			{
+				io::File loadedFile;
+				loadedFile.set_task_composer(composer);
+				if (!loadedFile.deserialize(data.data(), data.size()) || loadedFile.get_metadata() != metadata || loadedFile.get_binary_blob_size() != blob.size()
+					|| memcmp(loadedFile.get_binary_blob(), blob.data(), blob.size()))
+				{
+					LOG_ERROR("Codec {}: blob or metadata is different after deserialization", (uint32_t)codec)
+					return false;
+				}
+			}
+
+			// Ranges inside one block, across block edges and at the end of the blob
+			io::BlockFileView view;
+			if (!view.init(data.data(), data.size()) || view.get_metadata() != metadata)
+				return false;
+			std::pair<uint64_t, uint64_t> ranges[] = {
+				{ 0, 100 }, { 1000, 64 * 1024 }, { 64 * 1024 - 10, 20 }, { 100, 200 * 1024 }, { blob.size() - 5000, 5000 } };
+			for (auto& [offset, size] : ranges)
+			{
+				std::vector<uint8_t> range(size);
+				if (!view.read_blob(range.data(), offset, size, taskComposer) || memcmp(range.data(), blob.data() + offset, size))
+				{
+					LOG_ERROR("Codec {}: range [{}, {}) is invalid", (uint32_t)codec, offset, offset + size)
+					return false;
+				}
+			}
+
+			// Truncated files are rejected instead of leaving a partially filled blob
+			io::File truncatedFile;
+			if (truncatedFile.deserialize(data.data(), data.size() - 1) || truncatedFile.get_binary_blob())
+			{
+				LOG_ERROR("Codec {}: truncated file is deserialized", (uint32_t)codec)
+				return false;
+			}
+		}
+
+		std::vector<uint8_t> legacyData = serialize_legacy_file(blob, metadata);
+		io::File legacyFile;
+		if (!legacyFile.deserialize(legacyData.data(), legacyData.size()) || legacyFile.get_metadata() != metadata || legacyFile.get_binary_blob_size() != blob.size()
+			|| memcmp(legacyFile.get_binary_blob(), blob.data(), blob.size()))
+		{
+			LOG_ERROR("Legacy file is different after deserialization")
+			return false;
+		}
+
+		// Sizes in the legacy header are checked before metadata is copied and the blob is decompressed
+		io::File truncatedLegacyFile;
+		if (truncatedLegacyFile.deserialize(legacyData.data(), legacyData.size() - 1)
+			|| truncatedLegacyFile.deserialize(legacyData.data(), 3 * sizeof(uint64_t) + metadata.size() - 1)
+			|| truncatedLegacyFile.deserialize(legacyData.data(), 3 * sizeof(uint64_t) - 1)
+			|| truncatedLegacyFile.get_binary_blob())
+		{
+			LOG_ERROR("Truncated legacy file is deserialized")
+			return false;
+		}
+	}
+	return true;
+}
+
+// Compares one LZ4 block that is decompressed on one thread with blocks that are decompressed in parallel
+void benchmark_block_file(tasks::TaskComposer* taskComposer)
+{
+	std::vector<uint8_t> blob = generate_compressible_data(BLOCK_FILE_BLOB_SIZE);
+	std::string metadata(2048, 'm');
+	std::vector<uint8_t> legacyData = serialize_legacy_file(blob, metadata);
+
+	io::File file;
+	uint8_t* blobCopy = new uint8_t[blob.size()];
+	memcpy(blobCopy, blob.data(), blob.size());
+	file.set_binary_blob(blobCopy, blob.size());
+	file.set_metadata(metadata);
+	file.set_task_composer(taskComposer);
+	std::vector<uint8_t> blockData = serialize_file(file);
+
+	auto measure = [&](const char* name, const std::vector<uint8_t>& data, tasks::TaskComposer* composer)
+	{
+		double bestMs = 1e9;
+		for (uint32_t i = 0; i != WARM_ITERATION_COUNT; ++i)
+		{
+			io::File loadedFile;
+			loadedFile.set_task_composer(composer);
+			Timer timer;
+			loadedFile.deserialize(data.data(), data.size());
+			bestMs = std::min(bestMs, timer.elapsed_milliseconds());
+		}
+		LOG_INFO("{}: {} MiB decompressed in {} ms, {} MiB/s, file size {} MiB", name, BLOCK_FILE_BLOB_SIZE / (1024 * 1024), bestMs,
+			BLOCK_FILE_BLOB_SIZE / (1024.0 * 1024.0) / (bestMs / 1000.0), data.size() / (1024.0 * 1024.0))
+	};
+
+	measure("Single LZ4 block", legacyData, nullptr);
+	measure("Blocks on one thread", blockData, nullptr);
+	measure("Blocks in parallel", blockData, taskComposer);
+
+	io::BlockFileView view;
+	view.init(blockData.data(), blockData.size());
+	std::vector<uint8_t> range(1024 * 1024);
+	Timer timer;
+	view.read_blob(range.data(), BLOCK_FILE_BLOB_SIZE / 2, range.size());
+	LOG_INFO("Partial read: {} KiB from the middle of the blob in {} ms", range.size() / 1024, timer.elapsed_milliseconds())
+}
+
+io::DerivedDataKey create_derived_data_key(uint32_t index)
+{
+	io::DerivedDataKey key;
+	key.sourceHash = index;
+	key.settingsHash = 7;
+	key.producerVersion = 1;
+	return key;
+}
+
+bool validate_derived_data_cache(const std::filesystem::path& directory)
+{
+	std::filesystem::path cacheDirectory = directory / "derived_data_cache";
+	std::vector<std::string> entries;
+	for (uint32_t i = 0; i != 4; ++i)
+		entries.push_back(std::string(1000 + i, static_cast<char>('a' + i)));
+	uint64_t entrySize = 0;
+
+	{
+		io::DerivedDataCache cache(cacheDirectory);
+		for (uint32_t i = 0; i != 3; ++i)
+			cache.store(create_derived_data_key(i), entries[i].data(), entries[i].size());
+
+		std::string data;
+		if (cache.load(create_derived_data_key(3), data))
+			return false;
+		for (uint32_t i = 0; i != 3; ++i)
+		{
+			if (!cache.load(create_derived_data_key(i), data) || data != entries[i])
+			{
+				LOG_ERROR("Entry {} is different after loading", i)
+				return false;
+			}
+		}
+
+		// A key with other settings or producer version must not return data of the original key
+		io::DerivedDataKey otherKey = create_derived_data_key(0);
+		otherKey.producerVersion = 2;
+		if (cache.load(otherKey, data))
+			return false;
+
+		// Entry 1 is the least recently used after entry 0 is used again, so it is evicted first
+		io::DerivedDataCacheStatistics statistics = cache.get_statistics();
+		entrySize = statistics.size / 3;
+		cache.load(create_derived_data_key(0), data);
+		cache.set_max_size(statistics.size + 100);
+		cache.store(create_derived_data_key(3), entries[3].data(), entries[3].size());
+		if (cache.load(create_derived_data_key(1), data) || !cache.load(create_derived_data_key(0), data)
+			|| !cache.load(create_derived_data_key(3), data))
+		{
+			LOG_ERROR("Least recently used entry was not evicted")
+			return false;
+		}
+
+		statistics = cache.get_statistics();
+		if (statistics.hitCount != 6 || statistics.missCount != 3 || statistics.storeCount != 4
+			|| statistics.evictionCount != 1 || statistics.entryCount != 3)
+		{
+			LOG_ERROR("Statistics are invalid: {} hits, {} misses, {} stores, {} evictions, {} entries", statistics.hitCount,
+				statistics.missCount, statistics.storeCount, statistics.evictionCount, statistics.entryCount)
+			return false;
+		}
+	}
+
+	// Entries are found after restart, a corrupted entry is removed instead of being returned
+	std::filesystem::path corruptedPath = cacheDirectory / fmt::format("{:016x}.aaddc", create_derived_data_key(3).get_hash());
+	{
+		std::fstream stream(corruptedPath, std::ios::binary | std::ios::in | std::ios::out);
+		stream.seekp(-1, std::ios::end);
+		stream.put('x');
+	}
+
+	io::DerivedDataCache cache(cacheDirectory);
+	std::string data;
+	if (cache.get_statistics().entryCount != 3 || cache.load(create_derived_data_key(3), data) || std::filesystem::exists(corruptedPath))
+	{
+		LOG_ERROR("Corrupted entry was loaded or entries were lost after restart")
+		return false;
+	}
+	if (!cache.load(create_derived_data_key(0), data) || data != entries[0] || cache.get_statistics().invalidEntryCount != 1)
+		return false;
+
+	// Data that doesn't fit into the cache is not stored
+	cache.set_max_size(entrySize);
+	if (cache.store(create_derived_data_key(4), entries[3].data(), entries[3].size()))
+		return false;
+
+	cache.clear();
+	return cache.get_statistics().entryCount == 0 && std::filesystem::is_empty(cacheDirectory);
+}
+
+// Deriving data is represented by LZ4 compression, which is much cheaper than decoding images or meshes,
+// so real imports benefit more
+void benchmark_derived_data_cache(const std::filesystem::path& directory)
+{
+	std::vector<uint8_t> source = generate_compressible_data(DERIVED_DATA_SOURCE_SIZE);
+	io::DerivedDataCache cache(directory / "derived_data_benchmark");
+	std::vector<char> derivedData(LZ4_compressBound(source.size()));
+
+	Timer timer;
+	for (uint32_t i = 0; i != DERIVED_DATA_ENTRY_COUNT; ++i)
+	{
+		io::DerivedDataKey key = create_derived_data_key(i);
+		key.settingsHash = XXH64(source.data(), source.size(), 0);
+		int size = LZ4_compress_default(reinterpret_cast<const char*>(source.data()), derivedData.data(), source.size(), derivedData.size());
+		cache.store(key, derivedData.data(), size);
+	}
+	LOG_INFO("Derived data cache: {} entries derived and stored in {} ms", DERIVED_DATA_ENTRY_COUNT, timer.elapsed_milliseconds())
+
+	timer.record();
+	uint64_t checksum = 0;
+	std::string data;
+	for (uint32_t i = 0; i != DERIVED_DATA_ENTRY_COUNT; ++i)
+	{
+		io::DerivedDataKey key = create_derived_data_key(i);
+		key.settingsHash = XXH64(source.data(), source.size(), 0);
+		if (cache.load(key, data))
+			checksum += data.size();
+	}
+	io::DerivedDataCacheStatistics statistics = cache.get_statistics();
+	LOG_INFO("Derived data cache: {} entries hashed and loaded in {} ms, {} hits, {} MiB in cache, checksum {}", DERIVED_DATA_ENTRY_COUNT,
+		timer.elapsed_milliseconds(), statistics.hitCount, statistics.size / (1024.0 * 1024.0), checksum)
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ad_astris_file_system_tasks";
+	std::filesystem::create_directories(directory);
+	io::EngineFileSystem fileSystem(directory.string().c_str());
+
+	if (!validate_mapped_file(&fileSystem, directory))
+	{
+		LOG_ERROR("Mapped file is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Mapped file is valid")
+
+	if (!validate_stream(&fileSystem, directory))
+	{
+		LOG_ERROR("Stream is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Stream is valid")
+
+	if (!validate_atomic_write(&fileSystem, directory))
+	{
+		LOG_ERROR("Atomic write is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Atomic write is valid")
+
+	if (!validate_pak(directory))
+	{
+		LOG_ERROR("Pak archive is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Pak archive is valid")
+
+	if (!validate_file_watcher(&fileSystem, directory))
+	{
+		LOG_ERROR("File watcher is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("File watcher is valid")
+
+	tasks::TaskComposer taskComposer;
+	if (!validate_block_file(&taskComposer))
+	{
+		LOG_ERROR("Block file is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Block file is valid")
+
+	if (!validate_derived_data_cache(directory))
+	{
+		LOG_ERROR("Derived data cache is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Derived data cache is valid")
+
+	for (bool isIOUringEnabled : { true, false })
+	{
+		if (!validate_async_io(&fileSystem, directory, isIOUringEnabled)
+			|| !validate_async_io_priorities(&fileSystem, directory, isIOUringEnabled))
+		{
+			LOG_ERROR("Async IO is invalid")
+			std::filesystem::remove_all(directory);
+			return 1;
+		}
+	}
+	LOG_INFO("Async IO is valid")
+
+	benchmark_read_paths(&fileSystem, directory);
+	benchmark_stream_reads(&fileSystem, directory);
+	benchmark_resource_saving(&fileSystem, &taskComposer, directory);
+	benchmark_blocking_io(directory);
+	benchmark_pak(directory);
+	benchmark_file_watcher(&fileSystem, directory);
+	benchmark_block_file(&taskComposer);
+	benchmark_derived_data_cache(directory);
+	for (bool isIOUringEnabled : { true, false })
+		benchmark_async_io(&fileSystem, directory, isIOUringEnabled);
+	std::filesystem::remove_all(directory);
+
+	return 0;
+}
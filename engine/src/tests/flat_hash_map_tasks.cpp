@@ -0,0 +1,182 @@
+#include "core/flat_hash_map.h"
+#include "core/timer.h"
+#include "ecs/entity_types.h"
+#include "profiler/logger.h"
+
+#include <unordered_map>
+#include <random>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t ENTITY_COUNT = 200000;
+constexpr uint32_t LOOKUP_COUNT = 2000000;
+constexpr uint32_t ARCHETYPE_COUNT = 64;
+
+struct EntityInfo
+{
+	uint32_t archetypeID;
+	uint32_t column;
+};
+
+std::vector<ecs::Entity> generate_entities(uint32_t count, uint64_t seed)
+{
+	std::mt19937_64 generator(seed);
+	std::vector<ecs::Entity> entities;
+	entities.reserve(count);
+	for (uint32_t i = 0; i != count; ++i)
+		entities.emplace_back(UUID(generator()));
+	return entities;
+}
+
+// EntityManager pattern: insert all entities, look them up randomly, destroy half of them and create new ones
+template<typename Map>
+double run_entity_workload(const std::vector<ecs::Entity>& entities, const std::vector<ecs::Entity>& newEntities, uint64_t& checksum)
+{
+	Timer timer;
+	Map entityToInfo;
+	for (uint32_t i = 0; i != entities.size(); ++i)
+		entityToInfo[entities[i]] = { i % ARCHETYPE_COUNT, i };
+
+	std::mt19937 generator(42);
+	std::uniform_int_distribution<uint32_t> distribution(0, entities.size() - 1);
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+	{
+		auto it = entityToInfo.find(entities[distribution(generator)]);
+		checksum += it->second.column;
+	}
+
+	for (uint32_t i = 0; i < entities.size(); i += 2)
+		entityToInfo.erase(entities[i]);
+	for (uint32_t i = 0; i != newEntities.size(); ++i)
+		entityToInfo[newEntities[i]] = { i % ARCHETYPE_COUNT, i };
+
+	// Half of the lookups miss
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+	{
+		auto it = entityToInfo.find(entities[distribution(generator)]);
+		if (it != entityToInfo.end())
+			checksum += it->second.archetypeID;
+	}
+
+	for (auto& pair : entityToInfo)
+		checksum += pair.second.column;
+
+	return timer.elapsed_milliseconds();
+}
+
+// EventManager and culling contexts pattern: small table with a lot of lookups by 64-bit type or filter hash
+template<typename Map>
+double run_small_table_workload(uint64_t& checksum)
+{
+	std::mt19937_64 generator(7);
+	std::vector<uint64_t> keys(ARCHETYPE_COUNT);
+	for (auto& key : keys)
+		key = generator();
+
+	Timer timer;
+	Map valueByHash;
+	for (uint32_t i = 0; i != keys.size(); ++i)
+		valueByHash[keys[i]] = i;
+
+	for (uint32_t i = 0; i != LOOKUP_COUNT * 4; ++i)
+		checksum += valueByHash.find(keys[(i * 7) % keys.size()])->second;
+
+	return timer.elapsed_milliseconds();
+}
+
+bool validate_against_std_map()
+{
+	FlatHashMap<uint64_t, uint64_t> flatMap;
+	std::unordered_map<uint64_t, uint64_t> stdMap;
+	std::mt19937_64 generator(1);
+
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+	{
+		uint64_t key = generator() % 50000;
+		switch (generator() % 4)
+		{
+			case 0:
+			case 1:
+			{
+				flatMap[key] = i;
+				stdMap[key] = i;
+				break;
+			}
+			case 2:
+			{
+				if (flatMap.erase(key) != stdMap.erase(key))
+					return false;
+				break;
+			}
+			case 3:
+			{
+				auto flatIt = flatMap.find(key);
+				auto stdIt = stdMap.find(key);
+				if ((flatIt == flatMap.end()) != (stdIt == stdMap.end()))
+					return false;
+				if (flatIt != flatMap.end() && flatIt->second != stdIt->second)
+					return false;
+				break;
+			}
+		}
+	}
+
+	if (flatMap.size() != stdMap.size())
+		return false;
+
+	size_t iteratedCount = 0;
+	for (auto& [key, value] : flatMap)
+	{
+		auto it = stdMap.find(key);
+		if (it == stdMap.end() || it->second != value)
+			return false;
+		++iteratedCount;
+	}
+
+	// Erasing while iterating must visit every element once
+	for (auto it = flatMap.begin(); it != flatMap.end();)
+	{
+		if (it->first % 2)
+			it = flatMap.erase(it);
+		else
+			++it;
+	}
+	for (auto& pair : flatMap)
+	{
+		if (pair.first % 2)
+			return false;
+	}
+
+	return iteratedCount == stdMap.size();
+}
+
+int main()
+{
+	if (!validate_against_std_map())
+	{
+		LOG_ERROR("FlatHashMap results differ from std::unordered_map")
+		return 1;
+	}
+	LOG_INFO("FlatHashMap results match std::unordered_map")
+
+	std::vector<ecs::Entity> entities = generate_entities(ENTITY_COUNT, 1);
+	std::vector<ecs::Entity> newEntities = generate_entities(ENTITY_COUNT / 2, 2);
+
+	uint64_t stdChecksum = 0, flatChecksum = 0;
+	double stdTime = run_entity_workload<std::unordered_map<ecs::Entity, EntityInfo>>(entities, newEntities, stdChecksum);
+	double flatTime = run_entity_workload<FlatHashMap<ecs::Entity, EntityInfo>>(entities, newEntities, flatChecksum);
+	LOG_INFO("Entity workload: std::unordered_map {} ms, FlatHashMap {} ms", stdTime, flatTime)
+
+	stdTime = run_small_table_workload<std::unordered_map<uint64_t, uint32_t>>(stdChecksum);
+	flatTime = run_small_table_workload<FlatHashMap<uint64_t, uint32_t>>(flatChecksum);
+	LOG_INFO("Small table workload: std::unordered_map {} ms, FlatHashMap {} ms", stdTime, flatTime)
+
+	if (stdChecksum != flatChecksum)
+	{
+		LOG_ERROR("Checksums are different: {} and {}", stdChecksum, flatChecksum)
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include "core/frame_scratch_allocator.h"
+#include "profiler/logger.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr size_t SMALL_CAPACITY = 1024;
+constexpr uint32_t THREAD_COUNT = 4;
+constexpr uint32_t ALLOCATIONS_PER_THREAD = 64;
+
+bool is_aligned(const void* ptr, size_t alignment)
+{
+	return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+bool validate_alignment()
+{
+	FrameScratchAllocator allocator(SMALL_CAPACITY * 16);
+	for (size_t alignment = 1; alignment <= 256; alignment *= 2)
+	{
+		// An odd allocation before each aligned one misaligns the offset
+		allocator.allocate(1, 1);
+		uint8_t* ptr = allocator.allocate(24, alignment);
+		if (!ptr || !is_aligned(ptr, alignment))
+			return false;
+	}
+
+	// Overflow blocks keep the requested alignment too
+	allocator.allocate(SMALL_CAPACITY * 16, 1);
+	uint8_t* ptr = allocator.allocate(24, 128);
+	return ptr && is_aligned(ptr, 128) && allocator.get_usage().overflow > 0;
+}
+
+bool validate_frame_reset()
+{
+	FrameScratchAllocator allocator(SMALL_CAPACITY);
+	uint8_t* firstFrameData = allocator.allocate(64);
+	memset(firstFrameData, 0xAB, 64);
+
+	// Data of frame N stays valid during frame N + 1
+	allocator.begin_frame();
+	uint8_t* secondFrameData = allocator.allocate(64);
+	memset(secondFrameData, 0xCD, 64);
+	for (size_t i = 0; i != 64; ++i)
+	{
+		if (firstFrameData[i] != 0xAB)
+			return false;
+	}
+	if (allocator.get_usage().used != 64)
+		return false;
+
+	// Frame N + 2 reuses the buffer of frame N from its beginning
+	allocator.begin_frame();
+	if (allocator.get_usage().used != 0)
+		return false;
+	uint8_t* thirdFrameData = allocator.allocate(64);
+	return thirdFrameData == firstFrameData && secondFrameData != firstFrameData && allocator.get_frame_index() == 2;
+}
+
+bool validate_overflow()
+{
+	FrameScratchAllocator allocator(SMALL_CAPACITY);
+	uint8_t* first = allocator.allocate(SMALL_CAPACITY / 2);
+	uint8_t* second = allocator.allocate(SMALL_CAPACITY / 2);
+	uint8_t* overflowed = allocator.allocate(SMALL_CAPACITY);
+	if (!first || !second || !overflowed)
+		return false;
+	memset(overflowed, 0xEF, SMALL_CAPACITY);
+
+	FrameScratchUsage usage = allocator.get_usage();
+	if (usage.overflow != SMALL_CAPACITY || usage.used != SMALL_CAPACITY * 2 || usage.highWater != SMALL_CAPACITY * 2)
+		return false;
+
+	// Overflow blocks are released when the buffer is reset, the high-water mark is kept
+	allocator.begin_frame();
+	allocator.begin_frame();
+	allocator.allocate(16);
+	usage = allocator.get_usage();
+	return usage.overflow == 0 && usage.used == 16 && usage.highWater == SMALL_CAPACITY * 2;
+}
+
+bool validate_threads()
+{
+	FrameScratchAllocator allocator(SMALL_CAPACITY * 4);
+	std::vector<std::vector<uint8_t*>> allocationsByThread(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t threadIndex = 0; threadIndex != THREAD_COUNT; ++threadIndex)
+	{
+		threads.emplace_back([&, threadIndex]
+		{
+			for (uint32_t i = 0; i != ALLOCATIONS_PER_THREAD; ++i)
+			{
+				uint8_t* ptr = allocator.allocate(32);
+				memset(ptr, threadIndex, 32);
+				allocationsByThread[threadIndex].push_back(ptr);
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	// Threads write only to their own buffers
+	for (uint32_t threadIndex = 0; threadIndex != THREAD_COUNT; ++threadIndex)
+	{
+		for (uint8_t* ptr : allocationsByThread[threadIndex])
+		{
+			for (size_t i = 0; i != 32; ++i)
+			{
+				if (ptr[i] != threadIndex)
+					return false;
+			}
+		}
+	}
+
+	FrameScratchUsage usage = allocator.get_usage();
+	return usage.threadCount == THREAD_COUNT
+		&& usage.used == THREAD_COUNT * ALLOCATIONS_PER_THREAD * 32
+		&& usage.capacity == THREAD_COUNT * SMALL_CAPACITY * 4;
+}
+
+bool validate_frame_vector()
+{
+	FrameScratchAllocator allocator(SMALL_CAPACITY * 16);
+	FrameVector<uint64_t> values(&allocator);
+	for (uint64_t i = 0; i != 256; ++i)
+		values.push_back(i);
+	for (uint64_t i = 0; i != 256; ++i)
+	{
+		if (values[i] != i)
+			return false;
+	}
+	return is_aligned(values.data(), alignof(uint64_t));
+}
+
+int main()
+{
+	if (!validate_alignment())
+	{
+		LOG_ERROR("Frame scratch allocations are not aligned")
+		return 1;
+	}
+	LOG_INFO("Frame scratch alignment is valid")
+
+	if (!validate_frame_reset())
+	{
+		LOG_ERROR("Frame scratch buffers are not reset correctly")
+		return 1;
+	}
+	LOG_INFO("Frame scratch reset is valid")
+
+	if (!validate_overflow())
+	{
+		LOG_ERROR("Frame scratch overflow is invalid")
+		return 1;
+	}
+	LOG_INFO("Frame scratch overflow is valid")
+
+	if (!validate_threads())
+	{
+		LOG_ERROR("Frame scratch buffers of threads are invalid")
+		return 1;
+	}
+	LOG_INFO("Frame scratch threads are valid")
+
+	if (!validate_frame_vector())
+	{
+		LOG_ERROR("FrameVector is invalid")
+		return 1;
+	}
+	LOG_INFO("FrameVector is valid")
+
+	return 0;
+}
@@ -0,0 +1,295 @@
+#include "profiler/logger.h"
+#include "core/timer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t THREAD_COUNT = 4;
+constexpr uint32_t VALIDATION_MESSAGE_COUNT = 20000;
+constexpr uint32_t BENCHMARK_MESSAGE_COUNT = 200000;
+constexpr uint32_t LATENCY_SAMPLE_PERIOD = 16;
+constexpr uint32_t SMALL_QUEUE_CAPACITY = 4 * 1024;
+
+struct LogTestResource
+{
+	std::string name;
+	uint32_t size;
+};
+
+template<>
+struct fmt::formatter<LogTestResource> : fmt::formatter<std::string_view>
+{
+	template<typename FormatContext>
+	auto format(const LogTestResource& resource, FormatContext& ctx) const
+	{
+		return fmt::format_to(ctx.out(), "{}:{}", resource.name, resource.size);
+	}
+};
+
+std::filesystem::path get_test_directory()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ad_astris_logger_tasks";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	return directory;
+}
+
+std::vector<std::string> read_lines(const std::filesystem::path& path)
+{
+	std::vector<std::string> lines;
+	std::ifstream file(path);
+	for (std::string line; std::getline(file, line);)
+		lines.push_back(line);
+	return lines;
+}
+
+bool ends_with(const std::string& str, std::string_view suffix)
+{
+	return str.size() >= suffix.size() && std::string_view(str).substr(str.size() - suffix.size()) == suffix;
+}
+
+bool validate_formatting(const std::filesystem::path& directory)
+{
+	profiler::LogFileSettings fileSettings;
+	fileSettings.filePath = (directory / "formatting.log").string();
+	std::vector<std::string> lines;
+	{
+		profiler::LoggerInstance logger(profiler::LogBackendMode::ASYNC, SMALL_QUEUE_CAPACITY);
+		logger.set_console_output(false);
+		if (!logger.open_log_file(fileSettings))
+			return false;
+
+		// Temporary strings and buffers are destroyed before the backend formats the record
+		char buffer[32] = "CharBuffer";
+		std::string longMessage(SMALL_QUEUE_CAPACITY * 2, 'x');
+		logger.log(LogType::INFO, "Int {} float {:.2f} bool {}", -42, 3.14159, true);
+		logger.log(LogType::WARNING, std::string("Strings {} {} {} {}"), std::string("Temporary"), std::string_view("View"), buffer, "Literal");
+		logger.log(LogType::ERROR_TYPE, "Resource {}", LogTestResource{ std::string(64, 'r'), 16 });
+		logger.log(LogType::SUCCESS, "Null {}", static_cast<const char*>(nullptr));
+		logger.log(LogType::INFO, "Invalid {} {}", 1);
+		logger.log(LogType::INFO, "Long {}", longMessage);
+		logger.flush();
+		lines = read_lines(fileSettings.filePath);
+
+		if (lines.size() != 6
+			|| !ends_with(lines[0], "[INFO]:    Int -42 float 3.14 bool true")
+			|| !ends_with(lines[1], "[WARNING]: Strings Temporary View CharBuffer Literal")
+			|| !ends_with(lines[2], "[ERROR]:   Resource " + std::string(64, 'r') + ":16")
+			|| !ends_with(lines[3], "[SUCCESS]: Null ")
+			|| lines[4].find("Failed to format \"Invalid {} {}\"") == std::string::npos
+			|| !ends_with(lines[5], "Long " + longMessage))
+		{
+			return false;
+		}
+	}
+
+	// Records that have not been flushed are written when the instance is destroyed
+	{
+		profiler::LoggerInstance logger;
+		logger.set_console_output(false);
+		logger.open_log_file(fileSettings);
+		logger.log(LogType::INFO, "Written on destruction");
+	}
+	lines = read_lines(fileSettings.filePath);
+	return lines.size() == 1 && ends_with(lines[0], "Written on destruction");
+}
+
+bool validate_multithreaded_logging(const std::filesystem::path& directory, profiler::LogBackendMode backendMode)
+{
+	profiler::LogFileSettings fileSettings;
+	fileSettings.filePath = (directory / "threads.log").string();
+	profiler::LoggerInstance logger(backendMode, SMALL_QUEUE_CAPACITY);
+	logger.set_console_output(false);
+	if (!logger.open_log_file(fileSettings))
+		return false;
+
+	// Small queues make producers wrap around and wait for the backend
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&logger, i]()
+		{
+			for (uint32_t j = 0; j != VALIDATION_MESSAGE_COUNT; ++j)
+				logger.log(LogType::INFO, "Thread {} message {} {}", i, j, std::string(j % 100, 'm'));
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	logger.flush();
+
+	std::vector<std::string> lines = read_lines(fileSettings.filePath);
+	if (lines.size() != THREAD_COUNT * VALIDATION_MESSAGE_COUNT)
+		return false;
+
+	std::vector<uint32_t> nextMessages(THREAD_COUNT, 0);
+	for (auto& line : lines)
+	{
+		uint32_t thread = 0, message = 0;
+		size_t offset = line.find("Thread ");
+		if (offset == std::string::npos || sscanf(line.c_str() + offset, "Thread %u message %u", &thread, &message) != 2)
+			return false;
+		if (thread >= THREAD_COUNT || nextMessages[thread]++ != message)
+			return false;
+		if (!ends_with(line, " " + std::string(message % 100, 'm')))
+			return false;
+	}
+
+	return true;
+}
+
+bool validate_exited_thread_queues(profiler::LogBackendMode backendMode)
+{
+	profiler::LoggerInstance logger(backendMode, SMALL_QUEUE_CAPACITY);
+	logger.set_console_output(false);
+
+	// Threads are created one after another, so their IDs are likely to be reused
+	for (uint32_t i = 0; i != THREAD_COUNT * 4; ++i)
+	{
+		std::thread thread([&logger, i]()
+		{
+			logger.log(LogType::INFO, "Short-lived thread {}", i);
+		});
+		thread.join();
+	}
+	logger.flush();
+	// In sync mode queues are freed by the next processing after the thread has exited
+	logger.log(LogType::INFO, "Main thread");
+	logger.flush();
+
+	return logger.get_thread_queue_count() == 1;
+}
+
+bool validate_rotation(const std::filesystem::path& directory)
+{
+	profiler::LogFileSettings fileSettings;
+	fileSettings.filePath = (directory / "rotation.log").string();
+	fileSettings.maxFileSize = 4 * 1024;
+	fileSettings.maxFileCount = 3;
+
+	// The previous file is kept as rotation.1.log when the log file is opened
+	std::ofstream(fileSettings.filePath) << "Previous session\n";
+	profiler::LoggerInstance logger(profiler::LogBackendMode::SYNC);
+	logger.set_console_output(false);
+	if (!logger.open_log_file(fileSettings))
+		return false;
+
+	std::vector<std::string> previousLines = read_lines(directory / "rotation.1.log");
+	if (previousLines.size() != 1 || previousLines[0] != "Previous session")
+		return false;
+
+	for (uint32_t i = 0; i != 1000; ++i)
+		logger.log(LogType::INFO, "Rotation message {}", i);
+	logger.flush();
+
+	std::vector<std::string> lines = read_lines(fileSettings.filePath);
+	if (lines.empty() || !ends_with(lines.back(), "Rotation message 999"))
+		return false;
+	if (std::filesystem::file_size(fileSettings.filePath) > fileSettings.maxFileSize)
+		return false;
+
+	return std::filesystem::exists(directory / "rotation.2.log") && !std::filesystem::exists(directory / "rotation.3.log");
+}
+
+void run_benchmark(const std::filesystem::path& directory, profiler::LogBackendMode backendMode, const char* modeName)
+{
+	profiler::LogFileSettings fileSettings;
+	fileSettings.filePath = (directory / "benchmark.log").string();
+	fileSettings.maxFileSize = 64 * 1024 * 1024;
+	profiler::LoggerInstance logger(backendMode);
+	logger.set_console_output(false);
+	logger.open_log_file(fileSettings);
+
+	std::vector<std::vector<uint64_t>> latenciesByThread(THREAD_COUNT);
+	std::vector<double> producerTimes(THREAD_COUNT);
+	Timer timer;
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&, i]()
+		{
+			std::vector<uint64_t>& latencies = latenciesByThread[i];
+			latencies.reserve(BENCHMARK_MESSAGE_COUNT / LATENCY_SAMPLE_PERIOD);
+			std::string resourceName = "Model_" + std::to_string(i);
+			Timer threadTimer;
+			for (uint32_t j = 0; j != BENCHMARK_MESSAGE_COUNT; ++j)
+			{
+				if (j % LATENCY_SAMPLE_PERIOD)
+				{
+					logger.log(LogType::WARNING, "Importer::import(): Failed to find texture {} for {}, size {:.3f} MB", j, resourceName, j * 0.001);
+					continue;
+				}
+				auto begin = std::chrono::steady_clock::now();
+				logger.log(LogType::WARNING, "Importer::import(): Failed to find texture {} for {}, size {:.3f} MB", j, resourceName, j * 0.001);
+				latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+			}
+			producerTimes[i] = threadTimer.elapsed_milliseconds();
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	double producerTime = timer.elapsed_milliseconds();
+	logger.flush();
+	double totalTime = timer.elapsed_milliseconds();
+
+	std::vector<uint64_t> latencies;
+	for (auto& threadLatencies : latenciesByThread)
+		latencies.insert(latencies.end(), threadLatencies.begin(), threadLatencies.end());
+	std::sort(latencies.begin(), latencies.end());
+	auto get_percentile = [&](double percentile) { return latencies[static_cast<size_t>(percentile * (latencies.size() - 1))]; };
+
+	uint32_t messageCount = THREAD_COUNT * BENCHMARK_MESSAGE_COUNT;
+	double averageThreadTime = 0;
+	for (double time : producerTimes)
+		averageThreadTime += time / THREAD_COUNT;
+	LOG_INFO("{} logger, {} threads: {} messages logged in {:.1f} ms ({:.0f} ns per call in producer thread), written in {:.1f} ms",
+		modeName, THREAD_COUNT, messageCount, producerTime, averageThreadTime * 1000000.0 / BENCHMARK_MESSAGE_COUNT, totalTime)
+	LOG_INFO("{} logger call latency: p50 {} ns, p99 {} ns, p99.9 {} ns, max {} ns",
+		modeName, get_percentile(0.5), get_percentile(0.99), get_percentile(0.999), latencies.back())
+}
+
+int main()
+{
+	std::filesystem::path directory = get_test_directory();
+
+	if (!validate_formatting(directory))
+	{
+		LOG_ERROR("Logger formatted records incorrectly")
+		return 1;
+	}
+	LOG_INFO("Logger formatting results are valid")
+
+	if (!validate_multithreaded_logging(directory, profiler::LogBackendMode::ASYNC)
+		|| !validate_multithreaded_logging(directory, profiler::LogBackendMode::SYNC))
+	{
+		LOG_ERROR("Logger lost or reordered messages of one thread")
+		return 1;
+	}
+	LOG_INFO("Multithreaded logging results are valid")
+
+	if (!validate_exited_thread_queues(profiler::LogBackendMode::ASYNC)
+		|| !validate_exited_thread_queues(profiler::LogBackendMode::SYNC))
+	{
+		LOG_ERROR("Logger kept queues of exited threads")
+		return 1;
+	}
+	LOG_INFO("Queues of exited threads are freed")
+
+	if (!validate_rotation(directory))
+	{
+		LOG_ERROR("Log files were rotated incorrectly")
+		return 1;
+	}
+	LOG_INFO("Log file rotation results are valid")
+
+	run_benchmark(directory, profiler::LogBackendMode::SYNC, "Sync");
+	run_benchmark(directory, profiler::LogBackendMode::ASYNC, "Async");
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include "core/memory_tracker.h"
+#include "profiler/logger.h"
+
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t THREAD_COUNT = 4;
+constexpr uint32_t ITERATION_COUNT = 100000;
+constexpr uint64_t THREAD_ALLOCATION_SIZE = 64;
+
+bool are_stats_equal(const MemoryTagStats& stats, uint64_t liveBytes, uint64_t peakBytes, uint64_t allocationCount, uint64_t freeCount)
+{
+	return stats.liveBytes == liveBytes
+		&& stats.peakBytes == peakBytes
+		&& stats.allocationCount == allocationCount
+		&& stats.freeCount == freeCount;
+}
+
+bool validate_tag_accounting()
+{
+	MemoryTrackerInstance trackerInstance;
+	MemoryTracker::init(&trackerInstance);
+
+	MemoryTracker::record_allocation(MemoryTag::ECS, 100);
+	MemoryTracker::record_allocation(MemoryTag::ECS, 50);
+	MemoryTracker::record_free(MemoryTag::ECS, 100);
+	MemoryTracker::record_allocation(MemoryTag::RESOURCES, 1000);
+	MemoryTracker::record_free(MemoryTag::RESOURCES, 1000);
+	MemoryTracker::record_allocation(MemoryTag::RESOURCES, 200);
+
+	// The peak is the maximum of live bytes, not the sum of allocations
+	if (!are_stats_equal(MemoryTracker::get_stats(MemoryTag::ECS), 50, 150, 2, 1)
+		|| !are_stats_equal(MemoryTracker::get_stats(MemoryTag::RESOURCES), 200, 1000, 2, 1)
+		|| !are_stats_equal(MemoryTracker::get_stats(MemoryTag::RENDERER), 0, 0, 0, 0))
+	{
+		MemoryTracker::init(nullptr);
+		return false;
+	}
+
+	MemoryTagStats totalStats;
+	for (auto& stats : MemoryTracker::get_all_stats())
+	{
+		totalStats.liveBytes += stats.liveBytes;
+		totalStats.allocationCount += stats.allocationCount;
+		totalStats.freeCount += stats.freeCount;
+	}
+	MemoryTracker::init(nullptr);
+	return totalStats.liveBytes == 250 && totalStats.allocationCount == 4 && totalStats.freeCount == 2;
+}
+
+bool validate_helpers()
+{
+	MemoryTrackerInstance trackerInstance;
+	MemoryTracker::init(&trackerInstance);
+
+	void* ptr = MemoryTracker::allocate(MemoryTag::IMPORTER, 256, 64);
+	bool isValid = ptr && reinterpret_cast<uintptr_t>(ptr) % 64 == 0
+		&& MemoryTracker::get_stats(MemoryTag::IMPORTER).liveBytes == 256;
+	MemoryTracker::free(MemoryTag::IMPORTER, ptr, 256);
+	isValid = isValid && are_stats_equal(MemoryTracker::get_stats(MemoryTag::IMPORTER), 0, 256, 1, 1);
+
+	{
+		ScopedMemoryRecord record(MemoryTag::RENDERER, 512);
+		isValid = isValid && MemoryTracker::get_stats(MemoryTag::RENDERER).liveBytes == 512;
+	}
+	isValid = isValid && are_stats_equal(MemoryTracker::get_stats(MemoryTag::RENDERER), 0, 512, 1, 1);
+
+	{
+		TaggedVector<uint32_t, MemoryTag::ECS> values;
+		for (uint32_t i = 0; i != 1000; ++i)
+			values.push_back(i);
+		isValid = isValid && MemoryTracker::get_stats(MemoryTag::ECS).liveBytes == values.capacity() * sizeof(uint32_t);
+	}
+	MemoryTagStats ecsStats = MemoryTracker::get_stats(MemoryTag::ECS);
+	isValid = isValid && ecsStats.liveBytes == 0 && ecsStats.allocationCount == ecsStats.freeCount && ecsStats.allocationCount != 0;
+
+	MemoryTracker::init(nullptr);
+	return isValid;
+}
+
+bool validate_threads()
+{
+	MemoryTrackerInstance trackerInstance;
+	MemoryTracker::init(&trackerInstance);
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([]
+		{
+			for (uint32_t i = 0; i != ITERATION_COUNT; ++i)
+			{
+				MemoryTracker::record_allocation(MemoryTag::FRAME_SCRATCH, THREAD_ALLOCATION_SIZE);
+				MemoryTracker::record_free(MemoryTag::FRAME_SCRATCH, THREAD_ALLOCATION_SIZE);
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	MemoryTagStats stats = MemoryTracker::get_stats(MemoryTag::FRAME_SCRATCH);
+	MemoryTracker::init(nullptr);
+	return stats.liveBytes == 0
+		&& stats.allocationCount == THREAD_COUNT * ITERATION_COUNT
+		&& stats.freeCount == THREAD_COUNT * ITERATION_COUNT
+		&& stats.peakBytes >= THREAD_ALLOCATION_SIZE
+		&& stats.peakBytes <= THREAD_COUNT * THREAD_ALLOCATION_SIZE;
+}
+
+bool validate_disabled_tracker()
+{
+	// Allocations before the tracker is set are ignored
+	MemoryTracker::init(nullptr);
+	MemoryTracker::record_allocation(MemoryTag::ECS, 100);
+	return are_stats_equal(MemoryTracker::get_stats(MemoryTag::ECS), 0, 0, 0, 0);
+}
+
+int main()
+{
+	if (!validate_tag_accounting())
+	{
+		LOG_ERROR("Memory tag accounting is invalid")
+		return 1;
+	}
+	LOG_INFO("Memory tag accounting is valid")
+
+	if (!validate_helpers())
+	{
+		LOG_ERROR("Memory tracking helpers are invalid")
+		return 1;
+	}
+	LOG_INFO("Memory tracking helpers are valid")
+
+	if (!validate_threads())
+	{
+		LOG_ERROR("Memory tracking from several threads is invalid")
+		return 1;
+	}
+	LOG_INFO("Memory tracking from several threads is valid")
+
+	if (!validate_disabled_tracker())
+	{
+		LOG_ERROR("Memory tracking without a tracker is invalid")
+		return 1;
+	}
+	LOG_INFO("Memory tracking without a tracker is valid")
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include "core/name_table.h"
+#include "core/flat_hash_map.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+
+#include <unordered_map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t NAME_COUNT = 100000;
+constexpr uint32_t LOOKUP_COUNT = 4000000;
+constexpr uint32_t RESOURCE_COUNT = 256;
+constexpr uint32_t THREAD_COUNT = 8;
+
+std::vector<std::string> generate_strings(uint32_t count, const std::string& suffix)
+{
+	std::vector<std::string> strings;
+	strings.reserve(count);
+	for (uint32_t i = 0; i != count; ++i)
+		strings.push_back(std::to_string(i * 2654435761u) + suffix);
+	return strings;
+}
+
+bool validate_interning()
+{
+	Name first("DepthPyramid");
+	Name second(std::string("DepthPyramid"));
+	Name third("DepthPyramidMipmap0");
+	if (first != second || first == third || first.is_none() || !Name().is_none() || !Name("").is_none())
+		return false;
+	if (first.get_string_view() != "DepthPyramid" || std::string(third.c_str()) != "DepthPyramidMipmap0")
+		return false;
+	if (first.get_hash() != compile_time_fnv1("DepthPyramid"))
+		return false;
+	if (!Name::find("NotInternedName").is_none() || Name::find("DepthPyramid") != first)
+		return false;
+
+	// All threads must get the same IDs for the same strings
+	std::vector<std::string> strings = generate_strings(NAME_COUNT / 4, "ThreadName");
+	std::vector<std::vector<uint32_t>> idsByThread(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&strings, &ids = idsByThread[i], i]()
+		{
+			for (uint32_t j = 0; j != strings.size(); ++j)
+				ids.push_back(Name(strings[(j + i * 997) % strings.size()]).get_id());
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		for (uint32_t j = 0; j != strings.size(); ++j)
+		{
+			uint32_t index = (j + i * 997) % strings.size();
+			Name name = Name::find(strings[index]);
+			if (name.get_id() != idsByThread[i][j] || name.get_string_view() != strings[index])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+// Renderer pattern: resources are looked up by names that were built with std::to_string(hash) + NAME
+void run_resource_lookup_benchmark(uint64_t& stdChecksum, uint64_t& flatChecksum)
+{
+	std::vector<std::string> strings = generate_strings(RESOURCE_COUNT, "ModelInstanceIdBuffer");
+	std::vector<uint64_t> resources(RESOURCE_COUNT);
+
+	std::unordered_map<std::string, uint64_t*> resourceByString;
+	FlatHashMap<Name, uint64_t*> resourceByName;
+	std::vector<Name> names;
+	for (uint32_t i = 0; i != RESOURCE_COUNT; ++i)
+	{
+		resources[i] = i;
+		resourceByString[strings[i]] = &resources[i];
+		names.emplace_back(strings[i]);
+		resourceByName[names.back()] = &resources[i];
+	}
+
+	Timer timer;
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+		stdChecksum += *resourceByString.find(strings[(i * 7) % RESOURCE_COUNT])->second;
+	double stdTime = timer.elapsed_milliseconds();
+
+	timer.record();
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+		flatChecksum += *resourceByName.find(names[(i * 7) % RESOURCE_COUNT])->second;
+	double nameTime = timer.elapsed_milliseconds();
+
+	LOG_INFO("Resource lookup: std::string keys {} ms, cached Name keys {} ms", stdTime, nameTime)
+}
+
+void run_interning_benchmark()
+{
+	std::vector<std::string> strings = generate_strings(NAME_COUNT, "RendererBuffer");
+
+	Timer timer;
+	for (auto& str : strings)
+		Name name(str);
+	LOG_INFO("Interning {} new names: {} ms", NAME_COUNT, timer.elapsed_milliseconds())
+
+	timer.record();
+	uint64_t checksum = 0;
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+		checksum += Name(strings[i % NAME_COUNT]).get_id();
+	LOG_INFO("Interning {} existing names: {} ms, checksum {}", LOOKUP_COUNT, timer.elapsed_milliseconds(), checksum)
+
+	timer.record();
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&strings, i]()
+		{
+			uint64_t threadChecksum = 0;
+			for (uint32_t j = 0; j != LOOKUP_COUNT / THREAD_COUNT; ++j)
+				threadChecksum += Name(strings[(j + i * NAME_COUNT / THREAD_COUNT) % NAME_COUNT]).get_id();
+			if (!threadChecksum)
+				LOG_ERROR("Invalid checksum")
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	LOG_INFO("Interning {} existing names from {} threads: {} ms", LOOKUP_COUNT, THREAD_COUNT, timer.elapsed_milliseconds())
+}
+
+int main()
+{
+	if (!validate_interning())
+	{
+		LOG_ERROR("Name interning returned invalid results")
+		return 1;
+	}
+	LOG_INFO("Name interning results are valid")
+
+	uint64_t stdChecksum = 0, flatChecksum = 0;
+	run_resource_lookup_benchmark(stdChecksum, flatChecksum);
+	if (stdChecksum != flatChecksum)
+	{
+		LOG_ERROR("Checksums are different: {} and {}", stdChecksum, flatChecksum)
+		return 1;
+	}
+
+	run_interning_benchmark();
+	LOG_INFO("Name table contains {} names", NameTable::get_instance()->get_name_count())
+
+	return 0;
+}
@@ -0,0 +1,691 @@
+#include "profiler/profiler.h"
+#include "profiler/trace_capture.h"
+#include "profiler/range_statistics.h"
+#include "rhi/null_rhi.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+#include <json.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t THREAD_COUNT = 4;
+constexpr uint32_t SCOPES_PER_FRAME = 50000;
+constexpr uint32_t FRAME_COUNT = 20;
+constexpr double MAX_SCOPE_OVERHEAD_NS = 50.0;
+
+// Every thread records the same tree: Job -> (Update -> Physics, Update -> Physics)
+void record_job_tree(profiler::CPUEventRecorder& recorder, Name jobName, Name updateName, Name physicsName)
+{
+	recorder.begin_scope(jobName);
+	for (uint32_t i = 0; i != 2; ++i)
+	{
+		recorder.begin_scope(updateName);
+		recorder.begin_scope(physicsName);
+		recorder.end_scope();
+		recorder.end_scope();
+	}
+	recorder.end_scope();
+}
+
+bool validate_timeline()
+{
+	profiler::CPUEventRecorder recorder;
+	Name jobName("Job"), updateName("Update"), physicsName("Physics");
+
+	// Threads wait for each other because IDs of finished threads can be reused
+	std::atomic<uint32_t> recordedThreadCount{ 0 };
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&]()
+		{
+			record_job_tree(recorder, jobName, updateName, physicsName);
+			recordedThreadCount.fetch_add(1);
+			while (recordedThreadCount.load() != THREAD_COUNT)
+				std::this_thread::yield();
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	// The scope is opened in the first frame and closed in the second one
+	Name frameSpanningName("FrameSpanning");
+	recorder.begin_scope(frameSpanningName);
+
+	profiler::CPUTimeline timeline;
+	recorder.end_frame(timeline);
+
+	if (timeline.threads.size() != THREAD_COUNT + 1 || timeline.events.size() != THREAD_COUNT * 5 + 1)
+		return false;
+
+	std::vector<uint32_t> jobCountByThread(timeline.threads.size());
+	for (uint32_t i = 0; i != timeline.events.size(); ++i)
+	{
+		const profiler::CPUTimelineEvent& event = timeline.events[i];
+		if (event.name == frameSpanningName)
+		{
+			if (event.isFinished || event.depth != 0)
+				return false;
+			continue;
+		}
+
+		if (!event.isFinished || event.endNs < event.beginNs)
+			return false;
+
+		if (event.name == jobName)
+		{
+			if (event.depth != 0 || event.parentIndex != profiler::INVALID_CPU_EVENT_INDEX)
+				return false;
+			++jobCountByThread[event.threadIndex];
+			continue;
+		}
+
+		const profiler::CPUTimelineEvent& parent = timeline.events[event.parentIndex];
+		if (parent.threadIndex != event.threadIndex || parent.depth + 1 != event.depth)
+			return false;
+		if (parent.beginNs > event.beginNs || parent.endNs < event.endNs)
+			return false;
+		if ((event.name == updateName && parent.name != jobName) || (event.name == physicsName && parent.name != updateName))
+			return false;
+	}
+
+	uint32_t threadsWithJobs = 0;
+	for (auto jobCount : jobCountByThread)
+		threadsWithJobs += jobCount == 1;
+	if (threadsWithJobs != THREAD_COUNT)
+		return false;
+
+	recorder.end_scope();
+	recorder.end_frame(timeline);
+	return timeline.events.empty() && timeline.frameID == 1;
+}
+
+bool validate_trace_capture()
+{
+	constexpr uint64_t FRAME_DURATION_NS = 1000000;
+	constexpr uint32_t CAPTURED_FRAME_COUNT = 30;
+
+	// Frames that ended more than 10 ms before the last frame are evicted
+	profiler::TraceCapture traceCapture(0.01);
+	Name scopeName("Scope with \"quotes\" and \\ slash");
+	for (uint32_t i = 0; i != CAPTURED_FRAME_COUNT; ++i)
+	{
+		profiler::CapturedFrame& frame = traceCapture.add_frame();
+		profiler::CPUTimeline& cpuTimeline = frame.cpuTimeline;
+		cpuTimeline.frameID = i;
+		cpuTimeline.frameBeginNs = i * FRAME_DURATION_NS;
+		cpuTimeline.frameEndNs = (i + 1) * FRAME_DURATION_NS;
+		cpuTimeline.threads.resize(2);
+		cpuTimeline.threads[0].name = "Main thread";
+		cpuTimeline.threads[1].threadIndex = 1;
+		cpuTimeline.threads[1].name = "Worker 0";
+
+		for (uint32_t threadIndex = 0; threadIndex != 2; ++threadIndex)
+		{
+			profiler::CPUTimelineEvent& event = cpuTimeline.events.emplace_back();
+			event.name = scopeName;
+			event.threadIndex = threadIndex;
+			event.category = profiler::ScopeCategory::RENDERER;
+			event.color = threadIndex ? 0x00FF00 : profiler::SCOPE_COLOR_DEFAULT;
+			event.beginNs = cpuTimeline.frameBeginNs;
+			event.endNs = cpuTimeline.frameEndNs;
+		}
+
+		profiler::GPUTimelineEvent& gpuEvent = frame.gpuEvents.emplace_back();
+		gpuEvent.name = "GPU range";
+		gpuEvent.beginNs = 1000;
+		gpuEvent.endNs = 2000;
+	}
+
+	constexpr uint32_t FIRST_KEPT_FRAME = 18;
+	if (traceCapture.get_captured_frame_count() != CAPTURED_FRAME_COUNT - FIRST_KEPT_FRAME)
+		return false;
+	if (traceCapture.get_frame(FIRST_KEPT_FRAME - 1) || !traceCapture.get_frame(FIRST_KEPT_FRAME))
+		return false;
+	if (traceCapture.get_frame(CAPTURED_FRAME_COUNT - 1)->cpuTimeline.frameID != CAPTURED_FRAME_COUNT - 1)
+		return false;
+
+	std::string trace;
+	traceCapture.export_chrome_trace(trace);
+	nlohmann::json traceJson = nlohmann::json::parse(trace, nullptr, false);
+	if (traceJson.is_discarded())
+		return false;
+
+	uint32_t cpuEventCount = 0, gpuEventCount = 0, threadNameCount = 0;
+	for (auto& event : traceJson["traceEvents"])
+	{
+		if (event["ph"] == "M")
+		{
+			threadNameCount += event["name"] == "thread_name";
+			continue;
+		}
+
+		if (event["pid"] == 1)
+		{
+			if (event["name"] != scopeName.get_string_view() || event["dur"].get<double>() != FRAME_DURATION_NS / 1000.0)
+				return false;
+			if (event["cat"] != "renderer" || (event["tid"] == 1) != (event.contains("args") && event["args"]["color"] == "#00ff00"))
+				return false;
+			++cpuEventCount;
+		}
+		else
+		{
+			// GPU events are aligned to the beginning of the CPU frame
+			double frameBeginUs = event["ts"].get<double>() - 1.0;
+			if (event["name"] != "GPU range" || static_cast<uint64_t>(frameBeginUs * 1000.0) % FRAME_DURATION_NS)
+				return false;
+			++gpuEventCount;
+		}
+	}
+
+	uint32_t keptFrameCount = CAPTURED_FRAME_COUNT - FIRST_KEPT_FRAME;
+	return cpuEventCount == keptFrameCount * 2 && gpuEventCount == keptFrameCount && threadNameCount == 3;
+}
+
+bool validate_range_statistics()
+{
+	std::vector<profiler::Timing> scratch;
+	profiler::RangeTimingHistory history;
+	for (uint32_t i = 1; i <= 1000; ++i)
+		history.add_timing(static_cast<profiler::Timing>(i), profiler::DEFAULT_HITCH_THRESHOLD);
+
+	profiler::RangeStatistics statistics;
+	history.calculate_statistics(statistics, scratch);
+	if (statistics.sampleCount != 1000 || statistics.min != 1.0f || statistics.max != 1000.0f || statistics.average != 500.5)
+		return false;
+	if (statistics.p50 != 500.0f || statistics.p95 != 950.0f || statistics.p99 != 990.0f)
+		return false;
+	// Sample standard deviation of 1..n is sqrt(n * (n + 1) / 12)
+	if (std::abs(statistics.standardDeviation - std::sqrt(1000.0 * 1001.0 / 12.0)) > 1e-6)
+		return false;
+
+	// Percentiles use only the window, the hitch is detected after warm-up
+	profiler::RangeTimingHistory windowHistory(4);
+	for (uint32_t i = 0; i != profiler::HITCH_WARMUP_SAMPLE_COUNT; ++i)
+		windowHistory.add_timing(1.0f, profiler::DEFAULT_HITCH_THRESHOLD);
+	if (!windowHistory.add_timing(5.0f, profiler::DEFAULT_HITCH_THRESHOLD))
+		return false;
+	for (uint32_t i = 0; i != 4; ++i)
+		windowHistory.add_timing(1.0f, profiler::DEFAULT_HITCH_THRESHOLD);
+	windowHistory.calculate_statistics(statistics, scratch);
+	if (statistics.hitchCount != 1 || statistics.max != 5.0f || statistics.p99 != 1.0f)
+		return false;
+
+	Name slowRangeName("SlowRange"), stableRangeName("StableRange"), hitchingRangeName("HitchingRange");
+	profiler::RangeStatistics baselineStatistics;
+	baselineStatistics.sampleCount = 1000;
+	baselineStatistics.average = 10.0;
+	baselineStatistics.standardDeviation = 1.0;
+	baselineStatistics.hitchCount = 5;
+
+	profiler::RangeStatisticsCapture baseline;
+	baseline.cpuRanges[slowRangeName] = baselineStatistics;
+	baseline.cpuRanges[stableRangeName] = baselineStatistics;
+	baseline.gpuRanges[hitchingRangeName] = baselineStatistics;
+
+	profiler::RangeStatisticsCapture current = baseline;
+	current.cpuRanges[slowRangeName].average = 11.0;
+	current.cpuRanges[stableRangeName].average = 10.02;
+	current.gpuRanges[hitchingRangeName].hitchCount = 40;
+
+	// Regressions must be found after saving and loading the capture
+	std::string serializedCapture;
+	current.serialize(serializedCapture);
+	profiler::RangeStatisticsCapture loadedCurrent;
+	loadedCurrent.deserialize(serializedCapture);
+	if (loadedCurrent.cpuRanges.size() != 2 || loadedCurrent.cpuRanges[slowRangeName].average != 11.0)
+		return false;
+
+	std::vector<profiler::RangeRegression> regressions;
+	profiler::find_regressions(baseline, loadedCurrent, profiler::RegressionSettings(), regressions);
+	if (regressions.size() != 2)
+		return false;
+	for (auto& regression : regressions)
+	{
+		if (regression.rangeName == slowRangeName && (!regression.isAverageRegressed || regression.isGPURange))
+			return false;
+		if (regression.rangeName == hitchingRangeName && (!regression.isHitchRateRegressed || !regression.isGPURange))
+			return false;
+		if (regression.rangeName == stableRangeName)
+			return false;
+	}
+
+	return true;
+}
+
+// Every frame the profiler fills timings of all ranges, FrameStats used to store them by std::string keys
+void run_range_timing_benchmark()
+{
+	constexpr uint32_t RANGE_COUNT = 64;
+	constexpr uint32_t FRAME_COUNT = 10000;
+
+	std::vector<Name> names;
+	for (uint32_t i = 0; i != RANGE_COUNT; ++i)
+		names.emplace_back("Range " + std::to_string(i));
+
+	Timer timer;
+	std::unordered_map<std::string, profiler::Timing> timingByString;
+	for (uint32_t frame = 0; frame != FRAME_COUNT; ++frame)
+	{
+		timingByString.clear();
+		for (auto& name : names)
+			timingByString[name.to_string()] += 1.0f;
+	}
+	double stringTime = timer.elapsed_milliseconds();
+
+	timer.record();
+	profiler::RangeTimingTable timingByName;
+	for (uint32_t frame = 0; frame != FRAME_COUNT; ++frame)
+	{
+		timingByName.clear();
+		for (auto& name : names)
+			timingByName[name] += 1.0f;
+	}
+	double nameTime = timer.elapsed_milliseconds();
+
+	LOG_INFO("Filling {} range timings for {} frames: std::string keys {} ms, Name keys {} ms", RANGE_COUNT, FRAME_COUNT, stringTime, nameTime)
+}
+
+bool validate_scope_descriptors()
+{
+	profiler::ScopeDescriptor descriptor("HashedScope", compile_time_fnv1("HashedScope"), profiler::ScopeCategory::ECS, 0xFF8000);
+	if (descriptor.name != Name("HashedScope") || descriptor.name.get_hash() != descriptor.hash)
+		return false;
+
+	profiler::CPUEventRecorder recorder;
+	recorder.begin_scope(descriptor.name, descriptor.category, descriptor.color);
+	recorder.begin_scope(Name("PlainScope"));
+	recorder.end_scope();
+	recorder.end_scope();
+
+	profiler::CPUTimeline timeline;
+	recorder.end_frame(timeline);
+	if (timeline.events.size() != 2)
+		return false;
+
+	const profiler::CPUTimelineEvent& hashedEvent = timeline.events[0];
+	const profiler::CPUTimelineEvent& plainEvent = timeline.events[1];
+	return hashedEvent.category == profiler::ScopeCategory::ECS && hashedEvent.color == 0xFF8000
+		&& plainEvent.category == profiler::ScopeCategory::GENERAL && plainEvent.color == profiler::SCOPE_COLOR_DEFAULT;
+}
+
+bool is_timing_equal(profiler::Timing timing, double expected)
+{
+	return std::abs(timing - expected) <= expected * 1e-5;
+}
+
+// NullRHI synthesises timestamps and pipeline statistics, so per-pass GPU statistics are checked without a device
+bool validate_gpu_range_statistics()
+{
+	constexpr uint32_t GPU_FRAME_COUNT = 100;
+	constexpr uint32_t BUFFER_COUNT = 2;
+	constexpr uint32_t RESOLVED_FRAME_COUNT = GPU_FRAME_COUNT - BUFFER_COUNT;
+	constexpr uint64_t VERTICES_PER_FRAME = 3000;
+
+	// Costs are powers of two, so synthesised timings are exact
+	rhi::NullRHICostModel costModel;
+	costModel.commandNs = 1000;
+	costModel.vertexNs = 0.25;
+	costModel.fragmentNs = 0.125;
+	costModel.computeInvocationNs = 0.5;
+	costModel.fragmentsPerPrimitive = 64;
+	costModel.computeGroupSize = 64;
+	rhi::NullRHI nullRHI(BUFFER_COUNT, costModel);
+
+	profiler::ProfilerInstanceInitContext initContext;
+	initContext.frameStatsHistoryCapacity = GPU_FRAME_COUNT;
+	profiler::ProfilerInstance profilerInstance(initContext);
+	profilerInstance.set_rhi(&nullRHI);
+
+	// Geometry cost grows every frame, lighting and culling costs are constant
+	Name geometryName("Geometry"), lightingName("Lighting"), cullingName("Culling"), nestedName("Nested");
+	for (uint32_t i = 0; i != GPU_FRAME_COUNT; ++i)
+	{
+		profilerInstance.begin_cpu_frame();
+		profilerInstance.begin_gpu_frame();
+		rhi::CommandBuffer cmd;
+		nullRHI.begin_command_buffer(&cmd);
+
+		profiler::RangeID rangeID = profilerInstance.begin_gpu_range(geometryName, cmd, true);
+		profiler::RangeID nestedRangeID = profilerInstance.begin_gpu_range(nestedName, cmd);
+		nullRHI.draw(&cmd, VERTICES_PER_FRAME * (i + 1));
+		profilerInstance.end_gpu_range(nestedRangeID);
+		profilerInstance.end_gpu_range(rangeID);
+
+		rangeID = profilerInstance.begin_gpu_range(lightingName, cmd, true);
+		nullRHI.draw(&cmd, 6);
+		profilerInstance.end_gpu_range(rangeID);
+
+		rangeID = profilerInstance.begin_gpu_range(cullingName, cmd, true);
+		nullRHI.dispatch(&cmd, 16, 1, 1);
+		profilerInstance.end_gpu_range(rangeID);
+
+		profilerInstance.end_gpu_frame();
+		profilerInstance.end_frame();
+	}
+
+	// Geometry of frame i takes commandNs + 3000 * (i + 1) vertices * 0.25 + 64000 * (i + 1) fragments * 0.125
+	auto get_geometry_time = [](uint32_t frameIndex) { return (1000.0 + 8750.0 * (frameIndex + 1)) / 1000000.0; };
+
+	// Query results are read back when the buffer is reused, so frame stats contain ranges of frame i - BUFFER_COUNT
+	profiler::FrameStatsManager& frameStatsManager = profilerInstance.get_frame_stats_manager();
+	const profiler::FrameStats* firstFrameStats = frameStatsManager.get_frame_stats(0);
+	const profiler::FrameStats* frameStats = frameStatsManager.get_frame_stats(10);
+	if (!firstFrameStats->get_gpu_timings().empty() || frameStats->get_gpu_timings().size() != 5)
+		return false;
+	if (!is_timing_equal(frameStats->get_gpu_timings().at(geometryName), get_geometry_time(10 - BUFFER_COUNT)))
+		return false;
+	const rhi::PipelineStatistics& geometryStatistics = frameStats->get_pipeline_statistics().at(geometryName);
+	if (frameStats->get_pipeline_statistics().size() != 3
+		|| geometryStatistics.vertexShaderInvocations != VERTICES_PER_FRAME * (10 - BUFFER_COUNT + 1)
+		|| geometryStatistics.inputAssemblyPrimitives != 1000 * (10 - BUFFER_COUNT + 1))
+		return false;
+
+	profiler::RangeStatisticsCapture capture;
+	frameStatsManager.capture_range_statistics(capture);
+	std::string serializedCapture;
+	capture.serialize(serializedCapture);
+	profiler::RangeStatisticsCapture loadedCapture;
+	loadedCapture.deserialize(serializedCapture);
+
+	// Nearest-rank percentiles of geometry timings are timings of frames rank - 1
+	const profiler::RangeStatistics& geometry = loadedCapture.gpuRanges[geometryName];
+	if (geometry.sampleCount != RESOLVED_FRAME_COUNT
+		|| !is_timing_equal(geometry.min, get_geometry_time(0))
+		|| !is_timing_equal(geometry.max, get_geometry_time(RESOLVED_FRAME_COUNT - 1))
+		|| !is_timing_equal(geometry.p50, get_geometry_time(48))
+		|| !is_timing_equal(geometry.p95, get_geometry_time(93))
+		|| !is_timing_equal(geometry.p99, get_geometry_time(97)))
+		return false;
+
+	const profiler::RangeStatistics& culling = loadedCapture.gpuRanges[cullingName];
+	if (culling.sampleCount != RESOLVED_FRAME_COUNT || !is_timing_equal(culling.p50, (1000.0 + 1024 * 0.5) / 1000000.0))
+		return false;
+
+	using profiler::PipelineStatisticType;
+	if (loadedCapture.pipelineStatistics.size() != 3)
+		return false;
+	const profiler::PipelineStatisticsSummary& geometrySummary = loadedCapture.pipelineStatistics[geometryName];
+	const profiler::RangeStatistics& vertexInvocations = geometrySummary[(size_t)PipelineStatisticType::VERTEX_SHADER_INVOCATIONS];
+	if (vertexInvocations.sampleCount != RESOLVED_FRAME_COUNT
+		|| vertexInvocations.min != VERTICES_PER_FRAME
+		|| vertexInvocations.p50 != VERTICES_PER_FRAME * 49
+		|| vertexInvocations.average != VERTICES_PER_FRAME * (RESOLVED_FRAME_COUNT + 1) / 2.0
+		|| vertexInvocations.hitchCount)
+		return false;
+	const profiler::PipelineStatisticsSummary& lightingSummary = loadedCapture.pipelineStatistics[lightingName];
+	const profiler::PipelineStatisticsSummary& cullingSummary = loadedCapture.pipelineStatistics[cullingName];
+	if (lightingSummary[(size_t)PipelineStatisticType::FRAGMENT_SHADER_INVOCATIONS].p99 != 128.0f
+		|| lightingSummary[(size_t)PipelineStatisticType::COMPUTE_SHADER_INVOCATIONS].max != 0.0f
+		|| cullingSummary[(size_t)PipelineStatisticType::COMPUTE_SHADER_INVOCATIONS].p50 != 1024.0f)
+		return false;
+
+	// GPU events are read back BUFFER_COUNT frames late but must be aligned to the frame that recorded them.
+	// The frame begins before its CPU Frame scope and after the CPU Frame scope of the previous frame
+	std::string trace;
+	profilerInstance.export_trace(trace);
+	nlohmann::json traceJson = nlohmann::json::parse(trace, nullptr, false);
+	if (traceJson.is_discarded())
+		return false;
+
+	std::vector<double> cpuFrameBegins, gpuFrameBegins, geometryDurations;
+	for (auto& event : traceJson["traceEvents"])
+	{
+		if (event["ph"] == "M")
+			continue;
+		if (event["name"] == "CPU Frame")
+			cpuFrameBegins.push_back(event["ts"].get<double>());
+		else if (event["name"] == "GPU range")
+			gpuFrameBegins.push_back(event["ts"].get<double>());
+		else if (event["name"] == geometryName.get_string_view())
+			geometryDurations.push_back(event["dur"].get<double>());
+	}
+	if (cpuFrameBegins.size() != GPU_FRAME_COUNT || gpuFrameBegins.size() != RESOLVED_FRAME_COUNT
+		|| geometryDurations.size() != RESOLVED_FRAME_COUNT)
+		return false;
+	for (uint32_t i = 0; i != RESOLVED_FRAME_COUNT; ++i)
+	{
+		if (gpuFrameBegins[i] > cpuFrameBegins[i] || (i && gpuFrameBegins[i] < cpuFrameBegins[i - 1]))
+			return false;
+		if (!is_timing_equal(geometryDurations[i] / 1000.0, get_geometry_time(i)))
+			return false;
+	}
+
+	return true;
+}
+
+class TestResidencyProvider : public profiler::IResourceResidencyProvider
+{
+	public:
+		uint64_t residentSize{ 0 };
+
+		void get_residency_usage(std::vector<profiler::ResourceResidencyUsage>& outUsage) const override
+		{
+			outUsage.clear();
+			profiler::ResourceResidencyUsage& usage = outUsage.emplace_back();
+			usage.typeName = "texture";
+			usage.residentSize = residentSize;
+			usage.budget = 1024;
+			usage.evictionCount = residentSize / 1024;
+		}
+};
+
+// Residency is pulled from the provider at the end of every frame and survives serialization of frame stats
+bool validate_resource_residency_stats()
+{
+	rhi::NullRHI nullRHI(2, rhi::NullRHICostModel());
+	profiler::ProfilerInstanceInitContext initContext;
+	profiler::ProfilerInstance profilerInstance(initContext);
+	profilerInstance.set_rhi(&nullRHI);
+	TestResidencyProvider provider;
+	profilerInstance.set_resource_residency_provider(&provider);
+
+	for (uint32_t i = 0; i != 4; ++i)
+	{
+		provider.residentSize = 1000 * (i + 1);
+		profilerInstance.begin_cpu_frame();
+		profilerInstance.begin_gpu_frame();
+		profilerInstance.end_gpu_frame();
+		profilerInstance.end_frame();
+	}
+	profilerInstance.set_resource_residency_provider(nullptr);
+
+	profiler::FrameStats* frameStats = profilerInstance.get_frame_stats_manager().get_frame_stats(2);
+	std::string serializedStats;
+	frameStats->serialize(serializedStats);
+	profiler::FrameStats loadedStats;
+	loadedStats.deserialize(serializedStats);
+
+	const std::vector<profiler::ResourceResidencyUsage>& usage = loadedStats.get_resource_residency_usage();
+	return usage.size() == 1
+		&& usage[0].typeName == "texture"
+		&& usage[0].residentSize == 3000
+		&& usage[0].budget == 1024
+		&& usage[0].evictionCount == 2;
+}
+
+// Enabled state is latched at the beginning of the frame, so toggling the profiler inside a frame doesn't leave scopes open
+bool validate_enable_inside_frame()
+{
+	rhi::NullRHI nullRHI(2, rhi::NullRHICostModel());
+	profiler::ProfilerInstanceInitContext initContext;
+	initContext.isEnabled = false;
+	profiler::ProfilerInstance profilerInstance(initContext);
+	profilerInstance.set_rhi(&nullRHI);
+
+	profilerInstance.begin_cpu_frame();
+	profilerInstance.set_enable(true);
+	profilerInstance.begin_gpu_frame();
+	profilerInstance.end_gpu_frame();
+	profilerInstance.end_frame();
+	if (profilerInstance.get_cpu_timeline(0))
+		return false;
+
+	for (uint32_t i = 0; i != 4; ++i)
+	{
+		profilerInstance.set_enable(true);
+		profilerInstance.begin_cpu_frame();
+		profilerInstance.begin_gpu_frame();
+		profilerInstance.set_enable(false);
+		profilerInstance.end_gpu_frame();
+		profilerInstance.end_frame();
+	}
+
+	const profiler::CPUTimeline* timeline = profilerInstance.get_cpu_timeline(3);
+	return timeline && timeline->events.size() == 1 && timeline->events[0].isFinished
+		&& profilerInstance.get_frame_stats_manager().get_frame_stats(3)->get_gpu_timings().size() == 1;
+}
+
+// Instrumentation stays in hot loops, so the cost of a scope must be negligible when the profiler is disabled
+void run_disabled_scope_benchmark()
+{
+	constexpr uint32_t ITERATION_COUNT = 10000000;
+
+	volatile uint64_t sink = 0;
+	Timer timer;
+	for (uint32_t i = 0; i != ITERATION_COUNT; ++i)
+		sink = sink + i;
+	double loopTime = timer.elapsed_milliseconds();
+
+	profiler::ProfilerInstanceInitContext initContext;
+	initContext.isEnabled = false;
+	initContext.frameStatsHistoryCapacity = 1;
+	profiler::ProfilerInstance profilerInstance(initContext);
+	profiler::ProfilerInstance* previousProfilerInstance = profiler::Profiler::get_profiler_instance();
+	profiler::Profiler::init(&profilerInstance);
+
+	timer.record();
+	for (uint32_t i = 0; i != ITERATION_COUNT; ++i)
+	{
+		PROFILER_SCOPE_CATEGORY("DisabledHotLoopScope", profiler::ScopeCategory::ECS);
+		sink = sink + i;
+	}
+	double scopeTime = timer.elapsed_milliseconds();
+
+	// The local instance is destroyed on return, so it must not stay installed
+	if (previousProfilerInstance)
+		profiler::Profiler::init(previousProfilerInstance);
+	else
+		profiler::Profiler::reset();
+
+	LOG_INFO("Disabled profiler: loop {} ms, loop with scope {} ms, {} ns per scope",
+		loopTime, scopeTime, (scopeTime - loopTime) * 1000000.0 / ITERATION_COUNT)
+}
+
+double measure_scope_overhead(profiler::CPUEventRecorder& recorder, Name scopeName)
+{
+	Timer timer;
+	for (uint32_t i = 0; i != SCOPES_PER_FRAME; ++i)
+	{
+		recorder.begin_scope(scopeName);
+		recorder.end_scope();
+	}
+	return timer.elapsed_milliseconds() * 1000000.0 / SCOPES_PER_FRAME;
+}
+
+int main()
+{
+	if (!validate_timeline())
+	{
+		LOG_ERROR("CPU timeline is invalid")
+		return 1;
+	}
+	LOG_INFO("CPU timeline is valid")
+
+	if (!validate_trace_capture())
+	{
+		LOG_ERROR("Trace capture is invalid")
+		return 1;
+	}
+	LOG_INFO("Trace capture is valid")
+
+	if (!validate_range_statistics())
+	{
+		LOG_ERROR("Range statistics are invalid")
+		return 1;
+	}
+	LOG_INFO("Range statistics are valid")
+
+	if (!validate_gpu_range_statistics())
+	{
+		LOG_ERROR("GPU range statistics are invalid")
+		return 1;
+	}
+	LOG_INFO("GPU range statistics are valid")
+	run_range_timing_benchmark();
+
+	if (!validate_resource_residency_stats())
+	{
+		LOG_ERROR("Resource residency stats are invalid")
+		return 1;
+	}
+	LOG_INFO("Resource residency stats are valid")
+
+	if (!validate_enable_inside_frame())
+	{
+		LOG_ERROR("Enabling the profiler inside a frame is invalid")
+		return 1;
+	}
+	LOG_INFO("Enabling the profiler inside a frame is valid")
+
+	if (!validate_scope_descriptors())
+	{
+		LOG_ERROR("Scope descriptors are invalid")
+		return 1;
+	}
+	LOG_INFO("Scope descriptors are valid")
+	run_disabled_scope_benchmark();
+
+	// Capacity is enough to store all scopes of the frame, so the benchmark measures recording, not dropping
+	profiler::CPUEventRecorder recorder(SCOPES_PER_FRAME);
+	Name scopeName("BenchmarkScope");
+	profiler::CPUTimeline timeline;
+	double singleThreadOverhead = 0.0;
+	for (uint32_t i = 0; i != FRAME_COUNT; ++i)
+	{
+		singleThreadOverhead += measure_scope_overhead(recorder, scopeName) / FRAME_COUNT;
+		recorder.end_frame(timeline);
+	}
+	LOG_INFO("One thread: {} ns per scope, {} events merged per frame", singleThreadOverhead, timeline.events.size())
+
+	std::vector<double> overheads(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&recorder, &overhead = overheads[i], scopeName]()
+		{
+			overhead = measure_scope_overhead(recorder, scopeName);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	Timer timer;
+	recorder.end_frame(timeline);
+	LOG_INFO("{} threads: {} ns per scope in the first thread, merged {} events in {} ms",
+		THREAD_COUNT, overheads[0], timeline.events.size(), timer.elapsed_milliseconds())
+
+	// Two timestamps are taken per scope, so the clock cost is the lower bound of the overhead
+	Timer clockTimer;
+	uint64_t ticksChecksum = 0;
+	for (uint32_t i = 0; i != SCOPES_PER_FRAME; ++i)
+		ticksChecksum += profiler::CPUClock::get_ticks();
+	LOG_INFO("Reading the clock: {} ns, checksum {}", clockTimer.elapsed_milliseconds() * 1000000.0 / SCOPES_PER_FRAME, ticksChecksum)
+
+	// Timings depend on the machine and its load, so the budget is only reported. Timings of unoptimized builds
+	// don't say anything about the recorder
+#ifdef NDEBUG
+	if (singleThreadOverhead > MAX_SCOPE_OVERHEAD_NS)
+	{
+		LOG_WARNING("Scope overhead {} ns is higher than {} ns", singleThreadOverhead, MAX_SCOPE_OVERHEAD_NS)
+	}
+#endif
+
+	return 0;
+}
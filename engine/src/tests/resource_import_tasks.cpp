@@ -0,0 +1,195 @@
+#include "resource_manager/module/resource_manager.h"
+#include "file_system/IO.h"
+#include "core/global_objects.h"
+#include "profiler/logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t SOURCE_COUNT = 24;
+constexpr uint32_t TEXTURE_WIDTH = 32;
+constexpr uint32_t TEXTURE_HEIGHT = 32;
+constexpr uint64_t TGA_HEADER_SIZE = 18;
+constexpr uint64_t SOURCE_SIZE = TGA_HEADER_SIZE + TEXTURE_WIDTH * TEXTURE_HEIGHT * 3;
+// RGB textures are imported with 4 channels
+constexpr uint64_t TEXTURE_SIZE = TEXTURE_WIDTH * TEXTURE_HEIGHT * 4;
+
+// Writes uncompressed 24-bit TGA files, each one is filled with its own color
+std::vector<resource::experimental::ResourceImportRequest> create_sources(const std::filesystem::path& directory, const std::string& prefix)
+{
+	std::filesystem::path sourceDirectory = directory / "sources" / prefix;
+	std::filesystem::path contentDirectory = directory / "content" / prefix;
+	std::filesystem::create_directories(sourceDirectory);
+	std::filesystem::create_directories(contentDirectory);
+
+	std::vector<resource::experimental::ResourceImportRequest> requests;
+	for (uint32_t i = 0; i != SOURCE_COUNT; ++i)
+	{
+		std::vector<uint8_t> data(SOURCE_SIZE, static_cast<uint8_t>(i * 10));
+		uint8_t header[TGA_HEADER_SIZE] = { 0, 0, 2 };
+		header[12] = TEXTURE_WIDTH & 0xFF;
+		header[13] = TEXTURE_WIDTH >> 8;
+		header[14] = TEXTURE_HEIGHT & 0xFF;
+		header[15] = TEXTURE_HEIGHT >> 8;
+		header[16] = 24;
+		memcpy(data.data(), header, TGA_HEADER_SIZE);
+
+		std::filesystem::path path = sourceDirectory / (prefix + "_" + std::to_string(i) + ".tga");
+		std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(data.data()), data.size());
+		auto& request = requests.emplace_back();
+		request.originalResourcePath = path.string();
+		request.engineResourcePath = contentDirectory.string();
+	}
+	return requests;
+}
+
+// The limit is checked before sources are decoded, so it bounds the number of sources in flight
+// and their decoded size is counted when it is known
+bool validate_in_flight_size(resource::impl::ResourceManager& resourceManager, const std::filesystem::path& directory)
+{
+	for (uint64_t maxSourceCount : { 1, 4 })
+	{
+		auto requests = create_sources(directory, "limit_" + std::to_string(maxSourceCount));
+		resource::experimental::ResourceImportSettings settings;
+		settings.maxInFlightSize = maxSourceCount == 1 ? 1 : maxSourceCount * SOURCE_SIZE;
+		settings.areResourcesUnloaded = true;
+		resource::experimental::ResourceImportResult result = resourceManager.import_resources(requests, settings, nullptr);
+
+		const auto& progress = result.progress;
+		LOG_INFO("{} sources in flight: peak in-flight size {} bytes", maxSourceCount, progress.peakInFlightSize)
+		if (result.uuids.size() != SOURCE_COUNT || progress.failedSourceCount
+			|| progress.peakInFlightSize > maxSourceCount * TEXTURE_SIZE || progress.peakInFlightSize < TEXTURE_SIZE)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool validate_progress(resource::impl::ResourceManager& resourceManager, const std::filesystem::path& directory)
+{
+	auto requests = create_sources(directory, "progress");
+	std::vector<resource::experimental::ResourceImportProgress> reports;
+	resource::experimental::ResourceImportSettings settings;
+	settings.areResourcesUnloaded = true;
+	resource::experimental::ResourceImportResult result = resourceManager.import_resources(requests, settings,
+		[&](const resource::experimental::ResourceImportProgress& progress)
+		{
+			reports.push_back(progress);
+		});
+
+	// The callback is called once after each completed source
+	if (reports.size() != SOURCE_COUNT)
+		return false;
+	for (uint32_t i = 0; i != reports.size(); ++i)
+	{
+		const auto& progress = reports[i];
+		if (progress.sourceCount != SOURCE_COUNT || progress.completedSourceCount != i + 1
+			|| progress.sourceSize != progress.completedSourceCount * SOURCE_SIZE || progress.failedSourceCount)
+		{
+			return false;
+		}
+		if (i && (progress.writtenResourceCount < reports[i - 1].writtenResourceCount || progress.writtenSize < reports[i - 1].writtenSize))
+			return false;
+	}
+
+	const auto& progress = result.progress;
+	return result.uuids.size() == SOURCE_COUNT
+		&& progress.completedSourceCount == SOURCE_COUNT
+		&& progress.writtenResourceCount == SOURCE_COUNT
+		&& progress.writtenSize == reports.back().writtenSize
+		&& progress.writtenSize != 0;
+}
+
+// Sources that can't be read or decoded are skipped, other sources are imported
+bool validate_partial_failure(resource::impl::ResourceManager& resourceManager, const std::filesystem::path& directory)
+{
+	auto requests = create_sources(directory, "partial");
+	std::filesystem::path brokenPath = directory / "sources" / "partial" / "broken.png";
+	std::ofstream(brokenPath, std::ios::binary) << "not an image";
+
+	auto brokenRequest = requests[0];
+	brokenRequest.originalResourcePath = brokenPath.string();
+	auto missingRequest = requests[0];
+	missingRequest.originalResourcePath = (directory / "sources" / "partial" / "missing.png").string();
+	requests.insert(requests.begin() + SOURCE_COUNT / 2, brokenRequest);
+	requests.push_back(missingRequest);
+
+	uint32_t lastFailedCount = 0;
+	resource::experimental::ResourceImportSettings settings;
+	settings.areResourcesUnloaded = true;
+	resource::experimental::ResourceImportResult result = resourceManager.import_resources(requests, settings,
+		[&](const resource::experimental::ResourceImportProgress& progress)
+		{
+			lastFailedCount = progress.failedSourceCount;
+		});
+
+	const auto& progress = result.progress;
+	if (result.uuids.size() != SOURCE_COUNT || progress.completedSourceCount != SOURCE_COUNT + 2
+		|| progress.failedSourceCount != 2 || lastFailedCount != 2 || progress.writtenResourceCount != SOURCE_COUNT)
+	{
+		return false;
+	}
+
+	// Files of imported resources are written and their textures are loaded from them
+	for (UUID uuid : result.uuids)
+	{
+		auto texture = resourceManager.get_texture(uuid);
+		if (!texture.get_resource() || texture.get_resource()->get_info().size != TEXTURE_SIZE)
+			return false;
+		resourceManager.unload_resource(uuid);
+	}
+	return true;
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ad_astris_resource_import_tasks";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "configs");
+
+	GlobalObjectContext context;
+	GlobalObjects::set_global_object_context(&context);
+	context.fileSystem = std::make_unique<io::EngineFileSystem>(directory.string().c_str());
+	context.fileSystem->set_project_root_path(directory.string());
+	context.taskComposer = std::make_unique<tasks::TaskComposer>();
+	context.eventManager = std::make_unique<events::EventManager>();
+
+	resource::impl::ResourceManager resourceManager;
+	resourceManager.init();
+
+	if (!validate_in_flight_size(resourceManager, directory))
+	{
+		LOG_ERROR("In-flight size of resource imports is invalid")
+		resourceManager.cleanup();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("In-flight size of resource imports is valid")
+
+	if (!validate_progress(resourceManager, directory))
+	{
+		LOG_ERROR("Progress of resource imports is invalid")
+		resourceManager.cleanup();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Progress of resource imports is valid")
+
+	if (!validate_partial_failure(resourceManager, directory))
+	{
+		LOG_ERROR("Resource imports with failed sources are invalid")
+		resourceManager.cleanup();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Resource imports with failed sources are valid")
+
+	resourceManager.cleanup();
+	std::filesystem::remove_all(directory);
+	return 0;
+}
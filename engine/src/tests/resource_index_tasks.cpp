@@ -0,0 +1,305 @@
+#include "resource_manager/resource_index.h"
+#include "resource_manager/utils.h"
+#include "file_system/IO.h"
+#include "core/config_base.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t RESOURCE_COUNT = 1000;
+constexpr uint32_t BENCHMARK_RESOURCE_COUNT = 50000;
+constexpr uint32_t LOOKUP_COUNT = 100000;
+
+// Pairs of records share the name without the ID like resources that were imported twice
+resource::ResourceIndexRecord generate_record(uint32_t seed)
+{
+	constexpr resource::ResourceType TYPES[] = {
+		resource::ResourceType::MODEL,
+		resource::ResourceType::TEXTURE,
+		resource::ResourceType::MATERIAL_TEMPLATE
+	};
+
+	resource::ResourceIndexRecord record;
+	record.uuid = (seed + 1) * 0x9E3779B97F4A7C15ull;
+	record.type = TYPES[seed % 3];
+	record.path = "content/resources/resource_" + std::to_string(seed) + ".aares";
+	record.name = "resource_" + std::to_string(seed / 2);
+	record.nameID = seed % 2;
+	record.isBuiltin = seed % 7 == 0;
+	return record;
+}
+
+bool are_records_equal(const resource::ResourceIndexRecord& first, const resource::ResourceIndexRecord& second)
+{
+	return first.uuid == second.uuid
+		&& first.type == second.type
+		&& first.path == second.path
+		&& first.name == second.name
+		&& first.nameID == second.nameID
+		&& first.isBuiltin == second.isBuiltin;
+}
+
+// Writes the INI resource table the same way as resource tables did before the index
+void write_config(io::FileSystem* fileSystem, const std::filesystem::path& configPath, uint32_t recordCount)
+{
+	std::ofstream(configPath, std::ios::trunc).close();
+	Config config;
+	config.load_from_file(configPath.string());
+	for (uint32_t i = 0; i != recordCount; ++i)
+	{
+		resource::ResourceIndexRecord record = generate_record(i);
+		Section section(record.path);
+		section.set_option("UUID", (uint64_t)record.uuid);
+		section.set_option("Type", resource::Utils::get_str_resource_type(record.type));
+		section.set_option("Builtin", record.isBuiltin);
+		section.set_option("Name", record.name);
+		section.set_option("NameID", (uint64_t)record.nameID);
+		config.set_section(section);
+	}
+	config.save(fileSystem);
+}
+
+bool validate_records(const resource::ResourceIndex& index, uint32_t recordCount)
+{
+	if (index.get_entry_count() != recordCount)
+		return false;
+
+	std::vector<UUID> uuids;
+	for (uint32_t i = 0; i != recordCount; ++i)
+	{
+		resource::ResourceIndexRecord expectedRecord = generate_record(i);
+		resource::ResourceIndexRecord record;
+		if (!index.find(expectedRecord.uuid, record) || !are_records_equal(record, expectedRecord))
+			return false;
+		if (index.find_uuid(expectedRecord.get_full_name()) != expectedRecord.uuid)
+			return false;
+
+		uuids.clear();
+		index.find_uuids_by_base_name(expectedRecord.name, uuids);
+		if (std::find(uuids.begin(), uuids.end(), expectedRecord.uuid) == uuids.end())
+			return false;
+	}
+
+	uint32_t typeCount = 0;
+	for (auto type : { resource::ResourceType::MODEL, resource::ResourceType::TEXTURE, resource::ResourceType::MATERIAL_TEMPLATE })
+	{
+		uuids.clear();
+		index.get_uuids(type, uuids);
+		typeCount += uuids.size();
+	}
+	return typeCount == recordCount && !index.contains(0) && index.find_uuid("missing_resource") == UUID(0);
+}
+
+bool validate_resource_index(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::filesystem::path configsDirectory = directory / "configs";
+	std::filesystem::create_directories(configsDirectory);
+	std::string indexPath = (configsDirectory / resource::RESOURCE_INDEX_FILE_NAME).string();
+	std::string logPath = (configsDirectory / resource::RESOURCE_LOG_FILE_NAME).string();
+	write_config(fileSystem, configsDirectory / resource::RESOURCE_TABLE_CONFIG_FILE_NAME, RESOURCE_COUNT);
+
+	// Projects without the index are migrated from the INI table
+	{
+		resource::ResourceIndex index;
+		index.load_project(fileSystem, directory.string());
+		if (!validate_records(index, RESOURCE_COUNT) || !std::filesystem::exists(indexPath))
+			return false;
+	}
+
+	// Changes are appended to the log and replayed over the index
+	resource::ResourceIndexRecord addedRecord = generate_record(RESOURCE_COUNT);
+	resource::ResourceIndexRecord changedRecord = generate_record(1);
+	changedRecord.path = "content/moved/resource_1.aares";
+	UUID removedUUID = generate_record(2).uuid;
+	{
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath))
+			return false;
+		index.add(addedRecord);
+		index.add(changedRecord);
+		index.remove(removedUUID);
+	}
+	auto validate_changes = [&](const resource::ResourceIndex& index)
+	{
+		resource::ResourceIndexRecord record;
+		return index.get_entry_count() == RESOURCE_COUNT
+			&& index.find(addedRecord.uuid, record) && are_records_equal(record, addedRecord)
+			&& index.find(changedRecord.uuid, record) && are_records_equal(record, changedRecord)
+			&& !index.contains(removedUUID)
+			&& index.find_uuid(generate_record(2).get_full_name()) == UUID(0)
+			&& index.find_uuid(addedRecord.get_full_name()) == addedRecord.uuid;
+	};
+	{
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath) || index.get_log_record_count() != 3 || !validate_changes(index))
+			return false;
+	}
+	std::filesystem::copy_file(logPath, logPath + ".old", std::filesystem::copy_options::overwrite_existing);
+
+	// A record that was partially written before a crash is discarded and the log is merged into a new index
+	{
+		std::ofstream log(logPath, std::ios::binary | std::ios::app);
+		const char tornRecord[] = { 1, 0, 0, 0, 64, 0, 0, 0, 7, 7 };
+		log.write(tornRecord, sizeof(tornRecord));
+	}
+	// A read-only index doesn't merge the log and doesn't write changes
+	{
+		uint64_t logSize = std::filesystem::file_size(logPath);
+		auto indexWriteTime = std::filesystem::last_write_time(indexPath);
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath, true) || !validate_changes(index))
+			return false;
+		index.remove(addedRecord.uuid);
+		if (index.save() || index.contains(addedRecord.uuid) || std::filesystem::file_size(logPath) != logSize
+			|| std::filesystem::last_write_time(indexPath) != indexWriteTime)
+			return false;
+	}
+	// A writable index merges the log
+	{
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath) || index.get_log_record_count() != 0 || !validate_changes(index))
+			return false;
+	}
+
+	// A log of the previous index is ignored, otherwise the removed resource would be restored
+	{
+		resource::ResourceIndex index;
+		index.load(fileSystem, indexPath, logPath);
+		index.remove(addedRecord.uuid);
+		if (!index.save())
+			return false;
+	}
+	std::filesystem::copy_file(logPath + ".old", logPath, std::filesystem::copy_options::overwrite_existing);
+	{
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath) || index.contains(addedRecord.uuid) || index.get_log_record_count() != 0)
+			return false;
+	}
+
+	// Long logs are compacted into the index
+	{
+		resource::ResourceIndex index;
+		index.load(fileSystem, indexPath, logPath);
+		for (uint32_t i = 0; i != RESOURCE_COUNT; ++i)
+		{
+			resource::ResourceIndexRecord record = generate_record(i);
+			record.path += ".new";
+			index.add(record);
+			index.add(generate_record(i));
+		}
+		index.add(addedRecord);
+		if (!index.is_compaction_needed() || !index.save() || index.is_compaction_needed())
+			return false;
+	}
+	{
+		resource::ResourceIndex index;
+		if (!index.load(fileSystem, indexPath, logPath) || index.get_log_record_count() != 0)
+			return false;
+		index.remove(addedRecord.uuid);
+		if (!validate_records(index, RESOURCE_COUNT))
+			return false;
+	}
+	return true;
+}
+
+void benchmark_resource_index(io::FileSystem* fileSystem, const std::filesystem::path& directory)
+{
+	std::filesystem::path projectDirectory = directory / "benchmark_project";
+	std::filesystem::path configsDirectory = projectDirectory / "configs";
+	std::filesystem::create_directories(configsDirectory);
+	std::filesystem::path configPath = configsDirectory / resource::RESOURCE_TABLE_CONFIG_FILE_NAME;
+	write_config(fileSystem, configPath, BENCHMARK_RESOURCE_COUNT);
+
+	std::vector<resource::ResourceIndexRecord> records(BENCHMARK_RESOURCE_COUNT);
+	for (uint32_t i = 0; i != BENCHMARK_RESOURCE_COUNT; ++i)
+		records[i] = generate_record(i);
+
+	// The INI table was parsed completely and every resource got a name when the table was loaded
+	Timer timer;
+	Config config;
+	config.load_from_file(fileSystem, configPath.string());
+	uint64_t checksum = 0;
+	for (auto section : config)
+	{
+		checksum += section.get_option_value<uint64_t>("UUID");
+		checksum += section.get_option_value<std::string>("Name").size();
+		checksum += section.get_option_value<uint64_t>("NameID");
+		checksum += static_cast<uint64_t>(resource::Utils::get_enum_resource_type(section.get_option_value<std::string>("Type")));
+		checksum += section.get_name().size();
+	}
+	LOG_INFO("INI table: {} resources loaded in {} ms, checksum {}", BENCHMARK_RESOURCE_COUNT, timer.elapsed_milliseconds(), checksum)
+
+	timer.record();
+	{
+		resource::ResourceIndex index;
+		index.load_project(fileSystem, projectDirectory.string());
+	}
+	LOG_INFO("Index: {} resources migrated from the INI table in {} ms", BENCHMARK_RESOURCE_COUNT, timer.elapsed_milliseconds())
+
+	io::URI indexPath = (configsDirectory / resource::RESOURCE_INDEX_FILE_NAME).string();
+	io::URI logPath = (configsDirectory / resource::RESOURCE_LOG_FILE_NAME).string();
+	resource::ResourceIndex index;
+	timer.record();
+	index.load(fileSystem, indexPath, logPath);
+	LOG_INFO("Index: {} resources loaded in {} ms", index.get_entry_count(), timer.elapsed_milliseconds())
+
+	checksum = 0;
+	timer.record();
+	resource::ResourceIndexRecord record;
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+	{
+		if (index.find(records[(i * 7919) % BENCHMARK_RESOURCE_COUNT].uuid, record))
+			checksum += record.path.size();
+	}
+	LOG_INFO("Index: {} lookups by UUID in {} ms, checksum {}", LOOKUP_COUNT, timer.elapsed_milliseconds(), checksum)
+
+	std::vector<std::string> fullNames(LOOKUP_COUNT);
+	for (uint32_t i = 0; i != LOOKUP_COUNT; ++i)
+		fullNames[i] = records[(i * 7919) % BENCHMARK_RESOURCE_COUNT].get_full_name();
+	checksum = 0;
+	timer.record();
+	for (auto& fullName : fullNames)
+		checksum += index.find_uuid(fullName);
+	LOG_INFO("Index: {} lookups by name in {} ms, checksum {}", LOOKUP_COUNT, timer.elapsed_milliseconds(), checksum)
+
+	timer.record();
+	for (uint32_t i = 0; i != resource::RESOURCE_LOG_COMPACTION_THRESHOLD; ++i)
+	{
+		resource::ResourceIndexRecord changedRecord = records[i];
+		changedRecord.path += ".new";
+		index.add(changedRecord);
+	}
+	LOG_INFO("Index: {} changes logged in {} ms", resource::RESOURCE_LOG_COMPACTION_THRESHOLD, timer.elapsed_milliseconds())
+
+	timer.record();
+	index.save();
+	LOG_INFO("Index: {} resources saved in {} ms", index.get_entry_count(), timer.elapsed_milliseconds())
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ad_astris_resource_index_tasks";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	io::EngineFileSystem fileSystem(directory.string().c_str());
+
+	if (!validate_resource_index(&fileSystem, directory))
+	{
+		LOG_ERROR("Resource index is invalid")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Resource index is valid")
+
+	benchmark_resource_index(&fileSystem, directory);
+	std::filesystem::remove_all(directory);
+
+	return 0;
+}
@@ -0,0 +1,478 @@
+#include "engine_core/model/model.h"
+#include "engine_core/texture/texture.h"
+#include "file_system/file.h"
+#include "rhi/utils.h"
+#include "core/custom_objects_to_json.h"
+#include "core/memory_tracker.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+
+#include <json/json.hpp>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t RESOURCE_COUNT = 20000;
+constexpr uint32_t VERTEX_COUNT = 24;
+constexpr uint32_t TEXTURE_SIZE = 4;
+constexpr uint32_t LARGE_RESOURCE_COUNT = 16;
+constexpr uint32_t LARGE_VERTEX_COUNT = 256 * 1024;
+constexpr uint32_t LARGE_TEXTURE_SIZE = 1024;
+
+// Small blobs, so the time of deserialization is dominated by metadata like in levels with many small resources
+ecore::ModelInfo generate_model_info(uint32_t seed)
+{
+	ecore::ModelInfo modelInfo;
+	for (uint32_t i = 0; i != VERTEX_COUNT; ++i)
+	{
+		float value = static_cast<float>(seed + i);
+		modelInfo.vertexPositions.push_back({ value, value * 0.5f, -value });
+		modelInfo.vertexNormals.push_back({ 0.0f, 1.0f, 0.0f });
+		modelInfo.vertexTangents.push_back({ 1.0f, 0.0f, 0.0f, 1.0f });
+		modelInfo.vertexUVSet0.push_back({ value / VERTEX_COUNT, 1.0f - value / VERTEX_COUNT });
+		modelInfo.vertexColors.push_back(seed * 31 + i);
+	}
+	for (uint32_t i = 0; i != VERTEX_COUNT * 3 / 2; ++i)
+		modelInfo.indices.push_back((seed + i) % VERTEX_COUNT);
+
+	uint32_t meshCount = seed % 3 + 1;
+	uint32_t indicesPerMesh = modelInfo.indices.size() / meshCount;
+	for (uint32_t i = 0; i != meshCount; ++i)
+	{
+		modelInfo.meshes.push_back({ indicesPerMesh, indicesPerMesh * i, i });
+		modelInfo.materialNames.push_back("material_" + std::to_string(seed) + "_" + std::to_string(i));
+	}
+
+	modelInfo.sphereBounds.origin = { static_cast<float>(seed), 1.0f, 2.0f };
+	modelInfo.sphereBounds.radius = 3.0f + seed;
+	modelInfo.originalFile = "content/models/model_" + std::to_string(seed) + ".gltf";
+	return modelInfo;
+}
+
+ecore::TextureInfo generate_texture_info(uint32_t seed, std::vector<uint8_t>& outData)
+{
+	outData.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+	for (size_t i = 0; i != outData.size(); ++i)
+		outData[i] = static_cast<uint8_t>(seed + i);
+
+	ecore::TextureInfo textureInfo;
+	textureInfo.data = outData.data();
+	textureInfo.size = outData.size();
+	textureInfo.width = TEXTURE_SIZE;
+	textureInfo.height = TEXTURE_SIZE;
+	textureInfo.depth = 1;
+	textureInfo.mipmapMode = seed % 2 ? ecore::texture::MipmapMode::BASE_MIPMAPPING : ecore::texture::MipmapMode::NO_MIPMAPS;
+	textureInfo.tilingX = rhi::AddressMode::CLAMP_TO_EDGE;
+	textureInfo.format = rhi::Format::R8G8B8A8_UNORM;
+	textureInfo.mapping = { rhi::ComponentSwizzle::R, rhi::ComponentSwizzle::G, rhi::ComponentSwizzle::B, rhi::ComponentSwizzle::ONE };
+	textureInfo.brightness = 0.5f + seed % 4;
+	textureInfo.saturation = 2.0f;
+	textureInfo.is16Bit = seed % 2;
+	return textureInfo;
+}
+
+// Metadata of models that were saved before binary headers
+std::string serialize_legacy_model_metadata(const ecore::ModelInfo& modelInfo, UUID uuid)
+{
+	nlohmann::json metadata;
+	metadata["uuid"] = uuid;
+	metadata["original_file"] = modelInfo.originalFile;
+	metadata["vertex_count"] = modelInfo.vertexPositions.size();
+	metadata["index_count"] = modelInfo.indices.size();
+	metadata["material_names"] = modelInfo.materialNames;
+	metadata["sphere_bounds_origin"] = modelInfo.sphereBounds.origin;
+	metadata["sphere_bounds_radius"] = modelInfo.sphereBounds.radius;
+
+	nlohmann::json meshesJson;
+	size_t meshCounter = 0;
+	for (auto& mesh : modelInfo.meshes)
+	{
+		nlohmann::json meshJson;
+		meshJson["index_count"] = mesh.indexCount;
+		meshJson["index_offset"] = mesh.indexOffset;
+		meshJson["material_index"] = mesh.materialIndex;
+		meshesJson["mesh" + std::to_string(meshCounter++)] = meshJson;
+	}
+	metadata["meshes"] = meshesJson;
+
+	uint64_t offset = modelInfo.indices.size() * sizeof(uint32_t) + modelInfo.vertexPositions.size() * sizeof(XMFLOAT3)
+		+ modelInfo.vertexNormals.size() * sizeof(XMFLOAT3) + modelInfo.vertexTangents.size() * sizeof(XMFLOAT4);
+	metadata["uv_set0_offset"] = offset;
+	offset += modelInfo.vertexUVSet0.size() * sizeof(XMFLOAT2);
+	metadata["colors_offset"] = offset;
+	return metadata.dump(4);
+}
+
+std::string serialize_legacy_texture_metadata(const ecore::TextureInfo& textureInfo, UUID uuid)
+{
+	nlohmann::json metadata;
+	metadata["uuid"] = uuid;
+	metadata["size"] = textureInfo.size;
+	metadata["width"] = textureInfo.width;
+	metadata["height"] = textureInfo.height;
+	metadata["depth"] = textureInfo.depth;
+	metadata["mipmap_mode"] = ecore::texture::Utils::get_str_mipmap_mode(textureInfo.mipmapMode);
+	metadata["compression_mode"] = ecore::texture::Utils::get_str_runtime_compression(textureInfo.runtimeCompressionMode);
+	metadata["tiling_x"] = rhi::Utils::get_address_mode_str(textureInfo.tilingX);
+	metadata["tiling_y"] = rhi::Utils::get_address_mode_str(textureInfo.tilingY);
+	metadata["format"] = rhi::Utils::get_format_str(textureInfo.format);
+	metadata["component_mapping"] = rhi::Utils::get_component_mapping_str(textureInfo.mapping);
+	metadata["brightness"] = textureInfo.brightness;
+	metadata["saturation"] = textureInfo.saturation;
+	metadata["is_16_bit"] = textureInfo.is16Bit;
+	return metadata.dump(4);
+}
+
+struct SerializedResources
+{
+	std::vector<std::unique_ptr<io::File>> binaryModels;
+	std::vector<std::unique_ptr<io::File>> jsonModels;
+	std::vector<std::unique_ptr<io::File>> binaryTextures;
+	std::vector<std::unique_ptr<io::File>> jsonTextures;
+	std::vector<ecore::ModelInfo> modelInfos;
+	std::vector<ecore::TextureInfo> textureInfos;
+	std::vector<std::vector<uint8_t>> textureData;
+};
+
+// JSON files share the blob layout with binary files, only metadata differs
+std::unique_ptr<io::File> create_json_file(io::File* binaryFile, const std::string& metadata)
+{
+	auto file = std::make_unique<io::File>();
+	uint8_t* blob = new uint8_t[binaryFile->get_binary_blob_size()];
+	memcpy(blob, binaryFile->get_binary_blob(), binaryFile->get_binary_blob_size());
+	file->set_binary_blob(blob, binaryFile->get_binary_blob_size());
+	file->set_metadata(metadata);
+	return file;
+}
+
+void serialize_resources(SerializedResources& resources)
+{
+	ecore::ObjectName name("resource");
+	resources.textureData.resize(RESOURCE_COUNT);
+	for (uint32_t i = 0; i != RESOURCE_COUNT; ++i)
+	{
+		ecore::ModelInfo& modelInfo = resources.modelInfos.emplace_back(generate_model_info(i));
+		ecore::Model model(modelInfo, &name);
+		auto& modelFile = resources.binaryModels.emplace_back(std::make_unique<io::File>());
+		model.serialize(modelFile.get());
+		resources.jsonModels.push_back(create_json_file(modelFile.get(), serialize_legacy_model_metadata(modelInfo, model.get_uuid())));
+
+		ecore::TextureInfo& textureInfo = resources.textureInfos.emplace_back(generate_texture_info(i, resources.textureData[i]));
+		// Texture takes ownership of the data
+		ecore::TextureInfo ownedTextureInfo = textureInfo;
+		ownedTextureInfo.data = new uint8_t[textureInfo.size];
+		memcpy(ownedTextureInfo.data, textureInfo.data, textureInfo.size);
+		ecore::Texture texture(ownedTextureInfo, &name);
+		auto& textureFile = resources.binaryTextures.emplace_back(std::make_unique<io::File>());
+		texture.serialize(textureFile.get());
+		resources.jsonTextures.push_back(create_json_file(textureFile.get(), serialize_legacy_texture_metadata(textureInfo, texture.get_uuid())));
+	}
+}
+
+template<typename T>
+bool is_equal(const std::vector<T>& first, const std::vector<T>& second)
+{
+	return first.size() == second.size() && !memcmp(first.data(), second.data(), first.size() * sizeof(T));
+}
+
+template<typename T>
+bool is_equal(const ConstArrayView<T>& view, const std::vector<T>& vec)
+{
+	return view.size() == vec.size() && !memcmp(view.data(), vec.data(), vec.size() * sizeof(T));
+}
+
+bool is_equal(const ecore::ModelDataView& view, const ecore::ModelInfo& modelInfo)
+{
+	return is_equal(view.indices, modelInfo.indices)
+		&& is_equal(view.vertexPositions, modelInfo.vertexPositions)
+		&& is_equal(view.vertexNormals, modelInfo.vertexNormals)
+		&& is_equal(view.vertexTangents, modelInfo.vertexTangents)
+		&& is_equal(view.vertexUVSet0, modelInfo.vertexUVSet0)
+		&& is_equal(view.vertexUVSet1, modelInfo.vertexUVSet1)
+		&& is_equal(view.vertexColors, modelInfo.vertexColors)
+		&& is_equal(view.vertexBoneIndices, modelInfo.vertexBoneIndices);
+}
+
+bool is_equal(const ecore::ModelInfo& first, const ecore::ModelInfo& second)
+{
+	if (first.meshes.size() != second.meshes.size())
+		return false;
+	for (size_t i = 0; i != first.meshes.size(); ++i)
+	{
+		const ecore::ModelInfo::Mesh& firstMesh = first.meshes[i];
+		const ecore::ModelInfo::Mesh& secondMesh = second.meshes[i];
+		if (firstMesh.indexCount != secondMesh.indexCount || firstMesh.indexOffset != secondMesh.indexOffset
+			|| firstMesh.materialIndex != secondMesh.materialIndex)
+			return false;
+	}
+
+	return is_equal(first.indices, second.indices)
+		&& is_equal(first.vertexPositions, second.vertexPositions)
+		&& is_equal(first.vertexNormals, second.vertexNormals)
+		&& is_equal(first.vertexTangents, second.vertexTangents)
+		&& is_equal(first.vertexUVSet0, second.vertexUVSet0)
+		&& is_equal(first.vertexUVSet1, second.vertexUVSet1)
+		&& is_equal(first.vertexColors, second.vertexColors)
+		&& is_equal(first.vertexBoneIndices, second.vertexBoneIndices)
+		&& first.materialNames == second.materialNames
+		&& first.originalFile == second.originalFile
+		&& !memcmp(&first.sphereBounds, &second.sphereBounds, sizeof(ecore::SphereBounds));
+}
+
+bool is_equal(const ecore::TextureInfo& first, const ecore::TextureInfo& second)
+{
+	return first.size == second.size
+		&& first.width == second.width
+		&& first.height == second.height
+		&& first.depth == second.depth
+		&& first.mipmapMode == second.mipmapMode
+		&& first.runtimeCompressionMode == second.runtimeCompressionMode
+		&& first.tilingX == second.tilingX
+		&& first.tilingY == second.tilingY
+		&& first.format == second.format
+		&& rhi::Utils::get_component_mapping_str(first.mapping) == rhi::Utils::get_component_mapping_str(second.mapping)
+		&& first.brightness == second.brightness
+		&& first.saturation == second.saturation
+		&& first.is16Bit == second.is16Bit
+		&& !memcmp(first.data, second.data, first.size);
+}
+
+// Binary and JSON files must be deserialized into the same resources
+bool validate_metadata(SerializedResources& resources)
+{
+	ecore::ObjectName name("resource");
+	for (uint32_t i = 0; i != RESOURCE_COUNT; ++i)
+	{
+		ecore::Model binaryModel, jsonModel;
+		binaryModel.deserialize(resources.binaryModels[i].get(), &name);
+		jsonModel.deserialize(resources.jsonModels[i].get(), &name);
+		if (!is_equal(binaryModel.get_info(), resources.modelInfos[i]) || !is_equal(jsonModel.get_info(), resources.modelInfos[i])
+			|| binaryModel.get_uuid() != jsonModel.get_uuid())
+		{
+			LOG_ERROR("Model {} is deserialized incorrectly", i)
+			return false;
+		}
+
+		ecore::Texture binaryTexture, jsonTexture;
+		binaryTexture.deserialize(resources.binaryTextures[i].get(), &name);
+		jsonTexture.deserialize(resources.jsonTextures[i].get(), &name);
+		if (!is_equal(binaryTexture.get_info(), resources.textureInfos[i]) || !is_equal(jsonTexture.get_info(), resources.textureInfos[i])
+			|| binaryTexture.get_uuid() != jsonTexture.get_uuid())
+		{
+			LOG_ERROR("Texture {} is deserialized incorrectly", i)
+			return false;
+		}
+	}
+
+	// Metadata of a newer version must be rejected instead of being read with a wrong layout
+	std::string futureMetadata = resources.binaryTextures[0]->get_metadata();
+	uint16_t futureVersion = 1000;
+	memcpy(futureMetadata.data() + sizeof(uint32_t), &futureVersion, sizeof(uint16_t));
+	io::File futureFile;
+	futureFile.set_metadata(futureMetadata);
+	uint8_t* blob = new uint8_t[1];
+	futureFile.set_binary_blob(blob, 1);
+	ecore::Texture futureTexture;
+	futureTexture.deserialize(&futureFile, &name);
+	if (futureTexture.get_info().data)
+	{
+		LOG_ERROR("Texture with unsupported metadata version is deserialized")
+		return false;
+	}
+
+	return true;
+}
+
+// Files are read from serialized data like in ResourceTable, so the blob is allocated and tracked by the file
+std::unique_ptr<io::File> read_file(io::File* file, bool areBlobViewsEnabled)
+{
+	uint8_t* data = nullptr;
+	uint64_t size = 0;
+	file->serialize(data, size);
+	auto readFile = std::make_unique<io::File>();
+	readFile->set_blob_views_enabled(areBlobViewsEnabled);
+	readFile->deserialize(data, size);
+	delete[] data;
+	return readFile;
+}
+
+// Views must stay valid after the file is destroyed and resources with views must be saved like other resources
+bool validate_blob_views(SerializedResources& resources)
+{
+	ecore::ObjectName name("resource");
+	for (uint32_t i = 0; i != RESOURCE_COUNT; i += RESOURCE_COUNT / 100)
+	{
+		ecore::Model model;
+		std::unique_ptr<io::File> modelFile = read_file(resources.binaryModels[i].get(), true);
+		const uint8_t* modelBlob = modelFile->get_binary_blob();
+		model.deserialize(modelFile.get(), &name);
+		modelFile.reset();
+		if (!model.has_blob_views() || !is_equal(model.copy_info(), resources.modelInfos[i])
+			|| reinterpret_cast<const uint8_t*>(model.get_data_view().indices.data()) != modelBlob
+			|| !is_equal(model.get_data_view(), resources.modelInfos[i]))
+		{
+			LOG_ERROR("Model {} with blob views is invalid", i)
+			return false;
+		}
+
+		io::File resavedModelFile;
+		model.serialize(&resavedModelFile);
+		ecore::Model resavedModel;
+		resavedModel.deserialize(&resavedModelFile, &name);
+		if (resavedModel.has_blob_views() || !is_equal(resavedModel.get_info(), resources.modelInfos[i])
+			|| !is_equal(resavedModel.get_data_view(), resources.modelInfos[i]))
+		{
+			LOG_ERROR("Model {} with blob views is saved incorrectly", i)
+			return false;
+		}
+
+		ecore::Texture texture;
+		std::unique_ptr<io::File> textureFile = read_file(resources.binaryTextures[i].get(), true);
+		const uint8_t* textureBlob = textureFile->get_binary_blob();
+		texture.deserialize(textureFile.get(), &name);
+		textureFile.reset();
+		if (!texture.has_blob_view() || texture.get_info().data != textureBlob || !is_equal(texture.get_info(), resources.textureInfos[i]))
+		{
+			LOG_ERROR("Texture {} with blob view is invalid", i)
+			return false;
+		}
+	}
+	return true;
+}
+
+ecore::ModelInfo generate_large_model_info(uint32_t seed)
+{
+	ecore::ModelInfo modelInfo;
+	modelInfo.vertexPositions.resize(LARGE_VERTEX_COUNT, { static_cast<float>(seed), 1.0f, 2.0f });
+	modelInfo.vertexNormals.resize(LARGE_VERTEX_COUNT, { 0.0f, 1.0f, 0.0f });
+	modelInfo.vertexTangents.resize(LARGE_VERTEX_COUNT, { 1.0f, 0.0f, 0.0f, 1.0f });
+	modelInfo.vertexUVSet0.resize(LARGE_VERTEX_COUNT, { 0.5f, 0.5f });
+	modelInfo.indices.resize(LARGE_VERTEX_COUNT * 3 / 2);
+	for (size_t i = 0; i != modelInfo.indices.size(); ++i)
+		modelInfo.indices[i] = (seed + i) % LARGE_VERTEX_COUNT;
+	modelInfo.meshes.push_back({ static_cast<uint32_t>(modelInfo.indices.size()), 0, 0 });
+	modelInfo.materialNames.push_back("material");
+	return modelInfo;
+}
+
+// Decompression is included in the time, because the blob is decompressed in both cases. Only textures
+// record their data in MemoryTracker, vectors of models are not tracked
+template<typename Resource>
+void benchmark_blob_views(const char* name, const std::vector<std::unique_ptr<io::File>>& files, bool areBlobViewsEnabled)
+{
+	MemoryTrackerInstance memoryTrackerInstance;
+	MemoryTracker::init(&memoryTrackerInstance);
+
+	std::vector<std::vector<uint8_t>> serializedFiles;
+	for (auto& file : files)
+	{
+		uint8_t* data = nullptr;
+		uint64_t size = 0;
+		file->serialize(data, size);
+		serializedFiles.emplace_back(data, data + size);
+		delete[] data;
+	}
+
+	ecore::ObjectName objectName("resource");
+	std::vector<Resource> resources(files.size());
+	Timer timer;
+	for (size_t i = 0; i != files.size(); ++i)
+	{
+		io::File file;
+		file.set_blob_views_enabled(areBlobViewsEnabled);
+		file.deserialize(serializedFiles[i].data(), serializedFiles[i].size());
+		resources[i].deserialize(&file, &objectName);
+	}
+	double elapsed = timer.elapsed_milliseconds();
+
+	MemoryTagStats stats = MemoryTracker::get_stats(MemoryTag::RESOURCES);
+	LOG_INFO("{}, blob views {}: {} resources in {} ms, tracked live {} MiB, tracked peak {} MiB",
+		name,
+		areBlobViewsEnabled ? "enabled" : "disabled",
+		files.size(),
+		elapsed,
+		stats.liveBytes / (1024 * 1024),
+		stats.peakBytes / (1024 * 1024))
+
+	resources.clear();
+	MemoryTracker::init(nullptr);
+}
+
+template<typename Resource>
+void benchmark_deserialization(const char* name, const std::vector<std::unique_ptr<io::File>>& files)
+{
+	ecore::ObjectName objectName("resource");
+	uint64_t metadataSize = 0;
+	for (auto& file : files)
+		metadataSize += file->get_metadata().size();
+
+	std::vector<Resource> resources(files.size());
+	Timer timer;
+	for (size_t i = 0; i != files.size(); ++i)
+		resources[i].deserialize(files[i].get(), &objectName);
+	double elapsed = timer.elapsed_milliseconds();
+
+	LOG_INFO("{}: {} resources in {} ms, {} us per resource, {} bytes of metadata per resource",
+		name,
+		files.size(),
+		elapsed,
+		elapsed * 1000.0 / files.size(),
+		metadataSize / files.size())
+}
+
+int main()
+{
+	SerializedResources resources;
+	serialize_resources(resources);
+
+	if (!validate_metadata(resources))
+	{
+		LOG_ERROR("Resource metadata is invalid")
+		return 1;
+	}
+	LOG_INFO("Resource metadata is valid")
+
+	benchmark_deserialization<ecore::Model>("Models, JSON metadata", resources.jsonModels);
+	benchmark_deserialization<ecore::Model>("Models, binary metadata", resources.binaryModels);
+	benchmark_deserialization<ecore::Texture>("Textures, JSON metadata", resources.jsonTextures);
+	benchmark_deserialization<ecore::Texture>("Textures, binary metadata", resources.binaryTextures);
+
+	if (!validate_blob_views(resources))
+	{
+		LOG_ERROR("Blob views are invalid")
+		return 1;
+	}
+	LOG_INFO("Blob views are valid")
+
+	ecore::ObjectName name("resource");
+	std::vector<std::unique_ptr<io::File>> largeModels;
+	std::vector<std::unique_ptr<io::File>> largeTextures;
+	for (uint32_t i = 0; i != LARGE_RESOURCE_COUNT; ++i)
+	{
+		ecore::Model model(generate_large_model_info(i), &name);
+		model.serialize(largeModels.emplace_back(std::make_unique<io::File>()).get());
+
+		ecore::TextureInfo textureInfo;
+		textureInfo.size = LARGE_TEXTURE_SIZE * LARGE_TEXTURE_SIZE * 4;
+		textureInfo.data = new uint8_t[textureInfo.size];
+		for (uint64_t j = 0; j != textureInfo.size; ++j)
+			textureInfo.data[j] = static_cast<uint8_t>((j / 64) * (i + 1));
+		textureInfo.width = LARGE_TEXTURE_SIZE;
+		textureInfo.height = LARGE_TEXTURE_SIZE;
+		textureInfo.depth = 1;
+		textureInfo.format = rhi::Format::R8G8B8A8_UNORM;
+		ecore::Texture texture(textureInfo, &name);
+		texture.serialize(largeTextures.emplace_back(std::make_unique<io::File>()).get());
+	}
+
+	for (bool areBlobViewsEnabled : { false, true })
+	{
+		benchmark_blob_views<ecore::Model>("Large models", largeModels, areBlobViewsEnabled);
+		benchmark_blob_views<ecore::Texture>("Large textures", largeTextures, areBlobViewsEnabled);
+	}
+	return 0;
+}
@@ -0,0 +1,546 @@
+#include "resource_manager/module/resource_table.h"
+#include "engine_core/texture/texture.h"
+#include "file_system/IO.h"
+#include "core/global_objects.h"
+#include "profiler/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+using namespace resource::impl;
+
+constexpr uint32_t TEXTURE_COUNT = 64;
+constexpr uint64_t TEXTURE_SIZE = 16 * 1024;
+constexpr uint32_t THREAD_COUNT = 4;
+constexpr uint32_t CRITICAL_LOAD_COUNT = 8;
+constexpr uint32_t RESIDENT_TEXTURE_COUNT = 4;
+
+// Data of each texture is filled with its index, so loaded textures can be told apart
+std::vector<UUID> create_textures(ResourceTable& table, const std::string& prefix, uint32_t count)
+{
+	std::vector<UUID> uuids;
+	for (uint32_t i = 0; i != count; ++i)
+	{
+		ecore::TextureInfo info;
+		info.size = TEXTURE_SIZE;
+		info.width = 128;
+		info.height = 128;
+		info.depth = 1;
+		info.format = rhi::Format::R8_UNORM;
+		info.data = new uint8_t[TEXTURE_SIZE];
+		memset(info.data, static_cast<uint8_t>(i + 1), TEXTURE_SIZE);
+
+		std::string name = prefix + std::to_string(i);
+		ResourceDesc resourceDesc;
+		resourceDesc.path = FILE_SYSTEM()->get_project_root_path() + "/" + name + ".aares";
+		resourceDesc.type = resource::ResourceType::TEXTURE;
+		resourceDesc.resourceName = table.allocate_resource_name(name);
+		resourceDesc.resource = table.get_resource_pool()->allocate<ecore::Texture>(info, resourceDesc.resourceName);
+		if (!ResourceTable::write_resource(resourceDesc))
+			return {};
+		table.add_resource(resourceDesc);
+
+		// Textures are loaded from their files by tests
+		uuids.push_back(resourceDesc.resource->get_uuid());
+		table.unload_resource(uuids.back());
+	}
+	return uuids;
+}
+
+bool is_texture_valid(const ecore::Texture* texture, uint32_t index)
+{
+	if (!texture || texture->get_info().size != TEXTURE_SIZE || !texture->get_info().data)
+		return false;
+	const uint8_t* data = texture->get_info().data;
+	return std::all_of(data, data + TEXTURE_SIZE, [index](uint8_t value) { return value == static_cast<uint8_t>(index + 1); });
+}
+
+uint64_t get_texture_load_count(const ResourceTable& table)
+{
+	return table.get_residency_usage(resource::ResourceType::TEXTURE).loadCount;
+}
+
+bool validate_async_load(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	uint32_t loadedEventCount = 0;
+	events::EventDelegate<resource::ResourceLoadedEvent<ecore::Texture>> delegate = [&](resource::ResourceLoadedEvent<ecore::Texture>&)
+	{
+		++loadedEventCount;
+	};
+	EVENT_MANAGER()->subscribe(delegate);
+
+	std::vector<resource::ResourceLoadHandle<ecore::Texture>> handles;
+	for (UUID uuid : uuids)
+		handles.push_back(table.load_resource_async<ecore::Texture>(uuid, resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::NORMAL));
+
+	bool isValid = true;
+	for (uint32_t i = 0; i != handles.size(); ++i)
+	{
+		resource::ResourceAccessor<ecore::Texture> accessor = handles[i].wait();
+		isValid &= handles[i].get_status() == resource::ResourceLoadStatus::LOADED && accessor.is_valid()
+			&& is_texture_valid(accessor.get_resource(), i) && table.is_resource_loaded(uuids[i]);
+	}
+
+	// Loaded events are enqueued from TaskComposer threads
+	EVENT_MANAGER()->dispatch_events();
+	EVENT_MANAGER()->unsubscribe(resource::ResourceLoadedEvent<ecore::Texture>::get_type_id_static(), delegate.target_type().name());
+	return isValid && loadedEventCount == uuids.size();
+}
+
+bool validate_load_deduplication(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	for (UUID uuid : uuids)
+		table.unload_resource(uuid);
+	uint64_t loadCount = get_texture_load_count(table);
+
+	// Threads request the same resources asynchronously and synchronously, each resource is read once
+	std::vector<std::vector<ecore::Texture*>> texturesByThread(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t threadIndex = 0; threadIndex != THREAD_COUNT; ++threadIndex)
+	{
+		threads.emplace_back([&, threadIndex]()
+		{
+			std::vector<ecore::Texture*>& textures = texturesByThread[threadIndex];
+			if (threadIndex % 2)
+			{
+				for (UUID uuid : uuids)
+					textures.push_back(table.load_resource<ecore::Texture>(uuid, resource::ResourceType::TEXTURE));
+				return;
+			}
+
+			std::vector<resource::ResourceLoadHandle<ecore::Texture>> handles;
+			for (UUID uuid : uuids)
+				handles.push_back(table.load_resource_async<ecore::Texture>(uuid, resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::HIGH));
+			for (auto& handle : handles)
+				textures.push_back(handle.wait().get_resource());
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	for (uint32_t i = 0; i != uuids.size(); ++i)
+	{
+		ecore::Texture* texture = texturesByThread[0][i];
+		if (!is_texture_valid(texture, i))
+			return false;
+		for (auto& textures : texturesByThread)
+		{
+			if (textures[i] != texture)
+				return false;
+		}
+	}
+	return get_texture_load_count(table) == loadCount + uuids.size();
+}
+
+bool validate_load_cancellation(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	for (UUID uuid : uuids)
+		table.unload_resource(uuid);
+
+	// The load continues while other requesters wait for it
+	auto firstHandle = table.load_resource_async<ecore::Texture>(uuids[0], resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::LOW);
+	auto secondHandle = table.load_resource_async<ecore::Texture>(uuids[0], resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::LOW);
+	firstHandle.cancel();
+	if (firstHandle.is_valid() || !is_texture_valid(secondHandle.wait().get_resource(), 0)
+		|| secondHandle.get_status() != resource::ResourceLoadStatus::LOADED)
+		return false;
+
+	// Loads that have been canceled before their files were read don't make resources resident
+	std::vector<resource::ResourceLoadHandle<ecore::Texture>> handles;
+	for (uint32_t i = 1; i != uuids.size(); ++i)
+	{
+		auto handle = table.load_resource_async<ecore::Texture>(uuids[i], resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::LOW);
+		handles.push_back(handle);
+		handle.cancel();
+	}
+	table.wait_for_loads();
+
+	uint32_t canceledCount = 0;
+	for (uint32_t i = 1; i != uuids.size(); ++i)
+	{
+		const auto& handle = handles[i - 1];
+		bool isLoaded = table.is_resource_loaded(uuids[i]);
+		if (handle.get_status() == resource::ResourceLoadStatus::CANCELED)
+		{
+			++canceledCount;
+			if (isLoaded || handle.wait().is_valid())
+				return false;
+		}
+		else if (handle.get_status() != resource::ResourceLoadStatus::LOADED || !isLoaded)
+		{
+			return false;
+		}
+
+		// Canceled resources can be loaded again
+		if (!is_texture_valid(table.load_resource<ecore::Texture>(uuids[i], resource::ResourceType::TEXTURE), i))
+			return false;
+	}
+	LOG_INFO("{} of {} loads were canceled before their files were read", canceledCount, uuids.size() - 1)
+	return true;
+}
+
+// One IO request is issued at a time and continuations are executed by one thread, so loaded events are enqueued
+// in the order of reads. The main thread doesn't wait through TaskComposer, otherwise it would execute continuations too
+bool validate_load_priorities(GlobalObjectContext& context, ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	for (UUID uuid : uuids)
+		table.unload_resource(uuid);
+	// Events of previous loads must not be recorded
+	EVENT_MANAGER()->dispatch_events();
+
+	context.asyncIOService.reset();
+	context.taskComposer = std::make_unique<tasks::TaskComposer>(1);
+	io::AsyncIOSettings settings;
+	settings.queueDepth = 1;
+	settings.workerThreadCount = 1;
+	settings.isIOUringEnabled = false;
+	context.asyncIOService = std::make_unique<io::AsyncIOService>(FILE_SYSTEM(), TASK_COMPOSER(), settings);
+
+	std::vector<UUID> loadOrder;
+	events::EventDelegate<resource::ResourceLoadedEvent<ecore::Texture>> delegate = [&](resource::ResourceLoadedEvent<ecore::Texture>& event)
+	{
+		loadOrder.push_back(event.get_resource().get_resource()->get_uuid());
+	};
+	EVENT_MANAGER()->subscribe(delegate);
+
+	std::vector<resource::ResourceLoadHandle<ecore::Texture>> handles;
+	uint32_t lowLoadCount = uuids.size() - CRITICAL_LOAD_COUNT;
+	for (uint32_t i = 0; i != uuids.size(); ++i)
+	{
+		resource::ResourceLoadPriority priority = i < lowLoadCount ? resource::ResourceLoadPriority::LOW : resource::ResourceLoadPriority::CRITICAL;
+		handles.push_back(table.load_resource_async<ecore::Texture>(uuids[i], resource::ResourceType::TEXTURE, priority));
+	}
+	for (auto& handle : handles)
+	{
+		while (!handle.is_finished())
+			std::this_thread::yield();
+	}
+	EVENT_MANAGER()->dispatch_events();
+	EVENT_MANAGER()->unsubscribe(resource::ResourceLoadedEvent<ecore::Texture>::get_type_id_static(), delegate.target_type().name());
+
+	context.asyncIOService.reset();
+	context.taskComposer = std::make_unique<tasks::TaskComposer>();
+	context.asyncIOService = std::make_unique<io::AsyncIOService>(FILE_SYSTEM(), TASK_COMPOSER());
+
+	// Low priority loads that were issued before critical loads were requested complete first,
+	// most of the low priority loads must complete after all critical ones
+	uint32_t lastCriticalPosition = 0;
+	for (uint32_t i = 0; i != loadOrder.size(); ++i)
+	{
+		if (std::find(uuids.begin() + lowLoadCount, uuids.end(), loadOrder[i]) != uuids.end())
+			lastCriticalPosition = i;
+	}
+	uint32_t lowLoadsAfterCritical = loadOrder.size() - lastCriticalPosition - 1;
+	LOG_INFO("{} of {} low priority loads completed after critical loads", lowLoadsAfterCritical, lowLoadCount)
+	return loadOrder.size() == uuids.size() && lowLoadsAfterCritical >= lowLoadCount / 2;
+}
+
+// Only dirty resources are written, files of other resources are removed to detect writes
+bool validate_dirty_saving(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	std::vector<ecore::Texture*> textures;
+	for (UUID uuid : uuids)
+	{
+		textures.push_back(table.load_resource<ecore::Texture>(uuid, resource::ResourceType::TEXTURE));
+		std::filesystem::remove(table.get_resource_desc(uuid)->path.c_str());
+	}
+	// Recreated resources get new infos, which marks them dirty
+	for (uint32_t i = 0; i < textures.size(); i += 8)
+		textures[i]->set_info(textures[i]->get_info());
+	table.save_resources();
+
+	bool isValid = true;
+	for (uint32_t i = 0; i != uuids.size(); ++i)
+	{
+		bool isSaved = std::filesystem::exists(table.get_resource_desc(uuids[i])->path.c_str());
+		isValid &= isSaved == (i % 8 == 0) && !textures[i]->is_dirty();
+		// Files are restored for other tests
+		if (!isSaved)
+			table.save_resource(uuids[i]);
+	}
+	return isValid;
+}
+
+bool is_resident(const ResourceTable& table, const std::vector<UUID>& uuids, std::initializer_list<uint32_t> indices)
+{
+	return std::all_of(indices.begin(), indices.end(), [&](uint32_t index) { return table.is_resource_loaded(uuids[index]); });
+}
+
+bool is_evicted(const ResourceTable& table, const std::vector<UUID>& uuids, std::initializer_list<uint32_t> indices)
+{
+	return std::none_of(indices.begin(), indices.end(), [&](uint32_t index) { return table.is_resource_loaded(uuids[index]); });
+}
+
+bool validate_reference_counting(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	for (UUID uuid : uuids)
+		table.unload_resource(uuid);
+	table.set_memory_budget(resource::ResourceType::TEXTURE, RESIDENT_TEXTURE_COUNT * TEXTURE_SIZE);
+
+	ecore::Texture* texture = table.acquire_resource<ecore::Texture>(uuids[0], resource::ResourceType::TEXTURE);
+	if (!is_texture_valid(texture, 0) || table.acquire_resource<ecore::Texture>(uuids[0], resource::ResourceType::TEXTURE) != texture
+		|| table.get_residency_usage(resource::ResourceType::TEXTURE).referencedCount != 1)
+		return false;
+
+	// The resource stays referenced until each acquisition is released
+	table.release_reference(uuids[0]);
+	table.unload_resource(uuids[0]);
+	if (!table.is_resource_loaded(uuids[0]) || table.get_residency_usage(resource::ResourceType::TEXTURE).referencedCount != 1)
+		return false;
+	table.release_reference(uuids[0]);
+	table.unload_resource(uuids[0]);
+	return !table.is_resource_loaded(uuids[0]) && table.get_residency_usage(resource::ResourceType::TEXTURE).referencedCount == 0;
+}
+
+// The texture budget fits RESIDENT_TEXTURE_COUNT textures. Unreferenced textures are evicted in least recently used order,
+// referenced and dirty textures stay resident
+bool validate_eviction(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	auto load_texture = [&](uint32_t index)
+	{
+		return table.load_resource<ecore::Texture>(uuids[index], resource::ResourceType::TEXTURE);
+	};
+	uint64_t evictionCount = table.get_residency_usage(resource::ResourceType::TEXTURE).evictionCount;
+
+	for (uint32_t i = 0; i != RESIDENT_TEXTURE_COUNT; ++i)
+		load_texture(i);
+	// Loading a resident texture makes it the most recently used one
+	load_texture(0);
+	load_texture(4);
+	if (!is_evicted(table, uuids, { 1 }) || !is_resident(table, uuids, { 0, 2, 3, 4 }))
+		return false;
+
+	table.acquire_resource<ecore::Texture>(uuids[2], resource::ResourceType::TEXTURE);
+	load_texture(5);
+	if (!is_evicted(table, uuids, { 3 }) || !is_resident(table, uuids, { 0, 2, 4, 5 }))
+		return false;
+
+	load_texture(0)->make_dirty();
+	for (uint32_t i = 6; i != 9; ++i)
+		load_texture(i);
+	if (!is_evicted(table, uuids, { 4, 5, 6 }) || !is_resident(table, uuids, { 0, 2, 7, 8 }))
+		return false;
+
+	// The saved texture is no longer dirty and is evicted after textures that were used before it
+	table.save_resource(uuids[0]);
+	for (uint32_t i = 9; i != 12; ++i)
+		load_texture(i);
+	if (!is_evicted(table, uuids, { 0, 7, 8 }) || !is_resident(table, uuids, { 2, 9, 10, 11 }))
+		return false;
+
+	auto usage = table.get_residency_usage(resource::ResourceType::TEXTURE);
+	return usage.residentCount == RESIDENT_TEXTURE_COUNT && usage.residentSize == usage.budget
+		&& usage.evictionCount == evictionCount + 8 && usage.referencedCount == 1;
+}
+
+// Budgets of other types don't evict textures
+bool validate_per_type_budget(ResourceTable& table)
+{
+	auto usage = table.get_residency_usage(resource::ResourceType::TEXTURE);
+	table.set_memory_budget(resource::ResourceType::MODEL, 1);
+	auto newUsage = table.get_residency_usage(resource::ResourceType::TEXTURE);
+	bool isValid = table.get_memory_budget(resource::ResourceType::MODEL) == 1
+		&& table.get_memory_budget(resource::ResourceType::TEXTURE) == RESIDENT_TEXTURE_COUNT * TEXTURE_SIZE
+		&& newUsage.residentCount == usage.residentCount && newUsage.evictionCount == usage.evictionCount;
+	table.set_memory_budget(resource::ResourceType::MODEL, 0);
+	return isValid;
+}
+
+// Reads a new texture with the UUID of the resource from its file
+ecore::Texture* read_texture(ResourceTable& table, const ResourceDesc& resourceDesc)
+{
+	io::MappedFile mappedFile = FILE_SYSTEM()->map_file(resourceDesc.path, io::MapAccess::SEQUENTIAL);
+	io::File file(resourceDesc.path);
+	if (!mappedFile.is_valid() || !file.deserialize(mappedFile.data(), mappedFile.size()))
+		return nullptr;
+	ecore::Texture* texture = table.get_resource_pool()->allocate<ecore::Texture>();
+	texture->deserialize(&file, resourceDesc.resourceName);
+	return texture;
+}
+
+// Texture 2 is referenced by validate_eviction(), a texture with its UUID must not replace it until the reference is released
+bool validate_replacement(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	ResourceDesc resourceDesc = *table.get_resource_desc(uuids[2]);
+	ecore::Texture* texture = static_cast<ecore::Texture*>(resourceDesc.resource);
+	ecore::Texture* newTexture = read_texture(table, resourceDesc);
+	if (!newTexture)
+		return false;
+	resourceDesc.resource = newTexture;
+
+	if (table.add_resource(resourceDesc))
+		return false;
+	bool isValid = table.load_resource<ecore::Texture>(uuids[2], resource::ResourceType::TEXTURE) == texture;
+
+	table.release_reference(uuids[2]);
+	if (!table.add_resource(resourceDesc))
+	{
+		table.get_resource_pool()->free(newTexture);
+		return false;
+	}
+	return isValid && table.load_resource<ecore::Texture>(uuids[2], resource::ResourceType::TEXTURE) == newTexture
+		&& is_texture_valid(newTexture, 2) && table.get_residency_usage(resource::ResourceType::TEXTURE).referencedCount == 0;
+}
+
+// Resources can be added while their files are read by asynchronous loads, loads finish with the added resources
+bool validate_add_during_load(ResourceTable& table, const std::vector<UUID>& uuids)
+{
+	table.set_memory_budget(resource::ResourceType::TEXTURE, 0);
+	for (UUID uuid : uuids)
+		table.unload_resource(uuid);
+
+	std::vector<resource::ResourceLoadHandle<ecore::Texture>> handles;
+	std::vector<ecore::Texture*> addedTextures;
+	for (UUID uuid : uuids)
+	{
+		ResourceDesc resourceDesc = *table.get_resource_desc(uuid);
+		resourceDesc.resource = read_texture(table, resourceDesc);
+		if (!resourceDesc.resource)
+			return false;
+		handles.push_back(table.load_resource_async<ecore::Texture>(uuid, resource::ResourceType::TEXTURE, resource::ResourceLoadPriority::NORMAL));
+		table.add_resource(resourceDesc);
+		addedTextures.push_back(static_cast<ecore::Texture*>(resourceDesc.resource));
+	}
+
+	// Loads that finished before their textures were added returned textures that have been replaced since
+	bool isValid = true;
+	uint32_t joinedCount = 0;
+	for (uint32_t i = 0; i != uuids.size(); ++i)
+	{
+		joinedCount += handles[i].wait().get_resource() == addedTextures[i];
+		isValid &= handles[i].get_status() == resource::ResourceLoadStatus::LOADED && is_texture_valid(addedTextures[i], i)
+			&& table.load_resource<ecore::Texture>(uuids[i], resource::ResourceType::TEXTURE) == addedTextures[i];
+	}
+	LOG_INFO("{} of {} loads finished with textures that were added while their files were read", joinedCount, uuids.size())
+	auto usage = table.get_residency_usage(resource::ResourceType::TEXTURE);
+	isValid &= usage.residentCount == uuids.size() && usage.residentSize == uuids.size() * TEXTURE_SIZE;
+
+	// Each resident texture must be in the eviction order once
+	table.set_memory_budget(resource::ResourceType::TEXTURE, TEXTURE_SIZE);
+	usage = table.get_residency_usage(resource::ResourceType::TEXTURE);
+	table.set_memory_budget(resource::ResourceType::TEXTURE, 0);
+	return isValid && usage.residentCount == 1 && usage.residentSize == TEXTURE_SIZE;
+}
+
+int main()
+{
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "ad_astris_resource_table_tasks";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "configs");
+
+	GlobalObjectContext context;
+	GlobalObjects::set_global_object_context(&context);
+	context.fileSystem = std::make_unique<io::EngineFileSystem>(directory.string().c_str());
+	context.fileSystem->set_project_root_path(directory.string());
+	context.taskComposer = std::make_unique<tasks::TaskComposer>();
+	context.asyncIOService = std::make_unique<io::AsyncIOService>(FILE_SYSTEM(), TASK_COMPOSER());
+	context.eventManager = std::make_unique<events::EventManager>();
+
+	ResourcePool resourcePool;
+	ResourceTable table(&resourcePool);
+	std::vector<UUID> uuids = create_textures(table, "texture_", TEXTURE_COUNT);
+	if (uuids.size() != TEXTURE_COUNT)
+	{
+		LOG_ERROR("Failed to create textures")
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+
+	if (!validate_async_load(table, uuids))
+	{
+		LOG_ERROR("Asynchronous resource loading is invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Asynchronous resource loading is valid")
+
+	if (!validate_load_deduplication(table, uuids))
+	{
+		LOG_ERROR("Concurrent loads of the same resource are not deduplicated")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Deduplication of resource loads is valid")
+
+	if (!validate_load_cancellation(table, uuids))
+	{
+		LOG_ERROR("Cancellation of resource loads is invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Cancellation of resource loads is valid")
+
+	if (!validate_load_priorities(context, table, uuids))
+	{
+		LOG_ERROR("Priorities of resource loads are invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Priorities of resource loads are valid")
+
+	if (!validate_dirty_saving(table, uuids))
+	{
+		LOG_ERROR("Saving of dirty resources is invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Only dirty resources are saved")
+
+	if (!validate_reference_counting(table, uuids))
+	{
+		LOG_ERROR("Reference counting of resources is invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Reference counting of resources is valid")
+
+	if (!validate_eviction(table, uuids))
+	{
+		LOG_ERROR("Eviction of resources over the budget is invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Eviction of resources over the budget is valid")
+
+	if (!validate_per_type_budget(table))
+	{
+		LOG_ERROR("Budgets of resource types are not independent")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Budgets of resource types are valid")
+
+	if (!validate_replacement(table, uuids))
+	{
+		LOG_ERROR("Referenced resources are replaced")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Replacement of resident resources is valid")
+
+	if (!validate_add_during_load(table, uuids))
+	{
+		LOG_ERROR("Resources added during their loads are invalid")
+		table.wait_for_loads();
+		std::filesystem::remove_all(directory);
+		return 1;
+	}
+	LOG_INFO("Resources added during their loads are valid")
+
+	table.wait_for_loads();
+	std::filesystem::remove_all(directory);
+	return 0;
+}
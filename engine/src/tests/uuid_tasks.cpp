@@ -0,0 +1,133 @@
+#include "engine_core/uuid.h"
+#include "core/timer.h"
+#include "profiler/logger.h"
+
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ad_astris;
+
+constexpr uint32_t UUID_COUNT = 4000000;
+constexpr uint32_t THREAD_COUNT = 8;
+
+bool validate_uniqueness()
+{
+	std::vector<std::vector<UUID>> uuidsByThread(THREAD_COUNT);
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&uuids = uuidsByThread[i], i]()
+		{
+			uint32_t count = UUID_COUNT / THREAD_COUNT;
+			uuids.reserve(count);
+			// Half of the threads use bulk generation to check that both paths share streams correctly
+			if (i % 2)
+			{
+				uuids.resize(count, UUID(0));
+				UUIDGenerator::generate(uuids.data(), count);
+			}
+			else
+			{
+				for (uint32_t j = 0; j != count; ++j)
+					uuids.emplace_back();
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	std::vector<uint64_t> allUUIDs;
+	allUUIDs.reserve(UUID_COUNT);
+	for (auto& uuids : uuidsByThread)
+	{
+		for (auto& uuid : uuids)
+		{
+			if (!uuid)
+				return false;
+			allUUIDs.push_back(uuid);
+		}
+	}
+
+	std::sort(allUUIDs.begin(), allUUIDs.end());
+	return std::adjacent_find(allUUIDs.begin(), allUUIDs.end()) == allUUIDs.end();
+}
+
+// Previous implementation, the mutex is required to make it thread-safe
+uint64_t generate_locked_mt19937_uuid()
+{
+	static std::mutex mutex;
+	static std::mt19937_64 randomEngine(std::random_device{}());
+	static std::uniform_int_distribution<uint64_t> uniformDistribution;
+
+	std::scoped_lock<std::mutex> locker(mutex);
+	uint64_t uuid = uniformDistribution(randomEngine);
+	return uuid ? uuid : uniformDistribution(randomEngine);
+}
+
+template<typename Func>
+double run_multithreaded(Func&& func)
+{
+	Timer timer;
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i != THREAD_COUNT; ++i)
+		threads.emplace_back(func);
+	for (auto& thread : threads)
+		thread.join();
+	return timer.elapsed_milliseconds();
+}
+
+void run_benchmark()
+{
+	std::vector<UUID> uuids(UUID_COUNT, UUID(0));
+	uint64_t checksum = 0;
+
+	Timer timer;
+	for (auto& uuid : uuids)
+		uuid = generate_locked_mt19937_uuid();
+	LOG_INFO("Locked mt19937_64: {} ms", timer.elapsed_milliseconds())
+
+	timer.record();
+	for (auto& uuid : uuids)
+		uuid = UUID();
+	LOG_INFO("UUID(): {} ms", timer.elapsed_milliseconds())
+
+	timer.record();
+	UUIDGenerator::generate(uuids.data(), uuids.size());
+	LOG_INFO("Bulk generation: {} ms", timer.elapsed_milliseconds())
+
+	for (auto& uuid : uuids)
+		checksum ^= uuid;
+
+	double lockedTime = run_multithreaded([]()
+	{
+		for (uint32_t i = 0; i != UUID_COUNT / THREAD_COUNT; ++i)
+			generate_locked_mt19937_uuid();
+	});
+	double perThreadTime = run_multithreaded([]()
+	{
+		uint64_t threadChecksum = 0;
+		for (uint32_t i = 0; i != UUID_COUNT / THREAD_COUNT; ++i)
+			threadChecksum ^= UUID();
+		if (!threadChecksum)
+		{
+			LOG_ERROR("Invalid checksum")
+		}
+	});
+	LOG_INFO("{} threads: locked mt19937_64 {} ms, UUID() {} ms, checksum {}", THREAD_COUNT, lockedTime, perThreadTime, checksum)
+}
+
+int main()
+{
+	if (!validate_uniqueness())
+	{
+		LOG_ERROR("Generated UUIDs are not unique")
+		return 1;
+	}
+	LOG_INFO("{} UUIDs generated from {} threads are unique", UUID_COUNT, THREAD_COUNT)
+
+	run_benchmark();
+	return 0;
+}
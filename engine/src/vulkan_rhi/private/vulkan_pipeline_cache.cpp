@@ -7,30 +7,24 @@ using namespace ad_astris::vulkan;
 
 void VulkanPipelineCache::load_pipeline_cache(VulkanDevice* device)
 {
-	size_t size = 0;
-	void* data = nullptr;
+	io::MappedFile mappedFile;
 	
 	if (io::Utils::exists(FILE_SYSTEM()->get_project_root_path(), "intermediate/pipeline_cache.bin"))
 	{
-		data = FILE_SYSTEM()->map_to_read(FILE_SYSTEM()->get_project_root_path() + "/intermediate/pipeline_cache.bin", size);
-		if (!is_loaded_cache_valid(device, static_cast<uint8_t*>(data)))
+		mappedFile = FILE_SYSTEM()->map_file(FILE_SYSTEM()->get_project_root_path() + "/intermediate/pipeline_cache.bin", io::MapAccess::SEQUENTIAL);
+		if (mappedFile.is_valid() && !is_loaded_cache_valid(device, mappedFile.data()))
 		{
 			LOG_WARNING("VulkanPipelineCache::load_pipeline_cache(): Pipeline cache is invalid")
-			FILE_SYSTEM()->unmap_after_reading(data);
-			data = nullptr;
-			size = 0;
+			mappedFile.unmap();
 		}
 	}
 
 	VkPipelineCacheCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-	createInfo.initialDataSize = size;
-	createInfo.pInitialData = data;
+	createInfo.initialDataSize = mappedFile.size();
+	createInfo.pInitialData = mappedFile.data();
 
 	VK_CHECK(vkCreatePipelineCache(device->get_device(), &createInfo, nullptr, &_pipelineCache));
-
-	if (data)
-		FILE_SYSTEM()->unmap_after_reading(data);
 }
 
 void VulkanPipelineCache::save_pipeline_cache(VulkanDevice* device)
@@ -52,7 +46,7 @@ void VulkanPipelineCache::destroy(VulkanDevice* device)
 		vkDestroyPipelineCache(device->get_device(), _pipelineCache, nullptr);
 }
 
-bool VulkanPipelineCache::is_loaded_cache_valid(VulkanDevice* device, uint8_t* cacheData)
+bool VulkanPipelineCache::is_loaded_cache_valid(VulkanDevice* device, const uint8_t* cacheData)
 {
 	uint32_t headerLength{ 0 };
 	uint32_t cacheHeaderVersion{ 0 };
@@ -16,6 +16,6 @@ namespace ad_astris::vulkan
 		private:
 			VkPipelineCache _pipelineCache{ VK_NULL_HANDLE };
 
-			bool is_loaded_cache_valid(VulkanDevice* device, uint8_t* cacheData);
+			bool is_loaded_cache_valid(VulkanDevice* device, const uint8_t* cacheData);
 	};
 }
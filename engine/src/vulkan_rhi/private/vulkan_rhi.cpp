@@ -1058,7 +1058,7 @@ void VulkanRHI::get_query_pool_result(
 	assert(queryPool->handle);
 
 	VulkanQueryPool* vkQueryPool = get_vk_obj(queryPool);
-	outputData.resize(queryCount);
+	outputData.resize(queryCount * stride / sizeof(uint64_t));
 	VK_CHECK(vkGetQueryPoolResults(
 		_device->get_device(),
 		vkQueryPool->get_handle(),
@@ -1105,7 +1105,7 @@ void VulkanRHI::copy_query_pool_results(
 		queryCount,
 		vkBuffer->get_handle(),
 		dstOffset,
-		sizeof(uint64_t),
+		stride,
 		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
 }
 